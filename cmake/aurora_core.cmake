@@ -5,6 +5,8 @@ add_library(aurora_core STATIC
         lib/input.cpp
         lib/io.cpp
         lib/io.hpp
+        lib/cache_snapshot.cpp
+        lib/cache_snapshot.hpp
         lib/logging.cpp
         lib/system_info.cpp
         lib/system_info.hpp
@@ -53,9 +55,12 @@ if(AURORA_ENABLE_RMLUI)
             lib/rmlui/RuntimeTextureProvider.cpp
             lib/rmlui/RmlUi_Backend_Aurora.cpp
             lib/rmlui/WebGPURenderInterface.cpp
+            lib/rmlui/blur_plan.cpp
+            lib/rmlui/filter_cache.cpp
             lib/rmlui/SystemInterface_Aurora.cpp
             lib/rmlui/FileInterface_SDL.cpp
             lib/rmlui/GlassFilter.cpp
+            lib/rmlui/image_loader.cpp
     )
     target_link_libraries(aurora_core PUBLIC rmlui)
 
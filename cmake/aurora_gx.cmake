@@ -1,8 +1,11 @@
 add_library(aurora_gx STATIC
         lib/gfx/clear.cpp
         lib/gfx/depth_peek.cpp
+        lib/gfx/depth_peek_store.cpp
         lib/gfx/encoding.cpp
         lib/gfx/frame.cpp
+        lib/gfx/frame_pacing.cpp
+        lib/gfx/frame_timing.cpp
         lib/gfx/pipeline_cache.cpp
         lib/gfx/recording.cpp
         lib/gfx/render_worker.cpp
@@ -21,9 +24,14 @@ add_library(aurora_gx STATIC
         lib/gx/fifo.cpp
         lib/gx/gx.cpp
         lib/gx/texture.cpp
+        lib/gx/bind_group_cache.cpp
         lib/gx/pipeline.cpp
         lib/gx/shader.cpp
         lib/gx/shader_info.cpp
+        lib/gx/canonicalize.cpp
+        lib/gx/uber_config.cpp
+        lib/gx/static_indices.cpp
+        lib/gx/vertex_decode.cpp
         lib/dolphin/gx/GXBump.cpp
         lib/dolphin/gx/GXCull.cpp
         lib/dolphin/gx/GXCpu2Efb.cpp
@@ -52,9 +60,13 @@ set_target_properties(aurora_gx PROPERTIES FOLDER "aurora")
 target_link_libraries(aurora_gx PUBLIC aurora::core dawn::webgpu_dawn xxhash)
 target_link_libraries(aurora_gx PRIVATE absl::btree absl::flat_hash_map sqlite3 TracyClient PNG::PNG)
 target_compile_definitions(aurora_gx PRIVATE WEBGPU_DAWN)
+# Public so that code including gx/perf.hpp agrees with the library on the counter layout.
+target_compile_definitions(aurora_gx PUBLIC AURORA_GX_PERF_COUNTERS=$<BOOL:${AURORA_GX_PERF_COUNTERS}>)
 
 if (AURORA_ENABLE_RMLUI)
     target_sources(aurora_gx PRIVATE
+        lib/rmlui/geometry_arena.cpp
+        lib/rmlui/geometry_arena.hpp
         lib/rmlui/pipeline.cpp
         lib/rmlui/pipeline.hpp
     )
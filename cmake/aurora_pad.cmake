@@ -1,4 +1,8 @@
-add_library(aurora_pad STATIC lib/dolphin/pad/pad.cpp)
+add_library(aurora_pad STATIC
+        lib/dolphin/pad/pad.cpp
+        lib/dolphin/pad/pad_sampler.cpp
+        lib/dolphin/pad/pad_sampler.hpp
+)
 add_library(aurora::pad ALIAS aurora_pad)
 set_target_properties(aurora_pad PROPERTIES FOLDER "aurora")
 
@@ -37,6 +37,15 @@ typedef enum {
   LOG_FATAL,
 } AuroraLogLevel;
 
+typedef enum {
+  /** Frames start as soon as a frame slot is free. */
+  FRAME_PACING_OFF,
+  /** Frames start as late as possible while still making the next present. */
+  FRAME_PACING_LOW_LATENCY,
+  /** Like FRAME_PACING_LOW_LATENCY, but backs off when frame times are too close to the present period. */
+  FRAME_PACING_ADAPTIVE,
+} AuroraFramePacing;
+
 typedef struct {
   int32_t x;
   int32_t y;
@@ -116,6 +125,17 @@ typedef struct {
    * This can be set to 0 to disable allocating this region.
    */
   uint32_t mem2Size;
+
+  /*
+   * Frame start pacing mode. Can be changed at runtime with aurora_set_frame_pacing.
+   */
+  AuroraFramePacing framePacing;
+
+  /*
+   * Write log messages from a background thread instead of the calling thread, collapsing repeated messages.
+   * When enabled, logCallback is invoked on that thread, except for LOG_FATAL messages.
+   */
+  bool asyncLogging;
 } AuroraConfig;
 
 typedef struct {
@@ -1,6 +1,8 @@
 #ifndef AURORA_GFX_H
 #define AURORA_GFX_H
 
+#include "aurora.h"
+
 #ifdef __cplusplus
 #include <cstdint>
 
@@ -26,12 +28,103 @@ typedef struct {
   uint32_t lastIndexSize;
   uint32_t lastStorageSize;
   uint32_t lastTextureUploadSize;
+  /** Time the last frame start was delayed by frame pacing, in microseconds. */
+  uint32_t pacingWaitUs;
+  /** Smoothed time from frame start to present, in microseconds. */
+  uint32_t estimatedLatencyUs;
+  /** Draws folded into the previous draw as another instance, differing only in their transform matrices. */
+  uint32_t instancedDrawCallCount;
+  /** Bytes of compiled UI geometry resident in persistent GPU buffers. */
+  uint32_t residentUiGeometrySize;
+  /** Bytes of pooled offscreen render targets currently allocated. */
+  uint32_t residentOffscreenTargetSize;
+  /** Most bytes of pooled offscreen render targets allocated at once. */
+  uint32_t peakOffscreenTargetSize;
 } AuroraStats;
 
+typedef enum {
+  AURORA_FRAME_PHASE_FIFO,
+  AURORA_FRAME_PHASE_DRAW_BUILD,
+  AURORA_FRAME_PHASE_TEXTURE_CONVERT,
+  AURORA_FRAME_PHASE_PIPELINE_LOOKUP,
+  AURORA_FRAME_PHASE_ENCODE,
+  AURORA_FRAME_PHASE_SUBMIT,
+  AURORA_FRAME_PHASE_PRESENT,
+  AURORA_FRAME_PHASE_COUNT,
+} AuroraFramePhase;
+
+typedef struct {
+  uint64_t frameId;
+  /** Time from frame start to the end of CPU recording, in microseconds. */
+  uint32_t cpuFrameUs;
+  /** Inclusive time spent in each phase during the frame, in microseconds. Phases may nest (e.g. draw building happens
+   * during FIFO processing) and run on different threads, so they do not sum to the frame time. */
+  uint32_t phaseUs[AURORA_FRAME_PHASE_COUNT];
+  /** Number of timed scopes per phase. */
+  uint32_t phaseCalls[AURORA_FRAME_PHASE_COUNT];
+} AuroraFrameTiming;
+
+typedef enum {
+  AURORA_FRAME_TIMING_JSON,
+  AURORA_FRAME_TIMING_CSV,
+} AuroraFrameTimingFormat;
+
+typedef struct {
+  /** Valid until shutdown. */
+  const char* tag;
+  /** Pipelines first requested while this tag was current, in this or previous sessions. */
+  uint32_t pipelineCount;
+  /** Pending pipelines moved ahead of the background compile queue by aurora_prefetch_pipelines. */
+  uint32_t prefetchedPipelines;
+  /** Pipelines of the set first requested after a prefetch that were ready (hits) or not yet compiled (misses). */
+  uint32_t prefetchHits;
+  uint32_t prefetchMisses;
+} AuroraPipelineTagStats;
+
 const AuroraStats* aurora_get_stats();
 float aurora_get_fps();
 
 void aurora_enable_vsync(bool enabled);
+void aurora_set_frame_pacing(AuroraFramePacing mode);
+AuroraFramePacing aurora_get_frame_pacing();
+
+/**
+ * Enables or disables sorting of opaque, depth-tested GX draws by pipeline and textures within each render pass.
+ * Disabled by default, since coplanar draws at exactly equal depth may resolve differently when reordered.
+ */
+void aurora_set_draw_reordering(bool enabled);
+bool aurora_get_draw_reordering();
+
+/**
+ * Sets the memory budget in bytes for indexed vertex arrays pre-decoded to f32 on the CPU. Arrays used in consecutive
+ * frames are decoded once, kept resident on the GPU and loaded directly by the shader instead of being byte-swapped and
+ * dequantized per vertex. Arrays rewritten in place are only picked up after GXInvalidateVtxCache. The budget is capped
+ * at 8 MiB; 0 (the default) disables pre-decoding.
+ */
+void aurora_set_vertex_predecode_budget(uint32_t bytes);
+uint32_t aurora_get_vertex_predecode_budget();
+
+/**
+ * Tags the current scene or region, e.g. "area_12". Pipelines first requested while a tag is current are recorded in
+ * its set in the pipeline cache. NULL or an empty string stops recording.
+ */
+void aurora_set_pipeline_tag(const char* tag);
+/**
+ * Compiles the pipelines recorded for tag ahead of the rest of the cache, e.g. at the start of a load screen. Returns
+ * the number of pipelines that were still pending.
+ */
+uint32_t aurora_prefetch_pipelines(const char* tag);
+/** Copies up to maxCount tag sets into out. Returns the number copied, or the number of tags if out is NULL. */
+uint32_t aurora_get_pipeline_tag_stats(AuroraPipelineTagStats* out, uint32_t maxCount);
+
+/** Enables or disables per-frame CPU timing. Enabled by default. */
+void aurora_set_frame_timing_enabled(bool enabled);
+bool aurora_get_frame_timing_enabled();
+/** Copies up to maxCount of the most recently completed frames into out, oldest first. Returns the number copied. */
+uint32_t aurora_get_frame_timings(AuroraFrameTiming* out, uint32_t maxCount);
+const char* aurora_get_frame_phase_name(AuroraFramePhase phase);
+/** Writes the frame timing history to path. Returns false if the file could not be written. */
+bool aurora_dump_frame_timings(const char* path, AuroraFrameTimingFormat format);
 
 #ifdef __cplusplus
 }
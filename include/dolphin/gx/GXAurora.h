@@ -173,6 +173,29 @@ void GXCreateFrameBuffer(u32 width, u32 height);
  */
 void GXRestoreFrameBuffer(void);
 
+typedef struct {
+  u16 x;
+  u16 y;
+} GXPeekZPoint;
+
+/**
+ * Batched GXPeekZ: reads the Z value at each of `count` points into `z`, all from the same depth snapshot.
+ * Points the snapshot does not cover read as 0, like GXPeekZ.
+ */
+void GXPeekZPoints(const GXPeekZPoint* points, u32 count, u32* z);
+
+/**
+ * Batched GXPeekZ over a rectangle: writes width * height Z values into `z`, row by row.
+ */
+void GXPeekZRect(u16 x, u16 y, u16 width, u16 height, u32* z);
+
+/**
+ * Sets the resolution of the depth snapshots behind GXPeekZ as a divisor of the framebuffer size (1-8, default 1).
+ * Larger divisors cut readback bandwidth by divisor^2; each peek then returns the depth at the centre of the
+ * divisor x divisor block containing the point.
+ */
+void GXSetPeekZDivisor(u32 divisor);
+
 #if __cplusplus
 }
 #endif
@@ -1,13 +1,71 @@
 #ifndef DOLPHIN_GXPERF_H
 #define DOLPHIN_GXPERF_H
 
+#include <dolphin/gx/GXEnum.h>
 #include <dolphin/types.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+void GXSetGPMetric(GXPerf0 perf0, GXPerf1 perf1);
+void GXClearGPMetric(void);
+void GXReadGPMetric(u32* cnt0, u32* cnt1);
+u32 GXReadGP0Metric(void);
+u32 GXReadGP1Metric(void);
+void GXReadMemMetric(u32* cp_req, u32* tc_req, u32* cpu_rd_req, u32* cpu_wr_req, u32* dsp_req, u32* io_req,
+                     u32* vi_req, u32* pe_req, u32* rf_req, u32* fi_req);
+void GXClearMemMetric(void);
+void GXReadPixMetric(u32* top_pixels_in, u32* top_pixels_out, u32* bot_pixels_in, u32* bot_pixels_out,
+                     u32* clr_pixels_in, u32* copy_clks);
+void GXClearPixMetric(void);
+void GXSetVCacheMetric(GXVCachePerf attr);
+void GXReadVCacheMetric(u32* check, u32* miss, u32* stall);
+void GXClearVCacheMetric(void);
 void GXReadXfRasMetric(u32* xf_wait_in, u32* xf_wait_out, u32* ras_busy, u32* clocks);
+void GXInitXfRasMetric(void);
+u32 GXReadClksPerVtx(void);
+
+/**
+ * Aurora extension: totals of the counters the GXPerf metrics are derived from, since startup. Counters never reset;
+ * subtract two reads to measure an interval. Every field reads as zero when Aurora is built with
+ * AURORA_GX_PERF_COUNTERS off.
+ */
+typedef struct {
+  u64 fifoBytes;
+  u64 commands;
+  u64 vertices;
+  u64 quads;
+  u64 triangles;
+  u64 triangleStripTris;
+  u64 triangleFanTris;
+  u64 lines;
+  u64 lineStripLines;
+  u64 points;
+  /** Draws recorded to the renderer. */
+  u64 drawsSubmitted;
+  /** Draws folded into the previous draw. */
+  u64 drawsMerged;
+  /** Draws added to the previous draw as another instance. */
+  u64 drawsInstanced;
+  u64 vertexBytes;
+  u64 indexBytes;
+  u64 uniformBytes;
+  u64 storageBytes;
+  u64 textureBytes;
+  u64 textureCacheHits;
+  u64 textureCacheMisses;
+  /** Pipeline lookups after a state change, and those whose pipeline was not yet compiled. */
+  u64 pipelineLookups;
+  u64 pipelineMisses;
+  u64 efbCopies;
+  u64 efbCopyPixels;
+  /** Indexed fetches and array uploads per attribute, GX_VA_POS through GX_VA_TEX7. */
+  u64 attrFetches[GX_VA_TEX7 - GX_VA_POS + 1];
+  u64 attrUploads[GX_VA_TEX7 - GX_VA_POS + 1];
+} GXAuroraPerfCounters;
+
+void GXAuroraReadPerfCounters(GXAuroraPerfCounters* out);
 
 #ifdef __cplusplus
 }
@@ -221,6 +221,14 @@ s32 PADGetNativeButtonPressed(u32 port);
 PADSignedNativeAxis PADGetNativeAxisPulled(u32 port);
 void PADRestoreDefaultMapping(u32 port);
 void PADBlockInput(bool block);
+/**
+ * Polls gamepads on a background thread at `hz` samples per second. PADRead then reports everything sampled since
+ * the previous read, so presses and releases shorter than a frame are not lost. 0 (the default) stops the thread and
+ * reads gamepads directly in PADRead. Keyboard and mouse bindings are always read directly.
+ */
+void PADSetSamplingRate(u32 hz);
+/* Age in nanoseconds of the newest sample at the last PADRead, and the largest seen. FALSE when not sampling. */
+BOOL PADGetSampleLatency(u32 port, u64* lastNs, u64* maxNs);
 
 void PADSetVirtualStatus(u32 port, const PADStatus* status);
 void PADClearVirtualStatus(u32 port);
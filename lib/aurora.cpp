@@ -4,6 +4,7 @@
 #ifdef AURORA_ENABLE_GX
 #include "gfx/resources.hpp"
 #include "gfx/frame.hpp"
+#include "gfx/frame_timing.hpp"
 #include "gfx/recording.hpp"
 #include "gfx/render_worker.hpp"
 #include "gx/command_processor.hpp"
@@ -98,6 +99,7 @@ bool g_initialFrame = false;
 
 AuroraInfo initialize(int argc, char* argv[], const AuroraConfig& config) noexcept {
   g_config = config;
+  set_async_logging(g_config.asyncLogging);
   Log.info("Aurora initializing");
   log_system_information();
   if (g_config.appName == nullptr) {
@@ -219,6 +221,7 @@ void shutdown() noexcept {
 #endif
   input::shutdown();
   window::shutdown();
+  set_async_logging(false);
 }
 
 const AuroraEvent* update() noexcept {
@@ -371,6 +374,7 @@ void end_frame() noexcept {
     const auto buffer = encoder.Finish(&cmdBufDescriptor);
     {
       ZoneScopedN("Queue Submit");
+      gfx::frame_timing::ScopedTimer timer{gfx::frame_timing::Phase::Submit};
       g_queue.Submit(1, &buffer);
     }
     webgpu::gpu_prof::after_submit();
@@ -378,6 +382,7 @@ void end_frame() noexcept {
       ZoneScopedN("Present");
       wgpu::ConvertibleStatus status = wgpu::Status::Error;
       {
+        gfx::frame_timing::ScopedTimer timer{gfx::frame_timing::Phase::Present};
         window::SurfaceLock surfaceLock;
         if (window::is_presentable()) {
           status = g_surface.Present();
@@ -428,17 +433,20 @@ void end_frame() noexcept {
     TracyPlotConfig("aurora: lastIndexSize", tracy::PlotFormatType::Memory, false, true, 0);
     TracyPlotConfig("aurora: lastStorageSize", tracy::PlotFormatType::Memory, false, true, 0);
     TracyPlotConfig("aurora: lastTextureUploadSize", tracy::PlotFormatType::Memory, false, true, 0);
+    TracyPlotConfig("aurora: residentOffscreenTargetSize", tracy::PlotFormatType::Memory, false, true, 0);
 
     const auto& stats = gfx::detail::resources().stats;
     TracyPlot("aurora: queuedPipelines", static_cast<int64_t>(stats.queuedPipelines));
     TracyPlot("aurora: createdPipelines", static_cast<int64_t>(stats.createdPipelines));
     TracyPlot("aurora: drawCallCount", static_cast<int64_t>(stats.drawCallCount));
     TracyPlot("aurora: mergedDrawCallCount", static_cast<int64_t>(stats.mergedDrawCallCount));
+    TracyPlot("aurora: instancedDrawCallCount", static_cast<int64_t>(stats.instancedDrawCallCount));
     TracyPlot("aurora: lastVertSize", static_cast<int64_t>(stats.lastVertSize));
     TracyPlot("aurora: lastUniformSize", static_cast<int64_t>(stats.lastUniformSize));
     TracyPlot("aurora: lastIndexSize", static_cast<int64_t>(stats.lastIndexSize));
     TracyPlot("aurora: lastStorageSize", static_cast<int64_t>(stats.lastStorageSize));
     TracyPlot("aurora: lastTextureUploadSize", static_cast<int64_t>(stats.lastTextureUploadSize));
+    TracyPlot("aurora: residentOffscreenTargetSize", static_cast<int64_t>(stats.residentOffscreenTargetSize));
   });
 
 #endif
@@ -0,0 +1,178 @@
+#include "cache_snapshot.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace aurora::cache_snapshot {
+namespace {
+constexpr uint32_t Magic = 0x4E534341; // 'ACSN'
+constexpr uint32_t Version = 1;
+
+struct Header {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t format;
+  uint32_t keySize;
+  uint64_t count;
+  uint64_t sourceStamp;
+  uint64_t blobSize;
+};
+static_assert(sizeof(Header) == 40);
+
+// Index entries are the key padded to 8 bytes, then the blob offset, size and raw size
+constexpr size_t padded_key_size(uint32_t keySize) noexcept { return (keySize + 7) & ~size_t{7}; }
+constexpr size_t entry_size(uint32_t keySize) noexcept { return padded_key_size(keySize) + 16; }
+
+template <typename T>
+T load(const uint8_t* ptr) noexcept {
+  T value;
+  std::memcpy(&value, ptr, sizeof(T));
+  return value;
+}
+
+template <typename T>
+void append(std::vector<uint8_t>& out, const T& value) {
+  const auto* bytes = reinterpret_cast<const uint8_t*>(&value);
+  out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+int compare_prefix(std::span<const uint8_t> key, std::span<const uint8_t> prefix) noexcept {
+  return std::memcmp(key.data(), prefix.data(), std::min(key.size(), prefix.size()));
+}
+} // namespace
+
+Builder::Builder(uint32_t format, uint32_t keySize, uint64_t sourceStamp) noexcept
+: m_format(format), m_keySize(std::min<uint32_t>(keySize, MaxKeySize)), m_sourceStamp(sourceStamp) {}
+
+void Builder::add(std::span<const uint8_t> key, std::span<const uint8_t> value, uint32_t rawSize) {
+  const size_t keyOffset = m_keys.size();
+  m_keys.resize(keyOffset + m_keySize);
+  std::memcpy(m_keys.data() + keyOffset, key.data(), std::min<size_t>(key.size(), m_keySize));
+  m_entries.push_back({
+      .keyOffset = keyOffset,
+      .valueOffset = m_blobs.size(),
+      .size = static_cast<uint32_t>(value.size()),
+      .rawSize = rawSize,
+  });
+  m_blobs.insert(m_blobs.end(), value.begin(), value.end());
+}
+
+bool Builder::write(const std::filesystem::path& path) {
+  std::stable_sort(m_entries.begin(), m_entries.end(), [this](const PendingEntry& a, const PendingEntry& b) {
+    return std::memcmp(m_keys.data() + a.keyOffset, m_keys.data() + b.keyOffset, m_keySize) < 0;
+  });
+
+  std::vector<uint8_t> out;
+  out.reserve(sizeof(Header) + m_entries.size() * entry_size(m_keySize) + m_blobs.size());
+  append(out, Header{
+                  .magic = Magic,
+                  .version = Version,
+                  .format = m_format,
+                  .keySize = m_keySize,
+                  .count = m_entries.size(),
+                  .sourceStamp = m_sourceStamp,
+                  .blobSize = m_blobs.size(),
+              });
+  for (const auto& entry : m_entries) {
+    const size_t keyStart = out.size();
+    out.resize(keyStart + padded_key_size(m_keySize));
+    std::memcpy(out.data() + keyStart, m_keys.data() + entry.keyOffset, m_keySize);
+    append(out, entry.valueOffset);
+    append(out, entry.size);
+    append(out, entry.rawSize);
+  }
+  out.insert(out.end(), m_blobs.begin(), m_blobs.end());
+  return io::write_file_atomic(path, out);
+}
+
+Snapshot Snapshot::open(const std::filesystem::path& path, uint32_t format, uint32_t keySize) noexcept {
+  Snapshot snapshot;
+  auto file = io::map_file(path);
+  if (!file) {
+    return snapshot;
+  }
+
+  const auto data = file.data();
+  if (data.size() < sizeof(Header)) {
+    return snapshot;
+  }
+  const auto header = load<Header>(data.data());
+  if (header.magic != Magic || header.version != Version || header.format != format || header.keySize != keySize ||
+      keySize > MaxKeySize) {
+    return snapshot;
+  }
+  const size_t available = data.size() - sizeof(Header);
+  if (header.count > available / entry_size(keySize)) {
+    return snapshot;
+  }
+  const size_t indexSize = header.count * entry_size(keySize);
+  if (header.blobSize != available - indexSize) {
+    return snapshot;
+  }
+
+  snapshot.m_keySize = keySize;
+  snapshot.m_count = header.count;
+  snapshot.m_sourceStamp = header.sourceStamp;
+  snapshot.m_index = data.subspan(sizeof(Header), indexSize);
+  snapshot.m_blobs = data.subspan(sizeof(Header) + indexSize);
+  snapshot.m_file = std::move(file);
+  return snapshot;
+}
+
+std::span<const uint8_t> Snapshot::key_at(size_t i) const noexcept {
+  return m_index.subspan(i * entry_size(m_keySize), m_keySize);
+}
+
+std::optional<Record> Snapshot::at(size_t i) const noexcept {
+  if (i >= m_count) {
+    return std::nullopt;
+  }
+  const uint8_t* entry = m_index.data() + i * entry_size(m_keySize) + padded_key_size(m_keySize);
+  const auto offset = load<uint64_t>(entry);
+  const auto size = load<uint32_t>(entry + 8);
+  if (offset > m_blobs.size() || size > m_blobs.size() - offset) {
+    return std::nullopt;
+  }
+  return Record{
+      .key = key_at(i),
+      .value = m_blobs.subspan(offset, size),
+      .rawSize = load<uint32_t>(entry + 12),
+  };
+}
+
+std::pair<size_t, size_t> Snapshot::prefix_range(std::span<const uint8_t> prefix) const noexcept {
+  size_t lo = 0;
+  size_t hi = m_count;
+  while (lo < hi) {
+    const size_t mid = lo + (hi - lo) / 2;
+    if (compare_prefix(key_at(mid), prefix) < 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  size_t end = lo;
+  hi = m_count;
+  while (end < hi) {
+    const size_t mid = end + (hi - end) / 2;
+    if (compare_prefix(key_at(mid), prefix) <= 0) {
+      end = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return {lo, end};
+}
+
+std::optional<Record> Snapshot::find(std::span<const uint8_t> key) const noexcept {
+  if (key.size() != m_keySize) {
+    return std::nullopt;
+  }
+  const auto [begin, end] = prefix_range(key);
+  if (begin == end) {
+    return std::nullopt;
+  }
+  return at(begin);
+}
+
+} // namespace aurora::cache_snapshot
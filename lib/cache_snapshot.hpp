@@ -0,0 +1,83 @@
+#pragma once
+
+#include "io.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+// Read-only snapshots of sqlite-backed caches. A snapshot is a sorted index of fixed-size keys followed by a blob
+// region, written beside the database and memory-mapped at startup so that loads become binary searches into the
+// mapping instead of sqlite queries. The database stays the source of truth: snapshots are only ever rebuilt from it,
+// and callers fall back to it on a miss or when a snapshot is stale.
+namespace aurora::cache_snapshot {
+
+constexpr size_t MaxKeySize = 32;
+
+struct Record {
+  std::span<const uint8_t> key;
+  std::span<const uint8_t> value;
+  // Caller-defined, e.g. the uncompressed size of value
+  uint32_t rawSize;
+};
+
+class Builder {
+public:
+  // format identifies the caller's key and value layout; snapshots are rejected when it doesn't match.
+  // sourceStamp identifies the database state the snapshot was built from.
+  Builder(uint32_t format, uint32_t keySize, uint64_t sourceStamp) noexcept;
+
+  void add(std::span<const uint8_t> key, std::span<const uint8_t> value, uint32_t rawSize);
+  [[nodiscard]] size_t size() const noexcept { return m_entries.size(); }
+  // Sorts the index and atomically replaces path.
+  bool write(const std::filesystem::path& path);
+
+private:
+  struct PendingEntry {
+    size_t keyOffset;
+    uint64_t valueOffset;
+    uint32_t size;
+    uint32_t rawSize;
+  };
+
+  uint32_t m_format;
+  uint32_t m_keySize;
+  uint64_t m_sourceStamp;
+  std::vector<uint8_t> m_keys;
+  std::vector<uint8_t> m_blobs;
+  std::vector<PendingEntry> m_entries;
+};
+
+class Snapshot {
+public:
+  Snapshot() = default;
+
+  // Maps the snapshot at path. Returns an empty snapshot if it doesn't exist or doesn't match format and keySize.
+  static Snapshot open(const std::filesystem::path& path, uint32_t format, uint32_t keySize) noexcept;
+
+  explicit operator bool() const noexcept { return static_cast<bool>(m_file); }
+  [[nodiscard]] uint64_t source_stamp() const noexcept { return m_sourceStamp; }
+  [[nodiscard]] size_t size() const noexcept { return m_count; }
+
+  // Record i in key order, or nullopt if its blob lies outside the file.
+  [[nodiscard]] std::optional<Record> at(size_t i) const noexcept;
+  [[nodiscard]] std::optional<Record> find(std::span<const uint8_t> key) const noexcept;
+  // The [begin, end) index range of records whose keys start with prefix.
+  [[nodiscard]] std::pair<size_t, size_t> prefix_range(std::span<const uint8_t> prefix) const noexcept;
+
+private:
+  [[nodiscard]] std::span<const uint8_t> key_at(size_t i) const noexcept;
+
+  io::MappedFile m_file;
+  uint32_t m_keySize = 0;
+  size_t m_count = 0;
+  uint64_t m_sourceStamp = 0;
+  std::span<const uint8_t> m_index;
+  std::span<const uint8_t> m_blobs;
+};
+
+} // namespace aurora::cache_snapshot
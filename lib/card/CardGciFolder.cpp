@@ -39,23 +39,93 @@ const CardGciFolder::GciFile* CardGciFolder::get_open_file(const FileHandle& fh)
   return file != nullptr && file->opened ? file : nullptr;
 }
 
+bool CardGciFolder::ensure_stream(GciFile& gciFile) {
+  if (!gciFile.stream) {
+    gciFile.stream = io::open_file(m_folderPath / gciFile.filename, "rb");
+    ++m_ioStats.opens;
+  }
+  return gciFile.stream != nullptr;
+}
+
+bool CardGciFolder::load_data(GciFile& gciFile) {
+  if (gciFile.dataLoaded) {
+    return true;
+  }
+  if (!ensure_stream(gciFile)) {
+    return false;
+  }
+  gciFile.data.resize(gciFile.fileSize > sizeof(File) ? gciFile.fileSize - sizeof(File) : 0);
+  ++m_ioStats.reads;
+  if (!io::read_at(gciFile.stream.get(), sizeof(File), gciFile.data.data(), gciFile.data.size())) {
+    gciFile.data.clear();
+    return false;
+  }
+  gciFile.dataLoaded = true;
+  return true;
+}
+
+// Replaces the file with its header and contents in one atomic write, if either changed.
+bool CardGciFolder::persist(GciFile& gciFile) {
+  if (!gciFile.headerDirty && !gciFile.dataDirty) {
+    return true;
+  }
+  if (!load_data(gciFile)) {
+    Log.error("Failed to read GCI file '{}' for update: {}", io::fs_path_to_string(gciFile.filename), SDL_GetError());
+    return false;
+  }
+  // Windows cannot replace a file that is still open.
+  gciFile.stream.reset();
+
+  File header = gciFile.file;
+  header.swapEndian();
+  auto writer = io::open_atomic_file(m_folderPath / gciFile.filename);
+  ++m_ioStats.opens;
+  m_ioStats.writes += 2;
+  if (!writer || !io::write_exact(writer.get(), &header, sizeof(File)) ||
+      !io::write_exact(writer.get(), gciFile.data.data(), gciFile.data.size()) || !writer.commit()) {
+    Log.error("Failed to write GCI file '{}': {}", io::fs_path_to_string(gciFile.filename), SDL_GetError());
+    return false;
+  }
+  ++m_ioStats.replaces;
+  gciFile.headerDirty = false;
+  gciFile.dataDirty = false;
+  return true;
+}
+
+void CardGciFolder::release(GciFile& gciFile) {
+  gciFile.stream.reset();
+  gciFile.data = {};
+  gciFile.dataLoaded = false;
+}
+
 CardGciFolder::CardGciFolder() {}
 
+CardGciFolder::~CardGciFolder() {
+  for (auto& gciFile : m_files) {
+    persist(gciFile);
+  }
+}
+
 CardGciFolder::CardGciFolder(CardGciFolder&& other) {
   m_files = std::move(other.m_files);
   m_bat = std::move(other.m_bat);
   m_folderPath = other.m_folderPath;
   m_encoding = other.m_encoding;
+  m_ioStats = other.m_ioStats;
 
   CardGciFolder::setCurrentGame(other.m_game);
   CardGciFolder::setCurrentMaker(other.m_maker);
 }
 
 CardGciFolder& CardGciFolder::operator=(CardGciFolder&& other) {
+  for (auto& gciFile : m_files) {
+    persist(gciFile);
+  }
   m_files = std::move(other.m_files);
   m_bat = std::move(other.m_bat);
   m_folderPath = other.m_folderPath;
   m_encoding = other.m_encoding;
+  m_ioStats = other.m_ioStats;
 
   CardGciFolder::setCurrentGame(other.m_game);
   CardGciFolder::setCurrentMaker(other.m_maker);
@@ -119,13 +189,23 @@ ECardResult CardGciFolder::createFile(const char* filename, size_t size, FileHan
 
   // write big endian header for dolphin compat
   gciFileHeader->swapEndian();
-  FileIO file(m_folderPath / gciFilename, true);
-  if (!file || !file.fileWrite(fileBuf.data(), fileBuf.size(), 0)) {
+  ++m_ioStats.opens;
+  ++m_ioStats.writes;
+  if (!io::write_file_atomic(m_folderPath / gciFilename, fileBuf)) {
     return ECardResult::IOERROR;
   }
+  ++m_ioStats.replaces;
 
   gciFileHeader->swapEndian();
-  m_files.push_back({*gciFileHeader, fileSize, reinterpret_cast<const char8_t*>(gciFilename.c_str()), true});
+  auto& gciFile = m_files.emplace_back(GciFile{
+      .file = *gciFileHeader,
+      .fileSize = fileSize,
+      .filename = reinterpret_cast<const char8_t*>(gciFilename.c_str()),
+      .opened = true,
+  });
+  // The contents are known to be zero, so the first write does not need to read them back.
+  gciFile.data.resize(size);
+  gciFile.dataLoaded = true;
   handleOut = FileHandle(m_files.size() - 1, 0);
 
   return ECardResult::READY;
@@ -135,6 +215,11 @@ ECardResult CardGciFolder::closeFile(FileHandle& fh) {
   auto file = get_open_file(fh);
   if (file) {
     file->opened = false;
+    // On failure the changes stay pending and are retried by the next commit.
+    if (!persist(*file)) {
+      return ECardResult::IOERROR;
+    }
+    release(*file);
     return ECardResult::READY;
   }
 
@@ -146,6 +231,9 @@ void CardGciFolder::deleteFile(const FileHandle& fh) {
   if (!file)
     return;
 
+  release(*file);
+  file->headerDirty = false;
+  file->dataDirty = false;
   FileIO fileIO(m_folderPath / file->filename, true);
   if (fileIO)
     fileIO.deleteFile();
@@ -159,6 +247,7 @@ ECardResult CardGciFolder::renameFile(const char* oldName, const char* newName)
   for (auto& gciFile : m_files) {
     if (strcmp(oldName, gciFile.file.m_filename) == 0) {
       strncpy(gciFile.file.m_filename, newName, std::size(gciFile.file.m_filename));
+      gciFile.headerDirty = true;
       return ECardResult::READY;
     }
   }
@@ -169,13 +258,20 @@ ECardResult CardGciFolder::renameFile(const char* oldName, const char* newName)
 ECardResult CardGciFolder::fileWrite(FileHandle& fh, const void* buf, size_t size) {
   auto file = get_open_file(fh);
   if (file) {
-    FileIO fileIO(m_folderPath / file->filename);
-    if (fileIO) {
-      if (fileIO.fileWrite(buf, size, sizeof(File) + fh.offset))
-        return ECardResult::READY;
+    if (fh.offset < 0) {
       return ECardResult::IOERROR;
     }
-    return ECardResult::NOFILE;
+    if (!load_data(*file)) {
+      return file->stream ? ECardResult::IOERROR : ECardResult::NOFILE;
+    }
+    const size_t offset = static_cast<size_t>(fh.offset);
+    if (offset + size > file->data.size()) {
+      file->data.resize(offset + size);
+      file->fileSize = sizeof(File) + file->data.size();
+    }
+    std::memcpy(file->data.data() + offset, buf, size);
+    file->dataDirty = true;
+    return ECardResult::READY;
   }
 
   return ECardResult::NOCARD;
@@ -184,13 +280,24 @@ ECardResult CardGciFolder::fileWrite(FileHandle& fh, const void* buf, size_t siz
 ECardResult CardGciFolder::fileRead(FileHandle& fh, void* dst, size_t size) {
   auto file = get_open_file(fh);
   if (file) {
-    FileIO fileIO(m_folderPath / file->filename);
-    if (fileIO) {
-      if (fileIO.fileRead(dst, size, sizeof(File) + fh.offset))
-        return ECardResult::READY;
+    if (fh.offset < 0) {
       return ECardResult::IOERROR;
     }
-    return ECardResult::NOFILE;
+    const size_t offset = static_cast<size_t>(fh.offset);
+    if (file->dataLoaded) {
+      if (offset + size > file->data.size()) {
+        return ECardResult::IOERROR;
+      }
+      std::memcpy(dst, file->data.data() + offset, size);
+      return ECardResult::READY;
+    }
+    if (!ensure_stream(*file)) {
+      return ECardResult::NOFILE;
+    }
+    ++m_ioStats.reads;
+    if (io::read_at(file->stream.get(), sizeof(File) + offset, dst, size))
+      return ECardResult::READY;
+    return ECardResult::IOERROR;
   }
 
   return ECardResult::NOCARD;
@@ -284,6 +391,7 @@ ECardResult CardGciFolder::setStatus(uint32_t fileNo, const CardStat& stat) {
   file->m_iconFmt = stat.x34_iconFormat;
   file->m_animSpeed = stat.x36_iconSpeed;
   file->m_commentAddr = stat.x38_commentAddr;
+  gciFile->headerDirty = true;
 
   return ECardResult::READY;
 }
@@ -342,12 +450,11 @@ void CardGciFolder::format(ECardSlot deviceId, ECardSize size, EEncoding encodin
 }
 
 void CardGciFolder::commit() {
+  // Open files are published when they are closed, so a save written in many chunks is replaced once, as a whole.
   for (auto& gciFile : m_files) {
-    FileIO file(m_folderPath / gciFile.filename);
-
-    File tempFile = gciFile.file;
-    tempFile.swapEndian();
-    file.fileWrite(&tempFile, sizeof(File), 0); // update header
+    if (!gciFile.opened && persist(gciFile)) {
+      release(gciFile);
+    }
   }
 }
 
@@ -394,20 +501,23 @@ bool CardGciFolder::open(const std::filesystem::path& filepath) {
       continue;
     }
 
-    FileIO file(path);
+    auto file = io::open_file(path, "rb");
+    ++m_ioStats.opens;
     if (!file) {
       Log.warn("Failed to open GCI file '{}'", io::fs_path_to_string(path));
       return false;
     }
 
     File fileData;
-    if (!file.fileRead(&fileData, sizeof(File), 0)) {
+    ++m_ioStats.reads;
+    if (!io::read_exact(file.get(), &fileData, sizeof(File))) {
       Log.warn("Failed to read GCI file '{}'", io::fs_path_to_string(path));
       return false;
     }
     fileData.swapEndian();
+    const Sint64 fileSize = SDL_GetIOSize(file.get());
 
-    m_files.push_back({fileData, file.fileSize(), path.filename().u8string(), false});
+    m_files.push_back({fileData, fileSize > 0 ? static_cast<size_t>(fileSize) : 0, path.filename().u8string(), false});
 
     it.increment(ec);
     if (ec) {
@@ -420,6 +530,9 @@ bool CardGciFolder::open(const std::filesystem::path& filepath) {
 }
 
 void CardGciFolder::close() {
+  for (auto& gciFile : m_files) {
+    persist(gciFile);
+  }
   m_files.clear();
   m_folderPath = "";
   m_bat = BlockAllocationTable();
@@ -1,7 +1,10 @@
 #pragma once
+#include <cstdint>
 #include <filesystem>
 #include <vector>
 
+#include "../io.hpp"
+
 #include "BlockAllocationTable.hpp"
 #include "CommonData.h"
 #include "File.hpp"
@@ -10,12 +13,29 @@
 namespace aurora::card {
 
 class CardGciFolder : public ICard {
+public:
+  // File operations performed against the folder, for tests and diagnostics.
+  struct IoStats {
+    uint32_t opens = 0;
+    uint32_t reads = 0;
+    uint32_t writes = 0;
+    uint32_t replaces = 0;
+  };
+
 private:
   struct GciFile {
     File file;
     size_t fileSize;
     std::u8string filename;
     bool opened = false;
+    // Read handle kept while the file is open.
+    io::Stream stream;
+    // Contents after the header, loaded on the first write of an open session. Writes land here and are published
+    // by persist, so a save interrupted before it is closed leaves the previous file intact.
+    std::vector<uint8_t> data;
+    bool dataLoaded = false;
+    bool headerDirty = false;
+    bool dataDirty = false;
   };
 
   std::vector<GciFile> m_files;
@@ -23,6 +43,7 @@ private:
   BlockAllocationTable m_bat;
 
   EEncoding m_encoding = EEncoding::ASCII;
+  IoStats m_ioStats;
 
   char m_game[5] = {'\0'};
   char m_maker[3] = {'\0'};
@@ -31,10 +52,14 @@ private:
   const GciFile* get_file(uint32_t idx) const;
   GciFile* get_open_file(const FileHandle& fh);
   const GciFile* get_open_file(const FileHandle& fh) const;
+  bool ensure_stream(GciFile& gciFile);
+  bool load_data(GciFile& gciFile);
+  bool persist(GciFile& gciFile);
+  void release(GciFile& gciFile);
 
 public:
   CardGciFolder();
-  ~CardGciFolder() override = default;
+  ~CardGciFolder() override;
 
   CardGciFolder(const CardGciFolder& other) = delete;
   CardGciFolder& operator=(const CardGciFolder& other) = delete;
@@ -74,6 +99,8 @@ public:
   const std::filesystem::path& cardFilename() const override;
   ECardResult getError() const override;
   ProbeResults probeCardFile(const std::filesystem::path& filename) override;
+
+  const IoStats& ioStats() const noexcept { return m_ioStats; }
 };
 
 } // namespace aurora::card
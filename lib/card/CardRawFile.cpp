@@ -4,8 +4,11 @@
 #include <cstdio>
 #include <cstring>
 #include <filesystem>
+#include <functional>
 #include <memory>
 
+#include <SDL3/SDL_filesystem.h>
+
 #include "../io.hpp"
 #include "../internal.hpp"
 #include "SRAM.hpp"
@@ -28,6 +31,29 @@ bool is_supported_card_size(const uint16_t sizeMb) {
 }
 
 void null_file_access() { fprintf(stderr, "Attempted to access null file\n"); }
+
+constexpr uint32_t JournalMagic = 0x4C4E524A; // JRNL
+constexpr uint32_t JournalVersion = 1;
+
+// Followed by the sorted block indices, then the contents of each block in the same order.
+struct JournalHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t blockCount;
+  uint32_t imageBlocks;
+  uint64_t checksum;
+};
+
+// FNV-1a, fed the block indices followed by the block contents.
+constexpr uint64_t ChecksumBasis = 0xcbf29ce484222325;
+
+uint64_t update_checksum(uint64_t hash, const void* data, size_t size) {
+  const auto* bytes = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < size; ++i) {
+    hash = (hash ^ bytes[i]) * 0x100000001b3;
+  }
+  return hash;
+}
 } // namespace
 
 void CardRawFile::CardHeader::_swapEndian() {
@@ -48,7 +74,10 @@ CardRawFile::CardRawFile() { m_ch.raw.fill(0xFF); }
 CardRawFile::CardRawFile(CardRawFile&& other) {
   m_ch.raw = other.m_ch.raw;
   m_filename = std::move(other.m_filename);
-  m_fileHandle = std::move(other.m_fileHandle);
+  m_stream = std::move(other.m_stream);
+  m_image = std::move(other.m_image);
+  m_dirtyBlocks = std::move(other.m_dirtyBlocks);
+  m_blockChains = std::move(other.m_blockChains);
   m_dirs = std::move(other.m_dirs);
   m_bats = std::move(other.m_bats);
   m_currentDir = other.m_currentDir;
@@ -57,6 +86,9 @@ CardRawFile::CardRawFile(CardRawFile&& other) {
   m_maxBlock = other.m_maxBlock;
   std::copy(std::cbegin(other.m_game), std::cend(other.m_game), std::begin(m_game));
   std::copy(std::cbegin(other.m_maker), std::cend(other.m_maker), std::begin(m_maker));
+  m_dirty = other.m_dirty;
+  m_opened = other.m_opened;
+  m_ioStats = other.m_ioStats;
 }
 
 CardRawFile& CardRawFile::operator=(CardRawFile&& other) {
@@ -64,7 +96,10 @@ CardRawFile& CardRawFile::operator=(CardRawFile&& other) {
 
   m_ch.raw = other.m_ch.raw;
   m_filename = std::move(other.m_filename);
-  m_fileHandle = std::move(other.m_fileHandle);
+  m_stream = std::move(other.m_stream);
+  m_image = std::move(other.m_image);
+  m_dirtyBlocks = std::move(other.m_dirtyBlocks);
+  m_blockChains = std::move(other.m_blockChains);
   m_dirs = std::move(other.m_dirs);
   m_bats = std::move(other.m_bats);
   m_currentDir = other.m_currentDir;
@@ -73,6 +108,9 @@ CardRawFile& CardRawFile::operator=(CardRawFile&& other) {
   m_maxBlock = other.m_maxBlock;
   std::copy(std::cbegin(other.m_game), std::cend(other.m_game), std::begin(m_game));
   std::copy(std::cbegin(other.m_maker), std::cend(other.m_maker), std::begin(m_maker));
+  m_dirty = other.m_dirty;
+  m_opened = other.m_opened;
+  m_ioStats = other.m_ioStats;
 
   return *this;
 }
@@ -81,7 +119,7 @@ ECardResult CardRawFile::_pumpOpen() {
   if (m_opened)
     return ECardResult::READY;
 
-  if (!m_fileHandle)
+  if (!m_stream)
     return ECardResult::NOCARD;
 
   m_ch._swapEndian();
@@ -128,7 +166,7 @@ void CardRawFile::_repair_card() {
   const uint32_t expectedBlocks = static_cast<uint32_t>(sizeMb) * MbitToBlocks;
   const uintmax_t expectedSize = static_cast<uintmax_t>(expectedBlocks) * BlockSize;
   const uintmax_t legacySize = expectedSize - MissingBlocks * BlockSize;
-  if (m_fileHandle.fileSize() != legacySize)
+  if (m_image.size() != legacySize)
     return;
 
   if (_pumpOpen() != ECardResult::READY || getError() != ECardResult::READY) {
@@ -147,10 +185,14 @@ void CardRawFile::_repair_card() {
 
   std::array<uint8_t, MissingBlocks * BlockSize> missingBlocks;
   missingBlocks.fill(0xFF);
-  if (!m_fileHandle.fileWrite(missingBlocks.data(), missingBlocks.size(), legacySize)) {
+  ++m_ioStats.writes;
+  if (!io::write_at(m_stream.get(), legacySize, missingBlocks.data(), missingBlocks.size()) ||
+      !SDL_FlushIO(m_stream.get())) {
     Log.error("Failed to repair legacy raw card image: {}", io::fs_path_to_string(m_filename));
     return;
   }
+  m_image.insert(m_image.end(), missingBlocks.begin(), missingBlocks.end());
+  m_dirtyBlocks.resize(expectedBlocks);
 
   Log.info("Repaired legacy raw card image: {}", io::fs_path_to_string(m_filename));
 }
@@ -215,6 +257,7 @@ void CardRawFile::_updateDirAndBat(const Directory& dir, const BlockAllocationTa
   updateBat.m_updateCounter++;
   updateBat.updateChecksum();
 
+  _clearBlockChains();
   m_dirty = true;
 }
 
@@ -224,6 +267,26 @@ void CardRawFile::_updateChecksum() {
   m_ch._swapEndian();
 }
 
+const std::vector<uint16_t>& CardRawFile::_fileBlocks(uint32_t idx, const File& f) {
+  std::vector<uint16_t>& chain = m_blockChains[idx];
+  if (chain.empty()) {
+    /* Stops at the end of the chain, at an unallocated block, or after the file's block count in case the BAT loops */
+    const BlockAllocationTable& bat = m_bats[m_currentBat];
+    uint16_t block = f.m_firstBlock;
+    while (block != 0xFFFF && block >= FSTBlocks && chain.size() < f.m_blockCount) {
+      chain.push_back(block);
+      block = bat.getNextBlock(block);
+    }
+  }
+  return chain;
+}
+
+void CardRawFile::_clearBlockChains() {
+  for (auto& chain : m_blockChains) {
+    chain.clear();
+  }
+}
+
 File* CardRawFile::_fileFromHandle(const FileHandle& fh) const {
   if (!fh) {
     null_file_access();
@@ -308,12 +371,9 @@ const char* CardRawFile::getFilename(const FileHandle& fh) const {
 }
 
 void CardRawFile::_deleteFile(File& f, BlockAllocationTable& bat) {
-  uint16_t block = f.m_firstBlock;
-  while (block != 0xFFFF) {
-    /* TODO: add a fragmentation check */
-    uint16_t nextBlock = bat.getNextBlock(block);
-    bat.clear(block, 1);
-    block = nextBlock;
+  /* Frees the whole chain at once; clear() only accepts the count of blocks that follow the given one */
+  if (!bat.clear(f.m_firstBlock, f.m_blockCount)) {
+    Log.warn("Block chain does not match the file's block count; leaving it allocated");
   }
   f = File();
 }
@@ -404,36 +464,28 @@ ECardResult CardRawFile::fileWrite(FileHandle& fh, const void* buf, size_t size)
   if (!file)
     return ECardResult::NOFILE;
 
-  /* Block handling is a little different from cache handling,
-   * since each block can be in an arbitrary location we must
-   * first find our starting block.
+  /* Each block can be in an arbitrary location, so the file's cached block chain
+   * is indexed to find where each part of the write lands in the image.
    */
-  const uint16_t blockId = static_cast<uint16_t>(fh.offset / BlockSize);
-  uint16_t block = file->m_firstBlock;
-  for (uint16_t i = 0; i < blockId; i++)
-    block = m_bats[m_currentBat].getNextBlock(block);
-
+  const std::vector<uint16_t>& blocks = _fileBlocks(fh.idx, *file);
   const uint8_t* tmpBuf = static_cast<const uint8_t*>(buf);
-  uint16_t curBlock = block;
-  uint32_t blockOffset = fh.offset % BlockSize;
+  size_t chainIdx = static_cast<uint32_t>(fh.offset) / BlockSize;
+  uint32_t blockOffset = static_cast<uint32_t>(fh.offset) % BlockSize;
   size_t rem = size;
   while (rem) {
-    if (curBlock == 0xFFFF)
+    if (chainIdx >= blocks.size())
       return ECardResult::NOFILE;
-
-    size_t cacheSize = rem;
-    if (cacheSize + blockOffset > BlockSize)
-      cacheSize = BlockSize - blockOffset;
-    uint32_t offset = (curBlock * BlockSize) + blockOffset;
-    if (!m_fileHandle.fileWrite(tmpBuf, cacheSize, offset))
+    const uint16_t curBlock = blocks[chainIdx];
+    if (curBlock >= m_dirtyBlocks.size())
       return ECardResult::FATAL_ERROR;
+
+    const size_t cacheSize = std::min<size_t>(rem, BlockSize - blockOffset);
+    std::memcpy(m_image.data() + (static_cast<size_t>(curBlock) * BlockSize) + blockOffset, tmpBuf, cacheSize);
+    m_dirtyBlocks[curBlock] = true;
     tmpBuf += cacheSize;
     rem -= cacheSize;
-    blockOffset += cacheSize;
-    if (blockOffset >= BlockSize) {
-      curBlock = m_bats[m_currentBat].getNextBlock(curBlock);
-      blockOffset = 0;
-    }
+    blockOffset = 0;
+    ++chainIdx;
   }
   fh.offset += size;
 
@@ -452,36 +504,27 @@ ECardResult CardRawFile::fileRead(FileHandle& fh, void* dst, size_t size) {
   File* file = m_dirs[m_currentDir].getFile(fh.idx);
   if (!file)
     return ECardResult::NOFILE;
-  /* Block handling is a little different from cache handling,
-   * since each block can be in an arbitrary location we must
-   * first find our starting block.
+  /* Each block can be in an arbitrary location, so the file's cached block chain
+   * is indexed to find where each part of the read comes from in the image.
    */
-  const uint16_t blockId = static_cast<uint16_t>(fh.offset / BlockSize);
-  uint16_t block = file->m_firstBlock;
-  for (uint16_t i = 0; i < blockId; i++)
-    block = m_bats[m_currentBat].getNextBlock(block);
-
+  const std::vector<uint16_t>& blocks = _fileBlocks(fh.idx, *file);
   uint8_t* tmpBuf = static_cast<uint8_t*>(dst);
-  uint16_t curBlock = block;
-  uint32_t blockOffset = fh.offset % BlockSize;
+  size_t chainIdx = static_cast<uint32_t>(fh.offset) / BlockSize;
+  uint32_t blockOffset = static_cast<uint32_t>(fh.offset) % BlockSize;
   size_t rem = size;
   while (rem) {
-    if (curBlock == 0xFFFF)
+    if (chainIdx >= blocks.size())
       return ECardResult::NOFILE;
-
-    size_t cacheSize = rem;
-    if (cacheSize + blockOffset > BlockSize)
-      cacheSize = BlockSize - blockOffset;
-    uint32_t offset = (curBlock * BlockSize) + blockOffset;
-    if (!m_fileHandle.fileRead(tmpBuf, cacheSize, offset))
+    const uint16_t curBlock = blocks[chainIdx];
+    if (curBlock >= m_dirtyBlocks.size())
       return ECardResult::FATAL_ERROR;
+
+    const size_t cacheSize = std::min<size_t>(rem, BlockSize - blockOffset);
+    std::memcpy(tmpBuf, m_image.data() + (static_cast<size_t>(curBlock) * BlockSize) + blockOffset, cacheSize);
     tmpBuf += cacheSize;
     rem -= cacheSize;
-    blockOffset += cacheSize;
-    if (blockOffset >= BlockSize) {
-      curBlock = m_bats[m_currentBat].getNextBlock(curBlock);
-      blockOffset = 0;
-    }
+    blockOffset = 0;
+    ++chainIdx;
   }
   fh.offset += size;
 
@@ -815,32 +858,25 @@ void CardRawFile::format(ECardSlot id, ECardSize size, EEncoding encoding) {
   m_currentDir = 1;
   m_currentBat = 1;
 
-  m_fileHandle = {};
-  m_fileHandle = FileIO(m_filename, true);
-
-  if (m_fileHandle) {
-    const uint32_t blockCount = (static_cast<uint32_t>(size) * MbitToBlocks) - 5;
-
-    m_tmpCh = m_ch;
-    m_tmpCh._swapEndian();
-    m_fileHandle.fileWrite(m_tmpCh.raw.data(), BlockSize, 0);
-    m_tmpDirs[0] = m_dirs[0];
-    m_tmpDirs[0].swapEndian();
-    m_fileHandle.fileWrite(m_tmpDirs[0].raw.data(), BlockSize, BlockSize * 1);
-    m_tmpDirs[1] = m_dirs[1];
-    m_tmpDirs[1].swapEndian();
-    m_fileHandle.fileWrite(m_tmpDirs[1].raw.data(), BlockSize, BlockSize * 2);
-    m_tmpBats[0] = m_bats[0];
-    m_tmpBats[0].swapEndian();
-    m_fileHandle.fileWrite(m_tmpBats[0].raw.data(), BlockSize, BlockSize * 3);
-    m_tmpBats[1] = m_bats[1];
-    m_tmpBats[1].swapEndian();
-    m_fileHandle.fileWrite(m_tmpBats[1].raw.data(), BlockSize, BlockSize * 4);
-
-    std::unique_ptr<uint8_t[]> dummyBlock;
-    dummyBlock.reset(new uint8_t[BlockSize * blockCount]);
-    memset(dummyBlock.get(), 0xFF, BlockSize * blockCount);
-    m_fileHandle.fileWrite(dummyBlock.get(), BlockSize * blockCount, BlockSize * FSTBlocks);
+  _clearBlockChains();
+
+  m_stream.reset();
+  m_stream = io::open_file(m_filename, "w+b");
+
+  if (m_stream) {
+    const uint32_t blockCount = static_cast<uint32_t>(size) * MbitToBlocks;
+    m_image.assign(static_cast<size_t>(blockCount) * BlockSize, 0xFF);
+    m_dirtyBlocks.assign(blockCount, false);
+    _stageMetadata();
+
+    ++m_ioStats.writes;
+    if (io::write_at(m_stream.get(), 0, m_image.data(), m_image.size()) && SDL_FlushIO(m_stream.get())) {
+      m_dirtyBlocks.assign(blockCount, false);
+    } else {
+      Log.error("Failed to format raw card image: {}", io::fs_path_to_string(m_filename));
+    }
+    /* A journal left behind belongs to the previous image */
+    _removeJournal();
     m_dirty = false;
   }
 }
@@ -853,63 +889,229 @@ ProbeResults CardRawFile::probeCardFile(const std::filesystem::path& filename) {
 }
 
 void CardRawFile::commit() {
-  if (!m_dirty)
+  if (!m_stream) {
     return;
-  if (m_fileHandle) {
-    m_tmpCh = m_ch;
-    m_tmpCh._swapEndian();
-    m_fileHandle.fileWrite(&m_tmpCh, BlockSize, 0);
-    m_tmpDirs[0] = m_dirs[0];
-    m_tmpDirs[0].updateChecksum();
-    m_tmpDirs[0].swapEndian();
-    m_fileHandle.fileWrite(m_tmpDirs[0].raw.data(), BlockSize, BlockSize * 1);
-    m_tmpDirs[1] = m_dirs[1];
-    m_tmpDirs[1].updateChecksum();
-    m_tmpDirs[1].swapEndian();
-    m_fileHandle.fileWrite(m_tmpDirs[1].raw.data(), BlockSize, BlockSize * 2);
-    m_tmpBats[0] = m_bats[0];
-    m_tmpBats[0].updateChecksum();
-    m_tmpBats[0].swapEndian();
-    m_fileHandle.fileWrite(m_tmpBats[0].raw.data(), BlockSize, BlockSize * 3);
-    m_tmpBats[1] = m_bats[1];
-    m_tmpBats[1].updateChecksum();
-    m_tmpBats[1].swapEndian();
-    m_fileHandle.fileWrite(m_tmpBats[1].raw.data(), BlockSize, BlockSize * 4);
+  }
+  if (m_dirty) {
+    _stageMetadata();
     m_dirty = false;
   }
+
+  std::vector<uint16_t> blocks;
+  for (size_t block = 0; block < m_dirtyBlocks.size(); ++block) {
+    if (m_dirtyBlocks[block]) {
+      blocks.push_back(static_cast<uint16_t>(block));
+    }
+  }
+  if (blocks.empty()) {
+    return;
+  }
+
+  /* Once the journal is in place the commit survives an interruption, since open() replays it */
+  if (!_writeJournal(blocks)) {
+    Log.error("Failed to write raw card journal: {}", io::fs_path_to_string(_journalPath()));
+    return;
+  }
+  if (!_writeBlocks(blocks)) {
+    Log.error("Failed to write raw card image: {}", io::fs_path_to_string(m_filename));
+    return;
+  }
+  for (const uint16_t block : blocks) {
+    m_dirtyBlocks[block] = false;
+  }
+  _writeStep(WriteStep::RemoveJournal, 0, [this](size_t) {
+    _removeJournal();
+    return true;
+  });
+}
+
+void CardRawFile::_stageMetadata() {
+  m_tmpCh = m_ch;
+  m_tmpCh._swapEndian();
+  _stageBlock(0, m_tmpCh.raw.data());
+  for (uint32_t i = 0; i < m_dirs.size(); ++i) {
+    m_tmpDirs[i] = m_dirs[i];
+    m_tmpDirs[i].updateChecksum();
+    m_tmpDirs[i].swapEndian();
+    _stageBlock(1 + i, m_tmpDirs[i].raw.data());
+  }
+  for (uint32_t i = 0; i < m_bats.size(); ++i) {
+    m_tmpBats[i] = m_bats[i];
+    m_tmpBats[i].updateChecksum();
+    m_tmpBats[i].swapEndian();
+    _stageBlock(3 + i, m_tmpBats[i].raw.data());
+  }
+}
+
+void CardRawFile::_stageBlock(uint32_t block, const uint8_t* data) {
+  /* Metadata blocks that serialize to what is already on disk are not rewritten */
+  uint8_t* const dst = m_image.data() + static_cast<size_t>(block) * BlockSize;
+  if (std::memcmp(dst, data, BlockSize) != 0) {
+    std::memcpy(dst, data, BlockSize);
+    m_dirtyBlocks[block] = true;
+  }
+}
+
+std::filesystem::path CardRawFile::_journalPath() const {
+  auto path = m_filename;
+  path += ".journal";
+  return path;
+}
+
+bool CardRawFile::_writeJournal(std::span<const uint16_t> blocks) {
+  uint64_t checksum = update_checksum(ChecksumBasis, blocks.data(), blocks.size_bytes());
+  for (const uint16_t block : blocks) {
+    checksum = update_checksum(checksum, m_image.data() + static_cast<size_t>(block) * BlockSize, BlockSize);
+  }
+  const JournalHeader header{
+      .magic = JournalMagic,
+      .version = JournalVersion,
+      .blockCount = static_cast<uint32_t>(blocks.size()),
+      .imageBlocks = static_cast<uint32_t>(m_dirtyBlocks.size()),
+      .checksum = checksum,
+  };
+
+  auto journal = io::open_atomic_file(_journalPath());
+  if (!journal) {
+    return false;
+  }
+  bool ok = io::write_exact(journal.get(), &header, sizeof(header)) &&
+            io::write_exact(journal.get(), blocks.data(), blocks.size_bytes());
+  for (size_t i = 0; ok && i < blocks.size(); ++i) {
+    ok = io::write_exact(journal.get(), m_image.data() + static_cast<size_t>(blocks[i]) * BlockSize, BlockSize);
+  }
+  if (!ok) {
+    return false;
+  }
+  ++m_ioStats.journals;
+  /* Until it is renamed into place the journal does not exist as far as open() is concerned */
+  return _writeStep(WriteStep::Journal, 0, [&journal](size_t) { return journal.commit(); });
+}
+
+bool CardRawFile::_writeBlocks(std::span<const uint16_t> blocks) {
+  /* blocks is sorted, so each run of consecutive blocks goes out as a single write in image order */
+  for (size_t first = 0; first < blocks.size();) {
+    size_t last = first + 1;
+    while (last < blocks.size() && blocks[last] == blocks[last - 1] + 1) {
+      ++last;
+    }
+    const size_t offset = static_cast<size_t>(blocks[first]) * BlockSize;
+    ++m_ioStats.writes;
+    const bool written = _writeStep(WriteStep::Blocks, (last - first) * BlockSize, [&](size_t size) {
+      return io::write_at(m_stream.get(), offset, m_image.data() + offset, size);
+    });
+    if (!written) {
+      return false;
+    }
+    first = last;
+  }
+  return SDL_FlushIO(m_stream.get());
+}
+
+void CardRawFile::_removeJournal() {
+  const auto path = io::fs_path_to_string(_journalPath());
+  SDL_RemovePath(path.c_str());
+}
+
+bool CardRawFile::_replayJournal() {
+  const auto journalPath = _journalPath();
+  std::error_code ec;
+  if (!std::filesystem::exists(journalPath, ec)) {
+    return true;
+  }
+  const auto journal = io::read_file(journalPath);
+
+  JournalHeader header{};
+  std::vector<uint16_t> blocks;
+  bool valid = journal && journal->size() >= sizeof(header);
+  if (valid) {
+    std::memcpy(&header, journal->data(), sizeof(header));
+    valid = header.magic == JournalMagic && header.version == JournalVersion &&
+            header.imageBlocks == m_dirtyBlocks.size() &&
+            journal->size() == sizeof(header) + header.blockCount * (sizeof(uint16_t) + size_t{BlockSize});
+  }
+  if (valid) {
+    blocks.resize(header.blockCount);
+    std::memcpy(blocks.data(), journal->data() + sizeof(header), blocks.size() * sizeof(uint16_t));
+    const uint8_t* const data = journal->data() + sizeof(header) + blocks.size() * sizeof(uint16_t);
+    valid = update_checksum(update_checksum(ChecksumBasis, blocks.data(), blocks.size() * sizeof(uint16_t)), data,
+                            blocks.size() * BlockSize) == header.checksum &&
+            std::ranges::adjacent_find(blocks, std::greater_equal{}) == blocks.end() &&
+            (blocks.empty() || blocks.back() < header.imageBlocks);
+    for (size_t i = 0; valid && i < blocks.size(); ++i) {
+      std::memcpy(m_image.data() + static_cast<size_t>(blocks[i]) * BlockSize, data + i * BlockSize, BlockSize);
+    }
+  }
+
+  if (!valid) {
+    Log.warn("Discarding incomplete raw card journal: {}", io::fs_path_to_string(journalPath));
+    _removeJournal();
+    return true;
+  }
+  if (!_writeBlocks(blocks)) {
+    Log.error("Failed to replay raw card journal: {}", io::fs_path_to_string(journalPath));
+    return false;
+  }
+  Log.info("Replayed raw card journal: {}", io::fs_path_to_string(journalPath));
+  _removeJournal();
+  return true;
+}
+
+bool CardRawFile::_writeStep(WriteStep step, size_t size, const std::function<bool(size_t)>& write) {
+  return m_writeHook ? m_writeHook(step, size, write) : write(size);
 }
 
 bool CardRawFile::open(const std::filesystem::path& filepath) {
   m_opened = false;
+  m_dirty = false;
   m_filename = filepath;
-  m_fileHandle = FileIO(m_filename);
-  if (m_fileHandle) {
-    if (!m_fileHandle.fileRead(m_ch.raw.data(), BlockSize, 0))
-      return false;
-    if (!m_fileHandle.fileRead(m_dirs[0].raw.data(), BlockSize, BlockSize * 1))
-      return false;
-    if (!m_fileHandle.fileRead(m_dirs[1].raw.data(), BlockSize, BlockSize * 2))
-      return false;
-    if (!m_fileHandle.fileRead(m_bats[0].raw.data(), BlockSize, BlockSize * 3))
-      return false;
-    if (!m_fileHandle.fileRead(m_bats[1].raw.data(), BlockSize, BlockSize * 4))
-      return false;
-    _repair_card();
-    return true;
+  m_image.clear();
+  m_dirtyBlocks.clear();
+  _clearBlockChains();
+
+  m_stream = io::open_file(m_filename, "r+b");
+  if (!m_stream)
+    return false;
+  const Sint64 size = SDL_GetIOSize(m_stream.get());
+  if (size < static_cast<Sint64>(FSTBlocks * BlockSize)) {
+    m_stream.reset();
+    return false;
   }
-  return false;
+
+  m_image.resize(static_cast<size_t>(size));
+  ++m_ioStats.reads;
+  if (!io::read_at(m_stream.get(), 0, m_image.data(), m_image.size())) {
+    m_stream.reset();
+    return false;
+  }
+  m_dirtyBlocks.assign(m_image.size() / BlockSize, false);
+  if (!_replayJournal()) {
+    m_stream.reset();
+    return false;
+  }
+
+  std::memcpy(m_ch.raw.data(), m_image.data(), BlockSize);
+  std::memcpy(m_dirs[0].raw.data(), m_image.data() + BlockSize * 1, BlockSize);
+  std::memcpy(m_dirs[1].raw.data(), m_image.data() + BlockSize * 2, BlockSize);
+  std::memcpy(m_bats[0].raw.data(), m_image.data() + BlockSize * 3, BlockSize);
+  std::memcpy(m_bats[1].raw.data(), m_image.data() + BlockSize * 4, BlockSize);
+  _repair_card();
+  return true;
 }
 
 void CardRawFile::close() {
   m_opened = false;
-  if (m_fileHandle) {
+  if (m_stream) {
     commit();
-    m_fileHandle = {};
+    m_stream.reset();
   }
+  m_image = {};
+  m_dirtyBlocks = {};
+  _clearBlockChains();
 }
 
 ECardResult CardRawFile::getError() const {
-  if (!m_fileHandle)
+  if (!m_stream)
     return ECardResult::NOCARD;
 
   ECardResult openRes = const_cast<CardRawFile*>(this)->_pumpOpen();
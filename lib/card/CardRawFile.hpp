@@ -2,9 +2,13 @@
 
 #include <array>
 #include <cstdint>
+#include <functional>
+#include <span>
 #include <string>
+#include <vector>
+
+#include "../io.hpp"
 
-#include "FileIO.hpp"
 #include "BlockAllocationTable.hpp"
 #include "Directory.hpp"
 #include "File.hpp"
@@ -16,6 +20,26 @@
 namespace aurora::card {
 
 class CardRawFile : public ICard {
+public:
+  // Operations performed against the card image, for tests and diagnostics.
+  struct IoStats {
+    uint32_t reads = 0;
+    uint32_t writes = 0;
+    uint32_t journals = 0;
+  };
+
+  // The steps of a commit that reach the disk, in order: publishing the journal, one write per run of blocks, and
+  // removing the journal.
+  enum class WriteStep {
+    Journal,
+    Blocks,
+    RemoveJournal,
+  };
+  // Performs a write step by calling `write` with the number of bytes to write, out of `size`, and returns whether
+  // the step completed. Steps without data have a size of 0.
+  using WriteHook = std::function<bool(WriteStep step, size_t size, const std::function<bool(size_t)>& write)>;
+
+private:
 #pragma pack(push, 4)
   struct CardHeader {
     union {
@@ -43,7 +67,12 @@ class CardRawFile : public ICard {
   CardHeader m_tmpCh;
 
   std::filesystem::path m_filename;
-  FileIO m_fileHandle;
+  io::Stream m_stream;
+  // The whole card image. Reads are served from here; writes land here and reach the disk on commit.
+  std::vector<uint8_t> m_image;
+  std::vector<bool> m_dirtyBlocks;
+  // Block chain of each file in the current BAT, built on first access. Empty when not cached.
+  std::array<std::vector<uint16_t>, MaxFiles> m_blockChains;
   std::array<Directory, 2> m_dirs;
   std::array<BlockAllocationTable, 2> m_bats;
   std::array<Directory, 2> m_tmpDirs;
@@ -60,9 +89,21 @@ class CardRawFile : public ICard {
   void _repair_card();
   File* _fileFromHandle(const FileHandle& fh) const;
   void _deleteFile(File& f, BlockAllocationTable& bat);
+  const std::vector<uint16_t>& _fileBlocks(uint32_t idx, const File& f);
+  void _clearBlockChains();
+  void _stageMetadata();
+  void _stageBlock(uint32_t block, const uint8_t* data);
+  std::filesystem::path _journalPath() const;
+  bool _writeJournal(std::span<const uint16_t> blocks);
+  bool _writeBlocks(std::span<const uint16_t> blocks);
+  void _removeJournal();
+  bool _replayJournal();
+  bool _writeStep(WriteStep step, size_t size, const std::function<bool(size_t)>& write);
 
   bool m_dirty = false;
   bool m_opened = false;
+  IoStats m_ioStats;
+  WriteHook m_writeHook;
   ECardResult _pumpOpen();
 
 public:
@@ -403,6 +444,8 @@ public:
 
   /**
    * @brief Writes any changes to the Card instance immediately to disk. <br />
+   * Changed blocks are first recorded in a journal next to the image, so an interrupted commit is either
+   * completed or discarded the next time the card is opened. <br />
    * <b>Note:</b> <i>Under normal circumstances there is no need to call this function.</i>
    */
   void commit() override;
@@ -435,5 +478,12 @@ public:
    * @return Whether or not the card is within a ready state.
    */
   explicit operator bool() const { return getError() == ECardResult::READY; }
+
+  const IoStats& ioStats() const noexcept { return m_ioStats; }
+
+  /**
+   * @brief Routes commit write steps through a hook, for tests that interrupt or tear them.
+   */
+  void setWriteHook(WriteHook hook) { m_writeHook = std::move(hook); }
 };
 } // namespace aurora::card
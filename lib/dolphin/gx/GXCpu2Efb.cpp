@@ -18,3 +18,21 @@ void GXPeekZ(u16 x, u16 y, u32* z) {
 
   GX_WRITE_AURORA(GX_AURORA_REQUEST_DEPTH_SNAPSHOT);
 }
+
+void GXPeekZPoints(const GXPeekZPoint* points, u32 count, u32* z) {
+  if (points != nullptr && z != nullptr) {
+    aurora::gfx::depth_peek::read_points({points, count}, {z, count});
+  }
+
+  GX_WRITE_AURORA(GX_AURORA_REQUEST_DEPTH_SNAPSHOT);
+}
+
+void GXPeekZRect(u16 x, u16 y, u16 width, u16 height, u32* z) {
+  if (z != nullptr) {
+    aurora::gfx::depth_peek::read_rect(x, y, width, height, {z, static_cast<size_t>(width) * height});
+  }
+
+  GX_WRITE_AURORA(GX_AURORA_REQUEST_DEPTH_SNAPSHOT);
+}
+
+void GXSetPeekZDivisor(u32 divisor) { aurora::gfx::depth_peek::set_divisor(divisor); }
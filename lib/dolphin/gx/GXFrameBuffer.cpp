@@ -7,6 +7,7 @@
 #include "../../window.hpp"
 #include "../../gfx/clear.hpp"
 #include "../../webgpu/gpu.hpp"
+#include "../../gx/perf.hpp"
 #include "../../gx/texture.hpp"
 #include "../vi/vi_internal.hpp"
 
@@ -80,6 +81,8 @@ void copy_tex(const void* dest, GXBool clear) noexcept {
   gfx::resolve_pass_into(handle.handle, rect, clearColor, clearAlpha, clearDepth, g_gxState.clearColor,
                          clear_depth_value(), texCopyFmt);
   ++handle.revision;
+  perf::add(perf::Counter::EfbCopies);
+  perf::add(perf::Counter::EfbCopyPixels, static_cast<uint64_t>(dstWidth) * dstHeight);
   g_gxState.copyTextures[dest] = handle;
   texture::invalidate_bindings();
 }
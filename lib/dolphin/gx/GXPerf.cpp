@@ -1,20 +1,237 @@
 #include "gx.hpp"
 
+#include "../../gx/perf.hpp"
+
+#include <dolphin/gx/GXPerf.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <numeric>
+
+// Metrics are backed by the counters the command processor maintains (see gx/perf.hpp). Counters only ever increase;
+// the Clear functions record a baseline and reads report the difference. Hardware metrics with no host equivalent
+// (XF stalls, pixel engine quads, etc.) read as zero.
+
+namespace {
+using aurora::gx::perf::Counter;
+using aurora::gx::perf::Snapshot;
+using Clock = std::chrono::steady_clock;
+
+// GP clock rate of the original hardware, used to express host time in GP clocks.
+constexpr uint64_t GpClockHz = 162'000'000;
+// Size of a CP/TC memory request in bytes.
+constexpr uint64_t MemRequestSize = 32;
+
+struct Baseline {
+  Snapshot counters;
+  Clock::time_point time = Clock::now();
+};
+
+struct Delta {
+  Snapshot counters;
+  uint64_t clocks = 0;
+
+  [[nodiscard]] uint64_t operator[](Counter counter) const noexcept { return counters[counter]; }
+  [[nodiscard]] uint64_t vcache_misses() const noexcept {
+    return std::accumulate(counters.attrMisses.begin(), counters.attrMisses.end(), uint64_t{0});
+  }
+};
+
+GXPerf0 s_perf0 = GX_PERF0_NONE;
+GXPerf1 s_perf1 = GX_PERF1_NONE;
+GXVCachePerf s_vcacheAttr = GX_VC_ALL;
+Baseline s_gpBase;
+Baseline s_memBase;
+Baseline s_pixBase;
+Baseline s_vcacheBase;
+Baseline s_xfRasBase;
+
+Baseline capture() noexcept { return {aurora::gx::perf::snapshot(), Clock::now()}; }
+
+Delta since(const Baseline& base) noexcept {
+  const auto now = capture();
+  Delta delta;
+  for (size_t i = 0; i < delta.counters.counters.size(); ++i) {
+    delta.counters.counters[i] = now.counters.counters[i] - base.counters.counters[i];
+  }
+  for (size_t i = 0; i < aurora::gx::perf::VertexCacheAttrCount; ++i) {
+    delta.counters.attrChecks[i] = now.counters.attrChecks[i] - base.counters.attrChecks[i];
+    delta.counters.attrMisses[i] = now.counters.attrMisses[i] - base.counters.attrMisses[i];
+  }
+  const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time - base.time).count();
+  delta.clocks = static_cast<uint64_t>(std::max<int64_t>(elapsed, 0)) * (GpClockHz / 1'000'000) / 1'000;
+  return delta;
+}
+
+u32 saturate(uint64_t value) noexcept { return static_cast<u32>(std::min<uint64_t>(value, UINT32_MAX)); }
+
+uint64_t perf0_value(GXPerf0 metric, const Delta& delta) noexcept {
+  switch (metric) {
+  case GX_PERF0_VERTICES:
+    return delta[Counter::Vertices];
+  case GX_PERF0_TRIANGLES:
+  // Culling and scissoring happen on the host GPU, so every submitted triangle is reported as passed.
+  case GX_PERF0_TRIANGLES_PASSED:
+    return delta.counters.triangles();
+  case GX_PERF0_CLOCKS:
+    return delta.clocks;
+  default:
+    return 0;
+  }
+}
+
+uint64_t perf1_value(GXPerf1 metric, const Delta& delta) noexcept {
+  switch (metric) {
+  case GX_PERF1_VERTICES:
+    return delta[Counter::Vertices];
+  case GX_PERF1_TC_CHECK1_2:
+    return delta[Counter::TextureCacheHits] + delta[Counter::TextureCacheMisses];
+  case GX_PERF1_TC_MISS:
+    return delta[Counter::TextureCacheMisses];
+  case GX_PERF1_VC_MISS_REQ:
+    return delta.vcache_misses();
+  case GX_PERF1_FIFO_REQ:
+    return delta[Counter::FifoBytes] / MemRequestSize;
+  case GX_PERF1_CP_ALL_REQ:
+    return delta[Counter::FifoBytes] / MemRequestSize + delta.vcache_misses();
+  case GX_PERF1_CLOCKS:
+    return delta.clocks;
+  default:
+    return 0;
+  }
+}
+
+// Adding a counter means adding a field to GXAuroraPerfCounters as well.
+static_assert(static_cast<size_t>(Counter::Count) == 24);
+static_assert(std::size(GXAuroraPerfCounters{}.attrUploads) == aurora::gx::perf::VertexCacheAttrCount);
+
+void store(u32* out, uint64_t value) noexcept {
+  if (out != nullptr) {
+    *out = saturate(value);
+  }
+}
+} // namespace
+
 extern "C" {
 
-// TODO GXSetGPMetric
-// TODO GXClearGPMetric
-// TODO GXReadGPMetric
-// TODO GXReadGP0Metric
-// TODO GXReadGP1Metric
-// TODO GXReadMemMetric
-// TODO GXClearMemMetric
-// TODO GXReadPixMetric
-// TODO GXClearPixMetric
-// TODO GXSetVCacheMetric
-// TODO GXReadVCacheMetric
-// TODO GXClearVCacheMetric
-// TODO GXReadXfRasMetric
-// TODO GXInitXfRasMetric
-// TODO GXReadClksPerVtx
-}
\ No newline at end of file
+void GXSetGPMetric(GXPerf0 perf0, GXPerf1 perf1) {
+  s_perf0 = perf0;
+  s_perf1 = perf1;
+}
+
+void GXClearGPMetric(void) { s_gpBase = capture(); }
+
+void GXReadGPMetric(u32* cnt0, u32* cnt1) {
+  const auto delta = since(s_gpBase);
+  store(cnt0, perf0_value(s_perf0, delta));
+  store(cnt1, perf1_value(s_perf1, delta));
+}
+
+u32 GXReadGP0Metric(void) { return saturate(perf0_value(s_perf0, since(s_gpBase))); }
+
+u32 GXReadGP1Metric(void) { return saturate(perf1_value(s_perf1, since(s_gpBase))); }
+
+void GXReadMemMetric(u32* cp_req, u32* tc_req, u32* cpu_rd_req, u32* cpu_wr_req, u32* dsp_req, u32* io_req,
+                     u32* vi_req, u32* pe_req, u32* rf_req, u32* fi_req) {
+  const auto delta = since(s_memBase);
+  store(cp_req, (delta[Counter::FifoBytes] + delta[Counter::VertexBytes] + delta[Counter::IndexBytes]) /
+                    MemRequestSize);
+  store(tc_req, delta[Counter::TextureBytes] / MemRequestSize);
+  store(cpu_rd_req, 0);
+  store(cpu_wr_req, 0);
+  store(dsp_req, 0);
+  store(io_req, 0);
+  store(vi_req, 0);
+  store(pe_req, delta[Counter::EfbCopies]);
+  store(rf_req, 0);
+  store(fi_req, 0);
+}
+
+void GXClearMemMetric(void) { s_memBase = capture(); }
+
+void GXReadPixMetric(u32* top_pixels_in, u32* top_pixels_out, u32* bot_pixels_in, u32* bot_pixels_out,
+                     u32* clr_pixels_in, u32* copy_clks) {
+  const auto delta = since(s_pixBase);
+  store(top_pixels_in, 0);
+  store(top_pixels_out, 0);
+  store(bot_pixels_in, 0);
+  store(bot_pixels_out, 0);
+  store(clr_pixels_in, 0);
+  // EFB copies are charged one clock per destination pixel.
+  store(copy_clks, delta[Counter::EfbCopyPixels]);
+}
+
+void GXClearPixMetric(void) { s_pixBase = capture(); }
+
+void GXSetVCacheMetric(GXVCachePerf attr) { s_vcacheAttr = attr; }
+
+void GXReadVCacheMetric(u32* check, u32* miss, u32* stall) {
+  const auto delta = since(s_vcacheBase);
+  uint64_t checks = 0;
+  uint64_t misses = 0;
+  if (s_vcacheAttr == GX_VC_ALL) {
+    checks = std::accumulate(delta.counters.attrChecks.begin(), delta.counters.attrChecks.end(), uint64_t{0});
+    misses = delta.vcache_misses();
+  } else if (static_cast<size_t>(s_vcacheAttr) < aurora::gx::perf::VertexCacheAttrCount) {
+    checks = delta.counters.attrChecks[s_vcacheAttr];
+    misses = delta.counters.attrMisses[s_vcacheAttr];
+  }
+  store(check, checks);
+  store(miss, misses);
+  store(stall, 0);
+}
+
+void GXClearVCacheMetric(void) { s_vcacheBase = capture(); }
+
+void GXReadXfRasMetric(u32* xf_wait_in, u32* xf_wait_out, u32* ras_busy, u32* clocks) {
+  const auto delta = since(s_xfRasBase);
+  store(xf_wait_in, 0);
+  store(xf_wait_out, 0);
+  store(ras_busy, 0);
+  store(clocks, delta.clocks);
+}
+
+void GXInitXfRasMetric(void) { s_xfRasBase = capture(); }
+
+u32 GXReadClksPerVtx(void) {
+  const auto delta = since(s_gpBase);
+  const uint64_t vertices = delta[Counter::Vertices];
+  return vertices == 0 ? 0 : saturate(delta.clocks / vertices);
+}
+
+void GXAuroraReadPerfCounters(GXAuroraPerfCounters* out) {
+  if (out == nullptr) {
+    return;
+  }
+  const auto counters = aurora::gx::perf::snapshot();
+  *out = {
+      .fifoBytes = counters[Counter::FifoBytes],
+      .commands = counters[Counter::Commands],
+      .vertices = counters[Counter::Vertices],
+      .quads = counters[Counter::Quads],
+      .triangles = counters[Counter::Triangles],
+      .triangleStripTris = counters[Counter::TriangleStripTris],
+      .triangleFanTris = counters[Counter::TriangleFanTris],
+      .lines = counters[Counter::Lines],
+      .lineStripLines = counters[Counter::LineStripLines],
+      .points = counters[Counter::Points],
+      .drawsSubmitted = counters[Counter::DrawsSubmitted],
+      .drawsMerged = counters[Counter::DrawsMerged],
+      .drawsInstanced = counters[Counter::DrawsInstanced],
+      .vertexBytes = counters[Counter::VertexBytes],
+      .indexBytes = counters[Counter::IndexBytes],
+      .uniformBytes = counters[Counter::UniformBytes],
+      .storageBytes = counters[Counter::StorageBytes],
+      .textureBytes = counters[Counter::TextureBytes],
+      .textureCacheHits = counters[Counter::TextureCacheHits],
+      .textureCacheMisses = counters[Counter::TextureCacheMisses],
+      .pipelineLookups = counters[Counter::PipelineLookups],
+      .pipelineMisses = counters[Counter::PipelineMisses],
+      .efbCopies = counters[Counter::EfbCopies],
+      .efbCopyPixels = counters[Counter::EfbCopyPixels],
+  };
+  std::copy(counters.attrChecks.begin(), counters.attrChecks.end(), out->attrFetches);
+  std::copy(counters.attrMisses.begin(), counters.attrMisses.end(), out->attrUploads);
+}
+}
@@ -2,15 +2,22 @@
 #include "../../device.hpp"
 #include "../../internal.hpp"
 #include "../../io.hpp"
+#include "pad_sampler.hpp"
 #include <dolphin/pad.h>
 #include <dolphin/si.h>
 #include <SDL3/SDL_mouse.h>
+#include <SDL3/SDL_timer.h>
 
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <filesystem>
 #include <limits>
+#include <mutex>
 #include <ranges>
 #include <sys/stat.h>
+#include <thread>
 
 namespace {
 constexpr aurora::Module Log{"aurora::input"};
@@ -299,6 +306,11 @@ std::array<PADButton, PAD_CHANMAX> g_suppressedButtons{};
 std::array<bool, PAD_CHANMAX> g_suppressLeftTrigger{};
 std::array<bool, PAD_CHANMAX> g_suppressRightTrigger{};
 
+// Gamepad each port was last read from, published by PADRead for the sampler thread. 0 when the port has none.
+std::array<std::atomic<SDL_JoystickID>, PAD_CHANMAX> g_sampledDevices{};
+std::array<aurora::pad::SampleHistory, PAD_CHANMAX> g_sampleHistories;
+std::atomic_uint32_t g_samplingRate{0};
+
 bool is_mouse_scancode(const s32 scancode) { return scancode < PAD_KEY_INVALID; }
 bool is_mouse_button_pressed(const s32 scancode) {
   const int32_t buttonNum = -(scancode + 1);
@@ -630,8 +642,109 @@ static void EnsureMappingLoaded(aurora::input::GameController* controller) {
   }
 }
 
+static_assert(SDL_GAMEPAD_BUTTON_COUNT <= 32);
+static_assert(SDL_GAMEPAD_AXIS_COUNT == aurora::pad::NativeAxisCount);
+static_assert(SDL_GAMEPAD_AXIS_LEFT_TRIGGER == aurora::pad::LeftTriggerAxis);
+static_assert(SDL_GAMEPAD_AXIS_RIGHT_TRIGGER == aurora::pad::RightTriggerAxis);
+
+static aurora::pad::NativeSample read_native_sample(SDL_Gamepad* gamepad, const uint64_t timestampNs) {
+  aurora::pad::NativeSample sample{.timestampNs = timestampNs};
+  for (int button = 0; button < SDL_GAMEPAD_BUTTON_COUNT; ++button) {
+    if (SDL_GetGamepadButton(gamepad, static_cast<SDL_GamepadButton>(button))) {
+      sample.buttons |= 1u << button;
+    }
+  }
+  for (size_t axis = 0; axis < sample.axes.size(); ++axis) {
+    sample.axes[axis] = SDL_GetGamepadAxis(gamepad, static_cast<SDL_GamepadAxis>(axis));
+  }
+  return sample;
+}
+
+namespace {
+// Polls every port's gamepad at a fixed rate into g_sampleHistories, so PADRead sees presses and releases that
+// happened between two game frames. Keyboard and mouse state is only updated by the event pump on the main thread,
+// so those are still read directly by PADRead.
+class InputSampler {
+public:
+  ~InputSampler() { stop(); }
+
+  void start(const u32 hz) {
+    stop();
+    std::lock_guard lock{m_mutex};
+    m_stop = false;
+    const auto period = std::chrono::nanoseconds{std::chrono::seconds{1}} / hz;
+    m_thread = std::thread([this, period] { run(period); });
+  }
+
+  void stop() {
+    {
+      std::lock_guard lock{m_mutex};
+      if (!m_thread.joinable()) {
+        return;
+      }
+      m_stop = true;
+    }
+    m_cv.notify_all();
+    m_thread.join();
+  }
+
+private:
+  void run(const std::chrono::nanoseconds period) {
+    auto next = std::chrono::steady_clock::now();
+    while (true) {
+      next += period;
+      {
+        std::unique_lock lock{m_mutex};
+        if (m_cv.wait_until(lock, next, [this] { return m_stop; })) {
+          return;
+        }
+      }
+      // Don't try to catch up after a stall; the samples would all carry the same state.
+      next = std::max(next, std::chrono::steady_clock::now() - period);
+
+      SDL_UpdateGamepads();
+      SDL_LockJoysticks();
+      const uint64_t now = SDL_GetTicksNS();
+      for (u32 port = 0; port < PAD_CHANMAX; ++port) {
+        const SDL_JoystickID device = g_sampledDevices[port].load(std::memory_order_acquire);
+        if (device == 0) {
+          continue;
+        }
+        if (SDL_Gamepad* gamepad = SDL_GetGamepadFromID(device)) {
+          g_sampleHistories[port].push(device, read_native_sample(gamepad, now));
+        }
+      }
+      SDL_UnlockJoysticks();
+    }
+  }
+
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::thread m_thread;
+  bool m_stop = false;
+};
+
+InputSampler g_inputSampler;
+} // namespace
+
+// Returns the state PADRead should use for the controller on `port`: the aggregate of everything sampled since the
+// last read when the sampler is running, otherwise the gamepad's current state.
+static aurora::pad::NativeSample sample_controller(const u32 port,
+                                                   const aurora::input::GameController* controller) {
+  const SDL_JoystickID device = SDL_GetGamepadID(controller->m_controller);
+  if (g_sampledDevices[port].exchange(device, std::memory_order_acq_rel) != device) {
+    g_sampleHistories[port].reset(device);
+  }
+  const uint64_t now = SDL_GetTicksNS();
+  aurora::pad::NativeSample sample;
+  if (g_samplingRate.load(std::memory_order_relaxed) != 0 && g_sampleHistories[port].consume(now, sample)) {
+    return sample;
+  }
+  return read_native_sample(controller->m_controller, now);
+}
+
 static Sint16 _get_axis_value(const aurora::input::GameController* controller, //  NOLINT(*-reserved-identifier)
-                              PADAxis axis) {
+                              const aurora::pad::NativeSample& sample, PADAxis axis) {
   const auto iter =
       std::ranges::find_if(controller->m_axisMapping, [axis](const auto& pair) { return pair.padAxis == axis; });
   if (iter == controller->m_axisMapping.end()) {
@@ -640,14 +753,15 @@ static Sint16 _get_axis_value(const aurora::input::GameController* controller, /
 
   if (iter->nativeAxis.nativeAxis != -1) {
     const auto [nativeAxis, sign] = iter->nativeAxis;
+    if (nativeAxis < 0 || static_cast<size_t>(nativeAxis) >= sample.axes.size()) {
+      return 0;
+    }
     // clamp value to avoid overflow when casting to Sint16 if -32768 is negated
-    return static_cast<Sint16>(
-        std::min(SDL_GetGamepadAxis(controller->m_controller, static_cast<SDL_GamepadAxis>(nativeAxis)) * sign,
-                 SDL_JOYSTICK_AXIS_MAX));
+    return static_cast<Sint16>(std::min(sample.axes[nativeAxis] * sign, SDL_JOYSTICK_AXIS_MAX));
   }
 
   assert(iter->nativeButton != -1);
-  if (SDL_GetGamepadButton(controller->m_controller, static_cast<SDL_GamepadButton>(iter->nativeButton))) {
+  if (sample.button(iter->nativeButton)) {
     return SDL_JOYSTICK_AXIS_MAX;
   }
   return 0;
@@ -727,6 +841,9 @@ u32 PADRead(PADStatus* status) {
       rumbleSupport |= PAD_CHAN0_BIT;
     }
     auto controller = aurora::input::get_controller_for_player(i);
+    if (controller == nullptr) {
+      g_sampledDevices[i].store(0, std::memory_order_release);
+    }
     if (controller == nullptr && !g_keyboardBindings[i].m_mappingsSet && !g_virtualPadActive[i]) {
       status[i].err = PAD_ERR_NO_CONTROLLER;
       g_suppressedButtons[i] = 0;
@@ -802,11 +919,12 @@ u32 PADRead(PADStatus* status) {
 
     if (controller) {
       EnsureMappingLoaded(controller);
+      const auto native = sample_controller(i, controller);
       bool leftTriggerSet = false;
       bool rightTriggerSet = false;
-      std::ranges::for_each(controller->m_buttonMapping, [&controller, &i, &status, &leftTriggerSet,
+      std::ranges::for_each(controller->m_buttonMapping, [&native, &i, &status, &leftTriggerSet,
                                                           &rightTriggerSet](const auto& mapping) {
-        if (SDL_GetGamepadButton(controller->m_controller, static_cast<SDL_GamepadButton>(mapping.nativeButton))) {
+        if (native.button(mapping.nativeButton)) {
           status[i].button |= mapping.padButton;
         }
 
@@ -837,16 +955,16 @@ u32 PADRead(PADStatus* status) {
           {SDL_GAMEPAD_BUTTON_TOUCHPAD, PAD_BUTTON_TOUCHPAD},
       }};
 
-      for (const auto& [native, button] : kExtButtonMappings) {
-        if (SDL_GetGamepadButton(controller->m_controller, native)) {
+      for (const auto& [nativeButton, button] : kExtButtonMappings) {
+        if (native.button(nativeButton)) {
           status[i].extButton |= button;
         }
       }
 
-      const auto xlPos = _get_axis_value(controller, PAD_AXIS_LEFT_X_POS);
-      const auto xlNeg = _get_axis_value(controller, PAD_AXIS_LEFT_X_NEG);
-      const auto ylPos = _get_axis_value(controller, PAD_AXIS_LEFT_Y_POS);
-      const auto ylNeg = _get_axis_value(controller, PAD_AXIS_LEFT_Y_NEG);
+      const auto xlPos = _get_axis_value(controller, native, PAD_AXIS_LEFT_X_POS);
+      const auto xlNeg = _get_axis_value(controller, native, PAD_AXIS_LEFT_X_NEG);
+      const auto ylPos = _get_axis_value(controller, native, PAD_AXIS_LEFT_Y_POS);
+      const auto ylNeg = _get_axis_value(controller, native, PAD_AXIS_LEFT_Y_NEG);
 
       auto xl = static_cast<Sint16>((xlPos + -xlNeg) / 2);
       // SDL's gamepad y-axis is inverted from GC's
@@ -870,10 +988,10 @@ u32 PADRead(PADStatus* status) {
       status[i].stickX = static_cast<int8_t>(xl);
       status[i].stickY = static_cast<int8_t>(yl);
 
-      const auto xrPos = _get_axis_value(controller, PAD_AXIS_RIGHT_X_POS);
-      const auto xrNeg = _get_axis_value(controller, PAD_AXIS_RIGHT_X_NEG);
-      const auto yrPos = _get_axis_value(controller, PAD_AXIS_RIGHT_Y_POS);
-      const auto yrNeg = _get_axis_value(controller, PAD_AXIS_RIGHT_Y_NEG);
+      const auto xrPos = _get_axis_value(controller, native, PAD_AXIS_RIGHT_X_POS);
+      const auto xrNeg = _get_axis_value(controller, native, PAD_AXIS_RIGHT_X_NEG);
+      const auto yrPos = _get_axis_value(controller, native, PAD_AXIS_RIGHT_Y_POS);
+      const auto yrNeg = _get_axis_value(controller, native, PAD_AXIS_RIGHT_Y_NEG);
 
       auto xr = static_cast<Sint16>((xrPos + -xrNeg) / 2);
       // SDL's gamepad y-axis is inverted from GC's
@@ -898,8 +1016,8 @@ u32 PADRead(PADStatus* status) {
       status[i].substickX = static_cast<int8_t>(xr);
       status[i].substickY = static_cast<int8_t>(yr);
 
-      Sint16 tl = std::max(static_cast<Sint16>(0), _get_axis_value(controller, PAD_AXIS_TRIGGER_L));
-      Sint16 tr = std::max(static_cast<Sint16>(0), _get_axis_value(controller, PAD_AXIS_TRIGGER_R));
+      Sint16 tl = std::max(static_cast<Sint16>(0), _get_axis_value(controller, native, PAD_AXIS_TRIGGER_L));
+      Sint16 tr = std::max(static_cast<Sint16>(0), _get_axis_value(controller, native, PAD_AXIS_TRIGGER_R));
 
       if (controller->m_deadZones.emulateTriggers) {
         if (!leftTriggerSet && tl > controller->m_deadZones.leftTriggerActivationZone) {
@@ -1621,6 +1739,42 @@ void PADBlockInput(const bool block) {
   g_blockPAD = block;
 }
 
+static void stop_input_sampler() {
+  g_samplingRate.store(0, std::memory_order_relaxed);
+  g_inputSampler.stop();
+}
+
+void PADSetSamplingRate(const u32 hz) {
+  if (hz == g_samplingRate.load(std::memory_order_relaxed)) {
+    return;
+  }
+  stop_input_sampler();
+  if (hz == 0) {
+    return;
+  }
+  // Samples left over from a previous run would replay old presses on the next read.
+  for (u32 port = 0; port < PAD_CHANMAX; ++port) {
+    g_sampleHistories[port].reset(g_sampledDevices[port].load(std::memory_order_relaxed));
+  }
+  aurora::input::set_shutdown_hook(stop_input_sampler);
+  g_inputSampler.start(hz);
+  g_samplingRate.store(hz, std::memory_order_relaxed);
+}
+
+BOOL PADGetSampleLatency(const u32 port, u64* lastNs, u64* maxNs) {
+  if (port >= PAD_CHANMAX || g_samplingRate.load(std::memory_order_relaxed) == 0) {
+    return false;
+  }
+  const auto stats = g_sampleHistories[port].stats();
+  if (lastNs != nullptr) {
+    *lastNs = stats.lastLatencyNs;
+  }
+  if (maxNs != nullptr) {
+    *maxNs = stats.maxLatencyNs;
+  }
+  return true;
+}
+
 SDL_Gamepad* PADGetSDLGamepadForIndex(const u32 index) {
   const auto* ctrl = __PADGetControllerForIndex(index);
   if (ctrl == nullptr) {
@@ -0,0 +1,87 @@
+#include "pad_sampler.hpp"
+
+#include <algorithm>
+
+namespace aurora::pad {
+namespace {
+constexpr std::array TriggerAxes{LeftTriggerAxis, RightTriggerAxis};
+} // namespace
+
+void SampleHistory::Aggregate::fold(const NativeSample& sample) noexcept {
+  anyPressed |= sample.buttons;
+  allPressed &= sample.buttons;
+  for (size_t i = 0; i < TriggerAxes.size(); ++i) {
+    triggerPeak[i] = std::max(triggerPeak[i], sample.axes[TriggerAxes[i]]);
+  }
+  ++count;
+}
+
+void SampleHistory::reset(const uint32_t device) noexcept {
+  std::lock_guard lock{m_mutex};
+  m_device = device;
+  m_written = 0;
+  m_read = 0;
+  m_evicted = {};
+  m_lastReported = {};
+  m_stats = {};
+}
+
+void SampleHistory::push(const uint32_t device, const NativeSample& sample) noexcept {
+  std::lock_guard lock{m_mutex};
+  if (device != m_device) {
+    return;
+  }
+  if (m_written - m_read == Capacity) {
+    // The reader has fallen a full ring behind. Keep the oldest unread sample's edges before overwriting it.
+    m_evicted.fold(m_ring[m_read % Capacity]);
+    ++m_read;
+    ++m_stats.overflowCount;
+  }
+  m_ring[m_written % Capacity] = sample;
+  ++m_written;
+}
+
+bool SampleHistory::consume(const uint64_t nowNs, NativeSample& out) noexcept {
+  std::lock_guard lock{m_mutex};
+  if (m_written == 0) {
+    return false;
+  }
+
+  Aggregate aggregate = m_evicted;
+  m_evicted = {};
+  for (uint64_t i = m_read; i < m_written; ++i) {
+    aggregate.fold(m_ring[i % Capacity]);
+  }
+  m_read = m_written;
+
+  const NativeSample& newest = m_ring[(m_written - 1) % Capacity];
+  out = newest;
+  if (aggregate.count != 0) {
+    const uint32_t last = m_lastReported.buttons;
+    out.buttons = (aggregate.anyPressed & ~last) | (aggregate.allPressed & last);
+    for (size_t i = 0; i < TriggerAxes.size(); ++i) {
+      const size_t axis = TriggerAxes[i];
+      if (aggregate.triggerPeak[i] > m_lastReported.axes[axis]) {
+        out.axes[axis] = aggregate.triggerPeak[i];
+      }
+    }
+  }
+  m_lastReported = out;
+
+  m_stats.lastLatencyNs = nowNs > newest.timestampNs ? nowNs - newest.timestampNs : 0;
+  m_stats.maxLatencyNs = std::max(m_stats.maxLatencyNs, m_stats.lastLatencyNs);
+  m_stats.lastSampleCount = aggregate.count;
+  return true;
+}
+
+uint32_t SampleHistory::device() const noexcept {
+  std::lock_guard lock{m_mutex};
+  return m_device;
+}
+
+SampleStats SampleHistory::stats() const noexcept {
+  std::lock_guard lock{m_mutex};
+  return m_stats;
+}
+
+} // namespace aurora::pad
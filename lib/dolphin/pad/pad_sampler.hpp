@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace aurora::pad {
+
+// Matches SDL_GAMEPAD_AXIS_COUNT; the last two axes are the triggers.
+inline constexpr size_t NativeAxisCount = 6;
+inline constexpr size_t LeftTriggerAxis = 4;
+inline constexpr size_t RightTriggerAxis = 5;
+
+// Raw gamepad state before any mapping, dead zones or trigger emulation is applied.
+struct NativeSample {
+  uint64_t timestampNs = 0;
+  // One bit per SDL_GamepadButton.
+  uint32_t buttons = 0;
+  std::array<int16_t, NativeAxisCount> axes{};
+
+  bool button(uint32_t native) const noexcept { return native < 32 && (buttons & (1u << native)) != 0; }
+};
+
+struct SampleStats {
+  // Age of the newest sample when it was last read.
+  uint64_t lastLatencyNs = 0;
+  uint64_t maxLatencyNs = 0;
+  // Samples folded into the last read.
+  uint32_t lastSampleCount = 0;
+  // Unread samples pushed out of the ring. They still count towards the next read.
+  uint64_t overflowCount = 0;
+};
+
+// Timestamped samples for one port, written by the sampler thread and read by PADRead.
+//
+// A read aggregates every sample since the previous read so that changes shorter than a game frame are not lost: a
+// button that was up at the last read is reported down if it was pressed in any sample, and one that was down is
+// reported up if it was released in any sample. Sticks report the newest position. A trigger reports its peak if it
+// rose above the last reported value, so a quick pull still crosses the emulated digital threshold.
+class SampleHistory {
+public:
+  static constexpr size_t Capacity = 256;
+
+  // Starts a new history for `device`, dropping all samples and the last reported state.
+  void reset(uint32_t device) noexcept;
+  // Ignored if `device` is not the one the history was last reset for.
+  void push(uint32_t device, const NativeSample& sample) noexcept;
+  // Aggregates the samples since the last read into `out`. Returns false if there has never been a sample, in
+  // which case the caller should read the device directly.
+  bool consume(uint64_t nowNs, NativeSample& out) noexcept;
+
+  uint32_t device() const noexcept;
+  SampleStats stats() const noexcept;
+
+private:
+  struct Aggregate {
+    uint32_t anyPressed = 0;
+    uint32_t allPressed = ~0u;
+    std::array<int16_t, 2> triggerPeak{INT16_MIN, INT16_MIN};
+    uint32_t count = 0;
+
+    void fold(const NativeSample& sample) noexcept;
+  };
+
+  mutable std::mutex m_mutex;
+  uint32_t m_device = 0;
+  std::array<NativeSample, Capacity> m_ring{};
+  // Total samples pushed since the last reset; the newest is at (m_written - 1) % Capacity.
+  uint64_t m_written = 0;
+  uint64_t m_read = 0;
+  // Unread samples that were overwritten before the next read.
+  Aggregate m_evicted;
+  NativeSample m_lastReported;
+  SampleStats m_stats;
+};
+
+} // namespace aurora::pad
@@ -11,6 +11,7 @@
 #include <chrono>
 #include <mutex>
 #include <string>
+#include <vector>
 
 #include <magic_enum.hpp>
 #include <tracy/Tracy.hpp>
@@ -43,12 +44,6 @@ struct Params {
 };
 static_assert(sizeof(Params) == 32);
 
-struct LatestSnapshot {
-  uint32_t width = 0;
-  uint32_t height = 0;
-  std::vector<uint32_t> data;
-};
-
 enum class SlotState : uint8_t {
   Available,
   CopySubmitted,
@@ -61,6 +56,7 @@ struct Slot {
   wgpu::Buffer paramsBuffer;
   uint32_t width = 0;
   uint32_t height = 0;
+  uint32_t divisor = 1;
   uint64_t byteSize = 0;
   SlotState state = SlotState::Available;
 };
@@ -78,7 +74,7 @@ wgpu::BindGroupLayout g_bindGroupLayout;
 wgpu::ComputePipeline g_pipeline;
 bool g_snapshotRequested = false;
 Clock::time_point g_nextSnapshotTime;
-LatestSnapshot g_latest;
+// Guards the slots and snapshot requests. Readers of the latest snapshot go through depth_peek_store without it.
 std::mutex g_mutex;
 
 constexpr std::string_view ShaderPreamble = R"(
@@ -293,9 +289,7 @@ void complete_slot(size_t slotIdx, wgpu::MapAsyncStatus status, wgpu::StringView
     const auto* mapped =
         static_cast<const uint32_t*>(slot.readbackBuffer.GetConstMappedRange(0, valueCount * sizeof(uint32_t)));
     if (mapped != nullptr) {
-      g_latest.width = slot.width;
-      g_latest.height = slot.height;
-      g_latest.data.assign(mapped, mapped + valueCount);
+      publish_latest(slot.width, slot.height, slot.divisor, {mapped, valueCount});
     }
     slot.readbackBuffer.Unmap();
   } else if (status != wgpu::MapAsyncStatus::CallbackCancelled && status != wgpu::MapAsyncStatus::Aborted) {
@@ -331,15 +325,6 @@ void request_snapshot() noexcept {
   g_snapshotRequested = true;
 }
 
-bool read_latest(uint16_t x, uint16_t y, uint32_t& z) noexcept {
-  std::lock_guard lock{g_mutex};
-  if (x >= g_latest.width || y >= g_latest.height || g_latest.data.empty()) {
-    return false;
-  }
-  z = g_latest.data[static_cast<size_t>(y) * g_latest.width + x] & 0x00ffffffu;
-  return true;
-}
-
 void encode_frame_snapshot(const wgpu::CommandEncoder& cmd, const wgpu::TextureView& depthView,
                            wgpu::Extent3D sourceSize, uint32_t msaaSamples) noexcept {
   if (!g_enabled) {
@@ -357,15 +342,25 @@ void encode_frame_snapshot(const wgpu::CommandEncoder& cmd, const wgpu::TextureV
     g_nextSnapshotTime = now + SnapshotInterval;
   }
 
-  const auto dstSize = vi::configured_fb_size();
-  if (!depthView || dstSize.x == 0 || dstSize.y == 0 || sourceSize.width == 0 || sourceSize.height == 0) {
+  const auto fbSize = vi::configured_fb_size();
+  if (!depthView || fbSize.x == 0 || fbSize.y == 0 || sourceSize.width == 0 || sourceSize.height == 0) {
     return;
   }
   if (msaaSamples > 1) {
     Log.fatal("Depth Peek from multisampled EFB targets is not supported");
   }
 
-  const Params params = make_params(sourceSize, dstSize);
+  // Each snapshot texel samples the centre of the divisor x divisor block of logical pixels it covers.
+  const uint32_t snapshotDivisor = divisor();
+  const Vec2<uint32_t> dstSize{
+      (fbSize.x + snapshotDivisor - 1) / snapshotDivisor,
+      (fbSize.y + snapshotDivisor - 1) / snapshotDivisor,
+  };
+  Params params = make_params(sourceSize, fbSize);
+  params.dstWidth = dstSize.x;
+  params.dstHeight = dstSize.y;
+  params.scaleX *= static_cast<float>(snapshotDivisor);
+  params.scaleY *= static_cast<float>(snapshotDivisor);
   wgpu::Buffer storageBuffer;
   wgpu::Buffer readbackBuffer;
   wgpu::Buffer paramsBuffer;
@@ -377,6 +372,7 @@ void encode_frame_snapshot(const wgpu::CommandEncoder& cmd, const wgpu::TextureV
       return;
     }
     slot->state = SlotState::CopySubmitted;
+    slot->divisor = snapshotDivisor;
     storageBuffer = slot->storageBuffer;
     readbackBuffer = slot->readbackBuffer;
     paramsBuffer = slot->paramsBuffer;
@@ -461,7 +457,7 @@ void reset() noexcept {
   g_snapshotRequested = false;
   g_nextSlot = 0;
   g_nextSnapshotTime = {};
-  g_latest = {};
+  clear_latest();
   for (auto& slot : g_slots) {
     slot.state = SlotState::Available;
   }
@@ -471,13 +467,6 @@ bool snapshot_requested() noexcept {
   std::lock_guard lock{g_mutex};
   return g_snapshotRequested;
 }
-
-void set_latest(uint32_t width, uint32_t height, const std::vector<uint32_t>& data) {
-  std::lock_guard lock{g_mutex};
-  g_latest.width = width;
-  g_latest.height = height;
-  g_latest.data = data;
-}
 } // namespace testing
 
 } // namespace aurora::gfx::depth_peek
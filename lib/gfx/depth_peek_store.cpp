@@ -0,0 +1,147 @@
+#include "depth_peek_store.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <mutex>
+
+namespace aurora::gfx::depth_peek {
+namespace {
+// The published snapshot plus spares the writer fills while readers still hold older ones.
+constexpr size_t BufferCount = 3;
+constexpr int NoBuffer = -1;
+
+struct Buffer {
+  std::atomic_uint32_t readers{0};
+  uint32_t width = 0;
+  uint32_t height = 0;
+  uint32_t divisor = 1;
+  std::vector<uint32_t> data;
+};
+
+std::array<Buffer, BufferCount> g_buffers;
+// Index of the latest snapshot. Only writers change it, under g_publishMutex.
+std::atomic_int g_current{NoBuffer};
+std::mutex g_publishMutex;
+std::atomic_uint32_t g_divisor{1};
+
+// Pins the latest snapshot for the duration of a read without taking a lock. A buffer is only rewritten once it is
+// no longer current and has no readers, so a reader that sees its buffer still current after registering is safe
+// to read it until it unregisters.
+class ReadGuard {
+public:
+  ReadGuard() noexcept {
+    while (true) {
+      const int current = g_current.load();
+      if (current == NoBuffer) {
+        return;
+      }
+      auto& buffer = g_buffers[current];
+      buffer.readers.fetch_add(1);
+      if (g_current.load() == current) {
+        m_buffer = &buffer;
+        return;
+      }
+      buffer.readers.fetch_sub(1, std::memory_order_release);
+    }
+  }
+  ~ReadGuard() {
+    if (m_buffer != nullptr) {
+      m_buffer->readers.fetch_sub(1, std::memory_order_release);
+    }
+  }
+  ReadGuard(const ReadGuard&) = delete;
+  ReadGuard& operator=(const ReadGuard&) = delete;
+
+  const Buffer* buffer() const noexcept { return m_buffer; }
+
+private:
+  Buffer* m_buffer = nullptr;
+};
+
+bool lookup(const Buffer& buffer, uint32_t x, uint32_t y, uint32_t& z) noexcept {
+  x /= buffer.divisor;
+  y /= buffer.divisor;
+  if (x >= buffer.width || y >= buffer.height) {
+    return false;
+  }
+  z = buffer.data[static_cast<size_t>(y) * buffer.width + x] & 0x00ffffffu;
+  return true;
+}
+} // namespace
+
+void set_divisor(uint32_t divisor) noexcept { g_divisor.store(std::clamp(divisor, 1u, MaxDivisor)); }
+
+uint32_t divisor() noexcept { return g_divisor.load(std::memory_order_relaxed); }
+
+bool publish_latest(uint32_t width, uint32_t height, uint32_t divisor, std::span<const uint32_t> data) {
+  if (width == 0 || height == 0 || divisor == 0 || data.size() < static_cast<size_t>(width) * height) {
+    return false;
+  }
+  std::lock_guard lock{g_publishMutex};
+  const int current = g_current.load(std::memory_order_relaxed);
+  for (int i = 0; i < static_cast<int>(g_buffers.size()); ++i) {
+    auto& buffer = g_buffers[i];
+    if (i == current || buffer.readers.load() != 0) {
+      continue;
+    }
+    buffer.width = width;
+    buffer.height = height;
+    buffer.divisor = divisor;
+    buffer.data.assign(data.begin(), data.begin() + static_cast<ptrdiff_t>(width) * height);
+    g_current.store(i);
+    return true;
+  }
+  return false;
+}
+
+void clear_latest() noexcept {
+  std::lock_guard lock{g_publishMutex};
+  g_current.store(NoBuffer);
+}
+
+bool read_latest(uint16_t x, uint16_t y, uint32_t& z) noexcept {
+  const ReadGuard guard;
+  return guard.buffer() != nullptr && lookup(*guard.buffer(), x, y, z);
+}
+
+size_t read_points(std::span<const PeekPoint> points, std::span<uint32_t> z) noexcept {
+  const size_t count = std::min(points.size(), z.size());
+  const ReadGuard guard;
+  size_t found = 0;
+  for (size_t i = 0; i < count; ++i) {
+    z[i] = 0;
+    if (guard.buffer() != nullptr && lookup(*guard.buffer(), points[i].x, points[i].y, z[i])) {
+      ++found;
+    }
+  }
+  return found;
+}
+
+size_t read_rect(uint16_t x, uint16_t y, uint16_t width, uint16_t height, std::span<uint32_t> z) noexcept {
+  if (z.size() < static_cast<size_t>(width) * height) {
+    return 0;
+  }
+  const ReadGuard guard;
+  size_t found = 0;
+  for (uint32_t row = 0; row < height; ++row) {
+    uint32_t* out = z.data() + static_cast<size_t>(row) * width;
+    for (uint32_t col = 0; col < width; ++col) {
+      out[col] = 0;
+      if (guard.buffer() != nullptr && lookup(*guard.buffer(), x + col, y + row, out[col])) {
+        ++found;
+      }
+    }
+  }
+  return found;
+}
+
+namespace testing {
+void set_latest(uint32_t width, uint32_t height, const std::vector<uint32_t>& data, uint32_t divisor) {
+  if (!publish_latest(width, height, divisor, data)) {
+    clear_latest();
+  }
+}
+} // namespace testing
+
+} // namespace aurora::gfx::depth_peek
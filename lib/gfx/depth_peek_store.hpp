@@ -0,0 +1,37 @@
+#pragma once
+
+#include <dolphin/gx/GXAurora.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace aurora::gfx::depth_peek {
+
+using PeekPoint = GXPeekZPoint;
+
+inline constexpr uint32_t MaxDivisor = 8;
+
+// Snapshots are taken at 1/divisor of the logical framebuffer size in each dimension. Each snapshot texel holds the
+// depth at the centre of the divisor x divisor block it covers.
+void set_divisor(uint32_t divisor) noexcept;
+uint32_t divisor() noexcept;
+
+// Makes `data` (width * height Z24 values) the latest snapshot. Readers never block; if every spare buffer is still
+// being read, the snapshot is dropped and false is returned.
+bool publish_latest(uint32_t width, uint32_t height, uint32_t divisor, std::span<const uint32_t> data);
+void clear_latest() noexcept;
+
+// Reads from the latest snapshot in logical framebuffer coordinates.
+bool read_latest(uint16_t x, uint16_t y, uint32_t& z) noexcept;
+// Reads every point from the same snapshot. Points it does not cover get 0. Returns the number of points covered.
+size_t read_points(std::span<const PeekPoint> points, std::span<uint32_t> z) noexcept;
+// Reads a width x height rectangle row by row into `z`, with the same fallback and result as read_points.
+size_t read_rect(uint16_t x, uint16_t y, uint16_t width, uint16_t height, std::span<uint32_t> z) noexcept;
+
+namespace testing {
+void set_latest(uint32_t width, uint32_t height, const std::vector<uint32_t>& data, uint32_t divisor = 1);
+} // namespace testing
+
+} // namespace aurora::gfx::depth_peek
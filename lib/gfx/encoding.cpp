@@ -4,7 +4,9 @@
 
 #include "clear.hpp"
 #include "depth_peek.hpp"
+#include "frame_timing.hpp"
 #include "pipeline_cache.hpp"
+#include "resource_cache.hpp"
 #include "tex_copy_conv.hpp"
 #include "tex_palette_conv.hpp"
 #include "../gx/gx.hpp"
@@ -33,6 +35,8 @@ using webgpu::g_queue;
 namespace {
 constexpr Module Log{"aurora::gfx"};
 PipelineRef g_currentPipeline;
+// Texture bind group set through bind_texture_group since the last pipeline change.
+BindGroupRef g_currentTextureBindGroup;
 
 void apply_viewport(const wgpu::RenderPassEncoder& pass, const Viewport& vp) {
   const float minDepth = gx::UseReversedZ ? 1.f - vp.zfar : vp.znear;
@@ -61,7 +65,7 @@ DrawContext make_draw_context(const RenderPass& passInfo) {
   };
 }
 
-void render_custom_draw(const CustomDrawCommand& draw, const wgpu::RenderPassEncoder& pass,
+void render_custom_draw(CustomDrawCommand& draw, const wgpu::RenderPassEncoder& pass,
                         const RenderPass& passInfo) {
   const auto drawType = find_runtime_draw_type(draw.type);
   if (!drawType) {
@@ -70,7 +74,7 @@ void render_custom_draw(const CustomDrawCommand& draw, const wgpu::RenderPassEnc
   }
 
   const auto context = make_draw_context(passInfo);
-  drawType->draw(context, pass, draw.payload.data(), draw.payloadSize, drawType->userdata);
+  drawType->draw(context, pass, draw.payload(), draw.payloadSize, drawType->userdata);
 }
 
 void execute_encoder_task(wgpu::CommandEncoder& cmd, FramePacket& frame, const EncoderTask& task) {
@@ -105,11 +109,41 @@ void execute_encoder_task(wgpu::CommandEncoder& cmd, FramePacket& frame, const E
   }
 }
 
-void render_pass(const wgpu::RenderPassEncoder& pass, FramePacket& frame, RenderPass& passInfo) {
+#ifdef AURORA_GFX_DEBUG_GROUPS
+// Pops and pushes debug groups to move the encoder from one interned stack to another.
+void transition_debug_groups(const wgpu::RenderPassEncoder& pass, const DebugGroup* from, const DebugGroup* to) {
+  std::array<const char*, 32> pushLabels;
+  size_t pushCount = 0;
+  const auto depth = [](const DebugGroup* group) { return group != nullptr ? group->depth : 0u; };
+  while (depth(from) > depth(to)) {
+    pass.PopDebugGroup();
+    from = from->parent;
+  }
+  while (depth(to) > depth(from)) {
+    if (pushCount < pushLabels.size()) {
+      pushLabels[pushCount++] = to->label;
+    }
+    to = to->parent;
+  }
+  while (from != to) {
+    pass.PopDebugGroup();
+    if (pushCount < pushLabels.size()) {
+      pushLabels[pushCount++] = to->label;
+    }
+    from = from->parent;
+    to = to->parent;
+  }
+  while (pushCount > 0) {
+    pass.PushDebugGroup(pushLabels[--pushCount]);
+  }
+}
+#endif
+
+void render_pass(const wgpu::RenderPassEncoder& pass, RenderPass& passInfo) {
   ZoneScoped;
   g_currentPipeline = UINTPTR_MAX;
 #ifdef AURORA_GFX_DEBUG_GROUPS
-  std::vector<std::string> lastDebugGroupStack;
+  const DebugGroup* lastDebugGroup = nullptr;
 #endif
   Viewport currentViewport{};
   ClipRect currentScissor{};
@@ -122,44 +156,32 @@ void render_pass(const wgpu::RenderPassEncoder& pass, FramePacket& frame, Render
 
   for (auto& cmd : passInfo.commands) {
 #ifdef AURORA_GFX_DEBUG_GROUPS
-    {
-      size_t firstDiff = lastDebugGroupStack.size();
-      for (size_t i = 0; i < lastDebugGroupStack.size(); ++i) {
-        if (i >= cmd.debugGroupStack.size() || cmd.debugGroupStack[i] != lastDebugGroupStack[i]) {
-          firstDiff = i;
-          break;
-        }
-      }
-      for (size_t i = firstDiff; i < lastDebugGroupStack.size(); ++i) {
-        pass.PopDebugGroup();
-      }
-      for (size_t i = firstDiff; i < cmd.debugGroupStack.size(); ++i) {
-        pass.PushDebugGroup(cmd.debugGroupStack[i].c_str());
-      }
-      lastDebugGroupStack = cmd.debugGroupStack;
+    if (cmd.debugGroup != lastDebugGroup) {
+      transition_debug_groups(pass, lastDebugGroup, cmd.debugGroup);
+      lastDebugGroup = cmd.debugGroup;
     }
 #endif
     switch (cmd.type) {
     case CommandType::SetViewport: {
-      const auto& vp = cmd.data.setViewport;
+      const auto& vp = cmd.as<Viewport>();
       apply_viewport(pass, vp);
       currentViewport = vp;
       hasViewport = true;
     } break;
     case CommandType::SetScissor: {
-      const auto& sc = cmd.data.setScissor;
+      const auto& sc = cmd.as<ClipRect>();
       apply_scissor(pass, sc, passInfo.colorAttachments[SceneColorAttachmentIndex].size);
       currentScissor = sc;
       hasScissor = true;
     } break;
     case CommandType::Draw: {
-      auto& draw = cmd.data.draw;
+      auto& draw = cmd.as<DrawCommand>();
       if (draw.encoder != nullptr) {
-        draw.encoder(draw.payload.data(), pass, passInfo);
+        draw.encoder(draw.payload(), pass, passInfo);
       }
     } break;
     case CommandType::CustomDraw: {
-      render_custom_draw(cmd.data.customDraw, pass, passInfo);
+      render_custom_draw(cmd.as<CustomDrawCommand>(), pass, passInfo);
       g_currentPipeline = UINTPTR_MAX;
       pass.SetBindGroup(0, resources().staticBindGroup);
       pass.SetBindGroup(2, gx::g_emptyTextureBindGroup);
@@ -172,21 +194,20 @@ void render_pass(const wgpu::RenderPassEncoder& pass, FramePacket& frame, Render
     } break;
     case CommandType::DebugMarker: {
 #if defined(AURORA_GFX_DEBUG_GROUPS)
-      pass.InsertDebugMarker(wgpu::StringView(frame.debugMarkers[cmd.data.debugMarkerIndex]));
+      pass.InsertDebugMarker(wgpu::StringView(cmd.as<const char*>()));
 #endif
     } break;
     }
   }
 
 #ifdef AURORA_GFX_DEBUG_GROUPS
-  for (size_t i = 0; i < lastDebugGroupStack.size(); ++i) {
-    pass.PopDebugGroup();
-  }
+  transition_debug_groups(pass, lastDebugGroup, nullptr);
 #endif
 }
 
 void render(wgpu::CommandEncoder& cmd, FramePacket& frame, RenderPass& passInfo, uint32_t passIndex) {
   ZoneScoped;
+  frame_timing::ScopedTimer timer{frame_timing::Phase::Encode};
   if (!passInfo.sealed) {
     return;
   }
@@ -246,7 +267,7 @@ void render(wgpu::CommandEncoder& cmd, FramePacket& frame, RenderPass& passInfo,
   };
 
   auto pass = cmd.BeginRenderPass(&renderPassDescriptor);
-  render_pass(pass, frame, passInfo);
+  render_pass(pass, passInfo);
   pass.End();
 
   if (passInfo.captureDepthSnapshot) {
@@ -342,8 +363,11 @@ bool needs_staging_copy(const FramePacket& frame, const FrameOp& op) {
       highWater.indices > frame.copied.indices || highWater.storage > frame.copied.storage) {
     return true;
   }
+  if (highWater.bufferUploadCount > frame.copied.bufferUploadCount) {
+    return true;
+  }
   if constexpr (UseTextureBuffer) {
-    return op.textureUploads.size() > frame.copied.textureUploadCount;
+    return highWater.textureUploadCount > frame.copied.textureUploadCount;
   }
   return false;
 }
@@ -363,8 +387,8 @@ void copy_staging_to_high_water(wgpu::CommandEncoder& cmd, FramePacket& frame, c
                             res.storageBuffer);
 
   if constexpr (UseTextureBuffer) {
-    for (size_t i = frame.copied.textureUploadCount; i < op.textureUploads.size(); ++i) {
-      const auto& item = *op.textureUploads[i];
+    for (size_t i = frame.copied.textureUploadCount; i < highWater.textureUploadCount; ++i) {
+      const auto& item = frame.textureUploads[i];
       const wgpu::TexelCopyBufferInfo buf{
           .layout =
               wgpu::TexelCopyBufferLayout{
@@ -377,12 +401,35 @@ void copy_staging_to_high_water(wgpu::CommandEncoder& cmd, FramePacket& frame, c
       cmd.CopyBufferToTexture(&buf, &item.tex, &item.size);
     }
     frame.copied.textureUpload = highWater.textureUpload;
-    frame.copied.textureUploadCount = op.textureUploads.size();
+    frame.copied.textureUploadCount = highWater.textureUploadCount;
+  }
+  for (size_t i = frame.copied.bufferUploadCount; i < highWater.bufferUploadCount; ++i) {
+    const auto& item = frame.bufferUploads[i];
+    cmd.CopyBufferToBuffer(item.buffer ? item.buffer : staging_buffer(frame.stagingBuffer),
+                           item.buffer ? item.srcOffset : item.srcOffset + TextureUploadStagingOffset, item.dst,
+                           item.dstOffset, item.size);
   }
+  frame.copied.bufferUploadCount = highWater.bufferUploadCount;
 }
 } // namespace
 
 namespace detail {
+void flush_staging(wgpu::CommandEncoder& cmd, FramePacket& frame) {
+  const FrameOp op{
+      .highWater =
+          {
+              .verts = static_cast<uint32_t>(frame.verts.size()),
+              .uniforms = static_cast<uint32_t>(frame.uniforms.size()),
+              .indices = static_cast<uint32_t>(frame.indices.size()),
+              .storage = static_cast<uint32_t>(frame.storage.size()),
+              .textureUpload = static_cast<uint32_t>(frame.textureUpload.size()),
+              .textureUploadCount = frame.textureUploads.size(),
+              .bufferUploadCount = frame.bufferUploads.size(),
+          },
+  };
+  copy_staging_to_high_water(cmd, frame, op);
+}
+
 void encode_op(wgpu::CommandEncoder& cmd, FramePacket& frame, const FrameOp& op) {
   copy_staging_to_high_water(cmd, frame, op);
   switch (op.type) {
@@ -416,6 +463,15 @@ bool bind_pipeline(PipelineRef ref, const wgpu::RenderPassEncoder& pass) {
   }
   pass.SetPipeline(pipeline);
   g_currentPipeline = ref;
+  g_currentTextureBindGroup = 0;
   return true;
 }
+
+void bind_texture_group(BindGroupRef ref, const wgpu::RenderPassEncoder& pass) {
+  if (ref == g_currentTextureBindGroup) {
+    return;
+  }
+  pass.SetBindGroup(2, find_bind_group(ref));
+  g_currentTextureBindGroup = ref;
+}
 } // namespace aurora::gfx
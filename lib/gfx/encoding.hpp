@@ -5,9 +5,14 @@
 namespace aurora::gfx {
 
 bool bind_pipeline(PipelineRef ref, const wgpu::RenderPassEncoder& pass);
+// Sets bind group 2 unless `ref` is already bound. Only valid after bind_pipeline, since a pipeline change (including
+// to a renderer that sets group 2 itself) forgets the bound group.
+void bind_texture_group(BindGroupRef ref, const wgpu::RenderPassEncoder& pass);
 
 namespace detail {
 void encode_op(wgpu::CommandEncoder& encoder, FramePacket& frame, const FrameOp& op);
+// Copies staging data pushed after the frame's last op, such as geometry drawn by the end-of-frame callback.
+void flush_staging(wgpu::CommandEncoder& encoder, FramePacket& frame);
 }
 
 } // namespace aurora::gfx
@@ -1,6 +1,9 @@
 #include "frame.hpp"
 
 #include "depth_peek.hpp"
+#include "encoding.hpp"
+#include "frame_pacing.hpp"
+#include "frame_timing.hpp"
 #include "pipeline_cache.hpp"
 #include "recording.hpp"
 #include "render_worker.hpp"
@@ -9,12 +12,15 @@
 #include "tex_palette_conv.hpp"
 #include "texture_replacement.hpp"
 #include "../gx/gx.hpp"
+#include "../gx/vertex_decode.hpp"
+#include "../io.hpp"
 #ifdef AURORA_ENABLE_RMLUI
 #include "../rmlui/pipeline.hpp"
 #endif
 #include "../webgpu/gpu.hpp"
 #include "../webgpu/gpu_prof.hpp"
 
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <chrono>
@@ -114,35 +120,22 @@ constexpr auto PresentFpsWindow = std::chrono::seconds{1};
 std::mutex g_presentStatsMutex;
 std::deque<PresentClock::time_point> g_presentTimes;
 std::atomic_bool g_processEventsQueued = false;
-std::atomic_int64_t g_lastPresentNs = 0;
-std::atomic_int64_t g_presentPeriodNs = 0;
-std::atomic_int64_t g_cpuFrameTimeNs = 0;
-PresentClock::time_point g_cpuFrameStart;
-constexpr auto FrameStartSafetyMargin = std::chrono::milliseconds{2};
-constexpr auto MaxPacingSample = std::chrono::milliseconds{250};
-constexpr uint32_t PacingEmaWeight = 8;
-
-int64_t timestamp_ns(PresentClock::time_point time) {
-  return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
-}
-
-int64_t duration_ns(PresentClock::duration duration) {
-  return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+int64_t g_cpuFrameStartNs = 0;
+// Start time of the frame currently being presented. Only accessed by the render worker.
+int64_t g_presentingFrameStartNs = 0;
+
+AuroraFramePacing sanitize_frame_pacing(AuroraFramePacing mode) {
+  switch (mode) {
+  case FRAME_PACING_OFF:
+  case FRAME_PACING_LOW_LATENCY:
+  case FRAME_PACING_ADAPTIVE:
+    return mode;
+  }
+  Log.warn("Unknown frame pacing mode {}, disabling", static_cast<int>(mode));
+  return FRAME_PACING_OFF;
 }
 
-void update_ema(std::atomic_int64_t& value, int64_t sample) {
-  if (sample <= 0 || sample > duration_ns(MaxPacingSample)) {
-    return;
-  }
-
-  int64_t current = value.load(std::memory_order_acquire);
-  while (true) {
-    const int64_t next = current == 0 ? sample : current + (sample - current) / static_cast<int64_t>(PacingEmaWeight);
-    if (value.compare_exchange_weak(current, next, std::memory_order_acq_rel, std::memory_order_acquire)) {
-      return;
-    }
-  }
-}
+uint32_t to_us(int64_t ns) { return static_cast<uint32_t>(std::clamp<int64_t>(ns / 1000, 0, UINT32_MAX)); }
 
 void prune_present_times(PresentClock::time_point now) {
   while (!g_presentTimes.empty() && g_presentTimes.front() + PresentFpsWindow < now) {
@@ -182,35 +175,14 @@ void wait_for_gpu_progress(std::chrono::nanoseconds sleepDuration) {
   std::this_thread::sleep_for(sleepDuration);
 }
 
+FramePacer g_framePacer{nullptr,
+                        [](int64_t durationNs) { wait_for_gpu_progress(std::chrono::nanoseconds{durationNs}); }};
+
 void pace_frame_start() {
   ZoneScopedN("Frame start pacing");
-  if (g_frameSlots.free_count() == FrameSlotCount) {
-    return;
-  }
-
-  const int64_t lastPresentNs = g_lastPresentNs.load(std::memory_order_acquire);
-  const int64_t presentPeriodNs = g_presentPeriodNs.load(std::memory_order_acquire);
-  const int64_t cpuFrameTimeNs = g_cpuFrameTimeNs.load(std::memory_order_acquire);
-  if (lastPresentNs == 0 || presentPeriodNs == 0 || cpuFrameTimeNs == 0) {
-    return;
-  }
-
-  const int64_t safetyMarginNs = duration_ns(FrameStartSafetyMargin);
-  const int64_t targetStartNs = lastPresentNs + presentPeriodNs - cpuFrameTimeNs - safetyMarginNs;
-  int64_t nowNs = timestamp_ns(PresentClock::now());
-  if (targetStartNs <= nowNs) {
-    return;
-  }
-
-  const double initialWaitMs = static_cast<double>(targetStartNs - nowNs) / 1'000'000.0;
-  TracyPlot("aurora: frameStartPaceWaitMs", initialWaitMs);
-  while (nowNs < targetStartNs) {
-    const int64_t remainingNs = targetStartNs - nowNs;
-    const auto sleepDuration =
-        remainingNs > 1'000'000 ? std::chrono::milliseconds{1} : std::chrono::nanoseconds{remainingNs};
-    wait_for_gpu_progress(sleepDuration);
-    nowNs = timestamp_ns(PresentClock::now());
-  }
+  const int64_t waitNs = g_framePacer.pace(g_frameSlots.free_count() != FrameSlotCount);
+  g_resources.stats.pacingWaitUs = to_us(waitNs);
+  TracyPlot("aurora: frameStartPaceWaitMs", static_cast<double>(waitNs) / 1'000'000.0);
 }
 
 void map_staging_buffer(size_t slot, bool releaseSlotOnCompletion = false) {
@@ -375,11 +347,12 @@ void unregister_encoder_task_type(EncoderTaskId type) noexcept {
 
 void initialize() {
   g_frameIndex = 0;
+  g_framePacer.set_mode(sanitize_frame_pacing(g_config.framePacing));
   g_processEventsQueued.store(false, std::memory_order_release);
-  g_lastPresentNs.store(0, std::memory_order_release);
-  g_presentPeriodNs.store(0, std::memory_order_release);
-  g_cpuFrameTimeNs.store(0, std::memory_order_release);
-  g_cpuFrameStart = {};
+  g_framePacer.reset();
+  frame_timing::reset();
+  g_cpuFrameStartNs = 0;
+  g_presentingFrameStartNs = 0;
   {
     std::lock_guard lock{g_presentStatsMutex};
     g_presentTimes.clear();
@@ -416,8 +389,8 @@ void initialize() {
                "Shared Vertex Buffer");
   createBuffer(g_resources.indexBuffer, wgpu::BufferUsage::Index | wgpu::BufferUsage::CopyDst, IndexBufferSize,
                "Shared Index Buffer");
-  createBuffer(g_resources.storageBuffer, wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst, StorageBufferSize,
-               "Shared Storage Buffer");
+  createBuffer(g_resources.storageBuffer, wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst,
+               StorageBufferSize + ResidentStorageSize, "Shared Storage Buffer");
   for (size_t i = 0; i < g_stagingBuffers.size(); ++i) {
     const auto label = fmt::format("Staging Buffer {}", i);
     createBuffer(g_stagingBuffers[i], wgpu::BufferUsage::MapWrite | wgpu::BufferUsage::CopySrc, StagingBufferSize,
@@ -522,10 +495,10 @@ void shutdown() {
   render_worker::synchronize();
   render_worker::shutdown();
   g_processEventsQueued.store(false, std::memory_order_release);
-  g_lastPresentNs.store(0, std::memory_order_release);
-  g_presentPeriodNs.store(0, std::memory_order_release);
-  g_cpuFrameTimeNs.store(0, std::memory_order_release);
-  g_cpuFrameStart = {};
+  g_framePacer.reset();
+  frame_timing::reset();
+  g_cpuFrameStartNs = 0;
+  g_presentingFrameStartNs = 0;
   {
     std::lock_guard lock{g_presentStatsMutex};
     g_presentTimes.clear();
@@ -614,7 +587,7 @@ std::optional<size_t> acquire_mapped_staging_buffer() {
 
 bool begin_frame() {
   ZoneScoped;
-  // pace_frame_start();
+  pace_frame_start();
   const size_t frameSlot = acquire_frame_slot();
   const auto stagingSlot = acquire_mapped_staging_buffer();
   if (!stagingSlot) {
@@ -651,17 +624,18 @@ bool begin_frame() {
     g_framePackets[frameSlot].encoder = g_device.CreateCommandEncoder(&EncoderDescriptor);
     webgpu::gpu_prof::frame_begin(g_framePackets[frameSlot].encoder);
   });
-  g_cpuFrameStart = PresentClock::now();
+  g_cpuFrameStartNs = g_framePacer.now();
   return true;
 }
 
 void end_frame(EndFrameCallback callback) {
   ZoneScoped;
-  if (g_cpuFrameStart.time_since_epoch().count() != 0) {
-    const auto cpuFrameTime = PresentClock::now() - g_cpuFrameStart;
-    update_ema(g_cpuFrameTimeNs, duration_ns(cpuFrameTime));
-    const double cpuFrameTimeMs = std::chrono::duration<double, std::milli>{cpuFrameTime}.count();
-    TracyPlot("aurora: cpuFrameTimeMs", cpuFrameTimeMs);
+  const int64_t frameStartNs = g_cpuFrameStartNs;
+  int64_t cpuFrameTimeNs = 0;
+  if (frameStartNs != 0) {
+    cpuFrameTimeNs = g_framePacer.now() - frameStartNs;
+    g_framePacer.record_cpu_frame(cpuFrameTimeNs);
+    TracyPlot("aurora: cpuFrameTimeMs", static_cast<double>(cpuFrameTimeNs) / 1'000'000.0);
   }
   const auto recorded = end_recording();
   auto& frame = *recorded.packet;
@@ -671,28 +645,39 @@ void end_frame(EndFrameCallback callback) {
   ++g_frameIndex;
 
   const size_t stagingSlot = frame.stagingBuffer;
-  render_worker::enqueue_end_frame(frameId, [frameSlot, stagingSlot, callback = std::move(callback)]() mutable {
+  const auto timing = frame_timing::end_cpu_frame(frameId, cpuFrameTimeNs);
+  render_worker::enqueue_end_frame(frameId, [frameSlot, stagingSlot, frameStartNs, timing,
+                                               callback = std::move(callback)]() mutable {
     auto& packet = g_framePackets[frameSlot];
     g_stagingBuffers[stagingSlot].Unmap();
     g_mappingStates[stagingSlot].store(BufferMapState::Unmapped, std::memory_order_release);
+    if (packet.encoder) {
+      flush_staging(packet.encoder, packet);
+    }
     auto encoder = std::move(packet.encoder);
     const auto stats = packet.stats;
     auto afterSubmitCallbacks = std::move(packet.afterSubmitCallbacks);
     packet = {};
     g_resources.stats.drawCallCount = stats.drawCallCount;
     g_resources.stats.mergedDrawCallCount = stats.mergedDrawCallCount;
+    g_resources.stats.instancedDrawCallCount = stats.instancedDrawCallCount;
     g_resources.stats.lastVertSize = stats.lastVertSize;
     g_resources.stats.lastUniformSize = stats.lastUniformSize;
     g_resources.stats.lastIndexSize = stats.lastIndexSize;
     g_resources.stats.lastStorageSize = stats.lastStorageSize;
     g_resources.stats.lastTextureUploadSize = stats.lastTextureUploadSize;
+    g_resources.stats.residentOffscreenTargetSize = stats.residentOffscreenTargetSize;
+    g_resources.stats.peakOffscreenTargetSize = stats.peakOffscreenTargetSize;
     if (callback) {
+      g_presentingFrameStartNs = frameStartNs;
       callback(encoder, std::move(afterSubmitCallbacks));
+      g_presentingFrameStartNs = 0;
     }
     g_frameSlots.release(frameSlot);
     expire_cached_bind_groups();
     map_staging_buffer(stagingSlot, true);
     process_events();
+    frame_timing::end_worker_frame(timing);
   });
 }
 
@@ -706,18 +691,23 @@ void synchronize() { render_worker::synchronize(); }
 
 void after_present() noexcept {
   const auto now = PresentClock::now();
-  const int64_t nowNs = timestamp_ns(now);
-  const int64_t previousPresentNs = g_lastPresentNs.exchange(nowNs, std::memory_order_acq_rel);
-  if (previousPresentNs != 0) {
-    update_ema(g_presentPeriodNs, nowNs - previousPresentNs);
-    const double presentPeriodMs = static_cast<double>(g_presentPeriodNs.load(std::memory_order_acquire)) / 1'000'000.0;
-    TracyPlot("aurora: presentPeriodMs", presentPeriodMs);
-  }
+  g_framePacer.record_present(g_presentingFrameStartNs);
+  g_resources.stats.estimatedLatencyUs = to_us(g_framePacer.estimated_latency());
+  TracyPlot("aurora: presentPeriodMs", static_cast<double>(g_framePacer.present_period()) / 1'000'000.0);
+  TracyPlot("aurora: estimatedLatencyMs", static_cast<double>(g_framePacer.estimated_latency()) / 1'000'000.0);
   std::lock_guard lock{g_presentStatsMutex};
   g_presentTimes.push_back(now);
   prune_present_times(now);
 }
 
+void set_frame_pacing(AuroraFramePacing mode) noexcept {
+  mode = sanitize_frame_pacing(mode);
+  g_config.framePacing = mode;
+  g_framePacer.set_mode(mode);
+}
+
+AuroraFramePacing frame_pacing() noexcept { return g_framePacer.mode(); }
+
 float calculate_fps() noexcept {
   const auto now = PresentClock::now();
   std::lock_guard lock{g_presentStatsMutex};
@@ -736,3 +726,49 @@ float calculate_fps() noexcept {
 
 const AuroraStats* aurora_get_stats() { return &aurora::gfx::detail::resources().stats; }
 float aurora_get_fps() { return aurora::gfx::calculate_fps(); }
+void aurora_set_frame_pacing(AuroraFramePacing mode) { aurora::gfx::set_frame_pacing(mode); }
+AuroraFramePacing aurora_get_frame_pacing() { return aurora::gfx::frame_pacing(); }
+void aurora_set_draw_reordering(bool enabled) { aurora::gfx::set_draw_reordering(enabled); }
+bool aurora_get_draw_reordering() { return aurora::gfx::draw_reordering(); }
+void aurora_set_vertex_predecode_budget(uint32_t bytes) { aurora::gx::vertex_decode::set_budget(bytes); }
+uint32_t aurora_get_vertex_predecode_budget() { return static_cast<uint32_t>(aurora::gx::vertex_decode::budget()); }
+void aurora_set_pipeline_tag(const char* tag) { aurora::gfx::set_pipeline_tag(tag != nullptr ? tag : ""); }
+uint32_t aurora_prefetch_pipelines(const char* tag) {
+  if (tag == nullptr) {
+    return 0;
+  }
+  return static_cast<uint32_t>(aurora::gfx::prefetch_pipelines(tag));
+}
+uint32_t aurora_get_pipeline_tag_stats(AuroraPipelineTagStats* out, uint32_t maxCount) {
+  if (out == nullptr) {
+    return static_cast<uint32_t>(aurora::gfx::pipeline_tag_count());
+  }
+  return static_cast<uint32_t>(aurora::gfx::copy_pipeline_tag_stats({out, maxCount}));
+}
+void aurora_set_frame_timing_enabled(bool enabled) { aurora::gfx::frame_timing::set_enabled(enabled); }
+bool aurora_get_frame_timing_enabled() { return aurora::gfx::frame_timing::enabled(); }
+uint32_t aurora_get_frame_timings(AuroraFrameTiming* out, uint32_t maxCount) {
+  if (out == nullptr) {
+    return 0;
+  }
+  return static_cast<uint32_t>(aurora::gfx::frame_timing::copy_history({out, maxCount}));
+}
+const char* aurora_get_frame_phase_name(AuroraFramePhase phase) {
+  return aurora::gfx::frame_timing::phase_name(static_cast<aurora::gfx::frame_timing::Phase>(phase));
+}
+bool aurora_dump_frame_timings(const char* path, AuroraFrameTimingFormat format) {
+  using namespace aurora::gfx;
+  if (path == nullptr) {
+    return false;
+  }
+  std::vector<AuroraFrameTiming> frames(frame_timing::HistorySize);
+  frames.resize(frame_timing::copy_history(frames));
+  const auto text = format == AURORA_FRAME_TIMING_CSV ? frame_timing::format_csv(frames)
+                                                      : frame_timing::format_json(frames);
+  const auto* data = reinterpret_cast<const uint8_t*>(text.data());
+  if (!aurora::io::write_file(aurora::io::fs_path_from_string(path), {data, text.size()})) {
+    Log.warn("Failed to write frame timings to {}", path);
+    return false;
+  }
+  return true;
+}
@@ -39,5 +39,7 @@ uint32_t current_frame() noexcept;
 void after_submit() noexcept;
 void gpu_synchronize();
 void after_present() noexcept;
+void set_frame_pacing(AuroraFramePacing mode) noexcept;
+AuroraFramePacing frame_pacing() noexcept;
 float calculate_fps() noexcept;
 } // namespace aurora::gfx
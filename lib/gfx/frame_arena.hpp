@@ -0,0 +1,206 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace aurora::gfx::detail {
+
+// Linear allocator owned by a frame slot. Blocks are retained across frames, so once a slot has grown to its working
+// set, reset() rewinds the cursor to the first block and runs destructors for the (few) non-trivial objects created
+// through make(). Only the recording thread allocates. The render worker reads objects that were published to it
+// through the op queue, and blocks never move, so no further synchronization is needed.
+class FrameArena {
+public:
+  static constexpr size_t BlockSize = 256 * 1024;
+
+  FrameArena() noexcept = default;
+  FrameArena(const FrameArena&) = delete;
+  FrameArena& operator=(const FrameArena&) = delete;
+  ~FrameArena() { release(); }
+
+  [[nodiscard]] void* allocate(size_t size, size_t alignment) {
+    std::byte* ptr = align_cursor(alignment);
+    if (ptr == nullptr || size > static_cast<size_t>(m_end - ptr)) {
+      next_block(size + alignment);
+      ptr = align_cursor(alignment);
+    }
+    m_cursor = ptr + size;
+    return ptr;
+  }
+
+  template <typename T, typename... Args>
+  T* make(Args&&... args) {
+    T* obj = new (allocate(sizeof(T), alignof(T))) T{std::forward<Args>(args)...};
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      m_finalizers = new (allocate(sizeof(Finalizer), alignof(Finalizer)))
+          Finalizer{[](void* ptr) { static_cast<T*>(ptr)->~T(); }, obj, m_finalizers};
+    }
+    return obj;
+  }
+
+  const char* copy_string(std::string_view str) {
+    auto* dst = static_cast<char*>(allocate(str.size() + 1, 1));
+    std::memcpy(dst, str.data(), str.size());
+    dst[str.size()] = '\0';
+    return dst;
+  }
+
+  // Destroys all objects and rewinds to the start of the first block. Memory is kept for the next frame.
+  void reset() noexcept {
+    run_finalizers();
+    m_block = 0;
+    if (m_blocks.empty()) {
+      m_cursor = m_end = nullptr;
+    } else {
+      m_cursor = m_blocks.front().data.get();
+      m_end = m_cursor + m_blocks.front().size;
+    }
+  }
+
+  // Destroys all objects and frees every block.
+  void release() noexcept {
+    run_finalizers();
+    m_blocks.clear();
+    m_block = 0;
+    m_cursor = m_end = nullptr;
+  }
+
+  [[nodiscard]] size_t capacity() const noexcept {
+    size_t total = 0;
+    for (const auto& block : m_blocks) {
+      total += block.size;
+    }
+    return total;
+  }
+  [[nodiscard]] size_t block_count() const noexcept { return m_blocks.size(); }
+
+private:
+  struct Block {
+    std::unique_ptr<std::byte[]> data;
+    size_t size = 0;
+  };
+  struct Finalizer {
+    void (*destroy)(void*);
+    void* ptr;
+    Finalizer* next;
+  };
+
+  std::vector<Block> m_blocks;
+  size_t m_block = 0;
+  std::byte* m_cursor = nullptr;
+  std::byte* m_end = nullptr;
+  Finalizer* m_finalizers = nullptr;
+
+  std::byte* align_cursor(size_t alignment) const noexcept {
+    if (m_cursor == nullptr) {
+      return nullptr;
+    }
+    const auto addr = reinterpret_cast<uintptr_t>(m_cursor);
+    const auto aligned = (addr + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+    if (aligned > reinterpret_cast<uintptr_t>(m_end)) {
+      return nullptr;
+    }
+    return m_cursor + (aligned - addr);
+  }
+
+  void next_block(size_t minSize) {
+    size_t idx = m_cursor == nullptr ? m_block : m_block + 1;
+    // Blocks too small for an oversized allocation are skipped for the rest of the frame.
+    while (idx < m_blocks.size() && m_blocks[idx].size < minSize) {
+      ++idx;
+    }
+    if (idx >= m_blocks.size()) {
+      const size_t size = std::max(BlockSize, minSize);
+      m_blocks.push_back({std::make_unique_for_overwrite<std::byte[]>(size), size});
+      idx = m_blocks.size() - 1;
+    }
+    m_block = idx;
+    m_cursor = m_blocks[idx].data.get();
+    m_end = m_cursor + m_blocks[idx].size;
+  }
+
+  void run_finalizers() noexcept {
+    for (auto* fin = m_finalizers; fin != nullptr; fin = fin->next) {
+      fin->destroy(fin->ptr);
+    }
+    m_finalizers = nullptr;
+  }
+};
+
+// Append-only list of arena-allocated objects with stable addresses and O(1) indexing. The chunk directory is
+// replaced (never resized in place) when it fills, so a reader indexing below a count it received through the op
+// queue never observes a reallocation.
+template <typename T>
+class FrameList {
+public:
+  static constexpr size_t ChunkSize = 64;
+
+  T& emplace_back(FrameArena& arena, auto&&... args) {
+    const size_t chunk = m_size / ChunkSize;
+    if (m_size % ChunkSize == 0) {
+      if (chunk == m_directorySize) {
+        grow_directory(arena);
+      }
+      m_directory.load(std::memory_order_relaxed)[chunk] =
+          static_cast<T*>(arena.allocate(sizeof(T) * ChunkSize, alignof(T)));
+    }
+    T* slot = m_directory.load(std::memory_order_relaxed)[chunk] + m_size % ChunkSize;
+    T* obj = new (slot) T{std::forward<decltype(args)>(args)...};
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      arena.make<Owner>(obj);
+    }
+    ++m_size;
+    return *obj;
+  }
+
+  [[nodiscard]] T& operator[](size_t idx) const noexcept {
+    return m_directory.load(std::memory_order_acquire)[idx / ChunkSize][idx % ChunkSize];
+  }
+  [[nodiscard]] size_t size() const noexcept { return m_size; }
+  [[nodiscard]] bool empty() const noexcept { return m_size == 0; }
+
+  FrameList() noexcept = default;
+  FrameList(FrameList&& rhs) noexcept
+  : m_directory(rhs.m_directory.load(std::memory_order_relaxed))
+  , m_directorySize(std::exchange(rhs.m_directorySize, 0))
+  , m_size(std::exchange(rhs.m_size, 0)) {
+    rhs.m_directory.store(nullptr, std::memory_order_relaxed);
+  }
+  FrameList& operator=(FrameList&& rhs) noexcept {
+    m_directory.store(rhs.m_directory.exchange(nullptr, std::memory_order_relaxed), std::memory_order_relaxed);
+    m_directorySize = std::exchange(rhs.m_directorySize, 0);
+    m_size = std::exchange(rhs.m_size, 0);
+    return *this;
+  }
+
+private:
+  struct Owner {
+    T* obj;
+    ~Owner() { obj->~T(); }
+  };
+
+  std::atomic<T**> m_directory = nullptr;
+  size_t m_directorySize = 0;
+  size_t m_size = 0;
+
+  void grow_directory(FrameArena& arena) {
+    const size_t newSize = m_directorySize == 0 ? 16 : m_directorySize * 2;
+    auto** directory = static_cast<T**>(arena.allocate(sizeof(T*) * newSize, alignof(T*)));
+    if (m_directorySize != 0) {
+      std::memcpy(directory, m_directory.load(std::memory_order_relaxed), sizeof(T*) * m_directorySize);
+    }
+    m_directory.store(directory, std::memory_order_release);
+    m_directorySize = newSize;
+  }
+};
+
+} // namespace aurora::gfx::detail
@@ -0,0 +1,143 @@
+#include "frame_pacing.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace aurora::gfx::detail {
+namespace {
+constexpr int64_t PacingEmaWeight = 8;
+
+int64_t steady_now() noexcept {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void sleep_wait(int64_t durationNs) { std::this_thread::sleep_for(std::chrono::nanoseconds{durationNs}); }
+
+void update_ema(std::atomic_int64_t& value, int64_t sample) noexcept {
+  if (sample <= 0 || sample > FramePacer::MaxSampleNs) {
+    return;
+  }
+
+  int64_t current = value.load(std::memory_order_acquire);
+  while (true) {
+    const int64_t next = current == 0 ? sample : current + (sample - current) / PacingEmaWeight;
+    if (value.compare_exchange_weak(current, next, std::memory_order_acq_rel, std::memory_order_acquire)) {
+      return;
+    }
+  }
+}
+} // namespace
+
+FramePacer::FramePacer(NowFunction now, WaitFunction wait) noexcept
+: m_now(now != nullptr ? now : steady_now), m_wait(wait != nullptr ? wait : sleep_wait) {}
+
+void FramePacer::reset() noexcept {
+  m_cpuSamples.fill(0);
+  m_cpuSampleCount = 0;
+  m_cpuSampleNext = 0;
+  m_lastWaitNs = 0;
+  m_backoffFrames = 0;
+  m_lastPresentNs.store(0, std::memory_order_release);
+  m_presentPeriodNs.store(0, std::memory_order_release);
+  m_latencyNs.store(0, std::memory_order_release);
+  m_missedPresents.store(0, std::memory_order_release);
+}
+
+int64_t FramePacer::now() const noexcept { return m_now(); }
+
+int64_t FramePacer::pace(bool framesInFlight) {
+  if (m_missedPresents.exchange(0, std::memory_order_acq_rel) != 0) {
+    m_backoffFrames = MissBackoffFrames;
+  } else if (m_backoffFrames != 0) {
+    --m_backoffFrames;
+  }
+
+  m_lastWaitNs = 0;
+  if (!framesInFlight) {
+    return 0;
+  }
+  const int64_t targetNs = target_start();
+  if (targetNs == 0) {
+    return 0;
+  }
+
+  const int64_t startNs = now();
+  int64_t nowNs = startNs;
+  while (nowNs < targetNs) {
+    m_wait(std::min<int64_t>(targetNs - nowNs, 1'000'000));
+    nowNs = now();
+  }
+  m_lastWaitNs = nowNs - startNs;
+  return m_lastWaitNs;
+}
+
+int64_t FramePacer::target_start() const noexcept {
+  const auto pacing = mode();
+  if (pacing != FRAME_PACING_LOW_LATENCY && pacing != FRAME_PACING_ADAPTIVE) {
+    return 0;
+  }
+
+  const int64_t lastPresentNs = m_lastPresentNs.load(std::memory_order_acquire);
+  const int64_t presentPeriodNs = present_period();
+  const int64_t cpuFrameTimeNs = cpu_frame_time(pacing == FRAME_PACING_ADAPTIVE ? 95 : 90);
+  if (lastPresentNs == 0 || presentPeriodNs == 0 || cpuFrameTimeNs == 0) {
+    return 0;
+  }
+
+  int64_t marginNs = SafetyMarginNs;
+  if (pacing == FRAME_PACING_ADAPTIVE) {
+    if (m_backoffFrames != 0) {
+      return 0;
+    }
+    // Widen the margin by the observed jitter, and give up entirely when the frame would not fit anyway.
+    marginNs += cpu_frame_time(99) - cpu_frame_time(50);
+    if (cpuFrameTimeNs + marginNs >= presentPeriodNs) {
+      return 0;
+    }
+  }
+
+  // Never wait longer than one present period, even if the last present timestamp is skewed.
+  const int64_t targetNs = lastPresentNs + presentPeriodNs - cpuFrameTimeNs - marginNs;
+  return std::min(targetNs, now() + presentPeriodNs);
+}
+
+void FramePacer::record_cpu_frame(int64_t durationNs) noexcept {
+  if (durationNs <= 0 || durationNs > MaxSampleNs) {
+    return;
+  }
+  m_cpuSamples[m_cpuSampleNext] = durationNs;
+  m_cpuSampleNext = (m_cpuSampleNext + 1) % CpuSampleCount;
+  m_cpuSampleCount = std::min(m_cpuSampleCount + 1, CpuSampleCount);
+}
+
+void FramePacer::record_present(int64_t frameStartNs) noexcept {
+  const int64_t nowNs = now();
+  const int64_t previousPresentNs = m_lastPresentNs.exchange(nowNs, std::memory_order_acq_rel);
+  if (previousPresentNs != 0) {
+    const int64_t intervalNs = nowNs - previousPresentNs;
+    const int64_t periodNs = present_period();
+    if (periodNs != 0 && intervalNs > periodNs + periodNs / 2) {
+      m_missedPresents.fetch_add(1, std::memory_order_acq_rel);
+    }
+    update_ema(m_presentPeriodNs, intervalNs);
+  }
+  if (frameStartNs != 0) {
+    update_ema(m_latencyNs, nowNs - frameStartNs);
+  }
+}
+
+int64_t FramePacer::cpu_frame_time(uint32_t percentile) const noexcept {
+  if (m_cpuSampleCount == 0) {
+    return 0;
+  }
+  std::array<int64_t, CpuSampleCount> sorted;
+  std::copy_n(m_cpuSamples.begin(), m_cpuSampleCount, sorted.begin());
+  const auto end = sorted.begin() + static_cast<ptrdiff_t>(m_cpuSampleCount);
+  const auto nth = sorted.begin() + static_cast<ptrdiff_t>((m_cpuSampleCount - 1) * std::min(percentile, 100u) / 100);
+  std::nth_element(sorted.begin(), nth, end);
+  return *nth;
+}
+
+} // namespace aurora::gfx::detail
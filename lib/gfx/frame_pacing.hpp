@@ -0,0 +1,70 @@
+#pragma once
+
+#include <aurora/aurora.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace aurora::gfx::detail {
+
+// Delays the start of a frame so that its CPU work finishes just ahead of the next present, instead of running a full
+// frame slot ahead of the display. All timestamps are nanoseconds on the pacer's clock.
+//
+// Threading: set_mode may be called from any thread. record_present is called from the thread that presents (the
+// render worker); everything else is called from the frame thread.
+class FramePacer {
+public:
+  using NowFunction = int64_t (*)() noexcept;
+  using WaitFunction = void (*)(int64_t durationNs);
+
+  static constexpr size_t CpuSampleCount = 64;
+  static constexpr int64_t SafetyMarginNs = 2'000'000;
+  static constexpr int64_t MaxSampleNs = 250'000'000;
+  // Adaptive mode stops waiting for this many frames after a present misses its vblank.
+  static constexpr uint32_t MissBackoffFrames = 60;
+
+  // A null clock uses the steady clock; a null wait function sleeps the calling thread.
+  explicit FramePacer(NowFunction now = nullptr, WaitFunction wait = nullptr) noexcept;
+
+  void set_mode(AuroraFramePacing mode) noexcept { m_mode.store(mode, std::memory_order_release); }
+  [[nodiscard]] AuroraFramePacing mode() const noexcept { return m_mode.load(std::memory_order_acquire); }
+  void reset() noexcept;
+
+  [[nodiscard]] int64_t now() const noexcept;
+
+  // Waits until the predicted start time of the next frame, if any, and returns the time spent waiting.
+  // framesInFlight should be false when the GPU is idle, in which case there is nothing to pace against.
+  int64_t pace(bool framesInFlight);
+  // Computes the predicted start time without waiting. Returns 0 when the current mode would not wait.
+  [[nodiscard]] int64_t target_start() const noexcept;
+
+  void record_cpu_frame(int64_t durationNs) noexcept;
+  void record_present(int64_t frameStartNs) noexcept;
+
+  // Rolling percentile of the recorded CPU frame times, or 0 before any samples.
+  [[nodiscard]] int64_t cpu_frame_time(uint32_t percentile) const noexcept;
+  [[nodiscard]] int64_t present_period() const noexcept { return m_presentPeriodNs.load(std::memory_order_acquire); }
+  [[nodiscard]] int64_t last_wait() const noexcept { return m_lastWaitNs; }
+  // Smoothed time from frame start to present.
+  [[nodiscard]] int64_t estimated_latency() const noexcept { return m_latencyNs.load(std::memory_order_acquire); }
+
+private:
+  NowFunction m_now;
+  WaitFunction m_wait;
+  std::atomic<AuroraFramePacing> m_mode = FRAME_PACING_OFF;
+
+  std::array<int64_t, CpuSampleCount> m_cpuSamples{};
+  size_t m_cpuSampleCount = 0;
+  size_t m_cpuSampleNext = 0;
+  int64_t m_lastWaitNs = 0;
+  uint32_t m_backoffFrames = 0;
+
+  std::atomic_int64_t m_lastPresentNs = 0;
+  std::atomic_int64_t m_presentPeriodNs = 0;
+  std::atomic_int64_t m_latencyNs = 0;
+  std::atomic_uint32_t m_missedPresents = 0;
+};
+
+} // namespace aurora::gfx::detail
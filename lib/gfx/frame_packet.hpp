@@ -1,5 +1,6 @@
 #pragma once
 
+#include "frame_arena.hpp"
 #include "pipeline_cache.hpp"
 #include "types.hpp"
 #include "tex_palette_conv.hpp"
@@ -9,6 +10,8 @@
 #include <cstddef>
 #include <cstdint>
 #include <deque>
+#include <iterator>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -21,12 +24,15 @@ struct StagingHighWater {
   uint32_t storage = 0;
   uint32_t textureUpload = 0;
   size_t textureUploadCount = 0;
+  size_t bufferUploadCount = 0;
 };
 
 struct CustomDrawCommand {
   DrawTypeId type = 0;
   uint32_t payloadSize = 0;
-  alignas(std::max_align_t) std::array<std::byte, InlineDrawPayloadSize> payload{};
+
+  // Payload bytes follow the command in the stream.
+  [[nodiscard]] std::byte* payload() noexcept;
 };
 
 struct RenderPass;
@@ -34,10 +40,23 @@ using DrawEncoder = void (*)(void* payload, const wgpu::RenderPassEncoder& pass,
 
 struct DrawCommand {
   DrawEncoder encoder = nullptr;
-  alignas(std::max_align_t) std::array<std::byte, InlineDrawPayloadSize> payload{};
+  uint32_t payloadSize = 0;
+
+  // Payload bytes follow the command in the stream.
+  [[nodiscard]] std::byte* payload() noexcept;
 };
 
-enum class CommandType {
+inline constexpr size_t CommandAlignment = alignof(std::max_align_t);
+
+inline std::byte* CustomDrawCommand::payload() noexcept {
+  return reinterpret_cast<std::byte*>(this) + AURORA_ALIGN(sizeof(CustomDrawCommand), CommandAlignment);
+}
+
+inline std::byte* DrawCommand::payload() noexcept {
+  return reinterpret_cast<std::byte*>(this) + AURORA_ALIGN(sizeof(DrawCommand), CommandAlignment);
+}
+
+enum class CommandType : uint32_t {
   SetViewport,
   SetScissor,
   Draw,
@@ -45,21 +64,117 @@ enum class CommandType {
   DebugMarker,
 };
 
+#ifdef AURORA_GFX_DEBUG_GROUPS
+// Interned node of the debug group stack. Commands recorded under the same stack share one node, so replay only
+// compares pointers to find where the stack changed.
+struct DebugGroup {
+  const DebugGroup* parent = nullptr;
+  const char* label = nullptr;
+  uint32_t depth = 0;
+};
+#endif
+
+// Variable-size command record in a pass's CommandStream. The command body (Viewport, ClipRect, DrawCommand,
+// CustomDrawCommand or a debug marker label) starts at the next CommandAlignment boundary after the header.
 struct Command {
+  Command* next = nullptr;
   CommandType type;
+  uint32_t size = 0;
 #ifdef AURORA_GFX_DEBUG_GROUPS
-  std::vector<std::string> debugGroupStack;
+  const DebugGroup* debugGroup = nullptr;
 #endif
-  union Data {
-    Viewport setViewport;
-    ClipRect setScissor;
-    DrawCommand draw;
-    CustomDrawCommand customDraw;
-    size_t debugMarkerIndex;
-  } data;
+
+  [[nodiscard]] std::byte* body() noexcept;
+  template <typename T>
+  [[nodiscard]] T& as() noexcept {
+    static_assert(alignof(T) <= alignof(std::max_align_t));
+    return *std::launder(reinterpret_cast<T*>(body()));
+  }
+  template <typename T>
+  [[nodiscard]] const T& as() const noexcept {
+    return const_cast<Command*>(this)->as<T>();
+  }
 };
 
-using CommandList = std::vector<Command>;
+inline constexpr size_t CommandBodyOffset = AURORA_ALIGN(sizeof(Command), CommandAlignment);
+
+inline std::byte* Command::body() noexcept { return reinterpret_cast<std::byte*>(this) + CommandBodyOffset; }
+
+// Singly-linked stream of commands allocated from the frame arena. Commands of one pass are usually contiguous in
+// memory, but may be interleaved with another pass's (e.g. while the EFB pass is suspended for offscreen rendering).
+class CommandStream {
+public:
+  class Iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Command;
+    using difference_type = std::ptrdiff_t;
+    using pointer = Command*;
+    using reference = Command&;
+
+    Iterator() noexcept = default;
+    explicit Iterator(Command* cmd) noexcept : m_cmd(cmd) {}
+    Command& operator*() const noexcept { return *m_cmd; }
+    Command* operator->() const noexcept { return m_cmd; }
+    Iterator& operator++() noexcept {
+      m_cmd = m_cmd->next;
+      return *this;
+    }
+    Iterator operator++(int) noexcept {
+      Iterator prev = *this;
+      m_cmd = m_cmd->next;
+      return prev;
+    }
+    bool operator==(const Iterator& rhs) const noexcept { return m_cmd == rhs.m_cmd; }
+
+  private:
+    Command* m_cmd = nullptr;
+  };
+
+  // Appends a command with `bodySize` bytes of uninitialized body storage.
+  Command& push(FrameArena& arena, CommandType type, size_t bodySize) {
+    auto* cmd = new (arena.allocate(CommandBodyOffset + bodySize, CommandAlignment)) Command{
+        .type = type,
+        .size = static_cast<uint32_t>(bodySize),
+    };
+    if (m_tail != nullptr) {
+      m_tail->next = cmd;
+    } else {
+      m_head = cmd;
+    }
+    m_tail = cmd;
+    ++m_size;
+    return *cmd;
+  }
+
+  // Rebuilds the list in the order given by `order`, which must hold exactly this stream's commands.
+  void relink(std::span<Command* const> order) noexcept {
+    Command* prev = nullptr;
+    for (auto* cmd : order) {
+      if (prev != nullptr) {
+        prev->next = cmd;
+      } else {
+        m_head = cmd;
+      }
+      prev = cmd;
+    }
+    if (prev != nullptr) {
+      prev->next = nullptr;
+    }
+    m_tail = prev;
+  }
+
+  [[nodiscard]] Iterator begin() const noexcept { return Iterator{m_head}; }
+  [[nodiscard]] Iterator end() const noexcept { return Iterator{}; }
+  [[nodiscard]] Command* back() const noexcept { return m_tail; }
+  [[nodiscard]] size_t size() const noexcept { return m_size; }
+  [[nodiscard]] bool empty() const noexcept { return m_size == 0; }
+
+private:
+  Command* m_head = nullptr;
+  Command* m_tail = nullptr;
+  size_t m_size = 0;
+};
 
 struct RenderPass {
   struct ColorAttachment {
@@ -82,6 +197,8 @@ struct RenderPass {
   wgpu::Texture copySourceTexture;
   wgpu::TextureView copySourceView;
   wgpu::TextureView copySourceDepthView;
+  // Full size of copySourceTexture. Offscreen targets are pooled and may be larger than the color attachment size.
+  wgpu::Extent3D copySourceSize;
   uint32_t msaaSamples = 1;
 
   TextureHandle resolveTarget;
@@ -96,7 +213,7 @@ struct RenderPass {
   wgpu::LoadOp stencilLoadOp = wgpu::LoadOp::Undefined;
   wgpu::StoreOp stencilStoreOp = wgpu::StoreOp::Undefined;
   uint32_t stencilClearValue = 0;
-  CommandList commands;
+  CommandStream commands;
   bool clearDepth = true;
   bool hasDepth = true;
   bool hasStencil = false;
@@ -175,8 +292,9 @@ struct FrameOp {
   RenderPass* renderPass = nullptr;
   TextureCopy* textureCopy = nullptr;
   EncoderTask* encoderTask = nullptr;
+  // Staging ring offsets and texture/buffer upload counts recorded before this op; uploads in
+  // [copied.textureUploadCount, highWater.textureUploadCount) are encoded ahead of it, likewise for buffer uploads.
   StagingHighWater highWater;
-  std::vector<const TextureUpload*> textureUploads;
 };
 
 using RenderPassList = std::deque<RenderPass>;
@@ -186,10 +304,9 @@ struct FramePacket {
   std::deque<TextureCopy> textureCopies;
   std::deque<EncoderTask> encoderTasks;
   std::deque<FrameOp> ops;
-  std::deque<TextureUpload> textureUploads;
-#ifdef AURORA_GFX_DEBUG_GROUPS
-  std::vector<std::string> debugMarkers;
-#endif
+  FrameList<TextureUpload> textureUploads;
+  FrameList<BufferUpload> bufferUploads;
+  FrameArena* arena = nullptr;
   ByteBuffer verts;
   ByteBuffer uniforms;
   ByteBuffer indices;
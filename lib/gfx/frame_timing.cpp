@@ -0,0 +1,112 @@
+#include "frame_timing.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <mutex>
+
+#include <fmt/format.h>
+
+namespace aurora::gfx::frame_timing {
+namespace {
+constexpr std::array<const char*, PhaseCount> PhaseNames{
+    "fifo", "draw_build", "texture_convert", "pipeline_lookup", "encode", "submit", "present",
+};
+
+std::mutex g_historyMutex;
+std::array<AuroraFrameTiming, HistorySize> g_history;
+size_t g_historyNext = 0;
+size_t g_historyCount = 0;
+
+uint32_t to_us(int64_t ns) noexcept { return static_cast<uint32_t>(std::clamp<int64_t>(ns / 1000, 0, UINT32_MAX)); }
+
+void drain_phases(AuroraFrameTiming& record, size_t first, size_t last) noexcept {
+  for (size_t i = first; i < last; ++i) {
+    auto& acc = detail::g_phases[i];
+    record.phaseUs[i] = to_us(acc.ns.exchange(0, std::memory_order_relaxed));
+    record.phaseCalls[i] = acc.calls.exchange(0, std::memory_order_relaxed);
+  }
+}
+} // namespace
+
+void set_enabled(bool enabled) noexcept { detail::g_enabled.store(enabled, std::memory_order_relaxed); }
+
+AuroraFrameTiming end_cpu_frame(uint64_t frameId, int64_t cpuFrameNs) noexcept {
+  AuroraFrameTiming record{
+      .frameId = frameId,
+      .cpuFrameUs = to_us(cpuFrameNs),
+  };
+  drain_phases(record, 0, static_cast<size_t>(FirstWorkerPhase));
+  return record;
+}
+
+void end_worker_frame(AuroraFrameTiming record) noexcept {
+  drain_phases(record, static_cast<size_t>(FirstWorkerPhase), PhaseCount);
+  if (!enabled()) {
+    return;
+  }
+  std::lock_guard lock{g_historyMutex};
+  g_history[g_historyNext] = record;
+  g_historyNext = (g_historyNext + 1) % HistorySize;
+  g_historyCount = std::min(g_historyCount + 1, HistorySize);
+}
+
+size_t copy_history(std::span<AuroraFrameTiming> out) noexcept {
+  std::lock_guard lock{g_historyMutex};
+  const size_t count = std::min(out.size(), g_historyCount);
+  const size_t first = (g_historyNext + HistorySize - count) % HistorySize;
+  for (size_t i = 0; i < count; ++i) {
+    out[i] = g_history[(first + i) % HistorySize];
+  }
+  return count;
+}
+
+void reset() noexcept {
+  for (auto& acc : detail::g_phases) {
+    acc.ns.store(0, std::memory_order_relaxed);
+    acc.calls.store(0, std::memory_order_relaxed);
+  }
+  std::lock_guard lock{g_historyMutex};
+  g_historyNext = 0;
+  g_historyCount = 0;
+}
+
+const char* phase_name(Phase phase) noexcept {
+  const auto idx = static_cast<size_t>(phase);
+  return idx < PhaseCount ? PhaseNames[idx] : "unknown";
+}
+
+std::string format_json(std::span<const AuroraFrameTiming> frames) {
+  std::string out = "{\"frames\":[";
+  auto it = std::back_inserter(out);
+  for (size_t i = 0; i < frames.size(); ++i) {
+    const auto& frame = frames[i];
+    fmt::format_to(it, "{}{{\"frameId\":{},\"cpuFrameUs\":{},\"phases\":{{", i == 0 ? "" : ",", frame.frameId,
+                   frame.cpuFrameUs);
+    for (size_t phase = 0; phase < PhaseCount; ++phase) {
+      fmt::format_to(it, "{}\"{}\":{{\"us\":{},\"calls\":{}}}", phase == 0 ? "" : ",", PhaseNames[phase],
+                     frame.phaseUs[phase], frame.phaseCalls[phase]);
+    }
+    out += "}}";
+  }
+  out += "]}\n";
+  return out;
+}
+
+std::string format_csv(std::span<const AuroraFrameTiming> frames) {
+  std::string out = "frame_id,cpu_frame_us";
+  auto it = std::back_inserter(out);
+  for (const char* name : PhaseNames) {
+    fmt::format_to(it, ",{0}_us,{0}_calls", name);
+  }
+  out += '\n';
+  for (const auto& frame : frames) {
+    fmt::format_to(it, "{},{}", frame.frameId, frame.cpuFrameUs);
+    for (size_t phase = 0; phase < PhaseCount; ++phase) {
+      fmt::format_to(it, ",{},{}", frame.phaseUs[phase], frame.phaseCalls[phase]);
+    }
+    out += '\n';
+  }
+  return out;
+}
+
+} // namespace aurora::gfx::frame_timing
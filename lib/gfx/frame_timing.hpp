@@ -0,0 +1,92 @@
+#pragma once
+
+#include <aurora/gfx.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+// Lightweight always-on CPU timers for the major frame phases. Timed scopes accumulate into per-phase counters, which
+// are closed into a per-frame record at the end of each frame and kept in a fixed-size history.
+//
+// Threading: ScopedTimer may be used from any thread. end_cpu_frame is called from the frame thread and
+// end_worker_frame from the render worker; history accessors may be called from any thread.
+namespace aurora::gfx::frame_timing {
+
+enum class Phase : uint32_t {
+  // Recorded on the frame thread and FIFO processor; closed by end_cpu_frame.
+  FifoProcess = AURORA_FRAME_PHASE_FIFO,
+  DrawBuild = AURORA_FRAME_PHASE_DRAW_BUILD,
+  TextureConvert = AURORA_FRAME_PHASE_TEXTURE_CONVERT,
+  PipelineLookup = AURORA_FRAME_PHASE_PIPELINE_LOOKUP,
+  // Recorded on the render worker; closed by end_worker_frame.
+  Encode = AURORA_FRAME_PHASE_ENCODE,
+  Submit = AURORA_FRAME_PHASE_SUBMIT,
+  Present = AURORA_FRAME_PHASE_PRESENT,
+  Count = AURORA_FRAME_PHASE_COUNT,
+};
+
+inline constexpr size_t PhaseCount = static_cast<size_t>(Phase::Count);
+inline constexpr Phase FirstWorkerPhase = Phase::Encode;
+inline constexpr size_t HistorySize = 240;
+
+namespace detail {
+struct PhaseAccumulator {
+  std::atomic_int64_t ns = 0;
+  std::atomic_uint32_t calls = 0;
+};
+
+inline std::array<PhaseAccumulator, PhaseCount> g_phases;
+inline std::atomic_bool g_enabled = true;
+
+inline int64_t now() noexcept {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+} // namespace detail
+
+[[nodiscard]] inline bool enabled() noexcept { return detail::g_enabled.load(std::memory_order_relaxed); }
+void set_enabled(bool enabled) noexcept;
+
+inline void add(Phase phase, int64_t durationNs) noexcept {
+  auto& acc = detail::g_phases[static_cast<size_t>(phase)];
+  acc.ns.fetch_add(durationNs, std::memory_order_relaxed);
+  acc.calls.fetch_add(1, std::memory_order_relaxed);
+}
+
+class ScopedTimer {
+public:
+  explicit ScopedTimer(Phase phase) noexcept : m_phase(phase), m_startNs(enabled() ? detail::now() : 0) {}
+  ~ScopedTimer() {
+    if (m_startNs != 0) {
+      add(m_phase, detail::now() - m_startNs);
+    }
+  }
+
+  ScopedTimer(const ScopedTimer&) = delete;
+  ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+  Phase m_phase;
+  int64_t m_startNs;
+};
+
+// Drains the frame thread phases into a new record for frameId.
+[[nodiscard]] AuroraFrameTiming end_cpu_frame(uint64_t frameId, int64_t cpuFrameNs) noexcept;
+// Drains the render worker phases into record and appends it to the history.
+void end_worker_frame(AuroraFrameTiming record) noexcept;
+
+// Copies the most recent frames into out, oldest first, and returns the number copied.
+size_t copy_history(std::span<AuroraFrameTiming> out) noexcept;
+// Clears the history and any partially accumulated frame.
+void reset() noexcept;
+
+[[nodiscard]] const char* phase_name(Phase phase) noexcept;
+[[nodiscard]] std::string format_json(std::span<const AuroraFrameTiming> frames);
+[[nodiscard]] std::string format_csv(std::span<const AuroraFrameTiming> frames);
+
+} // namespace aurora::gfx::frame_timing
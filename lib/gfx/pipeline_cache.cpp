@@ -1,9 +1,11 @@
 #include "pipeline_cache.hpp"
 
 #include "clear.hpp"
+#include "frame_timing.hpp"
 #include "resources.hpp"
 #include "hash.hpp"
 #include "../gx/pipeline.hpp"
+#include "../cache_snapshot.hpp"
 #include "../io.hpp"
 #ifdef AURORA_ENABLE_RMLUI
 #include "../rmlui/pipeline.hpp"
@@ -12,18 +14,24 @@
 #include "../webgpu/gpu.hpp"
 
 #include <algorithm>
+#include <array>
 #include <atomic>
 #include <condition_variable>
+#include <cstdlib>
 #include <deque>
 #include <filesystem>
 #include <limits>
 #include <mutex>
 #include <optional>
+#include <string>
+#include <string_view>
 #include <thread>
 
+#include <SDL3/SDL_error.h>
 #include <SDL3/SDL_iostream.h>
 #include <absl/container/flat_hash_map.h>
 #include <absl/container/flat_hash_set.h>
+#include <absl/container/node_hash_map.h>
 #include <fmt/format.h>
 #include <tracy/Tracy.hpp>
 
@@ -33,6 +41,11 @@ static Module Log("aurora::gfx::pipeline_cache");
 constexpr int PipelineCacheSchema = 1;
 constexpr const char* InitialPipelineCacheName = "initial_pipeline_cache.db";
 constexpr const char* SdlVfsName = "aurora_pipeline_cache_sdl_vfs";
+constexpr const char* PipelineSnapshotName = "pipeline_cache.snapshot";
+// Snapshot keys are the big-endian type, config version and first frame used, padding, then the hash, so that each
+// type and version is a contiguous range in load order
+constexpr uint32_t PipelineSnapshotKeySize = 24;
+using PipelineSnapshotKey = std::array<uint8_t, PipelineSnapshotKeySize>;
 
 struct CachedPipeline {
   wgpu::RenderPipeline pipeline;
@@ -53,6 +66,20 @@ struct PipelineCacheWrite {
   uint32_t firstFrameUsed = UINT32_MAX;
 };
 
+struct PipelineTagWrite {
+  std::string tag;
+  ShaderType type;
+  PipelineRef hash;
+};
+
+// Pipelines requested while a tag was current, in this or previous sessions
+struct PipelineTag {
+  absl::flat_hash_set<PipelineRef> pipelines;
+  uint32_t prefetchedPipelines = 0;
+  uint32_t prefetchHits = 0;
+  uint32_t prefetchMisses = 0;
+};
+
 struct SdlVfsSqliteFile {
   sqlite3_file base;
   SDL_IOStream* io = nullptr;
@@ -76,15 +103,31 @@ static std::deque<PendingPipeline> g_pipelineQueue;
 static std::deque<PendingPipeline> g_backgroundPipelineQueue;
 static absl::flat_hash_set<PipelineRef> g_pendingPipelines;
 static std::atomic_bool g_gpuCachePrunePending = false;
+// Tag state is guarded by g_pipelineMutex. Nodes are stable, so tag names can be handed out until shutdown.
+static absl::node_hash_map<std::string, PipelineTag> g_pipelineTags;
+static PipelineTag* g_currentPipelineTag = nullptr;
+static std::string g_currentPipelineTagName;
+// Prefetched pipelines that haven't been requested since, and the tag that prefetched them
+static absl::flat_hash_map<PipelineRef, PipelineTag*> g_prefetchedPipelines;
+// Bumped on tag changes and prefetches so that the repeated lookup fast path doesn't skip tag tracking
+static std::atomic_uint32_t g_pipelineTagGeneration = 0;
+// Bumped after each pipeline is added to g_pipelines
+static std::atomic_uint32_t g_pipelineGeneration = 0;
 
 static sqlite3* g_pipelineCacheDb = nullptr;
 static sqlite3_stmt* g_pipelineCacheLoadStmt = nullptr;
 static sqlite3_stmt* g_pipelineCacheUpsertStmt = nullptr;
+static sqlite3_stmt* g_pipelineTagInsertStmt = nullptr;
 static bool g_pipelineCacheBroken = false;
+// Stored in PRAGMA user_version and bumped by every transaction that changes pipeline_cache rows, so a snapshot built
+// at this stamp holds exactly the current rows
+static uint32_t g_pipelineCacheStamp = 0;
+static bool g_pipelineSnapshotStale = false;
 static std::thread g_pipelineCacheWriterThread;
 static std::condition_variable g_pipelineCacheWriterCv;
 static std::mutex g_pipelineCacheWriterMutex;
 static std::deque<PipelineCacheWrite> g_pipelineCacheWriteQueue;
+static std::deque<PipelineTagWrite> g_pipelineTagWriteQueue;
 static bool g_pipelineCacheWriterStop = false;
 static int g_sdlVfsRegisterResult = SQLITE_ERROR;
 
@@ -362,6 +405,34 @@ static void enqueue_pipeline_cache_write(PipelineCacheWrite write) {
   g_pipelineCacheWriterCv.notify_one();
 }
 
+static void enqueue_pipeline_tag_write(PipelineTagWrite write) {
+  if (g_pipelineCacheBroken || g_pipelineCacheDb == nullptr) {
+    return;
+  }
+
+  {
+    std::lock_guard lock{g_pipelineCacheWriterMutex};
+    g_pipelineTagWriteQueue.emplace_back(std::move(write));
+  }
+  g_pipelineCacheWriterCv.notify_one();
+}
+
+// Records a requested pipeline in the current tag's set and settles a pending prefetch of it.
+static std::optional<PipelineTagWrite> track_pipeline_tags(ShaderType type, PipelineRef hash, bool ready) {
+  if (const auto it = g_prefetchedPipelines.find(hash); it != g_prefetchedPipelines.end()) {
+    ++(ready ? it->second->prefetchHits : it->second->prefetchMisses);
+    g_prefetchedPipelines.erase(it);
+  }
+  if (g_currentPipelineTag == nullptr || !g_currentPipelineTag->pipelines.insert(hash).second) {
+    return std::nullopt;
+  }
+  return PipelineTagWrite{
+      .tag = g_currentPipelineTagName,
+      .type = type,
+      .hash = hash,
+  };
+}
+
 template <typename Queue>
 static auto find_pending_pipeline(Queue& queue, PipelineRef hash) {
   return std::find_if(queue.begin(), queue.end(), [=](const PendingPipeline& pending) { return pending.hash == hash; });
@@ -370,6 +441,7 @@ static auto find_pending_pipeline(Queue& queue, PipelineRef hash) {
 enum class PipelinePriority {
   Background, // loaded from cache
   Normal,     // async skip draw
+  High,       // async skip draw, compiled ahead of normal requests
   Blocking,   // block until compiled
 };
 
@@ -390,6 +462,7 @@ static PendingPipeline* touch_pending_pipeline(PipelineRef hash, PipelinePriorit
     g_pipelineQueue.emplace_back(std::move(*backgroundIt));
     g_backgroundPipelineQueue.erase(backgroundIt);
     return &g_pipelineQueue.back();
+  case PipelinePriority::High:
   case PipelinePriority::Blocking:
     g_pipelineQueue.emplace_front(std::move(*backgroundIt));
     g_backgroundPipelineQueue.erase(backgroundIt);
@@ -420,6 +493,7 @@ static std::optional<PendingPipeline> take_pending_pipeline(PipelineRef hash) {
 
 static void notify_pipeline_ready(bool queued) {
   ++createdPipelines;
+  g_pipelineGeneration.fetch_add(1, std::memory_order_release);
   if (queued && --queuedPipelines == 0 && g_gpuCachePrunePending.exchange(false, std::memory_order_acq_rel)) {
     // Prune GPU cache entries after fully loading the pipeline cache.
     webgpu::cache_prune();
@@ -428,19 +502,23 @@ static void notify_pipeline_ready(bool queued) {
 }
 
 static PipelineRef g_lastPipelineRef = std::numeric_limits<PipelineRef>::max();
+static uint32_t g_lastPipelineTagGeneration = 0;
 
 template <typename PipelineConfig>
 static PipelineRef find_pipeline_impl(ShaderType type, const PipelineConfig& config, NewPipelineCallback&& cb,
                                       PipelinePriority priority = PipelinePriority::Normal,
                                       std::optional<uint32_t> firstFrameUsedOverride = std::nullopt) {
   ZoneScoped;
+  frame_timing::ScopedTimer timer{frame_timing::Phase::PipelineLookup};
 
   const PipelineRef hash = xxh3_hash(config, static_cast<HashType>(type));
   const bool blocking = priority == PipelinePriority::Blocking;
-  if (!blocking && hash == g_lastPipelineRef) {
+  const uint32_t tagGeneration = g_pipelineTagGeneration.load(std::memory_order_relaxed);
+  if (!blocking && hash == g_lastPipelineRef && tagGeneration == g_lastPipelineTagGeneration) {
     return g_lastPipelineRef;
   }
   g_lastPipelineRef = hash;
+  g_lastPipelineTagGeneration = tagGeneration;
   const uint32_t firstFrameUsed = firstFrameUsedOverride.value_or(current_frame());
   bool notifyWorker = false;
   bool persist = priority != PipelinePriority::Background;
@@ -448,6 +526,7 @@ static PipelineRef find_pipeline_impl(ShaderType type, const PipelineConfig& con
   bool createdPipeline = false;
   bool queued = false;
   std::optional<PipelineCacheWrite> cacheWrite;
+  std::optional<PipelineTagWrite> tagWrite;
   {
     std::scoped_lock guard{g_pipelineMutex};
     auto pipelineIt = g_pipelines.find(hash);
@@ -512,6 +591,7 @@ static PipelineRef find_pipeline_impl(ShaderType type, const PipelineConfig& con
       case PipelinePriority::Normal:
         g_pipelineQueue.emplace_back(std::move(pending));
         break;
+      case PipelinePriority::High:
       case PipelinePriority::Blocking:
         g_pipelineQueue.emplace_front(std::move(pending));
         break;
@@ -523,6 +603,10 @@ static PipelineRef find_pipeline_impl(ShaderType type, const PipelineConfig& con
       ++queuedPipelines;
       notifyWorker = true;
     }
+
+    if (persist) {
+      tagWrite = track_pipeline_tags(type, hash, pipelineReady);
+    }
   }
 
   if (cacheWrite) {
@@ -530,6 +614,10 @@ static PipelineRef find_pipeline_impl(ShaderType type, const PipelineConfig& con
     cacheWrite.reset();
   }
 
+  if (tagWrite) {
+    enqueue_pipeline_tag_write(std::move(*tagWrite));
+  }
+
   if (createdPipeline) {
     notify_pipeline_ready(queued);
   }
@@ -565,6 +653,10 @@ static void pipeline_cache_abort() {
     sqlite3_finalize(g_pipelineCacheUpsertStmt);
     g_pipelineCacheUpsertStmt = nullptr;
   }
+  if (g_pipelineTagInsertStmt != nullptr) {
+    sqlite3_finalize(g_pipelineTagInsertStmt);
+    g_pipelineTagInsertStmt = nullptr;
+  }
   if (g_pipelineCacheDb != nullptr) {
     sqlite3_close(g_pipelineCacheDb);
     g_pipelineCacheDb = nullptr;
@@ -572,6 +664,58 @@ static void pipeline_cache_abort() {
 }
 
 static bool write_pipeline_cache_record(const PipelineCacheWrite& write);
+static bool write_pipeline_tag_record(const PipelineTagWrite& write);
+
+static std::filesystem::path pipeline_snapshot_path() {
+  return io::fs_path_from_string(g_config.cachePath) / PipelineSnapshotName;
+}
+
+static PipelineSnapshotKey pipeline_snapshot_key(ShaderType type, uint32_t configVersion, uint32_t firstFrameUsed,
+                                                 PipelineRef hash) {
+  PipelineSnapshotKey key{};
+  const auto store = [&key](size_t offset, uint64_t value, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+      key[offset + i] = static_cast<uint8_t>(value >> ((size - 1 - i) * 8));
+    }
+  };
+  store(0, underlying(type), 4);
+  store(4, configVersion, 4);
+  store(8, firstFrameUsed, 4);
+  store(16, hash, 8);
+  return key;
+}
+
+static uint32_t pipeline_snapshot_first_frame_used(std::span<const uint8_t> key) {
+  return static_cast<uint32_t>(key[8]) << 24 | static_cast<uint32_t>(key[9]) << 16 |
+         static_cast<uint32_t>(key[10]) << 8 | static_cast<uint32_t>(key[11]);
+}
+
+static bool read_pipeline_cache_stamp() {
+  bool found = false;
+  const auto ret = sqlite::exec(g_pipelineCacheDb, "PRAGMA user_version", [&found](int argc, char** argv, char**) {
+    if (argc == 1 && argv[0] != nullptr) {
+      g_pipelineCacheStamp = static_cast<uint32_t>(std::strtoul(argv[0], nullptr, 10));
+      found = true;
+    }
+  });
+  if (ret != SQLITE_OK || !found) {
+    Log.error("Failed to read pipeline cache stamp: {}", sqlite3_errmsg(g_pipelineCacheDb));
+    return false;
+  }
+  return true;
+}
+
+static bool bump_pipeline_cache_stamp() {
+  // user_version is a signed 32-bit integer
+  const uint32_t stamp = (g_pipelineCacheStamp + 1) & 0x7FFFFFFF;
+  const auto sql = fmt::format("PRAGMA user_version = {}", stamp);
+  if (sqlite::exec(g_pipelineCacheDb, sql.c_str()) != SQLITE_OK) {
+    Log.error("Failed to update pipeline cache stamp: {}", sqlite3_errmsg(g_pipelineCacheDb));
+    return false;
+  }
+  g_pipelineCacheStamp = stamp;
+  return true;
+}
 
 static std::string pipeline_cache_seed_path() {
   if (g_config.resourcesPath == nullptr || g_config.resourcesPath[0] == '\0') {
@@ -620,6 +764,46 @@ static sqlite3* open_pipeline_cache_seed_db(const std::string& path) {
   return seedDb;
 }
 
+// Merges the bundled tag sets, if any. Returns false only if writing to the cache failed.
+static bool seed_pipeline_tags(sqlite3* seedDb, const std::string& seedPath) {
+  sqlite3_stmt* tagStmt = nullptr;
+  auto ret = sqlite3_prepare_v3(seedDb, "SELECT tag, type, hash FROM pipeline_tags", -1, 0, &tagStmt, nullptr);
+  if (ret != SQLITE_OK) {
+    // Bundled caches recorded before pipeline tags existed have no tag table
+    sqlite3_finalize(tagStmt);
+    return true;
+  }
+
+  bool writeFailed = false;
+  uint32_t mergedRows = 0;
+  while ((ret = sqlite3_step(tagStmt)) == SQLITE_ROW) {
+    const auto* tag = reinterpret_cast<const char*>(sqlite3_column_text(tagStmt, 0));
+    const auto typeValue = sqlite3_column_int(tagStmt, 1);
+    constexpr auto MaxShaderTypeValue = std::numeric_limits<std::underlying_type_t<ShaderType>>::max();
+    if (tag == nullptr || tag[0] == '\0' || typeValue < 0 || typeValue > MaxShaderTypeValue) {
+      continue;
+    }
+    const PipelineTagWrite write{
+        .tag = tag,
+        .type = static_cast<ShaderType>(typeValue),
+        .hash = static_cast<PipelineRef>(sqlite3_column_int64(tagStmt, 2)),
+    };
+    if (!write_pipeline_tag_record(write)) {
+      writeFailed = true;
+      break;
+    }
+    ++mergedRows;
+  }
+
+  if (!writeFailed && ret != SQLITE_DONE) {
+    Log.warn("Failed while reading bundled pipeline tags from '{}': {}", seedPath, sqlite3_errmsg(seedDb));
+  } else if (!writeFailed) {
+    Log.info("Seeded {} pipeline tag rows from '{}'", mergedRows, seedPath);
+  }
+  sqlite3_finalize(tagStmt);
+  return !writeFailed;
+}
+
 static void seed_pipeline_cache() {
   if (g_pipelineCacheBroken || g_pipelineCacheDb == nullptr || g_pipelineCacheUpsertStmt == nullptr) {
     return;
@@ -702,6 +886,14 @@ static void seed_pipeline_cache() {
       readFailed = true;
     }
 
+    if (!writeFailed && !readFailed && !seed_pipeline_tags(seedDb, seedPath)) {
+      writeFailed = true;
+    }
+
+    if (!writeFailed && !readFailed && mergedRows != 0 && !bump_pipeline_cache_stamp()) {
+      writeFailed = true;
+    }
+
     if (!writeFailed && !readFailed) {
       tx.commit();
     }
@@ -770,6 +962,7 @@ static bool prepare_pipeline_cache_db() {
     if (!schemaFailed && !schemaMatch) {
       const auto schemaSql = fmt::format(
           R"(DROP TABLE IF EXISTS pipeline_cache;
+DROP TABLE IF EXISTS pipeline_tags;
 CREATE TABLE pipeline_cache (
   type INTEGER NOT NULL,
   hash INTEGER NOT NULL,
@@ -791,6 +984,20 @@ INSERT INTO aurora_schema VALUES ({});)",
       }
     }
 
+    if (!schemaFailed) {
+      // Added after schema version 1; tag sets of older caches simply start out empty
+      ret = sqlite::exec(g_pipelineCacheDb, R"(CREATE TABLE IF NOT EXISTS pipeline_tags (
+  tag TEXT NOT NULL,
+  type INTEGER NOT NULL,
+  hash INTEGER NOT NULL,
+  PRIMARY KEY (tag, type, hash)
+) WITHOUT ROWID;)");
+      if (ret != SQLITE_OK) {
+        Log.error("Failed to create pipeline tag table: {}", sqlite3_errmsg(g_pipelineCacheDb));
+        schemaFailed = true;
+      }
+    }
+
     if (!schemaFailed) {
       tx.commit();
     }
@@ -828,6 +1035,19 @@ INSERT INTO aurora_schema VALUES ({});)",
     return false;
   }
 
+  ret = sqlite3_prepare_v3(g_pipelineCacheDb, "INSERT OR IGNORE INTO pipeline_tags (tag, type, hash) VALUES (?, ?, ?)",
+                           -1, SQLITE_PREPARE_PERSISTENT, &g_pipelineTagInsertStmt, nullptr);
+  if (ret != SQLITE_OK) {
+    Log.error("Failed to prepare pipeline tag insert statement: {}", sqlite3_errmsg(g_pipelineCacheDb));
+    pipeline_cache_abort();
+    return false;
+  }
+
+  if (!read_pipeline_cache_stamp()) {
+    pipeline_cache_abort();
+    return false;
+  }
+
   seed_pipeline_cache();
   if (g_pipelineCacheBroken) {
     return false;
@@ -841,6 +1061,7 @@ static void prune_old_pipeline_cache_versions() {
     return;
   }
 
+  const auto changesBefore = sqlite3_total_changes64(g_pipelineCacheDb);
   const auto clearDelete = fmt::format("DELETE FROM pipeline_cache WHERE type = {} AND config_version < {}",
                                        underlying(ShaderType::Clear), clear::ClearPipelineConfigVersion);
   auto ret = sqlite::exec(g_pipelineCacheDb, clearDelete.c_str());
@@ -859,6 +1080,15 @@ static void prune_old_pipeline_cache_versions() {
     return;
   }
 
+  const auto gxUberDelete = fmt::format("DELETE FROM pipeline_cache WHERE type = {} AND config_version < {}",
+                                        underlying(ShaderType::GXUber), gx::GXPipelineConfigVersion);
+  ret = sqlite::exec(g_pipelineCacheDb, gxUberDelete.c_str());
+  if (ret != SQLITE_OK) {
+    Log.error("Failed to prune GX uber pipeline cache rows: {}", sqlite3_errmsg(g_pipelineCacheDb));
+    pipeline_cache_abort();
+    return;
+  }
+
 #ifdef AURORA_ENABLE_RMLUI
   const auto rmlDelete = fmt::format("DELETE FROM pipeline_cache WHERE type = {} AND config_version < {}",
                                      underlying(ShaderType::Rml), rmlui::RmlPipelineConfigVersion);
@@ -866,8 +1096,22 @@ static void prune_old_pipeline_cache_versions() {
   if (ret != SQLITE_OK) {
     Log.error("Failed to prune RmlUi pipeline cache rows: {}", sqlite3_errmsg(g_pipelineCacheDb));
     pipeline_cache_abort();
+    return;
   }
 #endif
+
+  if (sqlite3_total_changes64(g_pipelineCacheDb) != changesBefore && !bump_pipeline_cache_stamp()) {
+    pipeline_cache_abort();
+    return;
+  }
+
+  ret = sqlite::exec(g_pipelineCacheDb, "DELETE FROM pipeline_tags WHERE NOT EXISTS (SELECT 1 FROM pipeline_cache "
+                                        "WHERE pipeline_cache.type = pipeline_tags.type "
+                                        "AND pipeline_cache.hash = pipeline_tags.hash)");
+  if (ret != SQLITE_OK) {
+    Log.error("Failed to prune pipeline tag rows: {}", sqlite3_errmsg(g_pipelineCacheDb));
+    pipeline_cache_abort();
+  }
 }
 
 static bool write_pipeline_cache_record(const PipelineCacheWrite& write) {
@@ -919,21 +1163,109 @@ static bool write_pipeline_cache_record(const PipelineCacheWrite& write) {
   return true;
 }
 
+static bool write_pipeline_tag_record(const PipelineTagWrite& write) {
+  const auto fail = [&]() {
+    sqlite3_reset(g_pipelineTagInsertStmt);
+    sqlite3_clear_bindings(g_pipelineTagInsertStmt);
+    return false;
+  };
+
+  auto ret = sqlite3_bind_text(g_pipelineTagInsertStmt, 1, write.tag.data(), static_cast<int>(write.tag.size()),
+                               SQLITE_TRANSIENT);
+  if (ret != SQLITE_OK) {
+    Log.error("Failed to bind pipeline tag: {}", sqlite3_errmsg(g_pipelineCacheDb));
+    return fail();
+  }
+  ret = sqlite3_bind_int(g_pipelineTagInsertStmt, 2, underlying(write.type));
+  if (ret != SQLITE_OK) {
+    Log.error("Failed to bind pipeline tag type: {}", sqlite3_errmsg(g_pipelineCacheDb));
+    return fail();
+  }
+  ret = sqlite3_bind_int64(g_pipelineTagInsertStmt, 3, static_cast<sqlite3_int64>(write.hash));
+  if (ret != SQLITE_OK) {
+    Log.error("Failed to bind pipeline tag hash: {}", sqlite3_errmsg(g_pipelineCacheDb));
+    return fail();
+  }
+
+  ret = sqlite3_step(g_pipelineTagInsertStmt);
+  if (ret != SQLITE_DONE) {
+    Log.error("Failed to insert pipeline tag row: {}", sqlite3_errmsg(g_pipelineCacheDb));
+    return fail();
+  }
+
+  sqlite3_reset(g_pipelineTagInsertStmt);
+  sqlite3_clear_bindings(g_pipelineTagInsertStmt);
+  return true;
+}
+
+// Rebuilds the startup snapshot from the current rows. Only called on the writer thread, before it writes anything,
+// so the rows match g_pipelineCacheStamp.
+static void write_pipeline_snapshot() {
+  ZoneScoped;
+  sqlite3_stmt* stmt = nullptr;
+  auto ret = sqlite3_prepare_v3(g_pipelineCacheDb,
+                                "SELECT type, hash, config_version, config, first_frame_used FROM pipeline_cache", -1,
+                                0, &stmt, nullptr);
+  if (ret != SQLITE_OK) {
+    Log.error("Failed to prepare pipeline cache snapshot query: {}", sqlite3_errmsg(g_pipelineCacheDb));
+    return;
+  }
+
+  cache_snapshot::Builder builder{PipelineCacheSchema, PipelineSnapshotKeySize, g_pipelineCacheStamp};
+  while ((ret = sqlite3_step(stmt)) == SQLITE_ROW) {
+    const auto typeValue = sqlite3_column_int(stmt, 0);
+    const auto configVersionValue = sqlite3_column_int64(stmt, 2);
+    const auto* configBlob = static_cast<const uint8_t*>(sqlite3_column_blob(stmt, 3));
+    const auto configSize = static_cast<size_t>(sqlite3_column_bytes(stmt, 3));
+    const auto firstFrameUsedValue = sqlite3_column_int64(stmt, 4);
+    if (typeValue < 0 || typeValue > std::numeric_limits<std::underlying_type_t<ShaderType>>::max() ||
+        configVersionValue < 0 || configVersionValue > std::numeric_limits<uint32_t>::max() ||
+        firstFrameUsedValue < 0 || firstFrameUsedValue > std::numeric_limits<uint32_t>::max() ||
+        (configSize != 0 && configBlob == nullptr)) {
+      continue;
+    }
+    const auto key = pipeline_snapshot_key(static_cast<ShaderType>(typeValue),
+                                           static_cast<uint32_t>(configVersionValue),
+                                           static_cast<uint32_t>(firstFrameUsedValue),
+                                           static_cast<PipelineRef>(sqlite3_column_int64(stmt, 1)));
+    builder.add(key, {configBlob, configSize}, static_cast<uint32_t>(configSize));
+  }
+  sqlite3_finalize(stmt);
+  if (ret != SQLITE_DONE) {
+    Log.error("Failed to read pipeline cache rows for snapshot: {}", sqlite3_errmsg(g_pipelineCacheDb));
+    return;
+  }
+
+  if (!builder.write(pipeline_snapshot_path())) {
+    Log.warn("Failed to write pipeline cache snapshot: {}", SDL_GetError());
+    return;
+  }
+  g_pipelineSnapshotStale = false;
+  Log.debug("Wrote pipeline cache snapshot with {} rows", builder.size());
+}
+
 static void pipeline_cache_writer() {
 #ifdef TRACY_ENABLE
   tracy::SetThreadName("Pipeline cache writer thread");
 #endif
 
+  if (g_pipelineSnapshotStale) {
+    write_pipeline_snapshot();
+  }
+
   while (true) {
     std::deque<PipelineCacheWrite> batch;
+    std::deque<PipelineTagWrite> tagBatch;
     {
       std::unique_lock lock{g_pipelineCacheWriterMutex};
-      g_pipelineCacheWriterCv.wait(lock,
-                                   [] { return g_pipelineCacheWriterStop || !g_pipelineCacheWriteQueue.empty(); });
-      if (g_pipelineCacheWriterStop && g_pipelineCacheWriteQueue.empty()) {
+      g_pipelineCacheWriterCv.wait(lock, [] {
+        return g_pipelineCacheWriterStop || !g_pipelineCacheWriteQueue.empty() || !g_pipelineTagWriteQueue.empty();
+      });
+      if (g_pipelineCacheWriterStop && g_pipelineCacheWriteQueue.empty() && g_pipelineTagWriteQueue.empty()) {
         return;
       }
       batch.swap(g_pipelineCacheWriteQueue);
+      tagBatch.swap(g_pipelineTagWriteQueue);
     }
 
     bool writeFailed = false;
@@ -949,6 +1281,15 @@ static void pipeline_cache_writer() {
             break;
           }
         }
+        for (const auto& write : tagBatch) {
+          if (writeFailed || !write_pipeline_tag_record(write)) {
+            writeFailed = true;
+            break;
+          }
+        }
+        if (!writeFailed && !batch.empty() && !bump_pipeline_cache_stamp()) {
+          writeFailed = true;
+        }
 
         if (!writeFailed) {
           tx.commit();
@@ -1007,7 +1348,31 @@ static void pipeline_worker() {
 }
 
 template <typename PipelineConfig, typename CreateFn>
-static size_t load_pipeline_cache_entries(ShaderType type, uint32_t configVersion, CreateFn&& create) {
+static size_t load_pipeline_cache_entries(ShaderType type, uint32_t configVersion, CreateFn&& create,
+                                          const cache_snapshot::Snapshot& snapshot) {
+  if (snapshot) {
+    const auto prefix = pipeline_snapshot_key(type, configVersion, 0, 0);
+    const auto [begin, end] = snapshot.prefix_range(std::span{prefix}.first(8));
+    size_t acceptedRows = 0;
+    for (size_t i = begin; i < end; ++i) {
+      const auto record = snapshot.at(i);
+      if (!record || record->value.size() != sizeof(PipelineConfig)) {
+        continue;
+      }
+
+      PipelineConfig config;
+      std::memcpy(&config, record->value.data(), sizeof(config));
+      if (config.version != configVersion) {
+        continue;
+      }
+
+      find_pipeline_impl(type, config, [=] { return create(config); }, PipelinePriority::Background,
+                         pipeline_snapshot_first_frame_used(record->key));
+      ++acceptedRows;
+    }
+    return acceptedRows;
+  }
+
   if (!prepare_pipeline_cache_db()) {
     return 0;
   }
@@ -1054,6 +1419,35 @@ static size_t load_pipeline_cache_entries(ShaderType type, uint32_t configVersio
   return acceptedRows;
 }
 
+static void load_pipeline_tags() {
+  sqlite3_stmt* stmt = nullptr;
+  auto ret = sqlite3_prepare_v3(g_pipelineCacheDb, "SELECT tag, hash FROM pipeline_tags", -1, 0, &stmt, nullptr);
+  if (ret != SQLITE_OK) {
+    Log.error("Failed to prepare pipeline tag load statement: {}", sqlite3_errmsg(g_pipelineCacheDb));
+    pipeline_cache_abort();
+    return;
+  }
+
+  {
+    std::lock_guard lock{g_pipelineMutex};
+    while ((ret = sqlite3_step(stmt)) == SQLITE_ROW) {
+      const auto* tag = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+      if (tag == nullptr) {
+        continue;
+      }
+      g_pipelineTags[tag].pipelines.insert(static_cast<PipelineRef>(sqlite3_column_int64(stmt, 1)));
+    }
+  }
+
+  if (ret != SQLITE_DONE) {
+    Log.error("Failed to read pipeline tag rows: {}", sqlite3_errmsg(g_pipelineCacheDb));
+    sqlite3_finalize(stmt);
+    pipeline_cache_abort();
+    return;
+  }
+  sqlite3_finalize(stmt);
+}
+
 static size_t load_pipeline_cache() {
   if (!prepare_pipeline_cache_db()) {
     return 0;
@@ -1063,15 +1457,28 @@ static size_t load_pipeline_cache() {
     return 0;
   }
 
+  // The snapshot is only used if no rows changed since it was built; otherwise the writer rebuilds it
+  auto snapshot =
+      cache_snapshot::Snapshot::open(pipeline_snapshot_path(), PipelineCacheSchema, PipelineSnapshotKeySize);
+  if (snapshot && snapshot.source_stamp() != g_pipelineCacheStamp) {
+    snapshot = {};
+  }
+  g_pipelineSnapshotStale = !snapshot;
+
   size_t acceptedRows = 0;
 #ifdef AURORA_ENABLE_RMLUI
   acceptedRows += load_pipeline_cache_entries<rmlui::PipelineConfig>(ShaderType::Rml, rmlui::RmlPipelineConfigVersion,
-                                                                     rmlui::create_pipeline);
+                                                                     rmlui::create_pipeline, snapshot);
 #endif
   acceptedRows += load_pipeline_cache_entries<clear::PipelineConfig>(
-      ShaderType::Clear, clear::ClearPipelineConfigVersion, clear::create_pipeline);
-  acceptedRows +=
-      load_pipeline_cache_entries<gx::PipelineConfig>(ShaderType::GX, gx::GXPipelineConfigVersion, gx::create_pipeline);
+      ShaderType::Clear, clear::ClearPipelineConfigVersion, clear::create_pipeline, snapshot);
+  acceptedRows += load_pipeline_cache_entries<gx::PipelineConfig>(ShaderType::GX, gx::GXPipelineConfigVersion,
+                                                                  gx::create_pipeline, snapshot);
+  acceptedRows += load_pipeline_cache_entries<gx::PipelineConfig>(ShaderType::GXUber, gx::GXPipelineConfigVersion,
+                                                                  gx::create_uber_pipeline, snapshot);
+  if (!g_pipelineCacheBroken) {
+    load_pipeline_tags();
+  }
   return acceptedRows;
 }
 
@@ -1097,6 +1504,7 @@ static void stop_pipeline_cache_writer() {
   }
 
   g_pipelineCacheWriteQueue.clear();
+  g_pipelineTagWriteQueue.clear();
 }
 
 template <>
@@ -1106,6 +1514,11 @@ PipelineRef find_pipeline(ShaderType type, const clear::PipelineConfig& config,
 
 template <>
 PipelineRef find_pipeline(ShaderType type, const gx::PipelineConfig& config, NewPipelineCallback&& cb) {
+  // Uber pipelines are the fallback while specialized pipelines compile, so they can't wait behind them. They don't
+  // block either: draws are skipped until the first one is ready, as they would be without the fallback.
+  if (type == ShaderType::GXUber) {
+    return find_pipeline_impl(type, config, std::move(cb), PipelinePriority::High, 0);
+  }
   return find_pipeline_impl(type, config, std::move(cb));
 }
 
@@ -1151,12 +1564,19 @@ void shutdown_pipeline_cache() {
   stop_pipeline_cache_writer();
   pipeline_cache_abort();
   g_pipelineCacheBroken = false;
+  g_pipelineCacheStamp = 0;
+  g_pipelineSnapshotStale = false;
   g_pipelinesPerFrame = 0;
   g_gpuCachePrunePending = false;
+  g_lastPipelineRef = std::numeric_limits<PipelineRef>::max();
   g_pipelines.clear();
   g_pipelineQueue.clear();
   g_backgroundPipelineQueue.clear();
   g_pendingPipelines.clear();
+  g_prefetchedPipelines.clear();
+  g_currentPipelineTag = nullptr;
+  g_currentPipelineTagName.clear();
+  g_pipelineTags.clear();
 
   queuedPipelines = 0;
   createdPipelines = 0;
@@ -1184,4 +1604,77 @@ bool get_pipeline(PipelineRef ref, wgpu::RenderPipeline& pipeline) {
   return true;
 }
 
+bool has_pipeline(PipelineRef ref) {
+  std::lock_guard guard{g_pipelineMutex};
+  return g_pipelines.contains(ref);
+}
+
+uint32_t pipeline_generation() noexcept { return g_pipelineGeneration.load(std::memory_order_acquire); }
+
+void set_pipeline_tag(std::string_view tag) {
+  {
+    std::lock_guard guard{g_pipelineMutex};
+    if (tag.empty()) {
+      g_currentPipelineTag = nullptr;
+      g_currentPipelineTagName.clear();
+    } else {
+      g_currentPipelineTag = &g_pipelineTags[std::string{tag}];
+      g_currentPipelineTagName = tag;
+    }
+  }
+  g_pipelineTagGeneration.fetch_add(1, std::memory_order_relaxed);
+}
+
+size_t prefetch_pipelines(std::string_view tag) {
+  ZoneScoped;
+  size_t prefetched = 0;
+  {
+    std::lock_guard guard{g_pipelineMutex};
+    const auto tagIt = g_pipelineTags.find(std::string{tag});
+    if (tagIt == g_pipelineTags.end()) {
+      return 0;
+    }
+    auto& pipelineTag = tagIt->second;
+    // Loaded pipelines are already queued in first-use order; move the tag's ahead of the rest, still behind any
+    // pipelines the current frame is waiting on
+    const auto end = std::stable_partition(
+        g_backgroundPipelineQueue.begin(), g_backgroundPipelineQueue.end(),
+        [&](const PendingPipeline& pending) { return pipelineTag.pipelines.contains(pending.hash); });
+    prefetched = static_cast<size_t>(end - g_backgroundPipelineQueue.begin());
+    // Only pipelines still waiting to compile can count as prefetch hits or misses
+    for (auto it = g_backgroundPipelineQueue.begin(); it != end; ++it) {
+      g_prefetchedPipelines.insert_or_assign(it->hash, &pipelineTag);
+    }
+    pipelineTag.prefetchedPipelines += static_cast<uint32_t>(prefetched);
+  }
+  g_pipelineTagGeneration.fetch_add(1, std::memory_order_relaxed);
+  if (prefetched != 0) {
+    g_pipelineQueueCv.notify_one();
+  }
+  return prefetched;
+}
+
+size_t pipeline_tag_count() {
+  std::lock_guard guard{g_pipelineMutex};
+  return g_pipelineTags.size();
+}
+
+size_t copy_pipeline_tag_stats(std::span<AuroraPipelineTagStats> out) {
+  std::lock_guard guard{g_pipelineMutex};
+  size_t count = 0;
+  for (const auto& [name, tag] : g_pipelineTags) {
+    if (count == out.size()) {
+      break;
+    }
+    out[count++] = {
+        .tag = name.c_str(),
+        .pipelineCount = static_cast<uint32_t>(tag.pipelines.size()),
+        .prefetchedPipelines = tag.prefetchedPipelines,
+        .prefetchHits = tag.prefetchHits,
+        .prefetchMisses = tag.prefetchMisses,
+    };
+  }
+  return count;
+}
+
 } // namespace aurora::gfx
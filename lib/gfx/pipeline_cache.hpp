@@ -3,6 +3,8 @@
 #include "types.hpp"
 
 #include <functional>
+#include <span>
+#include <string_view>
 
 namespace aurora::gfx::clear {
 struct PipelineConfig;
@@ -22,6 +24,7 @@ enum class ShaderType : uint8_t {
   Clear = 0,
   GX = 1,
   Rml = 2,
+  GXUber = 3,
 };
 
 using NewPipelineCallback = std::function<wgpu::RenderPipeline()>;
@@ -35,5 +38,17 @@ template <typename Config>
 PipelineRef find_pipeline(ShaderType type, const Config& config, NewPipelineCallback&& cb);
 
 bool get_pipeline(PipelineRef ref, wgpu::RenderPipeline& pipeline);
+bool has_pipeline(PipelineRef ref);
+// Changes whenever a pipeline finishes compiling. A caller waiting on a pipeline only needs to call has_pipeline
+// again once this has changed.
+uint32_t pipeline_generation() noexcept;
+
+// Pipelines first requested while a tag is current are added to that tag's set, which persists in the cache. An empty
+// tag stops recording.
+void set_pipeline_tag(std::string_view tag);
+// Moves the tag's cached pipelines ahead of the background compile queue. Returns how many were still pending.
+size_t prefetch_pipelines(std::string_view tag);
+size_t pipeline_tag_count();
+size_t copy_pipeline_tag_stats(std::span<AuroraPipelineTagStats> out);
 
 } // namespace aurora::gfx
@@ -13,17 +13,23 @@
 #include "../gx/fifo.hpp"
 #include "../gx/gx.hpp"
 #include "../gx/pipeline.hpp"
+#include "../gx/vertex_decode.hpp"
 #ifdef AURORA_ENABLE_RMLUI
 #include "../rmlui/pipeline.hpp"
 #endif
 #include "../window.hpp"
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <bit>
 #include <cstring>
 #include <new>
 #include <optional>
+#include <span>
 #include <ranges>
 #include <string>
+#include <string_view>
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -37,6 +43,7 @@ using namespace detail;
 
 namespace {
 constexpr Module Log{"aurora::gfx"};
+constexpr size_t NoOffscreenTarget = SIZE_MAX;
 
 struct FrameRecorder {
   FramePacket* packet = nullptr;
@@ -44,17 +51,21 @@ struct FrameRecorder {
   uint32_t currentRenderPass = UINT32_MAX;
   uint32_t drawCallCount = 0;
   uint32_t mergedDrawCallCount = 0;
+  uint32_t instancedDrawCallCount = 0;
   bool inOffscreen = false;
   std::optional<RenderPass> suspendedEfbPass;
   Viewport suspendedEfbViewport;
   ClipRect suspendedEfbScissor;
-  webgpu::TextureWithSampler offscreenColor;
-  webgpu::TextureWithSampler offscreenDepth;
+  size_t offscreenTarget = NoOffscreenTarget;
   Viewport cachedViewport;
   ClipRect cachedScissor;
   bool suppressRenderWorker = false;
 #ifdef AURORA_GFX_DEBUG_GROUPS
   std::vector<std::string> debugGroupStack;
+  // Interned nodes for the leading entries of debugGroupStack, valid for the active frame only.
+  std::vector<const DebugGroup*> debugGroupNodes;
+  absl::flat_hash_map<std::string_view, const char*> debugLabels;
+  absl::flat_hash_map<std::pair<const DebugGroup*, const char*>, const DebugGroup*> debugGroups;
 #endif
 
   [[nodiscard]] bool active() const noexcept { return packet != nullptr; }
@@ -65,9 +76,16 @@ struct FrameRecorder {
   }
 
   RenderPassList& passes() const { return frame().renderPasses; }
+
+  FrameArena& arena() const { return *frame().arena; }
 };
 
 FrameRecorder g_recorder;
+std::atomic_bool g_drawReordering{false};
+
+// Backing memory for each frame slot's command streams, texture uploads and debug labels. A slot is only
+// re-acquired after the render worker has finished its previous frame, so rewinding on begin_recording is safe.
+std::array<FrameArena, FrameSlotCount> g_frameArenas;
 
 std::string pass_label(std::string_view kind) {
 #ifdef AURORA_GFX_DEBUG_GROUPS
@@ -100,6 +118,7 @@ void set_efb_targets(RenderPass& pass) {
   pass.copySourceView =
       webgpu::g_graphicsConfig.msaaSamples > 1 ? webgpu::g_frameBufferResolved.view : webgpu::g_frameBuffer.view;
   pass.copySourceDepthView = webgpu::g_depthBuffer.view;
+  pass.copySourceSize = webgpu::g_frameBuffer.size;
   pass.msaaSamples = layout.sampleCount;
   pass.hasDepth = true;
   pass.hasStencil = false;
@@ -116,21 +135,26 @@ void set_single_color_target(RenderPass& pass, wgpu::TextureFormat format, const
   pass.colorAttachmentCount = 1;
 }
 
-struct OffscreenCacheKey {
-  uint32_t width;
-  uint32_t height;
+// Render targets for offscreen sessions. Sizes are rounded up to a bucket so that sessions of similar sizes share
+// targets. A session holds its target from start_offscreen until finish_current_offscreen. Every consumer of the
+// session's passes (resolve target and snapshots) is encoded with those passes, so the target's contents are dead once
+// the session ends and a later session in the same frame can render into it; queue ordering places the later writes
+// after the earlier copies. Targets left unused for OffscreenTargetMaxIdleFrames frames are released.
+constexpr uint64_t OffscreenTargetMaxIdleFrames = 120;
 
-  bool operator==(const OffscreenCacheKey& rhs) const { return width == rhs.width && height == rhs.height; }
-  template <typename H>
-  friend H AbslHashValue(H h, const OffscreenCacheKey& key) {
-    return H::combine(std::move(h), key.width, key.height);
-  }
-};
-struct OffscreenCacheEntry {
+struct OffscreenTarget {
   webgpu::TextureWithSampler color;
   webgpu::TextureWithSampler depth;
+  uint64_t lastUsedFrame = 0;
+  bool inUse = false;
+};
+struct OffscreenTargetPool {
+  std::vector<OffscreenTarget> targets;
+  uint64_t frame = 0;
+  uint64_t residentBytes = 0;
+  uint64_t peakBytes = 0;
 };
-absl::flat_hash_map<OffscreenCacheKey, OffscreenCacheEntry> g_offscreenCache;
+OffscreenTargetPool g_offscreenTargets;
 
 // Pooled destinations for the public resolve_pass API. Entries are recycled
 // per frame slot: a slot is only re-acquired after the render worker has
@@ -208,11 +232,12 @@ StagingHighWater current_high_water(const FramePacket& frame) noexcept {
       .storage = static_cast<uint32_t>(frame.storage.size()),
       .textureUpload = static_cast<uint32_t>(frame.textureUpload.size()),
       .textureUploadCount = frame.textureUploads.size(),
+      .bufferUploadCount = frame.bufferUploads.size(),
   };
 }
 
 FrameOp capture_frame_op(FramePacket& frame, FrameOpType type, uint32_t index) {
-  FrameOp op{
+  return {
       .type = type,
       .index = index,
       .renderPass =
@@ -224,13 +249,10 @@ FrameOp capture_frame_op(FramePacket& frame, FrameOpType type, uint32_t index) {
           type == FrameOpType::EncoderTask && index < frame.encoderTasks.size() ? &frame.encoderTasks[index] : nullptr,
       .highWater = current_high_water(frame),
   };
-  op.textureUploads.reserve(op.highWater.textureUploadCount);
-  for (size_t i = 0; i < op.highWater.textureUploadCount; ++i) {
-    op.textureUploads.push_back(&frame.textureUploads[i]);
-  }
-  return op;
 }
 
+void reorder_draws(RenderPass& pass);
+
 void seal_pass(FramePacket& frame, uint32_t passIndex) {
   if (passIndex >= frame.renderPasses.size()) {
     return;
@@ -239,6 +261,9 @@ void seal_pass(FramePacket& frame, uint32_t passIndex) {
   if (pass.sealed) {
     return;
   }
+  if (g_drawReordering.load(std::memory_order_relaxed)) {
+    reorder_draws(pass);
+  }
   pass.sealed = true;
 }
 
@@ -282,11 +307,39 @@ bool check_recording(const char* name) {
   return true;
 }
 
-void push_command(CommandType type, const Command::Data& data) {
+#ifdef AURORA_GFX_DEBUG_GROUPS
+const char* intern_debug_label(std::string_view label) {
+  auto& labels = g_recorder.debugLabels;
+  if (const auto it = labels.find(label); it != labels.end()) {
+    return it->second;
+  }
+  const char* interned = g_recorder.arena().copy_string(label);
+  labels.emplace(std::string_view{interned, label.size()}, interned);
+  return interned;
+}
+
+const DebugGroup* current_debug_group() {
+  auto& nodes = g_recorder.debugGroupNodes;
+  const auto& stack = g_recorder.debugGroupStack;
+  while (nodes.size() < stack.size()) {
+    const DebugGroup* parent = nodes.empty() ? nullptr : nodes.back();
+    const char* label = intern_debug_label(stack[nodes.size()]);
+    auto [it, inserted] = g_recorder.debugGroups.try_emplace(std::pair{parent, label}, nullptr);
+    if (inserted) {
+      it->second = g_recorder.arena().make<DebugGroup>(parent, label, static_cast<uint32_t>(nodes.size() + 1));
+    }
+    nodes.push_back(it->second);
+  }
+  return nodes.empty() ? nullptr : nodes.back();
+}
+#endif
+
+// Appends a command with bodySize bytes of body storage to the current pass, or returns nullptr if no pass is open.
+Command* append_command(CommandType type, size_t bodySize) {
   if (g_recorder.currentRenderPass == UINT32_MAX)
     UNLIKELY {
       Log.warn("Dropping command {}", magic_enum::enum_name(type));
-      return;
+      return nullptr;
     }
   auto& renderPass = current_render_passes()[g_recorder.currentRenderPass];
   AURORA_ASSERT(!renderPass.sealed, "Attempted to append command {} to sealed render pass {}",
@@ -294,13 +347,19 @@ void push_command(CommandType type, const Command::Data& data) {
   if (type == CommandType::Draw || type == CommandType::CustomDraw) {
     renderPass.hasDraws = true;
   }
-  renderPass.commands.push_back({
-      .type = type,
+  auto& cmd = renderPass.commands.push(g_recorder.arena(), type, bodySize);
 #ifdef AURORA_GFX_DEBUG_GROUPS
-      .debugGroupStack = g_recorder.debugGroupStack,
+  cmd.debugGroup = current_debug_group();
 #endif
-      .data = data,
-  });
+  return &cmd;
+}
+
+template <typename T>
+void push_command(CommandType type, const T& data) {
+  static_assert(std::is_trivially_copyable_v<T>);
+  if (auto* cmd = append_command(type, sizeof(T))) {
+    std::memcpy(cmd->body(), &data, sizeof(T));
+  }
 }
 
 template <class T>
@@ -326,24 +385,112 @@ void encode_draw(void* payload, const wgpu::RenderPassEncoder& pass, const Rende
 }
 
 template <auto Renderer, InlinePayload T>
-DrawCommand make_draw_command(const T& data) {
+void record_draw(const T& data) {
   static_assert(sizeof(T) <= InlineDrawPayloadSize);
-  static_assert(alignof(T) <= alignof(std::max_align_t));
-  DrawCommand command{.encoder = encode_draw<Renderer, T>};
-  std::memcpy(command.payload.data(), &data, sizeof(data));
-  return command;
+  static_assert(alignof(T) <= CommandAlignment);
+  constexpr size_t payloadOffset = AURORA_ALIGN(sizeof(DrawCommand), CommandAlignment);
+  auto* cmd = append_command(CommandType::Draw, payloadOffset + sizeof(T));
+  if (cmd == nullptr) {
+    return;
+  }
+  auto& draw = *new (cmd->body()) DrawCommand{.encoder = encode_draw<Renderer, T>, .payloadSize = sizeof(T)};
+  std::memcpy(draw.payload(), &data, sizeof(T));
+  ++g_recorder.drawCallCount;
 }
 
-void push_draw_command(DrawCommand data) {
-  push_command(CommandType::Draw, Command::Data{.draw = data});
-  ++g_recorder.drawCallCount;
+struct DrawSortKey {
+  PipelineRef pipeline;
+  BindGroupRef textureBindGroup;
+  uint32_t vertOffset;
+
+  auto operator<=>(const DrawSortKey&) const = default;
+};
+
+bool is_commutable_draw(Command& cmd) noexcept {
+  if (cmd.type != CommandType::Draw) {
+    return false;
+  }
+  auto& draw = cmd.as<DrawCommand>();
+  return draw.encoder == encode_draw<gx::render, gx::DrawData> &&
+         inline_payload<gx::DrawData>(draw.payload()).orderIndependent;
 }
 
-OffscreenCacheEntry get_offscreen_textures(uint32_t width, uint32_t height) {
-  OffscreenCacheKey key{width, height};
-  if (const auto it = g_offscreenCache.find(key); it != g_offscreenCache.end()) {
-    return it->second;
+DrawSortKey draw_sort_key(Command& cmd) noexcept {
+  const auto& data = inline_payload<gx::DrawData>(cmd.as<DrawCommand>().payload());
+  return {data.pipeline, data.bindGroups.textureBindGroup, data.vertRange.offset};
+}
+
+// Sorts each run of consecutive order-independent GX draws by pipeline, texture bind group and vertex offset so the
+// encoder switches state less often. Any other command (viewport, scissor, custom draws, blended or non-GX draws)
+// ends the run and keeps its position.
+void reorder_draws(RenderPass& pass) {
+  ZoneScoped;
+  static std::vector<Command*> order;
+  order.clear();
+  order.reserve(pass.commands.size());
+  bool changed = false;
+  const auto sort_run = [&](size_t begin) {
+    const auto run = std::span{order}.subspan(begin);
+    const auto less = [](Command* a, Command* b) { return draw_sort_key(*a) < draw_sort_key(*b); };
+    if (run.size() > 1 && !std::ranges::is_sorted(run, less)) {
+      std::ranges::stable_sort(run, less);
+      changed = true;
+    }
+  };
+  size_t runBegin = 0;
+  for (auto& cmd : pass.commands) {
+    const bool commutable = is_commutable_draw(cmd);
+#ifdef AURORA_GFX_DEBUG_GROUPS
+    const bool sameGroup = runBegin == order.size() || order[runBegin]->debugGroup == cmd.debugGroup;
+#else
+    constexpr bool sameGroup = true;
+#endif
+    if (!commutable || !sameGroup) {
+      sort_run(runBegin);
+      runBegin = order.size() + (commutable ? 0 : 1);
+    }
+    order.push_back(&cmd);
+  }
+  sort_run(runBegin);
+  if (changed) {
+    pass.commands.relink(order);
+  }
+}
+
+// Rounds up to a multiple of a quarter of the next lower power of two (at least 32), so that larger targets waste
+// less than a quarter of each dimension.
+uint32_t offscreen_bucket(uint32_t size) noexcept {
+  const uint32_t step = std::max(32u, std::bit_floor(size) / 4);
+  return (size + step - 1) / step * step;
+}
+
+// Approximate footprint; drivers may pad or compress.
+uint64_t offscreen_texel_size(wgpu::TextureFormat format) noexcept {
+  switch (format) {
+  case wgpu::TextureFormat::Depth16Unorm:
+    return 2;
+  case wgpu::TextureFormat::RGBA16Float:
+  case wgpu::TextureFormat::Depth32FloatStencil8:
+    return 8;
+  default:
+    return 4;
   }
+}
+
+uint64_t offscreen_target_bytes(const OffscreenTarget& target) noexcept {
+  const auto& size = target.color.size;
+  return static_cast<uint64_t>(size.width) * size.height *
+         (offscreen_texel_size(target.color.format) + offscreen_texel_size(target.depth.format));
+}
+
+void add_offscreen_target(OffscreenTarget target) {
+  auto& pool = g_offscreenTargets;
+  pool.residentBytes += offscreen_target_bytes(target);
+  pool.peakBytes = std::max(pool.peakBytes, pool.residentBytes);
+  pool.targets.emplace_back(std::move(target));
+}
+
+OffscreenTarget create_offscreen_target(uint32_t width, uint32_t height) {
   const auto colorFormat = webgpu::g_graphicsConfig.surfaceConfiguration.format;
   const wgpu::Extent3D size{width, height, 1};
   const wgpu::TextureDescriptor colorDesc{
@@ -382,12 +529,69 @@ OffscreenCacheEntry get_offscreen_textures(uint32_t width, uint32_t height) {
       .size = size,
       .format = depthFormat,
   };
-  OffscreenCacheEntry entry{
+  return {
       .color = std::move(color),
       .depth = std::move(depth),
   };
-  auto [insertIt, _] = g_offscreenCache.emplace(key, std::move(entry));
-  return insertIt->second;
+}
+
+// Takes the smallest free target that fits, as long as it is at most twice the size of the bucket; otherwise creates
+// a target of the bucket size.
+size_t acquire_offscreen_target(uint32_t width, uint32_t height) {
+  auto& pool = g_offscreenTargets;
+  const auto colorFormat = webgpu::g_graphicsConfig.surfaceConfiguration.format;
+  const auto depthFormat = webgpu::g_graphicsConfig.depthFormat;
+  const uint32_t bucketWidth = offscreen_bucket(width);
+  const uint32_t bucketHeight = offscreen_bucket(height);
+  const uint64_t maxArea = 2 * static_cast<uint64_t>(bucketWidth) * bucketHeight;
+
+  size_t best = NoOffscreenTarget;
+  uint64_t bestArea = UINT64_MAX;
+  for (size_t i = 0; i < pool.targets.size(); ++i) {
+    const auto& target = pool.targets[i];
+    const auto& size = target.color.size;
+    const uint64_t area = static_cast<uint64_t>(size.width) * size.height;
+    if (target.inUse || target.color.format != colorFormat || target.depth.format != depthFormat ||
+        size.width < width || size.height < height || area > maxArea || area >= bestArea) {
+      continue;
+    }
+    best = i;
+    bestArea = area;
+  }
+  if (best == NoOffscreenTarget) {
+    best = pool.targets.size();
+    add_offscreen_target(create_offscreen_target(bucketWidth, bucketHeight));
+  }
+  auto& target = pool.targets[best];
+  target.inUse = true;
+  target.lastUsedFrame = pool.frame;
+  return best;
+}
+
+void release_offscreen_target(size_t index) noexcept {
+  if (index < g_offscreenTargets.targets.size()) {
+    g_offscreenTargets.targets[index].inUse = false;
+  }
+}
+
+// Frames that still reference an evicted target keep its textures alive until they are done with them.
+void evict_offscreen_targets() {
+  auto& pool = g_offscreenTargets;
+  // Erasing shifts the indices that sessions hold.
+  AURORA_ASSERT(g_recorder.offscreenTarget == NoOffscreenTarget, "offscreen targets evicted while a session holds one");
+  std::erase_if(pool.targets, [&](const OffscreenTarget& target) {
+    if (target.inUse || pool.frame - target.lastUsedFrame <= OffscreenTargetMaxIdleFrames) {
+      return false;
+    }
+    pool.residentBytes -= offscreen_target_bytes(target);
+    return true;
+  });
+}
+
+void clear_offscreen_targets() noexcept {
+  g_offscreenTargets.targets.clear();
+  g_offscreenTargets.residentBytes = 0;
+  g_recorder.offscreenTarget = NoOffscreenTarget;
 }
 
 void enqueue_pass(FramePacket& frame, uint32_t passIndex);
@@ -402,6 +606,7 @@ void resume_efb_pass_loading(const RenderPass& prevPass) {
       .copySourceTexture = prevPass.copySourceTexture,
       .copySourceView = prevPass.copySourceView,
       .copySourceDepthView = prevPass.copySourceDepthView,
+      .copySourceSize = prevPass.copySourceSize,
       .msaaSamples = prevPass.msaaSamples,
       .clearDepth = false,
       .hasDepth = prevPass.hasDepth,
@@ -411,11 +616,10 @@ void resume_efb_pass_loading(const RenderPass& prevPass) {
     newPass.colorAttachments[i].loadOp = wgpu::LoadOp::Undefined;
     newPass.colorAttachments[i].clear = false;
   }
-  newPass.commands.reserve(2048);
   current_render_passes().emplace_back(std::move(newPass));
   ++g_recorder.currentRenderPass;
-  push_command(CommandType::SetViewport, Command::Data{.setViewport = g_recorder.cachedViewport});
-  push_command(CommandType::SetScissor, Command::Data{.setScissor = g_recorder.cachedScissor});
+  push_command(CommandType::SetViewport, g_recorder.cachedViewport);
+  push_command(CommandType::SetScissor, g_recorder.cachedScissor);
 }
 
 void suspend_efb() {
@@ -444,40 +648,41 @@ void finish_current_offscreen() {
   auto& offscreenPass = current_render_passes()[g_recorder.currentRenderPass];
   offscreenPass.discardable = !offscreenPass.has_consumer();
   enqueue_pass(current_frame_packet(), g_recorder.currentRenderPass);
-  g_recorder.offscreenColor = {};
-  g_recorder.offscreenDepth = {};
+  release_offscreen_target(g_recorder.offscreenTarget);
+  g_recorder.offscreenTarget = NoOffscreenTarget;
 }
 
 void start_offscreen(uint32_t width, uint32_t height) {
   AURORA_ASSERT(width != 0 && height != 0, "start_offscreen requires nonzero dimensions ({}x{})", width, height);
   AURORA_ASSERT(g_recorder.active(), "start_offscreen called outside of an active recording frame");
 
-  auto offscreenEntry = get_offscreen_textures(width, height);
-  g_recorder.offscreenColor = std::move(offscreenEntry.color);
-  g_recorder.offscreenDepth = std::move(offscreenEntry.depth);
+  g_recorder.offscreenTarget = acquire_offscreen_target(width, height);
+  const auto& target = g_offscreenTargets.targets[g_recorder.offscreenTarget];
 
   RenderPass newPass{
       .label = pass_label("Offscreen"),
-      .depthStencilView = g_recorder.offscreenDepth.view,
-      .depthStencilFormat = g_recorder.offscreenDepth.format,
-      .copySourceTexture = g_recorder.offscreenColor.texture,
-      .copySourceView = g_recorder.offscreenColor.view,
-      .copySourceDepthView = g_recorder.offscreenDepth.view,
+      .depthStencilView = target.depth.view,
+      .depthStencilFormat = target.depth.format,
+      .copySourceTexture = target.color.texture,
+      .copySourceView = target.color.view,
+      .copySourceDepthView = target.depth.view,
+      .copySourceSize = target.color.size,
       .msaaSamples = 1,
       .clearDepthValue = gx::UseReversedZ ? 0.f : 1.f,
       .clearDepth = true,
       .hasDepth = true,
       .hasStencil = false,
   };
-  set_single_color_target(newPass, g_recorder.offscreenColor.format, {width, height}, g_recorder.offscreenColor.view);
+  // The target may be larger than the session; the pass renders into its top-left corner.
+  set_single_color_target(newPass, target.color.format, {width, height}, target.color.view);
   current_render_passes().emplace_back(std::move(newPass));
   ++g_recorder.currentRenderPass;
   g_recorder.inOffscreen = true;
 
   g_recorder.cachedViewport = {0.f, 0.f, static_cast<float>(width), static_cast<float>(height), 0.f, 1.f};
   g_recorder.cachedScissor = {0, 0, static_cast<int32_t>(width), static_cast<int32_t>(height)};
-  push_command(CommandType::SetViewport, Command::Data{.setViewport = g_recorder.cachedViewport});
-  push_command(CommandType::SetScissor, Command::Data{.setScissor = g_recorder.cachedScissor});
+  push_command(CommandType::SetViewport, g_recorder.cachedViewport);
+  push_command(CommandType::SetScissor, g_recorder.cachedScissor);
 }
 
 void restore_efb() {
@@ -503,8 +708,8 @@ void restore_efb() {
 
   g_recorder.cachedViewport = g_recorder.suspendedEfbViewport;
   g_recorder.cachedScissor = g_recorder.suspendedEfbScissor;
-  push_command(CommandType::SetViewport, Command::Data{.setViewport = g_recorder.cachedViewport});
-  push_command(CommandType::SetScissor, Command::Data{.setScissor = g_recorder.cachedScissor});
+  push_command(CommandType::SetViewport, g_recorder.cachedViewport);
+  push_command(CommandType::SetScissor, g_recorder.cachedScissor);
 }
 
 void enqueue_op(FramePacket& frame, uint32_t opIndex) {
@@ -537,7 +742,17 @@ void begin_recording(FramePacket& packet, size_t frameSlot) {
   g_passSnapshotPools[frameSlot].used = 0;
   g_recorder.drawCallCount = 0;
   g_recorder.mergedDrawCallCount = 0;
+  g_recorder.instancedDrawCallCount = 0;
   g_recorder.suspendedEfbPass.reset();
+  ++g_offscreenTargets.frame;
+  evict_offscreen_targets();
+  g_frameArenas[frameSlot].reset();
+  packet.arena = &g_frameArenas[frameSlot];
+#ifdef AURORA_GFX_DEBUG_GROUPS
+  g_recorder.debugGroupNodes.clear();
+  g_recorder.debugLabels.clear();
+  g_recorder.debugGroups.clear();
+#endif
 
   current_render_passes().emplace_back();
   auto& pass = current_render_passes()[0];
@@ -548,8 +763,8 @@ void begin_recording(FramePacket& packet, size_t frameSlot) {
   g_recorder.currentRenderPass = 0;
   g_recorder.cachedViewport = gx::map_logical_viewport(gx::g_gxState.logicalViewport);
   g_recorder.cachedScissor = gx::map_logical_scissor(gx::g_gxState.logicalScissor);
-  push_command(CommandType::SetViewport, Command::Data{.setViewport = g_recorder.cachedViewport});
-  push_command(CommandType::SetScissor, Command::Data{.setScissor = g_recorder.cachedScissor});
+  push_command(CommandType::SetViewport, g_recorder.cachedViewport);
+  push_command(CommandType::SetScissor, g_recorder.cachedScissor);
 }
 
 RecordedFrame end_recording() {
@@ -560,15 +775,21 @@ RecordedFrame end_recording() {
   auto& frame = g_recorder.frame();
   frame.stats.drawCallCount = g_recorder.drawCallCount;
   frame.stats.mergedDrawCallCount = g_recorder.mergedDrawCallCount;
+  frame.stats.instancedDrawCallCount = g_recorder.instancedDrawCallCount;
   frame.stats.lastVertSize = frame.verts.size();
   frame.stats.lastUniformSize = frame.uniforms.size();
   frame.stats.lastIndexSize = frame.indices.size();
   frame.stats.lastStorageSize = frame.storage.size();
   frame.stats.lastTextureUploadSize = frame.textureUpload.size();
+  frame.stats.residentOffscreenTargetSize =
+      static_cast<uint32_t>(std::min<uint64_t>(g_offscreenTargets.residentBytes, UINT32_MAX));
+  frame.stats.peakOffscreenTargetSize =
+      static_cast<uint32_t>(std::min<uint64_t>(g_offscreenTargets.peakBytes, UINT32_MAX));
 
   for (auto& array : gx::g_gxState.arrays) {
     array.cachedRange = {};
   }
+  gx::vertex_decode::end_frame();
 #if defined(AURORA_GFX_DEBUG_GROUPS)
   if (!g_recorder.debugGroupStack.empty()) {
     for (auto& item : std::ranges::reverse_view(g_recorder.debugGroupStack)) {
@@ -576,6 +797,7 @@ RecordedFrame end_recording() {
     }
     g_recorder.debugGroupStack.clear();
   }
+  g_recorder.debugGroupNodes.clear();
 #endif
   const RecordedFrame recorded{.packet = g_recorder.packet, .frameSlot = g_recorder.frameSlot};
   g_recorder.packet = nullptr;
@@ -587,10 +809,17 @@ void shutdown_recording() {
   for (auto& pool : g_passSnapshotPools) {
     pool = {};
   }
+  for (auto& arena : g_frameArenas) {
+    arena.release();
+  }
+#ifdef AURORA_GFX_DEBUG_GROUPS
+  g_recorder.debugGroupNodes.clear();
+  g_recorder.debugLabels.clear();
+  g_recorder.debugGroups.clear();
+#endif
   g_recorder.currentRenderPass = UINT32_MAX;
-  g_offscreenCache.clear();
-  g_recorder.offscreenColor = {};
-  g_recorder.offscreenDepth = {};
+  clear_offscreen_targets();
+  g_offscreenTargets = {};
   g_recorder.suspendedEfbPass.reset();
   g_recorder.inOffscreen = false;
   g_recorder.packet = nullptr;
@@ -602,14 +831,14 @@ namespace testing {
 
 void suppress_render_worker(bool suppress) noexcept { g_recorder.suppressRenderWorker = suppress; }
 
-void seed_offscreen_cache(uint32_t width, uint32_t height, wgpu::TextureFormat colorFormat,
+void seed_offscreen_target(uint32_t width, uint32_t height, wgpu::TextureFormat colorFormat,
                           wgpu::TextureFormat depthFormat) {
   const wgpu::Extent3D size{width, height, 1};
-  g_offscreenCache.insert_or_assign(OffscreenCacheKey{width, height},
-                                    OffscreenCacheEntry{
-                                        .color = {.size = size, .format = colorFormat},
-                                        .depth = {.size = size, .format = depthFormat},
-                                    });
+  add_offscreen_target({
+      .color = {.size = size, .format = colorFormat},
+      .depth = {.size = size, .format = depthFormat},
+      .lastUsedFrame = g_offscreenTargets.frame,
+  });
 }
 
 } // namespace testing
@@ -620,14 +849,24 @@ void increment_merged_draw_count() noexcept {
   }
 }
 
+void increment_instanced_draw_count() noexcept {
+  if (g_recorder.active()) {
+    ++g_recorder.instancedDrawCallCount;
+  }
+}
+
 } // namespace detail
 
+void set_draw_reordering(bool enabled) noexcept { g_drawReordering.store(enabled, std::memory_order_relaxed); }
+bool draw_reordering() noexcept { return g_drawReordering.load(std::memory_order_relaxed); }
+
 void queue_texture_upload(TextureUpload upload) {
   if (g_recorder.currentRenderPass != UINT32_MAX) {
     AURORA_ASSERT(!current_render_passes()[g_recorder.currentRenderPass].sealed,
                   "Attempted to append texture upload to sealed render pass {}", g_recorder.currentRenderPass);
   }
-  current_frame_packet().textureUploads.emplace_back(std::move(upload));
+  auto& frame = current_frame_packet();
+  frame.textureUploads.emplace_back(*frame.arena, std::move(upload));
 }
 
 void queue_texture_upload_data(const uint8_t* data, uint32_t bytesPerRow, uint32_t rowsPerImage,
@@ -669,6 +908,46 @@ void queue_texture_upload_data(const uint8_t* data, uint32_t bytesPerRow, uint32
   queue_texture_upload(TextureUpload{layout, std::move(tex), size, std::move(buffer)});
 }
 
+void queue_buffer_upload_data(const uint8_t* data, uint64_t size, wgpu::Buffer dst, uint64_t dstOffset) {
+  if (g_recorder.currentRenderPass != UINT32_MAX) {
+    AURORA_ASSERT(!current_render_passes()[g_recorder.currentRenderPass].sealed,
+                  "Attempted to append buffer upload to sealed render pass {}", g_recorder.currentRenderPass);
+  }
+  // CopyBufferToBuffer requires 4-byte aligned sizes; texture uploads following in the ring stay 256-byte aligned.
+  const uint64_t copySize = AURORA_ALIGN(size, 4);
+  auto& frame = current_frame_packet();
+  if (UseTextureBuffer && frame.textureUpload.size() + AURORA_ALIGN(copySize, 256) <= TextureUploadSize) {
+    const auto range = map(frame.textureUpload, AURORA_ALIGN(copySize, 256), 0);
+    memcpy(frame.textureUpload.data() + range.offset, data, size);
+    BufferUpload upload{
+        .srcOffset = range.offset,
+        .dst = std::move(dst),
+        .dstOffset = dstOffset,
+        .size = copySize,
+    };
+    frame.bufferUploads.emplace_back(*frame.arena, std::move(upload));
+    return;
+  }
+
+  const wgpu::BufferDescriptor descriptor{
+      .label = "Overflow Buffer Upload Buffer",
+      .usage = wgpu::BufferUsage::MapWrite | wgpu::BufferUsage::CopySrc,
+      .size = copySize,
+      .mappedAtCreation = true,
+  };
+  auto buffer = webgpu::g_device.CreateBuffer(&descriptor);
+  memcpy(buffer.GetMappedRange(0, copySize), data, size);
+  buffer.Unmap();
+  BufferUpload upload{
+      .srcOffset = 0,
+      .dst = std::move(dst),
+      .dstOffset = dstOffset,
+      .size = copySize,
+      .buffer = std::move(buffer),
+  };
+  frame.bufferUploads.emplace_back(*frame.arena, std::move(upload));
+}
+
 void queue_texture_copy(wgpu::TexelCopyTextureInfo src, wgpu::TexelCopyTextureInfo dst, wgpu::Extent3D size) {
   ZoneScoped;
   auto& frame = current_frame_packet();
@@ -721,7 +1000,6 @@ void begin_color_pass(const ColorPassDescriptor& desc) {
   color.loadOp = desc.colorLoadOp;
   color.storeOp = desc.colorStoreOp;
   color.clear = desc.colorLoadOp == wgpu::LoadOp::Clear;
-  pass.commands.reserve(128);
   frame.renderPasses.emplace_back(std::move(pass));
   g_recorder.currentRenderPass = static_cast<uint32_t>(frame.renderPasses.size() - 1);
 
@@ -729,8 +1007,8 @@ void begin_color_pass(const ColorPassDescriptor& desc) {
       0.f, 0.f, static_cast<float>(desc.targetSize.width), static_cast<float>(desc.targetSize.height), 0.f, 1.f};
   g_recorder.cachedScissor = {0, 0, static_cast<int32_t>(desc.targetSize.width),
                               static_cast<int32_t>(desc.targetSize.height)};
-  push_command(CommandType::SetViewport, Command::Data{.setViewport = g_recorder.cachedViewport});
-  push_command(CommandType::SetScissor, Command::Data{.setScissor = g_recorder.cachedScissor});
+  push_command(CommandType::SetViewport, g_recorder.cachedViewport);
+  push_command(CommandType::SetScissor, g_recorder.cachedScissor);
 }
 
 void end_color_pass() {
@@ -747,11 +1025,15 @@ gx::DrawData* get_last_draw_command() {
   if (g_recorder.currentRenderPass >= current_render_passes().size()) {
     return nullptr;
   }
-  auto& last = current_render_passes()[g_recorder.currentRenderPass].commands.back();
-  if (last.type != CommandType::Draw || last.data.draw.encoder != encode_draw<gx::render, gx::DrawData>) {
+  auto* last = current_render_passes()[g_recorder.currentRenderPass].commands.back();
+  if (last == nullptr || last->type != CommandType::Draw) {
+    return nullptr;
+  }
+  auto& draw = last->as<DrawCommand>();
+  if (draw.encoder != encode_draw<gx::render, gx::DrawData>) {
     return nullptr;
   }
-  return &inline_payload<gx::DrawData>(last.data.draw.payload.data());
+  return &inline_payload<gx::DrawData>(draw.payload());
 }
 
 Vec2<uint32_t> get_render_target_size() noexcept {
@@ -766,21 +1048,21 @@ Vec2<uint32_t> get_render_target_size() noexcept {
 
 void set_viewport(const Viewport& cmd) noexcept {
   if (cmd != g_recorder.cachedViewport) {
-    push_command(CommandType::SetViewport, Command::Data{.setViewport = cmd});
+    push_command(CommandType::SetViewport, cmd);
     g_recorder.cachedViewport = cmd;
   }
 }
 
 void set_scissor(const ClipRect& cmd) noexcept {
   if (cmd != g_recorder.cachedScissor) {
-    push_command(CommandType::SetScissor, Command::Data{.setScissor = cmd});
+    push_command(CommandType::SetScissor, cmd);
     g_recorder.cachedScissor = cmd;
   }
 }
 
 template <>
 void push_draw_command(clear::DrawData data) {
-  push_draw_command(make_draw_command<clear::render>(data));
+  record_draw<clear::render>(data);
 }
 
 template <>
@@ -795,9 +1077,9 @@ void resolve_pass_into(TextureHandle texture, ClipRect rect, bool clearColor, bo
   prevPass.resolveTarget = std::move(texture);
   prevPass.resolveRect = rect;
   prevPass.resolveFormat = resolveFormat;
-  // Push UV transform uniform for tex_copy_conv (crop region in UV space)
-  const auto srcW = static_cast<float>(prevPass.colorAttachments[SceneColorAttachmentIndex].size.width);
-  const auto srcH = static_cast<float>(prevPass.colorAttachments[SceneColorAttachmentIndex].size.height);
+  // Push UV transform uniform for tex_copy_conv (crop region in UV space of the whole copy source)
+  const auto srcW = static_cast<float>(prevPass.copySourceSize.width);
+  const auto srcH = static_cast<float>(prevPass.copySourceSize.height);
   const std::array uvTransform{
       static_cast<float>(rect.x) / srcW,
       static_cast<float>(rect.y) / srcH,
@@ -818,6 +1100,7 @@ void resolve_pass_into(TextureHandle texture, ClipRect rect, bool clearColor, bo
       .copySourceTexture = prevPass.copySourceTexture,
       .copySourceView = prevPass.copySourceView,
       .copySourceDepthView = prevPass.copySourceDepthView,
+      .copySourceSize = prevPass.copySourceSize,
       .msaaSamples = msaaSamples,
       .clearDepthValue = clearDepthValue,
       .clearDepth = clearDepth,
@@ -835,7 +1118,6 @@ void resolve_pass_into(TextureHandle texture, ClipRect rect, bool clearColor, bo
     sceneColor.clear = true;
     sceneColor.clearValue = clearColorValue;
   }
-  newPass.commands.reserve(2048);
   current_render_passes().emplace_back(std::move(newPass));
   ++g_recorder.currentRenderPass;
 
@@ -853,8 +1135,8 @@ void resolve_pass_into(TextureHandle texture, ClipRect rect, bool clearColor, bo
             },
     });
   }
-  push_command(CommandType::SetViewport, Command::Data{.setViewport = g_recorder.cachedViewport});
-  push_command(CommandType::SetScissor, Command::Data{.setScissor = g_recorder.cachedScissor});
+  push_command(CommandType::SetViewport, g_recorder.cachedViewport);
+  push_command(CommandType::SetScissor, g_recorder.cachedScissor);
 }
 
 void queue_palette_conv(tex_palette_conv::ConvRequest req) {
@@ -877,7 +1159,7 @@ RenderTargetLayout get_render_target_layout() noexcept {
 }
 
 void clear_caches() noexcept {
-  g_offscreenCache.clear();
+  clear_offscreen_targets();
   clear_bind_group_cache();
 }
 
@@ -906,13 +1188,16 @@ bool push_custom_draw(DrawTypeId type, const void* payload, size_t payloadSize)
     return false;
   }
 
-  CustomDrawCommand draw{};
-  draw.type = type;
-  draw.payloadSize = static_cast<uint32_t>(payloadSize);
+  constexpr size_t payloadOffset = AURORA_ALIGN(sizeof(CustomDrawCommand), CommandAlignment);
+  auto* cmd = append_command(CommandType::CustomDraw, payloadOffset + payloadSize);
+  if (cmd == nullptr) {
+    return false;
+  }
+  auto& draw = *new (cmd->body())
+      CustomDrawCommand{.type = type, .payloadSize = static_cast<uint32_t>(payloadSize)};
   if (payloadSize > 0) {
-    std::memcpy(draw.payload.data(), payload, payloadSize);
+    std::memcpy(draw.payload(), payload, payloadSize);
   }
-  push_command(CommandType::CustomDraw, Command::Data{.customDraw = draw});
   ++g_recorder.drawCallCount;
   return true;
 }
@@ -1060,13 +1345,13 @@ bool push_encoder_task(EncoderTaskId type, const void* payload, size_t payloadSi
 
 template <>
 void push_draw_command(gx::DrawData data) {
-  push_draw_command(make_draw_command<gx::render>(data));
+  record_draw<gx::render>(data);
 }
 
 #ifdef AURORA_ENABLE_RMLUI
 template <>
 void push_draw_command(rmlui::DrawData data) {
-  push_draw_command(make_draw_command<rmlui::render>(data));
+  record_draw<rmlui::render>(data);
 }
 #endif
 
@@ -1122,6 +1407,20 @@ Range push_uniform(const uint8_t* data, size_t length) {
   return push(current_frame_packet().uniforms, data, length, resources().limits.minUniformBufferOffsetAlignment);
 }
 
+size_t vertex_space_remaining() noexcept {
+  if (!g_recorder.active()) {
+    return 0;
+  }
+  return VertexBufferSize - std::min<size_t>(current_frame_packet().verts.size(), VertexBufferSize);
+}
+
+size_t index_space_remaining() noexcept {
+  if (!g_recorder.active()) {
+    return 0;
+  }
+  return IndexBufferSize - std::min<size_t>(current_frame_packet().indices.size(), IndexBufferSize);
+}
+
 Range push_storage(const uint8_t* data, size_t length) {
   ZoneScoped;
   if (!check_recording("push_storage")) {
@@ -1130,6 +1429,32 @@ Range push_storage(const uint8_t* data, size_t length) {
   return push(current_frame_packet().storage, data, length, resources().limits.minStorageBufferOffsetAlignment);
 }
 
+Range push_storage_contiguous(const uint8_t* data, size_t length) {
+  ZoneScoped;
+  if (!check_recording("push_storage_contiguous")) {
+    return {};
+  }
+  return push(current_frame_packet().storage, data, length, 0);
+}
+
+Range upload_resident_storage(uint32_t offset, const uint8_t* data, size_t length) {
+  ZoneScoped;
+  if (!check_recording("upload_resident_storage")) {
+    return {};
+  }
+  AURORA_ASSERT(offset + length <= ResidentStorageSize, "Resident storage upload at {} of {} bytes out of bounds",
+                offset, length);
+  queue_buffer_upload_data(data, length, resources().storageBuffer, StorageBufferSize + offset);
+  return {static_cast<uint32_t>(StorageBufferSize + offset), static_cast<uint32_t>(length)};
+}
+
+size_t storage_offset() noexcept {
+  if (!g_recorder.active()) {
+    return 0;
+  }
+  return current_frame_packet().storage.size();
+}
+
 Range push_texture_data(const uint8_t* data, u32 bytesPerRow, u32 rowsPerImage) {
   // For CopyBufferToTexture, we need an alignment of 256 per row (see Dawn kTextureBytesPerRowAlignment)
   const auto copyBytesPerRow = AURORA_ALIGN(bytesPerRow, 256);
@@ -1149,10 +1474,7 @@ uint32_t align_uniform(uint32_t value) {
 
 void insert_debug_marker(std::string label) {
 #if defined(AURORA_GFX_DEBUG_GROUPS)
-  auto& markers = current_frame_packet().debugMarkers;
-  const auto idx = markers.size();
-  markers.emplace_back(std::move(label));
-  push_command(CommandType::DebugMarker, {.debugMarkerIndex = idx});
+  push_command(CommandType::DebugMarker, intern_debug_label(label));
 #endif
 }
 
@@ -1176,5 +1498,9 @@ void pop_debug_group() {
   }
 
   aurora::gfx::g_recorder.debugGroupStack.pop_back();
+  auto& nodes = aurora::gfx::g_recorder.debugGroupNodes;
+  if (nodes.size() > aurora::gfx::g_recorder.debugGroupStack.size()) {
+    nodes.pop_back();
+  }
 #endif
 }
@@ -18,10 +18,11 @@ void begin_recording(FramePacket& packet, size_t frameSlot);
 RecordedFrame end_recording();
 void shutdown_recording();
 void increment_merged_draw_count() noexcept;
+void increment_instanced_draw_count() noexcept;
 
 namespace testing {
 void suppress_render_worker(bool suppress) noexcept;
-void seed_offscreen_cache(uint32_t width, uint32_t height, wgpu::TextureFormat colorFormat,
+void seed_offscreen_target(uint32_t width, uint32_t height, wgpu::TextureFormat colorFormat,
                           wgpu::TextureFormat depthFormat);
 }
 
@@ -59,6 +60,9 @@ void end_offscreen();
 uint32_t get_sample_count() noexcept;
 RenderTargetLayout get_render_target_layout() noexcept;
 void clear_caches() noexcept;
+// When enabled, runs of order-independent GX draws are sorted by state as each render pass is sealed.
+void set_draw_reordering(bool enabled) noexcept;
+bool draw_reordering() noexcept;
 
 namespace tex_palette_conv {
 struct ConvRequest;
@@ -76,6 +80,9 @@ Range push_indices(ArrayRef<T> data, size_t alignment) {
   return push_indices(reinterpret_cast<const uint8_t*>(data.data()), data.size() * sizeof(T), alignment);
 }
 Range push_uniform(const uint8_t* data, size_t length);
+// Bytes left in the current frame's vertex and index staging buffers, before alignment padding.
+size_t vertex_space_remaining() noexcept;
+size_t index_space_remaining() noexcept;
 template <typename T>
 Range push_uniform(const T& data) {
   return push_uniform(reinterpret_cast<const uint8_t*>(&data), sizeof(T));
@@ -89,6 +96,13 @@ template <typename T>
 Range push_storage(const T& data) {
   return push_storage(reinterpret_cast<const uint8_t*>(&data), sizeof(T));
 }
+// Appends directly after the previous storage push, without alignment, so that it can extend that range.
+Range push_storage_contiguous(const uint8_t* data, size_t length);
+// Offset the next push_storage_contiguous will write at.
+size_t storage_offset() noexcept;
+// Copies data to `offset` bytes into the resident storage region, where it stays across frames until overwritten by
+// another upload. Returns its range in the storage buffer, which draws can reference like a push_storage range.
+Range upload_resident_storage(uint32_t offset, const uint8_t* data, size_t length);
 Range push_texture_data(const uint8_t* data, uint32_t bytesPerRow, uint32_t rowsPerImage);
 
 template <typename DrawData>
@@ -6,7 +6,9 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <atomic>
 #include <mutex>
+#include <shared_mutex>
 
 #include <absl/container/flat_hash_map.h>
 #include <tracy/Tracy.hpp>
@@ -42,22 +44,27 @@ struct CachedBindGroup {
 constexpr uint32_t BindGroupCacheRetainFrames = 32;
 constexpr uint32_t BindGroupCacheSweepPeriod = 16;
 
+// Lookups of existing entries only take the shared lock; lastUsedFrame is bumped through atomic_ref under it.
 absl::flat_hash_map<BindGroupRef, CachedBindGroup> g_cachedBindGroups;
 absl::flat_hash_map<SamplerRef, wgpu::Sampler> g_cachedSamplers;
-std::mutex g_bindGroupCacheMutex;
-std::mutex g_samplerCacheMutex;
+std::shared_mutex g_bindGroupCacheMutex;
+std::shared_mutex g_samplerCacheMutex;
+
+void touch(CachedBindGroup& entry) noexcept {
+  std::atomic_ref{entry.lastUsedFrame}.store(current_frame(), std::memory_order_relaxed);
+}
 
 } // namespace
 
 namespace detail {
 
 void clear_bind_group_cache() {
-  std::lock_guard lock{g_bindGroupCacheMutex};
+  std::unique_lock lock{g_bindGroupCacheMutex};
   g_cachedBindGroups.clear();
 }
 
 void expire_cached_bind_groups() {
-  std::lock_guard lock{g_bindGroupCacheMutex};
+  std::unique_lock lock{g_bindGroupCacheMutex};
   const auto frameIndex = current_frame();
   if (g_cachedBindGroups.empty() || frameIndex == UINT32_MAX || frameIndex % BindGroupCacheSweepPeriod != 0) {
     return;
@@ -75,7 +82,7 @@ void expire_cached_bind_groups() {
 
 void shutdown_resource_cache() {
   clear_bind_group_cache();
-  std::lock_guard lock{g_samplerCacheMutex};
+  std::unique_lock lock{g_samplerCacheMutex};
   g_cachedSamplers.clear();
 }
 
@@ -83,22 +90,33 @@ void shutdown_resource_cache() {
 
 BindGroupRef bind_group_ref(const WGPUBindGroupDescriptor& descriptor) {
   const auto id = xxh3_hash(descriptor);
-  std::lock_guard lock{g_bindGroupCacheMutex};
-  const auto it = g_cachedBindGroups.find(id);
-  if (it == g_cachedBindGroups.end()) {
-    auto bindGroup = wgpu::BindGroup::Acquire(wgpuDeviceCreateBindGroup(webgpu::g_device.Get(), &descriptor));
-    g_cachedBindGroups.emplace(id, CachedBindGroup{
-                                       .bindGroup = std::move(bindGroup),
-                                       .lastUsedFrame = current_frame(),
-                                   });
+  // GX draws check touch_bind_group through their own fingerprint cache first, so this is mostly reached on a miss:
+  // look up and insert under one exclusive lock rather than a shared lookup followed by an exclusive one.
+  std::unique_lock lock{g_bindGroupCacheMutex};
+  const auto [it, inserted] = g_cachedBindGroups.try_emplace(id);
+  if (inserted) {
+    it->second = CachedBindGroup{
+        .bindGroup = wgpu::BindGroup::Acquire(wgpuDeviceCreateBindGroup(webgpu::g_device.Get(), &descriptor)),
+        .lastUsedFrame = current_frame(),
+    };
   } else {
-    it->second.lastUsedFrame = current_frame();
+    touch(it->second);
   }
   return id;
 }
 
+bool touch_bind_group(BindGroupRef id) noexcept {
+  std::shared_lock lock{g_bindGroupCacheMutex};
+  const auto it = g_cachedBindGroups.find(id);
+  if (it == g_cachedBindGroups.end()) {
+    return false;
+  }
+  touch(it->second);
+  return true;
+}
+
 wgpu::BindGroup find_bind_group(BindGroupRef id) {
-  std::lock_guard lock{g_bindGroupCacheMutex};
+  std::shared_lock lock{g_bindGroupCacheMutex};
   const auto it = g_cachedBindGroups.find(id);
   CHECK(it != g_cachedBindGroups.end(), "get_bind_group: failed to locate {:x}", id);
   return it->second.bindGroup;
@@ -106,7 +124,13 @@ wgpu::BindGroup find_bind_group(BindGroupRef id) {
 
 wgpu::Sampler sampler_ref(const wgpu::SamplerDescriptor& descriptor) {
   const auto id = xxh3_hash(descriptor);
-  std::lock_guard lock{g_samplerCacheMutex};
+  {
+    std::shared_lock lock{g_samplerCacheMutex};
+    if (const auto it = g_cachedSamplers.find(id); it != g_cachedSamplers.end()) {
+      return it->second;
+    }
+  }
+  std::unique_lock lock{g_samplerCacheMutex};
   auto it = g_cachedSamplers.find(id);
   if (it == g_cachedSamplers.end()) {
     it = g_cachedSamplers.try_emplace(id, webgpu::g_device.CreateSampler(&descriptor)).first;
@@ -5,6 +5,8 @@
 namespace aurora::gfx {
 
 BindGroupRef bind_group_ref(const WGPUBindGroupDescriptor& descriptor);
+// Marks a bind group created by bind_group_ref as used this frame. Returns false if it has since expired.
+bool touch_bind_group(BindGroupRef id) noexcept;
 wgpu::BindGroup find_bind_group(BindGroupRef id);
 wgpu::Sampler sampler_ref(const wgpu::SamplerDescriptor& descriptor);
 
@@ -8,6 +8,9 @@ inline constexpr uint64_t UniformBufferSize = 25165824; // 24 MiB
 inline constexpr uint64_t VertexBufferSize = 5242880;   // 5 MiB
 inline constexpr uint64_t IndexBufferSize = 2097152;    // 2 MiB
 inline constexpr uint64_t StorageBufferSize = 8388608;  // 8 MiB
+// Region after StorageBufferSize in the storage buffer that per-frame pushes never overwrite; see
+// upload_resident_storage.
+inline constexpr uint64_t ResidentStorageSize = 8388608; // 8 MiB
 inline constexpr uint64_t TextureUploadSize = 25165824; // 24 MiB
 
 namespace detail {
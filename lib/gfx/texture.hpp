@@ -1,6 +1,7 @@
 #pragma once
 #include <dolphin/gx.h>
 
+#include <atomic>
 #include <utility>
 
 #include "types.hpp"
@@ -22,6 +23,17 @@ void queue_texture_upload(TextureUpload upload);
 void queue_texture_upload_data(const uint8_t* data, uint32_t bytesPerRow, uint32_t rowsPerImage,
                                wgpu::TexelCopyTextureInfo tex, wgpu::Extent3D size);
 
+// Copies data into a persistent GPU buffer ahead of the next op, sharing the texture upload staging ring. Without
+// `buffer`, `srcOffset` is relative to the ring.
+struct BufferUpload {
+  uint64_t srcOffset;
+  wgpu::Buffer dst;
+  uint64_t dstOffset;
+  uint64_t size;
+  wgpu::Buffer buffer;
+};
+void queue_buffer_upload_data(const uint8_t* data, uint64_t size, wgpu::Buffer dst, uint64_t dstOffset);
+
 struct TextureFormatInfo {
   uint8_t blockWidth;
   uint8_t blockHeight;
@@ -43,6 +55,9 @@ struct TextureRef {
   u32 gxFormat;
   bool hasArbitraryMips = false;
   bool isReplacement = false;
+  // Unique for the process lifetime. Unlike the TextureRef address, never reused once the texture is destroyed, so it
+  // can identify the texture in cache keys that outlive it.
+  const uint64_t id = next_id();
 
   TextureRef(wgpu::Texture texture, wgpu::TextureView sampleTextureView, wgpu::TextureView attachmentTextureView,
              wgpu::Extent3D size, wgpu::TextureFormat format, uint32_t mipCount, u32 gxFormat)
@@ -53,6 +68,12 @@ struct TextureRef {
   , format(format)
   , mipCount(mipCount)
   , gxFormat(gxFormat) {}
+
+private:
+  static uint64_t next_id() noexcept {
+    static std::atomic_uint64_t nextId = 1;
+    return nextId.fetch_add(1, std::memory_order_relaxed);
+  }
 };
 
 TextureHandle new_static_texture_2d(uint32_t width, uint32_t height, uint32_t mips, u32 gxFormat,
@@ -1,5 +1,6 @@
 #include "texture_convert.hpp"
 
+#include "frame_timing.hpp"
 #include "../internal.hpp"
 #include "../gx/gx_fmt.hpp"
 
@@ -574,6 +575,7 @@ static ByteBuffer BuildRGBA8FromBC1(uint32_t width, uint32_t height, uint32_t mi
 
 ConvertedTexture convert_texture(u32 format, uint32_t width, uint32_t height, uint32_t mips, ArrayRef<uint8_t> data) {
   ZoneScoped;
+  frame_timing::ScopedTimer timer{frame_timing::Phase::TextureConvert};
   ByteBuffer converted;
   switch (format) {
     DEFAULT_FATAL("convert_texture: unknown texture format {}", format);
@@ -0,0 +1,89 @@
+#include "bind_group_cache.hpp"
+
+#include "../gfx/resource_cache.hpp"
+
+#include <absl/container/flat_hash_map.h>
+#include <tracy/Tracy.hpp>
+
+namespace aurora::gx {
+namespace {
+// mode0 bits read by TextureBind::get_descriptor: wrap_s, wrap_t, mag_filter, min_filter and max_aniso.
+constexpr u32 SamplerMode0Mask = 0xFF | 0x3 << 19;
+constexpr u32 ReplacementFlag = 1u << 30;
+constexpr u32 ArbitraryMipsFlag = 1u << 31;
+static_assert((SamplerMode0Mask & (ReplacementFlag | ArbitraryMipsFlag)) == 0);
+
+struct CachedBindGroup {
+  gfx::BindGroupRef bindGroup = 0;
+  uint64_t lastUsedFrame = 0;
+};
+
+absl::flat_hash_map<TextureBindingsKey, CachedBindGroup> s_bindGroups;
+uint64_t s_frameCount = 0;
+} // namespace
+
+TextureBindingsKey texture_bindings_key(const ShaderInfo& info,
+                                        const std::array<gfx::TextureBind, MaxTextures>& textures,
+                                        u16 anisotropy) noexcept {
+  TextureBindingsKey key{.anisotropy = anisotropy};
+  for (u32 i = 0; i < MaxTextures; ++i) {
+    const auto& tex = textures[i];
+    if (!tex || !(info.sampledTextures[i] || info.sampledIndTextures[i])) {
+      continue;
+    }
+    u32 sampler = tex.texObj.mode0 & SamplerMode0Mask;
+    if (tex.ref->isReplacement) {
+      sampler |= ReplacementFlag;
+    }
+    if (tex.ref->hasArbitraryMips) {
+      sampler |= ArbitraryMipsFlag;
+    }
+    key.slots[i] = {
+        .textureId = tex.ref->id,
+        .sampler = sampler,
+        .lod = tex.texObj.mode1 & 0xFFFF,
+    };
+  }
+  return key;
+}
+
+namespace bind_group_cache {
+gfx::BindGroupRef find(const TextureBindingsKey& key) noexcept {
+  const auto it = s_bindGroups.find(key);
+  if (it == s_bindGroups.end()) {
+    return 0;
+  }
+  if (!gfx::touch_bind_group(it->second.bindGroup)) {
+    s_bindGroups.erase(it);
+    return 0;
+  }
+  it->second.lastUsedFrame = s_frameCount;
+  return it->second.bindGroup;
+}
+
+void insert(const TextureBindingsKey& key, gfx::BindGroupRef bindGroup) noexcept {
+  s_bindGroups.insert_or_assign(key, CachedBindGroup{
+                                         .bindGroup = bindGroup,
+                                         .lastUsedFrame = s_frameCount,
+                                     });
+}
+
+void end_frame() noexcept {
+  ++s_frameCount;
+  if (s_bindGroups.empty() || s_frameCount % RetainFrames != 0) {
+    return;
+  }
+
+  ZoneScoped;
+  absl::erase_if(s_bindGroups,
+                 [](const auto& entry) { return s_frameCount - entry.second.lastUsedFrame > RetainFrames; });
+}
+
+void clear() noexcept {
+  s_bindGroups.clear();
+  s_frameCount = 0;
+}
+
+size_t size() noexcept { return s_bindGroups.size(); }
+} // namespace bind_group_cache
+} // namespace aurora::gx
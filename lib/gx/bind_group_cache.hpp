@@ -0,0 +1,51 @@
+#pragma once
+
+#include "gx.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace aurora::gx {
+// Everything a GX texture bind group is built from, per texture map: the texture's unique id and the state that
+// TextureBind::get_descriptor turns into a sampler. Unsampled maps are left zeroed since they bind the empty texture.
+struct TextureBindSlotKey {
+  uint64_t textureId = 0;
+  u32 sampler = 0; // GXTexObj mode0 wrap/filter/aniso bits, plus the TextureRef replacement/arbitrary mip flags
+  u32 lod = 0;     // GXTexObj mode1 min/max LOD
+
+  bool operator==(const TextureBindSlotKey& rhs) const = default;
+  template <typename H>
+  friend H AbslHashValue(H h, const TextureBindSlotKey& key) {
+    return H::combine(std::move(h), key.textureId, key.sampler, key.lod);
+  }
+};
+
+struct TextureBindingsKey {
+  std::array<TextureBindSlotKey, MaxTextures> slots{};
+  u16 anisotropy = 0;
+
+  bool operator==(const TextureBindingsKey& rhs) const = default;
+  template <typename H>
+  friend H AbslHashValue(H h, const TextureBindingsKey& key) {
+    return H::combine(std::move(h), key.slots, key.anisotropy);
+  }
+};
+
+TextureBindingsKey texture_bindings_key(const ShaderInfo& info,
+                                        const std::array<gfx::TextureBind, MaxTextures>& textures,
+                                        u16 anisotropy) noexcept;
+
+// Command processor-owned cache of texture bind groups by TextureBindingsKey, consulted before building and hashing a
+// full bind group descriptor. Texture ids are never reused, so entries for destroyed textures can't be hit again and
+// simply age out.
+namespace bind_group_cache {
+constexpr uint64_t RetainFrames = 32;
+
+// Returns the bind group last inserted for key, or 0 if there is none or the shared cache has since expired it.
+gfx::BindGroupRef find(const TextureBindingsKey& key) noexcept;
+void insert(const TextureBindingsKey& key, gfx::BindGroupRef bindGroup) noexcept;
+void end_frame() noexcept;
+void clear() noexcept;
+size_t size() noexcept;
+} // namespace bind_group_cache
+} // namespace aurora::gx
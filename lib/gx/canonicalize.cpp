@@ -0,0 +1,167 @@
+#include "shader_info.hpp"
+
+#include <tracy/Tracy.hpp>
+
+namespace aurora::gx {
+namespace {
+bool is_alpha_bump_channel(GXChannelID id) noexcept { return id == GX_ALPHA_BUMP || id == GX_ALPHA_BUMPN; }
+
+bool stage_reads_texture(const TevStage& stage) noexcept {
+  const auto& c = stage.colorPass;
+  const auto& a = stage.alphaPass;
+  return c.a == GX_CC_TEXC || c.a == GX_CC_TEXA || c.b == GX_CC_TEXC || c.b == GX_CC_TEXA || c.c == GX_CC_TEXC ||
+         c.c == GX_CC_TEXA || c.d == GX_CC_TEXC || c.d == GX_CC_TEXA || a.a == GX_CA_TEXA || a.b == GX_CA_TEXA ||
+         a.c == GX_CA_TEXA || a.d == GX_CA_TEXA;
+}
+
+bool stage_reads_raster(const TevStage& stage) noexcept {
+  const auto& c = stage.colorPass;
+  const auto& a = stage.alphaPass;
+  return c.a == GX_CC_RASC || c.a == GX_CC_RASA || c.b == GX_CC_RASC || c.b == GX_CC_RASA || c.c == GX_CC_RASC ||
+         c.c == GX_CC_RASA || c.d == GX_CC_RASC || c.d == GX_CC_RASA || a.a == GX_CA_RASA || a.b == GX_CA_RASA ||
+         a.c == GX_CA_RASA || a.d == GX_CA_RASA;
+}
+
+bool stage_reads_konst_color(const TevStage& stage) noexcept {
+  const auto& c = stage.colorPass;
+  return c.a == GX_CC_KONST || c.b == GX_CC_KONST || c.c == GX_CC_KONST || c.d == GX_CC_KONST;
+}
+
+bool stage_reads_konst_alpha(const TevStage& stage) noexcept {
+  const auto& a = stage.alphaPass;
+  return a.a == GX_CA_KONST || a.b == GX_CA_KONST || a.c == GX_CA_KONST || a.d == GX_CA_KONST;
+}
+
+// Whether the stage's indirect state (ind stage, matrix, wrap, add-prev) can affect its texture coordinate.
+bool stage_uses_indirect(const TevStage& stage) noexcept {
+  return stage.indTexMtxId != GX_ITM_OFF || stage.indTexWrapS != GX_ITW_OFF || stage.indTexWrapT != GX_ITW_OFF ||
+         stage.indTexAddPrev || is_alpha_bump_channel(stage.channelId);
+}
+
+bool compare_ignores_ref(GXCompare comp) noexcept { return comp == GX_NEVER || comp == GX_ALWAYS; }
+} // namespace
+
+void canonicalize_shader_config(ShaderConfig& config, const ShaderInfo& info) noexcept {
+  ZoneScoped;
+
+  // Vertex attributes the shader reads. Unread attributes keep their space in the vertex (vtxStride and the other
+  // attributes' offsets are unchanged), they just aren't loaded.
+  std::bitset<MaxVtxAttr> readAttrs;
+  readAttrs.set(GX_VA_PNMTXIDX);
+  readAttrs.set(GX_VA_POS);
+  bool readsNormal = info.lightingEnabled || EnableNormalVisualization;
+  for (int i = 0; i < info.sampledTexCoords.size(); ++i) {
+    if (!info.sampledTexCoords.test(i)) {
+      continue;
+    }
+    const auto& tcg = config.tcgs[i];
+    readAttrs.set(GX_VA_TEX0MTXIDX + i);
+    if (tcg.type >= GX_TG_BUMP0 && tcg.type <= GX_TG_BUMP7) {
+      readsNormal = true;
+    } else if (tcg.src >= GX_TG_TEX0 && tcg.src <= GX_TG_TEX7) {
+      readAttrs.set(GX_VA_TEX0 + (tcg.src - GX_TG_TEX0));
+    } else if (tcg.src == GX_TG_NRM || tcg.src == GX_TG_BINRM || tcg.src == GX_TG_TANGENT) {
+      readsNormal = true;
+    } else if (tcg.src == GX_TG_COLOR0) {
+      readAttrs.set(GX_VA_CLR0);
+    } else if (tcg.src == GX_TG_COLOR1) {
+      readAttrs.set(GX_VA_CLR1);
+    }
+  }
+  for (int i = 0; i < info.sampledColorChannels.size(); ++i) {
+    if (!info.sampledColorChannels.test(i)) {
+      // Never rasterized
+      config.colorChannels[i] = {};
+      config.colorChannels[i + GX_ALPHA0] = {};
+      continue;
+    }
+    for (const auto& cc : {config.colorChannels[i], config.colorChannels[i + GX_ALPHA0]}) {
+      if (cc.matSrc == GX_SRC_VTX || (cc.lightingEnabled && cc.ambSrc == GX_SRC_VTX)) {
+        readAttrs.set(GX_VA_CLR0 + i);
+      }
+    }
+  }
+  if (readsNormal) {
+    readAttrs.set(GX_VA_NRM);
+  }
+  for (int i = 0; i < config.attrs.size(); ++i) {
+    if (!readAttrs.test(i)) {
+      config.attrs[i] = {};
+    }
+  }
+
+  // Texgens the TEV never samples aren't generated
+  for (int i = 0; i < info.sampledTexCoords.size(); ++i) {
+    if (!info.sampledTexCoords.test(i)) {
+      config.tcgs[i] = {};
+    }
+  }
+
+  // TEV stage state behind unused inputs
+  bool usesIndirect = false;
+  std::bitset<MaxTevSwap> usedSwaps;
+  for (u32 i = 0; i < config.tevStageCount; ++i) {
+    auto& stage = config.tevStages[i];
+    const bool readsTexture = stage_reads_texture(stage);
+    const bool readsRaster = stage_reads_raster(stage);
+    const bool indirect = stage_uses_indirect(stage);
+    if (!readsTexture && !indirect) {
+      stage.texCoordId = GX_TEXCOORD_NULL;
+      stage.texMapId = GX_TEXMAP_NULL;
+    }
+    if (!readsTexture || stage.texMapId == GX_TEXMAP_NULL) {
+      stage.tevSwapTex = GX_TEV_SWAP0;
+    }
+    if (!readsRaster && !is_alpha_bump_channel(stage.channelId)) {
+      stage.channelId = GX_COLOR_NULL;
+    }
+    if (stage.channelId == GX_COLOR_NULL || stage.channelId == GX_COLOR_ZERO ||
+        is_alpha_bump_channel(stage.channelId)) {
+      stage.tevSwapRas = GX_TEV_SWAP0;
+    }
+    if (!stage_reads_konst_color(stage)) {
+      stage.kcSel = GX_TEV_KCSEL_1;
+    }
+    if (!stage_reads_konst_alpha(stage)) {
+      stage.kaSel = GX_TEV_KASEL_1;
+    }
+    if (!indirect) {
+      stage.indTexStage = GX_INDTEXSTAGE0;
+      stage.indTexFormat = GX_ITF_8;
+      stage.indTexBiasSel = GX_ITB_NONE;
+      stage.indTexAlphaSel = GX_ITBA_OFF;
+      stage.indTexUseOrigLOD = false;
+    }
+    usesIndirect = usesIndirect || indirect;
+    usedSwaps.set(stage.tevSwapTex);
+    usedSwaps.set(stage.tevSwapRas);
+  }
+  for (int i = 0; i < config.tevSwapTable.size(); ++i) {
+    if (!usedSwaps.test(i)) {
+      config.tevSwapTable[i] = {};
+    }
+  }
+
+  // Indirect stages no TEV stage reads
+  if (!usesIndirect) {
+    config.numIndStages = 0;
+  }
+  for (int i = 0; i < config.indStages.size(); ++i) {
+    if (!info.usedIndStages.test(i) || i >= config.numIndStages) {
+      config.indStages[i] = {};
+    }
+  }
+
+  if (config.fogType == GX_FOG_NONE) {
+    config.fogRangeEnabled = false;
+  }
+  auto& alphaCompare = config.alphaCompare;
+  if (compare_ignores_ref(alphaCompare.comp0)) {
+    alphaCompare.ref0 = 0;
+  }
+  if (compare_ignores_ref(alphaCompare.comp1)) {
+    alphaCompare.ref1 = 0;
+  }
+}
+
+} // namespace aurora::gx
@@ -1,21 +1,29 @@
 #include "command_processor.hpp"
 
 #include "../gfx/depth_peek.hpp"
+#include "../gfx/frame_timing.hpp"
+#include "../gfx/pipeline_cache.hpp"
 #include "../gfx/recording.hpp"
 #include "../internal.hpp"
 #include "dolphin/gd/GDGeometry.h"
 #include "dolphin/gx/GXAurora.h"
 #include "gx.hpp"
+#include "perf.hpp"
 #include "pipeline.hpp"
 #include "regs.hpp"
 #include "shader_info.hpp"
+#include "static_indices.hpp"
 #include "texture.hpp"
+#include "uber_config.hpp"
+#include "vertex_decode.hpp"
 
 #include <tracy/Tracy.hpp>
 
 #include <algorithm>
+#include <bit>
 #include <cmath>
 #include <cstdint>
+#include <optional>
 #include <span>
 #include <vector>
 
@@ -177,14 +185,56 @@ struct DrawCache {
   GXVtxFmt fmt = GX_MAX_VTXFMT;
   u8 lineMode = 0;
   bool hasPipeline = false;
+  bool orderIndependent = false;
+  // Uber shader fallback while the specialized pipeline compiles. Readiness is only re-checked when the pipeline
+  // generation changes.
+  bool specializedReady = false;
+  uint32_t specializedGeneration = 0;
+  bool uberSupported = false;
+  bool usingUber = false;
+  gfx::PipelineRef uberPipelineRef{};
+  gfx::Range uberConfigRange{};
   gfx::Range uniformRange{};
   gfx::Range fogRange{};
   FogRangeLutKey fogRangeKey{};
   bool hasFogRange = false;
   GXVtxFmt lastDrawFmt = GX_MAX_VTXFMT;
+  // Automatic instancing: the last unmerged draw, which following draws that repeat it with only a different
+  // position/normal matrix are folded into as extra instances
+  bool instancingSupported = false;
+  bool hasInstancedPipeline = false;
+  bool instancedReady = false;
+  uint32_t instancedGeneration = 0;
+  gfx::PipelineRef instancedPipelineRef{};
+  bool instanceSource = false;
+  GXPrimitive instancePrim = GX_TRIANGLES;
+  gfx::Range instanceVertRange{};
+  gfx::Range instanceMtxRange{};
+  PnMtx instanceMtx{};
+  ByteBuffer instanceVerts;
 };
 DrawCache sDrawCache;
 
+// Instances folded into one draw before a new draw is started.
+constexpr u32 MaxDrawInstances = 256;
+// Larger draws are not worth comparing byte for byte against the previous one.
+constexpr size_t MaxInstancedVertexBytes = 4096;
+
+// Whether a draw can take its position/normal matrix per instance: one matrix for the whole draw (no matrix index
+// attributes, no line/point expansion), and no texgen that reads a position matrix slot.
+bool supports_instancing(const ShaderConfig& config) noexcept {
+  if (config.lineMode != 0) {
+    return false;
+  }
+  for (u32 attr = GX_VA_PNMTXIDX; attr <= GX_VA_TEX7MTXIDX; ++attr) {
+    if (config.attrs[attr].attrType != GX_NONE) {
+      return false;
+    }
+  }
+  return std::ranges::all_of(config.tcgs,
+                             [](const TcgConfig& tcg) { return tcg.src == GX_MAX_TEXGENSRC || tcg.mtx >= GX_TEXMTX0; });
+}
+
 FogRangeLutKey fog_range_lut_key() noexcept {
   const auto& state = g_gxState.fog;
   const f32 logicalWidth = std::max(g_gxState.logicalViewport.width, 1.f);
@@ -261,6 +311,7 @@ ProcessResult process(const u8* data, u32 size) noexcept {
   while (!reader.empty()) {
     const u8 cmd = reader.read<u8>();
     u8 opcode = cmd & CP_OPCODE_MASK;
+    perf::add(perf::Counter::Commands);
 
     switch (opcode) {
     case CP_CMD_NOP:
@@ -270,6 +321,7 @@ ProcessResult process(const u8* data, u32 size) noexcept {
       const u32 value = reader.read<u32>();
       handle_bp(value);
       if (reg_get(value, 8, 24) == GX_BP_REG_DRAWDONE) {
+        perf::add(perf::Counter::FifoBytes, reader.offset());
         return {static_cast<u32>(reader.offset()), true};
       }
       break;
@@ -324,7 +376,8 @@ ProcessResult process(const u8* data, u32 size) noexcept {
     }
 
     case CP_CMD_INVAL_VTX: {
-      // Invalidate vertex cache
+      // Invalidate vertex cache; arrays may have been rewritten in place
+      vertex_decode::invalidate();
       break;
     }
 
@@ -369,6 +422,7 @@ ProcessResult process(const u8* data, u32 size) noexcept {
       break;
     }
   }
+  perf::add(perf::Counter::FifoBytes, size);
   return {size, false};
 }
 
@@ -391,11 +445,18 @@ ProcessResult process(const u8* data, u32 size) noexcept {
   FATAL("draw vertex data overrun: need {} bytes at pos {}, have {}", totalVtxBytes, pos, reader.remaining());
 }
 
+// Indexed attributes of the cached vertex format, as a bitmask of GXAttr. Only maintained for perf counters.
+static u32 sIndexedAttrs = 0;
+
 static u32 calc_vtx_size(GXVtxFmt fmt) noexcept {
   u32 vtxSize = 0;
+  u32 indexedAttrs = 0;
   const auto& vtxFmt = g_gxState.vtxFmts[fmt];
   for (int i = GX_VA_PNMTXIDX; i <= GX_VA_TEX7; ++i) {
     const auto& attrFmt = vtxFmt.attrs[i];
+    if (i >= GX_VA_POS && (g_gxState.vtxDesc[i] == GX_INDEX8 || g_gxState.vtxDesc[i] == GX_INDEX16)) {
+      indexedAttrs |= 1u << i;
+    }
     switch (g_gxState.vtxDesc[i]) {
     case GX_NONE:
       break;
@@ -414,11 +475,40 @@ static u32 calc_vtx_size(GXVtxFmt fmt) noexcept {
   }
   g_gxState.lastVtxFmt = fmt;
   g_gxState.lastVtxSize = vtxSize;
+  sIndexedAttrs = indexedAttrs;
   return vtxSize;
 }
 
+// primVtxCount is the number of vertices that form primitives, which differs from vtxCount for indexed draws.
+static void count_draw(GXPrimitive prim, u32 primVtxCount, u16 vtxCount, u32 vtxBytes) noexcept {
+  perf::count_primitives(prim, primVtxCount);
+  perf::add(perf::Counter::Vertices, vtxCount);
+  perf::add(perf::Counter::VertexBytes, vtxBytes);
+  for (u32 attrs = sIndexedAttrs; attrs != 0; attrs &= attrs - 1) {
+    perf::add_attr_fetches(static_cast<GXAttr>(std::countr_zero(attrs)), vtxCount);
+  }
+}
+
+// Binds an indexed array once per frame: its resident pre-decoded copy when vertex_decode has one, otherwise its raw
+// contents uploaded to this frame's storage. Switching between the two changes how the shader loads the attribute, so
+// it invalidates the pipeline.
+static void upload_array(GXAttr attr, AttrArray& array, const VtxAttrFmt& attrFmt) noexcept {
+  array.cachedRange = vertex_decode::find(attr, attrFmt, array);
+  const bool predecoded = array.cachedRange.size != 0;
+  if (!predecoded) {
+    array.cachedRange = gfx::push_storage(static_cast<const uint8_t*>(array.data), array.size);
+    perf::add(perf::Counter::StorageBytes, array.size);
+    perf::add_attr_upload(attr);
+  }
+  if (predecoded != array.predecoded || (predecoded && array.predecodedFmt != attrFmt)) {
+    g_gxState.dirty |= DirtyPipeline;
+  }
+  array.predecoded = predecoded;
+  array.predecodedFmt = attrFmt;
+}
+
 static void push_gx_draw(GXPrimitive prim, GXVtxFmt fmt, u16 vtxCount, gfx::Range vertRange, gfx::Range idxRange,
-                         u32 numIndices) noexcept {
+                         u32 numIndices, bool staticIndices = false) noexcept {
   auto& state = g_gxState;
   auto& cache = sDrawCache;
 
@@ -428,8 +518,9 @@ static void push_gx_draw(GXPrimitive prim, GXVtxFmt fmt, u16 vtxCount, gfx::Rang
       continue;
     }
     auto& array = state.arrays[i];
-    if (array.cachedRange.size == 0) {
-      array.cachedRange = gfx::push_storage(static_cast<const uint8_t*>(array.data), array.size);
+    const auto& attrFmt = state.vtxFmts[fmt].attrs[i];
+    if (array.cachedRange.size == 0 || (array.predecoded && array.predecodedFmt != attrFmt)) {
+      upload_array(static_cast<GXAttr>(i), array, attrFmt);
     }
     immediates.arrayStart[i - GX_VA_POS] = array.cachedRange.offset;
   }
@@ -444,9 +535,20 @@ static void push_gx_draw(GXPrimitive prim, GXVtxFmt fmt, u16 vtxCount, gfx::Rang
     populate_pipeline_config(cache.config, prim, fmt);
     cache.shaderInfo = build_shader_info(cache.config.shaderConfig);
     cache.pipelineRef = gfx::pipeline_ref(cache.config);
+    cache.specializedGeneration = gfx::pipeline_generation();
+    cache.specializedReady = gfx::has_pipeline(cache.pipelineRef);
+    perf::add(perf::Counter::PipelineLookups);
+    if (!cache.specializedReady) {
+      perf::add(perf::Counter::PipelineMisses);
+    }
     cache.fmt = fmt;
     cache.lineMode = lineMode;
     cache.hasPipeline = true;
+    cache.orderIndependent = is_order_independent(cache.config);
+    cache.instancingSupported = supports_instancing(cache.config.shaderConfig);
+    cache.hasInstancedPipeline = false;
+    cache.uberSupported = uber::supported(cache.config.shaderConfig);
+    cache.uberConfigRange = {};
     state.dirty = (state.dirty & ~DirtyPipeline) | DirtyUniform;
     if (!hadPipeline || prevSampledTextures != cache.shaderInfo.sampledTextures ||
         prevSampledIndTextures != cache.shaderInfo.sampledIndTextures) {
@@ -468,15 +570,35 @@ static void push_gx_draw(GXPrimitive prim, GXVtxFmt fmt, u16 vtxCount, gfx::Rang
     }
   }
 
-  const bool uniformValid = (state.dirty & DirtyUniform) == 0 && cache.uniformRange.size != 0;
+  if (!cache.specializedReady && cache.specializedGeneration != gfx::pipeline_generation()) {
+    cache.specializedGeneration = gfx::pipeline_generation();
+    cache.specializedReady = gfx::has_pipeline(cache.pipelineRef);
+  }
+  const bool useUber = !cache.specializedReady && cache.uberSupported;
+  if (useUber != cache.usingUber) {
+    cache.usingUber = useUber;
+    state.dirty |= DirtyUniform;
+  }
+  if (useUber) {
+    if (cache.uberConfigRange.size == 0) {
+      cache.uberPipelineRef = uber_pipeline_ref(cache.config);
+      cache.uberConfigRange = gfx::push_storage(uber::pack(cache.config.shaderConfig));
+      perf::add(perf::Counter::StorageBytes, cache.uberConfigRange.size);
+    }
+    immediates.storageBase = cache.uberConfigRange.offset / sizeof(u32);
+  }
+
+  const bool uniformValid = (state.dirty & (DirtyUniform | DirtyPnMtx)) == 0 && cache.uniformRange.size != 0;
   if (!uniformValid) {
-    cache.uniformRange = build_uniform(cache.shaderInfo);
-    state.dirty &= ~DirtyUniform;
+    cache.uniformRange = useUber ? build_uber_uniform(cache.shaderInfo) : build_uniform(cache.shaderInfo);
+    perf::add(perf::Counter::UniformBytes, cache.uniformRange.size);
+    state.dirty &= ~(DirtyUniform | DirtyPnMtx);
   }
   if (cache.config.shaderConfig.fogRangeEnabled) {
     const auto key = fog_range_lut_key();
     if (!cache.hasFogRange || cache.fogRangeKey != key) {
       cache.fogRange = push_fog_range_lut(key);
+      perf::add(perf::Counter::StorageBytes, cache.fogRange.size);
       cache.fogRangeKey = key;
       cache.hasFogRange = true;
     }
@@ -494,8 +616,10 @@ static void push_gx_draw(GXPrimitive prim, GXVtxFmt fmt, u16 vtxCount, gfx::Rang
     instanceCount = vtxCount;
   }
   cache.lastDrawFmt = fmt;
+  cache.instanceSource = false;
+  perf::add(perf::Counter::DrawsSubmitted);
   gfx::push_draw_command(DrawData{
-      .pipeline = cache.pipelineRef,
+      .pipeline = useUber ? cache.uberPipelineRef : cache.pipelineRef,
       .vertRange = vertRange,
       .idxRange = idxRange,
       .uniformRange = cache.uniformRange,
@@ -505,6 +629,8 @@ static void push_gx_draw(GXPrimitive prim, GXVtxFmt fmt, u16 vtxCount, gfx::Rang
       .instanceCount = instanceCount,
       .bindGroups = cache.bindGroups,
       .dstAlpha = state.dstAlpha,
+      .staticIndices = staticIndices,
+      .orderIndependent = cache.orderIndependent,
   });
 }
 
@@ -512,20 +638,118 @@ static void handle_draw_unmerged(GXPrimitive prim, GXVtxFmt fmt, u16 vtxCount, g
   ZoneScoped;
   u32 numIndices = 0;
   gfx::Range idxRange;
+  bool staticIndices = false;
 
   if (prim != GX_TRIANGLES) {
-    ZoneScopedN("build idx buffer");
-    static ByteBuffer idxBuf;
-    numIndices = prepare_idx_buffer(idxBuf, prim, 0, vtxCount);
-    idxRange = gfx::push_indices(idxBuf.data(), idxBuf.size(), 4);
-    idxBuf.clear();
+    if (const auto slice = static_indices::find(prim, vtxCount)) {
+      idxRange = slice->range;
+      numIndices = slice->indexCount;
+      staticIndices = true;
+    } else {
+      ZoneScopedN("build idx buffer");
+      static ByteBuffer idxBuf;
+      numIndices = prepare_idx_buffer(idxBuf, prim, 0, vtxCount);
+      idxRange = gfx::push_indices(idxBuf.data(), idxBuf.size(), 4);
+      perf::add(perf::Counter::IndexBytes, idxBuf.size());
+      idxBuf.clear();
+    }
   }
 
-  push_gx_draw(prim, fmt, vtxCount, vertRange, idxRange, numIndices);
+  push_gx_draw(prim, fmt, vtxCount, vertRange, idxRange, numIndices, staticIndices);
+}
+
+// Quad draws merged onto a quad draw using the static index buffer keep using it: the merged index list is the quad
+// pattern for the combined vertex count, so it continues right after the previous draw's slice. Returns the slice
+// holding the merged draw's indices, or nullopt if the previous draw's indices must move to the per-frame buffer.
+static std::optional<static_indices::Slice> continue_static_indices(const DrawData& lastDraw, GXPrimitive prim,
+                                                                    u16 vtxCount) noexcept {
+  if (prim != GX_QUADS || lastDraw.vtxCount % 4 != 0 || lastDraw.vtxCount + vtxCount > static_indices::MaxVertices) {
+    return std::nullopt;
+  }
+  const auto last = static_indices::find(GX_QUADS, static_cast<u16>(lastDraw.vtxCount));
+  if (!last || last->range.offset != lastDraw.idxRange.offset) {
+    return std::nullopt;
+  }
+  const auto merged = static_indices::find(GX_QUADS, static_cast<u16>(lastDraw.vtxCount + vtxCount));
+  return static_indices::Slice{
+      .range = {.offset = last->range.offset + last->range.size, .size = merged->range.size - last->range.size},
+      .indexCount = merged->indexCount - last->indexCount,
+  };
+}
+
+// Records the draw just pushed as the one that following identical draws may be instanced onto.
+static void set_instance_source(GXPrimitive prim, std::span<const u8> vertexData) noexcept {
+  auto& cache = sDrawCache;
+  const auto* draw = gfx::get_last_draw_command<DrawData>();
+  if (!cache.instancingSupported || draw == nullptr || draw->pipeline != cache.pipelineRef ||
+      vertexData.size() > MaxInstancedVertexBytes) {
+    return;
+  }
+  cache.instanceSource = true;
+  cache.instancePrim = prim;
+  cache.instanceVertRange = draw->vertRange;
+  cache.instanceMtx = g_gxState.pnMtx[g_gxState.currentPnMtx];
+  cache.instanceVerts.clear();
+  cache.instanceVerts.append(vertexData.data(), vertexData.size());
+}
+
+// Folds a draw that repeats the previous one except for its position/normal matrix into it as another instance,
+// reusing its vertices, indices and uniform. The per-instance matrices are appended contiguously to abuf, and the
+// instanced pipeline reads them there by instance index. Returns false if the draw must be recorded normally.
+static bool try_instance_draw(GXPrimitive prim, GXVtxFmt fmt, std::span<const u8> vertexData) noexcept {
+  auto& state = g_gxState;
+  auto& cache = sDrawCache;
+  if (!cache.instanceSource || state.dirty != DirtyPnMtx || prim != cache.instancePrim || fmt != cache.fmt ||
+      cache.bindGeneration != texture::current_bind_generation() || vertexData.size() != cache.instanceVerts.size() ||
+      std::memcmp(vertexData.data(), cache.instanceVerts.data(), vertexData.size()) != 0) {
+    return false;
+  }
+  auto* lastDraw = gfx::get_last_draw_command<DrawData>();
+  if (lastDraw == nullptr || lastDraw->vertRange != cache.instanceVertRange ||
+      lastDraw->instanceCount >= MaxDrawInstances) {
+    return false;
+  }
+
+  const auto& mtx = state.pnMtx[state.currentPnMtx];
+  if (lastDraw->instanceCount == 1) {
+    if (!cache.hasInstancedPipeline) {
+      PipelineConfig config = cache.config;
+      config.shaderConfig.instancedMtx = true;
+      cache.instancedPipelineRef = gfx::pipeline_ref(config);
+      cache.hasInstancedPipeline = true;
+      cache.instancedGeneration = gfx::pipeline_generation();
+      cache.instancedReady = gfx::has_pipeline(cache.instancedPipelineRef);
+    }
+    if (!cache.instancedReady && cache.instancedGeneration != gfx::pipeline_generation()) {
+      cache.instancedGeneration = gfx::pipeline_generation();
+      cache.instancedReady = gfx::has_pipeline(cache.instancedPipelineRef);
+    }
+    if (!cache.instancedReady) {
+      return false;
+    }
+    const std::array mtxs{cache.instanceMtx, mtx};
+    cache.instanceMtxRange = gfx::push_storage(mtxs);
+    perf::add(perf::Counter::StorageBytes, cache.instanceMtxRange.size);
+    lastDraw->pipeline = cache.instancedPipelineRef;
+    lastDraw->immediateData.storageBase = cache.instanceMtxRange.offset / sizeof(u32);
+  } else {
+    if (gfx::storage_offset() != cache.instanceMtxRange.offset + cache.instanceMtxRange.size) {
+      // Something else was appended to abuf since the last instance
+      return false;
+    }
+    const auto range = gfx::push_storage_contiguous(reinterpret_cast<const u8*>(&mtx), sizeof(mtx));
+    perf::add(perf::Counter::StorageBytes, range.size);
+    cache.instanceMtxRange.size += range.size;
+  }
+  ++lastDraw->instanceCount;
+  gfx::detail::increment_instanced_draw_count();
+  perf::add(perf::Counter::DrawsInstanced);
+  return true;
 }
 
 static void draw_prim(GXPrimitive prim, GXVtxFmt fmt, u16 vtxCount, Reader& reader) noexcept {
   ZoneScoped;
+  gfx::frame_timing::ScopedTimer timer{gfx::frame_timing::Phase::DrawBuild};
   u32 vtxSize;
   if (g_gxState.lastVtxFmt == fmt)
     LIKELY { vtxSize = g_gxState.lastVtxSize; }
@@ -541,24 +765,48 @@ static void draw_prim(GXPrimitive prim, GXVtxFmt fmt, u16 vtxCount, Reader& read
   auto* lastDraw = cleanState ? gfx::get_last_draw_command<DrawData>() : nullptr;
   const bool canMerge = lastDraw != nullptr && lastDraw->instanceCount == 1;
 
-  // Push raw vertex data to buffer. Merged draws must remain contiguous with the previous range.
   const auto vertexData = reader.take(totalVtxBytes);
+  if (!canMerge && try_instance_draw(prim, fmt, vertexData)) {
+    count_draw(prim, vtxCount, vtxCount, 0);
+    return;
+  }
+
+  // Push raw vertex data to buffer. Merged draws must remain contiguous with the previous range.
   gfx::Range vertRange = gfx::push_verts(vertexData.data(), vertexData.size(), canMerge ? 0 : 4);
+  count_draw(prim, vtxCount, vtxCount, totalVtxBytes);
 
   // Try to merge with previous draw call
   if (canMerge) {
     u32 numIndices = 0;
     gfx::Range idxRange;
     static ByteBuffer idxBuf;
-    const bool hadIndexRange = lastDraw->idxRange.size != 0;
-    if (lastDraw->indexCount == 0 && prim != GX_TRIANGLES) {
-      // Generate triangle index buffer for previous draw
-      lastDraw->indexCount = prepare_idx_buffer(idxBuf, GX_TRIANGLES, 0, lastDraw->vtxCount);
+    std::optional<static_indices::Slice> staticTail;
+    if (lastDraw->staticIndices) {
+      staticTail = continue_static_indices(*lastDraw, prim, vtxCount);
+      if (!staticTail) {
+        // Move the previous draw's indices to the per-frame buffer so the merged indices can follow them
+        const auto indices =
+            static_indices::data().subspan(lastDraw->idxRange.offset / sizeof(u16), lastDraw->indexCount);
+        lastDraw->idxRange = gfx::push_indices(reinterpret_cast<const u8*>(indices.data()), indices.size_bytes(), 4);
+        lastDraw->staticIndices = false;
+        perf::add(perf::Counter::IndexBytes, indices.size_bytes());
+      }
     }
-    if (lastDraw->indexCount != 0) {
-      numIndices += prepare_idx_buffer(idxBuf, prim, lastDraw->vtxCount, vtxCount);
-      idxRange = gfx::push_indices(idxBuf.data(), idxBuf.size(), hadIndexRange ? 0 : 4);
-      idxBuf.clear();
+    const bool hadIndexRange = lastDraw->idxRange.size != 0;
+    if (staticTail) {
+      idxRange = staticTail->range;
+      numIndices = staticTail->indexCount;
+    } else {
+      if (lastDraw->indexCount == 0 && prim != GX_TRIANGLES) {
+        // Generate triangle index buffer for previous draw
+        lastDraw->indexCount = prepare_idx_buffer(idxBuf, GX_TRIANGLES, 0, lastDraw->vtxCount);
+      }
+      if (lastDraw->indexCount != 0) {
+        numIndices += prepare_idx_buffer(idxBuf, prim, lastDraw->vtxCount, vtxCount);
+        idxRange = gfx::push_indices(idxBuf.data(), idxBuf.size(), hadIndexRange ? 0 : 4);
+        perf::add(perf::Counter::IndexBytes, idxBuf.size());
+        idxBuf.clear();
+      }
     }
     CHECK(lastDraw->vertRange.offset + lastDraw->vertRange.size == vertRange.offset,
           "Non-consecutive vertex ranges ({} < {})", lastDraw->vertRange.offset + lastDraw->vertRange.size,
@@ -576,11 +824,14 @@ static void draw_prim(GXPrimitive prim, GXVtxFmt fmt, u16 vtxCount, Reader& read
     }
     lastDraw->vtxCount += vtxCount;
     lastDraw->indexCount += numIndices;
+    sDrawCache.instanceSource = false;
     gfx::detail::increment_merged_draw_count();
+    perf::add(perf::Counter::DrawsMerged);
     return;
   }
 
   handle_draw_unmerged(prim, fmt, vtxCount, vertRange);
+  set_instance_source(prim, vertexData);
 }
 
 static void handle_draw(u8 cmd, Reader& reader) noexcept {
@@ -761,6 +1012,7 @@ void handle_aurora(Reader& reader) noexcept {
     }
   } else if (subCmd == GX_AURORA_DRAW_INDEXED) {
     ZoneScopedN("DRAW_INDEXED");
+    gfx::frame_timing::ScopedTimer timer{gfx::frame_timing::Phase::DrawBuild};
     const u8 cmd = reader.read<u8>();
     const u16 vtxCount = reader.read<u16>();
     const u32 indexCount = reader.read<u32>();
@@ -781,6 +1033,8 @@ void handle_aurora(Reader& reader) noexcept {
     const u32 totalVtxBytes = vtxCount * vtxSize;
     const auto vertexData = reader.take(totalVtxBytes);
     const gfx::Range vertRange = gfx::push_verts(vertexData.data(), vertexData.size(), 4);
+    count_draw(prim, indexCount, vtxCount, totalVtxBytes);
+    perf::add(perf::Counter::IndexBytes, idxBytes);
     if (indexCount != 0) {
       push_gx_draw(prim, fmt, vtxCount, vertRange, idxRange, indexCount);
     }
@@ -802,8 +1056,10 @@ void handle_aurora(Reader& reader) noexcept {
 void clear_draw_cache() noexcept {
   sDrawCache.bindGeneration = 0;
   sDrawCache.uniformRange = {};
+  sDrawCache.uberConfigRange = {};
   sDrawCache.fogRange = {};
   sDrawCache.hasFogRange = false;
+  sDrawCache.instanceSource = false;
 }
 
 } // namespace aurora::gx::fifo
@@ -1,5 +1,6 @@
 #include "fifo.hpp"
 
+#include "../gfx/frame_timing.hpp"
 #include "../thread.hpp"
 #include "command_processor.hpp"
 
@@ -59,6 +60,7 @@ void process_to(uint64_t target, std::memory_order order) noexcept {
                     sStreamBase + detail::sBufferSize);
       const auto start = static_cast<uint32_t>(processed - sStreamBase);
       const auto size = static_cast<uint32_t>(target - processed);
+      gfx::frame_timing::ScopedTimer timer{gfx::frame_timing::Phase::FifoProcess};
       result = process(detail::sBufferData + start, size);
     }
     AURORA_ASSERT(result.bytesProcessed > 0 && result.bytesProcessed <= target - processed,
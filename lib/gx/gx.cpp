@@ -1,7 +1,11 @@
 #include "gx.hpp"
 
+#include "bind_group_cache.hpp"
 #include "pipeline.hpp"
+#include "shader_info.hpp"
+#include "static_indices.hpp"
 #include "texture.hpp"
+#include "vertex_decode.hpp"
 #include "../dolphin/vi/vi_internal.hpp"
 #include "../webgpu/gpu.hpp"
 #include "../internal.hpp"
@@ -19,6 +23,7 @@
 #include <bit>
 #include <cfloat>
 #include <cmath>
+#include <cstring>
 #include <mutex>
 #include <utility>
 
@@ -30,6 +35,7 @@ using webgpu::g_graphicsConfig;
 
 GXState g_gxState{};
 wgpu::BindGroup g_emptyTextureBindGroup;
+wgpu::Buffer g_staticIndexBuffer;
 
 namespace {
 wgpu::Sampler sEmptySampler;
@@ -408,6 +414,17 @@ void populate_pipeline_config(PipelineConfig& config, GXPrimitive primitive, GXV
     default:
       Log.fatal("populate_pipeline_config: Invalid vertex type {}", type);
     }
+    const auto& array = g_gxState.arrays[i];
+    if (type != GX_DIRECT && array.predecoded && array.predecodedFmt == attrFmt) {
+      mapping.stride = vertex_decode::decoded_components(attr, attrFmt) * sizeof(f32);
+      mapping.le = true;
+      mapping.predecoded = true;
+      if (attr != GX_VA_CLR0 && attr != GX_VA_CLR1) {
+        // A plain little-endian f32 array, which the uber shader can read as such
+        mapping.compType = GX_F32;
+        mapping.frac = 0;
+      }
+    }
   }
   config.shaderConfig.vtxStride = vtxOffset;
   if (primitive == GX_LINES) {
@@ -445,6 +462,8 @@ void populate_pipeline_config(PipelineConfig& config, GXPrimitive primitive, GXV
   if (g_gxState.alphaCompare) {
     config.shaderConfig.alphaCompare = g_gxState.alphaCompare;
   }
+  // Drop state the shader can't observe so that equivalent configs share a pipeline
+  canonicalize_shader_config(config.shaderConfig, build_shader_info(config.shaderConfig));
   const auto cullMode = config.shaderConfig.lineMode == 0 ? g_gxState.cullMode : GX_CULL_NONE;
   const auto [polygonOffset, polygonOffsetScale] = polygon_offset_for_cull_mode(cullMode);
   config = {
@@ -475,6 +494,13 @@ GXBindGroups build_bind_groups(const ShaderInfo& info) noexcept {
     return {};
   }
 
+  const auto key = texture_bindings_key(info, g_gxState.textures, g_graphicsConfig.textureAnisotropy);
+  if (const auto bindGroup = bind_group_cache::find(key)) {
+    return {
+        .textureBindGroup = bindGroup,
+    };
+  }
+
   // Using C WGPU types instead of C++ wrappers to avoid destructor overhead
   std::array<WGPUBindGroupEntry, MaxTextures * 2> textureEntries{};
   for (u32 i = 0; i < MaxTextures; ++i) {
@@ -497,8 +523,10 @@ GXBindGroups build_bind_groups(const ShaderInfo& info) noexcept {
       .entryCount = textureEntries.size(),
       .entries = textureEntries.data(),
   };
+  const auto bindGroup = gfx::bind_group_ref(textureBindGroupDescriptor);
+  bind_group_cache::insert(key, bindGroup);
   return {
-      .textureBindGroup = gfx::bind_group_ref(textureBindGroupDescriptor),
+      .textureBindGroup = bindGroup,
   };
 }
 
@@ -562,6 +590,18 @@ void initialize() noexcept {
     };
     g_emptyTextureBindGroup = g_device.CreateBindGroup(&desc);
   }
+  {
+    const auto indices = static_indices::data();
+    const wgpu::BufferDescriptor descriptor{
+        .label = "GX Static Index Buffer",
+        .usage = wgpu::BufferUsage::Index,
+        .size = indices.size_bytes(),
+        .mappedAtCreation = true,
+    };
+    g_staticIndexBuffer = g_device.CreateBuffer(&descriptor);
+    std::memcpy(g_staticIndexBuffer.GetMappedRange(0, indices.size_bytes()), indices.data(), indices.size_bytes());
+    g_staticIndexBuffer.Unmap();
+  }
   {
     const std::array layouts{
         gfx::detail::resources().staticBindGroupLayout,
@@ -582,6 +622,7 @@ void shutdown() noexcept {
   // TODO we should probably store this all in g_state.gx instead
   sSamplerBindGroupLayout = {};
   sTextureBindGroupLayout = {};
+  g_staticIndexBuffer = {};
   {
     std::lock_guard lock{sBindGroupLayoutMutex};
     sUniformBindGroupLayouts.clear();
@@ -593,6 +634,7 @@ void shutdown() noexcept {
   g_gxState.loadedTextures.fill({});
   g_gxState.loadedTluts.fill({});
   clear_copy_texture_cache();
+  vertex_decode::clear();
   texture::shutdown();
 }
 } // namespace aurora::gx
@@ -74,20 +74,25 @@ enum DirtyFlag : u8 {
   DirtyTextures = 1 << 1,
   DirtyUniform = 1 << 2,
   DirtyImmediates = 1 << 3,
-  DirtyAll = DirtyPipeline | DirtyTextures | DirtyUniform | DirtyImmediates,
+  // Position/normal matrix loads. Rebuilds the uniform like DirtyUniform, but is tracked separately so that draws
+  // differing only in their matrices can be instanced.
+  DirtyPnMtx = 1 << 4,
+  DirtyAll = DirtyPipeline | DirtyTextures | DirtyUniform | DirtyImmediates | DirtyPnMtx,
 };
 
 struct DrawImmediateData {
   u32 vtxStart = 0;
   u32 currentPnMtx = 0;
   u32 fogRangeBase = 0;
-  u32 _pad = 0;
+  // abuf word index of the packed uber::Config for uber draws, or of the per-instance matrices for instanced draws
+  u32 storageBase = 0;
   std::array<u32, MaxIndexAttr> arrayStart{};
 };
 static_assert(std::has_unique_object_representations_v<DrawImmediateData>);
 static_assert(sizeof(DrawImmediateData) == 64);
 
 extern wgpu::BindGroup g_emptyTextureBindGroup;
+extern wgpu::Buffer g_staticIndexBuffer;
 
 template <typename Arg, Arg Default>
 struct TevPass {
@@ -261,6 +266,8 @@ struct VtxAttrFmt {
   u8 _p1 = 0;
   u8 _p2 = 0;
   u8 _p3 = 0;
+
+  bool operator==(const VtxAttrFmt& rhs) const { return memcmp(this, &rhs, sizeof(*this)) == 0; }
 };
 static_assert(std::has_unique_object_representations_v<VtxAttrFmt>);
 struct VtxFmt {
@@ -272,6 +279,8 @@ struct PnMtx {
   Mat3x4<float> nrm;
 };
 static_assert(sizeof(PnMtx) == sizeof(Mat3x4<float>) * 2);
+// Instanced draws store one PnMtx per instance in abuf, starting at DrawImmediateData::storageBase.
+constexpr u32 InstancedMtxWords = sizeof(PnMtx) / sizeof(u32);
 struct Light {
   Vec4<float> pos{0.f, 0.f, 0.f};
   Vec4<float> dir{0.f, 0.f, 0.f};
@@ -300,6 +309,9 @@ struct AttrArray {
   u8 stride;
   bool le = true;
   gfx::Range cachedRange;
+  // cachedRange holds the array pre-decoded for predecodedFmt rather than its raw bytes; see vertex_decode.hpp
+  bool predecoded = false;
+  VtxAttrFmt predecodedFmt{};
 };
 inline bool operator==(const AttrArray& lhs, const AttrArray& rhs) {
   return lhs.data == rhs.data && lhs.size == rhs.size && lhs.stride == rhs.stride && lhs.le == rhs.le;
@@ -484,14 +496,19 @@ struct AttrConfig {
   u8 stride = 0;         // Array stride
   u8 frac = 0;
   bool le = true;
-  bool nbt3 = false; // GX_NRM_NBT3
+  u8 nbt3 : 1 = false; // GX_NRM_NBT3
+  // Indexed loads read the f32 copy of the array made by vertex_decode
+  u8 predecoded : 1 = false;
+  u8 pad : 6 = 0;
 };
 struct ShaderConfig {
   u8 fogType = GX_FOG_NONE;
   u8 vtxStride = 0;
   u8 lineMode : 2 = 0; // 1 = GX_LINES, 2 = GX_LINESTRIP, 3 = GX_POINTS
   u8 fogRangeEnabled : 1 = false;
-  u8 pad1 : 5 = 0;
+  // Position/normal matrices come from abuf per instance instead of the uniform; see InstancedMtxWords
+  u8 instancedMtx : 1 = false;
+  u8 pad1 : 4 = 0;
   u8 pad2 = 0;
   std::array<AttrConfig, MaxVtxAttr> attrs;
   std::array<TevSwap, MaxTevSwap> tevSwapTable;
@@ -538,6 +555,8 @@ wgpu::RenderPipeline build_pipeline(const PipelineConfig& config, ArrayRef<wgpu:
                                     wgpu::ShaderModule shader, const char* label) noexcept;
 std::string build_shader_source(const ShaderConfig& config) noexcept;
 wgpu::ShaderModule build_shader(const ShaderConfig& config) noexcept;
+std::string build_uber_shader_source() noexcept;
+wgpu::ShaderModule build_uber_shader() noexcept;
 GXBindGroups build_bind_groups(const ShaderInfo& info) noexcept;
 
 u8 comp_type_size(GXAttr attr, GXCompType type) noexcept;
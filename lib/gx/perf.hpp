@@ -0,0 +1,136 @@
+#pragma once
+
+#include "../internal.hpp"
+
+#include <dolphin/gx/GXEnum.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Set to 0 to compile out all GXPerf counter maintenance. The GXRead*Metric functions then report zeros.
+#ifndef AURORA_GX_PERF_COUNTERS
+#define AURORA_GX_PERF_COUNTERS 1
+#endif
+
+namespace aurora::gx::perf {
+
+enum class Counter : uint32_t {
+  FifoBytes,
+  Commands,
+  Vertices,
+  // Primitives by GX primitive type
+  Quads,
+  Triangles,
+  TriangleStripTris,
+  TriangleFanTris,
+  Lines,
+  LineStripLines,
+  Points,
+  // Draws recorded to the renderer; merged draws were folded into the previous draw instead, and instanced draws
+  // were added to it as another instance
+  DrawsSubmitted,
+  DrawsMerged,
+  DrawsInstanced,
+  // Host uploads
+  VertexBytes,
+  IndexBytes,
+  UniformBytes,
+  StorageBytes,
+  TextureBytes,
+  TextureCacheHits,
+  TextureCacheMisses,
+  // Pipeline lookups after a state change, and those whose pipeline was not yet compiled
+  PipelineLookups,
+  PipelineMisses,
+  EfbCopies,
+  EfbCopyPixels,
+  Count,
+};
+
+// Indexed attribute fetches per vertex attribute, GX_VA_POS through GX_VA_TEX7. A miss is an array upload.
+inline constexpr size_t VertexCacheAttrCount = GX_VA_TEX7 - GX_VA_POS + 1;
+
+struct Snapshot {
+  std::array<uint64_t, static_cast<size_t>(Counter::Count)> counters{};
+  std::array<uint64_t, VertexCacheAttrCount> attrChecks{};
+  std::array<uint64_t, VertexCacheAttrCount> attrMisses{};
+
+  [[nodiscard]] uint64_t operator[](Counter counter) const noexcept { return counters[static_cast<size_t>(counter)]; }
+  [[nodiscard]] uint64_t triangles() const noexcept {
+    return (*this)[Counter::Quads] * 2 + (*this)[Counter::Triangles] + (*this)[Counter::TriangleStripTris] +
+           (*this)[Counter::TriangleFanTris];
+  }
+};
+
+#if AURORA_GX_PERF_COUNTERS
+namespace detail {
+inline std::array<std::atomic_uint64_t, static_cast<size_t>(Counter::Count)> g_counters{};
+inline std::array<std::atomic_uint64_t, VertexCacheAttrCount> g_attrChecks{};
+inline std::array<std::atomic_uint64_t, VertexCacheAttrCount> g_attrMisses{};
+
+// Counters have a single writer (the thread processing the FIFO), so a relaxed load/store pair is enough and avoids
+// a locked read-modify-write on every draw.
+inline void bump(std::atomic_uint64_t& counter, uint64_t value) noexcept {
+  counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+} // namespace detail
+
+inline void add(Counter counter, uint64_t value = 1) noexcept {
+  detail::bump(detail::g_counters[static_cast<size_t>(counter)], value);
+}
+
+inline void add_attr_fetches(GXAttr attr, uint64_t value) noexcept {
+  detail::bump(detail::g_attrChecks[attr - GX_VA_POS], value);
+}
+
+inline void add_attr_upload(GXAttr attr) noexcept { detail::bump(detail::g_attrMisses[attr - GX_VA_POS], 1); }
+
+inline void count_primitives(GXPrimitive prim, uint32_t vtxCount) noexcept {
+  switch (prim) {
+  case GX_QUADS:
+    add(Counter::Quads, vtxCount / 4);
+    break;
+  case GX_TRIANGLES:
+    add(Counter::Triangles, vtxCount / 3);
+    break;
+  case GX_TRIANGLESTRIP:
+    add(Counter::TriangleStripTris, vtxCount > 2 ? vtxCount - 2 : 0);
+    break;
+  case GX_TRIANGLEFAN:
+    add(Counter::TriangleFanTris, vtxCount > 2 ? vtxCount - 2 : 0);
+    break;
+  case GX_LINES:
+    add(Counter::Lines, vtxCount / 2);
+    break;
+  case GX_LINESTRIP:
+    add(Counter::LineStripLines, vtxCount > 1 ? vtxCount - 1 : 0);
+    break;
+  case GX_POINTS:
+    add(Counter::Points, vtxCount);
+    break;
+  default:
+    break;
+  }
+}
+
+inline Snapshot snapshot() noexcept {
+  Snapshot ret;
+  for (size_t i = 0; i < ret.counters.size(); ++i) {
+    ret.counters[i] = detail::g_counters[i].load(std::memory_order_relaxed);
+  }
+  for (size_t i = 0; i < VertexCacheAttrCount; ++i) {
+    ret.attrChecks[i] = detail::g_attrChecks[i].load(std::memory_order_relaxed);
+    ret.attrMisses[i] = detail::g_attrMisses[i].load(std::memory_order_relaxed);
+  }
+  return ret;
+}
+#else
+inline void add(Counter, uint64_t = 1) noexcept {}
+inline void add_attr_fetches(GXAttr, uint64_t) noexcept {}
+inline void add_attr_upload(GXAttr) noexcept {}
+inline void count_primitives(GXPrimitive, uint32_t) noexcept {}
+inline Snapshot snapshot() noexcept { return {}; }
+#endif
+
+} // namespace aurora::gx::perf
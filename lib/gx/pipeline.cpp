@@ -21,6 +21,19 @@ wgpu::RenderPipeline create_pipeline(const PipelineConfig& config) {
   return build_pipeline(config, {}, shader, label.c_str());
 }
 
+wgpu::RenderPipeline create_uber_pipeline(const PipelineConfig& config) {
+  ZoneScoped;
+  const auto label =
+      fmt::format("GX Uber Pipeline {:x}", xxh3_hash(config, static_cast<HashType>(gfx::ShaderType::GXUber)));
+  return build_pipeline(config, {}, build_uber_shader(), label.c_str());
+}
+
+gfx::PipelineRef uber_pipeline_ref(const PipelineConfig& config) noexcept {
+  PipelineConfig uberConfig = config;
+  uberConfig.shaderConfig = {};
+  return gfx::find_pipeline(gfx::ShaderType::GXUber, uberConfig, [=] { return create_uber_pipeline(uberConfig); });
+}
+
 void render(const DrawData& data, const wgpu::RenderPassEncoder& pass) {
   if (!gfx::bind_pipeline(data.pipeline, pass)) {
     return;
@@ -31,9 +44,10 @@ void render(const DrawData& data, const wgpu::RenderPassEncoder& pass) {
   const std::array offsets{data.uniformRange.offset};
   pass.SetBindGroup(1, resources.uniformBindGroup, offsets.size(), offsets.data());
   if (data.bindGroups.textureBindGroup) {
-    pass.SetBindGroup(2, gfx::find_bind_group(data.bindGroups.textureBindGroup));
+    gfx::bind_texture_group(data.bindGroups.textureBindGroup, pass);
   }
-  pass.SetIndexBuffer(resources.indexBuffer, wgpu::IndexFormat::Uint16, data.idxRange.offset, data.idxRange.size);
+  pass.SetIndexBuffer(data.staticIndices ? g_staticIndexBuffer : resources.indexBuffer, wgpu::IndexFormat::Uint16,
+                      data.idxRange.offset, data.idxRange.size);
   if (data.dstAlpha != UINT32_MAX) {
     const wgpu::Color color{0.f, 0.f, 0.f, data.dstAlpha / 255.f};
     pass.SetBlendConstant(&color);
@@ -15,9 +15,13 @@ struct DrawData {
   uint32_t instanceCount;
   GXBindGroups bindGroups;
   uint32_t dstAlpha;
+  // idxRange refers to g_staticIndexBuffer rather than the per-frame index buffer; see static_indices.hpp.
+  bool staticIndices;
+  // Set for draws that may be reordered among each other when the pass is sealed; see is_order_independent.
+  bool orderIndependent;
 };
 
-constexpr uint32_t GXPipelineConfigVersion = 13;
+constexpr uint32_t GXPipelineConfigVersion = 16;
 struct PipelineConfig {
   uint32_t version = GXPipelineConfigVersion;
   uint32_t msaaSamples = 1;
@@ -35,7 +39,31 @@ struct PipelineConfig {
 };
 static_assert(std::has_unique_object_representations_v<PipelineConfig>);
 
+// Whether consecutive draws with configs like this one leave the same result in any order: opaque, depth-tested and
+// depth-written with an ordering compare, writing both color and alpha, with no blending, logic op or destination
+// alpha. A masked draw that wins the depth test keeps the color beneath it, so its order still matters. The one
+// exception is fragments of different draws landing at exactly the same depth, which is why reordering is opt-in.
+inline bool is_order_independent(const PipelineConfig& config) noexcept {
+  if (config.blendMode != GX_BM_NONE || config.dstAlpha != UINT32_MAX || !config.depthCompare || !config.depthUpdate ||
+      !config.colorUpdate || !config.alphaUpdate) {
+    return false;
+  }
+  switch (config.depthFunc) {
+  case GX_LESS:
+  case GX_LEQUAL:
+  case GX_GREATER:
+  case GX_GEQUAL:
+    return true;
+  default:
+    return false;
+  }
+}
+
 wgpu::RenderPipeline create_pipeline([[maybe_unused]] const PipelineConfig& config);
+wgpu::RenderPipeline create_uber_pipeline(const PipelineConfig& config);
+// Uber shader pipeline sharing config's fixed-function state. The shader config is cleared, so every shader that
+// differs only in TEV/texgen/vertex setup maps to the same pipeline.
+gfx::PipelineRef uber_pipeline_ref(const PipelineConfig& config) noexcept;
 void render(const DrawData& data, const wgpu::RenderPassEncoder& pass);
 
 void queue_surface(const u8* dlStart, uint32_t dlSize, bool bigEndian) noexcept;
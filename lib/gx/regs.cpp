@@ -993,7 +993,7 @@ bool copy_xf_data(u32 addr, const u8* data, u32 len, std::endian e) noexcept {
       changed |= store_xf_f32(flat[i], read_bits<u32>(data + i * 4, e));
     }
     if (changed) {
-      g_gxState.dirty |= DirtyUniform;
+      g_gxState.dirty |= DirtyPnMtx;
     }
     return true;
   }
@@ -1032,7 +1032,7 @@ bool copy_xf_data(u32 addr, const u8* data, u32 len, std::endian e) noexcept {
       changed |= store_xf_f32(flat[row * 4 + col], read_bits<u32>(data + i * 4, e));
     }
     if (changed) {
-      g_gxState.dirty |= DirtyUniform;
+      g_gxState.dirty |= DirtyPnMtx;
     }
     return true;
   }
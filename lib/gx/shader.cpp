@@ -6,6 +6,7 @@
 #include "gx.hpp"
 #include "gx_fmt.hpp"
 #include "shader_info.hpp"
+#include "uber_config.hpp"
 
 #include <dolphin/gx/GXEnum.h>
 
@@ -622,6 +623,9 @@ auto fetch_fixed16_attr(std::string_view fetchFn, const AttrConfig& mapping, std
 }
 
 auto fetch_attr(const AttrConfig& mapping, std::string_view buf, std::string_view offs, bool le) -> std::string {
+  if (mapping.predecoded) {
+    return fmt::format("load_f32_{}(&{}, {})", mapping.cnt, buf, offs);
+  }
   switch (mapping.compType) {
   case GX_U8:
     return fmt::format("fetch_u8_{}(&{}, {}, {}, {})", mapping.cnt, buf, offs, mapping.frac, le);
@@ -641,6 +645,9 @@ auto fetch_attr(const AttrConfig& mapping, std::string_view buf, std::string_vie
 }
 
 auto fetch_color_attr(const AttrConfig& mapping, std::string_view buf, std::string_view offs, bool le) -> std::string {
+  if (mapping.predecoded) {
+    return fmt::format("load_f32_4(&{}, {})", buf, offs);
+  }
   switch (mapping.compType) {
   case GX_RGB565:
     return fmt::format("fetch_rgb565(&{}, {}, {})", buf, offs, le);
@@ -867,873 +874,142 @@ auto lighting_func(const ShaderConfig& config, const ColorChannelConfig& cc, u8
                      alpha ? "a"sv : ""sv);
 }
 
-absl::flat_hash_set<gfx::ShaderRef> s_seenShaders;
-} // namespace
-
-std::string build_shader_source(const ShaderConfig& config) noexcept {
-  ZoneScoped;
-  const auto hash = xxh3_hash(config);
-  const auto info = build_shader_info(config);
-  if (EnableDebugPrints && !s_seenShaders.contains(hash)) {
-    s_seenShaders.insert(hash);
-
-    Log.info("Shader config (hash {:x}):", hash);
-    {
-      for (int i = 0; i < config.tevStageCount; ++i) {
-        const auto& stage = config.tevStages[i];
-        Log.info("  tevStages[{}]:", i);
-        Log.info("    color_a: {}", TevColorArgNames[stage.colorPass.a]);
-        Log.info("    color_b: {}", TevColorArgNames[stage.colorPass.b]);
-        Log.info("    color_c: {}", TevColorArgNames[stage.colorPass.c]);
-        Log.info("    color_d: {}", TevColorArgNames[stage.colorPass.d]);
-        Log.info("    alpha_a: {}", TevAlphaArgNames[stage.alphaPass.a]);
-        Log.info("    alpha_b: {}", TevAlphaArgNames[stage.alphaPass.b]);
-        Log.info("    alpha_c: {}", TevAlphaArgNames[stage.alphaPass.c]);
-        Log.info("    alpha_d: {}", TevAlphaArgNames[stage.alphaPass.d]);
-        Log.info("    color_op_clamp: {}", stage.colorOp.clamp);
-        Log.info("    color_op_op: {}", stage.colorOp.op);
-        Log.info("    color_op_bias: {}", stage.colorOp.bias);
-        Log.info("    color_op_scale: {}", stage.colorOp.scale);
-        Log.info("    color_op_reg_id: {}", stage.colorOp.outReg);
-        Log.info("    alpha_op_clamp: {}", stage.alphaOp.clamp);
-        Log.info("    alpha_op_op: {}", stage.alphaOp.op);
-        Log.info("    alpha_op_bias: {}", stage.alphaOp.bias);
-        Log.info("    alpha_op_scale: {}", stage.alphaOp.scale);
-        Log.info("    alpha_op_reg_id: {}", stage.alphaOp.outReg);
-        Log.info("    kc_sel: {}", stage.kcSel);
-        Log.info("    ka_sel: {}", stage.kaSel);
-        Log.info("    texCoordId: {}", stage.texCoordId);
-        Log.info("    texMapId: {}", stage.texMapId);
-        Log.info("    channelId: {}", stage.channelId);
-        Log.info("    tevSwapRas: {}", stage.tevSwapRas);
-        Log.info("    tevSwapTex: {}", stage.tevSwapTex);
-        Log.info("    indTexStage: {}", stage.indTexStage);
-        Log.info("    indTexFormat: {}", stage.indTexFormat);
-        Log.info("    indTexBiasSel: {}", stage.indTexBiasSel);
-        Log.info("    indTexAlphaSel: {}", stage.indTexAlphaSel);
-        Log.info("    indTexMtxId: {}", stage.indTexMtxId);
-        Log.info("    indTexWrapS: {}", stage.indTexWrapS);
-        Log.info("    indTexWrapT: {}", stage.indTexWrapT);
-        Log.info("    indTexUseOrigLOD: {}", stage.indTexUseOrigLOD);
-        Log.info("    indTexAddPrev: {}", stage.indTexAddPrev);
-      }
-      Log.info("  numIndStages: {}", config.numIndStages);
-      for (u32 i = 0; i < config.numIndStages; ++i) {
-        const auto& stage = config.indStages[i];
-        Log.info("  indStages[{}]: texCoordId {} texMapId {} scaleS {} scaleT {}", i, stage.texCoordId, stage.texMapId,
-                 stage.scaleS, stage.scaleT);
-      }
-      for (int i = 0; i < config.colorChannels.size(); ++i) {
-        const auto& chan = config.colorChannels[i];
-        Log.info("  colorChannels[{}]: enabled {} mat {} amb {}", static_cast<GXChannelID>(i), chan.lightingEnabled,
-                 chan.matSrc, chan.ambSrc);
-      }
-      for (int i = 0; i < config.tcgs.size(); ++i) {
-        const auto& tcg = config.tcgs[i];
-        if (tcg.src != GX_MAX_TEXGENSRC) {
-          Log.info("  tcg[{}]: src {} mtx {} post {} type {} norm {}", i, tcg.src, tcg.mtx, tcg.postMtx, tcg.type,
-                   tcg.normalize);
-        }
-      }
-      Log.info("  alphaCompare: comp0 {} ref0 {} op {} comp1 {} ref1 {}", config.alphaCompare.comp0,
-               config.alphaCompare.ref0, config.alphaCompare.op, config.alphaCompare.comp1, config.alphaCompare.ref1);
-      Log.info("  fogType: {}", config.fogType);
-      Log.info("  fogRangeEnabled: {}", config.fogRangeEnabled);
-    }
+// Vertex pulling and TEV helpers shared by the specialized and uber shaders.
+constexpr std::string_view ShaderPrelude = R"""(
+fn bswap32(v: u32, le: bool) -> u32 {
+  if (le) {
+    return v;
   }
+  return ((v & 0x000000FFu) << 24u) |
+         ((v & 0x0000FF00u) << 8u) |
+         ((v & 0x00FF0000u) >> 8u) |
+         ((v & 0xFF000000u) >> 24u);
+}
 
-  std::string uniformPre;
-  std::string uniBufAttrs;
-  std::string texBindings;
-  std::string vtxOutAttrs;
-  std::string vtxInAttrs;
-  std::string vtxXfrAttrsPre;
-  std::string vtxXfrAttrs;
-  size_t vtxOutIdx = 0;
+fn bswap16(v: u32, le: bool) -> u32 {
+  return select(((v & 0xFFu) << 8u) | (v >> 8u), v, le);
+}
 
-  // Load points for line/point expansion
-  std::string_view vidxAttr = "vidx"sv;
-  if (config.lineMode != 0) {
-    vtxInAttrs += ",\n    @builtin(instance_index) iidx: u32";
-    uniBufAttrs +=
-        "\n    line_width: f32,"
-        "\n    line_aspect_y: f32,"
-        "\n    line_tex_offset: f32,"
-        "\n    line_texcoord_mask: u32,";
-    if (config.lineMode == 3) {
-      // GX_POINTS: each instance = one vertex, expand to quad
-      vtxXfrAttrsPre += fmt::format(
-          "\n    let in_vidx = iidx;"
-          "\n    let in_pos = {};"
-          "\n    let in_pnmtxidx = {};"
-          "\n    let mv_pos = vec4f(in_pos, 1.0) * ubuf.postex_mtx[in_pnmtxidx];",
-          attr_load(config, GX_VA_POS, "in_vidx"sv), attr_load(config, GX_VA_PNMTXIDX, "in_vidx"sv));
-    } else {
-      // GX_LINES / GX_LINESTRIP: each instance = two vertices, expand to quad
-      vtxXfrAttrsPre += fmt::format(
-          "\n    let use_b = vidx >= 2u;"
-          "\n    let vidx_a = iidx * {}u;"
-          "\n    let vidx_b = vidx_a + 1u;"
-          "\n    let in_vidx = select(vidx_a, vidx_b, use_b);"
-          "\n    let pos_a = {};"
-          "\n    let pos_b = {};"
-          "\n    let in_pos = select(pos_a, pos_b, use_b);"
-          "\n    let pnmtxidx_a = {};"
-          "\n    let pnmtxidx_b = {};"
-          "\n    let in_pnmtxidx = select(pnmtxidx_a, pnmtxidx_b, use_b);"
-          "\n    let mv_pos_a = vec4f(pos_a, 1.0) * ubuf.postex_mtx[pnmtxidx_a];"
-          "\n    let mv_pos_b = vec4f(pos_b, 1.0) * ubuf.postex_mtx[pnmtxidx_b];"
-          "\n    let mv_pos = select(mv_pos_a, mv_pos_b, use_b);",
-          config.lineMode == 1 ? 2 : 1, attr_load(config, GX_VA_POS, "vidx_a"sv),
-          attr_load(config, GX_VA_POS, "vidx_b"sv), attr_load(config, GX_VA_PNMTXIDX, "vidx_a"sv),
-          attr_load(config, GX_VA_PNMTXIDX, "vidx_b"sv));
-    }
-    vidxAttr = "in_vidx"sv;
-  } else if (config.attrs[GX_VA_PNMTXIDX].attrType == GX_NONE) {
-    vtxXfrAttrsPre += "\n    let in_pnmtxidx = imm.current_pnmtx;";
+fn load_word(p: ptr<storage, array<u32>>, word_idx: u32) -> u32 {
+  // This guard is not expected to handle routine out-of-bounds accesses.
+  // It appears to discourage some Adreno drivers/optimizers from storage buffer
+  // optimizations that can cause visual artifacts, including vertex explosions
+  // in Dusklight.
+  if (word_idx < arrayLength(p)) {
+    return p[word_idx];
   }
+  return 0u;
+}
 
-  // Load vertex attributes
-  for (GXAttr attr = GX_VA_PNMTXIDX; attr <= GX_VA_TEX7; attr = static_cast<GXAttr>(attr + 1)) {
-    const auto attrType = config.attrs[attr].attrType;
-    if (attrType == GX_NONE) {
-      continue;
-    }
-    // in_pnmtxidx and in_pos written above for line mode
-    if ((attr != GX_VA_PNMTXIDX && attr != GX_VA_POS) || config.lineMode == 0) {
-      vtxXfrAttrsPre += fmt::format("\n    let {} = {};", vtx_attr(config, attr), attr_load(config, attr, vidxAttr));
-    }
-  }
-  bool needsBinrm = false;
-  bool needsTangent = false;
-  for (int i = 0; i < info.sampledTexCoords.size(); ++i) {
-    if (!info.sampledTexCoords.test(i)) {
-      continue;
-    }
-    const bool emboss = is_emboss_texgen(config.tcgs[i].type);
-    needsBinrm = needsBinrm || config.tcgs[i].src == GX_TG_BINRM || emboss;
-    needsTangent = needsTangent || config.tcgs[i].src == GX_TG_TANGENT || emboss;
-  }
-  if (needsBinrm) {
-    vtxXfrAttrsPre += fmt::format("\n    let {} = {};", nbt_slice_local(NbtSlice::B),
-                                  attr_load_nbt_slice(config, NbtSlice::B, vidxAttr));
+fn load_mtx3x4(p: ptr<storage, array<u32>>, word_idx: u32) -> mat3x4f {
+  var rows: array<vec4f, 3>;
+  for (var r = 0u; r < 3u; r++) {
+    let w = word_idx + r * 4u;
+    rows[r] = bitcast<vec4f>(vec4u(load_word(p, w), load_word(p, w + 1u), load_word(p, w + 2u), load_word(p, w + 3u)));
   }
-  if (needsTangent) {
-    vtxXfrAttrsPre += fmt::format("\n    let {} = {};", nbt_slice_local(NbtSlice::T),
-                                  attr_load_nbt_slice(config, NbtSlice::T, vidxAttr));
+  return mat3x4f(rows[0], rows[1], rows[2]);
+}
+
+// Aligned little-endian f32 loads for arrays pre-decoded on the CPU
+fn load_f32_1(p: ptr<storage, array<u32>>, byte_off: u32) -> f32 {
+  return bitcast<f32>(load_word(p, byte_off >> 2u));
+}
+
+fn load_f32_2(p: ptr<storage, array<u32>>, byte_off: u32) -> vec2f {
+  let w = byte_off >> 2u;
+  return bitcast<vec2f>(vec2u(load_word(p, w), load_word(p, w + 1u)));
+}
+
+fn load_f32_3(p: ptr<storage, array<u32>>, byte_off: u32) -> vec3f {
+  let w = byte_off >> 2u;
+  return bitcast<vec3f>(vec3u(load_word(p, w), load_word(p, w + 1u), load_word(p, w + 2u)));
+}
+
+fn load_f32_4(p: ptr<storage, array<u32>>, byte_off: u32) -> vec4f {
+  let w = byte_off >> 2u;
+  return bitcast<vec4f>(vec4u(load_word(p, w), load_word(p, w + 1u), load_word(p, w + 2u), load_word(p, w + 3u)));
+}
+
+fn load_u8(p: ptr<storage, array<u32>>, byte_off: u32) -> u32 {
+  let word = load_word(p, byte_off / 4u);
+  let shift = (byte_off & 3u) * 8u;
+  return (word >> shift) & 0xFFu;
+}
+
+fn load_u32_raw(p: ptr<storage, array<u32>>, byte_off: u32) -> u32 {
+  let word_idx = byte_off >> 2u;
+  let sub = byte_off & 3u;
+  let lo = load_word(p, word_idx);
+  if (sub == 0u) {
+    return lo;
   }
+  let hi = load_word(p, word_idx + 1u);
+  let shift = sub * 8u;
+  return (lo >> shift) | (hi << (32u - shift));
+}
 
-  if (config.lineMode == 0) {
-    vtxXfrAttrsPre += fmt::format(
-        "\n    let mv_pos = vec4f({}, 1.0) * ubuf.postex_mtx[in_pnmtxidx];"
-        "\n    out.pos = vec4f(mv_pos, 1.0) * ubuf.proj;",
-        vtx_attr(config, GX_VA_POS));
-  } else if (config.lineMode == 3) {
-    // GX_POINTS: expand single vertex to axis-aligned screen-space square
-    vtxXfrAttrsPre +=
-        "\n    let clip = vec4f(mv_pos, 1.0) * ubuf.proj;"
-        "\n    let viewport_scale = ubuf.render_viewport_size / max(ubuf.logical_viewport_size, vec2f(1.0));"
-        "\n    let point_size = ubuf.line_width * min(viewport_scale.x, viewport_scale.y);"
-        "\n    let x_sign = select(-1.0, 1.0, (vidx & 1u) != 0u);"
-        "\n    let y_sign = select(-1.0, 1.0, vidx >= 2u);"
-        "\n    let offset_px = vec2f(x_sign, y_sign) * (point_size / 2.0);"
-        "\n    let offset_ndc = (offset_px * 2.0) / ubuf.render_viewport_size;"
-        "\n    out.pos = vec4f(clip.xy + offset_ndc * clip.w, clip.zw);";
-  } else {
-    // GX_LINES / GX_LINESTRIP: expand line segment perpendicular to direction
-    vtxXfrAttrsPre +=
-        "\n    let clip_a = vec4f(mv_pos_a, 1.0) * ubuf.proj;"
-        "\n    let clip_b = vec4f(mv_pos_b, 1.0) * ubuf.proj;"
-        "\n    let ndc_a = clip_a.xy / clip_a.w;"
-        "\n    let ndc_b = clip_b.xy / clip_b.w;"
-        "\n    let viewport_scale = ubuf.render_viewport_size / max(ubuf.logical_viewport_size, vec2f(1.0));"
-        "\n    let delta_px = (ndc_b - ndc_a) / 2.0 * ubuf.render_viewport_size;"
-        "\n    let dir_px = select(vec2f(1.0, 0.0), normalize(delta_px), dot(delta_px, delta_px) > 1e-10);"
-        "\n    let perp_px = vec2f(-dir_px.y, dir_px.x);"
-        "\n    let line_width = ubuf.line_width * min(viewport_scale.x, viewport_scale.y);"
-        "\n    let offset_px = perp_px * (line_width / 2.0) * select(-1.0, 1.0, (vidx & 1u) != 0u);"
-        "\n    let offset_ndc = (offset_px * 2.0) / ubuf.render_viewport_size;"
-        "\n    let clip_base = select(clip_a, clip_b, use_b);"
-        "\n    out.pos = vec4f(clip_base.xy + offset_ndc * clip_base.w, clip_base.zw);";
+fn load_u16(p: ptr<storage, array<u32>>, byte_off: u32, le: bool) -> u32 {
+  let word_idx = byte_off >> 2u;
+  let sub = byte_off & 3u;
+  let word = load_word(p, word_idx);
+  if (sub <= 2u) {
+    return bswap16(extractBits(word, sub * 8u, 16u), le);
   }
-  vtxXfrAttrsPre += fmt::format(
-      "\n    let nrm_tmp = vec4f({}, 0.0) * ubuf.nrm_mtx[in_pnmtxidx];"
-      "\n    let mv_nrm = select(nrm_tmp, normalize(nrm_tmp), dot(nrm_tmp, nrm_tmp) > 1e-10);",
-      vtx_attr(config, GX_VA_NRM));
-  if constexpr (EnableNormalVisualization) {
-    vtxOutAttrs += fmt::format("\n    @location({}) nrm: vec3f,", vtxOutIdx++);
-    vtxXfrAttrsPre += "\n    out.nrm = mv_nrm;";
+  let next = load_word(p, word_idx + 1u);
+  let raw = extractBits(word, 24u, 8u) | (extractBits(next, 0u, 8u) << 8u);
+  return bswap16(raw, le);
+}
+
+fn load_u24(p: ptr<storage, array<u32>>, byte_off: u32, le: bool) -> u32 {
+  let raw = load_u32_raw(p, byte_off) & 0x00FFFFFFu;
+  if (le) {
+    return raw;
   }
+  return ((raw & 0x0000FFu) << 16u) |
+         (raw & 0x00FF00u) |
+         ((raw & 0xFF0000u) >> 16u);
+}
 
-  uniBufAttrs += "\n    proj: mat4x4f,";
-  uniBufAttrs += fmt::format("\n    postex_mtx: array<mat3x4f, {}>,", MaxPnMtx + MaxTexMtx);
-  uniBufAttrs += fmt::format("\n    nrm_mtx: array<mat3x4f, {}>,", MaxPnMtx);
-  std::string fragmentFnPre;
-  std::string fragmentFn;
+fn load_u32(p: ptr<storage, array<u32>>, byte_off: u32, le: bool) -> u32 {
+  return bswap32(load_u32_raw(p, byte_off), le);
+}
 
-  static std::array regName{"prev"sv, "tevreg0"sv, "tevreg1"sv, "tevreg2"sv};
-  std::array<bool, MaxTevRegs> colorNormalized{};
-  std::array<bool, MaxTevRegs> alphaNormalized{};
-  for (u32 idx = 0; idx < config.tevStageCount; ++idx) {
-    const auto& stage = config.tevStages[idx];
-    {
-      const auto color_arg = [&](GXTevColorArg arg) {
-        auto value = color_arg_reg(arg, idx, config, stage);
-        if (tev_color_arg_is_normalized(arg, colorNormalized, alphaNormalized)) {
-          return fmt::format("vec3f({})", value);
-        }
-        return fmt::format("tev_overflow_vec3f({})", value);
-      };
-      std::string_view outReg = regName[stage.colorOp.outReg];
-      std::string op = tev_color_op(stage.colorOp.op, tev_bias(stage.colorOp.bias), tev_scale(stage.colorOp.scale),
-                                    stage.colorOp.clamp, color_arg(stage.colorPass.a), color_arg(stage.colorPass.b),
-                                    color_arg(stage.colorPass.c), color_arg_reg(stage.colorPass.d, idx, config, stage));
-      fragmentFn += fmt::format("\n    // TEV stage {2}\n    {0} = vec4f({1}, {0}.a);", outReg, op, idx);
-      colorNormalized[stage.colorOp.outReg] = stage.colorOp.clamp;
-    }
-    {
-      const auto alpha_arg = [&](GXTevAlphaArg arg) {
-        auto value = alpha_arg_reg(arg, idx, config, stage);
-        if (tev_alpha_arg_is_normalized(arg, alphaNormalized)) {
-          return value;
-        }
-        return fmt::format("tev_overflow_f32({})", value);
-      };
-      std::string_view outReg = regName[stage.alphaOp.outReg];
-      std::string op = tev_alpha_op(stage.alphaOp.op, tev_bias(stage.alphaOp.bias), tev_scale(stage.alphaOp.scale),
-                                    stage.alphaOp.clamp, alpha_arg(stage.alphaPass.a), alpha_arg(stage.alphaPass.b),
-                                    alpha_arg(stage.alphaPass.c), alpha_arg_reg(stage.alphaPass.d, idx, config, stage));
-      fragmentFn += fmt::format("\n    {0}.a = {1};", outReg, op);
-      alphaNormalized[stage.alphaOp.outReg] = stage.alphaOp.clamp;
-    }
-  }
-
-  const auto& lastStage = config.tevStages[config.tevStageCount - 1];
-  const bool prevColorNormalized = colorNormalized[lastStage.colorOp.outReg];
-  const bool prevAlphaNormalized = alphaNormalized[lastStage.alphaOp.outReg];
-  if (lastStage.colorOp.outReg != 0) {
-    fragmentFn += fmt::format("\n    prev = vec4f({0}.rgb, prev.a);", regName[lastStage.colorOp.outReg]);
-  }
-  if (lastStage.alphaOp.outReg != 0) {
-    fragmentFn += fmt::format("\n    prev.a = {0}.a;", regName[lastStage.alphaOp.outReg]);
-  }
-
-  if (info.loadsTevReg.test(0)) {
-    uniBufAttrs += "\n    tevprev: vec4f,";
-    fragmentFnPre += "\n    var prev = ubuf.tevprev;";
-  } else {
-    fragmentFnPre += "\n    var prev: vec4f;";
-  }
-  for (int i = 1 /* Skip TEVPREV */; i < info.loadsTevReg.size(); ++i) {
-    if (info.loadsTevReg.test(i)) {
-      uniBufAttrs += fmt::format("\n    tevreg{}: vec4f,", i - 1);
-      fragmentFnPre += fmt::format("\n    var tevreg{0} = ubuf.tevreg{0};", i - 1);
-    } else if (info.writesTevReg.test(i)) {
-      fragmentFnPre += fmt::format("\n    var tevreg{0}: vec4f;", i - 1);
-    }
-  }
-
-  if (info.lightingEnabled) {
-    uniBufAttrs += fmt::format(FMT_STRING(R"""(
-    lights: array<Light, {}>,
-    lightState0: u32,
-    lightState1: u32,
-    lightState0a: u32,
-    lightState1a: u32,)"""),
-                               GX::MaxLights);
-    uniformPre +=
-        "\n"
-        "struct Light {\n"
-        "    pos: vec3f,\n"
-        "    dir: vec3f,\n"
-        "    color: vec4f,\n"
-        "    cos_att: vec3f,\n"
-        "    dist_att: vec3f,\n"
-        "};";
-    if (UsePerPixelLighting) {
-      vtxOutAttrs += fmt::format("\n    @location({}) mv_pos: vec3f,", vtxOutIdx++);
-      vtxOutAttrs += fmt::format("\n    @location({}) mv_nrm: vec3f,", vtxOutIdx++);
-      vtxXfrAttrs += fmt::format(FMT_STRING(R"""(
-    out.mv_pos = mv_pos;
-    out.mv_nrm = mv_nrm;)"""));
-    }
-  }
-
-  for (int i = 0; i < info.sampledColorChannels.size(); ++i) {
-    if (!info.sampledColorChannels.test(i)) {
-      continue;
-    }
-
-    const auto& cc = config.colorChannels[i];
-    const auto& cca = config.colorChannels[i + GX_ALPHA0];
-    if (cc.lightingEnabled && cc.ambSrc == GX_SRC_REG) {
-      uniBufAttrs += fmt::format("\n    cc{0}_amb: vec4f,", i);
-    }
-    if (cc.matSrc == GX_SRC_REG) {
-      uniBufAttrs += fmt::format("\n    cc{0}_mat: vec4f,", i);
-    }
-    if (cca.lightingEnabled && cca.ambSrc == GX_SRC_REG) {
-      uniBufAttrs += fmt::format("\n    cc{0}a_amb: vec4f,", i);
-    }
-    if (cca.matSrc == GX_SRC_REG) {
-      uniBufAttrs += fmt::format("\n    cc{0}a_mat: vec4f,", i);
-    }
-
-    // Output vertex color if necessary
-    if (UsePerPixelLighting) {
-      if ((cc.lightingEnabled && cc.ambSrc == GX_SRC_VTX) || cc.matSrc == GX_SRC_VTX ||
-          (cca.lightingEnabled && cca.ambSrc == GX_SRC_VTX) || cca.matSrc == GX_SRC_VTX) {
-        vtxOutAttrs += fmt::format("\n    @location({}) clr{}: vec4f,", vtxOutIdx++, i);
-        vtxXfrAttrs += fmt::format("\n    out.clr{} = {};", i, vtx_attr(config, static_cast<GXAttr>(GX_VA_CLR0 + i)));
-      }
-    }
-
-    if (UsePerPixelLighting) {
-      fragmentFnPre += fmt::format("\n    var rast{}: vec4f;", i);
-      fragmentFnPre += lighting_func(config, cc, i, false);
-      fragmentFnPre += lighting_func(config, cca, i, true);
-    } else {
-      vtxOutAttrs += fmt::format("\n    @location({}) cc{}: vec4f,", vtxOutIdx++, i);
-      vtxXfrAttrs += lighting_func(config, cc, i, false);
-      vtxXfrAttrs += lighting_func(config, cca, i, true);
-      fragmentFnPre += fmt::format("\n    var rast{0} = in.cc{0};", i);
-    }
-  }
-  for (int i = 0; i < info.sampledKColors.size(); ++i) {
-    if (info.sampledKColors.test(i)) {
-      uniBufAttrs += fmt::format("\n    kcolor{}: vec4f,", i);
-    }
-  }
-  for (int i = 0; i < info.sampledTexCoords.size(); ++i) {
-    if (!info.sampledTexCoords.test(i)) {
-      continue;
-    }
-    const auto& tcg = config.tcgs[i];
-    if (tcg.type == GX_TG_MTX3x4) {
-      vtxOutAttrs += fmt::format("\n    @location({}) tex{}_uvw: vec3f,", vtxOutIdx++, i);
-    } else {
-      vtxOutAttrs += fmt::format("\n    @location({}) tex{}_uv: vec2f,", vtxOutIdx++, i);
-    }
-    if (is_emboss_texgen(tcg.type)) {
-      // Emboss bump: offset the source texcoord by the light projected onto tangent/binormal
-      const u32 lightIdx = tcg.type - GX_TG_BUMP0;
-      vtxXfrAttrs += fmt::format(
-          "\n    let bump_ldir{0} = normalize(ubuf.lights[{1}].pos - mv_pos);"
-          "\n    let bump_tan{0} = vec4f(in_tangent, 0.0) * ubuf.nrm_mtx[in_pnmtxidx];"
-          "\n    let bump_bin{0} = vec4f(in_binrm, 0.0) * ubuf.nrm_mtx[in_pnmtxidx];"
-          "\n    out.tex{0}_uv = tc{2}_proj.xy + vec2f(dot(bump_ldir{0}, bump_tan{0}), dot(bump_ldir{0}, "
-          "bump_bin{0}));",
-          i, lightIdx, tcg.embossSrc);
-      fragmentFnPre += fmt::format("\n    var tex{0}_uv = in.tex{0}_uv.xy;", i);
-      continue;
-    }
-    if (tcg.src >= GX_TG_TEX0 && tcg.src <= GX_TG_TEX7) {
-      vtxXfrAttrs += fmt::format("\n    var tc{} = vec4f({}, 1.0, 1.0);", i,
-                                 vtx_attr(config, GXAttr(GX_VA_TEX0 + (tcg.src - GX_TG_TEX0))));
-    } else if (tcg.src == GX_TG_POS) {
-      vtxXfrAttrs += fmt::format("\n    var tc{} = vec4f({}, 1.0);", i, vtx_attr(config, GX_VA_POS));
-    } else if (tcg.src == GX_TG_NRM) {
-      vtxXfrAttrs += fmt::format("\n    var tc{} = vec4f({}, 1.0);", i, vtx_attr(config, GX_VA_NRM));
-    } else if (tcg.src == GX_TG_COLOR0) {
-      vtxXfrAttrs += fmt::format("\n    var tc{} = {};", i, vtx_attr(config, GX_VA_CLR0));
-    } else if (tcg.src == GX_TG_COLOR1) {
-      vtxXfrAttrs += fmt::format("\n    var tc{} = {};", i, vtx_attr(config, GX_VA_CLR1));
-    } else if (tcg.src == GX_TG_BINRM) {
-      vtxXfrAttrs += fmt::format("\n    var tc{} = vec4f({}, 1.0);", i, nbt_slice_local(NbtSlice::B));
-    } else if (tcg.src == GX_TG_TANGENT) {
-      vtxXfrAttrs += fmt::format("\n    var tc{} = vec4f({}, 1.0);", i, nbt_slice_local(NbtSlice::T));
-    } else
-      UNLIKELY FATAL("unhandled tcg src {}", underlying(tcg.src));
-    if (tcg.type == GX_TG_MTX2x4 || tcg.type == GX_TG_MTX3x4) {
-      if (info.indexAttr.test(GX_VA_TEX0MTXIDX + i)) {
-        vtxXfrAttrs += fmt::format("\n    var tc{0}_tmp = tc{0} * ubuf.postex_mtx[in_texmtxidx{0} / 3u];", i);
-      } else if (tcg.mtx == GX_IDENTITY) {
-        vtxXfrAttrs += fmt::format("\n    var tc{0}_tmp = tc{0}.xyz;", i);
-      } else {
-        u32 texMtxIdx = (tcg.mtx) / 3;
-        vtxXfrAttrs += fmt::format("\n    var tc{0}_tmp = tc{0} * ubuf.postex_mtx[{1}];", i, texMtxIdx);
-      }
-      if (tcg.type == GX_TG_MTX2x4) {
-        vtxXfrAttrs += fmt::format("\n    tc{0}_tmp.z = 1.0f;", i);
-      }
-    } else if (tcg.type == GX_TG_SRTG) {
-      vtxXfrAttrs += fmt::format("\n    var tc{0}_tmp = vec3f(tc{0}.xy, 1.0f);", i);
-    }
-    if (tcg.normalize) {
-      vtxXfrAttrs += fmt::format("\n    tc{0}_tmp = normalize(tc{0}_tmp);", i);
-    }
-    if (tcg.postMtx == GX_PTIDENTITY) {
-      vtxXfrAttrs += fmt::format("\n    var tc{0}_proj = tc{0}_tmp;", i);
-    } else {
-      u32 postMtxIdx = (tcg.postMtx - GX_PTTEXMTX0) / 3;
-      vtxXfrAttrs +=
-          fmt::format("\n    var tc{0}_proj = vec4f(tc{0}_tmp.xyz, 1.0) * ubuf.postmtx[{1}];", i, postMtxIdx);
-    }
-    // Apply line/point tex offset
-    if (config.lineMode == 3) {
-      // GX_POINTS: offset S for right columns, T for bottom rows
-      vtxXfrAttrs += fmt::format(
-          "\n    if ((ubuf.line_texcoord_mask & (1u << {0})) != 0u) {{"
-          "\n        if ((vidx & 1u) != 0u) {{ tc{0}_proj.x += ubuf.line_tex_offset; }}"
-          "\n        if (vidx >= 2u) {{ tc{0}_proj.y += ubuf.line_tex_offset; }}"
-          "\n    }}",
-          i);
-    } else if (config.lineMode != 0) {
-      // GX_LINES / GX_LINESTRIP: offset one axis for perpendicular side
-      vtxXfrAttrs += fmt::format(
-          "\n    if ((ubuf.line_texcoord_mask & (1u << {0})) != 0u && (vidx & 1u) != 0u) {{"
-          "\n        tc{0}_proj.y += ubuf.line_tex_offset;"
-          "\n    }}",
-          i);
-    }
-    if (tcg.type == GX_TG_MTX3x4) {
-      vtxXfrAttrs += fmt::format("\n    out.tex{0}_uvw = tc{0}_proj.xyz;", i);
-      fragmentFnPre += fmt::format("\n    var tex{0}_uv = in.tex{0}_uvw.xy / in.tex{0}_uvw.z;", i);
-    } else {
-      vtxXfrAttrs += fmt::format("\n    out.tex{0}_uv = tc{0}_proj.xy;", i);
-      fragmentFnPre += fmt::format("\n    var tex{0}_uv = in.tex{0}_uv.xy;", i);
-    }
-  }
-  // Multiple TEV stages may reference the same indirect stage,
-  // so we sample each indirect texture only once.
-  const auto ind_scale = [](const GXIndTexScale s) -> std::string_view {
-    switch (s) {
-    case GX_ITS_1:
-      return "1.0"sv;
-    case GX_ITS_2:
-      return "(1.0 / 2.0)"sv;
-    case GX_ITS_4:
-      return "(1.0 / 4.0)"sv;
-    case GX_ITS_8:
-      return "(1.0 / 8.0)"sv;
-    case GX_ITS_16:
-      return "(1.0 / 16.0)"sv;
-    case GX_ITS_32:
-      return "(1.0 / 32.0)"sv;
-    case GX_ITS_64:
-      return "(1.0 / 64.0)"sv;
-    case GX_ITS_128:
-      return "(1.0 / 128.0)"sv;
-    case GX_ITS_256:
-      return "(1.0 / 256.0)"sv;
-    default:
-      FATAL("unhandled indirect scale {}", underlying(s));
-    }
-  };
-  for (int i = 0; i < info.usedIndStages.size(); ++i) {
-    if (!info.usedIndStages.test(i)) {
-      continue;
-    }
-    const auto& indStage = config.indStages[i];
-    const u32 texCoordId = underlying(indStage.texCoordId);
-    const u32 texMapId = underlying(indStage.texMapId);
-    // GX applies the SU texture-coordinate scale before the indirect stage scale.
-    // The shader carries normalized UVs, so convert that texel-space result back
-    // into normalized coordinates for the indirect texture sample.
-    const auto scaleExpr =
-        fmt::format("tex{0}_uv * ubuf.texcoord_scale[{0}].xy * vec2f({1}, {2}) / ubuf.tex{3}_size_bias.xy", texCoordId,
-                    ind_scale(indStage.scaleS), ind_scale(indStage.scaleT), texMapId);
-    fragmentFnPre += fmt::format(
-        "\n    // Indirect stage {0}"
-        "\n    var t_IndTexCoord{0} = 255.0 * textureSampleBias(tex{1}, tex{1}_samp, {2}, "
-        "ubuf.tex{1}_size_bias.z).abg;",
-        i, texMapId, scaleExpr);
-  }
-  if (info.usedIndStages.any()) {
-    fragmentFnPre += "\n    var t_TexCoord = vec2f(0.0);";
-  }
-  for (int i = 0; i < config.tevStageCount; ++i) {
-    const auto& stage = config.tevStages[i];
-    const bool needsIndirectCoord = stage.indTexMtxId != GX_ITM_OFF;
-    const bool hasIndirectStage = stage.indTexStage < config.numIndStages;
-    const bool needsTevTexCoord =
-        needsIndirectCoord || stage.indTexWrapS != GX_ITW_OFF || stage.indTexWrapT != GX_ITW_OFF || stage.indTexAddPrev;
-    const bool needsTextureSample = uses_texture_sample(stage);
-    if (!needsTevTexCoord && !needsTextureSample) {
-      continue;
-    }
-    const bool hasBaseTexCoord = stage.texCoordId != GX_TEXCOORD_NULL;
-    const bool hasBaseTexture = stage.texMapId != GX_TEXMAP_NULL;
-    const bool hasBaseCoord = hasBaseTexCoord && hasBaseTexture;
-    std::string uvIn;
-    if (needsTevTexCoord) {
-      fragmentFnPre += fmt::format("\n    // TEV stage {} indirect", i);
-
-      // Apply indirect texture matrix (produces a texel-space offset)
-      std::string indirectOffsetTexel;
-      if (needsIndirectCoord && hasIndirectStage) {
-        std::string_view fmtShift;
-        switch (stage.indTexFormat) {
-        case GX_ITF_8:
-          break;
-        case GX_ITF_5:
-          fmtShift = " / 8.0"sv;
-          break;
-        case GX_ITF_4:
-          fmtShift = " / 16.0"sv;
-          break;
-        case GX_ITF_3:
-          fmtShift = " / 32.0"sv;
-          break;
-        default:
-          FATAL("unhandled indirect format {}", underlying(stage.indTexFormat));
-        }
-        if (fmtShift.empty()) {
-          fragmentFnPre += fmt::format("\n    var ind{0}_coord = t_IndTexCoord{1};", i, underlying(stage.indTexStage));
-        } else {
-          fragmentFnPre += fmt::format("\n    var ind{0}_coord = floor(t_IndTexCoord{1}{2});", i,
-                                       underlying(stage.indTexStage), fmtShift);
-        }
-
-        if (stage.indTexBiasSel != GX_ITB_NONE) {
-          auto bias = stage.indTexFormat == GX_ITF_8 ? "-128.0"sv : "1.0"sv;
-          auto biasS = "0.0"sv, biasT = "0.0"sv, biasU = "0.0"sv;
-          if (stage.indTexBiasSel == GX_ITB_S || stage.indTexBiasSel == GX_ITB_ST || stage.indTexBiasSel == GX_ITB_SU ||
-              stage.indTexBiasSel == GX_ITB_STU) {
-            biasS = "1.0"sv;
-          }
-          if (stage.indTexBiasSel == GX_ITB_T || stage.indTexBiasSel == GX_ITB_ST || stage.indTexBiasSel == GX_ITB_TU ||
-              stage.indTexBiasSel == GX_ITB_STU) {
-            biasT = "1.0"sv;
-          }
-          if (stage.indTexBiasSel == GX_ITB_U || stage.indTexBiasSel == GX_ITB_SU || stage.indTexBiasSel == GX_ITB_TU ||
-              stage.indTexBiasSel == GX_ITB_STU) {
-            biasU = "1.0"sv;
-          }
-          fragmentFnPre += fmt::format("\n    ind{0}_coord = ind{0}_coord + vec3f({1}, {2}, {3}) * {4};", i, biasS,
-                                       biasT, biasU, bias);
-        }
-
-        if (stage.indTexMtxId >= GX_ITM_0 && stage.indTexMtxId <= GX_ITM_2) {
-          // Static 2x3 matrix: dot(mat_row, vec3(S,T,U)) * scale
-          u32 mtxIdx = stage.indTexMtxId - GX_ITM_0;
-          fragmentFnPre += fmt::format(
-              "\n    let ind{0}_c0 = ubuf.ind_mtx[{1}][0];"
-              "\n    let ind{0}_c1 = ubuf.ind_mtx[{1}][1];",
-              i, mtxIdx);
-          indirectOffsetTexel = fmt::format(
-              "vec2f("
-              "dot(vec3f(ind{0}_c0.xz, ind{0}_c1.x), ind{0}_coord), "
-              "dot(vec3f(ind{0}_c0.yw, ind{0}_c1.y), ind{0}_coord)"
-              ") * ind{0}_c1.z",
-              i);
-        } else if (stage.indTexMtxId >= GX_ITM_S0 && stage.indTexMtxId <= GX_ITM_S2 && hasBaseCoord) {
-          // Dynamic S: result = scaled texcoord * ind_coord.x * scale / 256
-          u32 mtxIdx = stage.indTexMtxId - GX_ITM_S0;
-          u32 regTexCoord = underlying(stage.texCoordId);
-          indirectOffsetTexel = fmt::format(
-              "tex{1}_uv * ubuf.texcoord_scale[{1}].xy * ind{0}_coord.x"
-              " * ubuf.ind_mtx[{2}][1][2] / 256.0",
-              i, regTexCoord, mtxIdx);
-        } else if (stage.indTexMtxId >= GX_ITM_T0 && stage.indTexMtxId <= GX_ITM_T2 && hasBaseCoord) {
-          // Dynamic T: result = scaled texcoord * ind_coord.y * scale / 256
-          u32 mtxIdx = stage.indTexMtxId - GX_ITM_T0;
-          u32 regTexCoord = underlying(stage.texCoordId);
-          indirectOffsetTexel = fmt::format(
-              "tex{1}_uv * ubuf.texcoord_scale[{1}].xy * ind{0}_coord.y"
-              " * ubuf.ind_mtx[{2}][1][2] / 256.0",
-              i, regTexCoord, mtxIdx);
-        }
-      }
-
-      // Don't convert to/from texel space if we can avoid it
-      const bool useSimpleCoords = stage.indTexMtxId == GX_ITM_OFF && !stage.indTexAddPrev;
-
-      // Wrap base coord and combine with the indirect translation.
-      auto wrap_comp = [](GXIndTexWrap wrap, std::string&& coord) -> std::string {
-        switch (wrap) {
-        case GX_ITW_OFF:
-          return std::move(coord);
-        case GX_ITW_256:
-          return fmt::format("({} % 256.0)", coord);
-        case GX_ITW_128:
-          return fmt::format("({} % 128.0)", coord);
-        case GX_ITW_64:
-          return fmt::format("({} % 64.0)", coord);
-        case GX_ITW_32:
-          return fmt::format("({} % 32.0)", coord);
-        case GX_ITW_16:
-          return fmt::format("({} % 16.0)", coord);
-        case GX_ITW_0:
-          return "0.0";
-        default:
-          FATAL("unhandled indirect wrap {}", underlying(wrap));
-        }
-      };
-      std::string baseCoordExpr;
-      if (hasBaseCoord) {
-        u32 texCoordId = underlying(stage.texCoordId);
-        if (useSimpleCoords) {
-          baseCoordExpr = fmt::format("tex{}_uv", texCoordId);
-        } else {
-          fragmentFnPre +=
-              fmt::format("\n    var ind{0}_texel = tex{1}_uv * ubuf.texcoord_scale[{1}].xy;", i, texCoordId);
-          baseCoordExpr = fmt::format("ind{}_texel", i);
-        }
-      }
-      std::string wrappedExpr = baseCoordExpr;
-      if (!baseCoordExpr.empty() && (stage.indTexWrapS != GX_ITW_OFF || stage.indTexWrapT != GX_ITW_OFF)) {
-        wrappedExpr = fmt::format("vec2f({}, {})", wrap_comp(stage.indTexWrapS, fmt::format("{}.x", baseCoordExpr)),
-                                  wrap_comp(stage.indTexWrapT, fmt::format("{}.y", baseCoordExpr)));
-      }
-
-      std::string finalCoord;
-      if (!wrappedExpr.empty() && !indirectOffsetTexel.empty()) {
-        finalCoord = fmt::format("{} + ({})", wrappedExpr, indirectOffsetTexel);
-      } else if (!wrappedExpr.empty()) {
-        finalCoord = wrappedExpr;
-      } else {
-        finalCoord = indirectOffsetTexel;
-      }
-
-      if (info.usedIndStages.any() && !finalCoord.empty()) {
-        if (stage.indTexAddPrev) {
-          fragmentFnPre += fmt::format("\n    t_TexCoord += {};", finalCoord);
-        } else {
-          fragmentFnPre += fmt::format("\n    t_TexCoord = {};", finalCoord);
-        }
-
-        if (needsTextureSample && hasBaseTexture) {
-          u32 texMapId = underlying(stage.texMapId);
-          if (useSimpleCoords) {
-            fragmentFnPre += fmt::format("\n    var ind{0}_uv = t_TexCoord;", i);
-          } else {
-            fragmentFnPre += fmt::format("\n    var ind{0}_uv = t_TexCoord / ubuf.tex{1}_size_bias.xy;", i, texMapId);
-          }
-          uvIn = fmt::format("ind{0}_uv", i);
-        }
-      }
-    }
-    if (!needsTextureSample) {
-      continue;
-    }
-
-    CHECK(stage.texMapId != GX_TEXMAP_NULL, "unmapped texture for stage {}", i);
-    CHECK(stage.texCoordId != GX_TEXCOORD_NULL, "unmapped texcoord for stage {}", i);
-    if (uvIn.empty()) {
-      // No indirect texturing
-      uvIn = fmt::format("tex{0}_uv", underlying(stage.texCoordId));
-    }
-    fragmentFnPre +=
-        fmt::format("\n    var sampled{0} = textureSampleBias(tex{1}, tex{1}_samp, {2}, ubuf.tex{1}_size_bias.z);", i,
-                    underlying(stage.texMapId), uvIn);
-  }
-  if (info.usesPTTexMtx.any()) {
-    uniBufAttrs += fmt::format("\n    postmtx: array<mat3x4f, {}>,", MaxPTTexMtx);
-  }
-  if (info.usesFog) {
-    uniformPre +=
-        "\n"
-        "struct Fog {\n"
-        "    color: vec4f,\n"
-        "    a: f32,\n"
-        "    b: f32,\n"
-        "    c: f32,\n"
-        "    range_center: f32,\n"
-        "    range_k: array<vec4f, 3>,\n"
-        "}";
-    uniBufAttrs += "\n    fog: Fog,";
-
-    const std::string_view fogDepth = UseReversedZ ? "(1.0 - in.pos.z)" : "in.pos.z";
-    if ((config.fogType & 0x08) != 0) {
-      fragmentFn += fmt::format("\n    // Orthographic fog\n    var fogBase = ubuf.fog.a * {};", fogDepth);
-    } else {
-      fragmentFn +=
-          fmt::format("\n    // Perspective fog\n    var fogBase = ubuf.fog.a / (ubuf.fog.b - {});", fogDepth);
-    }
-    if (config.fogRangeEnabled) {
-      fragmentFn += "\n        fogBase *= bitcast<f32>(abuf[imm.fog_range_base + u32(in.pos.x)]);";
-    }
-    fragmentFn += "\n    var fogF = clamp(fogBase - ubuf.fog.c, 0.0, 1.0);";
-    switch (config.fogType) {
-      DEFAULT_FATAL("invalid fog type {}", config.fogType);
-    case GX_FOG_PERSP_LIN:
-    case GX_FOG_ORTHO_LIN:
-      fragmentFn += "\n    var fogZ = fogF;";
-      break;
-    case GX_FOG_PERSP_EXP:
-    case GX_FOG_ORTHO_EXP:
-      fragmentFn += "\n    var fogZ = 1.0 - exp2(-8.0 * fogF);";
-      break;
-    case GX_FOG_PERSP_EXP2:
-    case GX_FOG_ORTHO_EXP2:
-      fragmentFn += "\n    var fogZ = 1.0 - exp2(-8.0 * fogF * fogF);";
-      break;
-    case GX_FOG_PERSP_REVEXP:
-    case GX_FOG_ORTHO_REVEXP:
-      fragmentFn += "\n    var fogZ = exp2(-8.0 * (1.0 - fogF));";
-      break;
-    case GX_FOG_PERSP_REVEXP2:
-    case GX_FOG_ORTHO_REVEXP2:
-      fragmentFn +=
-          "\n    fogF = 1.0 - fogF;"
-          "\n    var fogZ = exp2(-8.0 * fogF * fogF);";
-      break;
-    }
-    fragmentFn += "\n    prev = vec4f(mix(prev.rgb, ubuf.fog.color.rgb, clamp(fogZ, 0.0, 1.0)), prev.a);";
-  }
-  uniBufAttrs += fmt::format("\n    texcoord_scale: array<vec4f, {}>,", MaxTexCoord);
-  if (info.usedIndTexMtxs.any()) {
-    uniBufAttrs += fmt::format("\n    ind_mtx: array<mat2x4f, {}>,", MaxIndTexMtxs);
-  }
-  for (int i = 0; i < info.sampledTextures.size(); ++i) {
-    if (!info.sampledTextures.test(i)) {
-      continue;
-    }
-    uniBufAttrs += fmt::format("\n    tex{}_size_bias: vec4f,", i);
-    texBindings += fmt::format(
-        "\n@group(2) @binding({1})\n"
-        "var tex{0}: texture_2d<f32>;\n"
-        "@group(2) @binding({2})\n"
-        "var tex{0}_samp: sampler;",
-        i, i * 2, i * 2 + 1);
-  }
-  if (!prevColorNormalized && !prevAlphaNormalized) {
-    fragmentFn += "\n    prev = tev_overflow_vec4f(prev);";
-  } else if (!prevColorNormalized) {
-    fragmentFn += "\n    prev = vec4f(tev_overflow_vec3f(prev.rgb), prev.a);";
-  } else if (!prevAlphaNormalized) {
-    fragmentFn += "\n    prev.a = tev_overflow_f32(prev.a);";
-  }
-  if (config.alphaCompare) {
-    const auto comp0 = alpha_compare(config.alphaCompare.comp0, config.alphaCompare.ref0);
-    const auto comp1 = alpha_compare(config.alphaCompare.comp1, config.alphaCompare.ref1);
-    AlphaCompareExpr pass;
-    switch (config.alphaCompare.op) {
-      DEFAULT_FATAL("invalid alpha compare op {}", underlying(config.alphaCompare.op));
-    case GX_AOP_AND:
-      pass = alpha_compare_and(comp0, comp1);
-      break;
-    case GX_AOP_OR:
-      pass = alpha_compare_or(comp0, comp1);
-      break;
-    case GX_AOP_XOR:
-      pass = alpha_compare_xor(comp0, comp1);
-      break;
-    case GX_AOP_XNOR:
-      pass = alpha_compare_xnor(comp0, comp1);
-      break;
-    }
-    const auto discard = alpha_compare_not(pass);
-    if (discard.constant == 1) {
-      fragmentFn += "\n    // Alpha compare\n    discard;";
-    } else if (discard.constant != 0) {
-      fragmentFn +=
-          "\n    // Alpha compare"
-          "\n    let alphaCompare = u32(round(clamp(prev.a, 0.0, 1.0) * 255.0));";
-      fragmentFn += fmt::format("\n    if ({}) {{ discard; }}", discard.expr);
-    }
-  }
-  if constexpr (EnableNormalVisualization) {
-    fragmentFn += "\n    prev = vec4f(in.nrm, prev.a);";
-  }
-
-  const auto shaderSource = fmt::format(R"""(
-fn bswap32(v: u32, le: bool) -> u32 {{
-  if (le) {{
-    return v;
-  }}
-  return ((v & 0x000000FFu) << 24u) |
-         ((v & 0x0000FF00u) << 8u) |
-         ((v & 0x00FF0000u) >> 8u) |
-         ((v & 0xFF000000u) >> 24u);
-}}
-
-fn bswap16(v: u32, le: bool) -> u32 {{
-  return select(((v & 0xFFu) << 8u) | (v >> 8u), v, le);
-}}
-
-fn load_word(p: ptr<storage, array<u32>>, word_idx: u32) -> u32 {{
-  // This guard is not expected to handle routine out-of-bounds accesses.
-  // It appears to discourage some Adreno drivers/optimizers from storage buffer
-  // optimizations that can cause visual artifacts, including vertex explosions
-  // in Dusklight.
-  if (word_idx < arrayLength(p)) {{
-    return p[word_idx];
-  }}
-  return 0u;
-}}
-
-fn load_u8(p: ptr<storage, array<u32>>, byte_off: u32) -> u32 {{
-  let word = load_word(p, byte_off / 4u);
-  let shift = (byte_off & 3u) * 8u;
-  return (word >> shift) & 0xFFu;
-}}
-
-fn load_u32_raw(p: ptr<storage, array<u32>>, byte_off: u32) -> u32 {{
-  let word_idx = byte_off >> 2u;
-  let sub = byte_off & 3u;
-  let lo = load_word(p, word_idx);
-  if (sub == 0u) {{
-    return lo;
-  }}
-  let hi = load_word(p, word_idx + 1u);
-  let shift = sub * 8u;
-  return (lo >> shift) | (hi << (32u - shift));
-}}
-
-fn load_u16(p: ptr<storage, array<u32>>, byte_off: u32, le: bool) -> u32 {{
-  let word_idx = byte_off >> 2u;
-  let sub = byte_off & 3u;
-  let word = load_word(p, word_idx);
-  if (sub <= 2u) {{
-    return bswap16(extractBits(word, sub * 8u, 16u), le);
-  }}
-  let next = load_word(p, word_idx + 1u);
-  let raw = extractBits(word, 24u, 8u) | (extractBits(next, 0u, 8u) << 8u);
-  return bswap16(raw, le);
-}}
-
-fn load_u24(p: ptr<storage, array<u32>>, byte_off: u32, le: bool) -> u32 {{
-  let raw = load_u32_raw(p, byte_off) & 0x00FFFFFFu;
-  if (le) {{
-    return raw;
-  }}
-  return ((raw & 0x0000FFu) << 16u) |
-         (raw & 0x00FF00u) |
-         ((raw & 0xFF0000u) >> 16u);
-}}
-
-fn load_u32(p: ptr<storage, array<u32>>, byte_off: u32, le: bool) -> u32 {{
-  return bswap32(load_u32_raw(p, byte_off), le);
-}}
-
-fn load_f32(p: ptr<storage, array<u32>>, byte_off: u32, le: bool) -> f32 {{
+fn load_f32(p: ptr<storage, array<u32>>, byte_off: u32, le: bool) -> f32 {
   return bitcast<f32>(load_u32(p, byte_off, le));
-}}
+}
 
-fn raw_fetch_u8_1(p: ptr<storage, array<u32>>, byte_off: u32) -> u32 {{
+fn raw_fetch_u8_1(p: ptr<storage, array<u32>>, byte_off: u32) -> u32 {
   return load_u8(p, byte_off);
-}}
+}
 
-fn raw_fetch_u8_2(p: ptr<storage, array<u32>>, byte_off: u32) -> vec2u {{
+fn raw_fetch_u8_2(p: ptr<storage, array<u32>>, byte_off: u32) -> vec2u {
   let word_idx = byte_off >> 2u;
   let sub = byte_off & 3u;
   let word = load_word(p, word_idx);
-  if (sub <= 2u) {{
+  if (sub <= 2u) {
     let shift = sub * 8u;
     return vec2u(
       extractBits(word, shift + 0u, 8u),
       extractBits(word, shift + 8u, 8u),
     );
-  }}
+  }
   let next = load_word(p, word_idx + 1u);
   return vec2u(
     extractBits(word, 24u, 8u),
     extractBits(next, 0u, 8u),
   );
-}}
+}
 
-fn raw_fetch_u8_3(p: ptr<storage, array<u32>>, byte_off: u32) -> vec3u {{
+fn raw_fetch_u8_3(p: ptr<storage, array<u32>>, byte_off: u32) -> vec3u {
   let raw = load_u32_raw(p, byte_off);
   return vec3u(
     extractBits(raw, 0u, 8u),
     extractBits(raw, 8u, 8u),
     extractBits(raw, 16u, 8u),
   );
-}}
+}
 
-fn raw_fetch_u8_4(p: ptr<storage, array<u32>>, byte_off: u32) -> vec4u {{
+fn raw_fetch_u8_4(p: ptr<storage, array<u32>>, byte_off: u32) -> vec4u {
   let raw = load_u32_raw(p, byte_off);
   return vec4u(
     extractBits(raw, 0u, 8u),
@@ -1741,227 +1017,999 @@ fn raw_fetch_u8_4(p: ptr<storage, array<u32>>, byte_off: u32) -> vec4u {{
     extractBits(raw, 16u, 8u),
     extractBits(raw, 24u, 8u),
   );
-}}
+}
 
-fn raw_fetch_u16_1(p: ptr<storage, array<u32>>, byte_off: u32, le: bool) -> u32 {{
+fn raw_fetch_u16_1(p: ptr<storage, array<u32>>, byte_off: u32, le: bool) -> u32 {
   return load_u16(p, byte_off, le);
-}}
+}
 
-fn raw_fetch_u16_2(p: ptr<storage, array<u32>>, byte_off: u32, le: bool) -> vec2u {{
+fn raw_fetch_u16_2(p: ptr<storage, array<u32>>, byte_off: u32, le: bool) -> vec2u {
   return vec2u(
     load_u16(p, byte_off + 0u, le),
     load_u16(p, byte_off + 2u, le),
   );
-}}
+}
 
-fn raw_fetch_u16_3(p: ptr<storage, array<u32>>, byte_off: u32, le: bool) -> vec3u {{
+fn raw_fetch_u16_3(p: ptr<storage, array<u32>>, byte_off: u32, le: bool) -> vec3u {
   return vec3u(
     load_u16(p, byte_off + 0u, le),
     load_u16(p, byte_off + 2u, le),
     load_u16(p, byte_off + 4u, le),
   );
-}}
+}
 
-fn raw_fetch_u16_4(p: ptr<storage, array<u32>>, byte_off: u32, le: bool) -> vec4u {{
+fn raw_fetch_u16_4(p: ptr<storage, array<u32>>, byte_off: u32, le: bool) -> vec4u {
   return vec4u(
     load_u16(p, byte_off + 0u, le),
     load_u16(p, byte_off + 2u, le),
     load_u16(p, byte_off + 4u, le),
     load_u16(p, byte_off + 6u, le),
   );
-}}
+}
 
-fn raw_fetch_f32_1(p: ptr<storage, array<u32>>, byte_off: u32, le: bool) -> f32 {{
+fn raw_fetch_f32_1(p: ptr<storage, array<u32>>, byte_off: u32, le: bool) -> f32 {
   return load_f32(p, byte_off, le);
-}}
+}
 
-fn raw_fetch_f32_2(p: ptr<storage, array<u32>>, byte_off: u32, le: bool) -> vec2f {{
+fn raw_fetch_f32_2(p: ptr<storage, array<u32>>, byte_off: u32, le: bool) -> vec2f {
   return vec2f(
     load_f32(p, byte_off + 0u, le),
     load_f32(p, byte_off + 4u, le),
   );
-}}
+}
 
-fn raw_fetch_f32_3(p: ptr<storage, array<u32>>, byte_off: u32, le: bool) -> vec3f {{
+fn raw_fetch_f32_3(p: ptr<storage, array<u32>>, byte_off: u32, le: bool) -> vec3f {
   return vec3f(
     load_f32(p, byte_off + 0u, le),
     load_f32(p, byte_off + 4u, le),
     load_f32(p, byte_off + 8u, le),
   );
-}}
+}
+
+fn raw_fetch_f32_4(p: ptr<storage, array<u32>>, byte_off: u32, le: bool) -> vec4f {
+  return vec4f(
+    load_f32(p, byte_off + 0u, le),
+    load_f32(p, byte_off + 4u, le),
+    load_f32(p, byte_off + 8u, le),
+    load_f32(p, byte_off + 12u, le),
+  );
+}
+
+fn fetch_u8_1(p: ptr<storage, array<u32>>, byte_off: u32, frac: u32, le: bool) -> f32 {
+  let v = raw_fetch_u8_1(p, byte_off);
+  return f32(v) / f32(1u << frac);
+}
+
+fn fetch_s8_1(p: ptr<storage, array<u32>>, byte_off: u32, frac: u32, le: bool) -> f32 {
+  let v = (bitcast<i32>(raw_fetch_u8_1(p, byte_off)) << 24) >> 24;
+  return f32(v) / f32(1u << frac);
+}
+
+fn fetch_u8_2(p: ptr<storage, array<u32>>, byte_off: u32, frac: u32, le: bool) -> vec2f {
+  let v = raw_fetch_u8_2(p, byte_off);
+  return vec2f(v) / f32(1u << frac);
+}
+
+fn fetch_s8_2(p: ptr<storage, array<u32>>, byte_off: u32, frac: u32, le: bool) -> vec2f {
+  let v = (bitcast<vec2i>(raw_fetch_u8_2(p, byte_off)) << vec2u(24u)) >> vec2u(24u);
+  return vec2f(v) / f32(1u << frac);
+}
+
+fn fetch_u8_3(p: ptr<storage, array<u32>>, byte_off: u32, frac: u32, le: bool) -> vec3f {
+  let v = raw_fetch_u8_3(p, byte_off);
+  return vec3f(v) / f32(1u << frac);
+}
+
+fn fetch_s8_3(p: ptr<storage, array<u32>>, byte_off: u32, frac: u32, le: bool) -> vec3f {
+  let v = (bitcast<vec3i>(raw_fetch_u8_3(p, byte_off)) << vec3u(24u)) >> vec3u(24u);
+  return vec3f(v) / f32(1u << frac);
+}
+
+fn fetch_u8_4(p: ptr<storage, array<u32>>, byte_off: u32, frac: u32, le: bool) -> vec4f {
+  let v = raw_fetch_u8_4(p, byte_off);
+  return vec4f(v) / f32(1u << frac);
+}
+
+fn fetch_s8_4(p: ptr<storage, array<u32>>, byte_off: u32, frac: u32, le: bool) -> vec4f {
+  let v = (bitcast<vec4i>(raw_fetch_u8_4(p, byte_off)) << vec4u(24u)) >> vec4u(24u);
+  return vec4f(v) / f32(1u << frac);
+}
+
+fn fetch_u16_1(p: ptr<storage, array<u32>>, byte_off: u32, frac: u32, le: bool) -> f32 {
+  let v = raw_fetch_u16_1(p, byte_off, le);
+  return f32(v) / f32(1u << frac);
+}
+
+fn fetch_s16_1(p: ptr<storage, array<u32>>, byte_off: u32, frac: u32, le: bool) -> f32 {
+  let v = bitcast<i32>(raw_fetch_u16_1(p, byte_off, le) << 16u) >> 16;
+  return f32(v) / f32(1u << frac);
+}
+
+fn fetch_u16_2(p: ptr<storage, array<u32>>, byte_off: u32, frac: u32, le: bool) -> vec2f {
+  let v = raw_fetch_u16_2(p, byte_off, le);
+  return vec2f(v) / f32(1u << frac);
+}
+
+fn fetch_s16_2(p: ptr<storage, array<u32>>, byte_off: u32, frac: u32, le: bool) -> vec2f {
+  let v = (bitcast<vec2i>(raw_fetch_u16_2(p, byte_off, le)) << vec2u(16u)) >> vec2u(16u);
+  return vec2f(v) / f32(1u << frac);
+}
+
+fn fetch_u16_3(p: ptr<storage, array<u32>>, byte_off: u32, frac: u32, le: bool) -> vec3f {
+  let v = raw_fetch_u16_3(p, byte_off, le);
+  return vec3f(v) / f32(1u << frac);
+}
+
+fn fetch_s16_3(p: ptr<storage, array<u32>>, byte_off: u32, frac: u32, le: bool) -> vec3f {
+  let v = (bitcast<vec3i>(raw_fetch_u16_3(p, byte_off, le)) << vec3u(16u)) >> vec3u(16u);
+  return vec3f(v) / f32(1u << frac);
+}
+
+fn fetch_u16_4(p: ptr<storage, array<u32>>, byte_off: u32, frac: u32, le: bool) -> vec4f {
+  let v = raw_fetch_u16_4(p, byte_off, le);
+  return vec4f(v) / f32(1u << frac);
+}
+
+fn fetch_s16_4(p: ptr<storage, array<u32>>, byte_off: u32, frac: u32, le: bool) -> vec4f {
+  let v = (bitcast<vec4i>(raw_fetch_u16_4(p, byte_off, le)) << vec4u(16u)) >> vec4u(16u);
+  return vec4f(v) / f32(1u << frac);
+}
+
+fn fetch_f32_1(p: ptr<storage, array<u32>>, byte_off: u32, le: bool) -> f32 {
+  return raw_fetch_f32_1(p, byte_off, le);
+}
+
+fn fetch_f32_2(p: ptr<storage, array<u32>>, byte_off: u32, le: bool) -> vec2f {
+  return raw_fetch_f32_2(p, byte_off, le);
+}
+
+fn fetch_f32_3(p: ptr<storage, array<u32>>, byte_off: u32, le: bool) -> vec3f {
+  return raw_fetch_f32_3(p, byte_off, le);
+}
+
+fn fetch_f32_4(p: ptr<storage, array<u32>>, byte_off: u32, le: bool) -> vec4f {
+  return raw_fetch_f32_4(p, byte_off, le);
+}
+
+fn fetch_rgb565(p: ptr<storage, array<u32>>, byte_off: u32, le: bool) -> vec4f {
+  let v = load_u16(p, byte_off, le);
+  return vec4f(
+    f32((v >> 11u) & 0x1Fu) / f32(0x1Fu),
+    f32((v >>  5u) & 0x3Fu) / f32(0x3Fu),
+    f32((v >>  0u) & 0x1Fu) / f32(0x1Fu),
+    1.0,
+  );
+}
+
+fn fetch_rgb8(p: ptr<storage, array<u32>>, byte_off: u32, le: bool) -> vec4f {
+  let v = raw_fetch_u8_3(p, byte_off);
+  return vec4f(f32(v.x), f32(v.y), f32(v.z), 255.0) / 255.0;
+}
+
+fn fetch_rgbx8(p: ptr<storage, array<u32>>, byte_off: u32, le: bool) -> vec4f {
+  let v = raw_fetch_u8_4(p, byte_off);
+  return vec4f(f32(v.x), f32(v.y), f32(v.z), 255.0) / 255.0;
+}
+
+fn fetch_rgba4(p: ptr<storage, array<u32>>, byte_off: u32, le: bool) -> vec4f {
+  let v = load_u16(p, byte_off, le);
+  return vec4f(
+    f32((v >> 12u) & 0x0Fu) / f32(0x0Fu),
+    f32((v >>  8u) & 0x0Fu) / f32(0x0Fu),
+    f32((v >>  4u) & 0x0Fu) / f32(0x0Fu),
+    f32((v >>  0u) & 0x0Fu) / f32(0x0Fu),
+  );
+}
 
-fn raw_fetch_f32_4(p: ptr<storage, array<u32>>, byte_off: u32, le: bool) -> vec4f {{
+fn fetch_rgba6(p: ptr<storage, array<u32>>, byte_off: u32, le: bool) -> vec4f {
+  let v = load_u24(p, byte_off, le);
   return vec4f(
-    load_f32(p, byte_off + 0u, le),
-    load_f32(p, byte_off + 4u, le),
-    load_f32(p, byte_off + 8u, le),
-    load_f32(p, byte_off + 12u, le),
+    f32((v >> 18u) & 0x3Fu) / f32(0x3Fu),
+    f32((v >> 12u) & 0x3Fu) / f32(0x3Fu),
+    f32((v >>  6u) & 0x3Fu) / f32(0x3Fu),
+    f32((v >>  0u) & 0x3Fu) / f32(0x3Fu),
   );
-}}
+}
 
-fn fetch_u8_1(p: ptr<storage, array<u32>>, byte_off: u32, frac: u32, le: bool) -> f32 {{
-  let v = raw_fetch_u8_1(p, byte_off);
-  return f32(v) / f32(1u << frac);
-}}
+fn fetch_rgba8(p: ptr<storage, array<u32>>, byte_off: u32, le: bool) -> vec4f {
+  let v = raw_fetch_u8_4(p, byte_off);
+  return vec4f(v) / 255.0;
+}
 
-fn fetch_s8_1(p: ptr<storage, array<u32>>, byte_off: u32, frac: u32, le: bool) -> f32 {{
-  let v = (bitcast<i32>(raw_fetch_u8_1(p, byte_off)) << 24) >> 24;
-  return f32(v) / f32(1u << frac);
-}}
+fn tev_overflow_f32(in: f32) -> f32 {
+  let byte_space = in * 255.0;
+  return (byte_space - floor(byte_space / 256.0) * 256.0) / 255.0;
+}
 
-fn fetch_u8_2(p: ptr<storage, array<u32>>, byte_off: u32, frac: u32, le: bool) -> vec2f {{
-  let v = raw_fetch_u8_2(p, byte_off);
-  return vec2f(v) / f32(1u << frac);
-}}
+fn tev_overflow_vec3f(in: vec3f) -> vec3f {
+  let byte_space = in * 255.0;
+  return (byte_space - floor(byte_space / 256.0) * 256.0) / 255.0;
+}
 
-fn fetch_s8_2(p: ptr<storage, array<u32>>, byte_off: u32, frac: u32, le: bool) -> vec2f {{
-  let v = (bitcast<vec2i>(raw_fetch_u8_2(p, byte_off)) << vec2u(24u)) >> vec2u(24u);
-  return vec2f(v) / f32(1u << frac);
-}}
+fn tev_overflow_vec4f(in: vec4f) -> vec4f {
+  let byte_space = in * 255.0;
+  return (byte_space - floor(byte_space / 256.0) * 256.0) / 255.0;
+}
+)""";
 
-fn fetch_u8_3(p: ptr<storage, array<u32>>, byte_off: u32, frac: u32, le: bool) -> vec3f {{
-  let v = raw_fetch_u8_3(p, byte_off);
-  return vec3f(v) / f32(1u << frac);
-}}
+absl::flat_hash_set<gfx::ShaderRef> s_seenShaders;
+} // namespace
 
-fn fetch_s8_3(p: ptr<storage, array<u32>>, byte_off: u32, frac: u32, le: bool) -> vec3f {{
-  let v = (bitcast<vec3i>(raw_fetch_u8_3(p, byte_off)) << vec3u(24u)) >> vec3u(24u);
-  return vec3f(v) / f32(1u << frac);
-}}
+std::string build_shader_source(const ShaderConfig& config) noexcept {
+  ZoneScoped;
+  const auto hash = xxh3_hash(config);
+  const auto info = build_shader_info(config);
+  if (EnableDebugPrints && !s_seenShaders.contains(hash)) {
+    s_seenShaders.insert(hash);
 
-fn fetch_u8_4(p: ptr<storage, array<u32>>, byte_off: u32, frac: u32, le: bool) -> vec4f {{
-  let v = raw_fetch_u8_4(p, byte_off);
-  return vec4f(v) / f32(1u << frac);
-}}
+    Log.info("Shader config (hash {:x}):", hash);
+    {
+      for (int i = 0; i < config.tevStageCount; ++i) {
+        const auto& stage = config.tevStages[i];
+        Log.info("  tevStages[{}]:", i);
+        Log.info("    color_a: {}", TevColorArgNames[stage.colorPass.a]);
+        Log.info("    color_b: {}", TevColorArgNames[stage.colorPass.b]);
+        Log.info("    color_c: {}", TevColorArgNames[stage.colorPass.c]);
+        Log.info("    color_d: {}", TevColorArgNames[stage.colorPass.d]);
+        Log.info("    alpha_a: {}", TevAlphaArgNames[stage.alphaPass.a]);
+        Log.info("    alpha_b: {}", TevAlphaArgNames[stage.alphaPass.b]);
+        Log.info("    alpha_c: {}", TevAlphaArgNames[stage.alphaPass.c]);
+        Log.info("    alpha_d: {}", TevAlphaArgNames[stage.alphaPass.d]);
+        Log.info("    color_op_clamp: {}", stage.colorOp.clamp);
+        Log.info("    color_op_op: {}", stage.colorOp.op);
+        Log.info("    color_op_bias: {}", stage.colorOp.bias);
+        Log.info("    color_op_scale: {}", stage.colorOp.scale);
+        Log.info("    color_op_reg_id: {}", stage.colorOp.outReg);
+        Log.info("    alpha_op_clamp: {}", stage.alphaOp.clamp);
+        Log.info("    alpha_op_op: {}", stage.alphaOp.op);
+        Log.info("    alpha_op_bias: {}", stage.alphaOp.bias);
+        Log.info("    alpha_op_scale: {}", stage.alphaOp.scale);
+        Log.info("    alpha_op_reg_id: {}", stage.alphaOp.outReg);
+        Log.info("    kc_sel: {}", stage.kcSel);
+        Log.info("    ka_sel: {}", stage.kaSel);
+        Log.info("    texCoordId: {}", stage.texCoordId);
+        Log.info("    texMapId: {}", stage.texMapId);
+        Log.info("    channelId: {}", stage.channelId);
+        Log.info("    tevSwapRas: {}", stage.tevSwapRas);
+        Log.info("    tevSwapTex: {}", stage.tevSwapTex);
+        Log.info("    indTexStage: {}", stage.indTexStage);
+        Log.info("    indTexFormat: {}", stage.indTexFormat);
+        Log.info("    indTexBiasSel: {}", stage.indTexBiasSel);
+        Log.info("    indTexAlphaSel: {}", stage.indTexAlphaSel);
+        Log.info("    indTexMtxId: {}", stage.indTexMtxId);
+        Log.info("    indTexWrapS: {}", stage.indTexWrapS);
+        Log.info("    indTexWrapT: {}", stage.indTexWrapT);
+        Log.info("    indTexUseOrigLOD: {}", stage.indTexUseOrigLOD);
+        Log.info("    indTexAddPrev: {}", stage.indTexAddPrev);
+      }
+      Log.info("  numIndStages: {}", config.numIndStages);
+      for (u32 i = 0; i < config.numIndStages; ++i) {
+        const auto& stage = config.indStages[i];
+        Log.info("  indStages[{}]: texCoordId {} texMapId {} scaleS {} scaleT {}", i, stage.texCoordId, stage.texMapId,
+                 stage.scaleS, stage.scaleT);
+      }
+      for (int i = 0; i < config.colorChannels.size(); ++i) {
+        const auto& chan = config.colorChannels[i];
+        Log.info("  colorChannels[{}]: enabled {} mat {} amb {}", static_cast<GXChannelID>(i), chan.lightingEnabled,
+                 chan.matSrc, chan.ambSrc);
+      }
+      for (int i = 0; i < config.tcgs.size(); ++i) {
+        const auto& tcg = config.tcgs[i];
+        if (tcg.src != GX_MAX_TEXGENSRC) {
+          Log.info("  tcg[{}]: src {} mtx {} post {} type {} norm {}", i, tcg.src, tcg.mtx, tcg.postMtx, tcg.type,
+                   tcg.normalize);
+        }
+      }
+      Log.info("  alphaCompare: comp0 {} ref0 {} op {} comp1 {} ref1 {}", config.alphaCompare.comp0,
+               config.alphaCompare.ref0, config.alphaCompare.op, config.alphaCompare.comp1, config.alphaCompare.ref1);
+      Log.info("  fogType: {}", config.fogType);
+      Log.info("  fogRangeEnabled: {}", config.fogRangeEnabled);
+    }
+  }
 
-fn fetch_s8_4(p: ptr<storage, array<u32>>, byte_off: u32, frac: u32, le: bool) -> vec4f {{
-  let v = (bitcast<vec4i>(raw_fetch_u8_4(p, byte_off)) << vec4u(24u)) >> vec4u(24u);
-  return vec4f(v) / f32(1u << frac);
-}}
+  std::string uniformPre;
+  std::string uniBufAttrs;
+  std::string texBindings;
+  std::string vtxOutAttrs;
+  std::string vtxInAttrs;
+  std::string vtxXfrAttrsPre;
+  std::string vtxXfrAttrs;
+  size_t vtxOutIdx = 0;
 
-fn fetch_u16_1(p: ptr<storage, array<u32>>, byte_off: u32, frac: u32, le: bool) -> f32 {{
-  let v = raw_fetch_u16_1(p, byte_off, le);
-  return f32(v) / f32(1u << frac);
-}}
+  // Load points for line/point expansion
+  std::string_view vidxAttr = "vidx"sv;
+  const auto posMtx = config.instancedMtx ? "inst_pos_mtx"sv : "ubuf.postex_mtx[in_pnmtxidx]"sv;
+  const auto nrmMtx = config.instancedMtx ? "inst_nrm_mtx"sv : "ubuf.nrm_mtx[in_pnmtxidx]"sv;
+  if (config.lineMode != 0) {
+    vtxInAttrs += ",\n    @builtin(instance_index) iidx: u32";
+    uniBufAttrs +=
+        "\n    line_width: f32,"
+        "\n    line_aspect_y: f32,"
+        "\n    line_tex_offset: f32,"
+        "\n    line_texcoord_mask: u32,";
+    if (config.lineMode == 3) {
+      // GX_POINTS: each instance = one vertex, expand to quad
+      vtxXfrAttrsPre += fmt::format(
+          "\n    let in_vidx = iidx;"
+          "\n    let in_pos = {};"
+          "\n    let in_pnmtxidx = {};"
+          "\n    let mv_pos = vec4f(in_pos, 1.0) * ubuf.postex_mtx[in_pnmtxidx];",
+          attr_load(config, GX_VA_POS, "in_vidx"sv), attr_load(config, GX_VA_PNMTXIDX, "in_vidx"sv));
+    } else {
+      // GX_LINES / GX_LINESTRIP: each instance = two vertices, expand to quad
+      vtxXfrAttrsPre += fmt::format(
+          "\n    let use_b = vidx >= 2u;"
+          "\n    let vidx_a = iidx * {}u;"
+          "\n    let vidx_b = vidx_a + 1u;"
+          "\n    let in_vidx = select(vidx_a, vidx_b, use_b);"
+          "\n    let pos_a = {};"
+          "\n    let pos_b = {};"
+          "\n    let in_pos = select(pos_a, pos_b, use_b);"
+          "\n    let pnmtxidx_a = {};"
+          "\n    let pnmtxidx_b = {};"
+          "\n    let in_pnmtxidx = select(pnmtxidx_a, pnmtxidx_b, use_b);"
+          "\n    let mv_pos_a = vec4f(pos_a, 1.0) * ubuf.postex_mtx[pnmtxidx_a];"
+          "\n    let mv_pos_b = vec4f(pos_b, 1.0) * ubuf.postex_mtx[pnmtxidx_b];"
+          "\n    let mv_pos = select(mv_pos_a, mv_pos_b, use_b);",
+          config.lineMode == 1 ? 2 : 1, attr_load(config, GX_VA_POS, "vidx_a"sv),
+          attr_load(config, GX_VA_POS, "vidx_b"sv), attr_load(config, GX_VA_PNMTXIDX, "vidx_a"sv),
+          attr_load(config, GX_VA_PNMTXIDX, "vidx_b"sv));
+    }
+    vidxAttr = "in_vidx"sv;
+  } else if (config.instancedMtx) {
+    vtxInAttrs += ",\n    @builtin(instance_index) iidx: u32";
+    vtxXfrAttrsPre += fmt::format(
+        "\n    let inst_base = imm.instance_base + iidx * {}u;"
+        "\n    let inst_pos_mtx = load_mtx3x4(&abuf, inst_base);"
+        "\n    let inst_nrm_mtx = load_mtx3x4(&abuf, inst_base + 12u);",
+        InstancedMtxWords);
+  } else if (config.attrs[GX_VA_PNMTXIDX].attrType == GX_NONE) {
+    vtxXfrAttrsPre += "\n    let in_pnmtxidx = imm.current_pnmtx;";
+  }
 
-fn fetch_s16_1(p: ptr<storage, array<u32>>, byte_off: u32, frac: u32, le: bool) -> f32 {{
-  let v = bitcast<i32>(raw_fetch_u16_1(p, byte_off, le) << 16u) >> 16;
-  return f32(v) / f32(1u << frac);
-}}
+  // Load vertex attributes
+  for (GXAttr attr = GX_VA_PNMTXIDX; attr <= GX_VA_TEX7; attr = static_cast<GXAttr>(attr + 1)) {
+    const auto attrType = config.attrs[attr].attrType;
+    if (attrType == GX_NONE) {
+      continue;
+    }
+    // in_pnmtxidx and in_pos written above for line mode
+    if ((attr != GX_VA_PNMTXIDX && attr != GX_VA_POS) || config.lineMode == 0) {
+      vtxXfrAttrsPre += fmt::format("\n    let {} = {};", vtx_attr(config, attr), attr_load(config, attr, vidxAttr));
+    }
+  }
+  bool needsBinrm = false;
+  bool needsTangent = false;
+  for (int i = 0; i < info.sampledTexCoords.size(); ++i) {
+    if (!info.sampledTexCoords.test(i)) {
+      continue;
+    }
+    const bool emboss = is_emboss_texgen(config.tcgs[i].type);
+    needsBinrm = needsBinrm || config.tcgs[i].src == GX_TG_BINRM || emboss;
+    needsTangent = needsTangent || config.tcgs[i].src == GX_TG_TANGENT || emboss;
+  }
+  if (needsBinrm) {
+    vtxXfrAttrsPre += fmt::format("\n    let {} = {};", nbt_slice_local(NbtSlice::B),
+                                  attr_load_nbt_slice(config, NbtSlice::B, vidxAttr));
+  }
+  if (needsTangent) {
+    vtxXfrAttrsPre += fmt::format("\n    let {} = {};", nbt_slice_local(NbtSlice::T),
+                                  attr_load_nbt_slice(config, NbtSlice::T, vidxAttr));
+  }
 
-fn fetch_u16_2(p: ptr<storage, array<u32>>, byte_off: u32, frac: u32, le: bool) -> vec2f {{
-  let v = raw_fetch_u16_2(p, byte_off, le);
-  return vec2f(v) / f32(1u << frac);
-}}
+  if (config.lineMode == 0) {
+    vtxXfrAttrsPre += fmt::format(
+        "\n    let mv_pos = vec4f({}, 1.0) * {};"
+        "\n    out.pos = vec4f(mv_pos, 1.0) * ubuf.proj;",
+        vtx_attr(config, GX_VA_POS), posMtx);
+  } else if (config.lineMode == 3) {
+    // GX_POINTS: expand single vertex to axis-aligned screen-space square
+    vtxXfrAttrsPre +=
+        "\n    let clip = vec4f(mv_pos, 1.0) * ubuf.proj;"
+        "\n    let viewport_scale = ubuf.render_viewport_size / max(ubuf.logical_viewport_size, vec2f(1.0));"
+        "\n    let point_size = ubuf.line_width * min(viewport_scale.x, viewport_scale.y);"
+        "\n    let x_sign = select(-1.0, 1.0, (vidx & 1u) != 0u);"
+        "\n    let y_sign = select(-1.0, 1.0, vidx >= 2u);"
+        "\n    let offset_px = vec2f(x_sign, y_sign) * (point_size / 2.0);"
+        "\n    let offset_ndc = (offset_px * 2.0) / ubuf.render_viewport_size;"
+        "\n    out.pos = vec4f(clip.xy + offset_ndc * clip.w, clip.zw);";
+  } else {
+    // GX_LINES / GX_LINESTRIP: expand line segment perpendicular to direction
+    vtxXfrAttrsPre +=
+        "\n    let clip_a = vec4f(mv_pos_a, 1.0) * ubuf.proj;"
+        "\n    let clip_b = vec4f(mv_pos_b, 1.0) * ubuf.proj;"
+        "\n    let ndc_a = clip_a.xy / clip_a.w;"
+        "\n    let ndc_b = clip_b.xy / clip_b.w;"
+        "\n    let viewport_scale = ubuf.render_viewport_size / max(ubuf.logical_viewport_size, vec2f(1.0));"
+        "\n    let delta_px = (ndc_b - ndc_a) / 2.0 * ubuf.render_viewport_size;"
+        "\n    let dir_px = select(vec2f(1.0, 0.0), normalize(delta_px), dot(delta_px, delta_px) > 1e-10);"
+        "\n    let perp_px = vec2f(-dir_px.y, dir_px.x);"
+        "\n    let line_width = ubuf.line_width * min(viewport_scale.x, viewport_scale.y);"
+        "\n    let offset_px = perp_px * (line_width / 2.0) * select(-1.0, 1.0, (vidx & 1u) != 0u);"
+        "\n    let offset_ndc = (offset_px * 2.0) / ubuf.render_viewport_size;"
+        "\n    let clip_base = select(clip_a, clip_b, use_b);"
+        "\n    out.pos = vec4f(clip_base.xy + offset_ndc * clip_base.w, clip_base.zw);";
+  }
+  vtxXfrAttrsPre += fmt::format(
+      "\n    let nrm_tmp = vec4f({}, 0.0) * {};"
+      "\n    let mv_nrm = select(nrm_tmp, normalize(nrm_tmp), dot(nrm_tmp, nrm_tmp) > 1e-10);",
+      vtx_attr(config, GX_VA_NRM), nrmMtx);
+  if constexpr (EnableNormalVisualization) {
+    vtxOutAttrs += fmt::format("\n    @location({}) nrm: vec3f,", vtxOutIdx++);
+    vtxXfrAttrsPre += "\n    out.nrm = mv_nrm;";
+  }
+
+  uniBufAttrs += "\n    proj: mat4x4f,";
+  uniBufAttrs += fmt::format("\n    postex_mtx: array<mat3x4f, {}>,", MaxPnMtx + MaxTexMtx);
+  uniBufAttrs += fmt::format("\n    nrm_mtx: array<mat3x4f, {}>,", MaxPnMtx);
+  std::string fragmentFnPre;
+  std::string fragmentFn;
 
-fn fetch_s16_2(p: ptr<storage, array<u32>>, byte_off: u32, frac: u32, le: bool) -> vec2f {{
-  let v = (bitcast<vec2i>(raw_fetch_u16_2(p, byte_off, le)) << vec2u(16u)) >> vec2u(16u);
-  return vec2f(v) / f32(1u << frac);
-}}
+  static std::array regName{"prev"sv, "tevreg0"sv, "tevreg1"sv, "tevreg2"sv};
+  std::array<bool, MaxTevRegs> colorNormalized{};
+  std::array<bool, MaxTevRegs> alphaNormalized{};
+  for (u32 idx = 0; idx < config.tevStageCount; ++idx) {
+    const auto& stage = config.tevStages[idx];
+    {
+      const auto color_arg = [&](GXTevColorArg arg) {
+        auto value = color_arg_reg(arg, idx, config, stage);
+        if (tev_color_arg_is_normalized(arg, colorNormalized, alphaNormalized)) {
+          return fmt::format("vec3f({})", value);
+        }
+        return fmt::format("tev_overflow_vec3f({})", value);
+      };
+      std::string_view outReg = regName[stage.colorOp.outReg];
+      std::string op = tev_color_op(stage.colorOp.op, tev_bias(stage.colorOp.bias), tev_scale(stage.colorOp.scale),
+                                    stage.colorOp.clamp, color_arg(stage.colorPass.a), color_arg(stage.colorPass.b),
+                                    color_arg(stage.colorPass.c), color_arg_reg(stage.colorPass.d, idx, config, stage));
+      fragmentFn += fmt::format("\n    // TEV stage {2}\n    {0} = vec4f({1}, {0}.a);", outReg, op, idx);
+      colorNormalized[stage.colorOp.outReg] = stage.colorOp.clamp;
+    }
+    {
+      const auto alpha_arg = [&](GXTevAlphaArg arg) {
+        auto value = alpha_arg_reg(arg, idx, config, stage);
+        if (tev_alpha_arg_is_normalized(arg, alphaNormalized)) {
+          return value;
+        }
+        return fmt::format("tev_overflow_f32({})", value);
+      };
+      std::string_view outReg = regName[stage.alphaOp.outReg];
+      std::string op = tev_alpha_op(stage.alphaOp.op, tev_bias(stage.alphaOp.bias), tev_scale(stage.alphaOp.scale),
+                                    stage.alphaOp.clamp, alpha_arg(stage.alphaPass.a), alpha_arg(stage.alphaPass.b),
+                                    alpha_arg(stage.alphaPass.c), alpha_arg_reg(stage.alphaPass.d, idx, config, stage));
+      fragmentFn += fmt::format("\n    {0}.a = {1};", outReg, op);
+      alphaNormalized[stage.alphaOp.outReg] = stage.alphaOp.clamp;
+    }
+  }
 
-fn fetch_u16_3(p: ptr<storage, array<u32>>, byte_off: u32, frac: u32, le: bool) -> vec3f {{
-  let v = raw_fetch_u16_3(p, byte_off, le);
-  return vec3f(v) / f32(1u << frac);
-}}
+  const auto& lastStage = config.tevStages[config.tevStageCount - 1];
+  const bool prevColorNormalized = colorNormalized[lastStage.colorOp.outReg];
+  const bool prevAlphaNormalized = alphaNormalized[lastStage.alphaOp.outReg];
+  if (lastStage.colorOp.outReg != 0) {
+    fragmentFn += fmt::format("\n    prev = vec4f({0}.rgb, prev.a);", regName[lastStage.colorOp.outReg]);
+  }
+  if (lastStage.alphaOp.outReg != 0) {
+    fragmentFn += fmt::format("\n    prev.a = {0}.a;", regName[lastStage.alphaOp.outReg]);
+  }
 
-fn fetch_s16_3(p: ptr<storage, array<u32>>, byte_off: u32, frac: u32, le: bool) -> vec3f {{
-  let v = (bitcast<vec3i>(raw_fetch_u16_3(p, byte_off, le)) << vec3u(16u)) >> vec3u(16u);
-  return vec3f(v) / f32(1u << frac);
-}}
+  if (info.loadsTevReg.test(0)) {
+    uniBufAttrs += "\n    tevprev: vec4f,";
+    fragmentFnPre += "\n    var prev = ubuf.tevprev;";
+  } else {
+    fragmentFnPre += "\n    var prev: vec4f;";
+  }
+  for (int i = 1 /* Skip TEVPREV */; i < info.loadsTevReg.size(); ++i) {
+    if (info.loadsTevReg.test(i)) {
+      uniBufAttrs += fmt::format("\n    tevreg{}: vec4f,", i - 1);
+      fragmentFnPre += fmt::format("\n    var tevreg{0} = ubuf.tevreg{0};", i - 1);
+    } else if (info.writesTevReg.test(i)) {
+      fragmentFnPre += fmt::format("\n    var tevreg{0}: vec4f;", i - 1);
+    }
+  }
 
-fn fetch_u16_4(p: ptr<storage, array<u32>>, byte_off: u32, frac: u32, le: bool) -> vec4f {{
-  let v = raw_fetch_u16_4(p, byte_off, le);
-  return vec4f(v) / f32(1u << frac);
-}}
+  if (info.lightingEnabled) {
+    uniBufAttrs += fmt::format(FMT_STRING(R"""(
+    lights: array<Light, {}>,
+    lightState0: u32,
+    lightState1: u32,
+    lightState0a: u32,
+    lightState1a: u32,)"""),
+                               GX::MaxLights);
+    uniformPre +=
+        "\n"
+        "struct Light {\n"
+        "    pos: vec3f,\n"
+        "    dir: vec3f,\n"
+        "    color: vec4f,\n"
+        "    cos_att: vec3f,\n"
+        "    dist_att: vec3f,\n"
+        "};";
+    if (UsePerPixelLighting) {
+      vtxOutAttrs += fmt::format("\n    @location({}) mv_pos: vec3f,", vtxOutIdx++);
+      vtxOutAttrs += fmt::format("\n    @location({}) mv_nrm: vec3f,", vtxOutIdx++);
+      vtxXfrAttrs += fmt::format(FMT_STRING(R"""(
+    out.mv_pos = mv_pos;
+    out.mv_nrm = mv_nrm;)"""));
+    }
+  }
 
-fn fetch_s16_4(p: ptr<storage, array<u32>>, byte_off: u32, frac: u32, le: bool) -> vec4f {{
-  let v = (bitcast<vec4i>(raw_fetch_u16_4(p, byte_off, le)) << vec4u(16u)) >> vec4u(16u);
-  return vec4f(v) / f32(1u << frac);
-}}
+  for (int i = 0; i < info.sampledColorChannels.size(); ++i) {
+    if (!info.sampledColorChannels.test(i)) {
+      continue;
+    }
 
-fn fetch_f32_1(p: ptr<storage, array<u32>>, byte_off: u32, le: bool) -> f32 {{
-  return raw_fetch_f32_1(p, byte_off, le);
-}}
+    const auto& cc = config.colorChannels[i];
+    const auto& cca = config.colorChannels[i + GX_ALPHA0];
+    if (cc.lightingEnabled && cc.ambSrc == GX_SRC_REG) {
+      uniBufAttrs += fmt::format("\n    cc{0}_amb: vec4f,", i);
+    }
+    if (cc.matSrc == GX_SRC_REG) {
+      uniBufAttrs += fmt::format("\n    cc{0}_mat: vec4f,", i);
+    }
+    if (cca.lightingEnabled && cca.ambSrc == GX_SRC_REG) {
+      uniBufAttrs += fmt::format("\n    cc{0}a_amb: vec4f,", i);
+    }
+    if (cca.matSrc == GX_SRC_REG) {
+      uniBufAttrs += fmt::format("\n    cc{0}a_mat: vec4f,", i);
+    }
 
-fn fetch_f32_2(p: ptr<storage, array<u32>>, byte_off: u32, le: bool) -> vec2f {{
-  return raw_fetch_f32_2(p, byte_off, le);
-}}
+    // Output vertex color if necessary
+    if (UsePerPixelLighting) {
+      if ((cc.lightingEnabled && cc.ambSrc == GX_SRC_VTX) || cc.matSrc == GX_SRC_VTX ||
+          (cca.lightingEnabled && cca.ambSrc == GX_SRC_VTX) || cca.matSrc == GX_SRC_VTX) {
+        vtxOutAttrs += fmt::format("\n    @location({}) clr{}: vec4f,", vtxOutIdx++, i);
+        vtxXfrAttrs += fmt::format("\n    out.clr{} = {};", i, vtx_attr(config, static_cast<GXAttr>(GX_VA_CLR0 + i)));
+      }
+    }
 
-fn fetch_f32_3(p: ptr<storage, array<u32>>, byte_off: u32, le: bool) -> vec3f {{
-  return raw_fetch_f32_3(p, byte_off, le);
-}}
+    if (UsePerPixelLighting) {
+      fragmentFnPre += fmt::format("\n    var rast{}: vec4f;", i);
+      fragmentFnPre += lighting_func(config, cc, i, false);
+      fragmentFnPre += lighting_func(config, cca, i, true);
+    } else {
+      vtxOutAttrs += fmt::format("\n    @location({}) cc{}: vec4f,", vtxOutIdx++, i);
+      vtxXfrAttrs += lighting_func(config, cc, i, false);
+      vtxXfrAttrs += lighting_func(config, cca, i, true);
+      fragmentFnPre += fmt::format("\n    var rast{0} = in.cc{0};", i);
+    }
+  }
+  for (int i = 0; i < info.sampledKColors.size(); ++i) {
+    if (info.sampledKColors.test(i)) {
+      uniBufAttrs += fmt::format("\n    kcolor{}: vec4f,", i);
+    }
+  }
+  for (int i = 0; i < info.sampledTexCoords.size(); ++i) {
+    if (!info.sampledTexCoords.test(i)) {
+      continue;
+    }
+    const auto& tcg = config.tcgs[i];
+    if (tcg.type == GX_TG_MTX3x4) {
+      vtxOutAttrs += fmt::format("\n    @location({}) tex{}_uvw: vec3f,", vtxOutIdx++, i);
+    } else {
+      vtxOutAttrs += fmt::format("\n    @location({}) tex{}_uv: vec2f,", vtxOutIdx++, i);
+    }
+    if (is_emboss_texgen(tcg.type)) {
+      // Emboss bump: offset the source texcoord by the light projected onto tangent/binormal
+      const u32 lightIdx = tcg.type - GX_TG_BUMP0;
+      vtxXfrAttrs += fmt::format(
+          "\n    let bump_ldir{0} = normalize(ubuf.lights[{1}].pos - mv_pos);"
+          "\n    let bump_tan{0} = vec4f(in_tangent, 0.0) * {3};"
+          "\n    let bump_bin{0} = vec4f(in_binrm, 0.0) * {3};"
+          "\n    out.tex{0}_uv = tc{2}_proj.xy + vec2f(dot(bump_ldir{0}, bump_tan{0}), dot(bump_ldir{0}, "
+          "bump_bin{0}));",
+          i, lightIdx, tcg.embossSrc, nrmMtx);
+      fragmentFnPre += fmt::format("\n    var tex{0}_uv = in.tex{0}_uv.xy;", i);
+      continue;
+    }
+    if (tcg.src >= GX_TG_TEX0 && tcg.src <= GX_TG_TEX7) {
+      vtxXfrAttrs += fmt::format("\n    var tc{} = vec4f({}, 1.0, 1.0);", i,
+                                 vtx_attr(config, GXAttr(GX_VA_TEX0 + (tcg.src - GX_TG_TEX0))));
+    } else if (tcg.src == GX_TG_POS) {
+      vtxXfrAttrs += fmt::format("\n    var tc{} = vec4f({}, 1.0);", i, vtx_attr(config, GX_VA_POS));
+    } else if (tcg.src == GX_TG_NRM) {
+      vtxXfrAttrs += fmt::format("\n    var tc{} = vec4f({}, 1.0);", i, vtx_attr(config, GX_VA_NRM));
+    } else if (tcg.src == GX_TG_COLOR0) {
+      vtxXfrAttrs += fmt::format("\n    var tc{} = {};", i, vtx_attr(config, GX_VA_CLR0));
+    } else if (tcg.src == GX_TG_COLOR1) {
+      vtxXfrAttrs += fmt::format("\n    var tc{} = {};", i, vtx_attr(config, GX_VA_CLR1));
+    } else if (tcg.src == GX_TG_BINRM) {
+      vtxXfrAttrs += fmt::format("\n    var tc{} = vec4f({}, 1.0);", i, nbt_slice_local(NbtSlice::B));
+    } else if (tcg.src == GX_TG_TANGENT) {
+      vtxXfrAttrs += fmt::format("\n    var tc{} = vec4f({}, 1.0);", i, nbt_slice_local(NbtSlice::T));
+    } else
+      UNLIKELY FATAL("unhandled tcg src {}", underlying(tcg.src));
+    if (tcg.type == GX_TG_MTX2x4 || tcg.type == GX_TG_MTX3x4) {
+      if (info.indexAttr.test(GX_VA_TEX0MTXIDX + i)) {
+        vtxXfrAttrs += fmt::format("\n    var tc{0}_tmp = tc{0} * ubuf.postex_mtx[in_texmtxidx{0} / 3u];", i);
+      } else if (tcg.mtx == GX_IDENTITY) {
+        vtxXfrAttrs += fmt::format("\n    var tc{0}_tmp = tc{0}.xyz;", i);
+      } else {
+        u32 texMtxIdx = (tcg.mtx) / 3;
+        vtxXfrAttrs += fmt::format("\n    var tc{0}_tmp = tc{0} * ubuf.postex_mtx[{1}];", i, texMtxIdx);
+      }
+      if (tcg.type == GX_TG_MTX2x4) {
+        vtxXfrAttrs += fmt::format("\n    tc{0}_tmp.z = 1.0f;", i);
+      }
+    } else if (tcg.type == GX_TG_SRTG) {
+      vtxXfrAttrs += fmt::format("\n    var tc{0}_tmp = vec3f(tc{0}.xy, 1.0f);", i);
+    }
+    if (tcg.normalize) {
+      vtxXfrAttrs += fmt::format("\n    tc{0}_tmp = normalize(tc{0}_tmp);", i);
+    }
+    if (tcg.postMtx == GX_PTIDENTITY) {
+      vtxXfrAttrs += fmt::format("\n    var tc{0}_proj = tc{0}_tmp;", i);
+    } else {
+      u32 postMtxIdx = (tcg.postMtx - GX_PTTEXMTX0) / 3;
+      vtxXfrAttrs +=
+          fmt::format("\n    var tc{0}_proj = vec4f(tc{0}_tmp.xyz, 1.0) * ubuf.postmtx[{1}];", i, postMtxIdx);
+    }
+    // Apply line/point tex offset
+    if (config.lineMode == 3) {
+      // GX_POINTS: offset S for right columns, T for bottom rows
+      vtxXfrAttrs += fmt::format(
+          "\n    if ((ubuf.line_texcoord_mask & (1u << {0})) != 0u) {{"
+          "\n        if ((vidx & 1u) != 0u) {{ tc{0}_proj.x += ubuf.line_tex_offset; }}"
+          "\n        if (vidx >= 2u) {{ tc{0}_proj.y += ubuf.line_tex_offset; }}"
+          "\n    }}",
+          i);
+    } else if (config.lineMode != 0) {
+      // GX_LINES / GX_LINESTRIP: offset one axis for perpendicular side
+      vtxXfrAttrs += fmt::format(
+          "\n    if ((ubuf.line_texcoord_mask & (1u << {0})) != 0u && (vidx & 1u) != 0u) {{"
+          "\n        tc{0}_proj.y += ubuf.line_tex_offset;"
+          "\n    }}",
+          i);
+    }
+    if (tcg.type == GX_TG_MTX3x4) {
+      vtxXfrAttrs += fmt::format("\n    out.tex{0}_uvw = tc{0}_proj.xyz;", i);
+      fragmentFnPre += fmt::format("\n    var tex{0}_uv = in.tex{0}_uvw.xy / in.tex{0}_uvw.z;", i);
+    } else {
+      vtxXfrAttrs += fmt::format("\n    out.tex{0}_uv = tc{0}_proj.xy;", i);
+      fragmentFnPre += fmt::format("\n    var tex{0}_uv = in.tex{0}_uv.xy;", i);
+    }
+  }
+  // Multiple TEV stages may reference the same indirect stage,
+  // so we sample each indirect texture only once.
+  const auto ind_scale = [](const GXIndTexScale s) -> std::string_view {
+    switch (s) {
+    case GX_ITS_1:
+      return "1.0"sv;
+    case GX_ITS_2:
+      return "(1.0 / 2.0)"sv;
+    case GX_ITS_4:
+      return "(1.0 / 4.0)"sv;
+    case GX_ITS_8:
+      return "(1.0 / 8.0)"sv;
+    case GX_ITS_16:
+      return "(1.0 / 16.0)"sv;
+    case GX_ITS_32:
+      return "(1.0 / 32.0)"sv;
+    case GX_ITS_64:
+      return "(1.0 / 64.0)"sv;
+    case GX_ITS_128:
+      return "(1.0 / 128.0)"sv;
+    case GX_ITS_256:
+      return "(1.0 / 256.0)"sv;
+    default:
+      FATAL("unhandled indirect scale {}", underlying(s));
+    }
+  };
+  for (int i = 0; i < info.usedIndStages.size(); ++i) {
+    if (!info.usedIndStages.test(i)) {
+      continue;
+    }
+    const auto& indStage = config.indStages[i];
+    const u32 texCoordId = underlying(indStage.texCoordId);
+    const u32 texMapId = underlying(indStage.texMapId);
+    // GX applies the SU texture-coordinate scale before the indirect stage scale.
+    // The shader carries normalized UVs, so convert that texel-space result back
+    // into normalized coordinates for the indirect texture sample.
+    const auto scaleExpr =
+        fmt::format("tex{0}_uv * ubuf.texcoord_scale[{0}].xy * vec2f({1}, {2}) / ubuf.tex{3}_size_bias.xy", texCoordId,
+                    ind_scale(indStage.scaleS), ind_scale(indStage.scaleT), texMapId);
+    fragmentFnPre += fmt::format(
+        "\n    // Indirect stage {0}"
+        "\n    var t_IndTexCoord{0} = 255.0 * textureSampleBias(tex{1}, tex{1}_samp, {2}, "
+        "ubuf.tex{1}_size_bias.z).abg;",
+        i, texMapId, scaleExpr);
+  }
+  if (info.usedIndStages.any()) {
+    fragmentFnPre += "\n    var t_TexCoord = vec2f(0.0);";
+  }
+  for (int i = 0; i < config.tevStageCount; ++i) {
+    const auto& stage = config.tevStages[i];
+    const bool needsIndirectCoord = stage.indTexMtxId != GX_ITM_OFF;
+    const bool hasIndirectStage = stage.indTexStage < config.numIndStages;
+    const bool needsTevTexCoord =
+        needsIndirectCoord || stage.indTexWrapS != GX_ITW_OFF || stage.indTexWrapT != GX_ITW_OFF || stage.indTexAddPrev;
+    const bool needsTextureSample = uses_texture_sample(stage);
+    if (!needsTevTexCoord && !needsTextureSample) {
+      continue;
+    }
+    const bool hasBaseTexCoord = stage.texCoordId != GX_TEXCOORD_NULL;
+    const bool hasBaseTexture = stage.texMapId != GX_TEXMAP_NULL;
+    const bool hasBaseCoord = hasBaseTexCoord && hasBaseTexture;
+    std::string uvIn;
+    if (needsTevTexCoord) {
+      fragmentFnPre += fmt::format("\n    // TEV stage {} indirect", i);
 
-fn fetch_f32_4(p: ptr<storage, array<u32>>, byte_off: u32, le: bool) -> vec4f {{
-  return raw_fetch_f32_4(p, byte_off, le);
-}}
+      // Apply indirect texture matrix (produces a texel-space offset)
+      std::string indirectOffsetTexel;
+      if (needsIndirectCoord && hasIndirectStage) {
+        std::string_view fmtShift;
+        switch (stage.indTexFormat) {
+        case GX_ITF_8:
+          break;
+        case GX_ITF_5:
+          fmtShift = " / 8.0"sv;
+          break;
+        case GX_ITF_4:
+          fmtShift = " / 16.0"sv;
+          break;
+        case GX_ITF_3:
+          fmtShift = " / 32.0"sv;
+          break;
+        default:
+          FATAL("unhandled indirect format {}", underlying(stage.indTexFormat));
+        }
+        if (fmtShift.empty()) {
+          fragmentFnPre += fmt::format("\n    var ind{0}_coord = t_IndTexCoord{1};", i, underlying(stage.indTexStage));
+        } else {
+          fragmentFnPre += fmt::format("\n    var ind{0}_coord = floor(t_IndTexCoord{1}{2});", i,
+                                       underlying(stage.indTexStage), fmtShift);
+        }
 
-fn fetch_rgb565(p: ptr<storage, array<u32>>, byte_off: u32, le: bool) -> vec4f {{
-  let v = load_u16(p, byte_off, le);
-  return vec4f(
-    f32((v >> 11u) & 0x1Fu) / f32(0x1Fu),
-    f32((v >>  5u) & 0x3Fu) / f32(0x3Fu),
-    f32((v >>  0u) & 0x1Fu) / f32(0x1Fu),
-    1.0,
-  );
-}}
+        if (stage.indTexBiasSel != GX_ITB_NONE) {
+          auto bias = stage.indTexFormat == GX_ITF_8 ? "-128.0"sv : "1.0"sv;
+          auto biasS = "0.0"sv, biasT = "0.0"sv, biasU = "0.0"sv;
+          if (stage.indTexBiasSel == GX_ITB_S || stage.indTexBiasSel == GX_ITB_ST || stage.indTexBiasSel == GX_ITB_SU ||
+              stage.indTexBiasSel == GX_ITB_STU) {
+            biasS = "1.0"sv;
+          }
+          if (stage.indTexBiasSel == GX_ITB_T || stage.indTexBiasSel == GX_ITB_ST || stage.indTexBiasSel == GX_ITB_TU ||
+              stage.indTexBiasSel == GX_ITB_STU) {
+            biasT = "1.0"sv;
+          }
+          if (stage.indTexBiasSel == GX_ITB_U || stage.indTexBiasSel == GX_ITB_SU || stage.indTexBiasSel == GX_ITB_TU ||
+              stage.indTexBiasSel == GX_ITB_STU) {
+            biasU = "1.0"sv;
+          }
+          fragmentFnPre += fmt::format("\n    ind{0}_coord = ind{0}_coord + vec3f({1}, {2}, {3}) * {4};", i, biasS,
+                                       biasT, biasU, bias);
+        }
 
-fn fetch_rgb8(p: ptr<storage, array<u32>>, byte_off: u32, le: bool) -> vec4f {{
-  let v = raw_fetch_u8_3(p, byte_off);
-  return vec4f(f32(v.x), f32(v.y), f32(v.z), 255.0) / 255.0;
-}}
+        if (stage.indTexMtxId >= GX_ITM_0 && stage.indTexMtxId <= GX_ITM_2) {
+          // Static 2x3 matrix: dot(mat_row, vec3(S,T,U)) * scale
+          u32 mtxIdx = stage.indTexMtxId - GX_ITM_0;
+          fragmentFnPre += fmt::format(
+              "\n    let ind{0}_c0 = ubuf.ind_mtx[{1}][0];"
+              "\n    let ind{0}_c1 = ubuf.ind_mtx[{1}][1];",
+              i, mtxIdx);
+          indirectOffsetTexel = fmt::format(
+              "vec2f("
+              "dot(vec3f(ind{0}_c0.xz, ind{0}_c1.x), ind{0}_coord), "
+              "dot(vec3f(ind{0}_c0.yw, ind{0}_c1.y), ind{0}_coord)"
+              ") * ind{0}_c1.z",
+              i);
+        } else if (stage.indTexMtxId >= GX_ITM_S0 && stage.indTexMtxId <= GX_ITM_S2 && hasBaseCoord) {
+          // Dynamic S: result = scaled texcoord * ind_coord.x * scale / 256
+          u32 mtxIdx = stage.indTexMtxId - GX_ITM_S0;
+          u32 regTexCoord = underlying(stage.texCoordId);
+          indirectOffsetTexel = fmt::format(
+              "tex{1}_uv * ubuf.texcoord_scale[{1}].xy * ind{0}_coord.x"
+              " * ubuf.ind_mtx[{2}][1][2] / 256.0",
+              i, regTexCoord, mtxIdx);
+        } else if (stage.indTexMtxId >= GX_ITM_T0 && stage.indTexMtxId <= GX_ITM_T2 && hasBaseCoord) {
+          // Dynamic T: result = scaled texcoord * ind_coord.y * scale / 256
+          u32 mtxIdx = stage.indTexMtxId - GX_ITM_T0;
+          u32 regTexCoord = underlying(stage.texCoordId);
+          indirectOffsetTexel = fmt::format(
+              "tex{1}_uv * ubuf.texcoord_scale[{1}].xy * ind{0}_coord.y"
+              " * ubuf.ind_mtx[{2}][1][2] / 256.0",
+              i, regTexCoord, mtxIdx);
+        }
+      }
 
-fn fetch_rgbx8(p: ptr<storage, array<u32>>, byte_off: u32, le: bool) -> vec4f {{
-  let v = raw_fetch_u8_4(p, byte_off);
-  return vec4f(f32(v.x), f32(v.y), f32(v.z), 255.0) / 255.0;
-}}
+      // Don't convert to/from texel space if we can avoid it
+      const bool useSimpleCoords = stage.indTexMtxId == GX_ITM_OFF && !stage.indTexAddPrev;
 
-fn fetch_rgba4(p: ptr<storage, array<u32>>, byte_off: u32, le: bool) -> vec4f {{
-  let v = load_u16(p, byte_off, le);
-  return vec4f(
-    f32((v >> 12u) & 0x0Fu) / f32(0x0Fu),
-    f32((v >>  8u) & 0x0Fu) / f32(0x0Fu),
-    f32((v >>  4u) & 0x0Fu) / f32(0x0Fu),
-    f32((v >>  0u) & 0x0Fu) / f32(0x0Fu),
-  );
-}}
+      // Wrap base coord and combine with the indirect translation.
+      auto wrap_comp = [](GXIndTexWrap wrap, std::string&& coord) -> std::string {
+        switch (wrap) {
+        case GX_ITW_OFF:
+          return std::move(coord);
+        case GX_ITW_256:
+          return fmt::format("({} % 256.0)", coord);
+        case GX_ITW_128:
+          return fmt::format("({} % 128.0)", coord);
+        case GX_ITW_64:
+          return fmt::format("({} % 64.0)", coord);
+        case GX_ITW_32:
+          return fmt::format("({} % 32.0)", coord);
+        case GX_ITW_16:
+          return fmt::format("({} % 16.0)", coord);
+        case GX_ITW_0:
+          return "0.0";
+        default:
+          FATAL("unhandled indirect wrap {}", underlying(wrap));
+        }
+      };
+      std::string baseCoordExpr;
+      if (hasBaseCoord) {
+        u32 texCoordId = underlying(stage.texCoordId);
+        if (useSimpleCoords) {
+          baseCoordExpr = fmt::format("tex{}_uv", texCoordId);
+        } else {
+          fragmentFnPre +=
+              fmt::format("\n    var ind{0}_texel = tex{1}_uv * ubuf.texcoord_scale[{1}].xy;", i, texCoordId);
+          baseCoordExpr = fmt::format("ind{}_texel", i);
+        }
+      }
+      std::string wrappedExpr = baseCoordExpr;
+      if (!baseCoordExpr.empty() && (stage.indTexWrapS != GX_ITW_OFF || stage.indTexWrapT != GX_ITW_OFF)) {
+        wrappedExpr = fmt::format("vec2f({}, {})", wrap_comp(stage.indTexWrapS, fmt::format("{}.x", baseCoordExpr)),
+                                  wrap_comp(stage.indTexWrapT, fmt::format("{}.y", baseCoordExpr)));
+      }
 
-fn fetch_rgba6(p: ptr<storage, array<u32>>, byte_off: u32, le: bool) -> vec4f {{
-  let v = load_u24(p, byte_off, le);
-  return vec4f(
-    f32((v >> 18u) & 0x3Fu) / f32(0x3Fu),
-    f32((v >> 12u) & 0x3Fu) / f32(0x3Fu),
-    f32((v >>  6u) & 0x3Fu) / f32(0x3Fu),
-    f32((v >>  0u) & 0x3Fu) / f32(0x3Fu),
-  );
-}}
+      std::string finalCoord;
+      if (!wrappedExpr.empty() && !indirectOffsetTexel.empty()) {
+        finalCoord = fmt::format("{} + ({})", wrappedExpr, indirectOffsetTexel);
+      } else if (!wrappedExpr.empty()) {
+        finalCoord = wrappedExpr;
+      } else {
+        finalCoord = indirectOffsetTexel;
+      }
 
-fn fetch_rgba8(p: ptr<storage, array<u32>>, byte_off: u32, le: bool) -> vec4f {{
-  let v = raw_fetch_u8_4(p, byte_off);
-  return vec4f(v) / 255.0;
-}}
+      if (info.usedIndStages.any() && !finalCoord.empty()) {
+        if (stage.indTexAddPrev) {
+          fragmentFnPre += fmt::format("\n    t_TexCoord += {};", finalCoord);
+        } else {
+          fragmentFnPre += fmt::format("\n    t_TexCoord = {};", finalCoord);
+        }
 
-fn tev_overflow_f32(in: f32) -> f32 {{
-  let byte_space = in * 255.0;
-  return (byte_space - floor(byte_space / 256.0) * 256.0) / 255.0;
-}}
+        if (needsTextureSample && hasBaseTexture) {
+          u32 texMapId = underlying(stage.texMapId);
+          if (useSimpleCoords) {
+            fragmentFnPre += fmt::format("\n    var ind{0}_uv = t_TexCoord;", i);
+          } else {
+            fragmentFnPre += fmt::format("\n    var ind{0}_uv = t_TexCoord / ubuf.tex{1}_size_bias.xy;", i, texMapId);
+          }
+          uvIn = fmt::format("ind{0}_uv", i);
+        }
+      }
+    }
+    if (!needsTextureSample) {
+      continue;
+    }
 
-fn tev_overflow_vec3f(in: vec3f) -> vec3f {{
-  let byte_space = in * 255.0;
-  return (byte_space - floor(byte_space / 256.0) * 256.0) / 255.0;
-}}
+    CHECK(stage.texMapId != GX_TEXMAP_NULL, "unmapped texture for stage {}", i);
+    CHECK(stage.texCoordId != GX_TEXCOORD_NULL, "unmapped texcoord for stage {}", i);
+    if (uvIn.empty()) {
+      // No indirect texturing
+      uvIn = fmt::format("tex{0}_uv", underlying(stage.texCoordId));
+    }
+    fragmentFnPre +=
+        fmt::format("\n    var sampled{0} = textureSampleBias(tex{1}, tex{1}_samp, {2}, ubuf.tex{1}_size_bias.z);", i,
+                    underlying(stage.texMapId), uvIn);
+  }
+  if (info.usesPTTexMtx.any()) {
+    uniBufAttrs += fmt::format("\n    postmtx: array<mat3x4f, {}>,", MaxPTTexMtx);
+  }
+  if (info.usesFog) {
+    uniformPre +=
+        "\n"
+        "struct Fog {\n"
+        "    color: vec4f,\n"
+        "    a: f32,\n"
+        "    b: f32,\n"
+        "    c: f32,\n"
+        "    range_center: f32,\n"
+        "    range_k: array<vec4f, 3>,\n"
+        "}";
+    uniBufAttrs += "\n    fog: Fog,";
 
-fn tev_overflow_vec4f(in: vec4f) -> vec4f {{
-  let byte_space = in * 255.0;
-  return (byte_space - floor(byte_space / 256.0) * 256.0) / 255.0;
-}}
+    const std::string_view fogDepth = UseReversedZ ? "(1.0 - in.pos.z)" : "in.pos.z";
+    if ((config.fogType & 0x08) != 0) {
+      fragmentFn += fmt::format("\n    // Orthographic fog\n    var fogBase = ubuf.fog.a * {};", fogDepth);
+    } else {
+      fragmentFn +=
+          fmt::format("\n    // Perspective fog\n    var fogBase = ubuf.fog.a / (ubuf.fog.b - {});", fogDepth);
+    }
+    if (config.fogRangeEnabled) {
+      fragmentFn += "\n        fogBase *= bitcast<f32>(abuf[imm.fog_range_base + u32(in.pos.x)]);";
+    }
+    fragmentFn += "\n    var fogF = clamp(fogBase - ubuf.fog.c, 0.0, 1.0);";
+    switch (config.fogType) {
+      DEFAULT_FATAL("invalid fog type {}", config.fogType);
+    case GX_FOG_PERSP_LIN:
+    case GX_FOG_ORTHO_LIN:
+      fragmentFn += "\n    var fogZ = fogF;";
+      break;
+    case GX_FOG_PERSP_EXP:
+    case GX_FOG_ORTHO_EXP:
+      fragmentFn += "\n    var fogZ = 1.0 - exp2(-8.0 * fogF);";
+      break;
+    case GX_FOG_PERSP_EXP2:
+    case GX_FOG_ORTHO_EXP2:
+      fragmentFn += "\n    var fogZ = 1.0 - exp2(-8.0 * fogF * fogF);";
+      break;
+    case GX_FOG_PERSP_REVEXP:
+    case GX_FOG_ORTHO_REVEXP:
+      fragmentFn += "\n    var fogZ = exp2(-8.0 * (1.0 - fogF));";
+      break;
+    case GX_FOG_PERSP_REVEXP2:
+    case GX_FOG_ORTHO_REVEXP2:
+      fragmentFn +=
+          "\n    fogF = 1.0 - fogF;"
+          "\n    var fogZ = exp2(-8.0 * fogF * fogF);";
+      break;
+    }
+    fragmentFn += "\n    prev = vec4f(mix(prev.rgb, ubuf.fog.color.rgb, clamp(fogZ, 0.0, 1.0)), prev.a);";
+  }
+  uniBufAttrs += fmt::format("\n    texcoord_scale: array<vec4f, {}>,", MaxTexCoord);
+  if (info.usedIndTexMtxs.any()) {
+    uniBufAttrs += fmt::format("\n    ind_mtx: array<mat2x4f, {}>,", MaxIndTexMtxs);
+  }
+  for (int i = 0; i < info.sampledTextures.size(); ++i) {
+    if (!info.sampledTextures.test(i)) {
+      continue;
+    }
+    uniBufAttrs += fmt::format("\n    tex{}_size_bias: vec4f,", i);
+    texBindings += fmt::format(
+        "\n@group(2) @binding({1})\n"
+        "var tex{0}: texture_2d<f32>;\n"
+        "@group(2) @binding({2})\n"
+        "var tex{0}_samp: sampler;",
+        i, i * 2, i * 2 + 1);
+  }
+  if (!prevColorNormalized && !prevAlphaNormalized) {
+    fragmentFn += "\n    prev = tev_overflow_vec4f(prev);";
+  } else if (!prevColorNormalized) {
+    fragmentFn += "\n    prev = vec4f(tev_overflow_vec3f(prev.rgb), prev.a);";
+  } else if (!prevAlphaNormalized) {
+    fragmentFn += "\n    prev.a = tev_overflow_f32(prev.a);";
+  }
+  if (config.alphaCompare) {
+    const auto comp0 = alpha_compare(config.alphaCompare.comp0, config.alphaCompare.ref0);
+    const auto comp1 = alpha_compare(config.alphaCompare.comp1, config.alphaCompare.ref1);
+    AlphaCompareExpr pass;
+    switch (config.alphaCompare.op) {
+      DEFAULT_FATAL("invalid alpha compare op {}", underlying(config.alphaCompare.op));
+    case GX_AOP_AND:
+      pass = alpha_compare_and(comp0, comp1);
+      break;
+    case GX_AOP_OR:
+      pass = alpha_compare_or(comp0, comp1);
+      break;
+    case GX_AOP_XOR:
+      pass = alpha_compare_xor(comp0, comp1);
+      break;
+    case GX_AOP_XNOR:
+      pass = alpha_compare_xnor(comp0, comp1);
+      break;
+    }
+    const auto discard = alpha_compare_not(pass);
+    if (discard.constant == 1) {
+      fragmentFn += "\n    // Alpha compare\n    discard;";
+    } else if (discard.constant != 0) {
+      fragmentFn +=
+          "\n    // Alpha compare"
+          "\n    let alphaCompare = u32(round(clamp(prev.a, 0.0, 1.0) * 255.0));";
+      fragmentFn += fmt::format("\n    if ({}) {{ discard; }}", discard.expr);
+    }
+  }
+  if constexpr (EnableNormalVisualization) {
+    fragmentFn += "\n    prev = vec4f(in.nrm, prev.a);";
+  }
 
+  const auto shaderSource = fmt::format(R"""({9}
 {8}
 
 struct Immediate {{
     vtx_start: u32,
     current_pnmtx: u32,
     fog_range_base: u32,
-    _pad: u32,
+    instance_base: u32,
     array_start0: vec4u,
     array_start1: vec4u,
     array_start2: vec4u,
@@ -1997,7 +2045,7 @@ fn fs_main(in: VertexOutput) -> @location(0) vec4f {{{6}{5}
 }}
 )""",
                                         uniBufAttrs, texBindings, vtxOutAttrs, vtxInAttrs, vtxXfrAttrs, fragmentFn,
-                                        fragmentFnPre, vtxXfrAttrsPre, uniformPre);
+                                        fragmentFnPre, vtxXfrAttrsPre, uniformPre, ShaderPrelude);
   if (EnableDebugPrints) {
     Log.info("Generated shader (hash {:x}): {}", hash, shaderSource);
   }
@@ -2019,3 +2067,656 @@ wgpu::ShaderModule build_shader(const ShaderConfig& config) noexcept {
   return webgpu::g_device.CreateShaderModule(&shaderDescriptor);
 }
 } // namespace aurora::gx
+
+namespace aurora::gx {
+namespace {
+static_assert(uber::HeaderWord == 0 && uber::AlphaCompareWord == 1 && uber::SwapTableWord == 2 &&
+                  uber::ColorChannelWord == 3 && uber::TexGenWord == 4 && uber::AttrWord == 12 &&
+                  uber::StageWord == 33 && uber::StageWords == 3 && uber::RasZero == 2,
+              "uber shader source hardcodes the packed config layout");
+static_assert(MaxPnMtx == 10 && MaxTexMtx == 10 && MaxPTTexMtx == 20 && MaxTevRegs == 4 && GX::MaxLights == 8 &&
+                  MaxTextures == 8 && MaxTexCoord == 8,
+              "uber shader source hardcodes the uniform layout");
+static_assert(GX_VA_TEX0MTXIDX == 1 && GX_VA_POS == 9 && GX_VA_NRM == 10 && GX_VA_CLR0 == 11 && GX_VA_TEX0 == 13);
+static_assert(GX_TG_TEX0 == 4 && GX_TG_COLOR0 == 19 && GX_TG_MTX2x4 == 1 && GX_TG_SRTG == 10 && GX_IDENTITY == 60 &&
+              GX_PTTEXMTX0 == 64 && GX_PTIDENTITY == 125);
+static_assert(GX_AF_SPEC == 0 && GX_AF_SPOT == 1 && GX_DF_SIGN == 1 && GX_DF_CLAMP == 2 && GX_SRC_VTX == 1);
+static_assert(GX_TEV_KCSEL_K0 == 0x0C && GX_TEV_KCSEL_K0_R == 0x10 && GX_TEV_KASEL_K0_R == 0x10);
+
+// Interprets uber::Config (read from abuf at imm.config_base) instead of specializing on it. Mirrors the generator
+// in build_shader_source for the subset accepted by uber::supported.
+constexpr std::string_view UberShaderSource = R"""(
+struct Light {
+    pos: vec3f,
+    dir: vec3f,
+    color: vec4f,
+    cos_att: vec3f,
+    dist_att: vec3f,
+};
+
+struct Fog {
+    color: vec4f,
+    a: f32,
+    b: f32,
+    c: f32,
+    range_center: f32,
+    range_k: array<vec4f, 3>,
+};
+
+struct Immediate {
+    vtx_start: u32,
+    current_pnmtx: u32,
+    fog_range_base: u32,
+    config_base: u32,
+    array_start0: vec4u,
+    array_start1: vec4u,
+    array_start2: vec4u,
+};
+var<immediate> imm: Immediate;
+
+struct Uniform {
+    render_viewport_size: vec2f,
+    logical_viewport_size: vec2f,
+    proj: mat4x4f,
+    postex_mtx: array<mat3x4f, 20>,
+    nrm_mtx: array<mat3x4f, 10>,
+    tevreg: array<vec4f, 4>,
+    lights: array<Light, 8>,
+    light_state: vec4u,
+    cc_amb: array<vec4f, 4>,
+    cc_mat: array<vec4f, 4>,
+    kcolor: array<vec4f, 4>,
+    postmtx: array<mat3x4f, 20>,
+    fog: Fog,
+    tex_size_bias: array<vec4f, 8>,
+};
+@group(0) @binding(0)
+var<storage, read> vbuf: array<u32>;
+@group(0) @binding(1)
+var<storage, read> abuf: array<u32>;
+@group(1) @binding(0)
+var<uniform> ubuf: Uniform;
+@group(2) @binding(0)
+var tex0: texture_2d<f32>;
+@group(2) @binding(1)
+var tex0_samp: sampler;
+@group(2) @binding(2)
+var tex1: texture_2d<f32>;
+@group(2) @binding(3)
+var tex1_samp: sampler;
+@group(2) @binding(4)
+var tex2: texture_2d<f32>;
+@group(2) @binding(5)
+var tex2_samp: sampler;
+@group(2) @binding(6)
+var tex3: texture_2d<f32>;
+@group(2) @binding(7)
+var tex3_samp: sampler;
+@group(2) @binding(8)
+var tex4: texture_2d<f32>;
+@group(2) @binding(9)
+var tex4_samp: sampler;
+@group(2) @binding(10)
+var tex5: texture_2d<f32>;
+@group(2) @binding(11)
+var tex5_samp: sampler;
+@group(2) @binding(12)
+var tex6: texture_2d<f32>;
+@group(2) @binding(13)
+var tex6_samp: sampler;
+@group(2) @binding(14)
+var tex7: texture_2d<f32>;
+@group(2) @binding(15)
+var tex7_samp: sampler;
+
+struct VertexOutput {
+    @builtin(position) pos: vec4f,
+    @location(0) cc0: vec4f,
+    @location(1) cc1: vec4f,
+    @location(2) tex0: vec3f,
+    @location(3) tex1: vec3f,
+    @location(4) tex2: vec3f,
+    @location(5) tex3: vec3f,
+    @location(6) tex4: vec3f,
+    @location(7) tex5: vec3f,
+    @location(8) tex6: vec3f,
+    @location(9) tex7: vec3f,
+};
+
+fn cfg(word: u32) -> u32 {
+  return abuf[imm.config_base + word];
+}
+
+fn attr_word(attr: u32) -> u32 {
+  return cfg(12u + attr);
+}
+
+fn array_start(attr: u32) -> u32 {
+  let idx = attr - 9u;
+  let starts = select(select(imm.array_start2, imm.array_start1, idx < 8u), imm.array_start0, idx < 4u);
+  return starts[idx % 4u];
+}
+
+struct AttrAddress {
+  offs: u32,
+  indexed: bool,
+  le: bool,
+};
+
+fn attr_address(attr: u32, vidx: u32) -> AttrAddress {
+  let word = attr_word(attr);
+  let attr_type = word & 3u;
+  let dl_offs = imm.vtx_start + vidx * (cfg(0u) & 0xFFu) + extractBits(word, 16u, 8u);
+  let stride = extractBits(word, 24u, 8u);
+  let le = extractBits(word, 14u, 1u) != 0u;
+  if (attr_type == 2u) {
+    return AttrAddress(array_start(attr) + load_u8(&vbuf, dl_offs) * stride, true, le);
+  }
+  if (attr_type == 3u) {
+    return AttrAddress(array_start(attr) + load_u16(&vbuf, dl_offs, false) * stride, true, le);
+  }
+  return AttrAddress(dl_offs, false, false);
+}
+
+fn uber_load_comp(p: ptr<storage, array<u32>>, offs: u32, comp_type: u32, frac: u32, le: bool) -> f32 {
+  switch comp_type {
+    case 0u: {
+      return f32(load_u8(p, offs)) / f32(1u << frac);
+    }
+    case 1u: {
+      return f32((bitcast<i32>(load_u8(p, offs)) << 24) >> 24) / f32(1u << frac);
+    }
+    case 2u: {
+      return f32(load_u16(p, offs, le)) / f32(1u << frac);
+    }
+    case 3u: {
+      return f32(bitcast<i32>(load_u16(p, offs, le) << 16u) >> 16) / f32(1u << frac);
+    }
+    default: {
+      return load_f32(p, offs, le);
+    }
+  }
+}
+
+fn uber_load_color(p: ptr<storage, array<u32>>, offs: u32, comp_type: u32, le: bool) -> vec4f {
+  switch comp_type {
+    case 0u: {
+      return fetch_rgb565(p, offs, le);
+    }
+    case 1u: {
+      return fetch_rgb8(p, offs, le);
+    }
+    case 2u: {
+      return fetch_rgbx8(p, offs, le);
+    }
+    case 3u: {
+      return fetch_rgba4(p, offs, le);
+    }
+    case 4u: {
+      return fetch_rgba6(p, offs, le);
+    }
+    default: {
+      return fetch_rgba8(p, offs, le);
+    }
+  }
+}
+
+// Generic attribute fetch; components beyond the attribute's count read as zero.
+fn fetch_attr(attr: u32, vidx: u32) -> vec4f {
+  let word = attr_word(attr);
+  if ((word & 3u) == 0u) {
+    return vec4f(0.0);
+  }
+  let addr = attr_address(attr, vidx);
+  let cnt = min(extractBits(word, 2u, 4u), 4u);
+  let comp_type = extractBits(word, 6u, 3u);
+  let frac = extractBits(word, 9u, 5u);
+  if (comp_type == 5u) {
+    if (addr.indexed) {
+      return unpack4x8unorm(load_u32_raw(&abuf, addr.offs));
+    }
+    return unpack4x8unorm(load_u32_raw(&vbuf, addr.offs));
+  }
+  let size = select(select(4u, 2u, comp_type < 4u), 1u, comp_type < 2u);
+  var v = vec4f(0.0);
+  for (var i = 0u; i < cnt; i++) {
+    if (addr.indexed) {
+      v[i] = uber_load_comp(&abuf, addr.offs + i * size, comp_type, frac, addr.le);
+    } else {
+      v[i] = uber_load_comp(&vbuf, addr.offs + i * size, comp_type, frac, addr.le);
+    }
+  }
+  return v;
+}
+
+fn fetch_color(attr: u32, vidx: u32) -> vec4f {
+  let word = attr_word(attr);
+  if ((word & 3u) == 0u) {
+    return vec4f(0.0);
+  }
+  let addr = attr_address(attr, vidx);
+  let comp_type = extractBits(word, 6u, 3u);
+  if (addr.indexed) {
+    return uber_load_color(&abuf, addr.offs, comp_type, addr.le);
+  }
+  return uber_load_color(&vbuf, addr.offs, comp_type, addr.le);
+}
+
+fn fetch_mtx_idx(attr: u32, vidx: u32) -> u32 {
+  let addr = attr_address(attr, vidx);
+  if (addr.indexed) {
+    return load_u8(&abuf, addr.offs);
+  }
+  return load_u8(&vbuf, addr.offs);
+}
+
+fn lit_channel(chan: u32, mv_pos: vec3f, mv_nrm: vec3f, vtx_clr: vec4f) -> vec4f {
+  let cc = extractBits(cfg(3u), chan * 8u, 8u);
+  let mat = select(ubuf.cc_mat[chan], vtx_clr, (cc & 1u) != 0u);
+  if ((cc & 0x40u) == 0u) {
+    return mat;
+  }
+  let amb = select(ubuf.cc_amb[chan], vtx_clr, (cc & 2u) != 0u);
+  let diff_fn = extractBits(cc, 2u, 2u);
+  let attn_fn = extractBits(cc, 4u, 2u);
+  var lighting = amb;
+  for (var i = 0u; i < 8u; i++) {
+    if ((ubuf.light_state[chan] & (1u << i)) == 0u) { continue; }
+    let light = ubuf.lights[i];
+    var ldir = light.pos - mv_pos;
+    let dist2 = dot(ldir, ldir);
+    let dist = sqrt(dist2);
+    ldir = ldir / dist;
+    var attn = 1.0;
+    if (attn_fn == 1u) {
+      let cosine = max(0.0, dot(ldir, light.dir));
+      let cos_attn = dot(light.cos_att, vec3f(1.0, cosine, cosine * cosine));
+      let dist_attn = dot(light.dist_att, vec3f(1.0, dist, dist2));
+      attn = max(0.0, cos_attn / dist_attn);
+    } else if (attn_fn == 0u) {
+      attn = select(0.0, max(0.0, dot(mv_nrm, light.dir)), dot(mv_nrm, ldir) >= 0.0);
+      let cos_attn = dot(light.cos_att, vec3f(1.0, attn, attn * attn));
+      let dist_att = select(light.dist_att, normalize(light.dist_att), diff_fn != 0u);
+      let dist_attn = max(0.0, dot(dist_att, vec3f(1.0, attn, attn * attn)));
+      attn = max(0.0, cos_attn / dist_attn);
+    }
+    var diff = 1.0;
+    if (diff_fn == 1u) {
+      diff = dot(ldir, mv_nrm);
+    } else if (diff_fn == 2u) {
+      diff = max(0.0, dot(ldir, mv_nrm));
+    }
+    lighting = lighting + (attn * diff * light.color);
+  }
+  return mat * clamp(lighting, vec4f(0.0), vec4f(1.0));
+}
+
+// Returns uvw; the fragment stage divides by w, which is 1 for everything but GX_TG_MTX3x4.
+fn texgen(i: u32, vidx: u32, pos: vec3f, nrm: vec3f, clr0: vec4f, clr1: vec4f) -> vec3f {
+  let word = cfg(4u + i);
+  let src = word & 0x1Fu;
+  if (src >= 21u) {
+    return vec3f(0.0, 0.0, 1.0);
+  }
+  let kind = extractBits(word, 5u, 4u);
+  let mtx = extractBits(word, 9u, 6u);
+  let post = extractBits(word, 15u, 7u);
+  var tc: vec4f;
+  if (src >= 4u && src <= 11u) {
+    tc = vec4f(fetch_attr(13u + src - 4u, vidx).xy, 1.0, 1.0);
+  } else if (src == 0u) {
+    tc = vec4f(pos, 1.0);
+  } else if (src == 1u) {
+    tc = vec4f(nrm, 1.0);
+  } else if (src == 19u) {
+    tc = clr0;
+  } else {
+    tc = clr1;
+  }
+  var tmp: vec3f;
+  if (kind == 10u) {
+    tmp = vec3f(tc.xy, 1.0);
+  } else {
+    if ((attr_word(1u + i) & 3u) != 0u) {
+      tmp = tc * ubuf.postex_mtx[fetch_mtx_idx(1u + i, vidx) / 3u];
+    } else if (mtx == 60u) {
+      tmp = tc.xyz;
+    } else {
+      tmp = tc * ubuf.postex_mtx[mtx / 3u];
+    }
+    if (kind == 1u) {
+      tmp.z = 1.0;
+    }
+  }
+  if (extractBits(word, 22u, 1u) != 0u) {
+    tmp = normalize(tmp);
+  }
+  var proj = tmp;
+  if (post != 125u) {
+    proj = vec4f(tmp, 1.0) * ubuf.postmtx[(post - 64u) / 3u];
+  }
+  if (kind != 0u) {
+    return vec3f(proj.xy, 1.0);
+  }
+  return proj;
+}
+
+@vertex
+fn vs_main(@builtin(vertex_index) vidx: u32) -> VertexOutput {
+    var out: VertexOutput;
+    var pnmtxidx = imm.current_pnmtx;
+    if ((attr_word(0u) & 3u) != 0u) {
+      pnmtxidx = fetch_mtx_idx(0u, vidx) / 3u;
+    }
+    let pos = fetch_attr(9u, vidx).xyz;
+    var nrm = vec3f(1.0, 0.0, 0.0);
+    if ((attr_word(10u) & 3u) != 0u) {
+      nrm = fetch_attr(10u, vidx).xyz;
+    }
+    let clr0 = fetch_color(11u, vidx);
+    let clr1 = fetch_color(12u, vidx);
+    let mv_pos = vec4f(pos, 1.0) * ubuf.postex_mtx[pnmtxidx];
+    out.pos = vec4f(mv_pos, 1.0) * ubuf.proj;
+    let nrm_tmp = vec4f(nrm, 0.0) * ubuf.nrm_mtx[pnmtxidx];
+    let mv_nrm = select(nrm_tmp, normalize(nrm_tmp), dot(nrm_tmp, nrm_tmp) > 1e-10);
+    out.cc0 = vec4f(lit_channel(0u, mv_pos, mv_nrm, clr0).rgb, lit_channel(2u, mv_pos, mv_nrm, clr0).a);
+    out.cc1 = vec4f(lit_channel(1u, mv_pos, mv_nrm, clr1).rgb, lit_channel(3u, mv_pos, mv_nrm, clr1).a);
+    out.tex0 = texgen(0u, vidx, pos, nrm, clr0, clr1);
+    out.tex1 = texgen(1u, vidx, pos, nrm, clr0, clr1);
+    out.tex2 = texgen(2u, vidx, pos, nrm, clr0, clr1);
+    out.tex3 = texgen(3u, vidx, pos, nrm, clr0, clr1);
+    out.tex4 = texgen(4u, vidx, pos, nrm, clr0, clr1);
+    out.tex5 = texgen(5u, vidx, pos, nrm, clr0, clr1);
+    out.tex6 = texgen(6u, vidx, pos, nrm, clr0, clr1);
+    out.tex7 = texgen(7u, vidx, pos, nrm, clr0, clr1);
+    return out;
+}
+
+fn frag_uv(in: VertexOutput, coord: u32) -> vec2f {
+  var t: vec3f;
+  switch coord {
+    case 0u: { t = in.tex0; }
+    case 1u: { t = in.tex1; }
+    case 2u: { t = in.tex2; }
+    case 3u: { t = in.tex3; }
+    case 4u: { t = in.tex4; }
+    case 5u: { t = in.tex5; }
+    case 6u: { t = in.tex6; }
+    default: { t = in.tex7; }
+  }
+  return t.xy / t.z;
+}
+
+fn sample_map(map: u32, uv: vec2f) -> vec4f {
+  switch map {
+    case 0u: { return textureSampleBias(tex0, tex0_samp, uv, ubuf.tex_size_bias[0].z); }
+    case 1u: { return textureSampleBias(tex1, tex1_samp, uv, ubuf.tex_size_bias[1].z); }
+    case 2u: { return textureSampleBias(tex2, tex2_samp, uv, ubuf.tex_size_bias[2].z); }
+    case 3u: { return textureSampleBias(tex3, tex3_samp, uv, ubuf.tex_size_bias[3].z); }
+    case 4u: { return textureSampleBias(tex4, tex4_samp, uv, ubuf.tex_size_bias[4].z); }
+    case 5u: { return textureSampleBias(tex5, tex5_samp, uv, ubuf.tex_size_bias[5].z); }
+    case 6u: { return textureSampleBias(tex6, tex6_samp, uv, ubuf.tex_size_bias[6].z); }
+    default: { return textureSampleBias(tex7, tex7_samp, uv, ubuf.tex_size_bias[7].z); }
+  }
+}
+
+fn tev_swap(v: vec4f, sel: u32) -> vec4f {
+  let e = extractBits(cfg(2u), sel * 8u, 8u);
+  return vec4f(v[e & 3u], v[extractBits(e, 2u, 2u)], v[extractBits(e, 4u, 2u)], v[extractBits(e, 6u, 2u)]);
+}
+
+fn konst_color(sel: u32) -> vec3f {
+  if (sel < 8u) {
+    return vec3f(f32(8u - sel) / 8.0);
+  }
+  if (sel < 0x10u) {
+    return ubuf.kcolor[sel - 0x0Cu].rgb;
+  }
+  let k = sel - 0x10u;
+  return vec3f(ubuf.kcolor[k % 4u][k / 4u]);
+}
+
+fn konst_alpha(sel: u32) -> f32 {
+  if (sel < 8u) {
+    return f32(8u - sel) / 8.0;
+  }
+  let k = sel - 0x10u;
+  return ubuf.kcolor[k % 4u][k / 4u];
+}
+
+struct TevState {
+  regs: array<vec4f, 4>,
+  color_norm: array<bool, 4>,
+  alpha_norm: array<bool, 4>,
+};
+
+fn tev_color_arg(arg: u32, normalize_arg: bool, st: TevState, tex: vec4f, ras: vec4f, konst: vec3f) -> vec3f {
+  if (arg < 8u) {
+    let reg = st.regs[arg / 2u];
+    let value = select(reg.rgb, vec3f(reg.a), (arg & 1u) != 0u);
+    let normalized = select(st.color_norm[arg / 2u], st.alpha_norm[arg / 2u], (arg & 1u) != 0u);
+    if (normalize_arg && !normalized) {
+      return tev_overflow_vec3f(value);
+    }
+    return value;
+  }
+  switch arg {
+    case 8u: { return tex.rgb; }
+    case 9u: { return vec3f(tex.a); }
+    case 10u: { return ras.rgb; }
+    case 11u: { return vec3f(ras.a); }
+    case 12u: { return vec3f(1.0); }
+    case 13u: { return vec3f(0.5); }
+    case 14u: { return konst; }
+    default: { return vec3f(0.0); }
+  }
+}
+
+fn tev_alpha_arg(arg: u32, normalize_arg: bool, st: TevState, tex: vec4f, ras: vec4f, konst: f32) -> f32 {
+  if (arg < 4u) {
+    let value = st.regs[arg].a;
+    if (normalize_arg && !st.alpha_norm[arg]) {
+      return tev_overflow_f32(value);
+    }
+    return value;
+  }
+  switch arg {
+    case 4u: { return tex.a; }
+    case 5u: { return ras.a; }
+    case 6u: { return konst; }
+    default: { return 0.0; }
+  }
+}
+
+fn tev_bias_scale(word: u32, v: vec3f) -> vec3f {
+  var r = v;
+  let bias = extractBits(word, 20u, 2u);
+  if (bias == 1u) {
+    r = r + 0.5;
+  } else if (bias == 2u) {
+    r = r - 0.5;
+  }
+  let scale = extractBits(word, 22u, 2u);
+  if (scale == 1u) {
+    r = r * 2.0;
+  } else if (scale == 2u) {
+    r = r * 4.0;
+  } else if (scale == 3u) {
+    r = r / 2.0;
+  }
+  return r;
+}
+
+fn tev_compare(op: u32, a: vec3f, b: vec3f) -> vec3<bool> {
+  let a8 = round(a * 255.0);
+  let b8 = round(b * 255.0);
+  let a16 = round(dot(a.rg * 255.0, vec2(1.0, 256.0)));
+  let b16 = round(dot(b.rg * 255.0, vec2(1.0, 256.0)));
+  let a24 = round(dot(a * 255.0, vec3(1.0, 256.0, 65536.0)));
+  let b24 = round(dot(b * 255.0, vec3(1.0, 256.0, 65536.0)));
+  switch op {
+    case 8u: { return vec3<bool>(a8.r > b8.r); }
+    case 9u: { return vec3<bool>(a8.r == b8.r); }
+    case 10u: { return vec3<bool>(a16 > b16); }
+    case 11u: { return vec3<bool>(a16 == b16); }
+    case 12u: { return vec3<bool>(a24 > b24); }
+    case 13u: { return vec3<bool>(a24 == b24); }
+    case 14u: { return a8 > b8; }
+    default: { return a8 == b8; }
+  }
+}
+
+fn tev_clamp(word: u32, v: vec3f) -> vec3f {
+  if (extractBits(word, 26u, 1u) != 0u) {
+    return clamp(v, vec3f(0.0), vec3f(1.0));
+  }
+  return clamp(v, vec3f(-4.0), vec3f(4.0));
+}
+
+fn alpha_test(comp: u32, alpha: u32, ref_value: u32) -> bool {
+  switch comp {
+    case 0u: { return false; }
+    case 1u: { return alpha < ref_value; }
+    case 2u: { return alpha == ref_value; }
+    case 3u: { return alpha <= ref_value; }
+    case 4u: { return alpha > ref_value; }
+    case 5u: { return alpha != ref_value; }
+    case 6u: { return alpha >= ref_value; }
+    default: { return true; }
+  }
+}
+
+@fragment
+fn fs_main(in: VertexOutput) -> @location(0) vec4f {
+    var st = TevState(ubuf.tevreg, array<bool, 4>(), array<bool, 4>());
+    let rast = array<vec4f, 2>(in.cc0, in.cc1);
+    let stage_count = extractBits(cfg(0u), 8u, 5u);
+    for (var s = 0u; s < stage_count; s++) {
+      let cw = cfg(33u + s * 3u);
+      let aw = cfg(34u + s * 3u);
+      let mw = cfg(35u + s * 3u);
+      var tex = vec4f(1.0);
+      if (extractBits(mw, 16u, 1u) != 0u) {
+        let sampled = sample_map(extractBits(mw, 13u, 3u), frag_uv(in, extractBits(mw, 10u, 3u)));
+        tex = tev_swap(sampled, extractBits(mw, 22u, 2u));
+      }
+      var ras = vec4f(0.0);
+      let ras_chan = extractBits(mw, 17u, 2u);
+      if (ras_chan < 2u) {
+        ras = tev_swap(rast[ras_chan], extractBits(mw, 20u, 2u));
+      }
+      let kc = konst_color(extractBits(mw, 0u, 5u));
+      let ka = konst_alpha(extractBits(mw, 5u, 5u));
+
+      let ca = tev_color_arg(extractBits(cw, 0u, 4u), true, st, tex, ras, kc);
+      let cb = tev_color_arg(extractBits(cw, 4u, 4u), true, st, tex, ras, kc);
+      let cc = tev_color_arg(extractBits(cw, 8u, 4u), true, st, tex, ras, kc);
+      let cd = tev_color_arg(extractBits(cw, 12u, 4u), false, st, tex, ras, kc);
+      let cop = extractBits(cw, 16u, 4u);
+      var color: vec3f;
+      if (cop <= 1u) {
+        color = tev_bias_scale(cw, select(mix(ca, cb, cc), -mix(ca, cb, cc), cop == 1u) + cd);
+      } else {
+        color = select(vec3f(0.0), cc, tev_compare(cop, ca, cb)) + cd;
+      }
+      let creg = extractBits(cw, 24u, 2u);
+      st.regs[creg] = vec4f(tev_clamp(cw, color), st.regs[creg].a);
+      st.color_norm[creg] = extractBits(cw, 26u, 1u) != 0u;
+
+      let aa = tev_alpha_arg(extractBits(aw, 0u, 3u), true, st, tex, ras, ka);
+      let ab = tev_alpha_arg(extractBits(aw, 3u, 3u), true, st, tex, ras, ka);
+      let ac = tev_alpha_arg(extractBits(aw, 6u, 3u), true, st, tex, ras, ka);
+      let ad = tev_alpha_arg(extractBits(aw, 9u, 3u), false, st, tex, ras, ka);
+      let aop = extractBits(aw, 16u, 4u);
+      var alpha: f32;
+      if (aop <= 1u) {
+        alpha = tev_bias_scale(aw, vec3f(select(mix(aa, ab, ac), -mix(aa, ab, ac), aop == 1u) + ad)).x;
+      } else if (aop >= 14u) {
+        alpha = select(0.0, ac, tev_compare(aop, vec3f(aa), vec3f(ab)).x) + ad;
+      } else {
+        alpha = select(0.0, ac, tev_compare(aop, ca, cb).x) + ad;
+      }
+      let areg = extractBits(aw, 24u, 2u);
+      st.regs[areg].a = tev_clamp(aw, vec3f(alpha)).x;
+      st.alpha_norm[areg] = extractBits(aw, 26u, 1u) != 0u;
+    }
+
+    let last = stage_count - 1u;
+    let last_creg = extractBits(cfg(33u + last * 3u), 24u, 2u);
+    let last_areg = extractBits(cfg(34u + last * 3u), 24u, 2u);
+    var prev = vec4f(st.regs[last_creg].rgb, st.regs[last_areg].a);
+
+    let fog_type = extractBits(cfg(0u), 16u, 4u);
+    if (fog_type != 0u) {
+      let fog_depth = select(in.pos.z, 1.0 - in.pos.z, REVERSED_Z);
+      var fog_base: f32;
+      if ((fog_type & 8u) != 0u) {
+        fog_base = ubuf.fog.a * fog_depth;
+      } else {
+        fog_base = ubuf.fog.a / (ubuf.fog.b - fog_depth);
+      }
+      var fog_f = clamp(fog_base - ubuf.fog.c, 0.0, 1.0);
+      var fog_z = 0.0;
+      switch fog_type & 7u {
+        case 2u: { fog_z = fog_f; }
+        case 4u: { fog_z = 1.0 - exp2(-8.0 * fog_f); }
+        case 5u: { fog_z = 1.0 - exp2(-8.0 * fog_f * fog_f); }
+        case 6u: { fog_z = exp2(-8.0 * (1.0 - fog_f)); }
+        case 7u: {
+          fog_f = 1.0 - fog_f;
+          fog_z = exp2(-8.0 * fog_f * fog_f);
+        }
+        default: {}
+      }
+      prev = vec4f(mix(prev.rgb, ubuf.fog.color.rgb, clamp(fog_z, 0.0, 1.0)), prev.a);
+    }
+
+    if (!st.color_norm[last_creg]) {
+      prev = vec4f(tev_overflow_vec3f(prev.rgb), prev.a);
+    }
+    if (!st.alpha_norm[last_areg]) {
+      prev.a = tev_overflow_f32(prev.a);
+    }
+
+    let alpha_cfg = cfg(1u);
+    let comp0 = extractBits(alpha_cfg, 0u, 3u);
+    let comp1 = extractBits(alpha_cfg, 3u, 3u);
+    if (comp0 != 7u || comp1 != 7u) {
+      let alpha = u32(round(clamp(prev.a, 0.0, 1.0) * 255.0));
+      let pass0 = alpha_test(comp0, alpha, extractBits(alpha_cfg, 8u, 8u));
+      let pass1 = alpha_test(comp1, alpha, extractBits(alpha_cfg, 16u, 8u));
+      var passed: bool;
+      switch extractBits(alpha_cfg, 6u, 2u) {
+        case 0u: { passed = pass0 && pass1; }
+        case 1u: { passed = pass0 || pass1; }
+        case 2u: { passed = pass0 != pass1; }
+        default: { passed = pass0 == pass1; }
+      }
+      if (!passed) {
+        discard;
+      }
+    }
+    return prev;
+}
+)""";
+} // namespace
+
+std::string build_uber_shader_source() noexcept {
+  std::string source{ShaderPrelude};
+  source += UseReversedZ ? "\nconst REVERSED_Z = true;\n" : "\nconst REVERSED_Z = false;\n";
+  source += UberShaderSource;
+  return source;
+}
+
+wgpu::ShaderModule build_uber_shader() noexcept {
+  ZoneScoped;
+  const auto shaderSource = build_uber_shader_source();
+  wgpu::ShaderSourceWGSL wgslDescriptor{};
+  wgslDescriptor.code = shaderSource.c_str();
+  const auto shaderDescriptor = wgpu::ShaderModuleDescriptor{
+      .nextInChain = &wgslDescriptor,
+      .label = "GX Uber Shader",
+  };
+  return webgpu::g_device.CreateShaderModule(&shaderDescriptor);
+}
+} // namespace aurora::gx
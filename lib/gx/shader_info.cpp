@@ -213,6 +213,37 @@ u32 line_texcoord_mask() noexcept {
   }
   return mask;
 }
+
+Mat4x4<float> uniform_proj() noexcept {
+  auto proj = g_gxState.proj;
+  if constexpr (UseReversedZ) {
+    proj.m2 = proj.m2 * Vec4{-1.f, -1.f, -1.f, -1.f};
+  } else {
+    proj.m2 = proj.m2 + proj.m3;
+  }
+  return proj;
+}
+
+Fog uniform_fog() noexcept {
+  const auto& state = g_gxState.fog;
+  const float logicalWidth = std::max(g_gxState.logicalViewport.width, 1.f);
+  const float renderWidth = std::max(g_gxState.renderViewport.width, 1.f);
+  Fog fog{
+      .color = state.color,
+      .a = state.a,
+      .b = state.b,
+      .c = state.c,
+      .rangeCenter = ((static_cast<float>(state.rangeCenter) - g_gxState.logicalViewport.left) / logicalWidth) * 2.f -
+                     1.f + (g_gxState.renderViewport.left / renderWidth) * 2.f,
+  };
+  for (u32 i = 0; i < state.rangeK.size(); ++i) {
+    const u32 source = (i & ~1u) | (1u - (i & 1u));
+    fog.rangeK[i / 4][i % 4] = static_cast<float>(state.rangeK[source]) / 64.f;
+  }
+  fog.rangeK[2][2] = fog.rangeK[2][1];
+  fog.rangeK[2][3] = fog.rangeK[2][1];
+  return fog;
+}
 } // namespace
 
 ShaderInfo build_shader_info(const ShaderConfig& config) noexcept {
@@ -389,13 +420,7 @@ static void fill_uniform(ByteBuffer& buf, const ShaderInfo& info) noexcept {
       buf.append<u32>(line_texcoord_mask());
     }
   }
-  auto proj = g_gxState.proj;
-  if constexpr (UseReversedZ) {
-    proj.m2 = proj.m2 * Vec4{-1.f, -1.f, -1.f, -1.f};
-  } else {
-    proj.m2 = proj.m2 + proj.m3;
-  }
-  buf.append(proj);
+  buf.append(uniform_proj());
 
   for (int i = 0; i < MaxPnMtx; i++) {
     buf.append(g_gxState.pnMtx[i].pos);
@@ -455,24 +480,7 @@ static void fill_uniform(ByteBuffer& buf, const ShaderInfo& info) noexcept {
     }
   }
   if (info.usesFog) {
-    const auto& state = g_gxState.fog;
-    const float logicalWidth = std::max(g_gxState.logicalViewport.width, 1.f);
-    const float renderWidth = std::max(g_gxState.renderViewport.width, 1.f);
-    Fog fog{
-        .color = state.color,
-        .a = state.a,
-        .b = state.b,
-        .c = state.c,
-        .rangeCenter = ((static_cast<float>(state.rangeCenter) - g_gxState.logicalViewport.left) / logicalWidth) * 2.f -
-                       1.f + (g_gxState.renderViewport.left / renderWidth) * 2.f,
-    };
-    for (u32 i = 0; i < state.rangeK.size(); ++i) {
-      const u32 source = (i & ~1u) | (1u - (i & 1u));
-      fog.rangeK[i / 4][i % 4] = static_cast<float>(state.rangeK[source]) / 64.f;
-    }
-    fog.rangeK[2][2] = fog.rangeK[2][1];
-    fog.rangeK[2][3] = fog.rangeK[2][1];
-    buf.append(fog);
+    buf.append(uniform_fog());
   }
   for (const auto& scale : g_gxState.texCoordScales) {
     buf.append(Vec4{static_cast<f32>(scale.scaleS) + 1.0f, static_cast<f32>(scale.scaleT) + 1.0f, 0.0f, 0.0f});
@@ -499,4 +507,46 @@ gfx::Range build_uniform(const ShaderInfo& info) noexcept {
   fill_uniform(buf, info);
   return gfx::push_uniform(buf.data(), buf.size());
 }
+
+gfx::Range build_uber_uniform(const ShaderInfo& info) noexcept {
+  ZoneScoped;
+  static ByteBuffer buf;
+  buf.clear();
+  buf.reserve_extra(UberUniformSize);
+  buf.append<f32>(g_gxState.renderViewport.width);
+  buf.append<f32>(g_gxState.renderViewport.height);
+  buf.append<f32>(g_gxState.logicalViewport.width);
+  buf.append<f32>(g_gxState.logicalViewport.height);
+  buf.append(uniform_proj());
+  for (const auto& mtx : g_gxState.pnMtx) {
+    buf.append(mtx.pos);
+  }
+  buf.append(g_gxState.texMtxs);
+  for (const auto& mtx : g_gxState.pnMtx) {
+    buf.append(mtx.nrm);
+  }
+  buf.append(g_gxState.colorRegs);
+  buf.append(g_gxState.lights);
+  for (const auto& state : g_gxState.colorChannelState) {
+    buf.append<u32>(state.lightMask.to_ulong());
+  }
+  for (const auto& state : g_gxState.colorChannelState) {
+    buf.append(state.ambColor);
+  }
+  for (const auto& state : g_gxState.colorChannelState) {
+    buf.append(state.matColor);
+  }
+  buf.append(g_gxState.kcolors);
+  buf.append(g_gxState.ptTexMtxs);
+  buf.append(uniform_fog());
+  for (int i = 0; i < MaxTextures; ++i) {
+    if (info.sampledTextures.test(i)) {
+      buf.append(texture_size_bias(get_texture(static_cast<GXTexMapID>(i))));
+    } else {
+      buf.append(Vec4<float>{});
+    }
+  }
+  CHECK(buf.size() == UberUniformSize, "uber uniform size mismatch: {} != {}", buf.size(), UberUniformSize);
+  return gfx::push_uniform(buf.data(), buf.size());
+}
 } // namespace aurora::gx
@@ -4,6 +4,15 @@
 
 namespace aurora::gx {
 ShaderInfo build_shader_info(const ShaderConfig& config) noexcept;
+// Resets state that can't affect the generated shader (unread attributes, unsampled texgens, swap table entries and
+// indirect stages no TEV stage uses, ...) so that equivalent configs hash to the same pipeline.
+void canonicalize_shader_config(ShaderConfig& config, const ShaderInfo& info) noexcept;
 gfx::Range build_uniform(const ShaderInfo& info) noexcept;
+// Fixed uniform layout read by the uber shader: every matrix, register, light and texture size/bias slot.
+constexpr u32 UberUniformSize = 16 + 64 + 48 * (MaxPnMtx + MaxTexMtx + MaxPnMtx) + 16 * MaxTevRegs +
+                                80 * GX::MaxLights + 16 + 32 * MaxColorChannels + 16 * MaxKColors + 48 * MaxPTTexMtx +
+                                80 + 16 * MaxTextures;
+static_assert(UberUniformSize <= MaxUniformSize);
+gfx::Range build_uber_uniform(const ShaderInfo& info) noexcept;
 u8 color_channel(GXChannelID id) noexcept;
 }; // namespace aurora::gx
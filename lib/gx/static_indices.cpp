@@ -0,0 +1,82 @@
+#include "static_indices.hpp"
+
+#include <vector>
+
+namespace aurora::gx::static_indices {
+namespace {
+static_assert(MaxVertices % 4 == 0, "quad pattern must cover whole quads");
+
+// Lines and points are expanded to one quad per instance, so their indices don't depend on the vertex count.
+constexpr u32 LineIndices = 6;
+constexpr u32 QuadIndices = MaxVertices / 4 * 6;
+constexpr u32 StripIndices = (MaxVertices - 2) * 3;
+
+constexpr u32 LineOffset = 0;
+constexpr u32 QuadOffset = LineOffset + LineIndices;
+constexpr u32 FanOffset = QuadOffset + QuadIndices;
+constexpr u32 StripOffset = FanOffset + StripIndices;
+constexpr u32 TotalIndices = StripOffset + StripIndices;
+static_assert(QuadOffset % 2 == 0 && FanOffset % 2 == 0 && StripOffset % 2 == 0, "slices must be 4-byte aligned");
+
+std::vector<u16> build() noexcept {
+  std::vector<u16> out;
+  out.reserve(TotalIndices);
+  out.insert(out.end(), {0, 1, 3, 3, 2, 0});
+  for (u32 v = 0; v < MaxVertices; v += 4) {
+    out.insert(out.end(), {static_cast<u16>(v), static_cast<u16>(v + 1), static_cast<u16>(v + 2),
+                           static_cast<u16>(v + 2), static_cast<u16>(v + 3), static_cast<u16>(v)});
+  }
+  out.insert(out.end(), {0, 1, 2});
+  for (u32 v = 3; v < MaxVertices; ++v) {
+    out.insert(out.end(), {0, static_cast<u16>(v - 1), static_cast<u16>(v)});
+  }
+  out.insert(out.end(), {0, 1, 2});
+  for (u32 v = 3; v < MaxVertices; ++v) {
+    if ((v & 1) == 0) {
+      out.insert(out.end(), {static_cast<u16>(v - 2), static_cast<u16>(v - 1), static_cast<u16>(v)});
+    } else {
+      out.insert(out.end(), {static_cast<u16>(v - 1), static_cast<u16>(v - 2), static_cast<u16>(v)});
+    }
+  }
+  return out;
+}
+
+constexpr Slice slice(u32 offset, u32 count) noexcept {
+  return {
+      .range = {.offset = static_cast<u32>(offset * sizeof(u16)), .size = static_cast<u32>(count * sizeof(u16))},
+      .indexCount = count,
+  };
+}
+} // namespace
+
+std::optional<Slice> find(GXPrimitive prim, u16 vtxCount) noexcept {
+  switch (prim) {
+  case GX_LINES:
+  case GX_LINESTRIP:
+  case GX_POINTS:
+    return slice(LineOffset, LineIndices);
+  default:
+    break;
+  }
+  if (vtxCount > MaxVertices) {
+    return std::nullopt;
+  }
+  switch (prim) {
+  case GX_QUADS:
+    // Like prepare_idx_buffer, a trailing partial quad is emitted whole
+    return slice(QuadOffset, (vtxCount + 3) / 4 * 6);
+  case GX_TRIANGLEFAN:
+    return slice(FanOffset, vtxCount < 3 ? vtxCount : (vtxCount - 2) * 3);
+  case GX_TRIANGLESTRIP:
+    return slice(StripOffset, vtxCount < 3 ? vtxCount : (vtxCount - 2) * 3);
+  default:
+    return std::nullopt;
+  }
+}
+
+std::span<const u16> data() noexcept {
+  static const std::vector<u16> sData = build();
+  return sData;
+}
+
+} // namespace aurora::gx::static_indices
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "gx.hpp"
+
+#include <optional>
+#include <span>
+
+// Persistent index patterns for the primitive topologies GX draws are converted from. The index lists
+// prepare_idx_buffer generates for a draw starting at vertex 0 only depend on its primitive and vertex count, and
+// each is a prefix of the list for the largest count, so one copy per topology is uploaded at startup and draws
+// reference a slice of it instead of pushing fresh indices into the per-frame index buffer.
+namespace aurora::gx::static_indices {
+
+// Largest vertex count covered by the quad, fan and strip patterns. Longer draws use the per-frame path.
+constexpr u16 MaxVertices = 0x4000;
+
+struct Slice {
+  gfx::Range range;
+  u32 indexCount;
+};
+
+// The slice of the static index buffer holding the indices for a draw of vtxCount vertices starting at vertex 0, or
+// nullopt if the draw needs no indices or is too long.
+std::optional<Slice> find(GXPrimitive prim, u16 vtxCount) noexcept;
+// Contents of the static index buffer, built on first use.
+std::span<const u16> data() noexcept;
+
+} // namespace aurora::gx::static_indices
@@ -1,9 +1,11 @@
 #include "texture.hpp"
+#include "bind_group_cache.hpp"
 
 #include "../gfx/recording.hpp"
 #include "../gfx/tex_palette_conv.hpp"
 #include "../gfx/texture_convert.hpp"
 #include "../gfx/texture_replacement.hpp"
+#include "perf.hpp"
 #include "shader_info.hpp"
 
 #include <absl/container/flat_hash_map.h>
@@ -234,6 +236,7 @@ gfx::TextureHandle find_content_texture(const TextureContentKey& key) {
   }
   touch_content_cache(it->second);
   ++s_stats.contentHits;
+  perf::add(perf::Counter::TextureCacheHits);
   return it->second.handle;
 }
 
@@ -601,6 +604,7 @@ gfx::TextureHandle resolve_static_texture(const GXTexObj_& obj) {
       if (entry.handle && entry.texDataVersion == obj.texDataVersion && entry.tlutObjId == 0) {
         entry.lastUsedFrame = s_frameCount;
         ++s_stats.objectHits;
+        perf::add(perf::Counter::TextureCacheHits);
         return entry.handle;
       }
     }
@@ -633,6 +637,8 @@ gfx::TextureHandle resolve_static_texture(const GXTexObj_& obj) {
                                           {static_cast<const uint8_t*>(obj.data), sourceBytes}, false, nameStr);
       ++s_stats.misses;
       s_stats.uploadBytes += texture_handle_size(handle);
+      perf::add(perf::Counter::TextureCacheMisses);
+      perf::add(perf::Counter::TextureBytes, texture_handle_size(handle));
       cache_content_texture(std::move(keys->contentKey), handle);
     }
   }
@@ -655,6 +661,7 @@ gfx::TextureHandle resolve_static_palette_texture(const GXTexObj_& obj, const GX
           tlutIt->second.lastUsedFrame = s_frameCount;
         }
         ++s_stats.objectHits;
+        perf::add(perf::Counter::TextureCacheHits);
         return entry.handle;
       }
     }
@@ -689,6 +696,8 @@ gfx::TextureHandle resolve_static_palette_texture(const GXTexObj_& obj, const GX
       handle->hasArbitraryMips = converted.hasArbitraryMips;
       ++s_stats.misses;
       s_stats.uploadBytes += texture_handle_size(handle);
+      perf::add(perf::Counter::TextureCacheMisses);
+      perf::add(perf::Counter::TextureBytes, texture_handle_size(handle));
       cache_content_texture(std::move(keys->contentKey), handle);
     }
   }
@@ -722,9 +731,11 @@ void end_frame() noexcept {
   ++s_frameCount;
   apply_pending_invalidations();
   sweep_object_caches();
+  bind_group_cache::end_frame();
 }
 
 void shutdown() noexcept {
+  bind_group_cache::clear();
   s_textureObjectCaches.clear();
   s_tlutObjectCaches.clear();
   s_replacementUsers.clear();
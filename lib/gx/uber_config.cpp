@@ -0,0 +1,138 @@
+#include "uber_config.hpp"
+
+#include "shader_info.hpp"
+
+namespace aurora::gx::uber {
+namespace {
+static_assert(GX_TEXMAP7 < 8 && GX_TEXCOORD7 < 8, "texMap/texCoord are packed into 3 bits");
+static_assert(GX_MAX_TEXGENSRC < 32 && GX_TG_SRTG < 16 && GX_IDENTITY < 64 && GX_PTIDENTITY < 128);
+
+bool uses_texture_sample(const TevStage& stage) noexcept {
+  if (stage.texMapId == GX_TEXMAP_NULL) {
+    return false;
+  }
+  const auto& c = stage.colorPass;
+  const auto& a = stage.alphaPass;
+  return c.a == GX_CC_TEXC || c.a == GX_CC_TEXA || c.b == GX_CC_TEXC || c.b == GX_CC_TEXA || c.c == GX_CC_TEXC ||
+         c.c == GX_CC_TEXA || c.d == GX_CC_TEXC || c.d == GX_CC_TEXA || a.a == GX_CA_TEXA || a.b == GX_CA_TEXA ||
+         a.c == GX_CA_TEXA || a.d == GX_CA_TEXA;
+}
+
+u32 ras_channel(GXChannelID id) noexcept {
+  switch (id) {
+  case GX_COLOR0:
+  case GX_ALPHA0:
+  case GX_COLOR0A0:
+  case GX_COLOR1:
+  case GX_ALPHA1:
+  case GX_COLOR1A1:
+    return color_channel(id);
+  default:
+    // GX_ALPHA_BUMP(N) reads zero without indirect stages, which the uber shader never has.
+    return RasZero;
+  }
+}
+
+u32 pack_op(const TevOp& op) noexcept {
+  return underlying(op.op) << 16 | underlying(op.bias) << 20 | underlying(op.scale) << 22 |
+         underlying(op.outReg) << 24 | static_cast<u32>(op.clamp) << 26;
+}
+
+std::bitset<MaxTexCoord> sampled_tex_coords(const ShaderConfig& config) noexcept {
+  std::bitset<MaxTexCoord> coords;
+  for (u32 i = 0; i < config.tevStageCount; ++i) {
+    const auto& stage = config.tevStages[i];
+    if (uses_texture_sample(stage) && stage.texCoordId != GX_TEXCOORD_NULL) {
+      coords.set(stage.texCoordId);
+    }
+  }
+  return coords;
+}
+} // namespace
+
+bool supported(const ShaderConfig& config) noexcept {
+  if (config.lineMode != 0 || config.numIndStages != 0 || config.fogRangeEnabled || config.instancedMtx ||
+      config.tevStageCount == 0 || config.attrs[GX_VA_CLR0].predecoded || config.attrs[GX_VA_CLR1].predecoded) {
+    return false;
+  }
+  for (u32 i = 0; i < config.tevStageCount; ++i) {
+    const auto& stage = config.tevStages[i];
+    if (uses_texture_sample(stage) && stage.texCoordId == GX_TEXCOORD_NULL) {
+      return false;
+    }
+  }
+  const auto coords = sampled_tex_coords(config);
+  for (u32 i = 0; i < MaxTexCoord; ++i) {
+    if (!coords.test(i)) {
+      continue;
+    }
+    const auto& tcg = config.tcgs[i];
+    if (tcg.type >= GX_TG_BUMP0 && tcg.type <= GX_TG_BUMP7) {
+      return false;
+    }
+    if (tcg.src == GX_TG_BINRM || tcg.src == GX_TG_TANGENT ||
+        (tcg.src >= GX_TG_TEXCOORD0 && tcg.src <= GX_TG_TEXCOORD6) || tcg.src == GX_MAX_TEXGENSRC) {
+      return false;
+    }
+  }
+  return true;
+}
+
+Config pack(const ShaderConfig& config) noexcept {
+  Config out;
+  auto& w = out.words;
+  w[HeaderWord] = config.vtxStride | config.tevStageCount << 8 | static_cast<u32>(config.fogType) << 16;
+  const auto& ac = config.alphaCompare;
+  w[AlphaCompareWord] = underlying(ac.comp0) | underlying(ac.comp1) << 3 | underlying(ac.op) << 6 |
+                        (ac.ref0 & 0xFF) << 8 | (ac.ref1 & 0xFF) << 16;
+  for (u32 i = 0; i < config.tevSwapTable.size(); ++i) {
+    const auto& swap = config.tevSwapTable[i];
+    const u32 entry =
+        underlying(swap.red) | underlying(swap.green) << 2 | underlying(swap.blue) << 4 | underlying(swap.alpha) << 6;
+    w[SwapTableWord] |= entry << (i * 8);
+  }
+  for (u32 i = 0; i < config.colorChannels.size(); ++i) {
+    const auto& cc = config.colorChannels[i];
+    const u32 entry = underlying(cc.matSrc) | underlying(cc.ambSrc) << 1 | underlying(cc.diffFn) << 2 |
+                      underlying(cc.attnFn) << 4 | static_cast<u32>(cc.lightingEnabled) << 6;
+    w[ColorChannelWord] |= entry << (i * 8);
+  }
+  const auto coords = sampled_tex_coords(config);
+  for (u32 i = 0; i < MaxTexCoord; ++i) {
+    const auto& tcg = config.tcgs[i];
+    if (!coords.test(i)) {
+      w[TexGenWord + i] = GX_MAX_TEXGENSRC;
+      continue;
+    }
+    w[TexGenWord + i] = underlying(tcg.src) | underlying(tcg.type) << 5 | underlying(tcg.mtx) << 9 |
+                        underlying(tcg.postMtx) << 15 | static_cast<u32>(tcg.normalize) << 22;
+  }
+  for (u32 i = 0; i < AttrCount; ++i) {
+    const auto& attr = config.attrs[i];
+    if (attr.attrType == GX_NONE) {
+      continue;
+    }
+    w[AttrWord + i] = (attr.attrType & 3) | (attr.cnt & 0xF) << 2 | (attr.compType & 7) << 6 | (attr.frac & 0x1F) << 9 |
+                      static_cast<u32>(attr.le) << 14 | static_cast<u32>(attr.offset) << 16 |
+                      static_cast<u32>(attr.stride) << 24;
+  }
+  for (u32 i = 0; i < config.tevStageCount; ++i) {
+    const auto& stage = config.tevStages[i];
+    const auto& c = stage.colorPass;
+    const auto& a = stage.alphaPass;
+    const bool sampled = uses_texture_sample(stage);
+    auto* sw = &w[StageWord + i * StageWords];
+    sw[0] = underlying(c.a) | underlying(c.b) << 4 | underlying(c.c) << 8 | underlying(c.d) << 12 |
+            pack_op(stage.colorOp);
+    sw[1] = underlying(a.a) | underlying(a.b) << 3 | underlying(a.c) << 6 | underlying(a.d) << 9 |
+            pack_op(stage.alphaOp);
+    sw[2] = underlying(stage.kcSel) | underlying(stage.kaSel) << 5 | ras_channel(stage.channelId) << 17 |
+            underlying(stage.tevSwapRas) << 20 | underlying(stage.tevSwapTex) << 22;
+    if (sampled) {
+      sw[2] |= underlying(stage.texCoordId) << 10 | underlying(stage.texMapId) << 13 | 1u << 16;
+    }
+  }
+  return out;
+}
+
+} // namespace aurora::gx::uber
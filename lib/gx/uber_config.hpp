@@ -0,0 +1,48 @@
+#pragma once
+
+#include "gx.hpp"
+
+#include <array>
+
+// Packed ShaderConfig for the TEV uber shader. Draws whose specialized pipeline is still compiling render through a
+// single generic shader that interprets this config from the storage buffer, so they appear immediately instead of
+// being skipped. The word layout below must stay in sync with the uber shader source in shader.cpp.
+namespace aurora::gx::uber {
+
+// Attributes covered by vertex pulling: GX_VA_PNMTXIDX through GX_VA_TEX7.
+constexpr u32 AttrCount = GX_VA_TEX7 + 1;
+
+// Word 0: vtxStride[0:8] tevStageCount[8:13] fogType[16:20]
+constexpr u32 HeaderWord = 0;
+// Word 1: comp0[0:3] comp1[3:6] op[6:8] ref0[8:16] ref1[16:24]
+constexpr u32 AlphaCompareWord = 1;
+// Word 2: swap table entry i at [i*8:i*8+8] as red[0:2] green[2:4] blue[4:6] alpha[6:8]
+constexpr u32 SwapTableWord = 2;
+// Word 3: color channel i at [i*8:i*8+8] as matSrc[0] ambSrc[1] diffFn[2:4] attnFn[4:6] lightingEnabled[6]
+constexpr u32 ColorChannelWord = 3;
+// One word per texgen: src[0:5] type[5:9] mtx[9:15] postMtx[15:22] normalize[22]
+constexpr u32 TexGenWord = 4;
+// One word per attribute: attrType[0:2] cnt[2:6] compType[6:9] frac[9:14] le[14] offset[16:24] stride[24:32]
+constexpr u32 AttrWord = TexGenWord + MaxTexCoord;
+// Three words per TEV stage:
+//   color: a[0:4] b[4:8] c[8:12] d[12:16] op[16:20] bias[20:22] scale[22:24] outReg[24:26] clamp[26]
+//   alpha: a[0:3] b[3:6] c[6:9]  d[9:12]  op[16:20] bias[20:22] scale[22:24] outReg[24:26] clamp[26]
+//   misc:  kcSel[0:5] kaSel[5:10] texCoord[10:13] texMap[13:16] sampled[16] ras[17:19] swapRas[20:22] swapTex[22:24]
+// ras is the rasterized color channel (0 or 1) or RasZero for GX_COLOR_ZERO/GX_COLOR_NULL.
+constexpr u32 StageWord = AttrWord + AttrCount;
+constexpr u32 StageWords = 3;
+constexpr u32 ConfigWords = StageWord + MaxTevStages * StageWords;
+constexpr u32 RasZero = 2;
+
+struct Config {
+  std::array<u32, ConfigWords> words{};
+};
+static_assert(std::has_unique_object_representations_v<Config>);
+
+// Whether the uber shader renders this config identically to its specialized shader. Indirect texturing, line and
+// point expansion, range fog, instanced matrices, pre-decoded colors, emboss texgens and binormal/tangent sources are
+// left to the specialized path.
+bool supported(const ShaderConfig& config) noexcept;
+Config pack(const ShaderConfig& config) noexcept;
+
+} // namespace aurora::gx::uber
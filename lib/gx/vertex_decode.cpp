@@ -0,0 +1,498 @@
+#include "vertex_decode.hpp"
+
+#include "../gfx/hash.hpp"
+#include "../gfx/recording.hpp"
+#include "../gfx/resources.hpp"
+#include "../internal.hpp"
+
+#include <absl/container/btree_map.h>
+#include <absl/container/flat_hash_map.h>
+#include <tracy/Tracy.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <list>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define AURORA_VERTEX_DECODE_SSE2
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define AURORA_VERTEX_DECODE_NEON
+#endif
+
+namespace aurora::gx::vertex_decode {
+namespace {
+// Keeps decoded arrays aligned for the shader's direct vector loads
+constexpr u32 ResidentAlignment = 16;
+constexpr u32 ResidentRegionSize = static_cast<u32>(gfx::ResidentStorageSize);
+
+struct ArrayKey {
+  const void* data = nullptr;
+  u32 size = 0;
+  u8 stride = 0;
+  bool le = true;
+  bool color = false;
+  u8 comps = 0;
+  GXCompType type = GX_U8;
+  u8 frac = 0;
+
+  bool operator==(const ArrayKey& rhs) const = default;
+  template <typename H>
+  friend H AbslHashValue(H h, const ArrayKey& key) {
+    return H::combine(std::move(h), key.data, key.size, key.stride, key.le, key.color, key.comps, key.type, key.frac);
+  }
+};
+
+struct ResidentArray {
+  gfx::Range range;
+  u32 allocSize = 0;
+  HashType sourceHash = 0;
+  // Value of sGeneration when sourceHash was last checked
+  u64 generation = 0;
+  std::list<ArrayKey>::iterator lru;
+};
+
+std::atomic_size_t sBudget = 0;
+absl::flat_hash_map<ArrayKey, ResidentArray> sResident;
+// Most recently used first
+std::list<ArrayKey> sLru;
+// Arrays not yet decoded, by the last frame they were used in
+absl::flat_hash_map<ArrayKey, u64> sCandidates;
+// Free space in the resident storage region keyed by offset; adjacent ranges are coalesced on release.
+absl::btree_map<u32, u32> sFreeRanges{{0, ResidentRegionSize}};
+// Space freed this frame. Draws recorded this frame may still read it ahead of a later upload, so it's only handed out
+// again from the next frame on.
+std::vector<std::pair<u32, u32>> sRetiredRanges;
+std::vector<f32> sScratch;
+size_t sResidentBytes = 0;
+u64 sFrame = 1;
+u64 sGeneration = 1;
+
+bool is_color(GXAttr attr) noexcept { return attr == GX_VA_CLR0 || attr == GX_VA_CLR1; }
+
+#if defined(AURORA_VERTEX_DECODE_SSE2)
+__m128i bswap16(__m128i v) noexcept { return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8)); }
+
+__m128i bswap32(__m128i v) noexcept {
+  v = bswap16(v);
+  return _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+}
+
+// Widens eight 16-bit integers to f32, scales them and stores them to out.
+template <bool Signed>
+void store_16x8(__m128i v, __m128 scale, f32* out) noexcept {
+  __m128i lo;
+  __m128i hi;
+  if constexpr (Signed) {
+    lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+    hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+  } else {
+    lo = _mm_unpacklo_epi16(v, _mm_setzero_si128());
+    hi = _mm_unpackhi_epi16(v, _mm_setzero_si128());
+  }
+  _mm_storeu_ps(out, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+  _mm_storeu_ps(out + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+}
+
+template <typename T>
+size_t convert_fixed_simd(const u8* src, size_t count, f32 scale, bool swap, f32* out) noexcept {
+  const __m128 vscale = _mm_set1_ps(scale);
+  size_t i = 0;
+  if constexpr (sizeof(T) == 1) {
+    for (; i + 16 <= count; i += 16) {
+      const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+      // 8-bit values widened to 16 bits stay in range for a signed widening to 32
+      if constexpr (std::is_signed_v<T>) {
+        store_16x8<true>(_mm_srai_epi16(_mm_unpacklo_epi8(v, v), 8), vscale, out + i);
+        store_16x8<true>(_mm_srai_epi16(_mm_unpackhi_epi8(v, v), 8), vscale, out + i + 8);
+      } else {
+        store_16x8<true>(_mm_unpacklo_epi8(v, _mm_setzero_si128()), vscale, out + i);
+        store_16x8<true>(_mm_unpackhi_epi8(v, _mm_setzero_si128()), vscale, out + i + 8);
+      }
+    }
+  } else {
+    for (; i + 8 <= count; i += 8) {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * sizeof(T)));
+      if (swap) {
+        v = bswap16(v);
+      }
+      store_16x8<std::is_signed_v<T>>(v, vscale, out + i);
+    }
+  }
+  return i;
+}
+
+size_t convert_f32_simd(const u8* src, size_t count, bool swap, f32* out) noexcept {
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * sizeof(f32)));
+    if (swap) {
+      v = bswap32(v);
+    }
+    _mm_storeu_ps(out + i, _mm_castsi128_ps(v));
+  }
+  return i;
+}
+#elif defined(AURORA_VERTEX_DECODE_NEON)
+template <bool Signed>
+void store_16x8(uint16x8_t v, float32x4_t scale, f32* out) noexcept {
+  if constexpr (Signed) {
+    const int16x8_t s = vreinterpretq_s16_u16(v);
+    vst1q_f32(out, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(s))), scale));
+    vst1q_f32(out + 4, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(s))), scale));
+  } else {
+    vst1q_f32(out, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(v))), scale));
+    vst1q_f32(out + 4, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(v))), scale));
+  }
+}
+
+template <typename T>
+size_t convert_fixed_simd(const u8* src, size_t count, f32 scale, bool swap, f32* out) noexcept {
+  const float32x4_t vscale = vdupq_n_f32(scale);
+  size_t i = 0;
+  if constexpr (sizeof(T) == 1) {
+    for (; i + 8 <= count; i += 8) {
+      const uint8x8_t v = vld1_u8(src + i);
+      if constexpr (std::is_signed_v<T>) {
+        store_16x8<true>(vreinterpretq_u16_s16(vmovl_s8(vreinterpret_s8_u8(v))), vscale, out + i);
+      } else {
+        store_16x8<false>(vmovl_u8(v), vscale, out + i);
+      }
+    }
+  } else {
+    for (; i + 8 <= count; i += 8) {
+      uint8x16_t v = vld1q_u8(src + i * sizeof(T));
+      if (swap) {
+        v = vrev16q_u8(v);
+      }
+      store_16x8<std::is_signed_v<T>>(vreinterpretq_u16_u8(v), vscale, out + i);
+    }
+  }
+  return i;
+}
+
+size_t convert_f32_simd(const u8* src, size_t count, bool swap, f32* out) noexcept {
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    uint8x16_t v = vld1q_u8(src + i * sizeof(f32));
+    if (swap) {
+      v = vrev32q_u8(v);
+    }
+    vst1q_f32(out + i, vreinterpretq_f32_u8(v));
+  }
+  return i;
+}
+#endif
+
+template <typename T>
+void decode_fixed(std::span<const u8> src, u32 srcStride, u32 count, u32 cnt, u8 frac, std::endian e,
+                  f32* out) noexcept {
+  // 1 / 2^frac is exact, so this matches dividing by the scale
+  const f32 scale = 1.f / static_cast<f32>(1u << frac);
+  if (srcStride == cnt * sizeof(T)) {
+    // Tightly packed components convert as one flat run
+    const size_t total = static_cast<size_t>(count) * cnt;
+    size_t i = 0;
+#if defined(AURORA_VERTEX_DECODE_SSE2) || defined(AURORA_VERTEX_DECODE_NEON)
+    i = convert_fixed_simd<T>(src.data(), total, scale, e != std::endian::native, out);
+#endif
+    for (; i < total; ++i) {
+      out[i] = static_cast<f32>(read_bits<T>(src.data() + i * sizeof(T), e)) * scale;
+    }
+    return;
+  }
+  for (u32 i = 0; i < count; ++i) {
+    const u8* elem = src.data() + i * srcStride;
+    for (u32 c = 0; c < cnt; ++c) {
+      *out++ = static_cast<f32>(read_bits<T>(elem + c * sizeof(T), e)) * scale;
+    }
+  }
+}
+
+void decode_f32(std::span<const u8> src, u32 srcStride, u32 count, u32 cnt, std::endian e, f32* out) noexcept {
+  if (srcStride == cnt * sizeof(f32)) {
+    const size_t total = static_cast<size_t>(count) * cnt;
+    size_t i = 0;
+#if defined(AURORA_VERTEX_DECODE_SSE2) || defined(AURORA_VERTEX_DECODE_NEON)
+    i = convert_f32_simd(src.data(), total, e != std::endian::native, out);
+#endif
+    for (; i < total; ++i) {
+      out[i] = std::bit_cast<f32>(read_bits<u32>(src.data() + i * sizeof(u32), e));
+    }
+    return;
+  }
+  for (u32 i = 0; i < count; ++i) {
+    const u8* elem = src.data() + i * srcStride;
+    for (u32 c = 0; c < cnt; ++c) {
+      *out++ = std::bit_cast<f32>(read_bits<u32>(elem + c * sizeof(u32), e));
+    }
+  }
+}
+
+void decode_color(GXCompType type, std::span<const u8> src, u32 srcStride, u32 count, std::endian e,
+                  f32* out) noexcept {
+  for (u32 i = 0; i < count; ++i) {
+    const u8* elem = src.data() + i * srcStride;
+    if (type == GX_RGB565) {
+      const u16 v = read_bits<u16>(elem, e);
+      *out++ = static_cast<f32>((v >> 11) & 0x1F) / 31.f;
+      *out++ = static_cast<f32>((v >> 5) & 0x3F) / 63.f;
+      *out++ = static_cast<f32>(v & 0x1F) / 31.f;
+      *out++ = 1.f;
+    } else if (type == GX_RGBA4) {
+      const u16 v = read_bits<u16>(elem, e);
+      *out++ = static_cast<f32>((v >> 12) & 0xF) / 15.f;
+      *out++ = static_cast<f32>((v >> 8) & 0xF) / 15.f;
+      *out++ = static_cast<f32>((v >> 4) & 0xF) / 15.f;
+      *out++ = static_cast<f32>(v & 0xF) / 15.f;
+    } else {
+      const u32 v = e == std::endian::little ? elem[0] | elem[1] << 8 | elem[2] << 16
+                                             : elem[0] << 16 | elem[1] << 8 | elem[2];
+      *out++ = static_cast<f32>((v >> 18) & 0x3F) / 63.f;
+      *out++ = static_cast<f32>((v >> 12) & 0x3F) / 63.f;
+      *out++ = static_cast<f32>((v >> 6) & 0x3F) / 63.f;
+      *out++ = static_cast<f32>(v & 0x3F) / 63.f;
+    }
+  }
+}
+
+u32 element_count(GXAttr attr, const VtxAttrFmt& fmt, u32 srcStride, size_t srcSize) noexcept {
+  const u32 typeSize = comp_type_size(attr, fmt.type);
+  const u32 elemSize = is_color(attr) ? typeSize : typeSize * comp_cnt_count(attr, fmt.cnt);
+  if (srcStride == 0 || srcSize < elemSize) {
+    return 0;
+  }
+  return static_cast<u32>((srcSize - elemSize) / srcStride + 1);
+}
+
+void decode_into(GXAttr attr, const VtxAttrFmt& fmt, bool le, u32 srcStride, std::span<const u8> src, u32 count,
+                 f32* out) noexcept {
+  const u32 comps = decoded_components(attr, fmt);
+  const auto e = le ? std::endian::little : std::endian::big;
+  if (is_color(attr)) {
+    decode_color(fmt.type, src, srcStride, count, e, out);
+    return;
+  }
+  switch (fmt.type) {
+  case GX_U8:
+    decode_fixed<u8>(src, srcStride, count, comps, fmt.frac, e, out);
+    break;
+  case GX_S8:
+    decode_fixed<s8>(src, srcStride, count, comps, fmt.frac, e, out);
+    break;
+  case GX_U16:
+    decode_fixed<u16>(src, srcStride, count, comps, fmt.frac, e, out);
+    break;
+  case GX_S16:
+    decode_fixed<s16>(src, srcStride, count, comps, fmt.frac, e, out);
+    break;
+  default:
+    decode_f32(src, srcStride, count, comps, e, out);
+    break;
+  }
+}
+
+HashType source_hash(const AttrArray& array) noexcept { return xxh3_hash_s(array.data, array.size, 0); }
+
+void release_range(u32 offset, u32 size) noexcept {
+  auto next = sFreeRanges.lower_bound(offset);
+  if (next != sFreeRanges.end() && offset + size == next->first) {
+    size += next->second;
+    next = sFreeRanges.erase(next);
+  }
+  if (next != sFreeRanges.begin()) {
+    const auto prev = std::prev(next);
+    if (prev->first + prev->second == offset) {
+      prev->second += size;
+      return;
+    }
+  }
+  sFreeRanges.emplace_hint(next, offset, size);
+}
+
+std::optional<u32> allocate_range(u32 size) noexcept {
+  const auto it = std::ranges::find_if(sFreeRanges, [size](const auto& range) { return range.second >= size; });
+  if (it == sFreeRanges.end()) {
+    return std::nullopt;
+  }
+  const u32 offset = it->first;
+  const u32 remaining = it->second - size;
+  sFreeRanges.erase(it);
+  if (remaining != 0) {
+    sFreeRanges.emplace(offset + size, remaining);
+  }
+  return offset;
+}
+
+void retire(const ResidentArray& resident) noexcept {
+  sRetiredRanges.emplace_back(static_cast<u32>(resident.range.offset - gfx::StorageBufferSize), resident.allocSize);
+  sResidentBytes -= resident.range.size;
+  sLru.erase(resident.lru);
+}
+
+void evict_to(size_t target) noexcept {
+  while (sResidentBytes > target && !sLru.empty()) {
+    const auto it = sResident.find(sLru.back());
+    retire(it->second);
+    sResident.erase(it);
+  }
+}
+
+// Decodes a hot array and uploads it to a new allocation in the resident region. On failure, such as when the region
+// is too fragmented until retired space is reclaimed, the array is left to be retried in a later frame.
+gfx::Range make_resident(const ArrayKey& key, GXAttr attr, const VtxAttrFmt& fmt, const AttrArray& array,
+                         size_t budget) noexcept {
+  const u32 count = element_count(attr, fmt, array.stride, array.size);
+  const size_t size = static_cast<size_t>(count) * key.comps * sizeof(f32);
+  if (size == 0 || size > budget) {
+    return {};
+  }
+  evict_to(budget - size);
+  const u32 allocSize = AURORA_ALIGN(static_cast<u32>(size), ResidentAlignment);
+  const auto offset = allocate_range(allocSize);
+  if (!offset) {
+    return {};
+  }
+
+  ZoneScoped;
+  sScratch.resize(size / sizeof(f32));
+  decode_into(attr, fmt, array.le, array.stride, {static_cast<const u8*>(array.data), array.size}, count,
+              sScratch.data());
+  const auto range = gfx::upload_resident_storage(*offset, reinterpret_cast<const u8*>(sScratch.data()), size);
+  if (range.size == 0) {
+    release_range(*offset, allocSize);
+    return {};
+  }
+  sLru.push_front(key);
+  sResident.insert_or_assign(key, ResidentArray{
+                                      .range = range,
+                                      .allocSize = allocSize,
+                                      .sourceHash = source_hash(array),
+                                      .generation = sGeneration,
+                                      .lru = sLru.begin(),
+                                  });
+  sResidentBytes += size;
+  return range;
+}
+} // namespace
+
+bool supported(GXAttr attr, const VtxAttrFmt& fmt) noexcept {
+  switch (attr) {
+  case GX_VA_POS:
+  case GX_VA_TEX0:
+  case GX_VA_TEX1:
+  case GX_VA_TEX2:
+  case GX_VA_TEX3:
+  case GX_VA_TEX4:
+  case GX_VA_TEX5:
+  case GX_VA_TEX6:
+  case GX_VA_TEX7:
+    return fmt.type <= GX_F32;
+  case GX_VA_NRM:
+    return fmt.cnt == GX_NRM_XYZ && fmt.type <= GX_F32;
+  case GX_VA_CLR0:
+  case GX_VA_CLR1:
+    return fmt.type == GX_RGB565 || fmt.type == GX_RGBA4 || fmt.type == GX_RGBA6;
+  default:
+    return false;
+  }
+}
+
+u32 decoded_components(GXAttr attr, const VtxAttrFmt& fmt) noexcept {
+  return is_color(attr) ? 4 : comp_cnt_count(attr, fmt.cnt);
+}
+
+std::vector<f32> decode(GXAttr attr, const VtxAttrFmt& fmt, bool le, u32 srcStride, std::span<const u8> src) noexcept {
+  ZoneScoped;
+  const u32 count = element_count(attr, fmt, srcStride, src.size());
+  std::vector<f32> out(static_cast<size_t>(count) * decoded_components(attr, fmt));
+  decode_into(attr, fmt, le, srcStride, src, count, out.data());
+  return out;
+}
+
+gfx::Range find(GXAttr attr, const VtxAttrFmt& fmt, const AttrArray& array) noexcept {
+  const size_t budget = sBudget.load(std::memory_order_relaxed);
+  if (budget == 0 || array.data == nullptr || array.stride == 0 || !supported(attr, fmt)) {
+    return {};
+  }
+  const ArrayKey key{
+      .data = array.data,
+      .size = array.size,
+      .stride = array.stride,
+      .le = array.le,
+      .color = is_color(attr),
+      .comps = static_cast<u8>(decoded_components(attr, fmt)),
+      .type = fmt.type,
+      .frac = fmt.frac,
+  };
+  if (const auto it = sResident.find(key); it != sResident.end()) {
+    auto& resident = it->second;
+    if (resident.generation == sGeneration) {
+      sLru.splice(sLru.begin(), sLru, resident.lru);
+      return resident.range;
+    }
+    resident.generation = sGeneration;
+    if (source_hash(array) == resident.sourceHash) {
+      sLru.splice(sLru.begin(), sLru, resident.lru);
+      return resident.range;
+    }
+    // Rewritten in place since it was decoded. Earlier draws this frame may still read the old copy, so decode into a
+    // new allocation rather than overwriting it.
+    retire(resident);
+    sResident.erase(it);
+    const auto range = make_resident(key, attr, fmt, array, budget);
+    if (range.size == 0) {
+      sCandidates.insert_or_assign(key, sFrame);
+    }
+    return range;
+  }
+
+  // Only decode arrays that were also used in the previous frame
+  const auto [it, inserted] = sCandidates.try_emplace(key, sFrame);
+  const bool hot = !inserted && it->second + 1 == sFrame;
+  it->second = sFrame;
+  if (!hot) {
+    return {};
+  }
+  const auto range = make_resident(key, attr, fmt, array, budget);
+  if (range.size != 0) {
+    sCandidates.erase(it);
+  }
+  return range;
+}
+
+void invalidate() noexcept { ++sGeneration; }
+
+void end_frame() noexcept {
+  // Drop candidates that weren't used this frame; resident arrays stay until evicted by the budget
+  absl::erase_if(sCandidates, [](const auto& item) { return item.second != sFrame; });
+  evict_to(sBudget.load(std::memory_order_relaxed));
+  for (const auto& [offset, size] : sRetiredRanges) {
+    release_range(offset, size);
+  }
+  sRetiredRanges.clear();
+  ++sFrame;
+}
+
+void clear() noexcept {
+  sResident.clear();
+  sLru.clear();
+  sCandidates.clear();
+  sFreeRanges.clear();
+  sFreeRanges.emplace(0, ResidentRegionSize);
+  sRetiredRanges.clear();
+  sResidentBytes = 0;
+}
+
+void set_budget(size_t bytes) noexcept {
+  sBudget.store(std::min<size_t>(bytes, gfx::ResidentStorageSize), std::memory_order_relaxed);
+}
+size_t budget() noexcept { return sBudget.load(std::memory_order_relaxed); }
+size_t resident_bytes() noexcept { return sResidentBytes; }
+
+} // namespace aurora::gx::vertex_decode
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "gx.hpp"
+
+#include <span>
+#include <vector>
+
+// Pre-decoding of hot indexed vertex arrays. Shaders otherwise byte-swap and dequantize every indexed attribute on
+// every fetch, in every pass the mesh is drawn in. Arrays seen in consecutive frames are instead decoded once on the
+// CPU to little-endian f32 components and kept resident on the GPU, in the storage buffer region reserved by
+// gfx::upload_resident_storage, within a memory budget; the shader loads them directly (AttrConfig::predecoded).
+//
+// Decoded arrays are identified by their address, size and format, not their contents. A game rewriting an array in
+// place must call GXInvalidateVtxCache, as it would on hardware; each decoded array is then re-hashed on its next use
+// and only decoded again if its contents changed.
+namespace aurora::gx::vertex_decode {
+
+// Whether arrays of this attribute and format can be pre-decoded: positions, normals without binormal/tangent,
+// texture coordinates and RGB565/RGBA4/RGBA6 colors.
+bool supported(GXAttr attr, const VtxAttrFmt& fmt) noexcept;
+// f32 components per decoded element: cnt for positions, normals and texture coordinates; RGBA for colors.
+u32 decoded_components(GXAttr attr, const VtxAttrFmt& fmt) noexcept;
+// Decodes each whole element of src, one per srcStride bytes, with the same math as the shader fetch helpers.
+std::vector<f32> decode(GXAttr attr, const VtxAttrFmt& fmt, bool le, u32 srcStride, std::span<const u8> src) noexcept;
+
+// The storage buffer range holding the decoded contents of array for this format if it is hot and fits the budget,
+// otherwise an empty range. Called at most once per array and frame, when the array is bound.
+gfx::Range find(GXAttr attr, const VtxAttrFmt& fmt, const AttrArray& array) noexcept;
+// Marks every decoded array for re-validation against its source, for GXInvalidateVtxCache.
+void invalidate() noexcept;
+// Ages the cache; arrays must be seen again in the next frame to stay hot.
+void end_frame() noexcept;
+void clear() noexcept;
+
+// Memory budget for decoded arrays in bytes, capped at gfx::ResidentStorageSize. 0 (the default) disables
+// pre-decoding.
+void set_budget(size_t bytes) noexcept;
+size_t budget() noexcept;
+size_t resident_bytes() noexcept;
+
+} // namespace aurora::gx::vertex_decode
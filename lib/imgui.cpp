@@ -1,19 +1,28 @@
 #include "imgui.hpp"
 
+#include <algorithm>
+#include <array>
 #include <cstddef>
 #include <cmath>
 #include <cstring>
 #include <memory>
+#include <optional>
+#include <span>
 #include <string>
+#include <tuple>
 #include <utility>
 #include <vector>
 
+#include <absl/container/flat_hash_map.h>
 #include <webgpu/webgpu_cpp.h>
 #include <SDL3/SDL_events.h>
 #include <SDL3/SDL_render.h>
 
 #include "internal.hpp"
+#include "gfx/frame.hpp"
+#include "gfx/recording.hpp"
 #include "gfx/render_worker.hpp"
+#include "gfx/resources.hpp"
 #include "webgpu/gpu.hpp"
 #include "window.hpp"
 
@@ -24,7 +33,53 @@
 #include "tracy/Tracy.hpp"
 
 namespace aurora::imgui {
+struct FrozenDrawList {
+  gfx::Range vertexRange;
+  gfx::Range indexRange;
+  uint32_t firstCommand = 0;
+  uint32_t commandCount = 0;
+};
+
+struct FrozenDrawCommand {
+  ImVec4 clipRect;
+  ImTextureID texture;
+  uint32_t indexOffset;
+  uint32_t elemCount;
+  uint32_t vertexOffset;
+  // User draw callback run in place of a draw. Data copied by ImGui is kept in DrawData::Impl::callbackData, since
+  // the draw list's own copy is gone by the time the render worker gets to it.
+  ImDrawCallback callback = nullptr;
+  void* callbackData = nullptr;
+  uint32_t callbackDataOffset = 0;
+  uint32_t callbackDataSize = 0;
+};
+
+struct DrawData::Impl {
+  // SDL renderer: ImGui's own buffers, swapped out of its draw lists rather than cloned.
+  ImDrawData drawData;
+  std::vector<std::unique_ptr<ImDrawList>> drawLists;
+  // WebGPU: geometry was written to the frame's staging buffers in freeze; only the commands are kept.
+  std::vector<FrozenDrawList> lists;
+  std::vector<FrozenDrawCommand> commands;
+  std::vector<uint8_t> callbackData;
+  // Set when the geometry did not fit in the staging buffers; holds all vertices followed by all indices.
+  wgpu::Buffer overflowBuffer;
+  gfx::Range uniformRange;
+  ImVec2 displayPos;
+  ImVec2 displaySize;
+  ImVec2 framebufferScale;
+};
+
 namespace {
+struct Uniforms {
+  std::array<float, 16> mvp;
+  float gamma;
+  std::array<float, 3> padding;
+};
+static_assert(sizeof(Uniforms) == 80);
+
+constexpr size_t MaxTextureBindGroups = 256;
+
 float g_scale;
 std::string g_imguiSettings{};
 std::string g_imguiLog{};
@@ -33,6 +88,20 @@ bool g_useSdlRenderer = false;
 std::vector<SDL_Texture*> g_sdlTextures;
 std::vector<wgpu::Texture> g_wgpuTextures;
 
+// A frame slot is only released after the end-of-frame callback that renders its draw data, so by the time freeze
+// comes back around to an instance, nothing reads it anymore.
+std::array<DrawData::Impl, gfx::detail::FrameSlotCount> g_frozen;
+size_t g_nextFrozen = 0;
+
+wgpu::RenderPipeline g_pipeline;
+wgpu::BindGroupLayout g_textureBindGroupLayout;
+wgpu::Sampler g_sampler;
+float g_gamma = 1.f;
+wgpu::Texture g_fontTexture;
+wgpu::TextureView g_fontTextureView;
+// Render worker only.
+absl::flat_hash_map<ImTextureID, wgpu::BindGroup> g_textureBindGroups;
+
 wgpu::Buffer create_texture_upload_buffer(uint32_t width, uint32_t height, const uint8_t* data,
                                           uint32_t copyBytesPerRow) {
   const uint32_t rowBytes = width * 4;
@@ -73,13 +142,485 @@ void enqueue_texture_upload(wgpu::Buffer buffer, wgpu::TexelCopyTextureInfo dst,
     webgpu::g_queue.Submit(1, &commandBuffer);
   });
 }
-} // namespace
 
-struct DrawData::Impl {
-  ImDrawData drawData;
-  std::vector<std::unique_ptr<ImDrawList>> drawLists;
+std::pair<wgpu::Texture, wgpu::TextureView> create_texture(uint32_t width, uint32_t height, const uint8_t* data) {
+  const wgpu::Extent3D size{
+      .width = width,
+      .height = height,
+      .depthOrArrayLayers = 1,
+  };
+  const wgpu::TextureDescriptor textureDescriptor{
+      .label = "imgui texture",
+      .usage = wgpu::TextureUsage::TextureBinding | wgpu::TextureUsage::CopyDst,
+      .dimension = wgpu::TextureDimension::e2D,
+      .size = size,
+      .format = wgpu::TextureFormat::RGBA8Unorm,
+      .mipLevelCount = 1,
+      .sampleCount = 1,
+  };
+  const wgpu::TextureViewDescriptor textureViewDescriptor{
+      .label = "imgui texture view",
+      .format = wgpu::TextureFormat::RGBA8Unorm,
+      .dimension = wgpu::TextureViewDimension::e2D,
+      .mipLevelCount = WGPU_MIP_LEVEL_COUNT_UNDEFINED,
+      .arrayLayerCount = WGPU_ARRAY_LAYER_COUNT_UNDEFINED,
+  };
+  auto texture = webgpu::g_device.CreateTexture(&textureDescriptor);
+  auto textureView = texture.CreateView(&textureViewDescriptor);
+  {
+    const wgpu::TexelCopyTextureInfo dstView{
+        .texture = texture,
+    };
+    const uint32_t copyBytesPerRow = AURORA_ALIGN(width * 4, 256);
+    const wgpu::TexelCopyBufferLayout dataLayout{
+        .bytesPerRow = copyBytesPerRow,
+        .rowsPerImage = height,
+    };
+    enqueue_texture_upload(create_texture_upload_buffer(width, height, data, copyBytesPerRow), dstView, dataLayout,
+                           size);
+  }
+  return {std::move(texture), std::move(textureView)};
+}
+
+void create_font_texture() {
+  ZoneScoped;
+  ImGuiIO& io = ImGui::GetIO();
+  unsigned char* pixels = nullptr;
+  int width = 0;
+  int height = 0;
+  io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+  // Frames already queued may still draw with the previous atlas; release it on the render worker behind them.
+  // Clearing the bind group cache there also keeps a reused view address from resolving to a stale bind group.
+  gfx::render_worker::enqueue_work([texture = std::move(g_fontTexture), view = std::move(g_fontTextureView)] {
+    g_textureBindGroups.clear();
+  });
+  std::tie(g_fontTexture, g_fontTextureView) =
+      create_texture(static_cast<uint32_t>(width), static_cast<uint32_t>(height), pixels);
+  io.Fonts->SetTexID(reinterpret_cast<ImTextureID>(g_fontTextureView.Get()));
+}
+
+bool is_srgb(wgpu::TextureFormat format) {
+  switch (format) {
+  case wgpu::TextureFormat::RGBA8UnormSrgb:
+  case wgpu::TextureFormat::BGRA8UnormSrgb:
+    return true;
+  default:
+    return false;
+  }
+}
+
+void create_pipeline() {
+  wgpu::ShaderSourceWGSL sourceDescriptor{};
+  sourceDescriptor.code = R"""(
+struct Uniforms {
+    mvp: mat4x4<f32>,
+    gamma: f32,
+};
+
+@group(0) @binding(0)
+var<uniform> uniforms: Uniforms;
+@group(1) @binding(0)
+var imgui_sampler: sampler;
+@group(1) @binding(1)
+var imgui_texture: texture_2d<f32>;
+
+struct VertexInput {
+    @location(0) pos: vec2<f32>,
+    @location(1) uv: vec2<f32>,
+    @location(2) color: vec4<f32>,
+};
+
+struct VertexOutput {
+    @builtin(position) pos: vec4<f32>,
+    @location(0) color: vec4<f32>,
+    @location(1) uv: vec2<f32>,
 };
 
+@vertex
+fn vs_main(in: VertexInput) -> VertexOutput {
+    var out: VertexOutput;
+    out.pos = uniforms.mvp * vec4<f32>(in.pos, 0.0, 1.0);
+    out.color = in.color;
+    out.uv = in.uv;
+    return out;
+}
+
+@fragment
+fn fs_main(in: VertexOutput) -> @location(0) vec4<f32> {
+    let color = in.color * textureSample(imgui_texture, imgui_sampler, in.uv);
+    return vec4<f32>(pow(color.rgb, vec3<f32>(uniforms.gamma)), color.a);
+}
+)""";
+  const wgpu::ShaderModuleDescriptor moduleDescriptor{
+      .nextInChain = &sourceDescriptor,
+      .label = "ImGui Module",
+  };
+  auto module = webgpu::g_device.CreateShaderModule(&moduleDescriptor);
+  const std::array bindGroupLayoutEntries{
+      wgpu::BindGroupLayoutEntry{
+          .binding = 0,
+          .visibility = wgpu::ShaderStage::Fragment,
+          .sampler =
+              wgpu::SamplerBindingLayout{
+                  .type = wgpu::SamplerBindingType::Filtering,
+              },
+      },
+      wgpu::BindGroupLayoutEntry{
+          .binding = 1,
+          .visibility = wgpu::ShaderStage::Fragment,
+          .texture =
+              wgpu::TextureBindingLayout{
+                  .sampleType = wgpu::TextureSampleType::Float,
+                  .viewDimension = wgpu::TextureViewDimension::e2D,
+              },
+      },
+  };
+  const wgpu::BindGroupLayoutDescriptor bindGroupLayoutDescriptor{
+      .label = "ImGui Texture Bind Group Layout",
+      .entryCount = bindGroupLayoutEntries.size(),
+      .entries = bindGroupLayoutEntries.data(),
+  };
+  g_textureBindGroupLayout = webgpu::g_device.CreateBindGroupLayout(&bindGroupLayoutDescriptor);
+  const std::array bindGroupLayouts{
+      gfx::detail::resources().uniformBindGroupLayout,
+      g_textureBindGroupLayout,
+  };
+  const wgpu::PipelineLayoutDescriptor layoutDescriptor{
+      .label = "ImGui Pipeline Layout",
+      .bindGroupLayoutCount = bindGroupLayouts.size(),
+      .bindGroupLayouts = bindGroupLayouts.data(),
+  };
+  auto pipelineLayout = webgpu::g_device.CreatePipelineLayout(&layoutDescriptor);
+
+  const std::array vertexAttributes{
+      wgpu::VertexAttribute{
+          .format = wgpu::VertexFormat::Float32x2,
+          .offset = offsetof(ImDrawVert, pos),
+          .shaderLocation = 0,
+      },
+      wgpu::VertexAttribute{
+          .format = wgpu::VertexFormat::Float32x2,
+          .offset = offsetof(ImDrawVert, uv),
+          .shaderLocation = 1,
+      },
+      wgpu::VertexAttribute{
+          .format = wgpu::VertexFormat::Unorm8x4,
+          .offset = offsetof(ImDrawVert, col),
+          .shaderLocation = 2,
+      },
+  };
+  const wgpu::VertexBufferLayout vertexBufferLayout{
+      .stepMode = wgpu::VertexStepMode::Vertex,
+      .arrayStride = sizeof(ImDrawVert),
+      .attributeCount = vertexAttributes.size(),
+      .attributes = vertexAttributes.data(),
+  };
+  const wgpu::BlendState blendState{
+      .color =
+          wgpu::BlendComponent{
+              .operation = wgpu::BlendOperation::Add,
+              .srcFactor = wgpu::BlendFactor::SrcAlpha,
+              .dstFactor = wgpu::BlendFactor::OneMinusSrcAlpha,
+          },
+      .alpha =
+          wgpu::BlendComponent{
+              .operation = wgpu::BlendOperation::Add,
+              .srcFactor = wgpu::BlendFactor::One,
+              .dstFactor = wgpu::BlendFactor::OneMinusSrcAlpha,
+          },
+  };
+  const auto surfaceFormat = webgpu::g_graphicsConfig.surfaceConfiguration.format;
+  const std::array colorTargets{wgpu::ColorTargetState{
+      .format = surfaceFormat,
+      .blend = &blendState,
+      .writeMask = wgpu::ColorWriteMask::All,
+  }};
+  const wgpu::FragmentState fragmentState{
+      .module = module,
+      .entryPoint = "fs_main",
+      .targetCount = colorTargets.size(),
+      .targets = colorTargets.data(),
+  };
+  const wgpu::RenderPipelineDescriptor pipelineDescriptor{
+      .label = "ImGui Pipeline",
+      .layout = pipelineLayout,
+      .vertex =
+          wgpu::VertexState{
+              .module = module,
+              .entryPoint = "vs_main",
+              .bufferCount = 1,
+              .buffers = &vertexBufferLayout,
+          },
+      .primitive =
+          wgpu::PrimitiveState{
+              .topology = wgpu::PrimitiveTopology::TriangleList,
+              .frontFace = wgpu::FrontFace::CW,
+              .cullMode = wgpu::CullMode::None,
+          },
+      .multisample =
+          wgpu::MultisampleState{
+              .count = 1,
+              .mask = UINT32_MAX,
+          },
+      .fragment = &fragmentState,
+  };
+  g_pipeline = webgpu::g_device.CreateRenderPipeline(&pipelineDescriptor);
+
+  const wgpu::SamplerDescriptor samplerDescriptor{
+      .label = "ImGui Sampler",
+      .addressModeU = wgpu::AddressMode::Repeat,
+      .addressModeV = wgpu::AddressMode::Repeat,
+      .addressModeW = wgpu::AddressMode::Repeat,
+      .magFilter = wgpu::FilterMode::Linear,
+      .minFilter = wgpu::FilterMode::Linear,
+      .mipmapFilter = wgpu::MipmapFilterMode::Linear,
+      .maxAnisotropy = 1,
+  };
+  g_sampler = webgpu::g_device.CreateSampler(&samplerDescriptor);
+  g_gamma = is_srgb(surfaceFormat) ? 2.2f : 1.f;
+}
+
+const wgpu::BindGroup& texture_bind_group(ImTextureID texture) {
+  if (const auto it = g_textureBindGroups.find(texture); it != g_textureBindGroups.end()) {
+    return it->second;
+  }
+  if (g_textureBindGroups.size() >= MaxTextureBindGroups) {
+    g_textureBindGroups.clear();
+  }
+  const std::array entries{
+      wgpu::BindGroupEntry{
+          .binding = 0,
+          .sampler = g_sampler,
+      },
+      wgpu::BindGroupEntry{
+          .binding = 1,
+          .textureView = wgpu::TextureView{reinterpret_cast<WGPUTextureView>(texture)},
+      },
+  };
+  const wgpu::BindGroupDescriptor descriptor{
+      .label = "ImGui Texture Bind Group",
+      .layout = g_textureBindGroupLayout,
+      .entryCount = entries.size(),
+      .entries = entries.data(),
+  };
+  return g_textureBindGroups.emplace(texture, webgpu::g_device.CreateBindGroup(&descriptor)).first->second;
+}
+
+// Moves ImGui's buffers into retained draw lists; ImGui clears its own lists at the start of the next frame.
+void swap_draw_lists(DrawData::Impl& frozen, ImDrawData& data) {
+  auto& frozenData = frozen.drawData;
+  frozenData.Valid = data.Valid;
+  frozenData.CmdListsCount = data.CmdListsCount;
+  frozenData.TotalIdxCount = data.TotalIdxCount;
+  frozenData.TotalVtxCount = data.TotalVtxCount;
+  frozenData.DisplayPos = data.DisplayPos;
+  frozenData.DisplaySize = data.DisplaySize;
+  frozenData.FramebufferScale = data.FramebufferScale;
+  frozenData.OwnerViewport = data.OwnerViewport;
+  frozenData.CmdLists.resize(data.CmdListsCount);
+  while (frozen.drawLists.size() < static_cast<size_t>(data.CmdListsCount)) {
+    frozen.drawLists.emplace_back(std::make_unique<ImDrawList>(ImGui::GetDrawListSharedData()));
+  }
+  for (int i = 0; i < data.CmdListsCount; ++i) {
+    auto& source = *data.CmdLists[i];
+    auto& list = *frozen.drawLists[i];
+    list.CmdBuffer.swap(source.CmdBuffer);
+    list.IdxBuffer.swap(source.IdxBuffer);
+    list.VtxBuffer.swap(source.VtxBuffer);
+    list.Flags = source.Flags;
+    frozenData.CmdLists[i] = &list;
+  }
+}
+
+void freeze_commands(DrawData::Impl& frozen, FrozenDrawList& frozenList, const ImDrawList& list) {
+  frozenList.firstCommand = static_cast<uint32_t>(frozen.commands.size());
+  for (const ImDrawCmd& cmd : list.CmdBuffer) {
+    if (cmd.UserCallback != nullptr) {
+      FrozenDrawCommand& frozenCmd = frozen.commands.emplace_back(FrozenDrawCommand{
+          .clipRect = cmd.ClipRect,
+          .texture = cmd.GetTexID(),
+          .indexOffset = cmd.IdxOffset,
+          .elemCount = cmd.ElemCount,
+          .vertexOffset = cmd.VtxOffset,
+          .callback = cmd.UserCallback,
+          .callbackData = cmd.UserCallbackData,
+      });
+      if (cmd.UserCallbackDataSize > 0) {
+        const auto* data = list.CallbacksDataBuf.Data + cmd.UserCallbackDataOffset;
+        frozenCmd.callbackData = nullptr;
+        frozenCmd.callbackDataOffset = static_cast<uint32_t>(frozen.callbackData.size());
+        frozenCmd.callbackDataSize = static_cast<uint32_t>(cmd.UserCallbackDataSize);
+        frozen.callbackData.insert(frozen.callbackData.end(), data, data + cmd.UserCallbackDataSize);
+      }
+      continue;
+    }
+    if (cmd.ElemCount == 0) {
+      continue;
+    }
+    frozen.commands.push_back({
+        .clipRect = cmd.ClipRect,
+        .texture = cmd.GetTexID(),
+        .indexOffset = cmd.IdxOffset,
+        .elemCount = cmd.ElemCount,
+        .vertexOffset = cmd.VtxOffset,
+    });
+  }
+  frozenList.commandCount = static_cast<uint32_t>(frozen.commands.size()) - frozenList.firstCommand;
+}
+
+// Writes the geometry straight into the frame's staging buffers, so it is copied exactly once on its way to the GPU.
+void stage_draw_lists(DrawData::Impl& frozen, const ImDrawData& data) {
+  ZoneScoped;
+  frozen.lists.clear();
+  frozen.commands.clear();
+  frozen.callbackData.clear();
+  frozen.overflowBuffer = {};
+  frozen.displayPos = data.DisplayPos;
+  frozen.displaySize = data.DisplaySize;
+  frozen.framebufferScale = data.FramebufferScale;
+
+  size_t vertexBytes = 0;
+  size_t indexBytes = 0;
+  for (const ImDrawList* list : data.CmdLists) {
+    vertexBytes += AURORA_ALIGN(static_cast<size_t>(list->VtxBuffer.size_in_bytes()), 4);
+    indexBytes += AURORA_ALIGN(static_cast<size_t>(list->IdxBuffer.size_in_bytes()), 4);
+  }
+  uint8_t* overflow = nullptr;
+  if (vertexBytes > gfx::vertex_space_remaining() || indexBytes > gfx::index_space_remaining()) {
+    const wgpu::BufferDescriptor descriptor{
+        .label = "ImGui Overflow Geometry",
+        .usage = wgpu::BufferUsage::Vertex | wgpu::BufferUsage::Index,
+        .size = vertexBytes + indexBytes,
+        .mappedAtCreation = true,
+    };
+    frozen.overflowBuffer = webgpu::g_device.CreateBuffer(&descriptor);
+    overflow = static_cast<uint8_t*>(frozen.overflowBuffer.GetMappedRange(0, vertexBytes + indexBytes));
+  }
+
+  const auto place = [overflow](size_t& cursor, const void* source, size_t size) {
+    const gfx::Range range{static_cast<uint32_t>(cursor), static_cast<uint32_t>(size)};
+    std::memcpy(overflow + cursor, source, size);
+    cursor += AURORA_ALIGN(size, 4);
+    return range;
+  };
+  size_t vertexCursor = 0;
+  size_t indexCursor = vertexBytes;
+  for (const ImDrawList* list : data.CmdLists) {
+    FrozenDrawList& frozenList = frozen.lists.emplace_back();
+    // Lists without geometry are still frozen for their callbacks.
+    if (!list->VtxBuffer.empty() && !list->IdxBuffer.empty()) {
+      const auto* vertices = reinterpret_cast<const uint8_t*>(list->VtxBuffer.Data);
+      const auto* indices = reinterpret_cast<const uint8_t*>(list->IdxBuffer.Data);
+      const auto verticesSize = static_cast<size_t>(list->VtxBuffer.size_in_bytes());
+      const auto indicesSize = static_cast<size_t>(list->IdxBuffer.size_in_bytes());
+      if (overflow != nullptr) {
+        frozenList.vertexRange = place(vertexCursor, vertices, verticesSize);
+        frozenList.indexRange = place(indexCursor, indices, indicesSize);
+      } else {
+        frozenList.vertexRange = gfx::push_verts(vertices, verticesSize, 4);
+        frozenList.indexRange = gfx::push_indices(indices, indicesSize, 4);
+      }
+    }
+    freeze_commands(frozen, frozenList, *list);
+    if (frozenList.commandCount == 0) {
+      frozen.lists.pop_back();
+    }
+  }
+  if (overflow != nullptr) {
+    frozen.overflowBuffer.Unmap();
+  }
+
+  const float left = data.DisplayPos.x;
+  const float right = data.DisplayPos.x + data.DisplaySize.x;
+  const float top = data.DisplayPos.y;
+  const float bottom = data.DisplayPos.y + data.DisplaySize.y;
+  const Uniforms uniforms{
+      // Column-major orthographic projection of the display rectangle.
+      .mvp = {2.f / (right - left), 0.f, 0.f, 0.f, 0.f, 2.f / (top - bottom), 0.f, 0.f, 0.f, 0.f, 0.5f, 0.f,
+              (right + left) / (left - right), (top + bottom) / (bottom - top), 0.5f, 1.f},
+      .gamma = g_gamma,
+  };
+  frozen.uniformRange = gfx::push_uniform(uniforms);
+}
+
+void render_frozen(const wgpu::RenderPassEncoder& pass, const DrawData::Impl& frozen) {
+  const auto targetWidth = static_cast<float>(webgpu::g_graphicsConfig.surfaceConfiguration.width);
+  const auto targetHeight = static_cast<float>(webgpu::g_graphicsConfig.surfaceConfiguration.height);
+  const float width = std::min(frozen.displaySize.x * frozen.framebufferScale.x, targetWidth);
+  const float height = std::min(frozen.displaySize.y * frozen.framebufferScale.y, targetHeight);
+  if (width <= 0.f || height <= 0.f) {
+    return;
+  }
+
+  const auto& res = gfx::detail::resources();
+  const auto& vertexBuffer = frozen.overflowBuffer ? frozen.overflowBuffer : res.vertexBuffer;
+  const auto& indexBuffer = frozen.overflowBuffer ? frozen.overflowBuffer : res.indexBuffer;
+  constexpr auto IndexFormat = sizeof(ImDrawIdx) == 2 ? wgpu::IndexFormat::Uint16 : wgpu::IndexFormat::Uint32;
+  const auto set_render_state = [&] {
+    pass.SetViewport(0.f, 0.f, width, height, 0.f, 1.f);
+    pass.SetPipeline(g_pipeline);
+    pass.SetBindGroup(0, res.uniformBindGroup, 1, &frozen.uniformRange.offset);
+  };
+  set_render_state();
+  // Callbacks written against ImGui's WebGPU backend find the pass the same way.
+  ImGui_ImplWGPU_RenderState renderState{
+      .Device = webgpu::g_device.Get(),
+      .RenderPassEncoder = pass.Get(),
+  };
+  ImGui::GetPlatformIO().Renderer_RenderState = &renderState;
+  std::optional<ImTextureID> boundTexture;
+  for (const auto& list : frozen.lists) {
+    const auto set_geometry = [&] {
+      if (list.vertexRange.size != 0) {
+        pass.SetVertexBuffer(0, vertexBuffer, list.vertexRange.offset, list.vertexRange.size);
+        pass.SetIndexBuffer(indexBuffer, IndexFormat, list.indexRange.offset, list.indexRange.size);
+      }
+    };
+    set_geometry();
+    for (const auto& cmd : std::span{frozen.commands}.subspan(list.firstCommand, list.commandCount)) {
+      if (cmd.callback != nullptr) {
+        if (cmd.callback != ImDrawCallback_ResetRenderState) {
+          // The draw list was handed back to ImGui in freeze, so callbacks only get the command.
+          ImDrawCmd drawCmd;
+          drawCmd.ClipRect = cmd.clipRect;
+          drawCmd.TextureId = cmd.texture;
+          drawCmd.VtxOffset = cmd.vertexOffset;
+          drawCmd.IdxOffset = cmd.indexOffset;
+          drawCmd.ElemCount = cmd.elemCount;
+          drawCmd.UserCallback = cmd.callback;
+          drawCmd.UserCallbackData =
+              cmd.callbackDataSize > 0
+                  ? const_cast<uint8_t*>(frozen.callbackData.data()) + cmd.callbackDataOffset
+                  : cmd.callbackData;
+          drawCmd.UserCallbackDataSize = static_cast<int>(cmd.callbackDataSize);
+          cmd.callback(nullptr, &drawCmd);
+        }
+        // The callback may have bound anything; put our state back before the next draw.
+        set_render_state();
+        set_geometry();
+        boundTexture.reset();
+        continue;
+      }
+      const float minX = std::clamp((cmd.clipRect.x - frozen.displayPos.x) * frozen.framebufferScale.x, 0.f, width);
+      const float minY = std::clamp((cmd.clipRect.y - frozen.displayPos.y) * frozen.framebufferScale.y, 0.f, height);
+      const float maxX = std::clamp((cmd.clipRect.z - frozen.displayPos.x) * frozen.framebufferScale.x, 0.f, width);
+      const float maxY = std::clamp((cmd.clipRect.w - frozen.displayPos.y) * frozen.framebufferScale.y, 0.f, height);
+      if (maxX <= minX || maxY <= minY) {
+        continue;
+      }
+      pass.SetScissorRect(static_cast<uint32_t>(minX), static_cast<uint32_t>(minY),
+                          static_cast<uint32_t>(maxX - minX), static_cast<uint32_t>(maxY - minY));
+      if (boundTexture != cmd.texture) {
+        pass.SetBindGroup(1, texture_bind_group(cmd.texture));
+        boundTexture = cmd.texture;
+      }
+      pass.DrawIndexed(cmd.elemCount, 1, cmd.indexOffset, static_cast<int32_t>(cmd.vertexOffset), 0);
+    }
+  }
+  ImGui::GetPlatformIO().Renderer_RenderState = nullptr;
+}
+} // namespace
+
 void create_context() noexcept {
   IMGUI_CHECKVERSION();
   ImGui::CreateContext();
@@ -98,10 +639,10 @@ void initialize() noexcept {
   if (g_useSdlRenderer) {
     ImGui_ImplSDLRenderer3_Init(renderer);
   } else {
-    ImGui_ImplWGPU_InitInfo info;
-    info.Device = webgpu::g_device.Get();
-    info.RenderTargetFormat = static_cast<WGPUTextureFormat>(webgpu::g_graphicsConfig.surfaceConfiguration.format);
-    ImGui_ImplWGPU_Init(&info);
+    ImGuiIO& io = ImGui::GetIO();
+    io.BackendRendererName = "aurora_webgpu";
+    io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;
+    create_pipeline();
   }
 }
 
@@ -110,15 +651,26 @@ void shutdown() noexcept {
   if (g_useSdlRenderer) {
     ImGui_ImplSDLRenderer3_Shutdown();
   } else {
-    ImGui_ImplWGPU_Shutdown();
+    ImGuiIO& io = ImGui::GetIO();
+    io.BackendRendererName = nullptr;
+    io.BackendFlags &= ~ImGuiBackendFlags_RendererHasVtxOffset;
+    io.Fonts->SetTexID(ImTextureID{});
   }
   ImGui_ImplSDL3_Shutdown();
+  g_frozen = {};
+  g_nextFrozen = 0;
   ImGui::DestroyContext();
   for (const auto& texture : g_sdlTextures) {
     SDL_DestroyTexture(texture);
   }
   g_sdlTextures.clear();
   g_wgpuTextures.clear();
+  g_textureBindGroups.clear();
+  g_fontTexture = {};
+  g_fontTextureView = {};
+  g_sampler = {};
+  g_pipeline = {};
+  g_textureBindGroupLayout = {};
 }
 
 void process_event(const SDL_Event& event) noexcept {
@@ -184,16 +736,15 @@ void new_frame(const AuroraWindowSize& size) noexcept {
     ImGui_ImplSDLRenderer3_NewFrame();
     g_scale = size.scale;
   } else {
+    // The atlas is rebuilt by the application on scale changes.
+    bool fontsChanged = !g_fontTexture || !ImGui::GetIO().Fonts->IsBuilt();
     if (g_scale != size.scale) {
-      if (g_scale > 0.f) {
-        ImGui_ImplWGPU_CreateDeviceObjects();
-      }
+      fontsChanged |= g_scale > 0.f;
       g_scale = size.scale;
     }
-    if (!ImGui::GetIO().Fonts->IsBuilt()) {
-      ImGui_ImplWGPU_CreateDeviceObjects();
+    if (fontsChanged) {
+      create_font_texture();
     }
-    ImGui_ImplWGPU_NewFrame();
   }
   ImGui_ImplSDL3_NewFrame();
 
@@ -209,15 +760,14 @@ DrawData freeze() noexcept {
 
   auto* data = ImGui::GetDrawData();
   data->FramebufferScale = ImGui::GetIO().DisplayFramebufferScale;
-  auto frozen = std::make_shared<DrawData::Impl>();
-  frozen->drawData = *data;
-  frozen->drawLists.reserve(data->CmdListsCount);
-  frozen->drawData.CmdLists.resize(data->CmdListsCount);
-  for (int i = 0; i < data->CmdListsCount; ++i) {
-    frozen->drawLists.emplace_back(data->CmdLists[i]->CloneOutput());
-    frozen->drawData.CmdLists[i] = frozen->drawLists.back().get();
+  auto& frozen = g_frozen[g_nextFrozen];
+  g_nextFrozen = (g_nextFrozen + 1) % g_frozen.size();
+  if (g_useSdlRenderer) {
+    swap_draw_lists(frozen, *data);
+  } else {
+    stage_draw_lists(frozen, *data);
   }
-  return DrawData{std::move(frozen)};
+  return DrawData{&frozen};
 }
 
 void render(const wgpu::RenderPassEncoder& pass, const DrawData& drawData) noexcept {
@@ -226,18 +776,21 @@ void render(const wgpu::RenderPassEncoder& pass, const DrawData& drawData) noexc
   if (!drawData.m_impl) {
     return;
   }
-  auto* data = &drawData.m_impl->drawData;
-  if (data->CmdListsCount == 0) {
-    return;
-  }
   if (g_useSdlRenderer) {
+    auto* data = &drawData.m_impl->drawData;
+    if (data->CmdListsCount == 0) {
+      return;
+    }
     SDL_Renderer* renderer = window::get_sdl_renderer();
     SDL_RenderClear(renderer);
     ImGui_ImplSDLRenderer3_RenderDrawData(data, renderer);
     SDL_RenderPresent(renderer);
   } else {
+    if (drawData.m_impl->commands.empty()) {
+      return;
+    }
     pass.PushDebugGroup("Aurora: Dear Imgui");
-    ImGui_ImplWGPU_RenderDrawData(data, pass.Get());
+    render_frozen(pass, *drawData.m_impl);
     pass.PopDebugGroup();
   }
 }
@@ -250,41 +803,7 @@ ImTextureID add_texture(uint32_t width, uint32_t height, const uint8_t* data) no
     g_sdlTextures.push_back(texture);
     return reinterpret_cast<ImTextureID>(texture);
   }
-  const wgpu::Extent3D size{
-      .width = width,
-      .height = height,
-      .depthOrArrayLayers = 1,
-  };
-  const wgpu::TextureDescriptor textureDescriptor{
-      .label = "imgui texture",
-      .usage = wgpu::TextureUsage::TextureBinding | wgpu::TextureUsage::CopyDst,
-      .dimension = wgpu::TextureDimension::e2D,
-      .size = size,
-      .format = wgpu::TextureFormat::RGBA8Unorm,
-      .mipLevelCount = 1,
-      .sampleCount = 1,
-  };
-  const wgpu::TextureViewDescriptor textureViewDescriptor{
-      .label = "imgui texture view",
-      .format = wgpu::TextureFormat::RGBA8Unorm,
-      .dimension = wgpu::TextureViewDimension::e2D,
-      .mipLevelCount = WGPU_MIP_LEVEL_COUNT_UNDEFINED,
-      .arrayLayerCount = WGPU_ARRAY_LAYER_COUNT_UNDEFINED,
-  };
-  auto texture = webgpu::g_device.CreateTexture(&textureDescriptor);
-  auto textureView = texture.CreateView(&textureViewDescriptor);
-  {
-    const wgpu::TexelCopyTextureInfo dstView{
-        .texture = texture,
-    };
-    const uint32_t copyBytesPerRow = AURORA_ALIGN(width * 4, 256);
-    const wgpu::TexelCopyBufferLayout dataLayout{
-        .bytesPerRow = copyBytesPerRow,
-        .rowsPerImage = height,
-    };
-    enqueue_texture_upload(create_texture_upload_buffer(width, height, data, copyBytesPerRow), dstView, dataLayout,
-                           size);
-  }
+  auto [texture, textureView] = create_texture(width, height, data);
   g_wgpuTextures.push_back(texture);
   return reinterpret_cast<ImTextureID>(textureView.MoveToCHandle());
 }
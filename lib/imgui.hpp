@@ -2,9 +2,6 @@
 
 #include <aurora/event.h>
 
-#include <memory>
-#include <utility>
-
 union SDL_Event;
 
 namespace wgpu {
@@ -14,14 +11,16 @@ class RenderPassEncoder;
 namespace aurora::imgui {
 class DrawData {
 public:
+  // Defined in imgui.cpp. One instance per frame slot is reused instead of allocating each frame.
+  struct Impl;
+
   DrawData() noexcept = default;
   [[nodiscard]] explicit operator bool() const noexcept { return m_impl != nullptr; }
 
 private:
-  struct Impl;
-  explicit DrawData(std::shared_ptr<Impl> impl) noexcept : m_impl(std::move(impl)) {}
+  explicit DrawData(Impl* impl) noexcept : m_impl(impl) {}
 
-  std::shared_ptr<Impl> m_impl;
+  Impl* m_impl = nullptr;
 
   friend DrawData freeze() noexcept;
   friend void render(const wgpu::RenderPassEncoder& pass, const DrawData& drawData) noexcept;
@@ -52,6 +52,7 @@ struct DevicePreference {
 std::array<PortPreference, PAD_MAX_CONTROLLERS> g_portPreferences;
 DevicePreference g_devicePreference;
 bool g_portPreferencesLoaded = false;
+void (*g_shutdownHook)() = nullptr;
 
 std::filesystem::path port_preferences_path() {
   if (g_config.userPath == nullptr) {
@@ -473,7 +474,12 @@ void get_mouse_scroll(float* scrollX, float* scrollY) noexcept {
   *scrollY = g_MouseStatus.scrollY;
 }
 
+void set_shutdown_hook(void (*hook)()) noexcept { g_shutdownHook = hook; }
+
 void shutdown() noexcept {
+  if (g_shutdownHook != nullptr) {
+    g_shutdownHook();
+  }
   // Upon shutdown we want to ensure all controllers are in a default state, so force all rumble supporting controllers
   // to shut off their rumble motors.
   for (const auto& controller : g_GameControllers) {
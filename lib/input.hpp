@@ -63,5 +63,7 @@ extern absl::flat_hash_map<Uint32, GameController> g_GameControllers;
 void set_mouse_scroll(float scrollX, float scrollY) noexcept;
 void get_mouse_scroll(float* scrollX, float* scrollY) noexcept;
 
+// Called at the start of shutdown, before SDL input is torn down. Lets aurora::pad stop its sampler thread.
+void set_shutdown_hook(void (*hook)()) noexcept;
 void shutdown() noexcept;
 } // namespace aurora::input
@@ -2,6 +2,7 @@
 
 #include <array>
 #include <atomic>
+#include <cerrno>
 #include <cstring>
 #include <exception>
 #include <limits>
@@ -10,6 +11,21 @@
 
 #include <SDL3/SDL_filesystem.h>
 
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace aurora::io {
 namespace {
 
@@ -235,6 +251,89 @@ bool AtomicFileWriter::commit() noexcept {
   return true;
 }
 
+MappedFile::~MappedFile() { unmap(); }
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+: m_data(std::exchange(other.m_data, nullptr)), m_size(std::exchange(other.m_size, 0)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+  if (this != &other) {
+    unmap();
+    m_data = std::exchange(other.m_data, nullptr);
+    m_size = std::exchange(other.m_size, 0);
+  }
+  return *this;
+}
+
+void MappedFile::unmap() noexcept {
+  if (m_data == nullptr) {
+    return;
+  }
+#ifdef _WIN32
+  UnmapViewOfFile(m_data);
+#else
+  munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+  m_data = nullptr;
+  m_size = 0;
+}
+
+MappedFile map_file(const std::filesystem::path& path) noexcept {
+  MappedFile file;
+#ifdef _WIN32
+  HANDLE handle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (handle == INVALID_HANDLE_VALUE) {
+    SDL_SetError("Failed to open file for mapping (error %lu)", GetLastError());
+    return file;
+  }
+  LARGE_INTEGER size{};
+  if (!GetFileSizeEx(handle, &size) || size.QuadPart <= 0 ||
+      static_cast<uint64_t>(size.QuadPart) > std::numeric_limits<size_t>::max()) {
+    SDL_SetError("Failed to map file: invalid size");
+    CloseHandle(handle);
+    return file;
+  }
+  HANDLE mapping = CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  CloseHandle(handle);
+  if (mapping == nullptr) {
+    SDL_SetError("Failed to create file mapping (error %lu)", GetLastError());
+    return file;
+  }
+  // The view keeps the mapping alive
+  void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  CloseHandle(mapping);
+  if (data == nullptr) {
+    SDL_SetError("Failed to map view of file (error %lu)", GetLastError());
+    return file;
+  }
+  file.m_data = static_cast<const uint8_t*>(data);
+  file.m_size = static_cast<size_t>(size.QuadPart);
+#else
+  const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    SDL_SetError("Failed to open file for mapping: %s", std::strerror(errno));
+    return file;
+  }
+  struct stat st{};
+  if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+    SDL_SetError("Failed to map file: invalid size");
+    close(fd);
+    return file;
+  }
+  // The mapping stays valid after the descriptor is closed
+  void* data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    SDL_SetError("Failed to map file: %s", std::strerror(errno));
+    return file;
+  }
+  file.m_data = static_cast<const uint8_t*>(data);
+  file.m_size = static_cast<size_t>(st.st_size);
+#endif
+  return file;
+}
+
 AtomicFileWriter open_atomic_file(const std::filesystem::path& path, AtomicFileMode mode) noexcept {
 #if defined(__cpp_exceptions) || defined(_CPPUNWIND)
   try {
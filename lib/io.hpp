@@ -70,6 +70,32 @@ private:
   std::string m_targetPath;
 };
 
+/** A read-only memory mapping of a whole file. */
+class MappedFile {
+public:
+  MappedFile() = default;
+  ~MappedFile();
+
+  MappedFile(MappedFile&& other) noexcept;
+  MappedFile& operator=(MappedFile&& other) noexcept;
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  [[nodiscard]] std::span<const uint8_t> data() const noexcept { return {m_data, m_size}; }
+  explicit operator bool() const noexcept { return m_data != nullptr; }
+
+private:
+  friend MappedFile map_file(const std::filesystem::path&) noexcept;
+
+  void unmap() noexcept;
+
+  const uint8_t* m_data = nullptr;
+  size_t m_size = 0;
+};
+
+/** Maps path for reading. Fails for empty files. */
+MappedFile map_file(const std::filesystem::path& path) noexcept;
+
 AtomicFileWriter open_atomic_file(const std::filesystem::path& path,
                                   AtomicFileMode mode = AtomicFileMode::Truncate) noexcept;
 bool write_file_atomic(const std::filesystem::path& path, std::span<const uint8_t> data) noexcept;
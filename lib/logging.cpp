@@ -4,20 +4,312 @@
 #include <fmt/format.h>
 #include <aurora/aurora.h>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
 
 namespace aurora {
-void log_internal(const AuroraLogLevel level, const char* module, const char* message,
-                  const unsigned int len) noexcept {
-  if (module == nullptr) {
-    module = "";
+namespace {
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t RingSize = 65536;
+constexpr size_t RecordAlignment = 16;
+// Longer messages are truncated on the asynchronous path.
+constexpr size_t MaxMessageSize = 8192;
+constexpr size_t MaxModuleSize = 64;
+// Only messages up to this size are compared against the previous one.
+constexpr size_t MaxDedupSize = 256;
+constexpr uint32_t PaddingRecord = UINT32_MAX;
+constexpr uint32_t NoMessage = UINT32_MAX;
+constexpr uint64_t RepeatCountMask = UINT32_MAX;
+constexpr auto WriterInterval = std::chrono::milliseconds{50};
+// How long a run of repeated messages may go unreported when nothing else is logged.
+constexpr auto RepeatSummaryInterval = std::chrono::seconds{1};
+
+// Records are a header followed by the NUL-terminated module and message, padded to RecordAlignment. A record that
+// would not fit before the end of the ring is preceded by a padding record covering the remainder.
+struct RecordHeader {
+  uint32_t size;
+  uint32_t level;
+  uint32_t moduleLen;
+  uint32_t messageLen;
+};
+// Every gap left at the end of the ring is a multiple of the alignment, so a padding record always fits in it.
+static_assert(RecordAlignment >= sizeof(RecordHeader) && RingSize % RecordAlignment == 0);
+
+// Single-producer, single-consumer ring owned by one thread at a time. The consumer side is guarded by g_mutex.
+struct Ring {
+  alignas(64) std::atomic_size_t head = 0;
+  alignas(64) std::atomic_size_t tail = 0;
+  // Messages identical to the last one pushed and not yet reported in the low 32 bits, and the number of distinct
+  // messages pushed in the high 32 bits. The count is claimed, and never handed back, either by the producer when the
+  // message changes or by the consumer once the producer goes quiet; a claim made for an earlier message fails.
+  std::atomic_uint64_t repeats = 0;
+  std::atomic_bool owned = true;
+
+  // Producer side
+  AuroraLogLevel lastLevel = LOG_DEBUG;
+  uint32_t lastLen = NoMessage;
+  std::array<char, MaxModuleSize> lastModule{};
+  std::array<char, MaxDedupSize> lastMessage{};
+
+  // Consumer side
+  AuroraLogLevel writtenLevel = LOG_DEBUG;
+  std::string writtenModule;
+  Clock::time_point lastWrite;
+
+  alignas(RecordAlignment) std::array<uint8_t, RingSize> data{};
+};
+
+struct RingOwner {
+  Ring* ring = nullptr;
+  ~RingOwner() {
+    if (ring != nullptr) {
+      ring->owned.store(false, std::memory_order_release);
+    }
   }
+};
+
+std::mutex g_mutex;
+std::vector<std::unique_ptr<Ring>> g_rings;
+std::condition_variable g_wake;
+std::thread g_writer;
+bool g_stopWriter = false;
+std::atomic_bool g_async = false;
+thread_local RingOwner t_ring;
+// Set while a message is being written, so messages logged by the callback itself are written synchronously.
+thread_local bool t_writing = false;
+
+void write_record(const AuroraLogLevel level, const char* module, const char* message, const unsigned int len) {
+  const bool writing = std::exchange(t_writing, true);
   if (g_config.logCallback == nullptr) {
     fmt::println(stderr, "[{}] [{}] {}", level, module, std::string_view(message, len));
   } else {
     g_config.logCallback(level, module, message, len);
   }
+  t_writing = writing;
+}
+
+void write_repeats(const AuroraLogLevel level, const char* module, const uint32_t repeats) {
+  std::array<char, 64> summary;
+  const auto result =
+      fmt::format_to_n(summary.data(), summary.size() - 1, "Previous message repeated {} times", repeats);
+  *result.out = '\0';
+  write_record(level, module, summary.data(), static_cast<unsigned int>(result.out - summary.data()));
+}
+
+void drain_locked(Ring& ring, const bool force) {
+  size_t tail = ring.tail.load(std::memory_order_relaxed);
+  const size_t head = ring.head.load(std::memory_order_acquire);
+  const auto now = Clock::now();
+  if (tail != head) {
+    ring.lastWrite = now;
+  }
+  while (tail != head) {
+    const uint8_t* record = ring.data.data() + tail % RingSize;
+    RecordHeader header;
+    std::memcpy(&header, record, sizeof(header));
+    if (header.moduleLen != PaddingRecord) {
+      const auto* module = reinterpret_cast<const char*>(record + sizeof(header));
+      const char* message = module + header.moduleLen + 1;
+      const auto level = static_cast<AuroraLogLevel>(header.level);
+      write_record(level, module, message, header.messageLen);
+      ring.writtenLevel = level;
+      ring.writtenModule.assign(module, header.moduleLen);
+    }
+    tail += header.size;
+  }
+  ring.tail.store(tail, std::memory_order_release);
+
+  if (!force && now - ring.lastWrite < RepeatSummaryInterval) {
+    return;
+  }
+  // Acquire orders this before the head load: the repeated message was pushed before its repeats were counted.
+  uint64_t state = ring.repeats.load(std::memory_order_acquire);
+  const uint64_t message = state & ~RepeatCountMask;
+  if (state == message || ring.head.load(std::memory_order_acquire) != tail) {
+    // Nothing to report, or the producer moved on after the drain and will report the repeats itself.
+    return;
+  }
+  while (!ring.repeats.compare_exchange_weak(state, message, std::memory_order_acq_rel, std::memory_order_acquire)) {
+    if ((state & ~RepeatCountMask) != message) {
+      return;
+    }
+  }
+  write_repeats(ring.writtenLevel, ring.writtenModule.c_str(), static_cast<uint32_t>(state & RepeatCountMask));
+  ring.lastWrite = now;
+}
+
+void drain_all_locked(const bool force) {
+  for (const auto& ring : g_rings) {
+    drain_locked(*ring, force);
+  }
+}
+
+void writer_main() {
+  std::unique_lock lock{g_mutex};
+  while (!g_stopWriter) {
+    g_wake.wait_for(lock, WriterInterval);
+    drain_all_locked(false);
+  }
+}
+
+Ring& thread_ring() {
+  if (t_ring.ring != nullptr) {
+    return *t_ring.ring;
+  }
+  std::lock_guard lock{g_mutex};
+  const auto it = std::ranges::find_if(
+      g_rings, [](const auto& ring) { return !ring->owned.load(std::memory_order_acquire); });
+  if (it != g_rings.end()) {
+    // Finish what the previous owner queued before its deduplication state is reset.
+    drain_locked(**it, true);
+    (*it)->owned.store(true, std::memory_order_relaxed);
+    (*it)->lastLen = NoMessage;
+    t_ring.ring = it->get();
+  } else {
+    t_ring.ring = g_rings.emplace_back(std::make_unique<Ring>()).get();
+  }
+  return *t_ring.ring;
+}
+
+bool try_push(Ring& ring, const AuroraLogLevel level, std::string_view module, std::string_view message) {
+  const size_t size = (sizeof(RecordHeader) + module.size() + 1 + message.size() + 1 + RecordAlignment - 1) &
+                      ~(RecordAlignment - 1);
+  const size_t head = ring.head.load(std::memory_order_relaxed);
+  const size_t remaining = RingSize - head % RingSize;
+  const size_t padding = remaining < size ? remaining : 0;
+  const size_t used = head - ring.tail.load(std::memory_order_acquire);
+  if (used + padding + size > RingSize) {
+    return false;
+  }
+
+  if (padding != 0) {
+    const RecordHeader header{.size = static_cast<uint32_t>(padding), .moduleLen = PaddingRecord};
+    std::memcpy(ring.data.data() + head % RingSize, &header, sizeof(header));
+  }
+  uint8_t* record = ring.data.data() + (head + padding) % RingSize;
+  const RecordHeader header{
+      .size = static_cast<uint32_t>(size),
+      .level = static_cast<uint32_t>(level),
+      .moduleLen = static_cast<uint32_t>(module.size()),
+      .messageLen = static_cast<uint32_t>(message.size()),
+  };
+  std::memcpy(record, &header, sizeof(header));
+  auto* text = reinterpret_cast<char*>(record + sizeof(header));
+  std::memcpy(text, module.data(), module.size());
+  text[module.size()] = '\0';
+  text += module.size() + 1;
+  std::memcpy(text, message.data(), message.size());
+  text[message.size()] = '\0';
+  ring.head.store(head + padding + size, std::memory_order_release);
+  if (used + padding + size > RingSize / 2) {
+    g_wake.notify_one();
+  }
+  return true;
+}
+
+void push(Ring& ring, const AuroraLogLevel level, std::string_view module, std::string_view message) {
+  // A full ring is drained on the calling thread rather than dropping the message.
+  while (!try_push(ring, level, module, message)) {
+    flush_logs();
+  }
+}
+
+void log_async(const AuroraLogLevel level, const char* module, const char* message, const unsigned int len) {
+  Ring& ring = thread_ring();
+  const std::string_view moduleView{module, std::min(std::strlen(module), MaxModuleSize - 1)};
+  const std::string_view messageView{message, std::min<size_t>(len, MaxMessageSize)};
+  if (ring.lastLen == messageView.size() && ring.lastLevel == level &&
+      moduleView == std::string_view{ring.lastModule.data()} &&
+      std::memcmp(ring.lastMessage.data(), messageView.data(), messageView.size()) == 0) {
+    // Release orders this after the push of the repeated message for the writer's check in drain_locked.
+    ring.repeats.fetch_add(1, std::memory_order_release);
+    return;
+  }
+
+  // A new message claims the repeats of the previous one. Only the producer changes the message count.
+  const uint64_t nextMessage = (ring.repeats.load(std::memory_order_relaxed) | RepeatCountMask) + 1;
+  const auto repeats =
+      static_cast<uint32_t>(ring.repeats.exchange(nextMessage, std::memory_order_acq_rel) & RepeatCountMask);
+  if (repeats != 0) {
+    std::array<char, 64> summary;
+    const auto result =
+        fmt::format_to_n(summary.data(), summary.size(), "Previous message repeated {} times", repeats);
+    push(ring, ring.lastLevel, ring.lastModule.data(),
+         std::string_view{summary.data(), static_cast<size_t>(result.out - summary.data())});
+  }
+  push(ring, level, moduleView, messageView);
+
+  if (messageView.size() <= ring.lastMessage.size()) {
+    ring.lastLevel = level;
+    ring.lastLen = static_cast<uint32_t>(messageView.size());
+    std::memcpy(ring.lastModule.data(), moduleView.data(), moduleView.size());
+    ring.lastModule[moduleView.size()] = '\0';
+    std::memcpy(ring.lastMessage.data(), messageView.data(), messageView.size());
+  } else {
+    ring.lastLen = NoMessage;
+  }
+}
+
+// Stops the writer if the application exits without shutting down, since a joinable std::thread would terminate.
+struct AsyncLoggingGuard {
+  ~AsyncLoggingGuard() { set_async_logging(false); }
+} g_asyncLoggingGuard;
+} // namespace
+
+void log_internal(const AuroraLogLevel level, const char* module, const char* message,
+                  const unsigned int len) noexcept {
+  if (module == nullptr) {
+    module = "";
+  }
+  if (!g_async.load(std::memory_order_acquire) || t_writing) {
+    write_record(level, module, message, len);
+    return;
+  }
+  if (level == LOG_FATAL) {
+    // The process is about to abort: write everything queued before this message, then the message itself.
+    std::lock_guard lock{g_mutex};
+    drain_all_locked(true);
+    write_record(level, module, message, len);
+    return;
+  }
+  log_async(level, module, message, len);
+}
+
+void set_async_logging(const bool enabled) noexcept {
+  std::unique_lock lock{g_mutex};
+  if (enabled == g_writer.joinable()) {
+    return;
+  }
+  if (enabled) {
+    g_stopWriter = false;
+    g_writer = std::thread{writer_main};
+    g_async.store(true, std::memory_order_release);
+    return;
+  }
+  g_async.store(false, std::memory_order_release);
+  g_stopWriter = true;
+  lock.unlock();
+  g_wake.notify_one();
+  g_writer.join();
+  flush_logs();
+}
+
+void flush_logs() noexcept {
+  std::lock_guard lock{g_mutex};
+  drain_all_locked(true);
 }
 } // namespace aurora
 
@@ -6,11 +6,19 @@
 #include <fmt/format.h>
 
 #include <cstdlib>
+#include <iterator>
 #include <string_view>
 
 namespace aurora {
 void log_internal(AuroraLogLevel level, const char* module, const char* message, unsigned int len) noexcept;
 
+// When enabled, messages are copied into per-thread rings and written by a background thread, and identical
+// consecutive messages from a thread are collapsed into a "repeated N times" summary. Fatal messages are written
+// synchronously after everything queued before them. Disabling flushes and stops the writer thread.
+void set_async_logging(bool enabled) noexcept;
+// Writes every queued message before returning.
+void flush_logs() noexcept;
+
 extern AuroraConfig g_config;
 
 struct Module {
@@ -22,8 +30,11 @@ struct Module {
     if (g_config.logLevel > level) {
       return;
     }
-    auto message = fmt::format(fmt, std::forward<T>(args)...);
-    log_internal(level, name, message.c_str(), static_cast<unsigned int>(message.size()));
+    fmt::memory_buffer message;
+    fmt::format_to(std::back_inserter(message), fmt, std::forward<T>(args)...);
+    const auto len = static_cast<unsigned int>(message.size());
+    message.push_back('\0');
+    log_internal(level, name, message.data(), len);
   }
 
   template <typename... T>
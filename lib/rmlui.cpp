@@ -17,6 +17,7 @@
 #include "rmlui/GlassFilter.hpp"
 #include "rmlui/SystemInterface_Aurora.h"
 #include "rmlui/WebGPURenderInterface.hpp"
+#include "rmlui/image_loader.hpp"
 #include "webgpu/gpu.hpp"
 
 namespace aurora::rmlui {
@@ -489,6 +490,7 @@ void shutdown() noexcept {
 
   Rml::Shutdown();
   Backend::Shutdown();
+  image_loader::shutdown();
   g_context = nullptr;
   s_renderTarget = {};
   s_renderTargetCopyBindGroup = {};
@@ -27,6 +27,8 @@ bool is_absolute_path(std::string_view path) {
 
 constexpr std::string_view FileScheme = "file://";
 
+} // namespace
+
 std::string resolve_path(const Rml::String& source) {
   std::string path(source);
   if (path.compare(0, FileScheme.size(), FileScheme) == 0) {
@@ -42,8 +44,6 @@ std::string resolve_path(const Rml::String& source) {
   return std::string(basePath) + path;
 }
 
-} // namespace
-
 Rml::FileHandle FileInterface_SDL::Open(const Rml::String& path) {
   const std::string resolvedPath = resolve_path(path);
   SDL_IOStream* stream = SDL_IOFromFile(resolvedPath.c_str(), "rb");
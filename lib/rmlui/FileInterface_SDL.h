@@ -2,8 +2,14 @@
 
 #include <RmlUi/Core/FileInterface.h>
 
+#include <string>
+
 namespace aurora::rmlui {
 
+// The file path Open reads for a source: file:// is stripped and relative paths are resolved against the resources
+// path.
+std::string resolve_path(const Rml::String& source);
+
 class FileInterface_SDL : public Rml::FileInterface {
 public:
   FileInterface_SDL() = default;
@@ -1,15 +1,14 @@
 #include "WebGPURenderInterface.hpp"
 
-#include "FileInterface_SDL.h"
 #include "RuntimeTextureProvider.hpp"
+#include "blur_plan.hpp"
+#include "geometry_arena.hpp"
+#include "image_loader.hpp"
 #include "pipeline.hpp"
 
 #include <RmlUi/Core/Core.h>
 #include <RmlUi/Core/DecorationTypes.h>
 
-#include <SDL3/SDL_iostream.h>
-#include <SDL3/SDL_surface.h>
-
 #include <algorithm>
 #include <array>
 #include <limits>
@@ -20,6 +19,7 @@
 
 #include "../gfx/recording.hpp"
 #include "../gfx/texture.hpp"
+#include "../internal.hpp"
 #include "../logging.hpp"
 #include "../webgpu/gpu.hpp"
 
@@ -30,16 +30,23 @@ Module Log("aurora::rmlui::RenderInterface");
 constexpr size_t rmlBufferOffsetAlignment = 4;
 constexpr float FilterEpsilon = 0.0001f;
 
-struct Image {
-  std::unique_ptr<uint8_t[]> data;
-  size_t size;
-  uint32_t width;
-  uint32_t height;
-};
+uint64_t g_nextContentId = 1;
 
 struct ShaderGeometryData {
+  // Released once the geometry is queued for upload into `allocation`.
   std::vector<Rml::Vertex> vertices;
   std::vector<uint32_t> indices;
+  GeometryAllocation allocation;
+  uint32_t vertexSize = 0;
+  uint32_t indexCount = 0;
+  // Unique for the lifetime of the process, unlike the handle address.
+  uint64_t id = g_nextContentId++;
+};
+
+struct GeometryRanges {
+  gfx::Range vertexRange;
+  gfx::Range indexRange;
+  uint32_t buffer = 0;
 };
 
 struct ShaderTextureData {
@@ -49,6 +56,10 @@ struct ShaderTextureData {
   wgpu::Extent3D m_size{};
   uint32_t m_rowBytes = 0;
   bool m_uploaded = false;
+  // Non-zero while the texels are being decoded on the image loader's worker pool.
+  image_loader::LoadId m_pendingLoad = 0;
+  // Changes whenever the texels do, so layer signatures never match across different texture contents.
+  uint64_t m_contentId = g_nextContentId++;
 };
 
 struct CompiledShaderData {
@@ -82,66 +93,6 @@ struct CompiledFilter {
   Rml::Vector4f radii;
 };
 
-Image get_image(const Rml::String& source) {
-  FileInterface_SDL fileInterface;
-  const Rml::FileHandle file = fileInterface.Open(source);
-  if (file == Rml::FileHandle{}) {
-    return {};
-  }
-
-  auto* stream = reinterpret_cast<SDL_IOStream*>(file);
-  SDL_Surface* loadedSurface = SDL_LoadPNG_IO(stream, true);
-  if (loadedSurface == nullptr) {
-    Log.warn("Failed to load image '{}': {}", source, SDL_GetError());
-    return {};
-  }
-
-  SDL_Surface* rgbaSurface = SDL_ConvertSurface(loadedSurface, SDL_PIXELFORMAT_RGBA32);
-  SDL_DestroySurface(loadedSurface);
-  if (rgbaSurface == nullptr) {
-    Log.warn("Failed to convert image '{}': {}", source, SDL_GetError());
-    return {};
-  }
-
-  const auto iconWidth = static_cast<uint32_t>(rgbaSurface->w);
-  const auto iconHeight = static_cast<uint32_t>(rgbaSurface->h);
-  const size_t rowSize = static_cast<size_t>(iconWidth) * 4;
-  const size_t size = rowSize * static_cast<size_t>(iconHeight);
-  auto ptr = std::make_unique<uint8_t[]>(size);
-  for (uint32_t row = 0; row < iconHeight; ++row) {
-    const auto* src = static_cast<const uint8_t*>(rgbaSurface->pixels) +
-                      static_cast<size_t>(row) * static_cast<size_t>(rgbaSurface->pitch);
-    auto* dst = ptr.get() + static_cast<size_t>(row) * rowSize;
-    std::memcpy(dst, src, rowSize);
-
-    // Convert colors to premultiplied alpha, which is necessary for correct alpha compositing.
-    for (size_t col = 0; col < rowSize; col += 4) {
-      const uint8_t alpha = dst[col + 3];
-      for (size_t channel = 0; channel < 3; ++channel) {
-        dst[col + channel] =
-            static_cast<uint8_t>((static_cast<uint32_t>(dst[col + channel]) * static_cast<uint32_t>(alpha)) / 255);
-      }
-    }
-  }
-
-  SDL_DestroySurface(rgbaSurface);
-  return Image{
-      .data = std::move(ptr),
-      .size = size,
-      .width = iconWidth,
-      .height = iconHeight,
-  };
-}
-
-void sigma_to_params(float desiredSigma, int& passLevel, float& sigma) {
-  constexpr int MaxPasses = 10;
-  constexpr float MaxSinglePassSigma = 3.f;
-  const int downsampleHint = static_cast<int>(desiredSigma * (2.f / MaxSinglePassSigma));
-  passLevel = downsampleHint > 0 ? static_cast<int>(std::log2(static_cast<float>(downsampleHint))) : 0;
-  passLevel = std::clamp(passLevel, 0, MaxPasses);
-  sigma = std::clamp(desiredSigma / static_cast<float>(1 << passLevel), 0.f, MaxSinglePassSigma);
-}
-
 Rml::Vector4f blur_weights(float sigma, uint32_t radius) {
   std::array<float, MaxBlurRadius + 1> scalarWeights = {};
   float normalization = 0.f;
@@ -259,12 +210,6 @@ bool try_fold_simple_filters(Rml::Span<const Rml::CompiledFilterHandle> filters,
   return true;
 }
 
-Rml::Rectanglei downsample_scissor(Rml::Rectanglei scissor) {
-  scissor.p0 = (scissor.p0 + Rml::Vector2i(1)) / 2;
-  scissor.p1 = Rml::Math::Max(scissor.p1 / 2, scissor.p0);
-  return scissor;
-}
-
 PipelineConfig make_pipeline_config(PipelineKind kind, wgpu::TextureFormat colorFormat, uint32_t sampleCount,
                                     VertexLayoutKind vertexLayout, StencilMode stencilMode, BlendMode blendMode,
                                     wgpu::ColorWriteMask colorWriteMask = wgpu::ColorWriteMask::All) {
@@ -363,6 +308,47 @@ void queue_texture_upload_if_needed(ShaderTextureData& texture) {
   texture.m_uploaded = true;
 }
 
+void queue_geometry_upload_if_needed(ShaderGeometryData& geometry) {
+  if (geometry.allocation.buffer != 0 || geometry.indexCount == 0) {
+    return;
+  }
+  const uint32_t indexSize = geometry.indexCount * sizeof(uint32_t);
+  const auto indexOffset = static_cast<uint32_t>(AURORA_ALIGN(geometry.vertexSize, rmlBufferOffsetAlignment));
+  geometry.allocation = allocate_geometry(indexOffset + indexSize);
+  if (geometry.allocation.buffer == 0) {
+    return;
+  }
+  const auto& buffer = geometry_buffer(geometry.allocation.buffer);
+  gfx::queue_buffer_upload_data(reinterpret_cast<const uint8_t*>(geometry.vertices.data()), geometry.vertexSize,
+                                buffer, geometry.allocation.offset);
+  gfx::queue_buffer_upload_data(reinterpret_cast<const uint8_t*>(geometry.indices.data()), indexSize, buffer,
+                                geometry.allocation.offset + indexOffset);
+  geometry.vertices.clear();
+  geometry.vertices.shrink_to_fit();
+  geometry.indices.clear();
+  geometry.indices.shrink_to_fit();
+}
+
+// Uploads the geometry on first use and references it in place; if the geometry pools are exhausted, the geometry is
+// pushed into the per-frame buffers instead.
+GeometryRanges geometry_ranges(ShaderGeometryData& geometry) {
+  queue_geometry_upload_if_needed(geometry);
+  if (geometry.allocation.buffer != 0) {
+    const auto indexOffset = static_cast<uint32_t>(AURORA_ALIGN(geometry.vertexSize, rmlBufferOffsetAlignment));
+    return {
+        .vertexRange = {geometry.allocation.offset, geometry.vertexSize},
+        .indexRange = {geometry.allocation.offset + indexOffset, geometry.indexCount * uint32_t{sizeof(uint32_t)}},
+        .buffer = geometry.allocation.buffer,
+    };
+  }
+  return {
+      .vertexRange = gfx::push_verts(reinterpret_cast<const uint8_t*>(geometry.vertices.data()), geometry.vertexSize,
+                                     rmlBufferOffsetAlignment),
+      .indexRange = gfx::push_indices(reinterpret_cast<const uint8_t*>(geometry.indices.data()),
+                                      geometry.indices.size() * sizeof(uint32_t), rmlBufferOffsetAlignment),
+  };
+}
+
 } // namespace
 
 Rml::CompiledGeometryHandle WebGPURenderInterface::CompileGeometry(Rml::Span<const Rml::Vertex> vertices,
@@ -373,53 +359,58 @@ Rml::CompiledGeometryHandle WebGPURenderInterface::CompileGeometry(Rml::Span<con
   for (const int index : indices) {
     geometryData->indices.push_back(static_cast<uint32_t>(index));
   }
+  geometryData->vertexSize = static_cast<uint32_t>(vertices.size() * sizeof(Rml::Vertex));
+  geometryData->indexCount = static_cast<uint32_t>(indices.size());
 
   return reinterpret_cast<Rml::CompiledGeometryHandle>(geometryData);
 }
 
 void WebGPURenderInterface::RenderGeometry(Rml::CompiledGeometryHandle geometry, Rml::Vector2f translation,
                                            Rml::TextureHandle texture) {
-  DrawGeometry(geometry, translation, texture,
-               geometry_pipeline(m_renderTargetFormat, LayerSampleCount,
-                                 m_clipMaskEnabled ? PipelineType::Masked : PipelineType::Normal));
+  MixLayerSignature(DrawGeometry(geometry, translation, texture,
+                                 geometry_pipeline(m_renderTargetFormat, LayerSampleCount,
+                                                   m_clipMaskEnabled ? PipelineType::Masked : PipelineType::Normal)));
 }
 
-void WebGPURenderInterface::DrawGeometry(Rml::CompiledGeometryHandle geometry, Rml::Vector2f translation,
-                                         Rml::TextureHandle texture, gfx::PipelineRef pipeline) {
+uint64_t WebGPURenderInterface::DrawGeometry(Rml::CompiledGeometryHandle geometry, Rml::Vector2f translation,
+                                             Rml::TextureHandle texture, gfx::PipelineRef pipeline) {
   EnsureActiveLayerPass("RmlUi resumed geometry layer pass");
   if (!m_passActive) {
-    return;
+    return 0;
   }
 
   auto* geometryData = reinterpret_cast<ShaderGeometryData*>(geometry);
   auto* textureData = reinterpret_cast<ShaderTextureData*>(texture != 0 ? texture : m_nullTexture);
   if (geometryData == nullptr || textureData == nullptr) {
-    return;
+    return 0;
   }
   queue_texture_upload_if_needed(*textureData);
 
   const auto uniformRange = SetupRenderState(translation);
-  const auto vertexRange =
-      gfx::push_verts(reinterpret_cast<const uint8_t*>(geometryData->vertices.data()),
-                      geometryData->vertices.size() * sizeof(Rml::Vertex), rmlBufferOffsetAlignment);
-  const auto indexRange = gfx::push_indices(reinterpret_cast<const uint8_t*>(geometryData->indices.data()),
-                                            geometryData->indices.size() * sizeof(uint32_t), rmlBufferOffsetAlignment);
+  const auto ranges = geometry_ranges(*geometryData);
   gfx::push_draw_command(DrawData{
       .pipeline = pipeline,
-      .vertexRange = vertexRange,
-      .indexRange = indexRange,
+      .vertexRange = ranges.vertexRange,
+      .indexRange = ranges.indexRange,
       .uniformRange = uniformRange,
       .bindGroup1 = texture_bind_group_ref(textureData->m_textureView),
       .drawKind = static_cast<uint32_t>(DrawKind::Geometry),
-      .indexCount = static_cast<uint32_t>(geometryData->indices.size()),
+      .indexCount = geometryData->indexCount,
       .stencilRef = m_stencilRef,
       .blendConstant = {0.f, 0.f, 0.f, 0.f},
       .hasBlendConstant = 1,
+      .geometryBuffer = ranges.buffer,
   });
+  const uint64_t signature = mix_signature(DrawStateSignature(pipeline, translation), geometryData->id);
+  return mix_signature(signature, textureData->m_contentId);
 }
 
 void WebGPURenderInterface::ReleaseGeometry(Rml::CompiledGeometryHandle geometry) {
-  delete reinterpret_cast<ShaderGeometryData*>(geometry);
+  auto* geometryData = reinterpret_cast<ShaderGeometryData*>(geometry);
+  if (geometryData != nullptr) {
+    free_geometry(geometryData->allocation);
+  }
+  delete geometryData;
 }
 
 Rml::TextureHandle WebGPURenderInterface::LoadTexture(Rml::Vector2i& dimensions, const Rml::String& source) {
@@ -434,13 +425,7 @@ Rml::TextureHandle WebGPURenderInterface::LoadTexture(Rml::Vector2i& dimensions,
     std::vector<Rml::byte> premultiplied;
     if (!runtimeTexture->premultipliedAlpha) {
       premultiplied.assign(texels, texels + size);
-      for (size_t offset = 0; offset < premultiplied.size(); offset += 4) {
-        const uint8_t alpha = premultiplied[offset + 3];
-        for (size_t channel = 0; channel < 3; ++channel) {
-          premultiplied[offset + channel] = static_cast<uint8_t>(
-              (static_cast<uint32_t>(premultiplied[offset + channel]) * static_cast<uint32_t>(alpha)) / 255);
-        }
-      }
+      image_loader::premultiply_alpha(premultiplied);
       texels = premultiplied.data();
     }
 
@@ -449,16 +434,54 @@ Rml::TextureHandle WebGPURenderInterface::LoadTexture(Rml::Vector2i& dimensions,
     return GenerateTexture({texels, size}, dimensions);
   }
 
-  // load texels from image source
-  const auto image = get_image(source);
-  if (image.size == 0) {
+  // load texels from image source, decoding on the worker pool unless already cached
+  auto image = image_loader::find_cached(source);
+  if (!image && image_loader::synchronous()) {
+    image = image_loader::load(source);
+    if (!image) {
+      Log.error("Failed to load texture! Path: {}", source);
+      return 0;
+    }
+  }
+  if (image) {
+    dimensions.x = static_cast<int>(image->width);
+    dimensions.y = static_cast<int>(image->height);
+    return GenerateTexture({image->rgba->data(), image->rgba->size()}, dimensions);
+  }
+
+  // RmlUi needs the dimensions for layout right away; the texels stay transparent until the decode is published.
+  const auto imageDimensions = image_loader::read_dimensions(source);
+  if (!imageDimensions) {
     Log.error("Failed to load texture! Path: {}", source);
     return 0;
   }
+  dimensions.x = static_cast<int>(imageDimensions->first);
+  dimensions.y = static_cast<int>(imageDimensions->second);
+  const auto texture = GenerateTexture({}, dimensions);
+  auto* texData = reinterpret_cast<ShaderTextureData*>(texture);
+  texData->m_pendingLoad = image_loader::queue_load(source);
+  m_pendingImages.emplace(texData->m_pendingLoad, texture);
+  return texture;
+}
 
-  dimensions.x = static_cast<int>(image.width);
-  dimensions.y = static_cast<int>(image.height);
-  return GenerateTexture({image.data.get(), image.size}, dimensions);
+void WebGPURenderInterface::PublishLoadedImages() {
+  for (auto& completion : image_loader::take_completions()) {
+    const auto it = m_pendingImages.find(completion.id);
+    if (it == m_pendingImages.end()) {
+      continue;
+    }
+    auto* texData = reinterpret_cast<ShaderTextureData*>(it->second);
+    m_pendingImages.erase(it);
+    texData->m_pendingLoad = 0;
+    const auto& image = completion.image;
+    if (!image || image->width != texData->m_size.width || image->height != texData->m_size.height) {
+      Log.error("Failed to load texture asynchronously!");
+      continue;
+    }
+    texData->m_pendingUpload.assign(image->rgba->begin(), image->rgba->end());
+    texData->m_uploaded = false;
+    texData->m_contentId = g_nextContentId++;
+  }
 }
 
 Rml::TextureHandle WebGPURenderInterface::GenerateTexture(Rml::Span<const Rml::byte> source,
@@ -488,7 +511,12 @@ Rml::TextureHandle WebGPURenderInterface::GenerateTexture(Rml::Span<const Rml::b
 }
 
 void WebGPURenderInterface::ReleaseTexture(Rml::TextureHandle texture) {
-  delete reinterpret_cast<ShaderTextureData*>(texture);
+  auto* texData = reinterpret_cast<ShaderTextureData*>(texture);
+  if (texData != nullptr && texData->m_pendingLoad != 0) {
+    image_loader::cancel(texData->m_pendingLoad);
+    m_pendingImages.erase(texData->m_pendingLoad);
+  }
+  delete texData;
 }
 
 void WebGPURenderInterface::EnableScissorRegion(bool enable) {
@@ -550,6 +578,12 @@ void WebGPURenderInterface::RenderToClipMask(Rml::ClipMaskOperation operation, R
 
   EnsureClipResetGeometry();
 
+  // The stencil contents only depend on the draws since the last full reset.
+  if (operation != Rml::ClipMaskOperation::Intersect) {
+    m_clipMaskSignature = 0;
+  }
+  m_clipMaskSignature = mix_signature(m_clipMaskSignature, operation);
+
   const Rml::Matrix4f prevMatrix = m_translationMatrix;
   switch (operation) {
   case Rml::ClipMaskOperation::Set:
@@ -560,8 +594,10 @@ void WebGPURenderInterface::RenderToClipMask(Rml::ClipMaskOperation operation, R
     m_translationMatrix = prevMatrix;
 
     m_stencilRef = 1;
-    DrawGeometry(geometry, translation, 0,
-                 geometry_pipeline(m_renderTargetFormat, LayerSampleCount, PipelineType::ClipReplace));
+    m_clipMaskSignature = mix_signature(
+        m_clipMaskSignature,
+        DrawGeometry(geometry, translation, 0,
+                     geometry_pipeline(m_renderTargetFormat, LayerSampleCount, PipelineType::ClipReplace)));
     break;
   case Rml::ClipMaskOperation::SetInverse:
     m_translationMatrix = Rml::Matrix4f::Identity();
@@ -572,8 +608,10 @@ void WebGPURenderInterface::RenderToClipMask(Rml::ClipMaskOperation operation, R
 
     m_stencilRef = 1;
     m_stencilRef = 0;
-    DrawGeometry(geometry, translation, 0,
-                 geometry_pipeline(m_renderTargetFormat, LayerSampleCount, PipelineType::ClipReplace));
+    m_clipMaskSignature = mix_signature(
+        m_clipMaskSignature,
+        DrawGeometry(geometry, translation, 0,
+                     geometry_pipeline(m_renderTargetFormat, LayerSampleCount, PipelineType::ClipReplace)));
     m_stencilRef = 1;
     break;
   case Rml::ClipMaskOperation::Intersect:
@@ -582,8 +620,10 @@ void WebGPURenderInterface::RenderToClipMask(Rml::ClipMaskOperation operation, R
       break;
     }
 
-    DrawGeometry(geometry, translation, 0,
-                 geometry_pipeline(m_renderTargetFormat, LayerSampleCount, PipelineType::ClipIntersect));
+    m_clipMaskSignature = mix_signature(
+        m_clipMaskSignature,
+        DrawGeometry(geometry, translation, 0,
+                     geometry_pipeline(m_renderTargetFormat, LayerSampleCount, PipelineType::ClipIntersect)));
     ++m_stencilRef;
     break;
   }
@@ -608,7 +648,8 @@ void WebGPURenderInterface::EnsureRenderTarget(RenderTarget& target, const char*
   target.size = size;
   const wgpu::TextureDescriptor textureDesc{
       .label = label,
-      .usage = wgpu::TextureUsage::RenderAttachment | wgpu::TextureUsage::TextureBinding | wgpu::TextureUsage::CopySrc,
+      .usage = wgpu::TextureUsage::RenderAttachment | wgpu::TextureUsage::TextureBinding |
+               wgpu::TextureUsage::CopySrc | wgpu::TextureUsage::CopyDst,
       .dimension = wgpu::TextureDimension::e2D,
       .size = size,
       .format = m_renderTargetFormat,
@@ -755,6 +796,7 @@ void WebGPURenderInterface::EnsureFrameRenderingStarted() {
   }
 
   m_frameRenderingStarted = true;
+  m_clipMaskSignature = 0;
   if (m_baseLayerContent == BaseLayerContent::Transparent) {
     BeginLayerPass(0, wgpu::LoadOp::Clear, "RmlUi transparent base layer pass", true);
     return;
@@ -832,13 +874,9 @@ void WebGPURenderInterface::CompositeToTarget(gfx::BindGroupRef bindGroup, const
 }
 
 void WebGPURenderInterface::RenderBlur(float sigma, const RenderTarget& sourceDestination, const RenderTarget& temp) {
-  sigma = std::max(sigma, 0.f);
-  if (sigma < 0.5f) {
-    return;
-  }
-
   const Rml::Rectanglei originalScissor = GetActiveScissorRegion();
-  if (originalScissor.Width() <= 0 || originalScissor.Height() <= 0) {
+  const BlurPlan plan = plan_blur(sigma, originalScissor);
+  if (plan.passes.empty()) {
     return;
   }
 
@@ -878,77 +916,74 @@ void WebGPURenderInterface::RenderBlur(float sigma, const RenderTarget& sourceDe
     };
     return gfx::push_uniform(uniform);
   };
+  auto set_region_viewport = [](Rml::Rectanglei region) {
+    gfx::set_viewport({static_cast<float>(region.Left()), static_cast<float>(region.Top()),
+                       static_cast<float>(std::max(region.Width(), 1)),
+                       static_cast<float>(std::max(region.Height(), 1)), 0.f, 1.f});
+  };
 
-  int passLevel = 0;
-  sigma_to_params(sigma, passLevel, sigma);
-  if (sigma == 0.f) {
-    return;
-  }
-
-  Rml::Rectanglei scissor = originalScissor;
-  const auto weights = blur_weights(sigma, MaxBlurRadius);
+  const auto weights = blur_weights(plan.sigma, MaxBlurRadius);
   constexpr auto radius = static_cast<float>(MaxBlurRadius);
-
-  for (int i = 0; i < passLevel; ++i) {
-    scissor = downsample_scissor(scissor);
-    const bool fromSource = (i % 2) == 0;
-    const RenderTarget& source = fromSource ? sourceDestination : temp;
-    const RenderTarget& destination = fromSource ? temp : sourceDestination;
-
-    BeginRenderTargetPass(destination.view, wgpu::LoadOp::Clear, "RmlUi blur downsample pass");
-    gfx::set_viewport({m_viewport.left, m_viewport.top, std::max(m_viewport.width * 0.5f, 1.f),
-                       std::max(m_viewport.height * 0.5f, 1.f), m_viewport.znear, m_viewport.zfar});
-    ApplyScissorRegion(scissor);
-    DrawFullscreenTexture(texture_bind_group_ref(source.view),
-                          blit_pipeline(m_renderTargetFormat, 1, BlitPipelineType::Replace, false));
-  }
-
-  if ((passLevel % 2) == 0) {
-    BeginRenderTargetPass(temp.view, wgpu::LoadOp::Clear, "RmlUi blur transfer pass");
-    ApplyViewport();
-    ApplyScissorRegion(scissor);
-    DrawFullscreenTexture(texture_bind_group_ref(sourceDestination.view),
-                          blit_pipeline(m_renderTargetFormat, 1, BlitPipelineType::Replace, false));
-  }
-
-  const auto verticalRange =
-      write_blur_uniform({0.f, 1.f / std::max(m_viewport.height, 1.f)}, scissor, radius, weights);
-  BeginRenderTargetPass(sourceDestination.view, wgpu::LoadOp::Clear, "RmlUi vertical blur pass");
-  ApplyScissorRegion(scissor);
-  DrawFullscreenTexture(texture_bind_group_ref(temp.view),
-                        filter_pipeline(PipelineKind::Blur, m_renderTargetFormat, VertexLayoutKind::BlurFullscreen),
-                        uniform_bind_group_ref(), verticalRange);
-
-  const auto horizontalRange =
-      write_blur_uniform({1.f / std::max(m_viewport.width, 1.f), 0.f}, scissor, radius, weights);
-  BeginRenderTargetPass(temp.view, wgpu::LoadOp::Clear, "RmlUi horizontal blur pass");
-  ApplyScissorRegion(scissor);
-  DrawFullscreenTexture(texture_bind_group_ref(sourceDestination.view),
-                        filter_pipeline(PipelineKind::Blur, m_renderTargetFormat, VertexLayoutKind::BlurFullscreen),
-                        uniform_bind_group_ref(), horizontalRange);
-
-  const auto upscaleRange = write_region_blit_uniform(scissor, weights);
-  BeginRenderTargetPass(sourceDestination.view, wgpu::LoadOp::Clear, "RmlUi blur upscale pass");
-  gfx::set_viewport({static_cast<float>(originalScissor.Left()), static_cast<float>(originalScissor.Top()),
-                     static_cast<float>(std::max(originalScissor.Width(), 1)),
-                     static_cast<float>(std::max(originalScissor.Height(), 1)), 0.f, 1.f});
-  ApplyScissorRegion(originalScissor);
-  DrawFullscreenTexture(texture_bind_group_ref(temp.view),
-                        filter_pipeline(PipelineKind::RegionBlit, m_renderTargetFormat), uniform_bind_group_ref(),
-                        upscaleRange);
-
-  const auto targetMin = scissor.p0 * (1 << passLevel);
-  const auto targetMax = scissor.p1 * (1 << passLevel);
-  const auto targetRegion = Rml::Rectanglei::FromCorners(targetMin, targetMax);
-  if (targetRegion.p0 != originalScissor.p0 || targetRegion.p1 != originalScissor.p1) {
-    BeginRenderTargetPass(sourceDestination.view, wgpu::LoadOp::Load, "RmlUi blur power-of-two upscale pass");
-    gfx::set_viewport({static_cast<float>(targetRegion.Left()), static_cast<float>(targetRegion.Top()),
-                       static_cast<float>(std::max(targetRegion.Width(), 1)),
-                       static_cast<float>(std::max(targetRegion.Height(), 1)), 0.f, 1.f});
-    ApplyScissorRegion(targetRegion);
-    DrawFullscreenTexture(texture_bind_group_ref(temp.view),
-                          filter_pipeline(PipelineKind::RegionBlit, m_renderTargetFormat), uniform_bind_group_ref(),
-                          upscaleRange);
+  gfx::Range upscaleRange;
+  for (const BlurPass& pass : plan.passes) {
+    const RenderTarget& source = pass.toTemp ? sourceDestination : temp;
+    const RenderTarget& destination = pass.toTemp ? temp : sourceDestination;
+    switch (pass.kind) {
+    case BlurPassKind::Downsample:
+      BeginRenderTargetPass(destination.view, wgpu::LoadOp::Clear, "RmlUi blur downsample pass");
+      gfx::set_viewport({m_viewport.left, m_viewport.top, std::max(m_viewport.width * 0.5f, 1.f),
+                         std::max(m_viewport.height * 0.5f, 1.f), m_viewport.znear, m_viewport.zfar});
+      ApplyScissorRegion(pass.region);
+      DrawFullscreenTexture(texture_bind_group_ref(source.view),
+                            blit_pipeline(m_renderTargetFormat, 1, BlitPipelineType::Replace, false));
+      break;
+    case BlurPassKind::Transfer:
+      BeginRenderTargetPass(destination.view, wgpu::LoadOp::Clear, "RmlUi blur transfer pass");
+      ApplyViewport();
+      ApplyScissorRegion(pass.region);
+      DrawFullscreenTexture(texture_bind_group_ref(source.view),
+                            blit_pipeline(m_renderTargetFormat, 1, BlitPipelineType::Replace, false));
+      break;
+    case BlurPassKind::VerticalBlur:
+    case BlurPassKind::HorizontalBlur: {
+      const bool vertical = pass.kind == BlurPassKind::VerticalBlur;
+      const Rml::Vector2f texelOffset = vertical ? Rml::Vector2f{0.f, 1.f / std::max(m_viewport.height, 1.f)}
+                                                 : Rml::Vector2f{1.f / std::max(m_viewport.width, 1.f), 0.f};
+      const auto range = write_blur_uniform(texelOffset, pass.sourceRegion, radius, weights);
+      BeginRenderTargetPass(destination.view, wgpu::LoadOp::Clear,
+                            vertical ? "RmlUi vertical blur pass" : "RmlUi horizontal blur pass");
+      ApplyScissorRegion(pass.region);
+      DrawFullscreenTexture(texture_bind_group_ref(source.view),
+                            filter_pipeline(PipelineKind::Blur, m_renderTargetFormat, VertexLayoutKind::BlurFullscreen),
+                            uniform_bind_group_ref(), range);
+      break;
+    }
+    case BlurPassKind::Upsample:
+    case BlurPassKind::Upscale:
+    case BlurPassKind::PowerOfTwoUpscale: {
+      const char* label = "RmlUi blur upsample pass";
+      wgpu::LoadOp loadOp = wgpu::LoadOp::Clear;
+      gfx::Range range;
+      if (pass.kind == BlurPassKind::Upsample) {
+        range = write_region_blit_uniform(pass.sourceRegion, weights);
+      } else if (pass.kind == BlurPassKind::Upscale) {
+        label = "RmlUi blur upscale pass";
+        range = upscaleRange = write_region_blit_uniform(pass.sourceRegion, weights);
+      } else {
+        // Reads the same region as the upscale pass
+        label = "RmlUi blur power-of-two upscale pass";
+        loadOp = wgpu::LoadOp::Load;
+        range = upscaleRange;
+      }
+      BeginRenderTargetPass(destination.view, loadOp, label);
+      set_region_viewport(pass.region);
+      ApplyScissorRegion(pass.region);
+      DrawFullscreenTexture(texture_bind_group_ref(source.view),
+                            filter_pipeline(PipelineKind::RegionBlit, m_renderTargetFormat), uniform_bind_group_ref(),
+                            range);
+      break;
+    }
+    }
   }
 }
 
@@ -1130,6 +1165,107 @@ size_t WebGPURenderInterface::RenderFilters(Rml::Span<const Rml::CompiledFilterH
   return sourceIndex;
 }
 
+Rml::Rectanglei WebGPURenderInterface::GetFilterRegion() const {
+  const Rml::Rectanglei region = GetActiveScissorRegion();
+  const int maxWidth = static_cast<int>(m_frameSize.width);
+  const int maxHeight = static_cast<int>(m_frameSize.height);
+  const int left = std::clamp(region.Left(), 0, maxWidth);
+  const int top = std::clamp(region.Top(), 0, maxHeight);
+  const int right = std::clamp(region.Right(), left, maxWidth);
+  const int bottom = std::clamp(region.Bottom(), top, maxHeight);
+  return Rml::Rectanglei::FromCorners({left, top}, {right, bottom});
+}
+
+WebGPURenderInterface::LayerSignature& WebGPURenderInterface::LayerSignatureOf(Rml::LayerHandle layer) {
+  if (static_cast<size_t>(layer) >= m_layerSignatures.size()) {
+    m_layerSignatures.resize(static_cast<size_t>(layer) + 1);
+  }
+  return m_layerSignatures[static_cast<size_t>(layer)];
+}
+
+void WebGPURenderInterface::MixLayerSignature(uint64_t drawSignature) {
+  if (drawSignature == 0) {
+    return;
+  }
+  LayerSignatureOf(m_activeLayer).mix(drawSignature);
+}
+
+uint64_t WebGPURenderInterface::DrawStateSignature(uint64_t seed, Rml::Vector2f translation) const {
+  uint64_t signature = mix_signature(seed, translation);
+  signature = mix_signature(signature, m_translationMatrix);
+  signature = mix_signature(signature, GetActiveScissorRegion());
+  signature = mix_signature(signature, m_stencilRef);
+  return mix_signature(signature, m_clipMaskEnabled ? m_clipMaskSignature : 0);
+}
+
+bool WebGPURenderInterface::RestoreFilterResult(uint64_t key, Rml::Rectanglei region) {
+  const FilterCache::Entry* entry = m_filterCache.find(key);
+  if (entry == nullptr) {
+    return false;
+  }
+
+  // The composite pass is scissored to `region`, so the rest of the target can keep stale contents.
+  EndActivePass();
+  const wgpu::TexelCopyTextureInfo src{
+      .texture = entry->texture,
+      .aspect = wgpu::TextureAspect::All,
+  };
+  const wgpu::TexelCopyTextureInfo dst{
+      .texture = m_postprocessTargets[0].texture,
+      .origin =
+          wgpu::Origin3D{
+              .x = static_cast<uint32_t>(region.Left()),
+              .y = static_cast<uint32_t>(region.Top()),
+          },
+      .aspect = wgpu::TextureAspect::All,
+  };
+  gfx::queue_texture_copy(src, dst,
+                          {static_cast<uint32_t>(region.Width()), static_cast<uint32_t>(region.Height()), 1});
+  return true;
+}
+
+void WebGPURenderInterface::StoreFilterResult(uint64_t key, Rml::Rectanglei region, const RenderTarget& target) {
+  if (region.Width() <= 0 || region.Height() <= 0) {
+    return;
+  }
+
+  const wgpu::Extent3D size{
+      .width = static_cast<uint32_t>(region.Width()),
+      .height = static_cast<uint32_t>(region.Height()),
+      .depthOrArrayLayers = 1,
+  };
+  FilterCache::Entry* entry = m_filterCache.record(key, static_cast<uint64_t>(size.width) * size.height * 4);
+  if (entry == nullptr) {
+    return;
+  }
+
+  const wgpu::TextureDescriptor textureDesc{
+      .label = "RmlUi Filter Cache Texture",
+      .usage = wgpu::TextureUsage::CopyDst | wgpu::TextureUsage::CopySrc,
+      .dimension = wgpu::TextureDimension::e2D,
+      .size = size,
+      .format = m_renderTargetFormat,
+      .mipLevelCount = 1,
+      .sampleCount = 1,
+  };
+  entry->texture = webgpu::g_device.CreateTexture(&textureDesc);
+
+  const wgpu::TexelCopyTextureInfo src{
+      .texture = target.texture,
+      .origin =
+          wgpu::Origin3D{
+              .x = static_cast<uint32_t>(region.Left()),
+              .y = static_cast<uint32_t>(region.Top()),
+          },
+      .aspect = wgpu::TextureAspect::All,
+  };
+  const wgpu::TexelCopyTextureInfo dst{
+      .texture = entry->texture,
+      .aspect = wgpu::TextureAspect::All,
+  };
+  gfx::queue_texture_copy(src, dst, size);
+}
+
 void WebGPURenderInterface::BeginFrame(const webgpu::TextureWithSampler& target,
                                        const webgpu::TextureWithSampler& sceneTarget,
                                        BaseLayerContent baseLayerContent) {
@@ -1150,8 +1286,12 @@ void WebGPURenderInterface::BeginFrame(const webgpu::TextureWithSampler& target,
   m_frameActive = true;
   m_passActive = false;
   m_baseLayerContent = baseLayerContent;
+  // The game frame changes every frame, so anything derived from it is never served from the filter cache.
+  m_layerSignatures.assign(1, LayerSignature{.stable = baseLayerContent == BaseLayerContent::Transparent});
 
   NewFrame();
+  PublishLoadedImages();
+  m_filterCache.begin_frame();
   EnsureFrameTargets(target.size);
   wgpu::Texture multisampleTexture;
   wgpu::TextureView multisampleView;
@@ -1211,6 +1351,7 @@ Rml::LayerHandle WebGPURenderInterface::PushLayer() {
   }
 
   EnsureRenderTarget(m_layers[static_cast<size_t>(layer)], "RmlUi Layer", m_frameSize, true);
+  LayerSignatureOf(layer) = {};
   m_layerStack.push_back(layer);
   BeginLayerPass(layer, wgpu::LoadOp::Clear, "RmlUi pushed layer pass");
   return layer;
@@ -1233,6 +1374,28 @@ void WebGPURenderInterface::CompositeLayers(Rml::LayerHandle source, Rml::LayerH
   const BlitPipelineType pipelineType =
       replace ? (m_clipMaskEnabled ? BlitPipelineType::ReplaceMasked : BlitPipelineType::Replace)
               : (m_clipMaskEnabled ? BlitPipelineType::BlendMasked : BlitPipelineType::Blend);
+
+  // The filtered result only depends on the source contents, the filters and the region they are confined to.
+  const Rml::Rectanglei filterRegion = GetFilterRegion();
+  LayerSignature filterSignature = LayerSignatureOf(source);
+  filterSignature.mix(filterRegion);
+  filterSignature.mix(m_frameSize);
+  filterSignature.mix(m_windowSize);
+  for (Rml::CompiledFilterHandle filterHandle : activeFilters) {
+    const auto& filter = *reinterpret_cast<const CompiledFilter*>(filterHandle);
+    filterSignature.mix(filter);
+    if (filter.type == FilterType::MaskImage) {
+      filterSignature.mix(m_blendMaskSignature);
+    } else if (filter.type == FilterType::Glass) {
+      filterSignature.mix(g_glassLightDir);
+    }
+  }
+  LayerSignatureOf(destination)
+      .mix(LayerSignature{
+          .hash = DrawStateSignature(mix_signature(filterSignature.hash, blendMode), {}),
+          .stable = filterSignature.stable,
+      });
+
   if (activeFilters.empty() && source != destination) {
     BeginLayerPass(destination, wgpu::LoadOp::Load, "RmlUi layer direct composite pass");
     DrawFullscreenTexture(texture_bind_group_ref(m_layers[source].view),
@@ -1265,9 +1428,17 @@ void WebGPURenderInterface::CompositeLayers(Rml::LayerHandle source, Rml::LayerH
     return;
   }
 
-  CompositeToTarget(texture_bind_group_ref(m_layers[source].view), m_postprocessTargets[0].view, wgpu::LoadOp::Clear,
-                    blit_pipeline(m_renderTargetFormat, 1, BlitPipelineType::Replace, false), "RmlUi layer copy pass");
-  const size_t filteredIndex = RenderFilters(activeFilters);
+  // Static filtered elements are composited from the result cached on an earlier frame.
+  size_t filteredIndex = 0;
+  if (!filterSignature.stable || !RestoreFilterResult(filterSignature.hash, filterRegion)) {
+    CompositeToTarget(texture_bind_group_ref(m_layers[source].view), m_postprocessTargets[0].view,
+                      wgpu::LoadOp::Clear, blit_pipeline(m_renderTargetFormat, 1, BlitPipelineType::Replace, false),
+                      "RmlUi layer copy pass");
+    filteredIndex = RenderFilters(activeFilters);
+    if (filterSignature.stable) {
+      StoreFilterResult(filterSignature.hash, filterRegion, m_postprocessTargets[filteredIndex]);
+    }
+  }
 
   BeginLayerPass(destination, wgpu::LoadOp::Load, "RmlUi layer composite pass");
   DrawFullscreenTexture(texture_bind_group_ref(m_postprocessTargets[filteredIndex].view),
@@ -1379,6 +1550,7 @@ Rml::CompiledFilterHandle WebGPURenderInterface::SaveLayerAsMaskImage() {
   CompositeToTarget(texture_bind_group_ref(m_postprocessTargets[0].view), m_blendMaskTarget.view, wgpu::LoadOp::Clear,
                     blit_pipeline(m_renderTargetFormat, 1, BlitPipelineType::Replace, false),
                     "RmlUi mask image save pass");
+  m_blendMaskSignature = LayerSignatureOf(layer);
 
   BeginLayerPass(layer, wgpu::LoadOp::Load, "RmlUi mask image restore pass");
 
@@ -1552,7 +1724,7 @@ Rml::CompiledShaderHandle WebGPURenderInterface::CompileShader(const Rml::String
 void WebGPURenderInterface::RenderShader(Rml::CompiledShaderHandle shader, Rml::CompiledGeometryHandle geometry,
                                          Rml::Vector2f translation, Rml::TextureHandle) {
   const auto* shaderData = reinterpret_cast<const CompiledShaderData*>(shader);
-  const auto* geometryData = reinterpret_cast<const ShaderGeometryData*>(geometry);
+  auto* geometryData = reinterpret_cast<ShaderGeometryData*>(geometry);
   if (shaderData == nullptr || geometryData == nullptr) {
     return;
   }
@@ -1561,27 +1733,27 @@ void WebGPURenderInterface::RenderShader(Rml::CompiledShaderHandle shader, Rml::
     return;
   }
 
+  const auto pipeline = gradient_pipeline(m_renderTargetFormat, LayerSampleCount, m_clipMaskEnabled);
   const auto uniformRange = SetupRenderState(translation);
   const auto shaderRange = gfx::push_uniform(shaderData->gradient);
-  const auto vertexRange =
-      gfx::push_verts(reinterpret_cast<const uint8_t*>(geometryData->vertices.data()),
-                      geometryData->vertices.size() * sizeof(Rml::Vertex), rmlBufferOffsetAlignment);
-  const auto indexRange = gfx::push_indices(reinterpret_cast<const uint8_t*>(geometryData->indices.data()),
-                                            geometryData->indices.size() * sizeof(uint32_t), rmlBufferOffsetAlignment);
+  const auto ranges = geometry_ranges(*geometryData);
   gfx::push_draw_command(DrawData{
-      .pipeline = gradient_pipeline(m_renderTargetFormat, LayerSampleCount, m_clipMaskEnabled),
-      .vertexRange = vertexRange,
-      .indexRange = indexRange,
+      .pipeline = pipeline,
+      .vertexRange = ranges.vertexRange,
+      .indexRange = ranges.indexRange,
       .uniformRange = uniformRange,
       .bindGroup1 = uniform_bind_group_ref(),
       .bindGroup1DynamicOffset = shaderRange.offset,
       .dynamicBindGroupMask = 1u << 1u,
       .drawKind = static_cast<uint32_t>(DrawKind::Geometry),
-      .indexCount = static_cast<uint32_t>(geometryData->indices.size()),
+      .indexCount = geometryData->indexCount,
       .stencilRef = m_stencilRef,
       .blendConstant = {0.f, 0.f, 0.f, 0.f},
       .hasBlendConstant = 1,
+      .geometryBuffer = ranges.buffer,
   });
+  const uint64_t signature = mix_signature(DrawStateSignature(pipeline, translation), geometryData->id);
+  MixLayerSignature(mix_signature(signature, shaderData->gradient));
 }
 
 void WebGPURenderInterface::ReleaseShader(Rml::CompiledShaderHandle shader) {
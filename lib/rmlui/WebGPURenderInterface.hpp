@@ -1,10 +1,12 @@
 #pragma once
 #include <array>
+#include <unordered_map>
 #include <vector>
 
 #include <dawn/webgpu_cpp.h>
 
 #include "../gfx/clear.hpp"
+#include "filter_cache.hpp"
 #include "RmlUi/Core/RenderInterface.h"
 
 namespace aurora::webgpu {
@@ -18,6 +20,7 @@ inline constexpr uint32_t LayerSampleCount = EnableMsaa ? 4 : 1;
 inline constexpr uint32_t MaxBlurRadius = 3;
 inline constexpr size_t MaxGradientStops = 16;
 inline constexpr size_t GradientStopPositionGroupCount = (MaxGradientStops + 3) / 4;
+inline constexpr uint64_t FilterCacheBudget = 33554432; // 32 MiB
 
 struct UniformBlock {
   Rml::Matrix4f MVP;
@@ -135,6 +138,10 @@ private:
   Rml::LayerHandle m_activeLayer = 0;
   Rml::LayerHandle m_nextLayer = 1;
   BaseLayerContent m_baseLayerContent = BaseLayerContent::Transparent;
+  std::vector<LayerSignature> m_layerSignatures;
+  LayerSignature m_blendMaskSignature{};
+  uint64_t m_clipMaskSignature = 0;
+  FilterCache m_filterCache{FilterCacheBudget};
 
   Rml::Vector2i m_windowSize{};
   Rml::Matrix4f m_translationMatrix = Rml::Matrix4f::Identity();
@@ -147,6 +154,8 @@ private:
   bool m_passActive = false;
   bool m_frameRenderingStarted = false;
   uint32_t m_stencilRef = 0;
+  // Textures whose texels are still being decoded, by image loader id.
+  std::unordered_map<uint64_t, Rml::TextureHandle> m_pendingImages;
 
   gfx::Range SetupRenderState(const Rml::Vector2f& translation);
 
@@ -169,8 +178,10 @@ private:
   void CreateNullTexture();
   void EnsureClipResetGeometry();
   void ApplyScissorRegion();
-  void DrawGeometry(Rml::CompiledGeometryHandle geometry, Rml::Vector2f translation, Rml::TextureHandle texture,
-                    gfx::PipelineRef pipeline);
+  void PublishLoadedImages();
+  // Returns a signature of the draw for layer content tracking, or 0 if nothing was drawn.
+  uint64_t DrawGeometry(Rml::CompiledGeometryHandle geometry, Rml::Vector2f translation, Rml::TextureHandle texture,
+                        gfx::PipelineRef pipeline);
   void DrawFullscreenTexture(gfx::BindGroupRef bindGroup, gfx::PipelineRef pipeline,
                              gfx::BindGroupRef extraBindGroup = 0, gfx::Range extraUniformRange = {},
                              bool extraBindGroupHasDynamicOffset = true, std::array<float, 4> blendConstant = {},
@@ -181,6 +192,12 @@ private:
                          std::array<float, 4> blendConstant = {}, bool hasBlendConstant = false);
   void RenderBlur(float sigma, const RenderTarget& sourceDestination, const RenderTarget& temp);
   size_t RenderFilters(Rml::Span<const Rml::CompiledFilterHandle> filters);
+  Rml::Rectanglei GetFilterRegion() const;
+  LayerSignature& LayerSignatureOf(Rml::LayerHandle layer);
+  void MixLayerSignature(uint64_t drawSignature);
+  uint64_t DrawStateSignature(uint64_t seed, Rml::Vector2f translation) const;
+  bool RestoreFilterResult(uint64_t key, Rml::Rectanglei region);
+  void StoreFilterResult(uint64_t key, Rml::Rectanglei region, const RenderTarget& target);
 
 public:
   Rml::CompiledGeometryHandle CompileGeometry(Rml::Span<const Rml::Vertex> vertices,
@@ -0,0 +1,72 @@
+#include "blur_plan.hpp"
+
+#include <RmlUi/Core/Math.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace aurora::rmlui {
+
+void sigma_to_params(float desiredSigma, int& passLevel, float& sigma) {
+  constexpr int MaxPasses = 10;
+  constexpr float MaxSinglePassSigma = 3.f;
+  const int downsampleHint = static_cast<int>(desiredSigma * (2.f / MaxSinglePassSigma));
+  passLevel = downsampleHint > 0 ? static_cast<int>(std::log2(static_cast<float>(downsampleHint))) : 0;
+  passLevel = std::clamp(passLevel, 0, MaxPasses);
+  sigma = std::clamp(desiredSigma / static_cast<float>(1 << passLevel), 0.f, MaxSinglePassSigma);
+}
+
+int blur_upsample_steps(int passLevel) { return passLevel > 2 ? (passLevel - 1) & ~1 : 0; }
+
+Rml::Rectanglei downsample_scissor(Rml::Rectanglei scissor) {
+  scissor.p0 = (scissor.p0 + Rml::Vector2i(1)) / 2;
+  scissor.p1 = Rml::Math::Max(scissor.p1 / 2, scissor.p0);
+  return scissor;
+}
+
+BlurPlan plan_blur(float sigma, Rml::Rectanglei scissor) {
+  BlurPlan plan;
+  sigma = std::max(sigma, 0.f);
+  if (sigma < 0.5f || scissor.Width() <= 0 || scissor.Height() <= 0) {
+    return plan;
+  }
+  sigma_to_params(sigma, plan.passLevel, plan.sigma);
+  if (plan.sigma == 0.f) {
+    return plan;
+  }
+
+  const Rml::Rectanglei originalScissor = scissor;
+  for (int i = 0; i < plan.passLevel; ++i) {
+    scissor = downsample_scissor(scissor);
+    plan.passes.push_back({.kind = BlurPassKind::Downsample, .toTemp = (i % 2) == 0, .region = scissor});
+  }
+  if ((plan.passLevel % 2) == 0) {
+    plan.passes.push_back({.kind = BlurPassKind::Transfer, .toTemp = true, .region = scissor});
+  }
+  plan.passes.push_back(
+      {.kind = BlurPassKind::VerticalBlur, .toTemp = false, .region = scissor, .sourceRegion = scissor});
+  plan.passes.push_back(
+      {.kind = BlurPassKind::HorizontalBlur, .toTemp = true, .region = scissor, .sourceRegion = scissor});
+
+  int upscaleLevel = plan.passLevel;
+  const int upsampleSteps = blur_upsample_steps(plan.passLevel);
+  for (int i = 0; i < upsampleSteps; ++i) {
+    const auto upsampleRegion = Rml::Rectanglei::FromCorners(scissor.p0 * 2, scissor.p1 * 2);
+    plan.passes.push_back(
+        {.kind = BlurPassKind::Upsample, .toTemp = (i % 2) != 0, .region = upsampleRegion, .sourceRegion = scissor});
+    scissor = upsampleRegion;
+    --upscaleLevel;
+  }
+
+  plan.passes.push_back(
+      {.kind = BlurPassKind::Upscale, .toTemp = false, .region = originalScissor, .sourceRegion = scissor});
+  const auto targetRegion =
+      Rml::Rectanglei::FromCorners(scissor.p0 * (1 << upscaleLevel), scissor.p1 * (1 << upscaleLevel));
+  if (targetRegion.p0 != originalScissor.p0 || targetRegion.p1 != originalScissor.p1) {
+    plan.passes.push_back(
+        {.kind = BlurPassKind::PowerOfTwoUpscale, .toTemp = false, .region = targetRegion, .sourceRegion = scissor});
+  }
+  return plan;
+}
+
+} // namespace aurora::rmlui
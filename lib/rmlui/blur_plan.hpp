@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+
+#include <RmlUi/Core/Types.h>
+
+namespace aurora::rmlui {
+
+enum class BlurPassKind {
+  Downsample,
+  // Copies the lowest level into `temp` when an even number of downsamples left it in the blurred target.
+  Transfer,
+  VerticalBlur,
+  HorizontalBlur,
+  // Doubles the resolution of the blurred region, one level at a time.
+  Upsample,
+  // Stretches the remaining levels back over the original scissor region.
+  Upscale,
+  // Covers the rest of the power-of-two aligned region when downsampling rounded it off.
+  PowerOfTwoUpscale,
+};
+
+struct BlurPass {
+  BlurPassKind kind = BlurPassKind::Downsample;
+  // Whether the pass writes `temp` from the blurred target, rather than the other way around.
+  bool toTemp = false;
+  // Scissor region written, in target pixels.
+  Rml::Rectanglei region;
+  // Region read by blur and region blit passes.
+  Rml::Rectanglei sourceRegion;
+};
+
+struct BlurPlan {
+  int passLevel = 0;
+  // Sigma of the Gaussian passes at the lowest level.
+  float sigma = 0.f;
+  std::vector<BlurPass> passes;
+};
+
+// Splits a blur into downsample levels and the sigma remaining for a single Gaussian pass at the lowest level.
+void sigma_to_params(float desiredSigma, int& passLevel, float& sigma);
+// Upsample passes taken before the final upscale. Large blurs climb back up one level at a time, dual-filter style,
+// so each bilinear step only doubles the resolution instead of stretching the lowest level in one go. Steps come in
+// pairs to leave the result in `temp`; blurs of two or fewer levels take the single upscale unchanged.
+int blur_upsample_steps(int passLevel);
+Rml::Rectanglei downsample_scissor(Rml::Rectanglei scissor);
+// The passes blurring `scissor` of the blurred target, or none if the blur has no visible effect.
+BlurPlan plan_blur(float sigma, Rml::Rectanglei scissor);
+
+} // namespace aurora::rmlui
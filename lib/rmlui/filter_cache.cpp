@@ -0,0 +1,59 @@
+#include "filter_cache.hpp"
+
+namespace aurora::rmlui {
+
+void FilterCache::begin_frame() {
+  ++m_frame;
+  trim(m_budget);
+}
+
+FilterCache::Entry* FilterCache::find(uint64_t key) {
+  const auto it = m_entries.find(key);
+  if (it == m_entries.end() || it->second.size == 0) {
+    return nullptr;
+  }
+  it->second.lastUsedFrame = m_frame;
+  return &it->second;
+}
+
+FilterCache::Entry* FilterCache::record(uint64_t key, uint64_t bytes) {
+  // Only results that recur on a later frame are kept, so animated elements never pay for the copy.
+  auto& entry = m_entries[key];
+  const bool recurring = entry.lastUsedFrame != 0 && entry.lastUsedFrame != m_frame;
+  entry.lastUsedFrame = m_frame;
+  if (!recurring || entry.size != 0 || bytes == 0 || bytes > m_budget) {
+    return nullptr;
+  }
+
+  trim(m_budget - bytes);
+  entry.size = bytes;
+  m_size += bytes;
+  return &entry;
+}
+
+void FilterCache::trim(uint64_t budget) {
+  std::erase_if(m_entries, [this](const auto& item) {
+    if (m_frame - item.second.lastUsedFrame <= MaxIdleFrames) {
+      return false;
+    }
+    m_size -= item.second.size;
+    return true;
+  });
+
+  while (m_size > budget) {
+    auto oldest = m_entries.end();
+    for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+      const bool older = oldest == m_entries.end() || it->second.lastUsedFrame < oldest->second.lastUsedFrame;
+      if (it->second.size != 0 && older) {
+        oldest = it;
+      }
+    }
+    if (oldest == m_entries.end()) {
+      break;
+    }
+    m_size -= oldest->second.size;
+    m_entries.erase(oldest);
+  }
+}
+
+} // namespace aurora::rmlui
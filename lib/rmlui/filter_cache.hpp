@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <unordered_map>
+
+#include <webgpu/webgpu_cpp.h>
+#include <xxhash.h>
+
+namespace aurora::rmlui {
+
+template <typename T>
+uint64_t mix_signature(uint64_t seed, const T& value) {
+  static_assert(std::is_standard_layout_v<T>);
+  return XXH3_64bits_withSeed(&value, sizeof(T), seed);
+}
+
+// Hash of every draw into a layer since it was last cleared. Layers seeded from the game frame, or composited from
+// such a layer, are not stable and never hit the filter cache.
+struct LayerSignature {
+  uint64_t hash = 0;
+  bool stable = true;
+
+  template <typename T>
+  void mix(const T& value) {
+    hash = mix_signature(hash, value);
+  }
+  // Folds in contents derived from another layer, which are only stable if that layer is.
+  void mix(const LayerSignature& other) {
+    hash = mix_signature(hash, other.hash);
+    stable = stable && other.stable;
+  }
+};
+
+// Filtered layer contents keyed by the source layer signature, filter parameters and region. Only results that recur
+// on a later frame are kept, within a memory budget; the least recently used are evicted first, and results not
+// composited for MaxIdleFrames are dropped.
+class FilterCache {
+public:
+  static constexpr uint64_t MaxIdleFrames = 120;
+
+  struct Entry {
+    // Null until the same result recurs on a later frame.
+    wgpu::Texture texture;
+    uint64_t lastUsedFrame = 0;
+    // Bytes reserved for `texture`, 0 while no result is kept.
+    uint64_t size = 0;
+  };
+
+  explicit FilterCache(uint64_t budget) noexcept : m_budget(budget) {}
+
+  // Advances the frame and drops idle entries.
+  void begin_frame();
+  // The entry holding the result for `key`, or null if none is kept. Marks it used in this frame.
+  Entry* find(uint64_t key);
+  // Records that the result for `key` was rendered in this frame. If it was also rendered on an earlier frame and
+  // `bytes` fit the budget, evicts older results as needed and returns the entry to keep it in; the caller creates
+  // its texture.
+  Entry* record(uint64_t key, uint64_t bytes);
+
+  uint64_t frame() const noexcept { return m_frame; }
+  uint64_t size() const noexcept { return m_size; }
+  size_t entry_count() const noexcept { return m_entries.size(); }
+
+private:
+  void trim(uint64_t budget);
+
+  std::unordered_map<uint64_t, Entry> m_entries;
+  uint64_t m_budget = 0;
+  uint64_t m_size = 0;
+  uint64_t m_frame = 0;
+};
+
+} // namespace aurora::rmlui
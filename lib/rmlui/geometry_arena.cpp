@@ -0,0 +1,167 @@
+#include "geometry_arena.hpp"
+
+#include "../gfx/frame.hpp"
+#include "../gfx/resources.hpp"
+#include "../internal.hpp"
+#include "../logging.hpp"
+#include "../webgpu/gpu.hpp"
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <optional>
+#include <vector>
+
+#include <absl/container/btree_map.h>
+
+namespace aurora::rmlui {
+namespace {
+Module Log("aurora::rmlui::GeometryArena");
+
+constexpr uint32_t GeometryPoolSize = 1048576; // 1 MiB
+constexpr uint32_t MaxGeometryPools = 32;
+// Satisfies both the vertex buffer offset and uint32 index buffer offset requirements.
+constexpr uint32_t GeometryAlignment = 4;
+
+struct GeometryPool {
+  wgpu::Buffer buffer;
+  uint32_t size = 0;
+  // Free ranges keyed by offset; adjacent ranges are coalesced on release.
+  absl::btree_map<uint32_t, uint32_t> freeRanges;
+};
+
+struct RetiredRange {
+  uint32_t frame;
+  GeometryAllocation allocation;
+};
+
+// Pools are never moved or destroyed before shutdown, so the render worker can look up the buffer of any draw
+// recorded after the pool was created.
+std::array<GeometryPool, MaxGeometryPools> g_pools;
+uint32_t g_poolCount = 0;
+std::vector<RetiredRange> g_retiredRanges;
+uint64_t g_residentSize = 0;
+bool g_warnedExhausted = false;
+
+void update_stats() noexcept {
+  gfx::detail::resources().stats.residentUiGeometrySize =
+      static_cast<uint32_t>(std::min<uint64_t>(g_residentSize, UINT32_MAX));
+}
+
+void release_range(GeometryPool& pool, uint32_t offset, uint32_t size) {
+  auto next = pool.freeRanges.lower_bound(offset);
+  if (next != pool.freeRanges.end() && offset + size == next->first) {
+    size += next->second;
+    next = pool.freeRanges.erase(next);
+  }
+  if (next != pool.freeRanges.begin()) {
+    const auto prev = std::prev(next);
+    if (prev->first + prev->second == offset) {
+      prev->second += size;
+      return;
+    }
+  }
+  pool.freeRanges.emplace_hint(next, offset, size);
+}
+
+void reclaim_retired_ranges() {
+  const uint32_t frame = gfx::current_frame();
+  std::erase_if(g_retiredRanges, [frame](const RetiredRange& retired) {
+    if (retired.frame == frame) {
+      return false;
+    }
+    const auto& allocation = retired.allocation;
+    release_range(g_pools[allocation.buffer - 1], allocation.offset, allocation.size);
+    return true;
+  });
+}
+
+std::optional<GeometryAllocation> allocate_from(uint32_t poolIndex, uint32_t size) {
+  auto& pool = g_pools[poolIndex];
+  const auto it = std::ranges::find_if(pool.freeRanges, [size](const auto& range) { return range.second >= size; });
+  if (it == pool.freeRanges.end()) {
+    return std::nullopt;
+  }
+  const uint32_t offset = it->first;
+  const uint32_t remaining = it->second - size;
+  pool.freeRanges.erase(it);
+  if (remaining != 0) {
+    pool.freeRanges.emplace(offset + size, remaining);
+  }
+  return GeometryAllocation{
+      .buffer = poolIndex + 1,
+      .offset = offset,
+      .size = size,
+  };
+}
+
+bool create_pool(uint32_t minSize) {
+  if (g_poolCount == MaxGeometryPools) {
+    return false;
+  }
+  const uint32_t size = std::max(GeometryPoolSize, minSize);
+  const wgpu::BufferDescriptor descriptor{
+      .label = "RmlUi Geometry Pool",
+      .usage = wgpu::BufferUsage::Vertex | wgpu::BufferUsage::Index | wgpu::BufferUsage::CopyDst,
+      .size = size,
+  };
+  auto& pool = g_pools[g_poolCount];
+  pool.buffer = webgpu::g_device.CreateBuffer(&descriptor);
+  pool.size = size;
+  pool.freeRanges.emplace(0, size);
+  ++g_poolCount;
+  return true;
+}
+} // namespace
+
+GeometryAllocation allocate_geometry(uint32_t size) {
+  if (size == 0) {
+    return {};
+  }
+  size = AURORA_ALIGN(size, GeometryAlignment);
+  reclaim_retired_ranges();
+
+  std::optional<GeometryAllocation> allocation;
+  for (uint32_t i = 0; i < g_poolCount && !allocation; ++i) {
+    allocation = allocate_from(i, size);
+  }
+  if (!allocation && create_pool(size)) {
+    allocation = allocate_from(g_poolCount - 1, size);
+  }
+  if (!allocation) {
+    if (!g_warnedExhausted) {
+      Log.warn("Geometry pools exhausted ({} bytes resident); falling back to per-frame buffers", g_residentSize);
+      g_warnedExhausted = true;
+    }
+    return {};
+  }
+
+  g_residentSize += allocation->size;
+  update_stats();
+  return *allocation;
+}
+
+void free_geometry(const GeometryAllocation& allocation) {
+  if (allocation.buffer == 0 || allocation.buffer > g_poolCount) {
+    return;
+  }
+  g_retiredRanges.push_back(RetiredRange{
+      .frame = gfx::current_frame(),
+      .allocation = allocation,
+  });
+  g_residentSize -= allocation.size;
+  update_stats();
+}
+
+const wgpu::Buffer& geometry_buffer(uint32_t buffer) noexcept { return g_pools[buffer - 1].buffer; }
+
+void shutdown_geometry_arena() {
+  g_pools = {};
+  g_poolCount = 0;
+  g_retiredRanges.clear();
+  g_residentSize = 0;
+  g_warnedExhausted = false;
+  update_stats();
+}
+
+} // namespace aurora::rmlui
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+
+#include <webgpu/webgpu_cpp.h>
+
+namespace aurora::rmlui {
+
+// A suballocation of one of the persistent RmlUi geometry buffers. `buffer` is 0 for no allocation, otherwise the
+// pool index plus one, as stored in DrawData::geometryBuffer.
+struct GeometryAllocation {
+  uint32_t buffer = 0;
+  uint32_t offset = 0;
+  uint32_t size = 0;
+};
+
+// Reserves `size` bytes of vertex/index buffer space for compiled geometry. Returns an empty allocation when every pool
+// is exhausted; callers fall back to the per-frame staging buffers.
+GeometryAllocation allocate_geometry(uint32_t size);
+// Returns the space to the pool. Freed ranges are only handed out again from the next frame on, since draws recorded
+// this frame may still reference them ahead of a later upload.
+void free_geometry(const GeometryAllocation& allocation);
+const wgpu::Buffer& geometry_buffer(uint32_t buffer) noexcept;
+void shutdown_geometry_arena();
+
+} // namespace aurora::rmlui
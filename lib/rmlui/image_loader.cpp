@@ -0,0 +1,428 @@
+#include "image_loader.hpp"
+
+#include "FileInterface_SDL.h"
+#include "../logging.hpp"
+#include "../thread.hpp"
+
+#include <SDL3/SDL_error.h>
+#include <SDL3/SDL_filesystem.h>
+#include <SDL3/SDL_iostream.h>
+#include <SDL3/SDL_surface.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <utility>
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
+#include <fmt/format.h>
+#include <tracy/Tracy.hpp>
+#include <xxhash.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define AURORA_PREMULTIPLY_SSE2
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define AURORA_PREMULTIPLY_NEON
+#endif
+
+namespace aurora::rmlui::image_loader {
+namespace {
+Module Log("aurora::rmlui::ImageLoader");
+
+constexpr std::array<uint8_t, 8> PngSignature{0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+// Signature, IHDR chunk length and type, width and height.
+constexpr size_t PngHeaderSize = 24;
+
+struct CacheEntry {
+  Image image;
+  std::list<uint64_t>::iterator lru;
+};
+
+// Size and modification time of a source file when it was last loaded. A cached decode is only served for the source
+// while both still match, since the cache itself is keyed by the hash of the contents read at that time.
+struct SourceStamp {
+  uint64_t size = 0;
+  SDL_Time modifyTime = 0;
+
+  bool operator==(const SourceStamp&) const = default;
+};
+
+struct SourceEntry {
+  uint64_t key = 0;
+  SourceStamp stamp;
+};
+
+struct Job {
+  LoadId id = 0;
+  std::string source;
+};
+
+std::mutex g_cacheMutex;
+absl::flat_hash_map<uint64_t, CacheEntry> g_cache;
+absl::flat_hash_map<std::string, SourceEntry> g_sourceKeys;
+std::list<uint64_t> g_cacheLru;
+size_t g_cacheSize = 0;
+size_t g_cacheBudget = DefaultCacheBudget;
+
+std::mutex g_jobMutex;
+std::condition_variable g_jobCv;
+std::deque<Job> g_jobs;
+// Loads that are queued or decoding and have not been cancelled.
+absl::flat_hash_set<LoadId> g_activeLoads;
+std::vector<Completion> g_completions;
+std::vector<thread::Thread> g_workers;
+LoadId g_nextLoadId = 1;
+std::atomic_bool g_synchronous = false;
+
+void premultiply_scalar(uint8_t* texels, size_t size) noexcept {
+  for (size_t offset = 0; offset + 4 <= size; offset += 4) {
+    const uint32_t alpha = texels[offset + 3];
+    for (size_t channel = 0; channel < 3; ++channel) {
+      texels[offset + channel] = static_cast<uint8_t>((texels[offset + channel] * alpha) / 255);
+    }
+  }
+}
+
+// Both vector paths compute x / 255 for x = c * a as (t + (t >> 8)) >> 8 with t = x + 1, which is exact for x < 65535.
+#if defined(AURORA_PREMULTIPLY_SSE2)
+__m128i premultiply_pixels(__m128i texels) noexcept {
+  const __m128i alphaMask = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+  const __m128i alpha =
+      _mm_shufflehi_epi16(_mm_shufflelo_epi16(texels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+  __m128i product = _mm_add_epi16(_mm_mullo_epi16(texels, alpha), _mm_set1_epi16(1));
+  product = _mm_srli_epi16(_mm_add_epi16(product, _mm_srli_epi16(product, 8)), 8);
+  return _mm_or_si128(_mm_andnot_si128(alphaMask, product), _mm_and_si128(alphaMask, texels));
+}
+#elif defined(AURORA_PREMULTIPLY_NEON)
+uint8x8_t premultiply_channel(uint8x8_t color, uint8x8_t alpha) noexcept {
+  const uint16x8_t product = vaddq_u16(vmull_u8(color, alpha), vdupq_n_u16(1));
+  return vaddhn_u16(product, vshrq_n_u16(product, 8));
+}
+#endif
+
+std::optional<SourceStamp> stat_source(const std::string& source) {
+  SDL_PathInfo info;
+  if (!SDL_GetPathInfo(resolve_path(source).c_str(), &info)) {
+    return std::nullopt;
+  }
+  return SourceStamp{
+      .size = info.size,
+      .modifyTime = info.modify_time,
+  };
+}
+
+std::optional<std::vector<uint8_t>> read_source(const std::string& source) {
+  FileInterface_SDL fileInterface;
+  const Rml::FileHandle file = fileInterface.Open(source);
+  if (file == Rml::FileHandle{}) {
+    return std::nullopt;
+  }
+  std::vector<uint8_t> bytes(fileInterface.Length(file));
+  const size_t read = fileInterface.Read(bytes.data(), bytes.size(), file);
+  fileInterface.Close(file);
+  if (read != bytes.size()) {
+    Log.warn("Failed to read image '{}'", source);
+    return std::nullopt;
+  }
+  return bytes;
+}
+
+std::optional<Image> decode_png(const std::vector<uint8_t>& bytes, const std::string& source) {
+  ZoneScoped;
+  SDL_IOStream* stream = SDL_IOFromConstMem(bytes.data(), bytes.size());
+  if (stream == nullptr) {
+    Log.warn("Failed to open image '{}': {}", source, SDL_GetError());
+    return std::nullopt;
+  }
+  SDL_Surface* loadedSurface = SDL_LoadPNG_IO(stream, true);
+  if (loadedSurface == nullptr) {
+    Log.warn("Failed to load image '{}': {}", source, SDL_GetError());
+    return std::nullopt;
+  }
+
+  SDL_Surface* rgbaSurface = SDL_ConvertSurface(loadedSurface, SDL_PIXELFORMAT_RGBA32);
+  SDL_DestroySurface(loadedSurface);
+  if (rgbaSurface == nullptr) {
+    Log.warn("Failed to convert image '{}': {}", source, SDL_GetError());
+    return std::nullopt;
+  }
+
+  const auto width = static_cast<uint32_t>(rgbaSurface->w);
+  const auto height = static_cast<uint32_t>(rgbaSurface->h);
+  const size_t rowSize = static_cast<size_t>(width) * 4;
+  auto texels = std::make_shared<std::vector<uint8_t>>(rowSize * height);
+  for (uint32_t row = 0; row < height; ++row) {
+    const auto* src = static_cast<const uint8_t*>(rgbaSurface->pixels) +
+                      static_cast<size_t>(row) * static_cast<size_t>(rgbaSurface->pitch);
+    std::memcpy(texels->data() + static_cast<size_t>(row) * rowSize, src, rowSize);
+  }
+  SDL_DestroySurface(rgbaSurface);
+
+  // Convert colors to premultiplied alpha, which is necessary for correct alpha compositing.
+  premultiply_alpha(*texels);
+  return Image{
+      .rgba = std::move(texels),
+      .width = width,
+      .height = height,
+  };
+}
+
+std::optional<Image> lookup_locked(uint64_t key) {
+  const auto it = g_cache.find(key);
+  if (it == g_cache.end()) {
+    return std::nullopt;
+  }
+  g_cacheLru.splice(g_cacheLru.begin(), g_cacheLru, it->second.lru);
+  return it->second.image;
+}
+
+void evict_locked() {
+  while (g_cacheSize > g_cacheBudget && !g_cacheLru.empty()) {
+    const auto it = g_cache.find(g_cacheLru.back());
+    g_cacheSize -= it->second.image.rgba->size();
+    g_cache.erase(it);
+    g_cacheLru.pop_back();
+  }
+}
+
+void insert_locked(uint64_t key, const Image& image) {
+  if (g_cache.contains(key) || image.rgba->size() > g_cacheBudget) {
+    return;
+  }
+  g_cacheLru.push_front(key);
+  g_cache.emplace(key, CacheEntry{
+                           .image = image,
+                           .lru = g_cacheLru.begin(),
+                       });
+  g_cacheSize += image.rgba->size();
+  evict_locked();
+}
+
+void worker_main(std::stop_token token) {
+  std::stop_callback notifyOnStop{token, [] { g_jobCv.notify_all(); }};
+  while (true) {
+    Job job;
+    {
+      std::unique_lock lock{g_jobMutex};
+      g_jobCv.wait(lock, [&] { return token.stop_requested() || !g_jobs.empty(); });
+      if (token.stop_requested()) {
+        return;
+      }
+      job = std::move(g_jobs.front());
+      g_jobs.pop_front();
+    }
+
+    auto image = load(job.source);
+
+    std::lock_guard lock{g_jobMutex};
+    if (!token.stop_requested() && g_activeLoads.erase(job.id) != 0) {
+      g_completions.push_back({
+          .id = job.id,
+          .image = std::move(image),
+      });
+    }
+  }
+}
+
+void start_worker_pool() {
+  if (!g_workers.empty()) {
+    return;
+  }
+  const uint32_t hardwareThreads = std::max(std::thread::hardware_concurrency(), 1u);
+  const uint32_t workerCount = std::clamp(hardwareThreads / 2, 1u, 4u);
+  for (uint32_t i = 0; i < workerCount; ++i) {
+    g_workers.emplace_back(
+        thread::Options{
+            .name = fmt::format("Aurora image worker {}", i),
+            .priority = thread::Priority::Low,
+        },
+        worker_main);
+  }
+}
+} // namespace
+
+void premultiply_alpha(std::span<uint8_t> rgba) noexcept {
+  uint8_t* texels = rgba.data();
+  const size_t size = rgba.size() & ~size_t{3};
+  size_t offset = 0;
+#if defined(AURORA_PREMULTIPLY_SSE2)
+  const __m128i zero = _mm_setzero_si128();
+  for (; offset + 16 <= size; offset += 16) {
+    auto* ptr = reinterpret_cast<__m128i*>(texels + offset);
+    const __m128i pixels = _mm_loadu_si128(ptr);
+    const __m128i lo = premultiply_pixels(_mm_unpacklo_epi8(pixels, zero));
+    const __m128i hi = premultiply_pixels(_mm_unpackhi_epi8(pixels, zero));
+    _mm_storeu_si128(ptr, _mm_packus_epi16(lo, hi));
+  }
+#elif defined(AURORA_PREMULTIPLY_NEON)
+  for (; offset + 64 <= size; offset += 64) {
+    uint8x16x4_t pixels = vld4q_u8(texels + offset);
+    const uint8x8_t alphaLo = vget_low_u8(pixels.val[3]);
+    const uint8x8_t alphaHi = vget_high_u8(pixels.val[3]);
+    for (int channel = 0; channel < 3; ++channel) {
+      pixels.val[channel] = vcombine_u8(premultiply_channel(vget_low_u8(pixels.val[channel]), alphaLo),
+                                        premultiply_channel(vget_high_u8(pixels.val[channel]), alphaHi));
+    }
+    vst4q_u8(texels + offset, pixels);
+  }
+#endif
+  premultiply_scalar(texels + offset, size - offset);
+}
+
+std::optional<Image> find_cached(const std::string& source) {
+  const auto stamp = stat_source(source);
+  std::lock_guard lock{g_cacheMutex};
+  const auto it = g_sourceKeys.find(source);
+  if (it == g_sourceKeys.end()) {
+    return std::nullopt;
+  }
+  std::optional<Image> image;
+  if (stamp && *stamp == it->second.stamp) {
+    image = lookup_locked(it->second.key);
+  }
+  if (!image) {
+    g_sourceKeys.erase(it);
+  }
+  return image;
+}
+
+std::optional<std::pair<uint32_t, uint32_t>> read_dimensions(const std::string& source) {
+  FileInterface_SDL fileInterface;
+  const Rml::FileHandle file = fileInterface.Open(source);
+  if (file == Rml::FileHandle{}) {
+    return std::nullopt;
+  }
+  std::array<uint8_t, PngHeaderSize> header{};
+  const size_t read = fileInterface.Read(header.data(), header.size(), file);
+  fileInterface.Close(file);
+  if (read != header.size() || !std::equal(PngSignature.begin(), PngSignature.end(), header.begin()) ||
+      std::memcmp(header.data() + 12, "IHDR", 4) != 0) {
+    return std::nullopt;
+  }
+  const auto readBE32 = [&](size_t offset) {
+    return static_cast<uint32_t>(header[offset]) << 24 | static_cast<uint32_t>(header[offset + 1]) << 16 |
+           static_cast<uint32_t>(header[offset + 2]) << 8 | static_cast<uint32_t>(header[offset + 3]);
+  };
+  const uint32_t width = readBE32(16);
+  const uint32_t height = readBE32(20);
+  if (width == 0 || height == 0) {
+    return std::nullopt;
+  }
+  return std::pair{width, height};
+}
+
+std::optional<Image> load(const std::string& source) {
+  ZoneScoped;
+  // Taken before reading, so a write racing the read leaves a stamp that no longer matches.
+  const auto stamp = stat_source(source);
+  const auto bytes = read_source(source);
+  if (!bytes) {
+    return std::nullopt;
+  }
+  const uint64_t key = XXH3_64bits(bytes->data(), bytes->size());
+  const auto remember_source = [&] {
+    if (stamp) {
+      g_sourceKeys[source] = {.key = key, .stamp = *stamp};
+    } else {
+      g_sourceKeys.erase(source);
+    }
+  };
+  {
+    std::lock_guard lock{g_cacheMutex};
+    if (auto image = lookup_locked(key)) {
+      remember_source();
+      return image;
+    }
+  }
+
+  auto image = decode_png(*bytes, source);
+  if (image) {
+    std::lock_guard lock{g_cacheMutex};
+    remember_source();
+    insert_locked(key, *image);
+  }
+  return image;
+}
+
+LoadId queue_load(std::string source) {
+  std::lock_guard lock{g_jobMutex};
+  start_worker_pool();
+  const LoadId id = g_nextLoadId++;
+  g_activeLoads.insert(id);
+  g_jobs.push_back({
+      .id = id,
+      .source = std::move(source),
+  });
+  g_jobCv.notify_one();
+  return id;
+}
+
+void cancel(LoadId id) {
+  std::lock_guard lock{g_jobMutex};
+  if (g_activeLoads.erase(id) == 0) {
+    std::erase_if(g_completions, [id](const Completion& completion) { return completion.id == id; });
+    return;
+  }
+  std::erase_if(g_jobs, [id](const Job& job) { return job.id == id; });
+}
+
+std::vector<Completion> take_completions() {
+  std::lock_guard lock{g_jobMutex};
+  return std::exchange(g_completions, {});
+}
+
+void set_synchronous(bool synchronous) noexcept { g_synchronous.store(synchronous, std::memory_order_relaxed); }
+
+bool synchronous() noexcept { return g_synchronous.load(std::memory_order_relaxed); }
+
+void set_cache_budget(size_t bytes) {
+  std::lock_guard lock{g_cacheMutex};
+  g_cacheBudget = bytes;
+  evict_locked();
+}
+
+size_t cache_size() noexcept {
+  std::lock_guard lock{g_cacheMutex};
+  return g_cacheSize;
+}
+
+void clear_cache() {
+  std::lock_guard lock{g_cacheMutex};
+  g_cache.clear();
+  g_sourceKeys.clear();
+  g_cacheLru.clear();
+  g_cacheSize = 0;
+}
+
+void shutdown() {
+  {
+    std::lock_guard lock{g_jobMutex};
+    g_jobs.clear();
+  }
+  for (auto& worker : g_workers) {
+    worker.request_stop();
+  }
+  g_jobCv.notify_all();
+  for (auto& worker : g_workers) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+  {
+    std::lock_guard lock{g_jobMutex};
+    g_workers.clear();
+    g_activeLoads.clear();
+    g_completions.clear();
+  }
+  clear_cache();
+}
+
+} // namespace aurora::rmlui::image_loader
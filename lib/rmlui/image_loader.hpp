@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace aurora::rmlui::image_loader {
+
+struct Image {
+  // Premultiplied RGBA8 texels, shared with the cache.
+  std::shared_ptr<const std::vector<uint8_t>> rgba;
+  uint32_t width = 0;
+  uint32_t height = 0;
+};
+
+using LoadId = uint64_t;
+
+struct Completion {
+  LoadId id = 0;
+  std::optional<Image> image;
+};
+
+inline constexpr size_t DefaultCacheBudget = 67108864; // 64 MiB
+
+// Converts RGBA8 texels to premultiplied alpha in place, rounding down like (c * a) / 255.
+void premultiply_alpha(std::span<uint8_t> rgba) noexcept;
+
+// Returns the decoded image last loaded from `source`, if it is still cached and the file's size and modification time
+// are unchanged since that load. Reopened documents only skip decoding while their images are untouched on disk.
+std::optional<Image> find_cached(const std::string& source);
+// Reads only the PNG header of `source`, returning its width and height.
+std::optional<std::pair<uint32_t, uint32_t>> read_dimensions(const std::string& source);
+// Decodes `source` on the calling thread, going through the cache.
+std::optional<Image> load(const std::string& source);
+// Queues `source` for decoding on the worker pool; the result is returned by take_completions.
+LoadId queue_load(std::string source);
+// Drops the result of a queued load. Decoding already in progress still populates the cache.
+void cancel(LoadId id);
+std::vector<Completion> take_completions();
+
+// When enabled, textures are decoded on the calling thread inside LoadTexture. Intended for tests and tools.
+void set_synchronous(bool synchronous) noexcept;
+bool synchronous() noexcept;
+// Decoded images are keyed by the hash of their encoded contents and evicted least recently used first.
+void set_cache_budget(size_t bytes);
+size_t cache_size() noexcept;
+void clear_cache();
+
+void shutdown();
+
+} // namespace aurora::rmlui::image_loader
@@ -1,5 +1,6 @@
 #include "pipeline.hpp"
 
+#include "geometry_arena.hpp"
 #include "../gfx/encoding.hpp"
 #include "../gfx/resources.hpp"
 #include "../gfx/resource_cache.hpp"
@@ -782,6 +783,7 @@ void initialize_pipeline() {
 }
 
 void shutdown_pipeline() {
+  shutdown_geometry_arena();
   g_commonBindGroupLayout = {};
   g_imageBindGroupLayout = {};
   g_uniformBindGroupLayout = {};
@@ -996,8 +998,11 @@ void render(const DrawData& data, const wgpu::RenderPassEncoder& pass) {
 
   if (static_cast<DrawKind>(data.drawKind) == DrawKind::Geometry) {
     auto& resources = gfx::detail::resources();
-    pass.SetVertexBuffer(0, resources.vertexBuffer, data.vertexRange.offset, data.vertexRange.size);
-    pass.SetIndexBuffer(resources.indexBuffer, wgpu::IndexFormat::Uint32, data.indexRange.offset, data.indexRange.size);
+    const bool resident = data.geometryBuffer != 0;
+    pass.SetVertexBuffer(0, resident ? geometry_buffer(data.geometryBuffer) : resources.vertexBuffer,
+                         data.vertexRange.offset, data.vertexRange.size);
+    pass.SetIndexBuffer(resident ? geometry_buffer(data.geometryBuffer) : resources.indexBuffer,
+                        wgpu::IndexFormat::Uint32, data.indexRange.offset, data.indexRange.size);
     pass.DrawIndexed(data.indexCount);
   } else {
     pass.Draw(data.vertexCount);
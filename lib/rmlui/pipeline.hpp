@@ -86,6 +86,8 @@ struct DrawData {
   uint32_t stencilRef = 0;
   std::array<float, 4> blendConstant{};
   uint32_t hasBlendConstant = 0;
+  // Non-zero when vertexRange and indexRange refer to a persistent geometry buffer; see geometry_arena.hpp.
+  uint32_t geometryBuffer = 0;
 };
 static_assert(std::is_trivially_copyable_v<DrawData>);
 
@@ -75,6 +75,8 @@ void draw_clear(const wgpu::RenderPassEncoder& pass, bool clearColor, bool clear
 
 size_t load_from_cache(void const* key, size_t keySize, void* value, size_t valueSize, void* userdata);
 void store_to_cache(void const* key, size_t keySize, void const* value, size_t valueSize, void* userdata);
+// Blocks until all stores issued so far are committed to the cache database.
+void cache_flush();
 void cache_prune();
 void cache_shutdown();
 
@@ -1,17 +1,29 @@
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
 #include <cstring>
 #include <cstdint>
+#include <deque>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <string>
 #include <filesystem>
+#include <thread>
 #include <vector>
 
+#include "gpu.hpp"
+#include "../cache_snapshot.hpp"
 #include "../internal.hpp"
 #include "../io.hpp"
 #include "../sqlite_utils.hpp"
 
+#include <SDL3/SDL_error.h>
+#include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
 #include <sqlite3.h>
 #include <fmt/format.h>
+#include <tracy/Tracy.hpp>
 #if defined(AURORA_CACHE_USE_ZSTD)
 #include <zstd.h>
 #endif
@@ -21,24 +33,66 @@
 namespace aurora::webgpu {
 static Module Log("aurora::gpu::cache");
 
+struct CacheKeyHash {
+  size_t operator()(const XXH128_hash_t& key) const noexcept { return key.low64 ^ key.high64; }
+};
+struct CacheKeyEq {
+  bool operator()(const XXH128_hash_t& a, const XXH128_hash_t& b) const noexcept {
+    return a.low64 == b.low64 && a.high64 == b.high64;
+  }
+};
+
+using CacheValue = std::shared_ptr<const std::vector<uint8_t>>;
+
+struct PendingWrite {
+  XXH128_hash_t key;
+  CacheValue value;
+};
+
 static sqlite3* db;
 static sqlite3_stmt* load_stmt;
 static sqlite3_stmt* store_stmt;
+static cache_snapshot::Snapshot snapshot;
+// Stored in PRAGMA user_version and bumped by every transaction that changes cache rows, so a snapshot built at this
+// stamp holds exactly the current rows
+static uint32_t cache_stamp;
+// Keys written since the snapshot was built, whose snapshot values are stale
+static absl::flat_hash_set<XXH128_hash_t, CacheKeyHash, CacheKeyEq> snapshot_stale_keys;
 static bool cache_broken;
 static std::mutex cache_mutex;
 static std::vector<XXH128_hash_t> cache_keys_used;
 #if defined(AURORA_CACHE_USE_ZSTD)
+// Only used by the writer thread
 static std::vector<uint8_t> compress_buffer;
 #endif
 
+// Stores are handed to a writer thread that compresses and commits them in batches. Until a write is committed, loads
+// of its key are served from pending_writes. All of the following is guarded by pending_mutex.
+static std::mutex pending_mutex;
+static std::condition_variable writer_cv;
+static std::condition_variable flushed_cv;
+static std::thread writer_thread;
+static std::deque<PendingWrite> write_queue;
+static absl::flat_hash_map<XXH128_hash_t, CacheValue, CacheKeyHash, CacheKeyEq> pending_writes;
+static uint64_t writes_queued;
+static uint64_t writes_done;
+static bool flush_requested;
+static bool writer_stop;
+
 constexpr int CACHE_SCHEMA = 2;
 // % of rows pruned to trigger a full VACUUM
 constexpr uint64_t VacuumPrunePercentThreshold = 25;
+// How long the writer waits for more stores before committing, since pipeline compiles tend to come in bursts
+constexpr auto WriteBatchDelay = std::chrono::milliseconds{100};
 
 static std::filesystem::path cache_path() {
   return io::fs_path_from_string(g_config.cachePath) / "dawn_cache.db";
 }
 
+static std::filesystem::path snapshot_path() {
+  return io::fs_path_from_string(g_config.cachePath) / "dawn_cache.snapshot";
+}
+
 static void init_abort() {
   cache_broken = true;
   sqlite3_close(db);
@@ -99,6 +153,33 @@ INSERT INTO aurora_schema VALUES ({});)",
   return true;
 }
 
+static bool read_cache_stamp() {
+  bool found = false;
+  const auto ret = sqlite::exec(db, "PRAGMA user_version", [&found](int argc, char** argv, char**) {
+    if (argc == 1 && argv[0] != nullptr) {
+      cache_stamp = static_cast<uint32_t>(std::strtoul(argv[0], nullptr, 10));
+      found = true;
+    }
+  });
+  if (ret != SQLITE_OK || !found) {
+    Log.error("Failed to read dawn cache stamp: {}", sqlite3_errmsg(db));
+    return false;
+  }
+  return true;
+}
+
+static bool bump_cache_stamp() {
+  // user_version is a signed 32-bit integer
+  const uint32_t stamp = (cache_stamp + 1) & 0x7FFFFFFF;
+  const auto sql = fmt::format("PRAGMA user_version = {}", stamp);
+  if (sqlite::exec(db, sql.c_str()) != SQLITE_OK) {
+    Log.error("Failed to update dawn cache stamp: {}", sqlite3_errmsg(db));
+    return false;
+  }
+  cache_stamp = stamp;
+  return true;
+}
+
 static bool cache_init_core() {
   Log.debug("SQLite version {}", sqlite3_libversion());
 
@@ -122,6 +203,10 @@ static bool cache_init_core() {
     return false;
   }
 
+  if (!read_cache_stamp()) {
+    return false;
+  }
+
   ret = sqlite3_prepare_v3(db, "SELECT value, size, compressed FROM cache WHERE key = ?", -1, SQLITE_PREPARE_PERSISTENT,
                            &load_stmt, nullptr);
   if (ret != SQLITE_OK) {
@@ -217,23 +302,89 @@ static bool cache_init() {
 
   Log.debug("SQLite cache init succeeded");
 
+  // The snapshot is only used if no rows changed since it was built; otherwise the next prune rebuilds it
+  snapshot = cache_snapshot::Snapshot::open(snapshot_path(), CACHE_SCHEMA, sizeof(XXH128_hash_t));
+  if (snapshot && snapshot.source_stamp() != cache_stamp) {
+    Log.debug("Ignoring stale dawn cache snapshot");
+    snapshot = {};
+  }
+  if (snapshot) {
+    Log.debug("Mapped dawn cache snapshot with {} entries", snapshot.size());
+  }
+
+  return true;
+}
+
+// Copies a stored value of rawSize bytes into value, decompressing it if needed.
+static bool copy_cache_value(void* value, const void* stored, size_t storedSize, size_t rawSize, bool compressed) {
+  if (compressed) {
+#if defined(AURORA_CACHE_USE_ZSTD)
+    const auto zstdRet = ZSTD_decompress(value, rawSize, stored, storedSize);
+    if (ZSTD_isError(zstdRet)) {
+      Log.error("zstd decompression error: {}", ZSTD_getErrorName(zstdRet));
+      return false;
+    }
+    if (zstdRet != rawSize) {
+      Log.error("zstd decompression size mismatch: expected {}, got {}", rawSize, zstdRet);
+      return false;
+    }
+    return true;
+#else
+    Log.error("Cache entry is zstd-compressed but zstd support is disabled");
+    return false;
+#endif
+  }
+  if (rawSize != 0 && (!stored || storedSize != rawSize)) {
+    Log.error("Cache entry is missing raw value data");
+    return false;
+  }
+  if (rawSize != 0) {
+    std::memcpy(value, stored, rawSize);
+  }
   return true;
 }
 
 size_t load_from_cache(void const* key, size_t keySize, void* value, size_t valueSize, void*) {
+  const auto keyHash = XXH128(key, keySize, 0);
+  {
+    std::lock_guard lock(pending_mutex);
+    if (const auto it = pending_writes.find(keyHash); it != pending_writes.end()) {
+      const auto& pending = *it->second;
+      if (value && valueSize == pending.size() && !pending.empty()) {
+        std::memcpy(value, pending.data(), pending.size());
+      }
+      return pending.size();
+    }
+  }
+
   std::lock_guard lock(cache_mutex);
 
   if (!cache_init()) {
     return 0;
   }
 
+  const auto record = snapshot_stale_keys.contains(keyHash)
+                          ? std::nullopt
+                          : snapshot.find({reinterpret_cast<const uint8_t*>(&keyHash), sizeof(keyHash)});
+  if (record) {
+    if (!value || valueSize != record->rawSize) {
+      return record->rawSize;
+    }
+    // Values are only stored compressed when that makes them smaller
+    const bool compressed = record->value.size() != record->rawSize;
+    if (copy_cache_value(value, record->value.data(), record->value.size(), record->rawSize, compressed)) {
+      cache_keys_used.push_back(keyHash);
+      return record->rawSize;
+    }
+    // Fall back to the database
+  }
+
   sqlite::Transaction tx(db, Log);
   if (!tx) {
     Log.error("Failed to open load transaction");
     return 0;
   }
 
-  const auto keyHash = XXH128(key, keySize, 0);
   check(sqlite3_bind_blob(load_stmt, 1, &keyHash, sizeof(keyHash), SQLITE_TRANSIENT));
 
   const auto ret = sqlite3_step(load_stmt);
@@ -246,33 +397,9 @@ size_t load_from_cache(void const* key, size_t keySize, void* value, size_t valu
     const bool compressed = sqlite3_column_int(load_stmt, 2) != 0;
 
     if (value && valueSize == foundSize) {
-      loadSucceeded = true;
-      if (compressed) {
-#if defined(AURORA_CACHE_USE_ZSTD)
-        const auto compSize = sqlite3_column_bytes(load_stmt, 0);
-        const auto zstdRet = ZSTD_decompress(value, valueSize, foundPtr, compSize);
-        if (ZSTD_isError(zstdRet)) {
-          Log.error("zstd decompression error: {}", ZSTD_getErrorName(zstdRet));
-          foundSize = 0;
-          loadSucceeded = false;
-        } else if (zstdRet != foundSize) {
-          Log.error("zstd decompression size mismatch: expected {}, got {}", foundSize, zstdRet);
-          foundSize = 0;
-          loadSucceeded = false;
-        }
-#else
-        Log.error("Cache entry is zstd-compressed but zstd support is disabled");
+      loadSucceeded = copy_cache_value(value, foundPtr, sqlite3_column_bytes(load_stmt, 0), foundSize, compressed);
+      if (!loadSucceeded) {
         foundSize = 0;
-        loadSucceeded = false;
-#endif
-      } else {
-        if (foundSize != 0 && !foundPtr) {
-          Log.error("Cache entry is missing raw value data");
-          foundSize = 0;
-          loadSucceeded = false;
-        } else if (foundSize != 0) {
-          std::memcpy(value, foundPtr, foundSize);
-        }
       }
     }
   } else if (ret == SQLITE_DONE) {
@@ -292,66 +419,190 @@ size_t load_from_cache(void const* key, size_t keySize, void* value, size_t valu
   return foundSize;
 }
 
-void store_to_cache(void const* key, size_t keySize, void const* value, size_t valueSize, void*) {
-  std::lock_guard lock(cache_mutex);
-
-  if (!cache_init()) {
-    return;
-  }
-
-  sqlite::Transaction tx(db, Log, true);
-  if (!tx) {
-    Log.error("Failed to open store transaction");
-    return;
-  }
-
-  const void* storedValue = value;
-  sqlite3_uint64 storedValueSize = valueSize;
+static bool write_cache_row(const PendingWrite& write) {
+  const auto& value = *write.value;
+  const void* storedValue = value.data();
+  sqlite3_uint64 storedValueSize = value.size();
   int compressed = 0;
 #if defined(AURORA_CACHE_USE_ZSTD)
-  const auto bound = ZSTD_compressBound(valueSize);
+  const auto bound = ZSTD_compressBound(value.size());
   if (ZSTD_isError(bound)) {
     Log.error("Failed to calculate ZSTD_compressBound: {}", ZSTD_getErrorName(bound));
-    return;
+    return false;
   }
 
   if (compress_buffer.size() < bound) {
     compress_buffer.resize(bound);
   }
 
-  const auto compressRet = ZSTD_compress(compress_buffer.data(), compress_buffer.size(), value, valueSize, 0);
+  const auto compressRet =
+      ZSTD_compress(compress_buffer.data(), compress_buffer.size(), value.data(), value.size(), 0);
   if (ZSTD_isError(compressRet)) {
     Log.error("ZSTD compression error: {}", ZSTD_getErrorName(compressRet));
-    return;
+    return false;
   }
 
-  if (compressRet < valueSize) {
+  if (compressRet < value.size()) {
     storedValue = compress_buffer.data();
     storedValueSize = compressRet;
     compressed = 1;
   }
 #endif
 
-  const auto keyHash = XXH128(key, keySize, 0);
-  check(sqlite3_bind_blob64(store_stmt, 1, &keyHash, sizeof(keyHash), SQLITE_TRANSIENT));
-  check(
-      sqlite3_bind_blob64(store_stmt, 2, storedValue, storedValueSize, compressed ? SQLITE_STATIC : SQLITE_TRANSIENT));
-  check(sqlite3_bind_int64(store_stmt, 3, static_cast<sqlite3_int64>(valueSize)));
+  check(sqlite3_bind_blob64(store_stmt, 1, &write.key, sizeof(write.key), SQLITE_TRANSIENT));
+  check(sqlite3_bind_blob64(store_stmt, 2, storedValue, storedValueSize, SQLITE_STATIC));
+  check(sqlite3_bind_int64(store_stmt, 3, static_cast<sqlite3_int64>(value.size())));
   check(sqlite3_bind_int(store_stmt, 4, compressed));
 
   const auto ret = sqlite3_step(store_stmt);
+  check(sqlite3_reset(store_stmt));
+  check(sqlite3_bind_null(store_stmt, 2));
+  check(sqlite3_bind_null(store_stmt, 4));
   if (ret != SQLITE_DONE) {
     // Error or something
     Log.error("Failed to insert row: {}", sqlite3_errmsg(db));
+    return false;
+  }
+  return true;
+}
+
+static void write_cache_batch(const std::deque<PendingWrite>& batch) {
+  ZoneScoped;
+  std::lock_guard lock(cache_mutex);
+
+  if (!cache_init()) {
     return;
   }
 
-  check(sqlite3_reset(store_stmt));
-  check(sqlite3_bind_null(store_stmt, 2));
-  check(sqlite3_bind_null(store_stmt, 4));
+  sqlite::Transaction tx(db, Log, true);
+  if (!tx) {
+    Log.error("Failed to open store transaction");
+    return;
+  }
+
+  std::vector<XXH128_hash_t> keysWritten;
+  keysWritten.reserve(batch.size());
+  for (const auto& write : batch) {
+    if (write_cache_row(write)) {
+      keysWritten.push_back(write.key);
+    }
+  }
+  if (!keysWritten.empty() && !bump_cache_stamp()) {
+    return;
+  }
+  // Rows written or replaced are no longer served from the snapshot, even if the batch is rolled back
+  snapshot_stale_keys.insert(keysWritten.begin(), keysWritten.end());
 
   tx.commit();
-  cache_keys_used.push_back(keyHash);
+  // Still active if the commit failed and the batch is rolled back
+  if (!tx) {
+    cache_keys_used.insert(cache_keys_used.end(), keysWritten.begin(), keysWritten.end());
+  }
+}
+
+static void cache_writer() {
+#ifdef TRACY_ENABLE
+  tracy::SetThreadName("Dawn cache writer thread");
+#endif
+
+  std::unique_lock lock(pending_mutex);
+  while (true) {
+    writer_cv.wait(lock, [] { return writer_stop || !write_queue.empty(); });
+    if (write_queue.empty()) {
+      return;
+    }
+    writer_cv.wait_for(lock, WriteBatchDelay, [] { return writer_stop || flush_requested; });
+
+    std::deque<PendingWrite> batch;
+    batch.swap(write_queue);
+    const uint64_t batchEnd = writes_queued;
+    lock.unlock();
+    write_cache_batch(batch);
+    lock.lock();
+
+    for (const auto& write : batch) {
+      // A later store of the same key stays pending until its own batch is written
+      const auto it = pending_writes.find(write.key);
+      if (it != pending_writes.end() && it->second == write.value) {
+        pending_writes.erase(it);
+      }
+    }
+    writes_done = batchEnd;
+    if (write_queue.empty()) {
+      flush_requested = false;
+    }
+    flushed_cv.notify_all();
+  }
+}
+
+void store_to_cache(void const* key, size_t keySize, void const* value, size_t valueSize, void*) {
+  const auto keyHash = XXH128(key, keySize, 0);
+  const auto* bytes = static_cast<const uint8_t*>(value);
+  auto data = std::make_shared<const std::vector<uint8_t>>(bytes, bytes + valueSize);
+  {
+    std::lock_guard lock(pending_mutex);
+    if (!writer_thread.joinable()) {
+      writer_thread = std::thread(cache_writer);
+    }
+    pending_writes.insert_or_assign(keyHash, data);
+    write_queue.push_back({keyHash, std::move(data)});
+    ++writes_queued;
+  }
+  writer_cv.notify_one();
+}
+
+void cache_flush() {
+  std::unique_lock lock(pending_mutex);
+  const uint64_t target = writes_queued;
+  if (writes_done >= target) {
+    return;
+  }
+  flush_requested = true;
+  writer_cv.notify_one();
+  flushed_cv.wait(lock, [target] { return writes_done >= target; });
+}
+
+// Rebuilds the snapshot from the database unless it was built at the current stamp.
+static void update_snapshot() {
+  ZoneScoped;
+  if (snapshot && snapshot.source_stamp() == cache_stamp) {
+    return;
+  }
+
+  sqlite3_stmt* stmt = nullptr;
+  auto ret = sqlite3_prepare_v3(db, "SELECT key, value, size FROM cache", -1, 0, &stmt, nullptr);
+  if (ret != SQLITE_OK) {
+    Log.error("Failed to prepare dawn cache snapshot query: {}", sqlite3_errmsg(db));
+    return;
+  }
+
+  cache_snapshot::Builder builder{CACHE_SCHEMA, sizeof(XXH128_hash_t), cache_stamp};
+  while ((ret = sqlite3_step(stmt)) == SQLITE_ROW) {
+    const auto* keyPtr = static_cast<const uint8_t*>(sqlite3_column_blob(stmt, 0));
+    const auto* valuePtr = static_cast<const uint8_t*>(sqlite3_column_blob(stmt, 1));
+    const auto valueBytes = static_cast<size_t>(sqlite3_column_bytes(stmt, 1));
+    const auto size = sqlite3_column_int64(stmt, 2);
+    if (keyPtr == nullptr || sqlite3_column_bytes(stmt, 0) != sizeof(XXH128_hash_t) || size < 0 ||
+        size > UINT32_MAX || (valueBytes != 0 && valuePtr == nullptr)) {
+      continue;
+    }
+    builder.add({keyPtr, sizeof(XXH128_hash_t)}, {valuePtr, valueBytes}, static_cast<uint32_t>(size));
+  }
+  sqlite3_finalize(stmt);
+  if (ret != SQLITE_DONE) {
+    Log.error("Failed to read dawn cache rows for snapshot: {}", sqlite3_errmsg(db));
+    return;
+  }
+
+  // Unmap before replacing the file, which fails on Windows while it's mapped
+  snapshot = {};
+  if (!builder.write(snapshot_path())) {
+    Log.warn("Failed to write dawn cache snapshot: {}", SDL_GetError());
+    return;
+  }
+  snapshot = cache_snapshot::Snapshot::open(snapshot_path(), CACHE_SCHEMA, sizeof(XXH128_hash_t));
+  snapshot_stale_keys.clear();
+  Log.debug("Wrote dawn cache snapshot with {} entries", builder.size());
 }
 
 void cache_prune() {
@@ -393,35 +644,57 @@ void cache_prune() {
       return;
     }
     deletedRows = sqlite3_changes64(db);
+    if (deletedRows != 0 && !bump_cache_stamp()) {
+      return;
+    }
 
     tx.commit();
   }
 
   if (deletedRows == 0) {
     Log.debug("Dawn cache prune completed; no stale entries found");
-    return;
-  }
+  } else {
+    Log.info("Pruned {} stale Dawn cache entries", deletedRows);
 
-  Log.info("Pruned {} stale Dawn cache entries", deletedRows);
+    // VACUUM if we removed at least 25% of the rows
+    if (totalRows != 0 && static_cast<uint64_t>(deletedRows) * 100ull >= totalRows * VacuumPrunePercentThreshold) {
+      if (const auto ret = sqlite::exec(db, "VACUUM;"); ret != SQLITE_OK) {
+        Log.warn("Failed to vacuum dawn cache after pruning: {}", sqlite3_errmsg(db));
+      }
+    }
 
-  // VACUUM if we removed at least 25% of the rows
-  if (totalRows != 0 && static_cast<uint64_t>(deletedRows) * 100ull >= totalRows * VacuumPrunePercentThreshold) {
-    if (const auto ret = sqlite::exec(db, "VACUUM;"); ret != SQLITE_OK) {
-      Log.warn("Failed to vacuum dawn cache after pruning: {}", sqlite3_errmsg(db));
-      return;
+    if (const auto ret = sqlite::exec(db, "PRAGMA wal_checkpoint(TRUNCATE);"); ret != SQLITE_OK) {
+      Log.warn("Failed to checkpoint dawn cache WAL: {}", sqlite3_errmsg(db));
     }
   }
 
-  if (const auto ret = sqlite::exec(db, "PRAGMA wal_checkpoint(TRUNCATE);"); ret != SQLITE_OK) {
-    Log.warn("Failed to checkpoint dawn cache WAL: {}", sqlite3_errmsg(db));
-  }
+  update_snapshot();
 }
 
 void cache_shutdown() {
+  // The writer drains the queue before exiting
+  if (writer_thread.joinable()) {
+    {
+      std::lock_guard lock(pending_mutex);
+      writer_stop = true;
+    }
+    writer_cv.notify_one();
+    writer_thread.join();
+  }
+  write_queue.clear();
+  pending_writes.clear();
+  writes_queued = 0;
+  writes_done = 0;
+  flush_requested = false;
+  writer_stop = false;
+
 #if defined(AURORA_CACHE_USE_ZSTD)
   compress_buffer.clear();
 #endif
   cache_keys_used.clear();
+  snapshot = {};
+  snapshot_stale_keys.clear();
+  cache_stamp = 0;
   if (load_stmt != nullptr) {
     check(sqlite3_finalize(load_stmt));
     load_stmt = nullptr;
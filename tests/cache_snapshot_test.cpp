@@ -0,0 +1,108 @@
+#include "cache_snapshot.hpp"
+#include "io.hpp"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <atomic>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace {
+using namespace aurora::cache_snapshot;
+
+constexpr uint32_t Format = 7;
+constexpr uint32_t KeySize = 4;
+
+std::array<uint8_t, KeySize> key(uint8_t a, uint8_t b) { return {a, b, 0, 0}; }
+
+std::vector<uint8_t> bytes(std::span<const uint8_t> data) { return {data.begin(), data.end()}; }
+
+class CacheSnapshotTest : public testing::Test {
+protected:
+  void SetUp() override {
+    static std::atomic_uint64_t counter{0};
+    m_directory = std::filesystem::temp_directory_path() /
+                  ("aurora-cache-snapshot-test-" + std::to_string(counter.fetch_add(1, std::memory_order_relaxed)));
+    ASSERT_TRUE(aurora::io::create_directories(m_directory));
+    m_path = m_directory / "test.snapshot";
+  }
+
+  void TearDown() override {
+    std::error_code error;
+    std::filesystem::remove_all(m_directory, error);
+  }
+
+  std::filesystem::path m_directory;
+  std::filesystem::path m_path;
+};
+
+TEST_F(CacheSnapshotTest, RecordsAreFoundByKey) {
+  Builder builder{Format, KeySize, 42};
+  builder.add(key(2, 0), std::array<uint8_t, 3>{7, 8, 9}, 3);
+  builder.add(key(1, 0), std::array<uint8_t, 1>{5}, 100);
+  builder.add(key(3, 0), {}, 0);
+  ASSERT_TRUE(builder.write(m_path));
+
+  const auto snapshot = Snapshot::open(m_path, Format, KeySize);
+  ASSERT_TRUE(snapshot);
+  EXPECT_EQ(snapshot.size(), 3u);
+  EXPECT_EQ(snapshot.source_stamp(), 42u);
+
+  const auto first = snapshot.find(key(1, 0));
+  ASSERT_TRUE(first.has_value());
+  EXPECT_EQ(bytes(first->value), (std::vector<uint8_t>{5}));
+  EXPECT_EQ(first->rawSize, 100u);
+
+  const auto second = snapshot.find(key(2, 0));
+  ASSERT_TRUE(second.has_value());
+  EXPECT_EQ(bytes(second->value), (std::vector<uint8_t>{7, 8, 9}));
+
+  const auto empty = snapshot.find(key(3, 0));
+  ASSERT_TRUE(empty.has_value());
+  EXPECT_TRUE(empty->value.empty());
+
+  EXPECT_FALSE(snapshot.find(key(4, 0)).has_value());
+}
+
+TEST_F(CacheSnapshotTest, PrefixRangesAreInKeyOrder) {
+  Builder builder{Format, KeySize, 0};
+  for (const auto [a, b] : std::array<std::pair<uint8_t, uint8_t>, 5>{{{2, 9}, {1, 3}, {2, 1}, {3, 0}, {2, 4}}}) {
+    builder.add(key(a, b), std::array<uint8_t, 1>{b}, 1);
+  }
+  ASSERT_TRUE(builder.write(m_path));
+
+  const auto snapshot = Snapshot::open(m_path, Format, KeySize);
+  ASSERT_TRUE(snapshot);
+  const std::array<uint8_t, 1> prefix{2};
+  const auto [begin, end] = snapshot.prefix_range(prefix);
+  ASSERT_EQ(end - begin, 3u);
+  std::vector<uint8_t> seconds;
+  for (size_t i = begin; i < end; ++i) {
+    seconds.push_back(snapshot.at(i)->key[1]);
+  }
+  EXPECT_EQ(seconds, (std::vector<uint8_t>{1, 4, 9}));
+
+  const std::array<uint8_t, 1> missing{4};
+  const auto [missingBegin, missingEnd] = snapshot.prefix_range(missing);
+  EXPECT_EQ(missingBegin, missingEnd);
+}
+
+TEST_F(CacheSnapshotTest, MismatchedOrTruncatedSnapshotsAreRejected) {
+  Builder builder{Format, KeySize, 0};
+  builder.add(key(1, 0), std::array<uint8_t, 4>{1, 2, 3, 4}, 4);
+  ASSERT_TRUE(builder.write(m_path));
+
+  EXPECT_FALSE(Snapshot::open(m_path, Format + 1, KeySize));
+  EXPECT_FALSE(Snapshot::open(m_path, Format, KeySize + 1));
+  EXPECT_FALSE(Snapshot::open(m_directory / "missing.snapshot", Format, KeySize));
+
+  auto data = aurora::io::read_file(m_path);
+  ASSERT_TRUE(data.has_value());
+  data->pop_back();
+  ASSERT_TRUE(aurora::io::write_file(m_path, *data));
+  EXPECT_FALSE(Snapshot::open(m_path, Format, KeySize));
+}
+
+} // namespace
@@ -0,0 +1,200 @@
+#include "card/CardGciFolder.hpp"
+#include "io.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace aurora::card {
+namespace {
+
+constexpr size_t SaveSize = 16384;
+constexpr size_t ChunkSize = 256;
+
+std::vector<uint8_t> pattern(size_t size, uint8_t seed) {
+  std::vector<uint8_t> data(size);
+  for (size_t i = 0; i < size; ++i) {
+    data[i] = static_cast<uint8_t>(seed + i * 7);
+  }
+  return data;
+}
+
+CardGciFolder::IoStats operator-(const CardGciFolder::IoStats& lhs, const CardGciFolder::IoStats& rhs) {
+  return {
+      .opens = lhs.opens - rhs.opens,
+      .reads = lhs.reads - rhs.reads,
+      .writes = lhs.writes - rhs.writes,
+      .replaces = lhs.replaces - rhs.replaces,
+  };
+}
+
+class CardGciFolderTest : public testing::Test {
+protected:
+  void SetUp() override {
+    static std::atomic_uint64_t counter{0};
+    m_directory = std::filesystem::temp_directory_path() /
+                  ("aurora-card-test-" + std::to_string(counter.fetch_add(1, std::memory_order_relaxed)));
+    ASSERT_TRUE(io::create_directories(m_directory)) << SDL_GetError();
+  }
+
+  void TearDown() override {
+    std::error_code error;
+    std::filesystem::remove_all(m_directory, error);
+  }
+
+  void open_card(CardGciFolder& card) const {
+    ASSERT_TRUE(card.open(m_directory));
+    card.InitCard("GAME", "01");
+  }
+
+  // Writes `data` the way CARDWrite does: one seek, write and commit per chunk.
+  static void write_in_chunks(CardGciFolder& card, FileHandle& handle, const std::vector<uint8_t>& data) {
+    for (size_t offset = 0; offset < data.size(); offset += ChunkSize) {
+      card.seek(handle, static_cast<int32_t>(offset), SeekOrigin::Begin);
+      ASSERT_EQ(card.fileWrite(handle, data.data() + offset, ChunkSize), ECardResult::READY);
+      card.commit();
+    }
+  }
+
+  std::vector<uint8_t> saved_payload(const char* name) const {
+    const auto contents = io::read_file(m_directory / (std::string{"01-GAME-"} + name + ".gci"));
+    if (!contents || contents->size() < sizeof(File)) {
+      return {};
+    }
+    return {contents->begin() + sizeof(File), contents->end()};
+  }
+
+  std::filesystem::path m_directory;
+};
+
+TEST_F(CardGciFolderTest, ChunkedSaveReplacesFileOnceOnClose) {
+  CardGciFolder card;
+  open_card(card);
+  FileHandle other;
+  ASSERT_EQ(card.createFile("other", SaveSize, other), ECardResult::READY);
+  ASSERT_EQ(card.closeFile(other), ECardResult::READY);
+
+  const auto before = card.ioStats();
+  FileHandle handle;
+  ASSERT_EQ(card.createFile("save", SaveSize, handle), ECardResult::READY);
+  const auto data = pattern(SaveSize, 1);
+  write_in_chunks(card, handle, data);
+  CardStat stat{};
+  ASSERT_EQ(card.getStatus(handle, stat), ECardResult::READY);
+  stat.x30_iconAddr = 0x40;
+  stat.x38_commentAddr = 0;
+  ASSERT_EQ(card.setStatus(handle, stat), ECardResult::READY);
+  card.commit();
+  ASSERT_EQ(card.closeFile(handle), ECardResult::READY);
+
+  // Previously every chunk reopened the file and every commit rewrote both headers. Now the file is written when
+  // created and replaced once when closed.
+  const auto stats = card.ioStats() - before;
+  EXPECT_EQ(stats.opens, 2u);
+  EXPECT_EQ(stats.reads, 0u);
+  EXPECT_EQ(stats.writes, 3u);
+  EXPECT_EQ(stats.replaces, 2u);
+  EXPECT_EQ(saved_payload("save"), data);
+
+  CardGciFolder reopened;
+  open_card(reopened);
+  FileHandle reopenedHandle;
+  ASSERT_EQ(reopened.openFile("save", reopenedHandle), ECardResult::READY);
+  CardStat reopenedStat{};
+  ASSERT_EQ(reopened.getStatus(reopenedHandle, reopenedStat), ECardResult::READY);
+  EXPECT_EQ(reopenedStat.x30_iconAddr, 0x40u);
+}
+
+TEST_F(CardGciFolderTest, InterruptedSaveKeepsPreviousContents) {
+  CardGciFolder card;
+  open_card(card);
+  FileHandle handle;
+  ASSERT_EQ(card.createFile("save", SaveSize, handle), ECardResult::READY);
+  const auto first = pattern(SaveSize, 1);
+  write_in_chunks(card, handle, first);
+  ASSERT_EQ(card.closeFile(handle), ECardResult::READY);
+
+  ASSERT_EQ(card.openFile("save", handle), ECardResult::READY);
+  const auto second = pattern(SaveSize, 2);
+  write_in_chunks(card, handle, second);
+  // Committed while the save is still open: the file on disk is untouched until it is closed.
+  EXPECT_EQ(saved_payload("save"), first);
+
+  std::vector<uint8_t> readBack(SaveSize);
+  card.seek(handle, 0, SeekOrigin::Begin);
+  ASSERT_EQ(card.fileRead(handle, readBack.data(), readBack.size()), ECardResult::READY);
+  EXPECT_EQ(readBack, second);
+
+  ASSERT_EQ(card.closeFile(handle), ECardResult::READY);
+  EXPECT_EQ(saved_payload("save"), second);
+}
+
+TEST_F(CardGciFolderTest, ReadsReuseOneHandle) {
+  {
+    CardGciFolder card;
+    open_card(card);
+    FileHandle handle;
+    ASSERT_EQ(card.createFile("save", SaveSize, handle), ECardResult::READY);
+    write_in_chunks(card, handle, pattern(SaveSize, 3));
+    ASSERT_EQ(card.closeFile(handle), ECardResult::READY);
+  }
+
+  CardGciFolder card;
+  open_card(card);
+  const auto before = card.ioStats();
+  FileHandle handle;
+  ASSERT_EQ(card.openFile("save", handle), ECardResult::READY);
+  std::vector<uint8_t> data(SaveSize);
+  for (size_t offset = 0; offset < SaveSize; offset += ChunkSize) {
+    card.seek(handle, static_cast<int32_t>(offset), SeekOrigin::Begin);
+    ASSERT_EQ(card.fileRead(handle, data.data() + offset, ChunkSize), ECardResult::READY);
+  }
+  ASSERT_EQ(card.closeFile(handle), ECardResult::READY);
+
+  const auto stats = card.ioStats() - before;
+  EXPECT_EQ(stats.opens, 1u);
+  EXPECT_EQ(stats.reads, SaveSize / ChunkSize);
+  EXPECT_EQ(stats.writes, 0u);
+  EXPECT_EQ(data, pattern(SaveSize, 3));
+}
+
+TEST_F(CardGciFolderTest, CommitOnlyWritesChangedFiles) {
+  {
+    CardGciFolder card;
+    open_card(card);
+    for (const char* name : {"a", "b", "c"}) {
+      FileHandle handle;
+      ASSERT_EQ(card.createFile(name, SaveSize, handle), ECardResult::READY);
+      ASSERT_EQ(card.closeFile(handle), ECardResult::READY);
+    }
+  }
+
+  CardGciFolder card;
+  open_card(card);
+  auto before = card.ioStats();
+  card.commit();
+  auto stats = card.ioStats() - before;
+  EXPECT_EQ(stats.opens, 0u);
+  EXPECT_EQ(stats.writes, 0u);
+
+  FileHandle handle;
+  ASSERT_EQ(card.openFile("b", handle), ECardResult::READY);
+  ASSERT_EQ(card.closeFile(handle), ECardResult::READY);
+  CardStat stat{};
+  ASSERT_EQ(card.getStatus(handle.getFileNo(), stat), ECardResult::READY);
+  stat.x36_iconSpeed = 3;
+  before = card.ioStats();
+  ASSERT_EQ(card.setStatus(handle.getFileNo(), stat), ECardResult::READY);
+  card.commit();
+  card.commit();
+  stats = card.ioStats() - before;
+  EXPECT_EQ(stats.replaces, 1u);
+  EXPECT_EQ(saved_payload("b"), std::vector<uint8_t>(SaveSize));
+}
+
+} // namespace
+} // namespace aurora::card
@@ -0,0 +1,277 @@
+#include "card/CardRawFile.hpp"
+#include "io.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace aurora::card {
+namespace {
+
+constexpr size_t ChunkSize = 256;
+
+std::vector<uint8_t> pattern(size_t size, uint8_t seed) {
+  std::vector<uint8_t> data(size);
+  for (size_t i = 0; i < size; ++i) {
+    data[i] = static_cast<uint8_t>(seed + i * 7);
+  }
+  return data;
+}
+
+// Loses power after `steps` commit write steps: the block write that hits the limit is torn halfway, and every
+// further step fails without writing anything.
+CardRawFile::WriteHook power_loss_after(uint32_t steps) {
+  return [steps, powered = true](CardRawFile::WriteStep step, size_t size,
+                                 const std::function<bool(size_t)>& write) mutable {
+    if (!powered) {
+      return false;
+    }
+    if (steps == 0) {
+      if (step == CardRawFile::WriteStep::Blocks) {
+        write(size / 2);
+      }
+      powered = false;
+      return false;
+    }
+    --steps;
+    return write(size);
+  };
+}
+
+CardRawFile::IoStats operator-(const CardRawFile::IoStats& lhs, const CardRawFile::IoStats& rhs) {
+  return {
+      .reads = lhs.reads - rhs.reads,
+      .writes = lhs.writes - rhs.writes,
+      .journals = lhs.journals - rhs.journals,
+  };
+}
+
+class CardRawFileTest : public testing::Test {
+protected:
+  void SetUp() override {
+    static std::atomic_uint64_t counter{0};
+    m_directory = std::filesystem::temp_directory_path() /
+                  ("aurora-raw-card-test-" + std::to_string(counter.fetch_add(1, std::memory_order_relaxed)));
+    ASSERT_TRUE(io::create_directories(m_directory)) << SDL_GetError();
+    m_path = m_directory / "MemoryCardA.raw";
+    m_journalPath = m_path;
+    m_journalPath += ".journal";
+
+    // The same sequence CARDInit uses to create a missing card.
+    CardRawFile card;
+    EXPECT_FALSE(card.open(m_path));
+    card.format(ECardSlot::SlotA, ECardSize::Card59Mb);
+    card.close();
+  }
+
+  void TearDown() override {
+    std::error_code error;
+    std::filesystem::remove_all(m_directory, error);
+  }
+
+  void open_card(CardRawFile& card) const {
+    ASSERT_TRUE(card.open(m_path));
+    card.setCurrentGame("GAME");
+    card.setCurrentMaker("01");
+    ASSERT_EQ(card.getError(), ECardResult::READY);
+  }
+
+  static void create_file(CardRawFile& card, const char* name, const std::vector<uint8_t>& data) {
+    FileHandle handle;
+    ASSERT_EQ(card.createFile(name, data.size(), handle), ECardResult::READY);
+    ASSERT_EQ(card.fileWrite(handle, data.data(), data.size()), ECardResult::READY);
+  }
+
+  static void write_in_chunks(CardRawFile& card, FileHandle& handle, const std::vector<uint8_t>& data,
+                              size_t chunkSize) {
+    for (size_t offset = 0; offset < data.size(); offset += chunkSize) {
+      const size_t size = std::min(chunkSize, data.size() - offset);
+      card.seek(handle, static_cast<int32_t>(offset), SeekOrigin::Begin);
+      ASSERT_EQ(card.fileWrite(handle, data.data() + offset, size), ECardResult::READY);
+    }
+  }
+
+  static std::vector<uint8_t> read_file(CardRawFile& card, const char* name, size_t size) {
+    FileHandle handle;
+    if (card.openFile(name, handle) != ECardResult::READY) {
+      return {};
+    }
+    std::vector<uint8_t> data(size);
+    if (card.fileRead(handle, data.data(), data.size()) != ECardResult::READY) {
+      return {};
+    }
+    return data;
+  }
+
+  std::filesystem::path m_directory;
+  std::filesystem::path m_path;
+  std::filesystem::path m_journalPath;
+};
+
+TEST_F(CardRawFileTest, ChainedReadsAndWritesAcrossFragmentedBat) {
+  const auto neighbor = pattern(BlockSize, 9);
+  const auto data = pattern(4 * BlockSize, 1);
+  {
+    CardRawFile card;
+    open_card(card);
+    // Fills the card, then frees every other block at the start so the next file wraps around into the holes.
+    for (const char* name : {"a", "b", "c", "d"}) {
+      create_file(card, name, neighbor);
+    }
+    FileHandle filler;
+    ASSERT_EQ(card.createFile("filler", 45 * BlockSize, filler), ECardResult::READY);
+    ASSERT_EQ(card.deleteFile("a"), ECardResult::READY);
+    ASSERT_EQ(card.deleteFile("c"), ECardResult::READY);
+    ASSERT_EQ(card.deleteFile("filler"), ECardResult::READY);
+
+    FileHandle handle;
+    ASSERT_EQ(card.createFile("save", data.size(), handle), ECardResult::READY);
+    // Chunks that straddle every block boundary.
+    write_in_chunks(card, handle, data, 3000);
+    card.commit();
+
+    std::vector<uint8_t> straddling(2 * BlockSize);
+    card.seek(handle, BlockSize / 2, SeekOrigin::Begin);
+    ASSERT_EQ(card.fileRead(handle, straddling.data(), straddling.size()), ECardResult::READY);
+    EXPECT_TRUE(std::equal(straddling.begin(), straddling.end(), data.begin() + BlockSize / 2));
+    EXPECT_EQ(card.fileRead(handle, straddling.data(), 2 * BlockSize), ECardResult::NOFILE);
+  }
+
+  const auto image = io::read_file(m_path);
+  ASSERT_TRUE(image);
+  // "save" took the holes left by "a" (block 5) and "c" (block 7), then continued past "d".
+  EXPECT_TRUE(std::equal(data.begin(), data.begin() + BlockSize, image->begin() + 5 * BlockSize));
+  EXPECT_TRUE(std::equal(data.begin() + BlockSize, data.begin() + 2 * BlockSize, image->begin() + 7 * BlockSize));
+  EXPECT_TRUE(std::equal(neighbor.begin(), neighbor.end(), image->begin() + 6 * BlockSize));
+  EXPECT_TRUE(std::equal(neighbor.begin(), neighbor.end(), image->begin() + 8 * BlockSize));
+
+  CardRawFile card;
+  open_card(card);
+  EXPECT_EQ(read_file(card, "save", data.size()), data);
+  EXPECT_EQ(read_file(card, "b", neighbor.size()), neighbor);
+  EXPECT_EQ(read_file(card, "d", neighbor.size()), neighbor);
+}
+
+TEST_F(CardRawFileTest, CommitCoalescesDirtyBlocks) {
+  CardRawFile card;
+  open_card(card);
+  FileHandle handle;
+  ASSERT_EQ(card.createFile("save", 4 * BlockSize, handle), ECardResult::READY);
+  card.commit();
+
+  auto before = card.ioStats();
+  write_in_chunks(card, handle, pattern(4 * BlockSize, 2), ChunkSize);
+  card.commit();
+  // Previously each chunk was its own write and the commit rewrote all five metadata blocks. Now the four data blocks
+  // go out as one write, and the unchanged directory and BAT are not touched.
+  auto stats = card.ioStats() - before;
+  EXPECT_EQ(stats.reads, 0u);
+  EXPECT_EQ(stats.writes, 1u);
+  EXPECT_EQ(stats.journals, 1u);
+
+  before = card.ioStats();
+  card.commit();
+  stats = card.ioStats() - before;
+  EXPECT_EQ(stats.writes, 0u);
+  EXPECT_EQ(stats.journals, 0u);
+
+  // A metadata change writes only the directory and BAT copies it replaced.
+  CardStat stat{};
+  ASSERT_EQ(card.getStatus(handle, stat), ECardResult::READY);
+  stat.x36_iconSpeed = 3;
+  ASSERT_EQ(card.setStatus(handle, stat), ECardResult::READY);
+  before = card.ioStats();
+  card.commit();
+  stats = card.ioStats() - before;
+  EXPECT_EQ(stats.writes, 2u);
+  EXPECT_FALSE(std::filesystem::exists(m_journalPath));
+}
+
+TEST_F(CardRawFileTest, PowerLossAtEachWriteStepKeepsCardConsistent) {
+  const auto before = pattern(3 * BlockSize, 1);
+  const auto after = pattern(3 * BlockSize, 2);
+  const auto extra = pattern(BlockSize, 3);
+  {
+    CardRawFile card;
+    open_card(card);
+    create_file(card, "save", before);
+  }
+  const auto baseline = io::read_file(m_path);
+  ASSERT_TRUE(baseline);
+
+  const auto apply_changes = [&](CardRawFile& card) {
+    FileHandle handle;
+    ASSERT_EQ(card.openFile("save", handle), ECardResult::READY);
+    write_in_chunks(card, handle, after, ChunkSize);
+    create_file(card, "extra", extra);
+  };
+
+  uint32_t steps = 0;
+  {
+    CardRawFile card;
+    open_card(card);
+    apply_changes(card);
+    const auto start = card.ioStats();
+    card.commit();
+    const auto stats = card.ioStats() - start;
+    // Publishing the journal, one write per run of blocks, and removing the journal.
+    steps = stats.journals + stats.writes + 1;
+    ASSERT_GT(stats.writes, 1u);
+  }
+
+  for (uint32_t step = 0; step <= steps; ++step) {
+    SCOPED_TRACE(step);
+    ASSERT_TRUE(io::write_file(m_path, *baseline));
+    {
+      CardRawFile card;
+      open_card(card);
+      card.setWriteHook(power_loss_after(step));
+      apply_changes(card);
+      card.commit();
+      // The card is dropped without power, so closing it writes nothing either.
+    }
+
+    CardRawFile card;
+    open_card(card);
+    EXPECT_FALSE(std::filesystem::exists(m_journalPath));
+    if (step == 0) {
+      // Lost before the journal was in place: nothing reached the image.
+      EXPECT_EQ(read_file(card, "save", before.size()), before);
+      FileHandle handle;
+      EXPECT_EQ(card.openFile("extra", handle), ECardResult::NOFILE);
+    } else {
+      // The journal completes the commit, including torn data and metadata writes.
+      EXPECT_EQ(read_file(card, "save", after.size()), after);
+      EXPECT_EQ(read_file(card, "extra", extra.size()), extra);
+    }
+  }
+}
+
+TEST_F(CardRawFileTest, IncompleteJournalIsDiscarded) {
+  const auto data = pattern(2 * BlockSize, 4);
+  {
+    CardRawFile card;
+    open_card(card);
+    card.setWriteHook(power_loss_after(1));
+    create_file(card, "save", data);
+    card.commit();
+  }
+  auto journal = io::read_file(m_journalPath);
+  ASSERT_TRUE(journal);
+  journal->resize(journal->size() / 2);
+  ASSERT_TRUE(io::write_file(m_journalPath, *journal));
+
+  CardRawFile card;
+  open_card(card);
+  EXPECT_FALSE(std::filesystem::exists(m_journalPath));
+  FileHandle handle;
+  EXPECT_EQ(card.openFile("save", handle), ECardResult::NOFILE);
+}
+
+} // namespace
+} // namespace aurora::card
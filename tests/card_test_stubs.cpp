@@ -0,0 +1,9 @@
+#include "internal.hpp"
+
+namespace aurora {
+
+AuroraConfig g_config{};
+
+void log_internal(AuroraLogLevel, const char*, const char*, unsigned int) noexcept {}
+
+} // namespace aurora
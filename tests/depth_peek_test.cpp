@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+
+#include "gfx/depth_peek_store.hpp"
+
+#include <array>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace aurora::gfx::depth_peek {
+namespace {
+
+class DepthPeekTest : public ::testing::Test {
+protected:
+  void TearDown() override {
+    clear_latest();
+    set_divisor(1);
+  }
+};
+
+std::vector<uint32_t> ramp(uint32_t width, uint32_t height, uint32_t base = 0) {
+  std::vector<uint32_t> data(static_cast<size_t>(width) * height);
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = base + static_cast<uint32_t>(i);
+  }
+  return data;
+}
+
+TEST_F(DepthPeekTest, NoSnapshotReadsNothing) {
+  uint32_t z = 1;
+  EXPECT_FALSE(read_latest(0, 0, z));
+  std::array<uint32_t, 2> values{1, 1};
+  const std::array<PeekPoint, 2> points{{{0, 0}, {1, 1}}};
+  EXPECT_EQ(read_points(points, values), 0u);
+  EXPECT_EQ(values, (std::array<uint32_t, 2>{0, 0}));
+}
+
+TEST_F(DepthPeekTest, ReadsLatestAndMasksToZ24) {
+  testing::set_latest(2, 2, {0x000001, 0x000002, 0x000003, 0x01000004});
+  uint32_t z = 0;
+  ASSERT_TRUE(read_latest(1, 1, z));
+  EXPECT_EQ(z, 0x000004u);
+  EXPECT_FALSE(read_latest(2, 0, z));
+
+  testing::set_latest(1, 1, {0x000007});
+  ASSERT_TRUE(read_latest(0, 0, z));
+  EXPECT_EQ(z, 0x000007u);
+  EXPECT_FALSE(read_latest(1, 1, z));
+}
+
+TEST_F(DepthPeekTest, BatchedPointsUseOneSnapshot) {
+  testing::set_latest(4, 3, ramp(4, 3, 100));
+  const std::array<PeekPoint, 4> points{{{0, 0}, {3, 2}, {4, 0}, {1, 1}}};
+  std::array<uint32_t, 4> values{};
+  EXPECT_EQ(read_points(points, values), 3u);
+  EXPECT_EQ(values, (std::array<uint32_t, 4>{100, 111, 0, 105}));
+}
+
+TEST_F(DepthPeekTest, RectReadsRowsAndClipsToSnapshot) {
+  testing::set_latest(4, 3, ramp(4, 3));
+  std::vector<uint32_t> values(3 * 2, 0xffffffff);
+  EXPECT_EQ(read_rect(2, 1, 3, 2, values), 4u);
+  const std::vector<uint32_t> expected{6, 7, 0, 10, 11, 0};
+  EXPECT_EQ(values, expected);
+
+  std::vector<uint32_t> small(2);
+  EXPECT_EQ(read_rect(0, 0, 2, 2, small), 0u);
+}
+
+TEST_F(DepthPeekTest, DivisorMapsLogicalCoordinates) {
+  // A 5x3 framebuffer at divisor 2 is a 3x2 snapshot.
+  testing::set_latest(3, 2, ramp(3, 2), 2);
+  uint32_t z = 0;
+  ASSERT_TRUE(read_latest(3, 1, z));
+  EXPECT_EQ(z, 1u);
+  ASSERT_TRUE(read_latest(4, 2, z));
+  EXPECT_EQ(z, 5u);
+  EXPECT_FALSE(read_latest(6, 0, z));
+
+  set_divisor(0);
+  EXPECT_EQ(divisor(), 1u);
+  set_divisor(64);
+  EXPECT_EQ(divisor(), MaxDivisor);
+}
+
+TEST_F(DepthPeekTest, RejectsShortSnapshots) {
+  EXPECT_FALSE(publish_latest(2, 2, 1, std::vector<uint32_t>(3)));
+  EXPECT_FALSE(publish_latest(0, 2, 1, {}));
+}
+
+TEST_F(DepthPeekTest, ConcurrentReadersSeeWholeSnapshots) {
+  // Every snapshot is filled with its generation, so a torn read would mix values within one batch.
+  constexpr uint32_t Width = 64;
+  constexpr uint32_t Height = 64;
+  constexpr uint32_t Generations = 2000;
+  std::atomic_bool done{false};
+  std::atomic_uint32_t torn{0};
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 4; ++i) {
+    readers.emplace_back([&] {
+      std::vector<uint32_t> values(Width * Height);
+      while (!done.load(std::memory_order_relaxed)) {
+        if (read_rect(0, 0, Width, Height, values) == 0) {
+          continue;
+        }
+        for (const uint32_t value : values) {
+          if (value != values[0]) {
+            torn.fetch_add(1, std::memory_order_relaxed);
+            break;
+          }
+        }
+      }
+    });
+  }
+
+  uint32_t published = 0;
+  for (uint32_t generation = 1; generation <= Generations; ++generation) {
+    if (publish_latest(Width, Height, 1, std::vector<uint32_t>(Width * Height, generation))) {
+      ++published;
+    }
+  }
+  done = true;
+  for (auto& reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(torn.load(), 0u);
+  EXPECT_GT(published, 0u);
+}
+
+} // namespace
+} // namespace aurora::gfx::depth_peek
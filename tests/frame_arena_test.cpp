@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+
+#include "gfx/frame_arena.hpp"
+
+#include <cstdint>
+#include <string_view>
+
+namespace aurora::gfx::detail {
+namespace {
+
+struct Tracked {
+  int* destroyed;
+  int value;
+  ~Tracked() { ++*destroyed; }
+};
+
+TEST(FrameArena, AllocationsAreAligned) {
+  FrameArena arena;
+  for (size_t alignment : {1u, 2u, 4u, 8u, 16u, 64u}) {
+    void* ptr = arena.allocate(3, alignment);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % alignment, 0u) << "alignment " << alignment;
+  }
+}
+
+TEST(FrameArena, ResetRewindsWithoutReallocating) {
+  FrameArena arena;
+  void* first = arena.allocate(64, 16);
+  for (int i = 0; i < 10000; ++i) {
+    (void)arena.allocate(128, 16);
+  }
+  const size_t blocks = arena.block_count();
+  ASSERT_GT(blocks, 1u);
+
+  arena.reset();
+  EXPECT_EQ(arena.allocate(64, 16), first);
+  for (int i = 0; i < 10000; ++i) {
+    (void)arena.allocate(128, 16);
+  }
+  EXPECT_EQ(arena.block_count(), blocks);
+}
+
+TEST(FrameArena, OversizedAllocationGetsDedicatedBlock) {
+  FrameArena arena;
+  auto* ptr = static_cast<uint8_t*>(arena.allocate(FrameArena::BlockSize * 3, 16));
+  ASSERT_NE(ptr, nullptr);
+  ptr[FrameArena::BlockSize * 3 - 1] = 0xFF;
+  EXPECT_GE(arena.capacity(), FrameArena::BlockSize * 3);
+}
+
+TEST(FrameArena, ResetRunsDestructors) {
+  FrameArena arena;
+  int destroyed = 0;
+  arena.make<Tracked>(&destroyed, 1);
+  arena.make<Tracked>(&destroyed, 2);
+  EXPECT_EQ(destroyed, 0);
+  arena.reset();
+  EXPECT_EQ(destroyed, 2);
+  arena.reset();
+  EXPECT_EQ(destroyed, 2);
+}
+
+TEST(FrameArena, CopyStringIsNullTerminated) {
+  FrameArena arena;
+  constexpr std::string_view label = "EFB copy";
+  const char* copy = arena.copy_string(label);
+  EXPECT_EQ(std::string_view{copy}, label);
+  EXPECT_NE(copy, label.data());
+}
+
+TEST(FrameList, IndexesAcrossChunksWithStableAddresses) {
+  FrameArena arena;
+  FrameList<uint32_t> list;
+  constexpr uint32_t Count = FrameList<uint32_t>::ChunkSize * 40 + 3;
+  const uint32_t* first = &list.emplace_back(arena, 0u);
+  for (uint32_t i = 1; i < Count; ++i) {
+    list.emplace_back(arena, i);
+  }
+  ASSERT_EQ(list.size(), Count);
+  EXPECT_EQ(&list[0], first);
+  for (uint32_t i = 0; i < Count; ++i) {
+    ASSERT_EQ(list[i], i);
+  }
+}
+
+TEST(FrameList, NonTrivialElementsDestroyedOnReset) {
+  FrameArena arena;
+  int destroyed = 0;
+  {
+    FrameList<Tracked> list;
+    for (int i = 0; i < 100; ++i) {
+      list.emplace_back(arena, &destroyed, i);
+    }
+    EXPECT_EQ(list[99].value, 99);
+  }
+  EXPECT_EQ(destroyed, 0);
+  arena.reset();
+  EXPECT_EQ(destroyed, 100);
+}
+
+} // namespace
+} // namespace aurora::gfx::detail
@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+
+#include "gfx/frame_pacing.hpp"
+
+#include <cstdint>
+
+namespace aurora::gfx::detail {
+namespace {
+
+constexpr int64_t Ms = 1'000'000;
+constexpr int64_t PresentPeriodNs = 16 * Ms;
+
+int64_t s_nowNs = 0;
+int64_t s_waitedNs = 0;
+
+int64_t fake_now() noexcept { return s_nowNs; }
+
+void fake_wait(int64_t durationNs) {
+  s_nowNs += durationNs;
+  s_waitedNs += durationNs;
+}
+
+class FramePacingTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    s_nowNs = 1'000 * Ms;
+    s_waitedNs = 0;
+  }
+
+  // Presents two frames one period apart and leaves the clock at the last present.
+  void establish_present_period() {
+    pacer.record_present(0);
+    s_nowNs += PresentPeriodNs;
+    pacer.record_present(0);
+  }
+
+  void record_cpu_frames(int64_t durationNs, size_t count = FramePacer::CpuSampleCount) {
+    for (size_t i = 0; i < count; ++i) {
+      pacer.record_cpu_frame(durationNs);
+    }
+  }
+
+  FramePacer pacer{fake_now, fake_wait};
+};
+
+TEST_F(FramePacingTest, OffNeverWaits) {
+  establish_present_period();
+  record_cpu_frames(4 * Ms);
+
+  EXPECT_EQ(pacer.pace(true), 0);
+  EXPECT_EQ(s_waitedNs, 0);
+}
+
+TEST_F(FramePacingTest, LowLatencyStartsAheadOfNextPresent) {
+  pacer.set_mode(FRAME_PACING_LOW_LATENCY);
+  establish_present_period();
+  record_cpu_frames(4 * Ms);
+  const int64_t lastPresentNs = s_nowNs;
+  s_nowNs += 1 * Ms;
+
+  const int64_t expectedStartNs = lastPresentNs + PresentPeriodNs - 4 * Ms - FramePacer::SafetyMarginNs;
+  EXPECT_EQ(pacer.target_start(), expectedStartNs);
+  EXPECT_EQ(pacer.pace(true), expectedStartNs - (lastPresentNs + 1 * Ms));
+  EXPECT_EQ(s_nowNs, expectedStartNs);
+  EXPECT_EQ(pacer.last_wait(), s_waitedNs);
+}
+
+TEST_F(FramePacingTest, DoesNotWaitWithoutFramesInFlight) {
+  pacer.set_mode(FRAME_PACING_LOW_LATENCY);
+  establish_present_period();
+  record_cpu_frames(4 * Ms);
+
+  EXPECT_EQ(pacer.pace(false), 0);
+  EXPECT_EQ(s_waitedNs, 0);
+}
+
+TEST_F(FramePacingTest, CpuEstimateIgnoresSingleFastSample) {
+  pacer.set_mode(FRAME_PACING_LOW_LATENCY);
+  establish_present_period();
+  record_cpu_frames(6 * Ms, FramePacer::CpuSampleCount - 1);
+  pacer.record_cpu_frame(1 * Ms);
+
+  EXPECT_EQ(pacer.cpu_frame_time(90), 6 * Ms);
+  EXPECT_EQ(pacer.cpu_frame_time(0), 1 * Ms);
+  EXPECT_EQ(pacer.target_start(), s_nowNs + PresentPeriodNs - 6 * Ms - FramePacer::SafetyMarginNs);
+}
+
+TEST_F(FramePacingTest, AdaptiveSkipsPacingWhenJitterLeavesNoHeadroom) {
+  establish_present_period();
+  for (size_t i = 0; i < FramePacer::CpuSampleCount; ++i) {
+    pacer.record_cpu_frame(i % 2 == 0 ? 8 * Ms : 12 * Ms);
+  }
+
+  pacer.set_mode(FRAME_PACING_LOW_LATENCY);
+  EXPECT_NE(pacer.target_start(), 0);
+  pacer.set_mode(FRAME_PACING_ADAPTIVE);
+  EXPECT_EQ(pacer.target_start(), 0);
+  EXPECT_EQ(pacer.pace(true), 0);
+}
+
+TEST_F(FramePacingTest, AdaptiveBacksOffAfterMissedPresent) {
+  pacer.set_mode(FRAME_PACING_ADAPTIVE);
+  establish_present_period();
+  record_cpu_frames(4 * Ms);
+  ASSERT_GT(pacer.pace(true), 0);
+
+  s_nowNs += 3 * PresentPeriodNs;
+  pacer.record_present(0);
+  for (uint32_t i = 0; i < FramePacer::MissBackoffFrames; ++i) {
+    ASSERT_EQ(pacer.pace(true), 0) << "frame " << i;
+  }
+  EXPECT_GT(pacer.pace(true), 0);
+}
+
+TEST_F(FramePacingTest, NeverWaitsLongerThanOnePeriod) {
+  pacer.set_mode(FRAME_PACING_LOW_LATENCY);
+  establish_present_period();
+  record_cpu_frames(4 * Ms);
+  s_nowNs -= 10 * PresentPeriodNs;
+
+  EXPECT_LE(pacer.pace(true), PresentPeriodNs);
+}
+
+TEST_F(FramePacingTest, LatencyMeasuresFrameStartToPresent) {
+  const int64_t frameStartNs = s_nowNs;
+  s_nowNs += 20 * Ms;
+  pacer.record_present(frameStartNs);
+  EXPECT_EQ(pacer.estimated_latency(), 20 * Ms);
+
+  pacer.reset();
+  EXPECT_EQ(pacer.estimated_latency(), 0);
+  EXPECT_EQ(pacer.present_period(), 0);
+}
+
+} // namespace
+} // namespace aurora::gfx::detail
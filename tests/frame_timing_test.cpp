@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+
+#include "gfx/frame_timing.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace aurora::gfx::frame_timing {
+namespace {
+
+class FrameTimingTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    set_enabled(true);
+    reset();
+  }
+  void TearDown() override {
+    set_enabled(true);
+    reset();
+  }
+
+  static void complete_frame(uint64_t frameId) { end_worker_frame(end_cpu_frame(frameId, 0)); }
+
+  static std::vector<AuroraFrameTiming> history() {
+    std::vector<AuroraFrameTiming> frames(HistorySize);
+    frames.resize(copy_history(frames));
+    return frames;
+  }
+};
+
+TEST_F(FrameTimingTest, PhasesCloseOnTheirOwnSide) {
+  add(Phase::FifoProcess, 3'000);
+  add(Phase::FifoProcess, 2'000);
+  add(Phase::Present, 7'000);
+  auto record = end_cpu_frame(1, 16'000'000);
+  EXPECT_EQ(record.frameId, 1u);
+  EXPECT_EQ(record.cpuFrameUs, 16'000u);
+  EXPECT_EQ(record.phaseUs[AURORA_FRAME_PHASE_FIFO], 5u);
+  EXPECT_EQ(record.phaseCalls[AURORA_FRAME_PHASE_FIFO], 2u);
+  EXPECT_EQ(record.phaseCalls[AURORA_FRAME_PHASE_PRESENT], 0u);
+
+  // Work recorded for the next frame before the worker finishes this one stays with the next frame.
+  add(Phase::DrawBuild, 1'000);
+  end_worker_frame(record);
+  const auto frames = history();
+  ASSERT_EQ(frames.size(), 1u);
+  EXPECT_EQ(frames[0].phaseUs[AURORA_FRAME_PHASE_PRESENT], 7u);
+  EXPECT_EQ(frames[0].phaseCalls[AURORA_FRAME_PHASE_PRESENT], 1u);
+  EXPECT_EQ(frames[0].phaseCalls[AURORA_FRAME_PHASE_DRAW_BUILD], 0u);
+  EXPECT_EQ(end_cpu_frame(2, 0).phaseCalls[AURORA_FRAME_PHASE_DRAW_BUILD], 1u);
+}
+
+TEST_F(FrameTimingTest, HistoryKeepsMostRecentFramesOldestFirst) {
+  for (uint64_t i = 1; i <= HistorySize + 10; ++i) {
+    complete_frame(i);
+  }
+  const auto frames = history();
+  ASSERT_EQ(frames.size(), HistorySize);
+  EXPECT_EQ(frames.front().frameId, 11u);
+  EXPECT_EQ(frames.back().frameId, HistorySize + 10);
+
+  std::array<AuroraFrameTiming, 3> latest{};
+  ASSERT_EQ(copy_history(latest), latest.size());
+  EXPECT_EQ(latest[0].frameId, HistorySize + 8);
+  EXPECT_EQ(latest[2].frameId, HistorySize + 10);
+}
+
+TEST_F(FrameTimingTest, DisabledTimersRecordNothing) {
+  set_enabled(false);
+  {
+    ScopedTimer timer{Phase::Encode};
+  }
+  complete_frame(1);
+  EXPECT_TRUE(history().empty());
+  EXPECT_EQ(end_cpu_frame(2, 0).phaseCalls[AURORA_FRAME_PHASE_ENCODE], 0u);
+}
+
+TEST_F(FrameTimingTest, FormatsJsonAndCsv) {
+  add(Phase::PipelineLookup, 4'000);
+  complete_frame(7);
+  const auto frames = history();
+
+  const auto json = format_json(frames);
+  EXPECT_NE(json.find("\"frameId\":7"), std::string::npos);
+  EXPECT_NE(json.find("\"pipeline_lookup\":{\"us\":4,\"calls\":1}"), std::string::npos);
+
+  const auto csv = format_csv(frames);
+  EXPECT_EQ(csv.substr(0, csv.find('\n')),
+            "frame_id,cpu_frame_us,fifo_us,fifo_calls,draw_build_us,draw_build_calls,texture_convert_us,"
+            "texture_convert_calls,pipeline_lookup_us,pipeline_lookup_calls,encode_us,encode_calls,submit_us,"
+            "submit_calls,present_us,present_calls");
+  EXPECT_NE(csv.find("\n7,0,0,0,0,0,0,0,4,1,0,0,0,0,0,0\n"), std::string::npos);
+}
+
+// The per-scope cost is measured by aurora_bench.
+TEST_F(FrameTimingTest, ScopedTimersCountEveryScope) {
+  constexpr int Iterations = 1000;
+  for (int i = 0; i < Iterations; ++i) {
+    ScopedTimer timer{Phase::DrawBuild};
+  }
+  EXPECT_EQ(end_cpu_frame(1, 0).phaseCalls[AURORA_FRAME_PHASE_DRAW_BUILD], static_cast<uint32_t>(Iterations));
+}
+
+} // namespace
+} // namespace aurora::gfx::frame_timing
@@ -3,10 +3,15 @@
 #include "gfx/frame_packet.hpp"
 #include "gfx/recording.hpp"
 #include "gfx/texture.hpp"
+#include "gx/pipeline.hpp"
 #include "webgpu/gpu.hpp"
 
 #include <algorithm>
+#include <array>
+#include <cstring>
+#include <iterator>
 #include <memory>
+#include <vector>
 
 namespace aurora::gfx {
 namespace {
@@ -40,7 +45,7 @@ protected:
   }
 
   void seed(uint32_t width, uint32_t height) {
-    detail::testing::seed_offscreen_cache(width, height, ColorFormat, DepthFormat);
+    detail::testing::seed_offscreen_target(width, height, ColorFormat, DepthFormat);
   }
 
   void copy_current_offscreen() {
@@ -52,11 +57,73 @@ protected:
                       false, false, false, {}, 1.f);
   }
 
+  // Ends the current frame and starts the next one, returning the ended frame's stats.
+  AuroraStats next_frame() {
+    finish();
+    detail::end_recording();
+    const auto stats = frame.stats;
+    frame = {};
+    detail::begin_recording(frame, 0);
+    return stats;
+  }
+
+  std::vector<const detail::RenderPass*> offscreen_passes() const {
+    std::vector<const detail::RenderPass*> passes;
+    for (const auto& pass : frame.renderPasses) {
+      if (pass.label.starts_with("Offscreen")) {
+        passes.push_back(&pass);
+      }
+    }
+    return passes;
+  }
+
   size_t count_efb_passes() const {
     return static_cast<size_t>(
         std::ranges::count_if(frame.renderPasses, [](const auto& pass) { return pass.label.starts_with("EFB"); }));
   }
 
+  static gx::DrawData gx_draw(PipelineRef pipeline, BindGroupRef textures, uint32_t vertOffset,
+                              bool orderIndependent = true) {
+    gx::DrawData data{};
+    data.pipeline = pipeline;
+    data.bindGroups.textureBindGroup = textures;
+    data.vertRange = {vertOffset, 16};
+    data.dstAlpha = UINT32_MAX;
+    data.orderIndependent = orderIndependent;
+    return data;
+  }
+
+  // Records a fixed sequence of draws, seals the EFB pass and returns the encoded vertex offsets in order.
+  std::vector<uint32_t> record_and_seal() {
+    push_draw_command(gx_draw(2, 20, 0));
+    push_draw_command(gx_draw(1, 10, 1));
+    push_draw_command(gx_draw(2, 10, 2));
+    push_draw_command(gx_draw(1, 20, 3));
+    push_draw_command(gx_draw(1, 10, 4, false));
+    push_draw_command(gx_draw(2, 10, 5));
+    push_draw_command(gx_draw(1, 10, 6));
+    set_viewport({0.f, 0.f, 320.f, 240.f, 0.f, 1.f});
+    push_draw_command(gx_draw(2, 10, 7));
+    push_draw_command(gx_draw(1, 10, 8));
+    return seal();
+  }
+
+  // Seals the EFB pass and returns the encoded vertex offsets in order.
+  std::vector<uint32_t> seal() {
+    finish();
+
+    std::vector<uint32_t> offsets;
+    for (auto& cmd : frame.renderPasses[0].commands) {
+      if (cmd.type == detail::CommandType::Draw) {
+        auto& draw = cmd.as<detail::DrawCommand>();
+        offsets.push_back(reinterpret_cast<const gx::DrawData*>(draw.payload())->vertRange.offset);
+      }
+    }
+    detail::end_recording();
+    recordingActive = false;
+    return offsets;
+  }
+
   detail::FramePacket frame;
   bool recordingActive = true;
 };
@@ -166,5 +233,217 @@ TEST_F(GfxRecordingTest, FinalizedPassesAreSealedOrDeliberatelyDiscarded) {
   recordingActive = false;
 }
 
+TEST_F(GfxRecordingTest, OffscreenSessionsInOneFrameShareATarget) {
+  seed(320, 180);
+  begin_offscreen(320, 180);
+  copy_current_offscreen();
+  begin_offscreen(300, 170);
+  end_offscreen();
+
+  const auto passes = offscreen_passes();
+  ASSERT_EQ(passes.size(), 3u);
+  for (const auto* pass : passes) {
+    EXPECT_EQ(pass->copySourceSize.width, 320u);
+    EXPECT_EQ(pass->copySourceSize.height, 180u);
+  }
+  EXPECT_EQ(passes[2]->colorAttachments[SceneColorAttachmentIndex].size.width, 300u);
+  EXPECT_EQ(passes[2]->colorAttachments[SceneColorAttachmentIndex].size.height, 170u);
+  EXPECT_EQ(next_frame().residentOffscreenTargetSize, 320u * 180u * 8u);
+}
+
+TEST_F(GfxRecordingTest, OffscreenSessionTakesSmallestFittingTarget) {
+  seed(640, 480);
+  seed(320, 240);
+  seed(160, 96);
+  begin_offscreen(150, 90);
+
+  EXPECT_EQ(frame.renderPasses.back().copySourceSize.width, 160u);
+  EXPECT_EQ(frame.renderPasses.back().copySourceSize.height, 96u);
+  EXPECT_EQ(frame.renderPasses.back().colorAttachments[SceneColorAttachmentIndex].size.width, 150u);
+  end_offscreen();
+}
+
+TEST_F(GfxRecordingTest, CopySourceSizeDrivesResolveUvTransform) {
+  seed(320, 192);
+  begin_offscreen(300, 180);
+  copy_current_offscreen();
+  end_offscreen();
+
+  const auto& pass = *offscreen_passes().front();
+  ASSERT_TRUE(pass.resolveTarget);
+  ASSERT_EQ(pass.resolveUniformRange.size, sizeof(float) * 4);
+  std::array<float, 4> uv{};
+  std::memcpy(uv.data(), frame.uniforms.data() + pass.resolveUniformRange.offset, sizeof(uv));
+  EXPECT_FLOAT_EQ(uv[2], 300.f / 320.f);
+  EXPECT_FLOAT_EQ(uv[3], 180.f / 192.f);
+}
+
+TEST_F(GfxRecordingTest, IdleOffscreenTargetsAreEvicted) {
+  seed(320, 180);
+  begin_offscreen(320, 180);
+  end_offscreen();
+  constexpr uint32_t TargetSize = 320u * 180u * 8u;
+
+  AuroraStats stats{};
+  for (int i = 0; i < 121; ++i) {
+    stats = next_frame();
+    EXPECT_EQ(stats.residentOffscreenTargetSize, TargetSize) << "frame " << i;
+  }
+  stats = next_frame();
+  EXPECT_EQ(stats.residentOffscreenTargetSize, 0u);
+  EXPECT_EQ(stats.peakOffscreenTargetSize, TargetSize);
+}
+
+TEST_F(GfxRecordingTest, CommandsAreRecordedInOrder) {
+  const Viewport viewport{10.f, 20.f, 300.f, 200.f, 0.f, 1.f};
+  set_viewport(viewport);
+  const ClipRect scissor{1, 2, 3, 4};
+  set_scissor(scissor);
+
+  const auto& commands = frame.renderPasses[0].commands;
+  ASSERT_EQ(commands.size(), 4u);
+  std::vector<detail::CommandType> types;
+  for (const auto& cmd : commands) {
+    types.push_back(cmd.type);
+  }
+  EXPECT_EQ(types, (std::vector{detail::CommandType::SetViewport, detail::CommandType::SetScissor,
+                                detail::CommandType::SetViewport, detail::CommandType::SetScissor}));
+  EXPECT_EQ(commands.back()->as<ClipRect>(), scissor);
+  auto it = commands.begin();
+  std::advance(it, 2);
+  EXPECT_FALSE(it->as<Viewport>() != viewport);
+}
+
+TEST_F(GfxRecordingTest, OpsReferenceTextureUploadsByWatermark) {
+  const auto queue_upload = [] {
+    queue_texture_upload(TextureUpload{wgpu::TexelCopyBufferLayout{}, wgpu::TexelCopyTextureInfo{}, {1, 1, 1}});
+  };
+  queue_upload();
+  queue_upload();
+  copy_current_offscreen();
+  queue_upload();
+  finish();
+
+  ASSERT_EQ(frame.ops.size(), 2u);
+  EXPECT_EQ(frame.ops[0].highWater.textureUploadCount, 2u);
+  EXPECT_EQ(frame.ops[1].highWater.textureUploadCount, 3u);
+  EXPECT_EQ(frame.textureUploads.size(), 3u);
+  detail::end_recording();
+  recordingActive = false;
+}
+
+TEST_F(GfxRecordingTest, BufferUploadsShareTextureUploadStaging) {
+  const std::array<uint8_t, 6> data{1, 2, 3, 4, 5, 6};
+  queue_buffer_upload_data(data.data(), data.size(), wgpu::Buffer{}, 64);
+  copy_current_offscreen();
+  queue_texture_upload(TextureUpload{wgpu::TexelCopyBufferLayout{}, wgpu::TexelCopyTextureInfo{}, {1, 1, 1}});
+  queue_buffer_upload_data(data.data(), 4, wgpu::Buffer{}, 0);
+  finish();
+
+  ASSERT_EQ(frame.ops.size(), 2u);
+  EXPECT_EQ(frame.ops[0].highWater.bufferUploadCount, 1u);
+  EXPECT_EQ(frame.ops[1].highWater.bufferUploadCount, 2u);
+  ASSERT_EQ(frame.bufferUploads.size(), 2u);
+  const auto& first = frame.bufferUploads[0];
+  EXPECT_EQ(first.srcOffset, 0u);
+  EXPECT_EQ(first.dstOffset, 64u);
+  EXPECT_EQ(first.size, 8u);
+  EXPECT_EQ(std::memcmp(frame.textureUpload.data(), data.data(), data.size()), 0);
+  // Later uploads in the shared ring stay aligned for texture copies.
+  EXPECT_EQ(frame.bufferUploads[1].srcOffset, 256u);
+  detail::end_recording();
+  recordingActive = false;
+}
+
+TEST_F(GfxRecordingTest, DrawsKeepRecordedOrderWithoutReordering) {
+  set_draw_reordering(false);
+  EXPECT_EQ(record_and_seal(), (std::vector<uint32_t>{0, 1, 2, 3, 4, 5, 6, 7, 8}));
+}
+
+TEST_F(GfxRecordingTest, ReorderingSortsOrderIndependentRunsByState) {
+  set_draw_reordering(true);
+  const auto offsets = record_and_seal();
+  set_draw_reordering(false);
+  // The draw that is not order independent and the viewport change split the pass into three runs, each sorted by
+  // pipeline, then texture bind group, then vertex offset.
+  EXPECT_EQ(offsets, (std::vector<uint32_t>{1, 3, 2, 0, 4, 6, 5, 8, 7}));
+  std::vector<detail::CommandType> types;
+  for (const auto& cmd : frame.renderPasses[0].commands) {
+    types.push_back(cmd.type);
+  }
+  EXPECT_EQ(types[types.size() - 3], detail::CommandType::SetViewport);
+  EXPECT_EQ(frame.renderPasses[0].commands.back()->type, detail::CommandType::Draw);
+}
+
+TEST(GXDrawOrder, OnlyOpaqueDepthWritingConfigsAreOrderIndependent) {
+  gx::PipelineConfig config{};
+  config.blendMode = GX_BM_NONE;
+  config.dstAlpha = UINT32_MAX;
+  config.depthCompare = true;
+  config.depthUpdate = true;
+  config.depthFunc = GX_LEQUAL;
+  config.colorUpdate = true;
+  config.alphaUpdate = true;
+  EXPECT_TRUE(gx::is_order_independent(config));
+
+  auto blended = config;
+  blended.blendMode = GX_BM_BLEND;
+  EXPECT_FALSE(gx::is_order_independent(blended));
+  auto logicOp = config;
+  logicOp.blendMode = GX_BM_LOGIC;
+  EXPECT_FALSE(gx::is_order_independent(logicOp));
+  auto dstAlpha = config;
+  dstAlpha.dstAlpha = 0x80;
+  EXPECT_FALSE(gx::is_order_independent(dstAlpha));
+  auto noDepthWrite = config;
+  noDepthWrite.depthUpdate = false;
+  EXPECT_FALSE(gx::is_order_independent(noDepthWrite));
+  auto always = config;
+  always.depthFunc = GX_ALWAYS;
+  EXPECT_FALSE(gx::is_order_independent(always));
+  auto equal = config;
+  equal.depthFunc = GX_EQUAL;
+  EXPECT_FALSE(gx::is_order_independent(equal));
+}
+
+TEST(GXDrawOrder, MaskedColorWritesAreNotOrderIndependent) {
+  gx::PipelineConfig config{};
+  config.blendMode = GX_BM_NONE;
+  config.dstAlpha = UINT32_MAX;
+  config.depthCompare = true;
+  config.depthUpdate = true;
+  config.depthFunc = GX_LEQUAL;
+
+  // A nearer depth-only draw hides later draws behind it without replacing the color already there
+  auto depthOnly = config;
+  EXPECT_FALSE(gx::is_order_independent(depthOnly));
+  auto colorOnly = config;
+  colorOnly.colorUpdate = true;
+  EXPECT_FALSE(gx::is_order_independent(colorOnly));
+  auto alphaOnly = config;
+  alphaOnly.alphaUpdate = true;
+  EXPECT_FALSE(gx::is_order_independent(alphaOnly));
+}
+
+TEST_F(GfxRecordingTest, MaskedDrawsKeepTheirOrderWhenReordering) {
+  gx::PipelineConfig config{};
+  config.blendMode = GX_BM_NONE;
+  config.dstAlpha = UINT32_MAX;
+  config.depthCompare = true;
+  config.depthUpdate = true;
+  config.depthFunc = GX_LEQUAL;
+  auto colorOnly = config;
+  colorOnly.colorUpdate = true;
+
+  set_draw_reordering(true);
+  push_draw_command(gx_draw(2, 20, 0, gx::is_order_independent(config)));
+  push_draw_command(gx_draw(1, 10, 1, gx::is_order_independent(colorOnly)));
+  push_draw_command(gx_draw(2, 10, 2, gx::is_order_independent(config)));
+  push_draw_command(gx_draw(1, 20, 3, gx::is_order_independent(colorOnly)));
+  const auto offsets = seal();
+  set_draw_reordering(false);
+  EXPECT_EQ(offsets, (std::vector<uint32_t>{0, 1, 2, 3}));
+}
+
 } // namespace
 } // namespace aurora::gfx
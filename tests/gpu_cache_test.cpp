@@ -0,0 +1,130 @@
+#include "internal.hpp"
+#include "io.hpp"
+#include "webgpu/gpu.hpp"
+
+#include <gtest/gtest.h>
+#include <sqlite3.h>
+
+#include <atomic>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+using namespace aurora::webgpu;
+
+class GpuCacheTest : public testing::Test {
+protected:
+  void SetUp() override {
+    static std::atomic_uint64_t counter{0};
+    m_directory = std::filesystem::temp_directory_path() /
+                  ("aurora-gpu-cache-test-" + std::to_string(counter.fetch_add(1, std::memory_order_relaxed)));
+    ASSERT_TRUE(aurora::io::create_directories(m_directory));
+    m_cachePath = aurora::io::fs_path_to_string(m_directory);
+    aurora::g_config.cachePath = m_cachePath.c_str();
+  }
+
+  void TearDown() override {
+    cache_shutdown();
+    aurora::g_config.cachePath = nullptr;
+    std::error_code error;
+    std::filesystem::remove_all(m_directory, error);
+  }
+
+  static void store(std::string_view key, const std::vector<uint8_t>& value) {
+    store_to_cache(key.data(), key.size(), value.data(), value.size(), nullptr);
+  }
+
+  static std::vector<uint8_t> load(std::string_view key) {
+    const size_t size = load_from_cache(key.data(), key.size(), nullptr, 0, nullptr);
+    std::vector<uint8_t> value(size);
+    if (size != 0) {
+      EXPECT_EQ(load_from_cache(key.data(), key.size(), value.data(), value.size(), nullptr), size);
+    }
+    return value;
+  }
+
+  std::filesystem::path m_directory;
+  std::string m_cachePath;
+};
+
+TEST_F(GpuCacheTest, StoredValuesAreVisibleBeforeTheyAreWritten) {
+  const std::vector<uint8_t> value(4096, 0x5A);
+  store("pipeline", value);
+  EXPECT_EQ(load("pipeline"), value);
+  EXPECT_TRUE(load("missing").empty());
+}
+
+TEST_F(GpuCacheTest, LaterStoresOfAKeyReplaceEarlierOnes) {
+  store("pipeline", {1, 2, 3});
+  store("pipeline", {4, 5});
+  EXPECT_EQ(load("pipeline"), (std::vector<uint8_t>{4, 5}));
+  cache_flush();
+  EXPECT_EQ(load("pipeline"), (std::vector<uint8_t>{4, 5}));
+}
+
+TEST_F(GpuCacheTest, ShutdownFlushesPendingWrites) {
+  std::vector<std::vector<uint8_t>> values;
+  for (uint8_t i = 0; i < 32; ++i) {
+    values.emplace_back(256 + i, i);
+    store("blob" + std::to_string(i), values.back());
+  }
+  cache_shutdown();
+
+  // Reopens the database from disk
+  for (uint8_t i = 0; i < values.size(); ++i) {
+    EXPECT_EQ(load("blob" + std::to_string(i)), values[i]);
+  }
+}
+
+TEST_F(GpuCacheTest, FlushWritesBeforeReturning) {
+  const std::vector<uint8_t> value{0xDE, 0xAD, 0xBE, 0xEF};
+  store("flushed", value);
+  cache_flush();
+  ASSERT_TRUE(std::filesystem::exists(m_directory / "dawn_cache.db"));
+  cache_shutdown();
+  EXPECT_EQ(load("flushed"), value);
+}
+
+TEST_F(GpuCacheTest, PruneWritesASnapshotThatServesLoads) {
+  std::vector<std::vector<uint8_t>> values;
+  for (uint8_t i = 0; i < 16; ++i) {
+    values.emplace_back(64 + i, i);
+    store("blob" + std::to_string(i), values.back());
+  }
+  cache_flush();
+  cache_prune();
+  cache_shutdown();
+  ASSERT_TRUE(std::filesystem::exists(m_directory / "dawn_cache.snapshot"));
+
+  // Emptying the table behind the cache's back leaves the stamp alone, so only the snapshot can serve the loads
+  sqlite3* db = nullptr;
+  ASSERT_EQ(sqlite3_open(aurora::io::fs_path_to_string(m_directory / "dawn_cache.db").c_str(), &db), SQLITE_OK);
+  EXPECT_EQ(sqlite3_exec(db, "DELETE FROM cache", nullptr, nullptr, nullptr), SQLITE_OK);
+  sqlite3_close(db);
+  for (uint8_t i = 0; i < values.size(); ++i) {
+    EXPECT_EQ(load("blob" + std::to_string(i)), values[i]);
+  }
+}
+
+TEST_F(GpuCacheTest, ReplacedValuesAreNotServedFromTheSnapshot) {
+  store("pipeline", std::vector<uint8_t>(64, 1));
+  cache_flush();
+  cache_prune();
+  ASSERT_TRUE(std::filesystem::exists(m_directory / "dawn_cache.snapshot"));
+
+  const std::vector<uint8_t> replaced(64, 2);
+  store("pipeline", replaced);
+  cache_flush();
+  EXPECT_EQ(load("pipeline"), replaced);
+
+  // The snapshot still holds the first value and as many entries as the database
+  cache_shutdown();
+  EXPECT_EQ(load("pipeline"), replaced);
+  cache_prune();
+  cache_shutdown();
+  EXPECT_EQ(load("pipeline"), replaced);
+}
+
+} // namespace
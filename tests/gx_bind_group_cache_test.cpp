@@ -0,0 +1,86 @@
+#include "gx/bind_group_cache.hpp"
+#include "gx/texture.hpp"
+
+#include <gtest/gtest.h>
+
+namespace aurora::gx::testing {
+void reset_texture_stubs();
+gfx::TextureHandle make_texture_handle(uint32_t width, uint32_t height, u32 format = GX_TF_RGBA8_PC);
+void expire_bind_group(gfx::BindGroupRef id);
+} // namespace aurora::gx::testing
+
+namespace aurora::gx {
+namespace {
+class GxBindGroupCacheTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    texture::shutdown();
+    testing::reset_texture_stubs();
+    info.sampledTextures.set(0);
+    textures[0] = gfx::TextureBind{GXTexObj_{.mode0 = GX_REPEAT | GX_REPEAT << 2}, testing::make_texture_handle(4, 4)};
+  }
+
+  void TearDown() override { texture::shutdown(); }
+
+  TextureBindingsKey key() const { return texture_bindings_key(info, textures, 16); }
+
+  ShaderInfo info{};
+  std::array<gfx::TextureBind, MaxTextures> textures;
+};
+
+TEST_F(GxBindGroupCacheTest, HitsForIdenticalBindings) {
+  EXPECT_EQ(bind_group_cache::find(key()), 0u);
+  bind_group_cache::insert(key(), 0x1234);
+  EXPECT_EQ(bind_group_cache::find(key()), 0x1234u);
+
+  // State of texture maps the shader doesn't sample doesn't matter
+  textures[3] = gfx::TextureBind{GXTexObj_{}, testing::make_texture_handle(8, 8)};
+  textures[0].texObj.mode0 |= 0x7F << 9; // LOD bias is a uniform, not sampler state
+  EXPECT_EQ(bind_group_cache::find(key()), 0x1234u);
+}
+
+TEST_F(GxBindGroupCacheTest, MissesOnSamplerStateChanges) {
+  bind_group_cache::insert(key(), 0x1234);
+  const auto base = key();
+
+  textures[0].texObj.mode0 = GX_CLAMP;
+  EXPECT_NE(key(), base);
+  textures[0].texObj.mode0 = base.slots[0].sampler;
+  textures[0].texObj.mode1 = 0x10 << 8;
+  EXPECT_NE(key(), base);
+  textures[0].texObj.mode1 = 0;
+  textures[0].ref->isReplacement = true;
+  EXPECT_NE(key(), base);
+  textures[0].ref->isReplacement = false;
+  EXPECT_EQ(key(), base);
+  EXPECT_NE(texture_bindings_key(info, textures, 1), base);
+}
+
+TEST_F(GxBindGroupCacheTest, DestroyedTexturesNeverHit) {
+  bind_group_cache::insert(key(), 0x1234);
+  const auto oldId = textures[0].ref->id;
+
+  // The replacement may well be allocated at the destroyed texture's address; its id must still differ.
+  textures[0].reset();
+  textures[0].ref = testing::make_texture_handle(4, 4);
+  EXPECT_NE(textures[0].ref->id, oldId);
+  EXPECT_EQ(bind_group_cache::find(key()), 0u);
+}
+
+TEST_F(GxBindGroupCacheTest, DropsEntriesTheSharedCacheExpired) {
+  bind_group_cache::insert(key(), 0x1234);
+  testing::expire_bind_group(0x1234);
+  EXPECT_EQ(bind_group_cache::find(key()), 0u);
+  EXPECT_EQ(bind_group_cache::size(), 0u);
+}
+
+TEST_F(GxBindGroupCacheTest, SweepsIdleEntries) {
+  bind_group_cache::insert(key(), 0x1234);
+  for (uint64_t i = 0; i < bind_group_cache::RetainFrames * 2; ++i) {
+    bind_group_cache::end_frame();
+  }
+  EXPECT_EQ(bind_group_cache::size(), 0u);
+}
+
+} // namespace
+} // namespace aurora::gx
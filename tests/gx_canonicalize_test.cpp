@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+#include "gx/shader_info.hpp"
+
+namespace aurora::gx {
+namespace {
+
+// One textured stage: prev = tex * ras0, with the ShaderInfo build_shader_info would produce for it.
+ShaderConfig textured_config() {
+  ShaderConfig config{};
+  config.vtxStride = 16;
+  config.tevStageCount = 1;
+  auto& stage = config.tevStages[0];
+  stage.colorPass = {GX_CC_ZERO, GX_CC_TEXC, GX_CC_RASC, GX_CC_ZERO};
+  stage.alphaPass = {GX_CA_ZERO, GX_CA_TEXA, GX_CA_RASA, GX_CA_ZERO};
+  stage.texCoordId = GX_TEXCOORD0;
+  stage.texMapId = GX_TEXMAP0;
+  stage.channelId = GX_COLOR0A0;
+  config.colorChannels[GX_COLOR0] = {.matSrc = GX_SRC_VTX};
+  config.colorChannels[GX_ALPHA0] = {.matSrc = GX_SRC_VTX};
+  config.tcgs[0] = {.type = GX_TG_MTX2x4, .src = GX_TG_TEX0};
+  config.attrs[GX_VA_POS] = {.attrType = GX_INDEX16, .cnt = 3, .compType = GX_F32, .offset = 0};
+  config.attrs[GX_VA_CLR0] = {.attrType = GX_INDEX16, .cnt = 1, .compType = GX_RGBA8, .offset = 2};
+  config.attrs[GX_VA_TEX0] = {.attrType = GX_INDEX16, .cnt = 1, .compType = GX_F32, .offset = 4};
+  return config;
+}
+
+ShaderInfo textured_info() {
+  ShaderInfo info{};
+  info.sampledTexCoords.set(0);
+  info.sampledTextures.set(0);
+  info.sampledColorChannels.set(0);
+  return info;
+}
+
+ShaderConfig canonical(ShaderConfig config) {
+  canonicalize_shader_config(config, textured_info());
+  return config;
+}
+
+TEST(GXCanonicalize, KeepsStateTheShaderReads) {
+  const auto config = textured_config();
+  EXPECT_EQ(canonical(config), config);
+}
+
+TEST(GXCanonicalize, CollapsesUnusedTexGensAndAttributes) {
+  auto config = textured_config();
+  config.tcgs[1] = {.type = GX_TG_MTX3x4, .src = GX_TG_NRM, .mtx = GX_TEXMTX3};
+  config.attrs[GX_VA_TEX1] = {.attrType = GX_INDEX8, .cnt = 1, .compType = GX_F32, .offset = 6};
+  config.attrs[GX_VA_TEX1MTXIDX] = {.attrType = GX_DIRECT, .offset = 7};
+  config.attrs[GX_VA_NRM] = {.attrType = GX_INDEX8, .cnt = 3, .compType = GX_F32, .offset = 8};
+  EXPECT_EQ(canonical(config), canonical(textured_config()));
+  EXPECT_EQ(canonical(config).vtxStride, 16);
+}
+
+TEST(GXCanonicalize, KeepsNormalWhenLit) {
+  auto config = textured_config();
+  config.attrs[GX_VA_NRM] = {.attrType = GX_INDEX8, .cnt = 3, .compType = GX_F32, .offset = 8};
+  config.colorChannels[GX_COLOR0].lightingEnabled = true;
+  auto info = textured_info();
+  info.lightingEnabled = true;
+  canonicalize_shader_config(config, info);
+  EXPECT_EQ(config.attrs[GX_VA_NRM].attrType, GX_INDEX8);
+}
+
+TEST(GXCanonicalize, CollapsesUnreferencedTevState) {
+  auto config = textured_config();
+  config.tevSwapTable[2] = {GX_CH_ALPHA, GX_CH_ALPHA, GX_CH_ALPHA, GX_CH_ALPHA};
+  config.tevStages[0].kcSel = GX_TEV_KCSEL_K1;
+  config.tevStages[0].kaSel = GX_TEV_KASEL_K2_A;
+  config.indStages[0] = {.texCoordId = GX_TEXCOORD1, .texMapId = GX_TEXMAP1};
+  config.numIndStages = 1;
+  config.colorChannels[GX_COLOR1] = {.matSrc = GX_SRC_VTX, .lightingEnabled = true};
+  config.alphaCompare = {.comp0 = GX_ALWAYS, .ref0 = 0x40, .op = GX_AOP_AND, .comp1 = GX_ALWAYS, .ref1 = 0x80};
+  config.fogRangeEnabled = true;
+  EXPECT_EQ(canonical(config), canonical(textured_config()));
+}
+
+TEST(GXCanonicalize, KeepsReferencedSwapAndKonst) {
+  auto config = textured_config();
+  config.tevSwapTable[2] = {GX_CH_ALPHA, GX_CH_ALPHA, GX_CH_ALPHA, GX_CH_ALPHA};
+  config.tevStages[0].tevSwapTex = GX_TEV_SWAP2;
+  config.tevStages[0].colorPass.d = GX_CC_KONST;
+  config.tevStages[0].kcSel = GX_TEV_KCSEL_K1;
+  const auto result = canonical(config);
+  EXPECT_EQ(result.tevSwapTable[2], config.tevSwapTable[2]);
+  EXPECT_EQ(result.tevStages[0].kcSel, GX_TEV_KCSEL_K1);
+  EXPECT_EQ(result.tevStages[0].kaSel, GX_TEV_KASEL_1);
+}
+
+TEST(GXCanonicalize, KeepsIndirectStagesInUse) {
+  auto config = textured_config();
+  config.tevStages[0].indTexStage = GX_INDTEXSTAGE0;
+  config.tevStages[0].indTexMtxId = GX_ITM_0;
+  config.tevStages[0].indTexBiasSel = GX_ITB_STU;
+  config.indStages[0] = {.texCoordId = GX_TEXCOORD1, .texMapId = GX_TEXMAP1};
+  config.numIndStages = 1;
+  auto info = textured_info();
+  info.usedIndStages.set(0);
+  info.sampledTexCoords.set(1);
+  canonicalize_shader_config(config, info);
+  EXPECT_EQ(config.numIndStages, 1);
+  EXPECT_EQ(config.indStages[0].texMapId, GX_TEXMAP1);
+  EXPECT_EQ(config.tevStages[0].indTexBiasSel, GX_ITB_STU);
+}
+
+} // namespace
+} // namespace aurora::gx
@@ -3649,6 +3649,28 @@ TEST_F(GXFifoTest, PeekZ_OutOfRangeFallsBackToZero) {
   EXPECT_TRUE(aurora::gfx::depth_peek::testing::snapshot_requested());
 }
 
+TEST_F(GXFifoTest, PeekZ_PointsAndRectReadOneSnapshot) {
+  aurora::gfx::depth_peek::testing::set_latest(2, 2, {0x000001, 0x000002, 0x000003, 0x01000004});
+
+  const GXPeekZPoint points[] = {{0, 1}, {1, 1}, {2, 0}};
+  u32 z[3] = {};
+  GXPeekZPoints(points, 3, z);
+  EXPECT_EQ(z[0], 0x000003u);
+  EXPECT_EQ(z[1], 0x000004u);
+  EXPECT_EQ(z[2], 0u);
+
+  u32 rect[4] = {};
+  GXPeekZRect(1, 0, 2, 2, rect);
+  EXPECT_EQ(rect[0], 0x000002u);
+  EXPECT_EQ(rect[1], 0u);
+  EXPECT_EQ(rect[2], 0x000004u);
+  EXPECT_EQ(rect[3], 0u);
+
+  auto bytes = capture_fifo();
+  decode_fifo(bytes);
+  EXPECT_TRUE(aurora::gfx::depth_peek::testing::snapshot_requested());
+}
+
 // ============================================================================
 // Composite tests (multiple state changes in a single FIFO stream)
 // ============================================================================
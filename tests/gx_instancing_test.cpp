@@ -0,0 +1,164 @@
+#include "gx_test_common.hpp"
+
+#include "gx/pipeline.hpp"
+
+#include <array>
+#include <cstring>
+#include <vector>
+
+namespace aurora::gfx {
+extern gx::DrawData g_testLastDraw;
+extern uint32_t g_testDrawCount;
+extern bool g_testExposeLastDraw;
+extern std::vector<uint8_t> g_testStorage;
+} // namespace aurora::gfx
+
+namespace aurora::gx {
+extern std::vector<PnMtx> g_testUniformPnMtx;
+} // namespace aurora::gx
+
+namespace {
+
+class GXInstancingTest : public GXFifoTest {
+protected:
+  void SetUp() override {
+    GXFifoTest::SetUp();
+    GXClearVtxDesc();
+    GXSetVtxDesc(GX_VA_POS, GX_DIRECT);
+    GXSetVtxAttrFmt(GX_VTXFMT0, GX_VA_POS, GX_POS_XYZ, GX_U8, 0);
+    decode_fifo(flush_and_capture());
+    aurora::gfx::g_testExposeLastDraw = true;
+    aurora::gfx::g_testDrawCount = 0;
+    aurora::gfx::g_testLastDraw = {};
+    aurora::gfx::g_testStorage.clear();
+    aurora::gx::g_testUniformPnMtx.clear();
+  }
+
+  void TearDown() override {
+    aurora::gfx::g_testExposeLastDraw = false;
+    GXFifoTest::TearDown();
+  }
+
+  static aurora::Mat3x4<float> translation(float x) {
+    aurora::Mat3x4<float> mtx{};
+    mtx.m0[0] = 1.f;
+    mtx.m1[1] = 1.f;
+    mtx.m2[2] = 1.f;
+    mtx.m0[3] = x;
+    return mtx;
+  }
+
+  static void draw_quad(u8 base = 0) {
+    GXBegin(GX_QUADS, GX_VTXFMT0, 4);
+    for (u8 i = 0; i < 4; ++i) {
+      GXPosition3u8(base + i, i, 0);
+    }
+    GXEnd();
+  }
+
+  // Loads a distinct matrix before each draw of the same quad, as a scene placing many copies of a model would.
+  void draw_copies(u32 count) {
+    for (u32 i = 0; i < count; ++i) {
+      const auto mtx = translation(static_cast<float>(i));
+      GXLoadPosMtxImm(&mtx, GX_PNMTX0);
+      draw_quad();
+    }
+    decode_fifo(capture_fifo());
+  }
+};
+
+TEST_F(GXInstancingTest, RepeatedDrawsBecomeOneInstancedDraw) {
+  draw_copies(3);
+
+  EXPECT_EQ(aurora::gfx::g_testDrawCount, 1u);
+  EXPECT_EQ(aurora::gfx::g_testLastDraw.instanceCount, 3u);
+  EXPECT_EQ(aurora::gfx::g_testLastDraw.vtxCount, 4u);
+}
+
+TEST_F(GXInstancingTest, InstanceMatricesMatchTheUniformPath) {
+  // Distinct vertices keep the copies apart, so each one reads its matrices from its own uniform.
+  for (u32 i = 0; i < 3; ++i) {
+    const auto mtx = translation(static_cast<float>(i));
+    GXLoadPosMtxImm(&mtx, GX_PNMTX0);
+    draw_quad(i * 4);
+  }
+  decode_fifo(capture_fifo());
+  ASSERT_EQ(aurora::gfx::g_testDrawCount, 3u);
+  const auto expected = aurora::gx::g_testUniformPnMtx;
+  ASSERT_EQ(expected.size(), 3u);
+
+  aurora::gfx::g_testDrawCount = 0;
+  aurora::gfx::g_testStorage.clear();
+  draw_copies(3);
+  ASSERT_EQ(aurora::gfx::g_testDrawCount, 1u);
+  ASSERT_EQ(aurora::gfx::g_testLastDraw.instanceCount, 3u);
+
+  // The instances' matrices are packed from storageBase in draw order and match what the uniform path read.
+  const auto& storage = aurora::gfx::g_testStorage;
+  const size_t base = aurora::gfx::g_testLastDraw.immediateData.storageBase * sizeof(u32);
+  ASSERT_EQ(storage.size(), base + 3 * sizeof(aurora::gx::PnMtx));
+  for (u32 i = 0; i < 3; ++i) {
+    EXPECT_EQ(std::memcmp(storage.data() + base + i * sizeof(aurora::gx::PnMtx), &expected[i],
+                          sizeof(aurora::gx::PnMtx)),
+              0)
+        << "instance " << i;
+  }
+}
+
+TEST_F(GXInstancingTest, InterleavedStoragePushEndsTheBatch) {
+  for (u32 i = 0; i < 2; ++i) {
+    const auto mtx = translation(static_cast<float>(i));
+    GXLoadPosMtxImm(&mtx, GX_PNMTX0);
+    draw_quad();
+  }
+  decode_fifo(capture_fifo());
+  ASSERT_EQ(aurora::gfx::g_testLastDraw.instanceCount, 2u);
+
+  static constexpr std::array<u8, 4> other{1, 2, 3, 4};
+  aurora::gfx::push_storage(other.data(), other.size());
+  const auto storageSize = aurora::gfx::g_testStorage.size();
+
+  const auto mtx = translation(2.f);
+  GXLoadPosMtxImm(&mtx, GX_PNMTX0);
+  draw_quad();
+  decode_fifo(capture_fifo());
+
+  // The third matrix can't extend the first two, so it's drawn on its own without pushing it to abuf first.
+  EXPECT_EQ(aurora::gfx::g_testDrawCount, 2u);
+  EXPECT_EQ(aurora::gfx::g_testLastDraw.instanceCount, 1u);
+  EXPECT_EQ(aurora::gfx::g_testStorage.size(), storageSize);
+}
+
+TEST_F(GXInstancingTest, BatchesAreCapped) {
+  draw_copies(300);
+
+  EXPECT_EQ(aurora::gfx::g_testDrawCount, 2u);
+  EXPECT_EQ(aurora::gfx::g_testLastDraw.instanceCount, 300u - 256u);
+}
+
+TEST_F(GXInstancingTest, OtherUniformChangesPreventInstancing) {
+  for (u32 i = 0; i < 3; ++i) {
+    const auto mtx = translation(static_cast<float>(i));
+    GXLoadPosMtxImm(&mtx, GX_PNMTX0);
+    GXSetTevColor(GX_TEVREG0, GXColor{static_cast<u8>(i), 0, 0, 0xFF});
+    draw_quad();
+  }
+  decode_fifo(capture_fifo());
+
+  EXPECT_EQ(aurora::gfx::g_testDrawCount, 3u);
+  EXPECT_EQ(aurora::gfx::g_testLastDraw.instanceCount, 1u);
+}
+
+TEST_F(GXInstancingTest, DifferentVerticesPreventInstancing) {
+  for (u8 i = 0; i < 3; ++i) {
+    const auto mtx = translation(static_cast<float>(i));
+    GXLoadPosMtxImm(&mtx, GX_PNMTX0);
+    draw_quad(i * 4);
+  }
+  decode_fifo(capture_fifo());
+
+  EXPECT_EQ(aurora::gfx::g_testDrawCount, 3u);
+  EXPECT_EQ(aurora::gfx::g_testLastDraw.instanceCount, 1u);
+}
+
+} // namespace
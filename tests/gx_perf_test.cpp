@@ -0,0 +1,136 @@
+#include "gx_test_common.hpp"
+
+#include "gx/perf.hpp"
+
+#include <dolphin/gx/GXPerf.h>
+
+#include <cstring>
+
+namespace {
+
+class GXPerfTest : public GXFifoTest {
+protected:
+  void SetUp() override {
+    GXFifoTest::SetUp();
+    aurora::gx::fifo::init();
+    aurora::gx::fifo::begin_frame();
+    GXClearVtxDesc();
+    GXSetVtxDesc(GX_VA_POS, GX_DIRECT);
+    GXSetVtxAttrFmt(GX_VTXFMT0, GX_VA_POS, GX_POS_XYZ, GX_U8, 0);
+  }
+
+  static void draw(GXPrimitive prim, u16 vtxCount) {
+    GXBegin(prim, GX_VTXFMT0, vtxCount);
+    for (u16 i = 0; i < vtxCount; ++i) {
+      GXPosition3u8(i, i, i);
+    }
+    GXEnd();
+  }
+
+  static void finish() {
+    aurora::gx::fifo::drain();
+    aurora::gx::fifo::end_frame();
+  }
+};
+
+#if AURORA_GX_PERF_COUNTERS
+TEST_F(GXPerfTest, GPMetricCountsTrianglesAndVertices) {
+  GXSetGPMetric(GX_PERF0_TRIANGLES, GX_PERF1_VERTICES);
+  GXClearGPMetric();
+
+  draw(GX_QUADS, 8);
+  draw(GX_TRIANGLESTRIP, 5);
+  draw(GX_TRIANGLEFAN, 4);
+  draw(GX_LINES, 4);
+  finish();
+
+  u32 triangles = 0;
+  u32 vertices = 0;
+  GXReadGPMetric(&triangles, &vertices);
+  EXPECT_EQ(triangles, 4u + 3u + 2u);
+  EXPECT_EQ(vertices, 8u + 5u + 4u + 4u);
+  EXPECT_EQ(GXReadGP1Metric(), vertices);
+}
+
+TEST_F(GXPerfTest, ClearResetsOnlyItsOwnGroup) {
+  GXSetGPMetric(GX_PERF0_VERTICES, GX_PERF1_FIFO_REQ);
+  GXClearGPMetric();
+  GXClearMemMetric();
+  draw(GX_TRIANGLES, 3);
+  finish();
+
+  GXClearGPMetric();
+  EXPECT_EQ(GXReadGP0Metric(), 0u);
+
+  u32 cpReq = 0;
+  u32 tcReq = 0;
+  GXReadMemMetric(&cpReq, &tcReq, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr);
+  EXPECT_GT(cpReq, 0u);
+  EXPECT_EQ(tcReq, 0u);
+}
+
+TEST_F(GXPerfTest, SnapshotCountsCommandsAndDraws) {
+  const auto before = aurora::gx::perf::snapshot();
+  draw(GX_TRIANGLES, 3);
+  finish();
+  const auto after = aurora::gx::perf::snapshot();
+
+  using aurora::gx::perf::Counter;
+  EXPECT_GT(after[Counter::Commands], before[Counter::Commands]);
+  EXPECT_GT(after[Counter::FifoBytes], before[Counter::FifoBytes]);
+  EXPECT_EQ(after[Counter::Triangles] - before[Counter::Triangles], 1u);
+  EXPECT_EQ(after[Counter::DrawsSubmitted] + after[Counter::DrawsMerged] - before[Counter::DrawsSubmitted] -
+                before[Counter::DrawsMerged],
+            1u);
+}
+
+TEST_F(GXPerfTest, AuroraCountersExposeEveryCounter) {
+  GXAuroraPerfCounters before{};
+  GXAuroraReadPerfCounters(&before);
+  draw(GX_LINES, 4);
+  draw(GX_POINTS, 3);
+  draw(GX_LINESTRIP, 3);
+  finish();
+  GXAuroraPerfCounters after{};
+  GXAuroraReadPerfCounters(&after);
+
+  const auto snapshot = aurora::gx::perf::snapshot();
+  using aurora::gx::perf::Counter;
+  EXPECT_EQ(after.lines - before.lines, 2u);
+  EXPECT_EQ(after.points - before.points, 3u);
+  EXPECT_EQ(after.lineStripLines - before.lineStripLines, 2u);
+  EXPECT_EQ(after.vertices - before.vertices, 10u);
+  EXPECT_EQ(after.commands, snapshot[Counter::Commands]);
+  EXPECT_EQ(after.drawsSubmitted, snapshot[Counter::DrawsSubmitted]);
+  EXPECT_EQ(after.uniformBytes, snapshot[Counter::UniformBytes]);
+  EXPECT_EQ(after.pipelineLookups, snapshot[Counter::PipelineLookups]);
+  EXPECT_EQ(after.efbCopyPixels, snapshot[Counter::EfbCopyPixels]);
+  EXPECT_EQ(after.attrUploads[GX_VA_TEX7 - GX_VA_POS], snapshot.attrMisses.back());
+}
+#else
+TEST_F(GXPerfTest, AuroraCountersReadZeroWhenCompiledOut) {
+  draw(GX_TRIANGLES, 3);
+  finish();
+
+  GXAuroraPerfCounters counters;
+  std::memset(&counters, 0xff, sizeof(counters));
+  GXAuroraReadPerfCounters(&counters);
+  EXPECT_EQ(counters.vertices, 0u);
+  EXPECT_EQ(counters.attrFetches[0], 0u);
+}
+#endif
+
+TEST_F(GXPerfTest, UnsupportedMetricsReadZero) {
+  GXSetGPMetric(GX_PERF0_XF_WAIT_IN, GX_PERF1_TX_IDLE);
+  GXClearGPMetric();
+  draw(GX_TRIANGLES, 3);
+  finish();
+
+  u32 cnt0 = 1;
+  u32 cnt1 = 1;
+  GXReadGPMetric(&cnt0, &cnt1);
+  EXPECT_EQ(cnt0, 0u);
+  EXPECT_EQ(cnt1, 0u);
+}
+
+} // namespace
@@ -0,0 +1,128 @@
+#include "gx_test_common.hpp"
+
+#include "gx/perf.hpp"
+#include "gx/pipeline.hpp"
+#include "gx/static_indices.hpp"
+
+namespace aurora::gfx {
+extern gx::DrawData g_testLastDraw;
+extern uint32_t g_testDrawCount;
+extern bool g_testExposeLastDraw;
+} // namespace aurora::gfx
+
+namespace {
+using aurora::gx::perf::Counter;
+namespace static_indices = aurora::gx::static_indices;
+
+std::vector<u16> slice_indices(const static_indices::Slice& slice) {
+  const auto data = static_indices::data().subspan(slice.range.offset / sizeof(u16), slice.indexCount);
+  return {data.begin(), data.end()};
+}
+
+TEST(GXStaticIndices, QuadSliceSplitsEachQuadIntoTwoTriangles) {
+  const auto slice = static_indices::find(GX_QUADS, 8);
+  ASSERT_TRUE(slice.has_value());
+  EXPECT_EQ(slice->range.size, slice->indexCount * sizeof(u16));
+  EXPECT_EQ(slice_indices(*slice), (std::vector<u16>{0, 1, 2, 2, 3, 0, 4, 5, 6, 6, 7, 4}));
+}
+
+TEST(GXStaticIndices, FanAndStripSlicesMatchGeneratedIndices) {
+  const auto fan = static_indices::find(GX_TRIANGLEFAN, 5);
+  ASSERT_TRUE(fan.has_value());
+  EXPECT_EQ(slice_indices(*fan), (std::vector<u16>{0, 1, 2, 0, 2, 3, 0, 3, 4}));
+
+  const auto strip = static_indices::find(GX_TRIANGLESTRIP, 5);
+  ASSERT_TRUE(strip.has_value());
+  EXPECT_EQ(slice_indices(*strip), (std::vector<u16>{0, 1, 2, 2, 1, 3, 2, 3, 4}));
+}
+
+TEST(GXStaticIndices, OnlyCoveredDrawsHaveSlices) {
+  EXPECT_FALSE(static_indices::find(GX_TRIANGLES, 3).has_value());
+  EXPECT_FALSE(static_indices::find(GX_QUADS, static_indices::MaxVertices + 4).has_value());
+  EXPECT_TRUE(static_indices::find(GX_QUADS, static_indices::MaxVertices).has_value());
+  // Lines and points are expanded per instance, so their slice doesn't depend on the vertex count
+  EXPECT_EQ(static_indices::find(GX_LINES, 2)->range, static_indices::find(GX_POINTS, 0xFFFF)->range);
+}
+
+class GXStaticIndexDrawTest : public GXFifoTest {
+protected:
+  void SetUp() override {
+    GXFifoTest::SetUp();
+    GXClearVtxDesc();
+    GXSetVtxDesc(GX_VA_POS, GX_DIRECT);
+    GXSetVtxAttrFmt(GX_VTXFMT0, GX_VA_POS, GX_POS_XYZ, GX_U8, 0);
+    decode_fifo(flush_and_capture());
+    aurora::gfx::g_testExposeLastDraw = true;
+    aurora::gfx::g_testDrawCount = 0;
+    aurora::gfx::g_testLastDraw = {};
+  }
+
+  void TearDown() override {
+    aurora::gfx::g_testExposeLastDraw = false;
+    GXFifoTest::TearDown();
+  }
+
+  static void draw(GXPrimitive prim, u16 vtxCount) {
+    GXBegin(prim, GX_VTXFMT0, vtxCount);
+    for (u16 i = 0; i < vtxCount; ++i) {
+      GXPosition3u8(static_cast<u8>(i), 0, 0);
+    }
+    GXEnd();
+  }
+
+  static u64 index_bytes() { return aurora::gx::perf::snapshot()[Counter::IndexBytes]; }
+};
+
+TEST_F(GXStaticIndexDrawTest, QuadDrawsReferenceStaticIndices) {
+  const auto before = index_bytes();
+  draw(GX_QUADS, 8);
+  decode_fifo(capture_fifo());
+
+  const auto& last = aurora::gfx::g_testLastDraw;
+  EXPECT_TRUE(last.staticIndices);
+  EXPECT_EQ(last.indexCount, 12u);
+  EXPECT_EQ(last.idxRange, static_indices::find(GX_QUADS, 8)->range);
+  EXPECT_EQ(index_bytes(), before);
+}
+
+TEST_F(GXStaticIndexDrawTest, MergedQuadsExtendTheStaticSlice) {
+  const auto before = index_bytes();
+  draw(GX_QUADS, 4);
+  draw(GX_QUADS, 8);
+  decode_fifo(capture_fifo());
+
+  const auto& last = aurora::gfx::g_testLastDraw;
+  EXPECT_EQ(aurora::gfx::g_testDrawCount, 1u);
+  EXPECT_TRUE(last.staticIndices);
+  EXPECT_EQ(last.indexCount, 18u);
+  EXPECT_EQ(last.idxRange, static_indices::find(GX_QUADS, 12)->range);
+  EXPECT_EQ(index_bytes(), before);
+}
+
+TEST_F(GXStaticIndexDrawTest, OtherMergesMoveIndicesToTheFrameBuffer) {
+  const auto before = index_bytes();
+  draw(GX_QUADS, 4);
+  draw(GX_TRIANGLEFAN, 4);
+  decode_fifo(capture_fifo());
+
+  const auto& last = aurora::gfx::g_testLastDraw;
+  EXPECT_EQ(aurora::gfx::g_testDrawCount, 1u);
+  EXPECT_FALSE(last.staticIndices);
+  EXPECT_EQ(last.indexCount, 12u);
+#if AURORA_GX_PERF_COUNTERS
+  EXPECT_EQ(index_bytes() - before, 12u * sizeof(u16));
+#endif
+}
+
+TEST_F(GXStaticIndexDrawTest, LongDrawsUseTheFrameBuffer) {
+  const auto before = index_bytes();
+  draw(GX_TRIANGLESTRIP, static_indices::MaxVertices + 2);
+  decode_fifo(capture_fifo());
+
+  EXPECT_FALSE(aurora::gfx::g_testLastDraw.staticIndices);
+#if AURORA_GX_PERF_COUNTERS
+  EXPECT_EQ(index_bytes() - before, static_indices::MaxVertices * 3u * sizeof(u16));
+#endif
+}
+
+} // namespace
@@ -6,6 +6,7 @@
 #include "gfx/clear.hpp"
 #include "gfx/resources.hpp"
 #include "gfx/depth_peek.hpp"
+#include "gfx/pipeline_cache.hpp"
 #include "gfx/recording.hpp"
 #include "gfx/tex_copy_conv.hpp"
 #include "gfx/tex_palette_conv.hpp"
@@ -18,7 +19,9 @@
 
 #include <atomic>
 #include <cstdio>
+#include <cstring>
 #include <fmt/format.h>
+#include <vector>
 
 // --- aurora::g_config ---
 namespace aurora {
@@ -46,6 +49,7 @@ Resources& resources() noexcept {
 }
 
 void increment_merged_draw_count() noexcept {}
+void increment_instanced_draw_count() noexcept {}
 } // namespace aurora::gfx::detail
 
 namespace aurora::webgpu {
@@ -117,7 +121,14 @@ void populate_pipeline_config(PipelineConfig& config, GXPrimitive primitive, GXV
 }
 GXBindGroups build_bind_groups(const ShaderInfo& info) noexcept { return {}; }
 ShaderInfo build_shader_info(const ShaderConfig& config) noexcept { return {}; }
-gfx::Range build_uniform(const ShaderInfo& info) noexcept { return {.size = 1}; }
+// The position/normal matrix each non-instanced draw reads from its uniform
+std::vector<PnMtx> g_testUniformPnMtx;
+gfx::Range build_uniform(const ShaderInfo& info) noexcept {
+  g_testUniformPnMtx.push_back(g_gxState.pnMtx[g_gxState.currentPnMtx]);
+  return {.size = 1};
+}
+gfx::Range build_uber_uniform(const ShaderInfo& info) noexcept { return {.size = 1}; }
+gfx::PipelineRef uber_pipeline_ref(const PipelineConfig& config) noexcept { return 0; }
 void resolve_sampled_textures(const ShaderInfo& info) noexcept {}
 } // namespace aurora::gx
 
@@ -126,7 +137,29 @@ namespace aurora::gfx {
 Range push_verts(const uint8_t* data, size_t length, size_t alignment) { return {}; }
 Range push_indices(const uint8_t* data, size_t length, size_t alignment) { return {}; }
 Range push_uniform(const uint8_t* data, size_t length) { return {}; }
-Range push_storage(const uint8_t* data, size_t length) { return {}; }
+// Storage pushes land in g_testStorage with the same offsets and alignment padding as the frame's storage buffer.
+std::vector<uint8_t> g_testStorage;
+constexpr size_t TestStorageAlignment = 256;
+Range push_storage_contiguous(const uint8_t* data, size_t length) {
+  const Range range{static_cast<uint32_t>(g_testStorage.size()), static_cast<uint32_t>(length)};
+  g_testStorage.insert(g_testStorage.end(), data, data + length);
+  return range;
+}
+Range push_storage(const uint8_t* data, size_t length) {
+  g_testStorage.resize((g_testStorage.size() + TestStorageAlignment - 1) & ~(TestStorageAlignment - 1));
+  return push_storage_contiguous(data, length);
+}
+size_t storage_offset() noexcept { return g_testStorage.size(); }
+std::vector<uint8_t> g_testResidentStorage;
+uint32_t g_testResidentUploads = 0;
+Range upload_resident_storage(uint32_t offset, const uint8_t* data, size_t length) {
+  if (g_testResidentStorage.size() < offset + length) {
+    g_testResidentStorage.resize(offset + length);
+  }
+  std::memcpy(g_testResidentStorage.data() + offset, data, length);
+  ++g_testResidentUploads;
+  return {static_cast<uint32_t>(StorageBufferSize + offset), static_cast<uint32_t>(length)};
+}
 
 Vec2<uint32_t> get_render_target_size() noexcept { return {640, 480}; }
 void set_viewport(const Viewport& viewport) noexcept {}
@@ -171,6 +204,8 @@ template <>
 PipelineRef pipeline_ref<gx::PipelineConfig>(const gx::PipelineConfig& config) {
   return 0;
 }
+bool has_pipeline(PipelineRef ref) { return true; }
+uint32_t pipeline_generation() noexcept { return 0; }
 gx::DrawData g_testLastDraw{};
 uint32_t g_testDrawCount = 0;
 std::atomic<uint32_t> g_testProcessedDrawCount{0};
@@ -181,9 +216,10 @@ void push_draw_command<gx::DrawData>(gx::DrawData data) {
   ++g_testDrawCount;
   g_testProcessedDrawCount.fetch_add(1, std::memory_order_release);
 }
+bool g_testExposeLastDraw = false;
 template <>
 gx::DrawData* get_last_draw_command() {
-  return nullptr;
+  return g_testExposeLastDraw && g_testDrawCount != 0 ? &g_testLastDraw : nullptr;
 }
 } // namespace aurora::gfx
 
@@ -235,9 +271,6 @@ bool is_offscreen() noexcept { return false; }
 namespace aurora::gfx::depth_peek {
 namespace {
 bool s_snapshotRequested = false;
-uint32_t s_width = 0;
-uint32_t s_height = 0;
-std::vector<uint32_t> s_data;
 } // namespace
 
 void initialize() {}
@@ -248,29 +281,14 @@ void encode_frame_snapshot(const wgpu::CommandEncoder& cmd, const wgpu::TextureV
                            wgpu::Extent3D sourceSize, uint32_t msaaSamples) noexcept {}
 void after_submit() noexcept {}
 
-bool read_latest(uint16_t x, uint16_t y, uint32_t& z) noexcept {
-  if (x >= s_width || y >= s_height || s_data.empty()) {
-    return false;
-  }
-  z = s_data[static_cast<size_t>(y) * s_width + x] & 0x00ffffffu;
-  return true;
-}
-
 namespace testing {
 void reset() noexcept {
   s_snapshotRequested = false;
-  s_width = 0;
-  s_height = 0;
-  s_data.clear();
+  clear_latest();
+  set_divisor(1);
 }
 
 bool snapshot_requested() noexcept { return s_snapshotRequested; }
-
-void set_latest(uint32_t width, uint32_t height, const std::vector<uint32_t>& data) {
-  s_width = width;
-  s_height = height;
-  s_data = data;
-}
 } // namespace testing
 } // namespace aurora::gfx::depth_peek
 
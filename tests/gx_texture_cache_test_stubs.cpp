@@ -10,6 +10,7 @@
 #include <fmt/format.h>
 #include <memory>
 #include <optional>
+#include <set>
 
 namespace {
 uint64_t s_textureAllocations = 0;
@@ -19,6 +20,7 @@ std::optional<aurora::texture::TextureSourceKey> s_sourceKey;
 aurora::gfx::TextureHandle s_sourceReplacement;
 uint64_t s_replacementId = 0;
 uint64_t s_sourceReplacementId = 0;
+std::set<aurora::gfx::BindGroupRef> s_expiredBindGroups;
 } // namespace
 
 namespace aurora {
@@ -52,6 +54,7 @@ void reset_texture_stubs() {
   s_sourceReplacement.reset();
   s_replacementId = 0;
   s_sourceReplacementId = 0;
+  s_expiredBindGroups.clear();
 }
 
 uint64_t texture_allocations() { return s_textureAllocations; }
@@ -65,10 +68,13 @@ void set_source_replacement(aurora::texture::TextureSourceKey key, gfx::TextureH
   s_sourceReplacement = std::move(handle);
   s_sourceReplacementId = 2;
 }
+void expire_bind_group(gfx::BindGroupRef id) { s_expiredBindGroups.insert(id); }
 } // namespace testing
 } // namespace aurora::gx
 
 namespace aurora::gfx {
+bool touch_bind_group(BindGroupRef id) noexcept { return !s_expiredBindGroups.contains(id); }
+
 uint64_t calc_texture_size(wgpu::TextureFormat format, uint32_t width, uint32_t height, uint32_t mips) noexcept {
   uint64_t total = 0;
   for (uint32_t mip = 0; mip < mips; ++mip) {
@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+
+#include "gx/uber_config.hpp"
+
+namespace aurora::gx::uber {
+namespace {
+
+u32 bits(u32 word, u32 offset, u32 count) { return (word >> offset) & ((1u << count) - 1); }
+
+// One textured stage: prev = tex * ras0
+ShaderConfig textured_config() {
+  ShaderConfig config{};
+  config.vtxStride = 12;
+  config.tevStageCount = 1;
+  auto& stage = config.tevStages[0];
+  stage.colorPass = {GX_CC_ZERO, GX_CC_TEXC, GX_CC_RASC, GX_CC_ZERO};
+  stage.alphaPass = {GX_CA_ZERO, GX_CA_TEXA, GX_CA_RASA, GX_CA_ZERO};
+  stage.texCoordId = GX_TEXCOORD0;
+  stage.texMapId = GX_TEXMAP1;
+  stage.channelId = GX_COLOR0A0;
+  config.tcgs[0] = {.type = GX_TG_MTX2x4, .src = GX_TG_TEX0, .mtx = GX_TEXMTX1, .postMtx = GX_PTTEXMTX2};
+  config.attrs[GX_VA_POS] = {.attrType = GX_INDEX16, .cnt = 3, .compType = GX_F32, .offset = 0, .stride = 12};
+  config.attrs[GX_VA_TEX0] = {.attrType = GX_DIRECT, .cnt = 2, .compType = GX_S16, .offset = 2, .frac = 7};
+  return config;
+}
+
+TEST(GXUberConfig, SupportsPlainTexturedConfig) { EXPECT_TRUE(supported(textured_config())); }
+
+TEST(GXUberConfig, RejectsSpecializedOnlyFeatures) {
+  auto config = textured_config();
+  config.lineMode = 1;
+  EXPECT_FALSE(supported(config));
+
+  config = textured_config();
+  config.numIndStages = 1;
+  EXPECT_FALSE(supported(config));
+
+  config = textured_config();
+  config.fogRangeEnabled = true;
+  EXPECT_FALSE(supported(config));
+
+  config = textured_config();
+  config.tevStageCount = 0;
+  EXPECT_FALSE(supported(config));
+
+  config = textured_config();
+  config.tcgs[0].type = GX_TG_BUMP0;
+  EXPECT_FALSE(supported(config));
+
+  config = textured_config();
+  config.tcgs[0].src = GX_TG_TANGENT;
+  EXPECT_FALSE(supported(config));
+
+  config = textured_config();
+  config.tevStages[0].texCoordId = GX_TEXCOORD_NULL;
+  EXPECT_FALSE(supported(config));
+}
+
+TEST(GXUberConfig, UnsampledTexGensDoNotAffectSupport) {
+  auto config = textured_config();
+  config.tcgs[3] = {.type = GX_TG_BUMP1, .src = GX_TG_BINRM};
+  EXPECT_TRUE(supported(config));
+  EXPECT_EQ(pack(config).words[TexGenWord + 3], static_cast<u32>(GX_MAX_TEXGENSRC));
+}
+
+TEST(GXUberConfig, PacksHeaderAndAlphaCompare) {
+  auto config = textured_config();
+  config.fogType = GX_FOG_ORTHO_EXP2;
+  config.alphaCompare = {.comp0 = GX_GEQUAL, .ref0 = 0x80, .op = GX_AOP_OR, .comp1 = GX_LESS, .ref1 = 0x10};
+  const auto w = pack(config).words;
+  EXPECT_EQ(bits(w[HeaderWord], 0, 8), 12u);
+  EXPECT_EQ(bits(w[HeaderWord], 8, 5), 1u);
+  EXPECT_EQ(bits(w[HeaderWord], 16, 4), static_cast<u32>(GX_FOG_ORTHO_EXP2));
+  EXPECT_EQ(bits(w[AlphaCompareWord], 0, 3), static_cast<u32>(GX_GEQUAL));
+  EXPECT_EQ(bits(w[AlphaCompareWord], 3, 3), static_cast<u32>(GX_LESS));
+  EXPECT_EQ(bits(w[AlphaCompareWord], 6, 2), static_cast<u32>(GX_AOP_OR));
+  EXPECT_EQ(bits(w[AlphaCompareWord], 8, 8), 0x80u);
+  EXPECT_EQ(bits(w[AlphaCompareWord], 16, 8), 0x10u);
+}
+
+TEST(GXUberConfig, PacksAttributesAndTexGens) {
+  const auto w = pack(textured_config()).words;
+  const u32 pos = w[AttrWord + GX_VA_POS];
+  EXPECT_EQ(bits(pos, 0, 2), static_cast<u32>(GX_INDEX16));
+  EXPECT_EQ(bits(pos, 2, 4), 3u);
+  EXPECT_EQ(bits(pos, 6, 3), static_cast<u32>(GX_F32));
+  EXPECT_EQ(bits(pos, 24, 8), 12u);
+  const u32 tex = w[AttrWord + GX_VA_TEX0];
+  EXPECT_EQ(bits(tex, 0, 2), static_cast<u32>(GX_DIRECT));
+  EXPECT_EQ(bits(tex, 9, 5), 7u);
+  EXPECT_EQ(bits(tex, 16, 8), 2u);
+  EXPECT_EQ(w[AttrWord + GX_VA_NRM], 0u);
+
+  const u32 tcg = w[TexGenWord];
+  EXPECT_EQ(bits(tcg, 0, 5), static_cast<u32>(GX_TG_TEX0));
+  EXPECT_EQ(bits(tcg, 5, 4), static_cast<u32>(GX_TG_MTX2x4));
+  EXPECT_EQ(bits(tcg, 9, 6), static_cast<u32>(GX_TEXMTX1));
+  EXPECT_EQ(bits(tcg, 15, 7), static_cast<u32>(GX_PTTEXMTX2));
+}
+
+TEST(GXUberConfig, PacksTevStages) {
+  auto config = textured_config();
+  config.tevStages[0].colorOp = {
+      .op = GX_TEV_SUB, .bias = GX_TB_ADDHALF, .scale = GX_CS_SCALE_2, .outReg = GX_TEVREG1, .clamp = false};
+  config.tevStages[0].kcSel = GX_TEV_KCSEL_K2_B;
+  config.tevStages[0].tevSwapTex = GX_TEV_SWAP3;
+  const auto w = pack(config).words;
+  const u32 color = w[StageWord];
+  EXPECT_EQ(bits(color, 4, 4), static_cast<u32>(GX_CC_TEXC));
+  EXPECT_EQ(bits(color, 8, 4), static_cast<u32>(GX_CC_RASC));
+  EXPECT_EQ(bits(color, 16, 4), static_cast<u32>(GX_TEV_SUB));
+  EXPECT_EQ(bits(color, 20, 2), static_cast<u32>(GX_TB_ADDHALF));
+  EXPECT_EQ(bits(color, 22, 2), static_cast<u32>(GX_CS_SCALE_2));
+  EXPECT_EQ(bits(color, 24, 2), static_cast<u32>(GX_TEVREG1));
+  EXPECT_EQ(bits(color, 26, 1), 0u);
+  const u32 alpha = w[StageWord + 1];
+  EXPECT_EQ(bits(alpha, 3, 3), static_cast<u32>(GX_CA_TEXA));
+  EXPECT_EQ(bits(alpha, 26, 1), 1u);
+  const u32 misc = w[StageWord + 2];
+  EXPECT_EQ(bits(misc, 0, 5), static_cast<u32>(GX_TEV_KCSEL_K2_B));
+  EXPECT_EQ(bits(misc, 10, 3), static_cast<u32>(GX_TEXCOORD0));
+  EXPECT_EQ(bits(misc, 13, 3), static_cast<u32>(GX_TEXMAP1));
+  EXPECT_EQ(bits(misc, 16, 1), 1u);
+  EXPECT_EQ(bits(misc, 17, 2), 0u);
+  EXPECT_EQ(bits(misc, 22, 2), static_cast<u32>(GX_TEV_SWAP3));
+}
+
+TEST(GXUberConfig, UntexturedStageReadsRasZero) {
+  auto config = textured_config();
+  auto& stage = config.tevStages[0];
+  stage.colorPass = {GX_CC_ZERO, GX_CC_ZERO, GX_CC_ZERO, GX_CC_RASC};
+  stage.alphaPass = {GX_CA_ZERO, GX_CA_ZERO, GX_CA_ZERO, GX_CA_RASA};
+  stage.channelId = GX_COLOR_ZERO;
+  const u32 misc = pack(config).words[StageWord + 2];
+  EXPECT_EQ(bits(misc, 16, 1), 0u);
+  EXPECT_EQ(bits(misc, 10, 6), 0u);
+  EXPECT_EQ(bits(misc, 17, 2), RasZero);
+}
+
+} // namespace
+} // namespace aurora::gx::uber
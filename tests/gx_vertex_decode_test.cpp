@@ -0,0 +1,324 @@
+#include "gx_test_common.hpp"
+
+#include "gfx/resources.hpp"
+#include "gx/pipeline.hpp"
+#include "gx/vertex_decode.hpp"
+
+#include <array>
+#include <bit>
+#include <cstring>
+#include <vector>
+
+namespace aurora::gfx {
+extern gx::DrawData g_testLastDraw;
+extern uint32_t g_testDrawCount;
+extern std::vector<uint8_t> g_testStorage;
+extern std::vector<uint8_t> g_testResidentStorage;
+extern uint32_t g_testResidentUploads;
+} // namespace aurora::gfx
+
+namespace {
+namespace vertex_decode = aurora::gx::vertex_decode;
+using aurora::gx::VtxAttrFmt;
+
+std::vector<f32> decode(GXAttr attr, GXCompCnt cnt, GXCompType type, u8 frac, bool le, u32 stride,
+                        std::span<const u8> src) {
+  return vertex_decode::decode(attr, VtxAttrFmt{cnt, type, frac}, le, stride, src);
+}
+
+TEST(GXVertexDecode, FixedPointComponentsAreDequantized) {
+  constexpr std::array<u8, 3> u8Src{0x10, 0x20, 0xFF};
+  EXPECT_EQ(decode(GX_VA_POS, GX_POS_XYZ, GX_U8, 4, false, 3, u8Src), (std::vector<f32>{1.f, 2.f, 15.9375f}));
+
+  constexpr std::array<u8, 2> s8Src{0xC0, 0x40};
+  EXPECT_EQ(decode(GX_VA_TEX0, GX_TEX_ST, GX_S8, 6, false, 2, s8Src), (std::vector<f32>{-1.f, 1.f}));
+
+  constexpr std::array<u8, 4> u16Src{0x01, 0x00, 0xFF, 0xFF};
+  EXPECT_EQ(decode(GX_VA_TEX0, GX_TEX_ST, GX_U16, 8, false, 4, u16Src), (std::vector<f32>{1.f, 65535.f / 256.f}));
+
+  constexpr std::array<u8, 6> s16Src{0x00, 0xC0, 0x00, 0x40, 0xFF, 0xFF};
+  EXPECT_EQ(decode(GX_VA_NRM, GX_NRM_XYZ, GX_S16, 14, true, 6, s16Src),
+            (std::vector<f32>{-1.f, 1.f, -1.f / 16384.f}));
+}
+
+TEST(GXVertexDecode, FloatComponentsAreByteSwapped) {
+  constexpr std::array<u8, 8> src{0x3F, 0x80, 0x00, 0x00, 0xC0, 0x00, 0x00, 0x00};
+  EXPECT_EQ(decode(GX_VA_POS, GX_POS_XY, GX_F32, 0, false, 8, src), (std::vector<f32>{1.f, -2.f}));
+}
+
+TEST(GXVertexDecode, ColorsExpandToRGBA) {
+  constexpr std::array<u8, 2> rgb565{0xF8, 0x1F};
+  EXPECT_EQ(decode(GX_VA_CLR0, GX_CLR_RGB, GX_RGB565, 0, false, 2, rgb565), (std::vector<f32>{1.f, 0.f, 1.f, 1.f}));
+
+  constexpr std::array<u8, 2> rgba4{0xF0, 0x5A};
+  EXPECT_EQ(decode(GX_VA_CLR0, GX_CLR_RGBA, GX_RGBA4, 0, false, 2, rgba4),
+            (std::vector<f32>{1.f, 0.f, 5.f / 15.f, 10.f / 15.f}));
+
+  // r=63 g=0 b=21 a=42
+  constexpr u32 rgba6 = 63u << 18 | 21u << 6 | 42u;
+  constexpr std::array<u8, 3> rgba6Be{rgba6 >> 16, (rgba6 >> 8) & 0xFF, rgba6 & 0xFF};
+  constexpr std::array<u8, 3> rgba6Le{rgba6 & 0xFF, (rgba6 >> 8) & 0xFF, rgba6 >> 16};
+  const std::vector<f32> expected{1.f, 0.f, 21.f / 63.f, 42.f / 63.f};
+  EXPECT_EQ(decode(GX_VA_CLR1, GX_CLR_RGBA, GX_RGBA6, 0, false, 3, rgba6Be), expected);
+  EXPECT_EQ(decode(GX_VA_CLR1, GX_CLR_RGBA, GX_RGBA6, 0, true, 3, rgba6Le), expected);
+}
+
+TEST(GXVertexDecode, StrideSkipsInterleavedData) {
+  // Two elements of one u8 component each, interleaved with two bytes of other data
+  constexpr std::array<u8, 4> src{1, 0xAA, 0xBB, 2};
+  EXPECT_EQ(decode(GX_VA_TEX1, GX_TEX_S, GX_U8, 0, false, 3, src), (std::vector<f32>{1.f, 2.f}));
+}
+
+// Long enough for the vector paths, with a tail left for the scalar loop
+TEST(GXVertexDecode, PackedArraysMatchPerComponentDecode) {
+  constexpr u32 Count = 37;
+  std::array<u8, Count * 4> src{};
+  for (u32 i = 0; i < src.size(); ++i) {
+    src[i] = static_cast<u8>(i * 29 + 7);
+  }
+  const auto be16 = [&](u32 i) { return static_cast<u16>(src[i * 2] << 8 | src[i * 2 + 1]); };
+  const auto be32 = [&](u32 i) {
+    return static_cast<u32>(src[i * 4] << 24 | src[i * 4 + 1] << 16 | src[i * 4 + 2] << 8 | src[i * 4 + 3]);
+  };
+
+  const auto u8s = decode(GX_VA_TEX0, GX_TEX_S, GX_U8, 3, false, 1, {src.data(), Count});
+  const auto s8s = decode(GX_VA_TEX0, GX_TEX_S, GX_S8, 3, false, 1, {src.data(), Count});
+  const auto u16s = decode(GX_VA_TEX0, GX_TEX_S, GX_U16, 5, false, 2, {src.data(), Count * 2});
+  const auto s16s = decode(GX_VA_TEX0, GX_TEX_S, GX_S16, 5, false, 2, {src.data(), Count * 2});
+  const auto f32s = decode(GX_VA_TEX0, GX_TEX_S, GX_F32, 0, false, 4, src);
+  ASSERT_EQ(u8s.size(), Count);
+  ASSERT_EQ(s8s.size(), Count);
+  ASSERT_EQ(u16s.size(), Count);
+  ASSERT_EQ(s16s.size(), Count);
+  ASSERT_EQ(f32s.size(), Count);
+  for (u32 i = 0; i < Count; ++i) {
+    EXPECT_EQ(u8s[i], static_cast<f32>(src[i]) / 8.f) << i;
+    EXPECT_EQ(s8s[i], static_cast<f32>(static_cast<s8>(src[i])) / 8.f) << i;
+    EXPECT_EQ(u16s[i], static_cast<f32>(be16(i)) / 32.f) << i;
+    EXPECT_EQ(s16s[i], static_cast<f32>(static_cast<s16>(be16(i))) / 32.f) << i;
+    EXPECT_EQ(std::bit_cast<u32>(f32s[i]), be32(i)) << i;
+  }
+
+  // Little-endian arrays aren't swapped
+  const auto s16Le = decode(GX_VA_TEX0, GX_TEX_S, GX_S16, 0, true, 2, {src.data(), Count * 2});
+  ASSERT_EQ(s16Le.size(), Count);
+  for (u32 i = 0; i < Count; ++i) {
+    EXPECT_EQ(s16Le[i], static_cast<f32>(static_cast<s16>(src[i * 2] | src[i * 2 + 1] << 8))) << i;
+  }
+}
+
+TEST(GXVertexDecode, OnlyFetchHeavyFormatsAreSupported) {
+  EXPECT_TRUE(vertex_decode::supported(GX_VA_POS, {GX_POS_XYZ, GX_S16, 0}));
+  EXPECT_TRUE(vertex_decode::supported(GX_VA_CLR0, {GX_CLR_RGB, GX_RGB565, 0}));
+  EXPECT_FALSE(vertex_decode::supported(GX_VA_CLR0, {GX_CLR_RGBA, GX_RGBA8, 0}));
+  EXPECT_FALSE(vertex_decode::supported(GX_VA_NRM, {GX_NRM_NBT, GX_S16, 0}));
+  EXPECT_FALSE(vertex_decode::supported(GX_VA_PNMTXIDX, {GX_POS_XYZ, GX_U8, 0}));
+}
+
+class GXVertexDecodeCacheTest : public GXFifoTest {
+protected:
+  static constexpr VtxAttrFmt PosFmt{GX_POS_XYZ, GX_S16, 8};
+
+  void SetUp() override {
+    GXFifoTest::SetUp();
+    vertex_decode::clear();
+    vertex_decode::set_budget(1024);
+    aurora::gfx::g_testResidentStorage.clear();
+    aurora::gfx::g_testResidentUploads = 0;
+  }
+
+  void TearDown() override {
+    vertex_decode::set_budget(0);
+    vertex_decode::clear();
+    GXFifoTest::TearDown();
+  }
+
+  static aurora::gx::AttrArray array_of(std::span<const u8> data) {
+    return {.data = data.data(), .size = static_cast<u32>(data.size()), .stride = 6, .le = false};
+  }
+
+  static aurora::gfx::Range find(const aurora::gx::AttrArray& array) {
+    return vertex_decode::find(GX_VA_POS, PosFmt, array);
+  }
+
+  // The decoded contents of a range returned by find
+  static std::vector<f32> resident(aurora::gfx::Range range) {
+    EXPECT_GE(range.offset, aurora::gfx::StorageBufferSize);
+    const size_t offset = range.offset - aurora::gfx::StorageBufferSize;
+    EXPECT_LE(offset + range.size, aurora::gfx::g_testResidentStorage.size());
+    std::vector<f32> out(range.size / sizeof(f32));
+    std::memcpy(out.data(), aurora::gfx::g_testResidentStorage.data() + offset, range.size);
+    return out;
+  }
+
+  static void next_frame() {
+    for (auto& array : aurora::gx::g_gxState.arrays) {
+      array.cachedRange = {};
+    }
+    vertex_decode::end_frame();
+  }
+};
+
+TEST_F(GXVertexDecodeCacheTest, ArraysUsedInConsecutiveFramesAreDecoded) {
+  constexpr std::array<u8, 12> data{0x01, 0x00, 0x02, 0x00, 0x03, 0x00, 0x04, 0x00, 0x05, 0x00, 0x06, 0x00};
+  const auto array = array_of(data);
+  EXPECT_EQ(find(array).size, 0u);
+  next_frame();
+  const auto range = find(array);
+  ASSERT_EQ(range.size, 6 * sizeof(f32));
+  EXPECT_EQ(range.offset % 16, 0u);
+  EXPECT_EQ(resident(range), (std::vector<f32>{1.f, 2.f, 3.f, 4.f, 5.f, 6.f}));
+  EXPECT_EQ(vertex_decode::resident_bytes(), 6 * sizeof(f32));
+}
+
+TEST_F(GXVertexDecodeCacheTest, ResidentArraysAreUploadedOnce) {
+  constexpr std::array<u8, 6> data{0x01, 0x00, 0x02, 0x00, 0x03, 0x00};
+  const auto array = array_of(data);
+  find(array);
+  next_frame();
+  const auto range = find(array);
+  ASSERT_NE(range.size, 0u);
+  for (int frame = 0; frame < 3; ++frame) {
+    next_frame();
+    EXPECT_EQ(find(array), range);
+  }
+  EXPECT_EQ(aurora::gfx::g_testResidentUploads, 1u);
+}
+
+TEST_F(GXVertexDecodeCacheTest, SkippedFramesResetHotness) {
+  constexpr std::array<u8, 6> data{0x01, 0x00, 0x02, 0x00, 0x03, 0x00};
+  const auto array = array_of(data);
+  EXPECT_EQ(find(array).size, 0u);
+  next_frame();
+  next_frame();
+  EXPECT_EQ(find(array).size, 0u);
+}
+
+TEST_F(GXVertexDecodeCacheTest, BudgetEvictsLeastRecentlyUsed) {
+  vertex_decode::set_budget(2 * 3 * sizeof(f32));
+  std::array<std::array<u8, 6>, 3> data{};
+  for (u8 i = 0; i < data.size(); ++i) {
+    data[i][1] = i;
+  }
+  for (int frame = 0; frame < 2; ++frame) {
+    for (const auto& item : data) {
+      find(array_of(item));
+    }
+    next_frame();
+  }
+  // All three were hot, but only the last two fit
+  EXPECT_EQ(vertex_decode::resident_bytes(), 2 * 3 * sizeof(f32));
+  const auto uploads = aurora::gfx::g_testResidentUploads;
+  EXPECT_NE(find(array_of(data[2])).size, 0u);
+  EXPECT_NE(find(array_of(data[1])).size, 0u);
+  EXPECT_EQ(aurora::gfx::g_testResidentUploads, uploads);
+
+  // data[2] is now the least recently used
+  vertex_decode::set_budget(3 * sizeof(f32));
+  next_frame();
+  EXPECT_EQ(vertex_decode::resident_bytes(), 3 * sizeof(f32));
+  EXPECT_NE(find(array_of(data[1])).size, 0u);
+  EXPECT_EQ(aurora::gfx::g_testResidentUploads, uploads);
+}
+
+TEST_F(GXVertexDecodeCacheTest, EvictedSpaceIsReusedFromTheNextFrame) {
+  vertex_decode::set_budget(3 * sizeof(f32));
+  std::array<std::array<u8, 6>, 2> data{};
+  data[1][1] = 1;
+  find(array_of(data[0]));
+  next_frame();
+  const auto first = find(array_of(data[0]));
+  ASSERT_NE(first.size, 0u);
+  find(array_of(data[1]));
+  next_frame();
+
+  // Evicting the first array can't hand its space to the second in the same frame, since earlier draws may read it
+  const auto second = find(array_of(data[1]));
+  ASSERT_NE(second.size, 0u);
+  EXPECT_NE(second.offset, first.offset);
+  EXPECT_EQ(vertex_decode::resident_bytes(), 3 * sizeof(f32));
+
+  find(array_of(data[0]));
+  next_frame();
+  EXPECT_EQ(find(array_of(data[0])).offset, first.offset);
+}
+
+TEST_F(GXVertexDecodeCacheTest, InvalidationRedecodesRewrittenArrays) {
+  std::array<u8, 6> data{0x01, 0x00, 0x02, 0x00, 0x03, 0x00};
+  constexpr std::array<u8, 6> other{0x04, 0x00, 0x05, 0x00, 0x06, 0x00};
+  const auto array = array_of(data);
+  const auto otherArray = array_of(other);
+  for (int frame = 0; frame < 2; ++frame) {
+    find(array);
+    find(otherArray);
+    next_frame();
+  }
+  const auto range = find(array);
+  const auto otherRange = find(otherArray);
+  const auto uploads = aurora::gfx::g_testResidentUploads;
+
+  // Rewrites aren't noticed without an invalidation
+  data[1] = 0x80;
+  next_frame();
+  EXPECT_EQ(find(array), range);
+  EXPECT_EQ(resident(range), (std::vector<f32>{1.f, 2.f, 3.f}));
+
+  vertex_decode::invalidate();
+  next_frame();
+  const auto rewritten = find(array);
+  ASSERT_NE(rewritten.size, 0u);
+  EXPECT_NE(rewritten.offset, range.offset);
+  EXPECT_EQ(resident(rewritten), (std::vector<f32>{1.5f, 2.f, 3.f}));
+  // Unchanged arrays are only re-hashed
+  EXPECT_EQ(find(otherArray), otherRange);
+  EXPECT_EQ(aurora::gfx::g_testResidentUploads, uploads + 1);
+}
+
+TEST_F(GXVertexDecodeCacheTest, DisabledWithoutBudget) {
+  vertex_decode::set_budget(0);
+  constexpr std::array<u8, 6> data{0x01, 0x00, 0x02, 0x00, 0x03, 0x00};
+  const auto array = array_of(data);
+  find(array);
+  next_frame();
+  EXPECT_EQ(find(array).size, 0u);
+}
+
+TEST_F(GXVertexDecodeCacheTest, HotArraysAreBoundFromResidentStorage) {
+  // Big-endian s16 positions with 8 fractional bits: (1, 2, 3)
+  static constexpr std::array<u8, 6> positions{0x01, 0x00, 0x02, 0x00, 0x03, 0x00};
+  GXClearVtxDesc();
+  GXSetVtxDesc(GX_VA_POS, GX_INDEX8);
+  GXSetVtxAttrFmt(GX_VTXFMT0, GX_VA_POS, GX_POS_XYZ, GX_S16, 8);
+  GXSetArray(GX_VA_POS, positions.data(), positions.size(), 6, false);
+  decode_fifo(flush_and_capture());
+
+  const auto draw = [&] {
+    aurora::gfx::g_testStorage.clear();
+    GXBegin(GX_TRIANGLES, GX_VTXFMT0, 3);
+    for (int i = 0; i < 3; ++i) {
+      GXPosition1x8(0);
+    }
+    GXEnd();
+    decode_fifo(capture_fifo());
+  };
+
+  draw();
+  EXPECT_EQ(aurora::gfx::g_testStorage, std::vector<u8>(positions.begin(), positions.end()));
+  EXPECT_FALSE(gxState().arrays[GX_VA_POS].predecoded);
+
+  next_frame();
+  draw();
+  // Nothing is pushed to the frame's storage; the draw reads the resident copy
+  EXPECT_TRUE(aurora::gfx::g_testStorage.empty());
+  EXPECT_TRUE(gxState().arrays[GX_VA_POS].predecoded);
+  const auto range = gxState().arrays[GX_VA_POS].cachedRange;
+  EXPECT_EQ(aurora::gfx::g_testLastDraw.immediateData.arrayStart[0], range.offset);
+  EXPECT_EQ(resident(range), (std::vector<f32>{1.f, 2.f, 3.f}));
+
+  next_frame();
+  draw();
+  EXPECT_EQ(gxState().arrays[GX_VA_POS].cachedRange, range);
+  EXPECT_EQ(aurora::gfx::g_testResidentUploads, 1u);
+}
+
+} // namespace
@@ -0,0 +1,211 @@
+#include <gtest/gtest.h>
+
+#include "logging.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace aurora {
+namespace {
+
+struct Entry {
+  AuroraLogLevel level;
+  std::string module;
+  std::string message;
+  std::thread::id thread;
+};
+
+std::mutex g_entriesMutex;
+std::vector<Entry> g_entries;
+
+void capture(AuroraLogLevel level, const char* module, const char* message, unsigned int len) {
+  std::lock_guard lock{g_entriesMutex};
+  g_entries.push_back({level, module, std::string{message, len}, std::this_thread::get_id()});
+}
+
+std::vector<std::string> messages() {
+  std::lock_guard lock{g_entriesMutex};
+  std::vector<std::string> ret;
+  for (const auto& entry : g_entries) {
+    ret.push_back(entry.message);
+  }
+  return ret;
+}
+
+class LoggingTest : public testing::Test {
+protected:
+  void SetUp() override {
+    g_config.logCallback = capture;
+    g_config.logLevel = LOG_DEBUG;
+    g_entries.clear();
+  }
+
+  void TearDown() override {
+    set_async_logging(false);
+    g_config.logCallback = nullptr;
+  }
+};
+
+constexpr Module Log{"aurora::test"};
+
+TEST_F(LoggingTest, SynchronousByDefault) {
+  Log.warn("value {}", 42);
+  ASSERT_EQ(g_entries.size(), 1u);
+  EXPECT_EQ(g_entries[0].level, LOG_WARNING);
+  EXPECT_EQ(g_entries[0].module, "aurora::test");
+  EXPECT_EQ(g_entries[0].message, "value 42");
+  EXPECT_EQ(g_entries[0].thread, std::this_thread::get_id());
+}
+
+TEST_F(LoggingTest, AsyncKeepsEveryMessageInOrderPerThread) {
+  constexpr int Threads = 4;
+  // Far more than one ring holds, so producers also drain full rings themselves.
+  constexpr int MessagesPerThread = 5000;
+  set_async_logging(true);
+  std::vector<std::thread> threads;
+  for (int thread = 0; thread < Threads; ++thread) {
+    threads.emplace_back([thread] {
+      for (int i = 0; i < MessagesPerThread; ++i) {
+        Log.info("thread {} message {}", thread, i);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  flush_logs();
+
+  std::vector<int> next(Threads, 0);
+  for (const auto& message : messages()) {
+    int thread = 0;
+    int i = 0;
+    ASSERT_EQ(std::sscanf(message.c_str(), "thread %d message %d", &thread, &i), 2) << message;
+    EXPECT_EQ(i, next[thread]++);
+  }
+  for (const int count : next) {
+    EXPECT_EQ(count, MessagesPerThread);
+  }
+}
+
+TEST_F(LoggingTest, RepeatedMessagesAreSummarized) {
+  set_async_logging(true);
+  for (int i = 0; i < 100; ++i) {
+    Log.warn("texture {} failed", 7);
+  }
+  Log.warn("other");
+  for (int i = 0; i < 5; ++i) {
+    Log.error("pipeline failed");
+  }
+  flush_logs();
+
+  const std::vector<std::string> expected{
+      "texture 7 failed",
+      "Previous message repeated 99 times",
+      "other",
+      "pipeline failed",
+      "Previous message repeated 4 times",
+  };
+  EXPECT_EQ(messages(), expected);
+  EXPECT_EQ(g_entries[1].level, LOG_WARNING);
+  EXPECT_EQ(g_entries[4].level, LOG_ERROR);
+}
+
+TEST_F(LoggingTest, RepeatsAreCountedOnceWhileFlushing) {
+  constexpr int Runs = 10000;
+  constexpr int RepeatsPerRun = 4;
+  set_async_logging(true);
+  std::atomic_bool done = false;
+  // Forced drains report repeats while the producer is still adding to them or moving on to the next message.
+  std::thread flusher{[&done] {
+    while (!done.load(std::memory_order_relaxed)) {
+      flush_logs();
+    }
+  }};
+  for (int run = 0; run < Runs; ++run) {
+    for (int i = 0; i < RepeatsPerRun; ++i) {
+      Log.info("run {}", run);
+    }
+  }
+  done = true;
+  flusher.join();
+  flush_logs();
+
+  int run = -1;
+  std::vector<int> repeats(Runs, 0);
+  for (const auto& message : messages()) {
+    int value = 0;
+    if (std::sscanf(message.c_str(), "Previous message repeated %d times", &value) == 1) {
+      ASSERT_GE(run, 0);
+      repeats[run] += value;
+    } else {
+      ASSERT_EQ(std::sscanf(message.c_str(), "run %d", &value), 1) << message;
+      EXPECT_EQ(value, run + 1);
+      run = value;
+    }
+  }
+  EXPECT_EQ(run, Runs - 1);
+  for (const int count : repeats) {
+    EXPECT_EQ(count, RepeatsPerRun - 1);
+  }
+}
+
+TEST_F(LoggingTest, RecordsWrapAtEveryOffset) {
+  // Mirrors the ring in logging.cpp: records are a 16-byte header followed by the NUL-terminated module and message.
+  constexpr size_t RingSize = 65536;
+  constexpr size_t HeaderSize = 16;
+  constexpr size_t Chunk = RingSize / 8;
+  set_async_logging(true);
+  int index = 0;
+  std::vector<std::string> expected;
+  const auto log_record = [&](size_t recordSize) {
+    std::string message(recordSize - HeaderSize - 2, static_cast<char>('a' + index % 26));
+    const std::string number = std::to_string(index++);
+    message.replace(0, number.size(), number);
+    log_internal(LOG_INFO, "", message.c_str(), static_cast<unsigned int>(message.size()));
+    expected.push_back(std::move(message));
+  };
+
+  // Once one of them wraps, whole chunks keep the head at a multiple of Chunk.
+  for (int i = 0; i < 8; ++i) {
+    log_record(Chunk);
+  }
+  for (size_t filler = 24; filler <= Chunk + 16; filler += 8) {
+    // One of the chunks that follow wraps with Chunk - filler % Chunk bytes left at the end of the ring.
+    log_record(filler);
+    for (int i = 0; i < 8; ++i) {
+      log_record(Chunk);
+    }
+    flush_logs();
+    ASSERT_EQ(messages(), expected) << "filler " << filler;
+    std::lock_guard lock{g_entriesMutex};
+    g_entries.clear();
+    expected.clear();
+  }
+}
+
+TEST_F(LoggingTest, FatalWritesQueuedMessagesFirst) {
+  set_async_logging(true);
+  Log.info("before");
+  const std::string message = "fatal";
+  log_internal(LOG_FATAL, Log.name, message.c_str(), static_cast<unsigned int>(message.size()));
+
+  // Written before log_internal returns, without a flush.
+  const std::vector<std::string> expected{"before", "fatal"};
+  EXPECT_EQ(messages(), expected);
+  EXPECT_EQ(g_entries[1].thread, std::this_thread::get_id());
+}
+
+TEST_F(LoggingTest, DisablingFlushesQueuedMessages) {
+  set_async_logging(true);
+  Log.info("queued");
+  set_async_logging(false);
+  const std::vector<std::string> expected{"queued"};
+  EXPECT_EQ(messages(), expected);
+}
+
+} // namespace
+} // namespace aurora
@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+
+#include "dolphin/pad/pad_sampler.hpp"
+
+#include <atomic>
+#include <thread>
+
+namespace aurora::pad {
+namespace {
+
+constexpr uint32_t Device = 7;
+constexpr uint32_t ButtonA = 1u << 0;
+constexpr uint32_t ButtonB = 1u << 1;
+
+NativeSample sample(uint64_t timestampNs, uint32_t buttons, int16_t leftX = 0, int16_t leftTrigger = 0) {
+  NativeSample ret{.timestampNs = timestampNs, .buttons = buttons};
+  ret.axes[0] = leftX;
+  ret.axes[LeftTriggerAxis] = leftTrigger;
+  return ret;
+}
+
+NativeSample consume(SampleHistory& history, uint64_t nowNs) {
+  NativeSample out;
+  EXPECT_TRUE(history.consume(nowNs, out));
+  return out;
+}
+
+TEST(PadSamplerTest, EmptyHistoryFallsBackToDirectRead) {
+  SampleHistory history;
+  history.reset(Device);
+  NativeSample out;
+  EXPECT_FALSE(history.consume(1000, out));
+}
+
+TEST(PadSamplerTest, TapBetweenReadsIsReported) {
+  SampleHistory history;
+  history.reset(Device);
+  history.push(Device, sample(1000, 0));
+  EXPECT_EQ(consume(history, 1500).buttons, 0u);
+
+  // Pressed and released again within one frame.
+  history.push(Device, sample(2000, ButtonA));
+  history.push(Device, sample(3000, 0));
+  EXPECT_EQ(consume(history, 16000).buttons, ButtonA);
+  // The release shows up on the following read, even with no new samples.
+  EXPECT_EQ(consume(history, 32000).buttons, 0u);
+}
+
+TEST(PadSamplerTest, ReleaseBetweenReadsIsReported) {
+  SampleHistory history;
+  history.reset(Device);
+  history.push(Device, sample(1000, ButtonA | ButtonB));
+  EXPECT_EQ(consume(history, 1500).buttons, ButtonA | ButtonB);
+
+  // A is released and pressed again within one frame; B stays held.
+  history.push(Device, sample(2000, ButtonB));
+  history.push(Device, sample(3000, ButtonA | ButtonB));
+  EXPECT_EQ(consume(history, 16000).buttons, ButtonB);
+
+  history.push(Device, sample(17000, ButtonA | ButtonB));
+  EXPECT_EQ(consume(history, 32000).buttons, ButtonA | ButtonB);
+}
+
+TEST(PadSamplerTest, SticksUseNewestAndTriggersKeepPeak) {
+  SampleHistory history;
+  history.reset(Device);
+  history.push(Device, sample(1000, 0, 1000, 0));
+  history.push(Device, sample(2000, 0, 20000, 32000));
+  history.push(Device, sample(3000, 0, -5000, 100));
+  auto out = consume(history, 4000);
+  EXPECT_EQ(out.axes[0], -5000);
+  EXPECT_EQ(out.axes[LeftTriggerAxis], 32000);
+
+  // Once reported, a lower trigger value is passed through.
+  history.push(Device, sample(5000, 0, -5000, 100));
+  out = consume(history, 6000);
+  EXPECT_EQ(out.axes[LeftTriggerAxis], 100);
+}
+
+TEST(PadSamplerTest, TracksLatencyAndSampleCount) {
+  SampleHistory history;
+  history.reset(Device);
+  for (uint64_t t = 1000; t <= 8000; t += 1000) {
+    history.push(Device, sample(t, 0));
+  }
+  consume(history, 8500);
+  auto stats = history.stats();
+  EXPECT_EQ(stats.lastSampleCount, 8u);
+  EXPECT_EQ(stats.lastLatencyNs, 500u);
+  EXPECT_EQ(stats.maxLatencyNs, 500u);
+
+  // No new samples: the newest one is now older.
+  consume(history, 12000);
+  stats = history.stats();
+  EXPECT_EQ(stats.lastSampleCount, 0u);
+  EXPECT_EQ(stats.lastLatencyNs, 4000u);
+  EXPECT_EQ(stats.maxLatencyNs, 4000u);
+
+  history.push(Device, sample(13000, 0));
+  consume(history, 13100);
+  stats = history.stats();
+  EXPECT_EQ(stats.lastLatencyNs, 100u);
+  EXPECT_EQ(stats.maxLatencyNs, 4000u);
+}
+
+TEST(PadSamplerTest, OverflowKeepsEdgesOfDroppedSamples) {
+  SampleHistory history;
+  history.reset(Device);
+  history.push(Device, sample(0, 0));
+  consume(history, 0);
+
+  // The tap is overwritten long before the next read.
+  history.push(Device, sample(1, ButtonA));
+  for (uint64_t t = 2; t < 2 + SampleHistory::Capacity * 2; ++t) {
+    history.push(Device, sample(t, 0));
+  }
+  EXPECT_EQ(consume(history, 1000).buttons, ButtonA);
+  const auto stats = history.stats();
+  EXPECT_EQ(stats.overflowCount, SampleHistory::Capacity + 1);
+  EXPECT_EQ(stats.lastSampleCount, 2 * SampleHistory::Capacity + 1);
+}
+
+TEST(PadSamplerTest, ResetDropsSamplesFromOtherDevices) {
+  SampleHistory history;
+  history.reset(Device);
+  history.push(Device, sample(1000, ButtonA));
+  history.reset(Device + 1);
+  NativeSample out;
+  EXPECT_FALSE(history.consume(2000, out));
+
+  // Late samples from the old device are ignored.
+  history.push(Device, sample(3000, ButtonA));
+  history.push(Device + 1, sample(3000, ButtonB));
+  EXPECT_EQ(consume(history, 4000).buttons, ButtonB);
+  EXPECT_EQ(history.device(), Device + 1);
+}
+
+TEST(PadSamplerTest, ConcurrentProducerNeverLosesEdges) {
+  // Mirrors the sampler thread with a button that flips on every sample, so any read covering two or more samples
+  // saw both a press and a release and must report the opposite of the previous read.
+  constexpr int Reads = 200;
+  SampleHistory history;
+  history.reset(Device);
+  std::atomic_bool done{false};
+  std::thread producer([&] {
+    for (uint64_t t = 1; !done.load(std::memory_order_relaxed); ++t) {
+      history.push(Device, sample(t, (t & 1) != 0 ? ButtonA : 0));
+      std::this_thread::yield();
+    }
+  });
+
+  uint32_t previous = 0;
+  int checked = 0;
+  while (checked < Reads) {
+    NativeSample out;
+    if (!history.consume(0, out)) {
+      continue;
+    }
+    if (history.stats().lastSampleCount >= 2) {
+      EXPECT_NE(out.buttons & ButtonA, previous & ButtonA);
+      ++checked;
+    }
+    previous = out.buttons;
+  }
+  done = true;
+  producer.join();
+}
+
+} // namespace
+} // namespace aurora::pad
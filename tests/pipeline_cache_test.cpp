@@ -0,0 +1,195 @@
+#include "gfx/clear.hpp"
+#include "gfx/pipeline_cache.hpp"
+#include "internal.hpp"
+#include "io.hpp"
+
+#include <gtest/gtest.h>
+#include <sqlite3.h>
+
+#include <array>
+#include <atomic>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace aurora::gfx {
+extern uint32_t g_testCreatedPipelines;
+} // namespace aurora::gfx
+
+namespace {
+using namespace aurora::gfx;
+
+class PipelineCacheTest : public testing::Test {
+protected:
+  void SetUp() override {
+    static std::atomic_uint64_t counter{0};
+    m_directory = std::filesystem::temp_directory_path() /
+                  ("aurora-pipeline-cache-test-" + std::to_string(counter.fetch_add(1, std::memory_order_relaxed)));
+    ASSERT_TRUE(aurora::io::create_directories(m_directory / "cache"));
+    ASSERT_TRUE(aurora::io::create_directories(m_directory / "resources"));
+    use_cache("cache");
+    m_resourcesPath = aurora::io::fs_path_to_string(m_directory / "resources");
+    aurora::g_config.resourcesPath = m_resourcesPath.c_str();
+    g_testCreatedPipelines = 0;
+    initialize_pipeline_cache();
+  }
+
+  void TearDown() override {
+    shutdown_pipeline_cache();
+    aurora::g_config.cachePath = nullptr;
+    aurora::g_config.resourcesPath = nullptr;
+    std::error_code error;
+    std::filesystem::remove_all(m_directory, error);
+  }
+
+  void use_cache(std::string_view name) {
+    m_cachePath = aurora::io::fs_path_to_string(m_directory / name);
+    aurora::g_config.cachePath = m_cachePath.c_str();
+  }
+
+  static void restart() {
+    shutdown_pipeline_cache();
+    initialize_pipeline_cache();
+  }
+
+  // Runs frames until the compile queues are empty; pipelines are built a few per frame without a compile thread
+  static void build_pending() {
+    uint32_t created = 0;
+    do {
+      created = g_testCreatedPipelines;
+      begin_pipeline_frame();
+      end_pipeline_frame();
+    } while (g_testCreatedPipelines != created);
+  }
+
+  static PipelineRef request(uint64_t key) {
+    clear::PipelineConfig config{};
+    config.targetLayoutKey = key;
+    return find_pipeline(ShaderType::Clear, config, [] { return wgpu::RenderPipeline{}; });
+  }
+
+  static std::optional<AuroraPipelineTagStats> stats(std::string_view tag) {
+    std::array<AuroraPipelineTagStats, 8> out{};
+    const size_t count = copy_pipeline_tag_stats(out);
+    for (size_t i = 0; i < count; ++i) {
+      if (out[i].tag == tag) {
+        return out[i];
+      }
+    }
+    return std::nullopt;
+  }
+
+  void exec(const std::filesystem::path& path, const char* sql) const {
+    sqlite3* db = nullptr;
+    ASSERT_EQ(sqlite3_open(aurora::io::fs_path_to_string(path).c_str(), &db), SQLITE_OK);
+    EXPECT_EQ(sqlite3_exec(db, sql, nullptr, nullptr, nullptr), SQLITE_OK) << sqlite3_errmsg(db);
+    sqlite3_close(db);
+  }
+
+  std::filesystem::path m_directory;
+  std::string m_cachePath;
+  std::string m_resourcesPath;
+};
+
+TEST_F(PipelineCacheTest, TagsPersistAcrossSessions) {
+  set_pipeline_tag("title");
+  request(1);
+  request(2);
+  set_pipeline_tag("level");
+  request(2);
+  request(3);
+  set_pipeline_tag({});
+  request(4);
+  restart();
+
+  EXPECT_EQ(pipeline_tag_count(), 2u);
+  const auto title = stats("title");
+  ASSERT_TRUE(title);
+  EXPECT_EQ(title->pipelineCount, 2u);
+  const auto level = stats("level");
+  ASSERT_TRUE(level);
+  EXPECT_EQ(level->pipelineCount, 2u);
+  EXPECT_EQ(level->prefetchedPipelines, 0u);
+}
+
+TEST_F(PipelineCacheTest, TagsOfPrunedPipelinesAreDropped) {
+  set_pipeline_tag("title");
+  request(1);
+  set_pipeline_tag({});
+  shutdown_pipeline_cache();
+
+  exec(m_directory / "cache" / "pipeline_cache.db",
+       "INSERT INTO pipeline_tags (tag, type, hash) VALUES ('title', 0, 57005), ('orphan', 0, 48879)");
+  initialize_pipeline_cache();
+
+  EXPECT_EQ(pipeline_tag_count(), 1u);
+  const auto title = stats("title");
+  ASSERT_TRUE(title);
+  EXPECT_EQ(title->pipelineCount, 1u);
+  EXPECT_FALSE(stats("orphan"));
+}
+
+TEST_F(PipelineCacheTest, BundledTagsAreMergedIntoTheCache) {
+  // Record the bundled cache in one session, then start from a different cache with its own tags
+  set_pipeline_tag("title");
+  request(1);
+  request(2);
+  set_pipeline_tag({});
+  shutdown_pipeline_cache();
+  std::filesystem::copy_file(m_directory / "cache" / "pipeline_cache.db",
+                             m_directory / "resources" / "initial_pipeline_cache.db");
+
+  use_cache("user");
+  ASSERT_TRUE(aurora::io::create_directories(m_directory / "user"));
+  initialize_pipeline_cache();
+  set_pipeline_tag("level");
+  request(3);
+  set_pipeline_tag({});
+  g_testCreatedPipelines = 0;
+  restart();
+  build_pending();
+
+  EXPECT_EQ(g_testCreatedPipelines, 3u);
+  EXPECT_EQ(pipeline_tag_count(), 2u);
+  const auto title = stats("title");
+  ASSERT_TRUE(title);
+  EXPECT_EQ(title->pipelineCount, 2u);
+  const auto level = stats("level");
+  ASSERT_TRUE(level);
+  EXPECT_EQ(level->pipelineCount, 1u);
+}
+
+TEST_F(PipelineCacheTest, PrefetchCountsOnlyPendingPipelines) {
+  set_pipeline_tag("level");
+  for (uint64_t key = 1; key <= 8; ++key) {
+    request(key);
+  }
+  set_pipeline_tag({});
+
+  // The first pipelines loaded are built during startup; the rest wait in the background queue
+  g_testCreatedPipelines = 0;
+  restart();
+  ASSERT_LT(g_testCreatedPipelines, 8u);
+  const uint32_t pending = 8 - g_testCreatedPipelines;
+  EXPECT_EQ(prefetch_pipelines("missing"), 0u);
+  EXPECT_EQ(prefetch_pipelines("level"), pending);
+
+  // Built before the prefetch, so neither a hit nor a miss
+  EXPECT_TRUE(has_pipeline(request(1)));
+  // Still pending
+  EXPECT_FALSE(has_pipeline(request(8)));
+  build_pending();
+  EXPECT_TRUE(has_pipeline(request(7)));
+  // Settled prefetches aren't counted again
+  EXPECT_TRUE(has_pipeline(request(8)));
+
+  const auto level = stats("level");
+  ASSERT_TRUE(level);
+  EXPECT_EQ(level->pipelineCount, 8u);
+  EXPECT_EQ(level->prefetchedPipelines, pending);
+  EXPECT_EQ(level->prefetchHits, 1u);
+  EXPECT_EQ(level->prefetchMisses, 1u);
+}
+
+} // namespace
@@ -0,0 +1,44 @@
+#include "gfx/clear.hpp"
+#include "gfx/resources.hpp"
+#include "gx/pipeline.hpp"
+#include "webgpu/gpu.hpp"
+
+namespace aurora::webgpu {
+// No compile thread; pipelines are only built on lookup and in end_pipeline_frame, as with the browser backend
+wgpu::BackendType g_backendType = wgpu::BackendType::WebGPU;
+
+void cache_prune() {}
+} // namespace aurora::webgpu
+
+namespace aurora::gfx::detail {
+Resources& resources() noexcept {
+  static Resources resources;
+  return resources;
+}
+} // namespace aurora::gfx::detail
+
+namespace aurora::gfx {
+uint32_t g_testCurrentFrame = 0;
+uint32_t g_testCreatedPipelines = 0;
+
+uint32_t current_frame() noexcept { return g_testCurrentFrame; }
+
+namespace clear {
+wgpu::RenderPipeline create_pipeline(const PipelineConfig&) {
+  ++g_testCreatedPipelines;
+  return {};
+}
+} // namespace clear
+} // namespace aurora::gfx
+
+namespace aurora::gx {
+wgpu::RenderPipeline create_pipeline(const PipelineConfig&) {
+  ++gfx::g_testCreatedPipelines;
+  return {};
+}
+
+wgpu::RenderPipeline create_uber_pipeline(const PipelineConfig&) {
+  ++gfx::g_testCreatedPipelines;
+  return {};
+}
+} // namespace aurora::gx
@@ -0,0 +1,156 @@
+#include "rmlui/blur_plan.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+namespace {
+using namespace aurora::rmlui;
+
+// The passes RenderBlur recorded before large blurs were upsampled progressively: every level is stretched back up in
+// a single upscale.
+std::vector<BlurPass> single_upscale_passes(float sigma, Rml::Rectanglei scissor) {
+  std::vector<BlurPass> passes;
+  int passLevel = 0;
+  sigma_to_params(sigma, passLevel, sigma);
+  const Rml::Rectanglei originalScissor = scissor;
+  for (int i = 0; i < passLevel; ++i) {
+    scissor = downsample_scissor(scissor);
+    passes.push_back({.kind = BlurPassKind::Downsample, .toTemp = (i % 2) == 0, .region = scissor});
+  }
+  if ((passLevel % 2) == 0) {
+    passes.push_back({.kind = BlurPassKind::Transfer, .toTemp = true, .region = scissor});
+  }
+  passes.push_back({.kind = BlurPassKind::VerticalBlur, .toTemp = false, .region = scissor, .sourceRegion = scissor});
+  passes.push_back({.kind = BlurPassKind::HorizontalBlur, .toTemp = true, .region = scissor, .sourceRegion = scissor});
+  passes.push_back(
+      {.kind = BlurPassKind::Upscale, .toTemp = false, .region = originalScissor, .sourceRegion = scissor});
+  const auto targetRegion = Rml::Rectanglei::FromCorners(scissor.p0 * (1 << passLevel), scissor.p1 * (1 << passLevel));
+  if (targetRegion.p0 != originalScissor.p0 || targetRegion.p1 != originalScissor.p1) {
+    passes.push_back(
+        {.kind = BlurPassKind::PowerOfTwoUpscale, .toTemp = false, .region = targetRegion, .sourceRegion = scissor});
+  }
+  return passes;
+}
+
+bool same_region(Rml::Rectanglei a, Rml::Rectanglei b) { return a.p0 == b.p0 && a.p1 == b.p1; }
+
+void expect_same_passes(const std::vector<BlurPass>& actual, const std::vector<BlurPass>& expected, float sigma) {
+  ASSERT_EQ(actual.size(), expected.size()) << "sigma " << sigma;
+  for (size_t i = 0; i < actual.size(); ++i) {
+    EXPECT_EQ(actual[i].kind, expected[i].kind) << "sigma " << sigma << ", pass " << i;
+    EXPECT_EQ(actual[i].toTemp, expected[i].toTemp) << "sigma " << sigma << ", pass " << i;
+    EXPECT_TRUE(same_region(actual[i].region, expected[i].region)) << "sigma " << sigma << ", pass " << i;
+    EXPECT_TRUE(same_region(actual[i].sourceRegion, expected[i].sourceRegion)) << "sigma " << sigma << ", pass " << i;
+  }
+}
+
+const std::array Scissors{
+    Rml::Rectanglei::FromCorners({0, 0}, {640, 480}),
+    Rml::Rectanglei::FromCorners({3, 5}, {317, 203}),
+    Rml::Rectanglei::FromCorners({101, 77}, {102, 79}),
+};
+
+TEST(RmlUiBlurPlanTest, SigmaIsSplitIntoDownsampleLevels) {
+  struct Case {
+    float desired;
+    int passLevel;
+    float sigma;
+  };
+  constexpr std::array Cases{
+      Case{0.5f, 0, 0.5f},   Case{1.5f, 0, 1.5f}, Case{3.f, 1, 1.5f},
+      Case{4.f, 1, 2.f},     Case{6.f, 2, 1.5f},  Case{11.9f, 2, 2.975f},
+      Case{12.f, 3, 1.5f},   Case{100000.f, 10, 3.f},
+  };
+  for (const auto& c : Cases) {
+    int passLevel = -1;
+    float sigma = -1.f;
+    sigma_to_params(c.desired, passLevel, sigma);
+    EXPECT_EQ(passLevel, c.passLevel) << "sigma " << c.desired;
+    EXPECT_FLOAT_EQ(sigma, c.sigma) << "sigma " << c.desired;
+  }
+
+  for (float desired = 0.5f; desired < 3000.f; desired *= 1.1f) {
+    int passLevel = 0;
+    float sigma = 0.f;
+    sigma_to_params(desired, passLevel, sigma);
+    EXPECT_LE(sigma, 3.f);
+    EXPECT_NEAR(sigma * static_cast<float>(1 << passLevel), desired, desired * 1e-5f) << "sigma " << desired;
+  }
+}
+
+TEST(RmlUiBlurPlanTest, UpsampleStepsLeaveOneOrTwoLevelsForTheUpscale) {
+  constexpr std::array<int, 11> Expected{0, 0, 0, 2, 2, 4, 4, 6, 6, 8, 8};
+  for (int passLevel = 0; passLevel < static_cast<int>(Expected.size()); ++passLevel) {
+    const int steps = blur_upsample_steps(passLevel);
+    EXPECT_EQ(steps, Expected[passLevel]) << "level " << passLevel;
+    // Pairs of steps leave the result in `temp`, where the final upscale reads it
+    EXPECT_EQ(steps % 2, 0);
+    if (passLevel > 2) {
+      EXPECT_GE(passLevel - steps, 1);
+      EXPECT_LE(passLevel - steps, 2);
+    }
+  }
+}
+
+TEST(RmlUiBlurPlanTest, InvisibleBlursRecordNothing) {
+  EXPECT_TRUE(plan_blur(0.f, Scissors[0]).passes.empty());
+  EXPECT_TRUE(plan_blur(0.49f, Scissors[0]).passes.empty());
+  EXPECT_TRUE(plan_blur(-4.f, Scissors[0]).passes.empty());
+  EXPECT_TRUE(plan_blur(8.f, Rml::Rectanglei::FromCorners({10, 10}, {10, 20})).passes.empty());
+}
+
+TEST(RmlUiBlurPlanTest, SmallBlursMatchTheSingleUpscalePath) {
+  for (const auto& scissor : Scissors) {
+    for (float sigma = 0.5f; sigma < 12.f; sigma += 0.25f) {
+      const BlurPlan plan = plan_blur(sigma, scissor);
+      ASSERT_LE(plan.passLevel, 2);
+      expect_same_passes(plan.passes, single_upscale_passes(sigma, scissor), sigma);
+    }
+  }
+}
+
+TEST(RmlUiBlurPlanTest, LargeBlursUpsampleOneLevelAtATime) {
+  for (const auto& scissor : Scissors) {
+    for (float sigma = 12.f; sigma < 4000.f; sigma *= 1.5f) {
+      const BlurPlan plan = plan_blur(sigma, scissor);
+      ASSERT_GE(plan.passLevel, 3);
+      const auto horizontal = std::find_if(plan.passes.begin(), plan.passes.end(), [](const BlurPass& pass) {
+        return pass.kind == BlurPassKind::HorizontalBlur;
+      });
+      ASSERT_NE(horizontal, plan.passes.end());
+
+      // Each step doubles the region the previous pass wrote, alternating targets
+      Rml::Rectanglei region = horizontal->region;
+      bool inTemp = true;
+      auto it = horizontal + 1;
+      int steps = 0;
+      for (; it != plan.passes.end() && it->kind == BlurPassKind::Upsample; ++it, ++steps) {
+        EXPECT_EQ(it->toTemp, !inTemp);
+        EXPECT_TRUE(same_region(it->sourceRegion, region));
+        EXPECT_TRUE(same_region(it->region, Rml::Rectanglei::FromCorners(region.p0 * 2, region.p1 * 2)));
+        region = it->region;
+        inTemp = it->toTemp;
+      }
+      EXPECT_EQ(steps, blur_upsample_steps(plan.passLevel)) << "sigma " << sigma;
+      EXPECT_TRUE(inTemp);
+
+      ASSERT_NE(it, plan.passes.end());
+      EXPECT_EQ(it->kind, BlurPassKind::Upscale);
+      EXPECT_FALSE(it->toTemp);
+      EXPECT_TRUE(same_region(it->region, scissor));
+      EXPECT_TRUE(same_region(it->sourceRegion, region));
+      if (++it != plan.passes.end()) {
+        const int remaining = plan.passLevel - steps;
+        EXPECT_EQ(it->kind, BlurPassKind::PowerOfTwoUpscale);
+        EXPECT_TRUE(same_region(it->region, Rml::Rectanglei::FromCorners(region.p0 * (1 << remaining),
+                                                                          region.p1 * (1 << remaining))));
+        EXPECT_EQ(++it, plan.passes.end());
+      }
+    }
+  }
+}
+
+} // namespace
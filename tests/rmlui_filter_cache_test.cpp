@@ -0,0 +1,132 @@
+#include "rmlui/filter_cache.hpp"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+
+namespace {
+using namespace aurora::rmlui;
+
+constexpr uint64_t EntrySize = 100;
+
+TEST(RmlUiFilterCacheTest, ResultsAreKeptOnceTheyRecurOnALaterFrame) {
+  FilterCache cache{1000};
+  cache.begin_frame();
+  EXPECT_EQ(cache.record(1, EntrySize), nullptr);
+  // Filtering the same contents twice in a frame is not a recurrence
+  EXPECT_EQ(cache.record(1, EntrySize), nullptr);
+  EXPECT_EQ(cache.find(1), nullptr);
+
+  cache.begin_frame();
+  FilterCache::Entry* entry = cache.record(1, EntrySize);
+  ASSERT_NE(entry, nullptr);
+  EXPECT_EQ(entry->size, EntrySize);
+  EXPECT_EQ(cache.size(), EntrySize);
+
+  cache.begin_frame();
+  EXPECT_EQ(cache.find(1), entry);
+  EXPECT_EQ(cache.find(2), nullptr);
+  // Kept results are restored rather than rendered and recorded again
+  EXPECT_EQ(cache.record(1, EntrySize), nullptr);
+  EXPECT_EQ(cache.size(), EntrySize);
+}
+
+TEST(RmlUiFilterCacheTest, BudgetEvictsLeastRecentlyUsedResults) {
+  FilterCache cache{3 * EntrySize};
+  cache.begin_frame();
+  for (uint64_t key = 1; key <= 4; ++key) {
+    cache.record(key, EntrySize);
+  }
+  for (uint64_t key = 1; key <= 3; ++key) {
+    cache.begin_frame();
+    ASSERT_NE(cache.record(key, EntrySize), nullptr);
+  }
+  EXPECT_EQ(cache.size(), 3 * EntrySize);
+
+  cache.begin_frame();
+  EXPECT_NE(cache.find(1), nullptr);
+  cache.begin_frame();
+  ASSERT_NE(cache.record(4, EntrySize), nullptr);
+  EXPECT_EQ(cache.size(), 3 * EntrySize);
+  EXPECT_NE(cache.find(1), nullptr);
+  EXPECT_EQ(cache.find(2), nullptr);
+  EXPECT_NE(cache.find(3), nullptr);
+  EXPECT_NE(cache.find(4), nullptr);
+}
+
+TEST(RmlUiFilterCacheTest, ResultsLargerThanTheBudgetAreNeverKept) {
+  FilterCache cache{EntrySize};
+  cache.begin_frame();
+  EXPECT_EQ(cache.record(1, 2 * EntrySize), nullptr);
+  cache.begin_frame();
+  EXPECT_EQ(cache.record(1, 2 * EntrySize), nullptr);
+  EXPECT_EQ(cache.find(1), nullptr);
+  EXPECT_EQ(cache.size(), 0u);
+}
+
+TEST(RmlUiFilterCacheTest, IdleResultsAreDropped) {
+  FilterCache cache{1000};
+  cache.begin_frame();
+  cache.record(1, EntrySize);
+  cache.record(2, EntrySize);
+  cache.begin_frame();
+  ASSERT_NE(cache.record(1, EntrySize), nullptr);
+  const uint64_t lastUsed = cache.frame();
+
+  while (cache.frame() - lastUsed < FilterCache::MaxIdleFrames) {
+    cache.begin_frame();
+  }
+  EXPECT_EQ(cache.entry_count(), 1u);
+  EXPECT_EQ(cache.size(), EntrySize);
+
+  cache.begin_frame();
+  EXPECT_EQ(cache.entry_count(), 0u);
+  EXPECT_EQ(cache.size(), 0u);
+  EXPECT_EQ(cache.find(1), nullptr);
+}
+
+TEST(RmlUiFilterCacheTest, SignaturesDependOnEveryValueInOrder) {
+  const auto signature = [](int a, int b) {
+    LayerSignature result;
+    result.mix(a);
+    result.mix(b);
+    return result.hash;
+  };
+  EXPECT_EQ(signature(1, 2), signature(1, 2));
+  EXPECT_NE(signature(1, 2), signature(1, 3));
+  EXPECT_NE(signature(1, 2), signature(2, 1));
+
+  // Filter keys fold the filter region into the source contents, so the same layer filtered over a different region
+  // is a different result
+  LayerSignature source;
+  source.mix(uint64_t{42});
+  LayerSignature left = source;
+  left.mix(std::array{0, 0, 64, 64});
+  LayerSignature right = source;
+  right.mix(std::array{64, 0, 128, 64});
+  EXPECT_NE(left.hash, right.hash);
+}
+
+TEST(RmlUiFilterCacheTest, UnstableContentsPropagateThroughComposites) {
+  const LayerSignature gameFrame{.stable = false};
+  LayerSignature element;
+  element.mix(7);
+  EXPECT_TRUE(element.stable);
+
+  LayerSignature composite;
+  composite.mix(element);
+  EXPECT_TRUE(composite.stable);
+  composite.mix(gameFrame);
+  EXPECT_FALSE(composite.stable);
+  // Drawing more on top does not make the layer stable again
+  composite.mix(8);
+  EXPECT_FALSE(composite.stable);
+
+  LayerSignature outer;
+  outer.mix(composite);
+  EXPECT_FALSE(outer.stable);
+  EXPECT_NE(outer.hash, LayerSignature{}.hash);
+}
+
+} // namespace
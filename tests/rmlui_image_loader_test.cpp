@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+
+#include "rmlui/image_loader.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace aurora::rmlui::image_loader {
+namespace {
+
+// The per-texel loop LoadTexture used before premultiplication was vectorized.
+void reference_premultiply(std::vector<uint8_t>& texels) {
+  for (size_t offset = 0; offset < texels.size(); offset += 4) {
+    const uint8_t alpha = texels[offset + 3];
+    for (size_t channel = 0; channel < 3; ++channel) {
+      texels[offset + channel] =
+          static_cast<uint8_t>((static_cast<uint32_t>(texels[offset + channel]) * static_cast<uint32_t>(alpha)) / 255);
+    }
+  }
+}
+
+std::vector<uint8_t> all_color_alpha_pairs() {
+  std::vector<uint8_t> texels;
+  texels.reserve(256 * 256 * 4);
+  for (uint32_t alpha = 0; alpha < 256; ++alpha) {
+    for (uint32_t color = 0; color < 256; ++color) {
+      texels.push_back(static_cast<uint8_t>(color));
+      texels.push_back(static_cast<uint8_t>(255 - color));
+      texels.push_back(static_cast<uint8_t>(color ^ 0x5A));
+      texels.push_back(static_cast<uint8_t>(alpha));
+    }
+  }
+  return texels;
+}
+
+// An opaque red 1x1 RGBA8 PNG and an opaque blue 2x1 one.
+constexpr std::array<uint8_t, 70> RedPng{
+    0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A, 0x00, 0x00, 0x00, 0x0D, 0x49, 0x48, 0x44, 0x52, 0x00, 0x00,
+    0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x08, 0x06, 0x00, 0x00, 0x00, 0x1F, 0x15, 0xC4, 0x89, 0x00, 0x00, 0x00,
+    0x0D, 0x49, 0x44, 0x41, 0x54, 0x78, 0x9C, 0x63, 0xF8, 0xCF, 0xC0, 0xF0, 0x1F, 0x00, 0x05, 0x00, 0x01, 0xFF,
+    0x89, 0x99, 0x3D, 0x1D, 0x00, 0x00, 0x00, 0x00, 0x49, 0x45, 0x4E, 0x44, 0xAE, 0x42, 0x60, 0x82,
+};
+constexpr std::array<uint8_t, 71> BluePng{
+    0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A, 0x00, 0x00, 0x00, 0x0D, 0x49, 0x48, 0x44, 0x52, 0x00, 0x00,
+    0x00, 0x02, 0x00, 0x00, 0x00, 0x01, 0x08, 0x06, 0x00, 0x00, 0x00, 0xF4, 0x22, 0x7F, 0x8A, 0x00, 0x00, 0x00,
+    0x0E, 0x49, 0x44, 0x41, 0x54, 0x78, 0x9C, 0x63, 0x60, 0x60, 0xF8, 0xFF, 0x1F, 0x84, 0x01, 0x0D, 0xFB, 0x03,
+    0xFD, 0x87, 0x5E, 0xD5, 0x87, 0x00, 0x00, 0x00, 0x00, 0x49, 0x45, 0x4E, 0x44, 0xAE, 0x42, 0x60, 0x82,
+};
+
+template <size_t N>
+void write_png(const std::filesystem::path& path, const std::array<uint8_t, N>& bytes) {
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+}
+
+TEST(RmlUiImageLoader, PremultiplyMatchesScalarPath) {
+  auto texels = all_color_alpha_pairs();
+  auto expected = texels;
+  reference_premultiply(expected);
+  premultiply_alpha(texels);
+  EXPECT_EQ(texels, expected);
+}
+
+TEST(RmlUiImageLoader, PremultiplyHandlesUnalignedTails) {
+  const auto source = all_color_alpha_pairs();
+  // Lengths that leave a remainder after every vector width, starting at an unaligned address.
+  for (const size_t pixels : {1u, 3u, 5u, 17u, 63u, 101u}) {
+    std::vector<uint8_t> texels(source.begin() + 4 * 777, source.begin() + 4 * (777 + pixels));
+    auto expected = texels;
+    reference_premultiply(expected);
+    std::vector<uint8_t> shifted(texels.size() + 1);
+    std::copy(texels.begin(), texels.end(), shifted.begin() + 1);
+    premultiply_alpha({shifted.data() + 1, texels.size()});
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(), shifted.begin() + 1)) << pixels << " pixels";
+  }
+}
+
+TEST(RmlUiImageLoader, CachedDecodesAreDroppedWhenTheFileChanges) {
+  clear_cache();
+  const auto path = std::filesystem::temp_directory_path() / "aurora-image-loader-test.png";
+  const std::string source = path.string();
+  write_png(path, RedPng);
+
+  const auto red = load(source);
+  ASSERT_TRUE(red);
+  EXPECT_EQ(red->width, 1u);
+  const auto cached = find_cached(source);
+  ASSERT_TRUE(cached);
+  EXPECT_EQ(cached->rgba, red->rgba);
+
+  // A reopened document must not get the decode of the file's old contents
+  write_png(path, BluePng);
+  EXPECT_FALSE(find_cached(source));
+  const auto blue = load(source);
+  ASSERT_TRUE(blue);
+  EXPECT_EQ(blue->width, 2u);
+  EXPECT_EQ(*blue->rgba, (std::vector<uint8_t>{0, 0, 255, 255, 0, 0, 255, 255}));
+  const auto cachedBlue = find_cached(source);
+  ASSERT_TRUE(cachedBlue);
+  EXPECT_EQ(cachedBlue->rgba, blue->rgba);
+
+  std::filesystem::remove(path);
+  EXPECT_FALSE(find_cached(source));
+  clear_cache();
+}
+
+} // namespace
+} // namespace aurora::rmlui::image_loader
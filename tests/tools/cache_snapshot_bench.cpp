@@ -0,0 +1,85 @@
+// Compares Dawn cache cold-start load time with and without the mapped snapshot on a synthetic cache. Each run reopens
+// the cache and loads every entry the way Dawn does: a size query followed by a copy. Results are printed as JSON.
+//
+// Usage: aurora_cache_snapshot_bench [entries] [blob size]
+
+#include "internal.hpp"
+#include "io.hpp"
+#include "webgpu/gpu.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+std::string key_for(size_t i) { return "synthetic-pipeline-" + std::to_string(i); }
+
+double load_all_ms(size_t entries, size_t blobSize) {
+  using namespace aurora::webgpu;
+  std::vector<uint8_t> value(blobSize);
+  size_t hits = 0;
+  const auto start = Clock::now();
+  for (size_t i = 0; i < entries; ++i) {
+    const auto key = key_for(i);
+    const size_t size = load_from_cache(key.data(), key.size(), nullptr, 0, nullptr);
+    if (size == value.size() && load_from_cache(key.data(), key.size(), value.data(), value.size(), nullptr) == size) {
+      ++hits;
+    }
+  }
+  const double ms = std::chrono::duration<double, std::milli>{Clock::now() - start}.count();
+  cache_shutdown();
+  if (hits != entries) {
+    std::fprintf(stderr, "Only %zu of %zu entries loaded\n", hits, entries);
+  }
+  return ms;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+  using namespace aurora::webgpu;
+  const size_t entries = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 5000;
+  const size_t blobSize = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 16384;
+
+  const auto directory = std::filesystem::temp_directory_path() / "aurora-cache-snapshot-bench";
+  std::error_code error;
+  std::filesystem::remove_all(directory, error);
+  if (!aurora::io::create_directories(directory)) {
+    std::fprintf(stderr, "Failed to create %s\n", directory.string().c_str());
+    return 1;
+  }
+  const auto cachePath = aurora::io::fs_path_to_string(directory);
+  aurora::g_config.cachePath = cachePath.c_str();
+
+  // Compressible but distinct blobs, similar to compiled pipeline binaries
+  std::vector<uint8_t> value(blobSize);
+  for (size_t i = 0; i < entries; ++i) {
+    for (size_t j = 0; j < blobSize; ++j) {
+      value[j] = static_cast<uint8_t>((j / 16) ^ (i * 31) ^ (j % 7 == 0 ? i >> 3 : 0));
+    }
+    const auto key = key_for(i);
+    store_to_cache(key.data(), key.size(), value.data(), value.size(), nullptr);
+  }
+  cache_flush();
+  cache_prune();
+  cache_shutdown();
+
+  const auto snapshotPath = directory / "dawn_cache.snapshot";
+  if (!std::filesystem::exists(snapshotPath)) {
+    std::fprintf(stderr, "No snapshot was written\n");
+    return 1;
+  }
+  const double withSnapshot = load_all_ms(entries, blobSize);
+  std::filesystem::rename(snapshotPath, directory / "dawn_cache.snapshot.off", error);
+  const double withoutSnapshot = load_all_ms(entries, blobSize);
+
+  std::printf("{\"entries\":%zu,\"blobSize\":%zu,\"snapshotMs\":%.2f,\"sqliteMs\":%.2f}\n", entries, blobSize,
+              withSnapshot, withoutSnapshot);
+  aurora::g_config.cachePath = nullptr;
+  std::filesystem::remove_all(directory, error);
+  return 0;
+}
@@ -0,0 +1,87 @@
+// Measures the caller-side cost of logging with the synchronous and asynchronous backends. Messages go to a callback
+// that writes and flushes a temporary file, standing in for unbuffered stderr. Results are printed as JSON.
+//
+// Usage: aurora_log_bench [messages]
+
+#include "logging.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+constexpr aurora::Module Log{"aurora::bench"};
+
+FILE* g_sink = nullptr;
+
+void sink_callback(AuroraLogLevel, const char* module, const char* message, unsigned int len) {
+  std::fprintf(g_sink, "[%s] %.*s\n", module, static_cast<int>(len), message);
+  std::fflush(g_sink);
+}
+
+struct Result {
+  double callerNs;
+  double flushMs;
+};
+
+// Messages are logged in bursts, like a frame that hits the same error for many draws, with a pause in between
+// that gives the writer thread time to catch up. Only the bursts are timed.
+constexpr size_t BurstSize = 256;
+constexpr auto BurstInterval = std::chrono::milliseconds{2};
+
+Result run(bool async, bool repeated, size_t messages) {
+  aurora::set_async_logging(async);
+  Clock::duration caller{};
+  for (size_t i = 0; i < messages;) {
+    const auto start = Clock::now();
+    for (const size_t end = std::min(messages, i + BurstSize); i < end; ++i) {
+      Log.warn("Failed to create texture {}: format {} unsupported", repeated ? 0 : i, 14);
+    }
+    caller += Clock::now() - start;
+    std::this_thread::sleep_for(BurstInterval);
+  }
+  const auto flushStart = Clock::now();
+  aurora::flush_logs();
+  const auto flushed = Clock::now();
+  aurora::set_async_logging(false);
+  return {
+      .callerNs = std::chrono::duration<double, std::nano>{caller}.count() / static_cast<double>(messages),
+      .flushMs = std::chrono::duration<double, std::milli>{flushed - flushStart}.count(),
+  };
+}
+} // namespace
+
+int main(int argc, char** argv) {
+  const size_t messages = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 50000;
+  g_sink = std::tmpfile();
+  if (g_sink == nullptr) {
+    std::fprintf(stderr, "Failed to create temporary file\n");
+    return 1;
+  }
+  aurora::g_config.logCallback = sink_callback;
+  aurora::g_config.logLevel = LOG_DEBUG;
+
+  std::string out = "{\"messages\":" + std::to_string(messages) + ",\"results\":[";
+  bool first = true;
+  for (const bool repeated : {false, true}) {
+    for (const bool async : {false, true}) {
+      const auto result = run(async, repeated, messages);
+      char buf[256];
+      std::snprintf(buf, sizeof(buf),
+                    "%s{\"mode\":\"%s\",\"messages\":\"%s\",\"callerNsPerMessage\":%.1f,\"flushMs\":%.2f}",
+                    first ? "" : ",", async ? "async" : "sync", repeated ? "repeated" : "unique", result.callerNs,
+                    result.flushMs);
+      out += buf;
+      first = false;
+    }
+  }
+  out += "]}\n";
+  std::fputs(out.c_str(), stdout);
+  std::fclose(g_sink);
+  return 0;
+}
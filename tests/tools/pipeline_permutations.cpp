@@ -0,0 +1,82 @@
+// Reports how many GX pipeline permutations a recorded pipeline cache collapses to after ShaderConfig
+// canonicalization. Rows written by older config versions are accepted as long as the PipelineConfig layout matches.
+//
+// Usage: aurora_pipeline_permutations <pipeline_cache.db>
+
+#include "gx/pipeline.hpp"
+#include "gx/shader_info.hpp"
+
+#include <sqlite3.h>
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+
+namespace {
+using aurora::gx::PipelineConfig;
+using aurora::gx::ShaderConfig;
+
+constexpr int GXShaderType = 1; // aurora::gfx::ShaderType::GX
+
+template <typename T>
+std::string_view bytes(const T& value) {
+  return {reinterpret_cast<const char*>(&value), sizeof(T)};
+}
+
+struct Counts {
+  std::unordered_set<std::string> pipelines;
+  std::unordered_set<std::string> shaders;
+
+  void add(const PipelineConfig& config) {
+    pipelines.emplace(bytes(config));
+    shaders.emplace(bytes(config.shaderConfig));
+  }
+};
+} // namespace
+
+int main(int argc, char** argv) {
+  if (argc != 2) {
+    std::fprintf(stderr, "Usage: %s <pipeline_cache.db>\n", argv[0]);
+    return 1;
+  }
+  sqlite3* db = nullptr;
+  if (sqlite3_open_v2(argv[1], &db, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK) {
+    std::fprintf(stderr, "Failed to open %s: %s\n", argv[1], sqlite3_errmsg(db));
+    sqlite3_close(db);
+    return 1;
+  }
+  sqlite3_stmt* stmt = nullptr;
+  if (sqlite3_prepare_v2(db, "SELECT config FROM pipeline_cache WHERE type = ?1 AND config_size = ?2", -1, &stmt,
+                         nullptr) != SQLITE_OK) {
+    std::fprintf(stderr, "Failed to query pipeline_cache: %s\n", sqlite3_errmsg(db));
+    sqlite3_close(db);
+    return 1;
+  }
+  sqlite3_bind_int(stmt, 1, GXShaderType);
+  sqlite3_bind_int(stmt, 2, static_cast<int>(sizeof(PipelineConfig)));
+
+  size_t rows = 0;
+  Counts before;
+  Counts after;
+  while (sqlite3_step(stmt) == SQLITE_ROW) {
+    if (sqlite3_column_bytes(stmt, 0) != sizeof(PipelineConfig)) {
+      continue;
+    }
+    PipelineConfig config;
+    std::memcpy(&config, sqlite3_column_blob(stmt, 0), sizeof(PipelineConfig));
+    config.version = aurora::gx::GXPipelineConfigVersion;
+    ++rows;
+    before.add(config);
+    aurora::gx::canonicalize_shader_config(config.shaderConfig, aurora::gx::build_shader_info(config.shaderConfig));
+    after.add(config);
+  }
+  sqlite3_finalize(stmt);
+  sqlite3_close(db);
+
+  std::printf("{\"rows\":%zu,\"pipelines\":{\"before\":%zu,\"after\":%zu},"
+              "\"shaders\":{\"before\":%zu,\"after\":%zu}}\n",
+              rows, before.pipelines.size(), after.pipelines.size(), before.shaders.size(), after.shaders.size());
+  return 0;
+}